@@ -0,0 +1,169 @@
+//
+//  MBTableGridLayoutBenchmark.c
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+//  Measures the layout core on grids of 1e3 to 1e8 cells, in a wide shape
+//  (100 rows, many variable-width columns) and a tall shape (10 columns,
+//  many variable-height rows).
+//
+//  Usage: MBTableGridLayoutBenchmark [max-cells-exponent] [operations]
+//
+
+#include "MBTableGridGeometry.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define MBViewportWidth 1440.0
+#define MBViewportHeight 900.0
+
+typedef struct MBBenchmarkGrid {
+    MBTableGridOffsetIndex *columnOffsets;
+    MBTableGridOffsetIndex *rowOffsets;
+    MBTableGridAxis columns;
+    MBTableGridAxis rows;
+} MBBenchmarkGrid;
+
+static uint64_t MBRandomState = 0x9E3779B97F4A7C15ULL;
+static double MBChecksum = 0.0;
+
+static uint64_t MBRandom(void) {
+    MBRandomState ^= MBRandomState << 13;
+    MBRandomState ^= MBRandomState >> 7;
+    MBRandomState ^= MBRandomState << 17;
+    return MBRandomState;
+}
+
+static size_t MBRandomIndex(size_t count) {
+    return (size_t)(MBRandom() % count);
+}
+
+static double MBRandomOffset(double length) {
+    return (double)(MBRandom() >> 11) * (1.0 / 9007199254740992.0) * length;
+}
+
+static double MBNow(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+static void MBReport(const char *shape, const MBBenchmarkGrid *grid, const char *operation, double seconds, size_t operations) {
+    printf("%-5s %10zu %10zu  %-22s %12.1f ns/op\n",
+           shape, grid->columns.count, grid->rows.count, operation, seconds * 1e9 / (double)operations);
+}
+
+static void MBFillSizes(MBTableGridOffsetIndex *index, size_t count, float minimum, unsigned spread) {
+    float *sizes = MBTableGridOffsetIndexBeginReset(index, count);
+    if (sizes == NULL && count > 0) {
+        fprintf(stderr, "Out of memory allocating %zu sizes\n", count);
+        exit(1);
+    }
+    for (size_t i = 0; i < count; i++)
+        sizes[i] = minimum + (float)(MBRandom() % spread);
+    MBTableGridOffsetIndexEndReset(index);
+}
+
+static void MBRunShape(const char *shape, size_t numberOfColumns, size_t numberOfRows, size_t operations) {
+    MBBenchmarkGrid grid;
+    double start;
+
+    grid.columnOffsets = MBTableGridOffsetIndexCreate();
+    grid.rowOffsets = MBTableGridOffsetIndexCreate();
+
+    start = MBNow();
+    MBFillSizes(grid.columnOffsets, numberOfColumns, 60.0f, 120);
+    MBFillSizes(grid.rowOffsets, numberOfRows, 20.0f, 40);
+    grid.columns.offsets = grid.columnOffsets;
+    grid.columns.count = numberOfColumns;
+    grid.columns.uniformSize = 0.0;
+    grid.rows.offsets = grid.rowOffsets;
+    grid.rows.count = numberOfRows;
+    grid.rows.uniformSize = 20.0;
+    MBReport(shape, &grid, "build", MBNow() - start, numberOfColumns + numberOfRows);
+
+    double width = MBTableGridAxisLength(&grid.columns);
+    double height = MBTableGridAxisLength(&grid.rows);
+
+    start = MBNow();
+    for (size_t i = 0; i < operations; i++) {
+        MBTableGridSpan span = MBTableGridAxisSpanOfIndex(&grid.columns, MBRandomIndex(numberOfColumns));
+        MBChecksum += span.origin + span.length;
+    }
+    MBReport(shape, &grid, "rectOfColumn", MBNow() - start, operations);
+
+    start = MBNow();
+    for (size_t i = 0; i < operations; i++) {
+        MBTableGridSpan span = MBTableGridAxisSpanOfIndex(&grid.rows, MBRandomIndex(numberOfRows));
+        MBChecksum += span.origin + span.length;
+    }
+    MBReport(shape, &grid, "rectOfRow", MBNow() - start, operations);
+
+    start = MBNow();
+    for (size_t i = 0; i < operations; i++)
+        MBChecksum += (double)MBTableGridAxisIndexAtOffset(&grid.columns, MBRandomOffset(width));
+    MBReport(shape, &grid, "columnAtPoint", MBNow() - start, operations);
+
+    start = MBNow();
+    for (size_t i = 0; i < operations; i++)
+        MBChecksum += (double)MBTableGridAxisIndexAtOffset(&grid.rows, MBRandomOffset(height));
+    MBReport(shape, &grid, "rowAtPoint", MBNow() - start, operations);
+
+    start = MBNow();
+    for (size_t i = 0; i < operations; i++) {
+        double x = MBRandomOffset(width);
+        double y = MBRandomOffset(height);
+        MBTableGridIndexRange columnRange = MBTableGridAxisRangeIntersecting(&grid.columns, x, x + MBViewportWidth);
+        MBTableGridIndexRange rowRange = MBTableGridAxisRangeIntersecting(&grid.rows, y, y + MBViewportHeight);
+        MBChecksum += (double)(columnRange.length + rowRange.length);
+    }
+    MBReport(shape, &grid, "visible ranges", MBNow() - start, operations);
+
+    start = MBNow();
+    for (size_t i = 0; i < operations; i++) {
+        MBTableGridSelectionBounds selection;
+        selection.firstColumn = MBRandomIndex(numberOfColumns);
+        selection.lastColumn = selection.firstColumn + MBRandomIndex(numberOfColumns - selection.firstColumn);
+        selection.firstRow = MBRandomIndex(numberOfRows);
+        selection.lastRow = selection.firstRow + MBRandomIndex(numberOfRows - selection.firstRow);
+        MBTableGridRect rect = MBTableGridGeometryRectOfSelection(&grid.columns, &grid.rows, selection, width, height);
+        MBChecksum += rect.width + rect.height;
+    }
+    MBReport(shape, &grid, "rectOfSelection", MBNow() - start, operations);
+
+    start = MBNow();
+    for (size_t i = 0; i < operations; i++)
+        MBTableGridOffsetIndexSetSize(grid.columnOffsets, MBRandomIndex(numberOfColumns), 60.0 + (double)(MBRandom() % 120));
+    MBReport(shape, &grid, "resize column", MBNow() - start, operations);
+
+    start = MBNow();
+    for (size_t i = 0; i < operations; i++)
+        MBTableGridOffsetIndexSetSize(grid.rowOffsets, MBRandomIndex(numberOfRows), 20.0 + (double)(MBRandom() % 40));
+    MBReport(shape, &grid, "resize row", MBNow() - start, operations);
+
+    MBTableGridOffsetIndexDestroy(grid.columnOffsets);
+    MBTableGridOffsetIndexDestroy(grid.rowOffsets);
+}
+
+int main(int argc, char *argv[]) {
+    int maxExponent = argc > 1 ? atoi(argv[1]) : 8;
+    size_t operations = argc > 2 ? (size_t)strtoull(argv[2], NULL, 10) : 1000000;
+    size_t cells = 1000;
+
+    if (maxExponent < 3 || operations == 0) {
+        fprintf(stderr, "usage: %s [max-cells-exponent >= 3] [operations > 0]\n", argv[0]);
+        return 1;
+    }
+
+    printf("%-5s %10s %10s  %-22s %18s\n", "shape", "columns", "rows", "operation", "time");
+    for (int exponent = 3; exponent <= maxExponent; exponent++, cells *= 10) {
+        MBRunShape("wide", cells / 100, 100, operations);
+        MBRunShape("tall", 10, cells / 10, operations);
+    }
+    printf("checksum %g\n", MBChecksum);
+    return 0;
+}
@@ -0,0 +1,164 @@
+//
+//  MBTableGrid+Export.m
+//  MBTableGrid
+//
+//  Created by agent on 10/17/26.
+//
+
+#import "MBTableGrid+Private.h"
+#import "MBTableGridDelimitedWriter.h"
+#import "MBTableGridColumnarWriter.h"
+
+static bool MBWriteToFileDescriptor(void *context, const char *bytes, size_t length) {
+    int fileDescriptor = *(const int *)context;
+    while (length) {
+        ssize_t written = write(fileDescriptor, bytes, length);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        bytes += written;
+        length -= (size_t)written;
+    }
+    return true;
+}
+
+@implementation MBTableGrid (Exporting)
+
+- (NSProgress *)exportColumns:(NSIndexSet *)columnIndexes rows:(NSIndexSet *)rowIndexes
+             toFileDescriptor:(int)fileDescriptor format:(MBTableGridExportFormat)format
+               includeHeaders:(BOOL)includeHeaders completionHandler:(void (^)(BOOL succeeded))completionHandler {
+	NSUInteger numberOfColumns = _numberOfColumns, numberOfRows = _numberOfRows;
+	NSIndexSet *columns = [columnIndexes ?: [NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, numberOfColumns)] indexesPassingTest:^(NSUInteger idx, BOOL *stop) {
+		return (BOOL)(idx < numberOfColumns);
+	}];
+	NSIndexSet *rows = [rowIndexes ?: [NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, numberOfRows)] indexesPassingTest:^(NSUInteger idx, BOOL *stop) {
+		return (BOOL)(idx < numberOfRows);
+	}];
+	
+	// Headers come from the data source on this thread; only cell values are fetched in the background
+	NSMutableArray<NSString *> *headers = nil;
+	if (includeHeaders) {
+		headers = [NSMutableArray arrayWithCapacity:columns.count];
+		[columns enumerateIndexesUsingBlock:^(NSUInteger columnIndex, BOOL *stop) {
+			[headers addObject:[self _headerStringForColumn:columnIndex] ?: @""];
+		}];
+	}
+	
+	NSProgress *progress = [NSProgress progressWithTotalUnitCount:rows.count];
+	dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+		BOOL succeeded = [self _exportColumns:columns rows:rows toFileDescriptor:fileDescriptor format:format
+									  headers:headers progress:progress];
+		if (completionHandler) {
+			dispatch_async(dispatch_get_main_queue(), ^{
+				completionHandler(succeeded);
+			});
+		}
+	});
+	return progress;
+}
+
+// Writes cells a batch of rows at a time. Each batch is fetched with one call per
+// batch spanning the first to last exported column, since strings borrowed from
+// one call needn't survive the next, and the exported columns picked out of it.
+- (BOOL)_exportColumns:(NSIndexSet *)columnIndexes rows:(NSIndexSet *)rowIndexes toFileDescriptor:(int)fileDescriptor
+                format:(MBTableGridExportFormat)format headers:(NSArray<NSString *> *)headers progress:(NSProgress *)progress {
+    NSUInteger columnCount = columnIndexes.count;
+    NSRange columnSpan = (columnCount > 0) ? NSMakeRange(columnIndexes.firstIndex, columnIndexes.lastIndex - columnIndexes.firstIndex + 1)
+                                           : NSMakeRange(0, 0);
+    BOOL providesTypedValues = [self _providesTypedValues];
+    // Object values come a few thousand at a time, as the data source method promises
+    NSUInteger batchSize = providesTypedValues ? MBTableGridExportBatchSize : MBTableGridObjectValueBatchSize;
+    NSUInteger rowsPerBatch = MAX(1, batchSize / MAX(1, columnSpan.length));
+    
+    MBTableGridDelimitedWriter *delimitedWriter = NULL;
+    MBTableGridColumnarWriter *columnarWriter = NULL;
+    if (format == MBTableGridExportFormatColumnar) {
+        const char **names = headers ? calloc(MAX(1, columnCount), sizeof(const char *)) : NULL;
+        size_t *nameLengths = headers ? calloc(MAX(1, columnCount), sizeof(size_t)) : NULL;
+        if (headers == nil || (names && nameLengths)) {
+            for (NSUInteger i = 0; i < headers.count; i++) {
+                names[i] = headers[i].UTF8String ?: "";
+                nameLengths[i] = strlen(names[i]);
+            }
+            columnarWriter = MBTableGridColumnarWriterCreate(columnCount, names, nameLengths, MBWriteToFileDescriptor, &fileDescriptor);
+        }
+        free(names);
+        free(nameLengths);
+    } else {
+        MBTableGridDelimitedFormat delimitedFormat = (format == MBTableGridExportFormatCommaSeparated) ? MBTableGridDelimitedFormatCommaSeparated
+                                                                                                      : MBTableGridDelimitedFormatTabSeparated;
+        delimitedWriter = MBTableGridDelimitedWriterCreate(delimitedFormat, true, MBWriteToFileDescriptor, &fileDescriptor);
+        if (delimitedWriter && headers) {
+            for (NSString *header in headers) {
+                const char *text = header.UTF8String ?: "";
+                MBTableGridDelimitedWriterWriteField(delimitedWriter, text, strlen(text));
+            }
+            MBTableGridDelimitedWriterEndRecord(delimitedWriter);
+        }
+    }
+    
+    NSUInteger cellCount = rowsPerBatch * columnSpan.length;
+    MBTableGridValue *spanValues = malloc(MAX(1, cellCount) * sizeof(MBTableGridValue));
+    MBTableGridValue *values = (columnSpan.length == columnCount) ? spanValues : malloc(MAX(1, rowsPerBatch * columnCount) * sizeof(MBTableGridValue));
+    __strong id *objects = providesTypedValues ? NULL : (__strong id *)calloc(MAX(1, cellCount), sizeof(id));
+    __block BOOL succeeded = ((delimitedWriter || columnarWriter) && spanValues && values && (providesTypedValues || objects));
+    
+    if (succeeded && columnCount > 0) {
+        [rowIndexes enumerateRangesUsingBlock:^(NSRange rowRange, BOOL *stop) {
+            for (NSUInteger firstRow = rowRange.location; firstRow < NSMaxRange(rowRange); firstRow += rowsPerBatch) {
+                if (progress.cancelled) {
+                    succeeded = NO;
+                    break;
+                }
+                NSRange batchRows = NSMakeRange(firstRow, MIN(rowsPerBatch, NSMaxRange(rowRange) - firstRow));
+                NSUInteger count = columnSpan.length * batchRows.length;
+                
+                @autoreleasepool {
+                    if (providesTypedValues) {
+                        [self _getValues:spanValues forColumns:columnSpan rows:batchRows];
+                    } else {
+                        [self _getObjectValues:objects forColumns:columnSpan rows:batchRows];
+                        for (NSUInteger i = 0; i < count; i++)
+                            spanValues[i] = MBValueForObject(objects[i]);
+                    }
+                    if (values != spanValues) {
+                        __block NSUInteger j = 0;
+                        [columnIndexes enumerateIndexesUsingBlock:^(NSUInteger columnIndex, BOOL *stopColumns) {
+                            memcpy(values + j * batchRows.length, spanValues + (columnIndex - columnSpan.location) * batchRows.length,
+                                   batchRows.length * sizeof(MBTableGridValue));
+                            j++;
+                        }];
+                    }
+                    
+                    if (delimitedWriter)
+                        succeeded = MBTableGridDelimitedWriterWriteValues(delimitedWriter, values, columnCount, batchRows.length);
+                    else
+                        succeeded = MBTableGridColumnarWriterWriteValues(columnarWriter, values, batchRows.length);
+                    
+                    if (objects) {
+                        for (NSUInteger i = 0; i < count; i++)
+                            objects[i] = nil;
+                    }
+                }
+                if (!succeeded)
+                    break;
+                progress.completedUnitCount += batchRows.length;
+            }
+            *stop = !succeeded;
+        }];
+    }
+    
+    if (succeeded)
+        succeeded = delimitedWriter ? MBTableGridDelimitedWriterFlush(delimitedWriter) : MBTableGridColumnarWriterFinish(columnarWriter);
+    MBTableGridDelimitedWriterDestroy(delimitedWriter);
+    MBTableGridColumnarWriterDestroy(columnarWriter);
+    if (values != spanValues)
+        free(values);
+    free(spanValues);
+    free(objects);
+    return succeeded;
+}
+
+@end
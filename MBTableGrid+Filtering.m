@@ -0,0 +1,270 @@
+//
+//  MBTableGrid+Filtering.m
+//  MBTableGrid
+//
+//  Created by agent on 10/17/26.
+//
+
+#import "MBTableGrid+Private.h"
+#import "MBTableGridHeaderView.h"
+#import "MBTableGridFooterView.h"
+#import "MBTableGridContentView.h"
+#import "MBTableGridTextFinderClient.h"
+
+#define MBTableGridFilterChunkSize 4096 // values each processor tests against a filter condition at a time
+
+int MBCompareFilterColumns(const void *a, const void *b) {
+    NSUInteger columnA = ((const MBFilterColumn *)a)->columnIndex, columnB = ((const MBFilterColumn *)b)->columnIndex;
+    return (columnA > columnB) - (columnA < columnB);
+}
+
+// A batch of values tested against a condition, a chunk per processor
+typedef struct MBFilterBatch {
+    const MBTableGridFilterCondition *condition;
+    const MBTableGridValue *values;
+    unsigned char *matches;
+    size_t count;
+} MBFilterBatch;
+
+static void MBMarkFilterChunk(void *context, size_t iteration) {
+    const MBFilterBatch *batch = context;
+    size_t first = iteration * MBTableGridFilterChunkSize;
+    MBTableGridFilterConditionMarkMatches(batch->condition, batch->values + first,
+                                          MIN(MBTableGridFilterChunkSize, batch->count - first), batch->matches + first);
+}
+
+static double MBFilterBound(id bound, double unbounded) {
+    if ([bound isKindOfClass:[NSDate class]])
+        return [bound timeIntervalSince1970];
+    if ([bound isKindOfClass:[NSNumber class]])
+        return [bound doubleValue];
+    return unbounded;
+}
+
+// Returns NULL if out of memory
+static MBTableGridFilterCondition *MBFilterConditionForPredicate(MBTableGridFilterPredicate *predicate) {
+    MBTableGridFilterCondition *condition = NULL;
+    @autoreleasepool {
+        switch (predicate.filterOperator) {
+            case MBTableGridFilterOperatorEquals: {
+                MBTableGridValue value = MBValueForObject(predicate.value);
+                condition = MBTableGridFilterConditionCreateEquals(&value, predicate.ignoresCase);
+                break;
+            }
+            case MBTableGridFilterOperatorRange:
+                condition = MBTableGridFilterConditionCreateRange(MBFilterBound(predicate.minimum, -INFINITY),
+                                                                  MBFilterBound(predicate.maximum, INFINITY));
+                break;
+            case MBTableGridFilterOperatorContains: {
+                const char *bytes = [predicate.value description].UTF8String ?: "";
+                condition = MBTableGridFilterConditionCreateContains(bytes, strlen(bytes), predicate.ignoresCase);
+                break;
+            }
+            case MBTableGridFilterOperatorIsEmpty:
+                condition = MBTableGridFilterConditionCreateIsEmpty();
+                break;
+        }
+    }
+    return predicate.negated ? MBTableGridFilterConditionCreateNegation(condition) : condition;
+}
+
+@implementation MBTableGrid (Filtering)
+
+- (NSArray<MBTableGridFilterPredicate *> *)filterPredicates {
+    return _filterPredicates ?: @[];
+}
+
+- (BOOL)filterRowsWithPredicates:(NSArray<MBTableGridFilterPredicate *> *)predicates {
+    // Selected rows stay selected if they are still shown
+    NSIndexSet *selectedDataSourceRowIndexes = [self _dataSourceRowIndexesForRowIndexes:self.selectedRowIndexes];
+    _filterPredicates = [predicates copy];
+    BOOL succeeded = [self _readFilterMatches];
+    if (!succeeded) {
+        NSLog(@"WARNING: MBTableGrid could not filter %lu rows", (unsigned long)_numberOfDataSourceRows);
+        [self _clearFilter];
+    }
+    succeeded = [self _orderRowsFromSortKeys] && succeeded;
+    self.selectedRowIndexes = [self _rowIndexesForDataSourceRowIndexes:selectedDataSourceRowIndexes];
+    // Footers may summarize the rows shown
+    columnFooterView.needsDisplay = YES;
+    return succeeded;
+}
+
+- (void)_clearFilterConditions {
+    for (NSUInteger i = 0; i < _filterColumnCount; i++) {
+        MBTableGridFilterConditionDestroy(_filterColumns[i].condition);
+    }
+    free(_filterColumns);
+    _filterColumns = NULL;
+    _filterColumnCount = 0;
+    free(_filterMatches);
+    _filterMatches = NULL;
+    MBTableGridBitmapDestroy(_pendingFilterRows);
+    _pendingFilterRows = NULL;
+}
+
+- (void)_clearFilter {
+    [self _clearFilterConditions];
+    _filterPredicates = nil;
+}
+
+// Tests every data source row against the predicates on columns that exist, with the
+// conditions on each column together so that it's read once. Returns NO if out of
+// memory; if no predicate applies, there's no filter.
+- (BOOL)_readFilterMatches {
+    [self _clearFilterConditions];
+    NSArray<MBTableGridFilterPredicate *> *predicates = _filterPredicates;
+    if (predicates.count == 0)
+        return YES;
+    _filterColumns = calloc(predicates.count, sizeof(MBFilterColumn));
+    if (_filterColumns == NULL)
+        return NO;
+    for (MBTableGridFilterPredicate *predicate in predicates) {
+        if (predicate.columnIndex >= _numberOfColumns)
+            continue;
+        MBTableGridFilterCondition *condition = MBFilterConditionForPredicate(predicate);
+        if (condition == NULL) {
+            [self _clearFilterConditions];
+            return NO;
+        }
+        _filterColumns[_filterColumnCount++] = (MBFilterColumn){ predicate.columnIndex, condition };
+    }
+    if (_filterColumnCount == 0) {
+        [self _clearFilterConditions];
+        return YES;
+    }
+    qsort(_filterColumns, _filterColumnCount, sizeof(MBFilterColumn), MBCompareFilterColumns);
+
+    _filterMatches = malloc(MAX(1, _numberOfDataSourceRows));
+    _pendingFilterRows = MBTableGridBitmapCreate();
+    if (_filterMatches == NULL || _pendingFilterRows == NULL || ![self _filterDataSourceRows:NSMakeRange(0, _numberOfDataSourceRows)]) {
+        [self _clearFilterConditions];
+        return NO;
+    }
+    return YES;
+}
+
+// Tests some data source rows against the filter a batch at a time, recording in the
+// filter's matches which pass, and in its pending rows which of those pass only
+// because their values are still loading. Each column is read once per batch, and
+// each condition tested on every processor. Returns NO if out of memory.
+- (BOOL)_filterDataSourceRows:(NSRange)rowRange {
+    BOOL providesTypedValues = [self _providesTypedValues];
+    NSUInteger batchSize = providesTypedValues ? MBTableGridExportBatchSize : MBTableGridObjectValueBatchSize;
+    NSUInteger capacity = MAX(1, MIN(rowRange.length, batchSize));
+    MBTableGridValue *values = malloc(capacity * sizeof(MBTableGridValue));
+    unsigned char *pending = malloc(capacity);
+    __strong id *objects = providesTypedValues ? NULL : (__strong id *)calloc(capacity, sizeof(id));
+    BOOL succeeded = (values != NULL && pending != NULL && (providesTypedValues || objects != NULL));
+    for (NSUInteger firstRow = rowRange.location; firstRow < NSMaxRange(rowRange) && succeeded; firstRow += batchSize) {
+        NSRange batchRows = NSMakeRange(firstRow, MIN(batchSize, NSMaxRange(rowRange) - firstRow));
+        unsigned char *matches = _filterMatches + firstRow;
+        memset(matches, 1, batchRows.length);
+        memset(pending, 0, batchRows.length);
+        NSUInteger i = 0;
+        while (i < _filterColumnCount) {
+            NSUInteger columnIndex = _filterColumns[i].columnIndex;
+            @autoreleasepool {
+                if (providesTypedValues) {
+                    [self _getValues:values forColumns:NSMakeRange(columnIndex, 1) dataSourceRows:batchRows];
+                } else {
+                    [self _getObjectValues:objects forColumns:NSMakeRange(columnIndex, 1) dataSourceRows:batchRows];
+                    for (NSUInteger j = 0; j < batchRows.length; j++) {
+                        values[j] = (objects[j] == MBTableGridPendingValue) ? MBTableGridValueMakePending() : MBValueForObject(objects[j]);
+                    }
+                }
+                for (NSUInteger j = 0; j < batchRows.length; j++) {
+                    pending[j] |= (values[j].type == MBTableGridValueTypePending);
+                }
+                for (; i < _filterColumnCount && _filterColumns[i].columnIndex == columnIndex; i++) {
+                    MBFilterBatch batch = { _filterColumns[i].condition, values, matches, batchRows.length };
+                    MBApplyConcurrently((batchRows.length + MBTableGridFilterChunkSize - 1) / MBTableGridFilterChunkSize, &batch, MBMarkFilterChunk);
+                }
+                // String values borrow from the objects until they've been tested
+                for (NSUInteger j = 0; objects && j < batchRows.length; j++) {
+                    objects[j] = nil;
+                }
+            }
+        }
+        for (NSUInteger j = 0; j < batchRows.length; j++) {
+            pending[j] &= matches[j];
+        }
+        succeeded = MBTableGridBitmapAssignBytes(_pendingFilterRows, batchRows.location, pending, batchRows.length);
+    }
+    free(values);
+    free(pending);
+    free(objects);
+    return succeeded;
+}
+
+// Rows kept while their values were pending are tested again once the values arrive,
+// and hidden if they don't pass after all
+- (void)_filterPendingDataSourceRows:(NSRange)rowRange columns:(NSIndexSet *)columnIndexes {
+    MBTableGridRowPermutation *permutation = self.rowPermutation;
+    BOOL filtersColumns = NO;
+    for (NSUInteger i = 0; i < _filterColumnCount; i++) {
+        filtersColumns = filtersColumns || [columnIndexes containsIndex:_filterColumns[i].columnIndex];
+    }
+    if (permutation == nil || !filtersColumns || MBTableGridBitmapCardinality(_pendingFilterRows) == 0)
+        return;
+
+    NSMutableIndexSet *hiddenRowIndexes = [NSMutableIndexSet indexSet];
+    BOOL succeeded = YES;
+    uint64_t row = MBTableGridBitmapNextMember(_pendingFilterRows, rowRange.location);
+    while (row != MBTableGridBitmapNotFound && row < NSMaxRange(rowRange) && succeeded) {
+        uint64_t end = MBTableGridBitmapNextNonMember(_pendingFilterRows, row);
+        if (end == MBTableGridBitmapNotFound || end > NSMaxRange(rowRange))
+            end = NSMaxRange(rowRange);
+        succeeded = [self _filterDataSourceRows:NSMakeRange((NSUInteger)row, (NSUInteger)(end - row))];
+        for (uint64_t dataSourceRowIndex = row; dataSourceRowIndex < end && succeeded; dataSourceRowIndex++) {
+            if (!_filterMatches[dataSourceRowIndex])
+                [hiddenRowIndexes addIndex:(NSUInteger)dataSourceRowIndex];
+        }
+        row = MBTableGridBitmapNextMember(_pendingFilterRows, end);
+    }
+    if (!succeeded || hiddenRowIndexes.count > MBTableGridSortRepairLimit) {
+        [self _orderRowsAgainReadingValues:!succeeded];
+        return;
+    }
+    if (hiddenRowIndexes.count == 0)
+        return;
+    // Hiding a row can leave its group empty or headed by another row
+    if (_groupTable) {
+        [self _orderRowsFromSortKeys];
+        return;
+    }
+
+    __block NSUInteger firstRow = NSNotFound;
+    [hiddenRowIndexes enumerateIndexesUsingBlock:^(NSUInteger dataSourceRowIndex, BOOL *stop) {
+        firstRow = MIN(firstRow, [permutation removeDataSourceRow:dataSourceRowIndex]);
+    }];
+    [self _noteRowsRemovedFromRow:firstRow];
+}
+
+// Counts and draws the rows again after some were taken out of the permutation shown,
+// from firstRow, the first of them, on
+- (void)_noteRowsRemovedFromRow:(NSUInteger)firstRow {
+    NSUInteger numberOfRows = self.rowPermutation.count;
+    _numberOfRows = numberOfRows;
+    _rowOffsetIndexIsValid = NO;
+    [self _cancelPrefetchedCells];
+    _findIndexIsValid = NO;
+    [(MBTableGridTextFinderClient *)_textFinderClient noteCellNumbersDidChange];
+    [_textFinder noteClientStringWillChange];
+    _selectedRowIndexes = [_selectedRowIndexes indexesPassingTest:^(NSUInteger idx, BOOL * stop) {
+        return (BOOL)(idx < numberOfRows);
+    }];
+    [self _noteAggregateRowsChanged];
+    [self _updateContentSize];
+
+    // Every row from the first one taken out has moved up
+    NSSize contentRectSize = contentView.frame.size;
+    CGFloat top = (firstRow > 0) ? NSMaxY([contentView rectOfRow:firstRow - 1]) : 0;
+    NSRect dirtyRect = NSMakeRect(0, top, contentRectSize.width, MAX(0, contentRectSize.height - top));
+    [contentView invalidateCachedTilesInRect:dirtyRect];
+    [rowHeaderView setNeedsDisplayInRect:NSMakeRect(0, top, NSWidth(rowHeaderView.bounds), NSHeight(dirtyRect))];
+    [rowFooterView setNeedsDisplayInRect:NSMakeRect(0, top, NSWidth(rowFooterView.bounds), NSHeight(dirtyRect))];
+    columnFooterView.needsDisplay = YES;
+}
+
+@end
@@ -0,0 +1,285 @@
+//
+//  MBTableGrid+Formulas.m
+//  MBTableGrid
+//
+//  Created by agent on 10/17/26.
+//
+
+#import "MBTableGrid+Private.h"
+#import "MBTableGridContentView.h"
+
+// Text entered in a cell is a formula if it starts with =
+static BOOL MBIsFormulaValue(const MBTableGridValue *value) {
+    return value->type == MBTableGridValueTypeString && value->data.string.length > 1 && value->data.string.bytes[0] == '=';
+}
+
+// Keeps a cell's formula in step with a value written to it, with the formula lock held:
+// formulas are compiled, and anything else takes the place of the cell's formula
+static void MBNoteFormulaValue(MBTableGridFormulaSheet *sheet, NSUInteger columnIndex, NSUInteger rowIndex, const MBTableGridValue *value) {
+    MBTableGridFormulaSheetNoteChange(sheet, columnIndex, rowIndex, 1);
+    if (!MBIsFormulaValue(value) ||
+        !MBTableGridFormulaSheetSetFormula(sheet, columnIndex, rowIndex, value->data.string.bytes, value->data.string.length))
+        MBTableGridFormulaSheetRemoveFormula(sheet, columnIndex, rowIndex);
+}
+
+// How a formula's result is shown: errors as their text, which is static
+static MBTableGridValue MBValueForFormulaResult(const MBTableGridFormulaValue *result) {
+    if (result->error == MBTableGridFormulaErrorNone)
+        return result->value;
+    const char *text = MBTableGridFormulaErrorString(result->error);
+    return MBTableGridValueMakeString(text, strlen(text));
+}
+
+// The state of a recalculation, which reads cells for the formula sheet and gathers the
+// data source rows of each column whose results changed
+typedef struct MBFormulaRecalculation {
+    __unsafe_unretained MBTableGrid *tableGrid;
+    __unsafe_unretained NSMutableData *strings;
+    __unsafe_unretained NSMutableDictionary<NSNumber *, NSMutableIndexSet *> *changedRows;
+} MBFormulaRecalculation;
+
+static bool MBReadFormulaValues(void *context, size_t column, size_t firstRow, size_t count, MBTableGridValue *values) {
+    const MBFormulaRecalculation *recalculation = context;
+    return [recalculation->tableGrid _readFormulaValues:values forColumn:column dataSourceRows:NSMakeRange(firstRow, count)
+                                                strings:recalculation->strings];
+}
+
+static void MBNoteFormulaResultChanged(void *context, size_t column, size_t row) {
+    const MBFormulaRecalculation *recalculation = context;
+    NSMutableIndexSet *rows = recalculation->changedRows[@(column)];
+    if (rows == nil) {
+        rows = [NSMutableIndexSet indexSet];
+        recalculation->changedRows[@(column)] = rows;
+    }
+    [rows addIndex:row];
+}
+
+@implementation MBTableGrid (Formulas)
+
+- (BOOL)evaluatesFormulas {
+    return _evaluatesFormulas;
+}
+
+- (void)setEvaluatesFormulas:(BOOL)evaluatesFormulas {
+    if (evaluatesFormulas == _evaluatesFormulas)
+        return;
+    _evaluatesFormulas = evaluatesFormulas;
+    [self removeAllFormulas];
+}
+
+// The sheet's columns are the data source's, as its rows are
+- (BOOL)setFormula:(NSString *)formula forColumn:(NSUInteger)columnIndex dataSourceRow:(NSUInteger)rowIndex {
+    if (_formulaSheet == NULL)
+        return NO;
+    columnIndex = [self dataSourceColumnForColumn:columnIndex];
+    const char *bytes = formula.UTF8String ?: "";
+    size_t length = strlen(bytes);
+    os_unfair_lock_lock(&_formulaLock);
+    MBTableGridFormulaSheetNoteChange(_formulaSheet, columnIndex, rowIndex, 1);
+    BOOL succeeded = (length > 0) && MBTableGridFormulaSheetSetFormula(_formulaSheet, columnIndex, rowIndex, bytes, length);
+    if (!succeeded)
+        MBTableGridFormulaSheetRemoveFormula(_formulaSheet, columnIndex, rowIndex);
+    os_unfair_lock_unlock(&_formulaLock);
+    [self _recalculateFormulas];
+    return succeeded;
+}
+
+- (NSString *)formulaForColumn:(NSUInteger)columnIndex dataSourceRow:(NSUInteger)rowIndex {
+    if (_formulaSheet == NULL)
+        return nil;
+    columnIndex = [self dataSourceColumnForColumn:columnIndex];
+    NSString *formula = nil;
+    os_unfair_lock_lock(&_formulaLock);
+    size_t length = 0;
+    const char *text = MBTableGridFormulaSheetGetText(_formulaSheet, columnIndex, rowIndex, &length);
+    if (text)
+        formula = [[NSString alloc] initWithBytes:text length:length encoding:NSUTF8StringEncoding];
+    os_unfair_lock_unlock(&_formulaLock);
+    return formula;
+}
+
+// Starts again with no formulas, and shows the data source's values
+- (void)removeAllFormulas {
+    os_unfair_lock_lock(&_formulaLock);
+    MBTableGridFormulaSheetDestroy(_formulaSheet);
+    _formulaSheet = _evaluatesFormulas ? MBTableGridFormulaSheetCreate() : NULL;
+    os_unfair_lock_unlock(&_formulaLock);
+    [self reloadData];
+}
+
+// Reads cells of a data source column for the formula sheet from the data source as
+// they are, with formulas' text, which the sheet replaces with their results itself.
+// Cells outside the grid are left empty. Strings from object values are copied into
+// strings, as offsets until it stops growing.
+- (BOOL)_readFormulaValues:(MBTableGridValue *)values forColumn:(NSUInteger)columnIndex dataSourceRows:(NSRange)rowRange
+                   strings:(NSMutableData *)strings {
+    if (columnIndex >= _numberOfColumns || rowRange.location >= _numberOfDataSourceRows)
+        return YES;
+    rowRange.length = MIN(rowRange.length, _numberOfDataSourceRows - rowRange.location);
+    NSRange columnRange = NSMakeRange(columnIndex, 1);
+    if ([self _providesTypedValues]) {
+        [self.dataSource tableGrid:self getValues:values forColumns:columnRange rows:rowRange];
+        return YES;
+    }
+    __strong id *objects = (__strong id *)calloc(rowRange.length, sizeof(id));
+    if (objects == NULL)
+        return NO;
+    strings.length = 0;
+    @autoreleasepool {
+        if ([self _providesObjectValuesInBulk]) {
+            [self.dataSource tableGrid:self getObjectValues:objects forColumns:columnRange rows:rowRange];
+        } else if ([self.dataSource respondsToSelector:@selector(tableGrid:objectValueForColumn:row:)]) {
+            for (NSUInteger i = 0; i < rowRange.length; i++) {
+                objects[i] = [self.dataSource tableGrid:self objectValueForColumn:columnIndex row:rowRange.location + i];
+            }
+        }
+        for (NSUInteger i = 0; i < rowRange.length; i++) {
+            MBTableGridValue value = (objects[i] == MBTableGridPendingValue) ? MBTableGridValueMakePending() : MBValueForObject(objects[i]);
+            if (value.type == MBTableGridValueTypeString) {
+                size_t offset = strings.length;
+                [strings appendBytes:value.data.string.bytes length:value.data.string.length];
+                value.data.string.bytes = (const char *)(uintptr_t)offset;
+            }
+            values[i] = value;
+            objects[i] = nil;
+        }
+    }
+    free(objects);
+
+    const char *bytes = strings.bytes;
+    for (NSUInteger i = 0; i < rowRange.length; i++) {
+        if (values[i].type == MBTableGridValueTypeString)
+            values[i].data.string.bytes = bytes + (uintptr_t)values[i].data.string.bytes;
+    }
+    return YES;
+}
+
+// For values the grid has written to the data source, laid out column by column
+- (void)_noteFormulaValues:(const MBTableGridValue *)values forColumns:(NSRange)columnRange dataSourceRows:(NSRange)rowRange {
+    if (_formulaSheet == NULL)
+        return;
+    os_unfair_lock_lock(&_formulaLock);
+    for (NSUInteger i = 0; i < columnRange.length; i++) {
+        for (NSUInteger j = 0; j < rowRange.length; j++) {
+            MBNoteFormulaValue(_formulaSheet, columnRange.location + i, rowRange.location + j, &values[i * rowRange.length + j]);
+        }
+    }
+    os_unfair_lock_unlock(&_formulaLock);
+}
+
+- (void)_noteFormulaObject:(id)value forColumns:(NSIndexSet *)columnIndexes dataSourceRows:(NSIndexSet *)dataSourceRowIndexes {
+    if (_formulaSheet == NULL)
+        return;
+    @autoreleasepool {
+        MBTableGridValue typedValue = MBValueForObject(value);
+        os_unfair_lock_lock(&_formulaLock);
+        [columnIndexes enumerateIndexesUsingBlock:^(NSUInteger columnIndex, BOOL *stopColumns) {
+            [dataSourceRowIndexes enumerateIndexesUsingBlock:^(NSUInteger rowIndex, BOOL *stopRows) {
+                MBNoteFormulaValue(_formulaSheet, columnIndex, rowIndex, &typedValue);
+            }];
+        }];
+        os_unfair_lock_unlock(&_formulaLock);
+    }
+}
+
+// Evaluates the formulas that depend on the cells changed since the last time, then
+// redraws, indexes, summarizes and sorts again only the cells whose results changed.
+// The lock is held throughout, so the data source mustn't read the grid's cells.
+- (void)_recalculateFormulas {
+    if (_formulaSheet == NULL)
+        return;
+    NSMutableDictionary<NSNumber *, NSMutableIndexSet *> *changedRows = [NSMutableDictionary dictionary];
+    MBFormulaRecalculation recalculation = { self, [NSMutableData data], changedRows };
+    os_unfair_lock_lock(&_formulaLock);
+    BOOL succeeded = MBTableGridFormulaSheetRecalculate(_formulaSheet, MBReadFormulaValues, MBNoteFormulaResultChanged,
+                                                        &recalculation, MBApplyConcurrently);
+    os_unfair_lock_unlock(&_formulaLock);
+    if (!succeeded)
+        NSLog(@"WARNING: MBTableGrid could not evaluate %lu formulas", (unsigned long)MBTableGridFormulaSheetCount(_formulaSheet));
+
+    [changedRows enumerateKeysAndObjectsUsingBlock:^(NSNumber *column, NSMutableIndexSet *dataSourceRowIndexes, BOOL *stop) {
+        if (column.unsignedIntegerValue >= _numberOfColumns)
+            return;
+        NSUInteger columnIndex = [self columnForDataSourceColumn:column.unsignedIntegerValue];
+        [dataSourceRowIndexes removeIndexesInRange:NSMakeRange(_numberOfDataSourceRows, NSNotFound - _numberOfDataSourceRows)];
+        NSIndexSet *columnIndexes = [NSIndexSet indexSetWithIndex:columnIndex];
+        NSIndexSet *rowIndexes = [self _rowIndexesForDataSourceRowIndexes:dataSourceRowIndexes];
+        [rowIndexes enumerateIndexesUsingBlock:^(NSUInteger rowIndex, BOOL *stopRows) {
+            [contentView invalidateCachedTilesInRect:[contentView frameOfCellAtColumn:columnIndex row:rowIndex]];
+        }];
+        [self _updateFindIndexForColumns:columnIndexes rows:rowIndexes];
+        [self _updateAggregatesForColumns:columnIndexes rows:rowIndexes dataSourceRows:dataSourceRowIndexes];
+        [self _repairSortForDataSourceRows:dataSourceRowIndexes columns:columnIndexes];
+    }];
+}
+
+// Puts the results of formulas in place of the text the data source keeps for them.
+// Result strings change as soon as the sheet is recalculated, so they're copied, into
+// a buffer of the thread's sized for all of them first.
+- (void)_getFormulaResults:(MBTableGridValue *)values forColumns:(NSRange)columnRange dataSourceRows:(NSRange)rowRange {
+    os_unfair_lock_lock(&_formulaLock);
+    size_t stringLength = 0;
+    BOOL hasFormulas = NO;
+    for (NSUInteger i = 0; i < columnRange.length; i++) {
+        if (!MBTableGridFormulaSheetColumnHasFormulas(_formulaSheet, columnRange.location + i))
+            continue;
+        hasFormulas = YES;
+        for (NSUInteger j = 0; j < rowRange.length; j++) {
+            MBTableGridFormulaValue result;
+            if (MBTableGridFormulaSheetGetResult(_formulaSheet, columnRange.location + i, rowRange.location + j, &result) &&
+                result.error == MBTableGridFormulaErrorNone && result.value.type == MBTableGridValueTypeString)
+                stringLength += result.value.data.string.length;
+        }
+    }
+    if (hasFormulas) {
+        NSMutableData *strings = [self _nextStringBufferForKey:_formulaStringBufferKey];
+        strings.length = stringLength;
+        char *bytes = strings.mutableBytes;
+        for (NSUInteger i = 0; i < columnRange.length; i++) {
+            if (!MBTableGridFormulaSheetColumnHasFormulas(_formulaSheet, columnRange.location + i))
+                continue;
+            for (NSUInteger j = 0; j < rowRange.length; j++) {
+                MBTableGridFormulaValue result;
+                if (!MBTableGridFormulaSheetGetResult(_formulaSheet, columnRange.location + i, rowRange.location + j, &result))
+                    continue;
+                MBTableGridValue value = MBValueForFormulaResult(&result);
+                if (result.error == MBTableGridFormulaErrorNone && value.type == MBTableGridValueTypeString) {
+                    if (value.data.string.length)
+                        memcpy(bytes, value.data.string.bytes, value.data.string.length);
+                    value.data.string.bytes = bytes;
+                    bytes += value.data.string.length;
+                }
+                values[i * rowRange.length + j] = value;
+            }
+        }
+    }
+    os_unfair_lock_unlock(&_formulaLock);
+}
+
+// The object form of _getFormulaResults:, with strings copied into objects of their own
+- (void)_getFormulaObjects:(id __strong *)values forColumns:(NSRange)columnRange dataSourceRows:(NSRange)rowRange {
+    os_unfair_lock_lock(&_formulaLock);
+    for (NSUInteger i = 0; i < columnRange.length; i++) {
+        if (!MBTableGridFormulaSheetColumnHasFormulas(_formulaSheet, columnRange.location + i))
+            continue;
+        for (NSUInteger j = 0; j < rowRange.length; j++) {
+            MBTableGridFormulaValue result;
+            if (!MBTableGridFormulaSheetGetResult(_formulaSheet, columnRange.location + i, rowRange.location + j, &result))
+                continue;
+            MBTableGridValue value = MBValueForFormulaResult(&result);
+            id object;
+            if (value.type == MBTableGridValueTypePending) {
+                object = MBTableGridPendingValue;
+            } else if (value.type == MBTableGridValueTypeString) {
+                object = [[NSString alloc] initWithBytes:value.data.string.bytes length:value.data.string.length
+                                                encoding:NSUTF8StringEncoding];
+            } else {
+                object = [self _objectForValue:&value];
+            }
+            values[i * rowRange.length + j] = object;
+        }
+    }
+    os_unfair_lock_unlock(&_formulaLock);
+}
+
+@end
@@ -0,0 +1,476 @@
+//
+//  MBTableGrid+Grouping.m
+//  MBTableGrid
+//
+//  Created by agent on 10/17/26.
+//
+
+#import "MBTableGrid+Private.h"
+#import "MBTableGridFooterView.h"
+
+typedef struct MBGroupedRowContext {
+    MBSortRowContext sortRow;
+    const uint32_t *groups;
+    const uint32_t *ranks;
+} MBGroupedRowContext;
+
+// Orders grouped rows as they're shown: by where their group is, and then as
+// MBCompareSortRow does
+static int MBCompareGroupedRow(void *context, size_t dataSourceRow) {
+    MBGroupedRowContext *groupedRow = context;
+    uint32_t rank = groupedRow->ranks[groupedRow->groups[dataSourceRow]];
+    uint32_t sortRank = groupedRow->ranks[groupedRow->groups[groupedRow->sortRow.dataSourceRow]];
+    if (rank != sortRank)
+        return (rank > sortRank) - (rank < sortRank);
+    return MBCompareSortRow(&groupedRow->sortRow, dataSourceRow);
+}
+
+@implementation MBTableGrid (Grouping)
+
+- (BOOL)groupRowsByColumn:(NSUInteger)columnIndex {
+    // Selected rows stay selected if they are still shown
+    NSIndexSet *selectedDataSourceRowIndexes = [self _dataSourceRowIndexesForRowIndexes:self.selectedRowIndexes];
+    if (columnIndex >= _numberOfColumns)
+        columnIndex = NSNotFound;
+    // Group numbers, and so which groups are collapsed, belong to the column
+    if (columnIndex != _groupColumnIndex)
+        [self _clearGroups];
+    _groupColumnIndex = columnIndex;
+    BOOL succeeded = YES;
+    if (columnIndex != NSNotFound) {
+        succeeded = [self _readAllGroups];
+        if (!succeeded) {
+            NSLog(@"WARNING: MBTableGrid could not group %lu rows", (unsigned long)_numberOfDataSourceRows);
+            [self _clearGroups];
+        }
+    }
+    succeeded = [self _orderRowsFromSortKeys] && succeeded;
+    self.selectedRowIndexes = [self _rowIndexesForDataSourceRowIndexes:selectedDataSourceRowIndexes];
+    return succeeded;
+}
+
+- (NSUInteger)groupColumnIndex {
+    return _groupColumnIndex;
+}
+
+- (NSUInteger)numberOfGroups {
+    return _groupRunCount;
+}
+
+- (NSUInteger)groupOfRow:(NSUInteger)rowIndex {
+    if (_groupRunCount == 0 || rowIndex >= _numberOfRows)
+        return NSNotFound;
+    // The last group starting at or before the row
+    NSUInteger low = 0, high = _groupRunCount;
+    while (high - low > 1) {
+        NSUInteger middle = low + (high - low) / 2;
+        if (_groupRuns[middle].firstRow <= rowIndex)
+            low = middle;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+- (NSRange)rowRangeOfGroup:(NSUInteger)groupIndex {
+    if (groupIndex >= _groupRunCount)
+        return NSMakeRange(NSNotFound, 0);
+    return NSMakeRange(_groupRuns[groupIndex].firstRow, _groupRuns[groupIndex].rowCount);
+}
+
+- (NSUInteger)numberOfRowsInGroup:(NSUInteger)groupIndex {
+    return (groupIndex < _groupRunCount) ? _groupRuns[groupIndex].groupedRowCount : 0;
+}
+
+// Strings are copied out of the table, which moves them as it grows
+- (id)keyOfGroup:(NSUInteger)groupIndex {
+    if (groupIndex >= _groupRunCount)
+        return nil;
+    MBTableGridValue key = MBTableGridGroupTableKey(_groupTable, _groupRuns[groupIndex].group);
+    if (key.type == MBTableGridValueTypeString)
+        return [[NSString alloc] initWithBytes:key.data.string.bytes length:key.data.string.length encoding:NSUTF8StringEncoding];
+    return [self _objectForValue:&key];
+}
+
+- (BOOL)isGroupCollapsed:(NSUInteger)groupIndex {
+    return (groupIndex < _groupRunCount && [_collapsedGroups containsIndex:_groupRuns[groupIndex].group]);
+}
+
+- (void)setGroup:(NSUInteger)groupIndex collapsed:(BOOL)collapsed {
+    if (groupIndex >= _groupRunCount || [self isGroupCollapsed:groupIndex] == collapsed)
+        return;
+    if (collapsed) {
+        [_collapsedGroups addIndex:_groupRuns[groupIndex].group];
+    } else {
+        [_collapsedGroups removeIndex:_groupRuns[groupIndex].group];
+    }
+    [self _showGroupsAgain];
+}
+
+- (void)setAllGroupsCollapsed:(BOOL)collapsed {
+    if (_groupTable == NULL)
+        return;
+    [_collapsedGroups removeAllIndexes];
+    for (NSUInteger i = 0; collapsed && i < _groupRunCount; i++) {
+        [_collapsedGroups addIndex:_groupRuns[i].group];
+    }
+    [self _showGroupsAgain];
+}
+
+- (MBTableGridAggregate)aggregateForGroup:(NSUInteger)groupIndex column:(NSUInteger)columnIndex {
+    MBTableGridAggregate aggregate = MBTableGridAggregateMakeEmpty();
+    if (groupIndex >= _groupRunCount || columnIndex >= _numberOfColumns)
+        return aggregate;
+    const MBTableGridAggregate *aggregates = [self _groupAggregatesForColumn:columnIndex];
+    if (aggregates)
+        return aggregates[_groupRuns[groupIndex].group];
+
+    // Without memory for every group's summary, the group's rows are read one at a time
+    if (![self _copyGroupedDataSourceRows])
+        return aggregate;
+    const MBGroupRun *run = &_groupRuns[groupIndex];
+    for (NSUInteger i = 0; i < run->groupedRowCount; i++) {
+        MBTableGridValue value;
+        if ([self _getAggregateValues:&value forColumn:columnIndex dataSourceRows:NSMakeRange(_groupedDataSourceRows[run->firstGroupedRow + i], 1)])
+            MBTableGridAggregateAddValues(&aggregate, &value, 1);
+    }
+    return aggregate;
+}
+
+- (MBTableGridAggregateFunction)groupFooterAggregateFunction {
+    return _groupFooterAggregateFunction;
+}
+
+- (void)setGroupFooterAggregateFunction:(MBTableGridAggregateFunction)function {
+    _groupFooterAggregateFunction = function;
+    if (function != MBTableGridAggregateFunctionNone)
+        self.rowFooterVisible = YES;
+    rowFooterView.needsDisplay = YES;
+}
+
+- (NSUInteger)groupFooterColumnIndex {
+    return _groupFooterColumnIndex;
+}
+
+- (void)setGroupFooterColumnIndex:(NSUInteger)columnIndex {
+    _groupFooterColumnIndex = columnIndex;
+    rowFooterView.needsDisplay = YES;
+}
+
+- (void)_clearGroups {
+    MBTableGridGroupTableDestroy(_groupTable);
+    _groupTable = NULL;
+    free(_dataSourceRowGroups);
+    _dataSourceRowGroups = NULL;
+    free(_groupedDataSourceRows);
+    _groupedDataSourceRows = NULL;
+    _groupedRowCount = 0;
+    free(_groupRuns);
+    _groupRuns = NULL;
+    _groupRunCount = 0;
+    _collapsedGroups = nil;
+    [self _clearGroupAggregates];
+    _groupColumnIndex = NSNotFound;
+}
+
+// Numbers every data source row's value in the grouping column, keeping the numbers
+// given before so that collapsed groups stay collapsed. Returns NO if out of memory.
+- (BOOL)_readAllGroups {
+    if (_groupTable == NULL) {
+        _groupTable = MBTableGridGroupTableCreate();
+        _collapsedGroups = [NSMutableIndexSet indexSet];
+        if (_groupTable == NULL)
+            return NO;
+    }
+    uint32_t *groups = realloc(_dataSourceRowGroups, MAX(1, _numberOfDataSourceRows) * sizeof(uint32_t));
+    if (groups == NULL)
+        return NO;
+    _dataSourceRowGroups = groups;
+    return [self _readGroupsForDataSourceRows:NSMakeRange(0, _numberOfDataSourceRows)];
+}
+
+// Reads the grouping column for some data source rows a batch at a time, looking each
+// batch up in the group table on every processor
+- (BOOL)_readGroupsForDataSourceRows:(NSRange)rowRange {
+    NSRange columnRange = NSMakeRange(_groupColumnIndex, 1);
+    BOOL providesTypedValues = [self _providesTypedValues];
+    NSUInteger batchSize = providesTypedValues ? MBTableGridExportBatchSize : MBTableGridObjectValueBatchSize;
+    NSUInteger capacity = MAX(1, MIN(rowRange.length, batchSize));
+    MBTableGridValue *values = malloc(capacity * sizeof(MBTableGridValue));
+    __strong id *objects = providesTypedValues ? NULL : (__strong id *)calloc(capacity, sizeof(id));
+    BOOL succeeded = (values != NULL && (providesTypedValues || objects != NULL));
+    for (NSUInteger firstRow = rowRange.location; firstRow < NSMaxRange(rowRange) && succeeded; firstRow += batchSize) {
+        NSRange batchRows = NSMakeRange(firstRow, MIN(batchSize, NSMaxRange(rowRange) - firstRow));
+        @autoreleasepool {
+            if (providesTypedValues) {
+                [self _getValues:values forColumns:columnRange dataSourceRows:batchRows];
+            } else {
+                [self _getObjectValues:objects forColumns:columnRange dataSourceRows:batchRows];
+                for (NSUInteger i = 0; i < batchRows.length; i++) {
+                    values[i] = MBValueForObject(objects[i]);
+                }
+            }
+            succeeded = MBTableGridGroupTableAssign(_groupTable, values, batchRows.length,
+                                                    _dataSourceRowGroups + batchRows.location, MBApplyConcurrently);
+            // String values borrow from the objects until the table has copied them
+            for (NSUInteger i = 0; objects && i < batchRows.length; i++) {
+                objects[i] = nil;
+            }
+        }
+    }
+    free(values);
+    free(objects);
+    return succeeded;
+}
+
+// Gathers rows, in the order given, into groups ranked by where each group's first row
+// is, and keeps them to show collapsed groups from. Takes ownership of dataSourceRows.
+// Returns nil if out of memory.
+- (MBTableGridRowPermutation *)_rowPermutationGroupingDataSourceRows:(size_t *)dataSourceRows count:(NSUInteger)count {
+    size_t groupCount = MBTableGridGroupTableCount(_groupTable);
+    uint32_t *ranks = malloc(MAX(1, groupCount) * sizeof(uint32_t));
+    size_t *groupedDataSourceRows = malloc(MAX(1, count) * sizeof(size_t));
+    MBGroupRun *runs = calloc(MAX(1, groupCount), sizeof(MBGroupRun));
+    if (ranks == NULL || groupedDataSourceRows == NULL || runs == NULL) {
+        free(ranks);
+        free(groupedDataSourceRows);
+        free(runs);
+        free(dataSourceRows);
+        return nil;
+    }
+    memset(ranks, 0xff, groupCount * sizeof(uint32_t));
+    NSUInteger runCount = 0;
+    for (NSUInteger i = 0; i < count; i++) {
+        uint32_t group = _dataSourceRowGroups[dataSourceRows[i]];
+        if (ranks[group] == MBTableGridGroupNone) {
+            ranks[group] = (uint32_t)runCount;
+            runs[runCount++].group = group;
+        }
+        runs[ranks[group]].groupedRowCount++;
+    }
+    NSUInteger firstGroupedRow = 0;
+    for (NSUInteger i = 0; i < runCount; i++) {
+        runs[i].firstGroupedRow = firstGroupedRow;
+        firstGroupedRow += runs[i].groupedRowCount;
+        runs[i].groupedRowCount = 0;
+    }
+    for (NSUInteger i = 0; i < count; i++) {
+        MBGroupRun *run = &runs[ranks[_dataSourceRowGroups[dataSourceRows[i]]]];
+        groupedDataSourceRows[run->firstGroupedRow + run->groupedRowCount++] = dataSourceRows[i];
+    }
+    free(ranks);
+    free(dataSourceRows);
+
+    free(_groupedDataSourceRows);
+    _groupedDataSourceRows = groupedDataSourceRows;
+    _groupedRowCount = count;
+    free(_groupRuns);
+    _groupRuns = runs;
+    _groupRunCount = runCount;
+    // Rows may have joined or left groups
+    [self _clearGroupAggregates];
+    return [self _rowPermutationFromGroups];
+}
+
+// Moves edited rows, already in the permutation shown at previousRows, to where their
+// keys and groups now put them: each is taken out of its old group's run and put back
+// into its new one's by a binary search, and only the runs' counts and starts change.
+// While no group is collapsed the permutation holds every grouped row, so the grouped
+// rows are left to it, to be copied out when they're next needed. Returns NO, perhaps
+// with some rows moved, if the groups' order could change, as when a group's first row
+// leaves it or a row goes before it, or if out of memory; the rows must then be
+// grouped again.
+- (BOOL)_repairGroupsForDataSourceRows:(NSIndexSet *)dataSourceRowIndexes previousRows:(NSArray<NSNumber *> *)previousRows {
+    MBTableGridRowPermutation *permutation = self.rowPermutation;
+    // Rows the grid's order leaves tied don't compare by data source row
+    if (_collapsedGroups.count || (_sortColumnCount == 0 && _rowOrder) || permutation.count != _groupedRowCount)
+        return NO;
+    size_t groupCount = MBTableGridGroupTableCount(_groupTable);
+    uint32_t *ranks = malloc(MAX(1, groupCount) * sizeof(uint32_t));
+    NSUInteger *previousRuns = malloc(MAX(1, dataSourceRowIndexes.count) * sizeof(NSUInteger));
+    if (ranks == NULL || previousRuns == NULL) {
+        free(ranks);
+        free(previousRuns);
+        return NO;
+    }
+    memset(ranks, 0xff, groupCount * sizeof(uint32_t));
+    for (NSUInteger i = 0; i < _groupRunCount; i++) {
+        ranks[_groupRuns[i].group] = (uint32_t)i;
+    }
+
+    // A group that gains its first row, or a row's new group, if it has none yet, is
+    // ranked anew
+    __block BOOL succeeded = YES;
+    __block NSUInteger i = 0;
+    [dataSourceRowIndexes enumerateIndexesUsingBlock:^(NSUInteger dataSourceRowIndex, BOOL *stop) {
+        NSUInteger previousRow = previousRows[i].unsignedIntegerValue;
+        NSUInteger run = (previousRow == NSNotFound) ? NSNotFound : [self groupOfRow:previousRow];
+        succeeded = (run != NSNotFound && self->_groupRuns[run].firstRow != previousRow &&
+                     ranks[self->_dataSourceRowGroups[dataSourceRowIndex]] != MBTableGridGroupNone);
+        previousRuns[i++] = run;
+        *stop = !succeeded;
+    }];
+    if (!succeeded) {
+        free(ranks);
+        free(previousRuns);
+        return NO;
+    }
+
+    [dataSourceRowIndexes enumerateIndexesUsingBlock:^(NSUInteger dataSourceRowIndex, BOOL *stop) {
+        [permutation removeDataSourceRow:dataSourceRowIndex];
+    }];
+    __block MBGroupedRowContext context = { { _sortColumns, _sortColumnCount, 0 }, _dataSourceRowGroups, ranks };
+    __block BOOL changesGroups = NO;
+    i = 0;
+    [dataSourceRowIndexes enumerateIndexesUsingBlock:^(NSUInteger dataSourceRowIndex, BOOL *stop) {
+        NSUInteger run = ranks[self->_dataSourceRowGroups[dataSourceRowIndex]];
+        context.sortRow.dataSourceRow = dataSourceRowIndex;
+        succeeded = ([permutation insertDataSourceRow:dataSourceRowIndex compareFunction:MBCompareGroupedRow context:&context] != NSNotFound);
+        self->_groupRuns[previousRuns[i]].groupedRowCount--;
+        self->_groupRuns[run].groupedRowCount++;
+        changesGroups = changesGroups || (run != previousRuns[i]);
+        i++;
+        *stop = !succeeded;
+    }];
+    free(previousRuns);
+    if (!succeeded) {
+        free(ranks);
+        return NO;
+    }
+    NSUInteger firstRow = 0;
+    for (NSUInteger run = 0; run < _groupRunCount; run++) {
+        _groupRuns[run].firstRow = _groupRuns[run].firstGroupedRow = firstRow;
+        _groupRuns[run].rowCount = _groupRuns[run].groupedRowCount;
+        firstRow += _groupRuns[run].rowCount;
+    }
+    [dataSourceRowIndexes enumerateIndexesUsingBlock:^(NSUInteger dataSourceRowIndex, BOOL *stop) {
+        NSUInteger run = ranks[self->_dataSourceRowGroups[dataSourceRowIndex]];
+        succeeded = ([permutation rowForDataSourceRow:dataSourceRowIndex] != self->_groupRuns[run].firstRow);
+        *stop = !succeeded;
+    }];
+    free(ranks);
+    if (!succeeded)
+        return NO;
+
+    free(_groupedDataSourceRows);
+    _groupedDataSourceRows = NULL;
+    if (changesGroups) {
+        [self _clearGroupAggregates];
+        rowFooterView.needsDisplay = YES;
+    }
+    return YES;
+}
+
+// The grouped rows, in the order shown, are copied out of the permutation if an edit
+// left them there. Returns NO if out of memory.
+- (BOOL)_copyGroupedDataSourceRows {
+    if (_groupedDataSourceRows)
+        return YES;
+    MBTableGridRowPermutation *permutation = self.rowPermutation;
+    if (permutation.count != _groupedRowCount)
+        return NO;
+    size_t *dataSourceRows = malloc(MAX(1, _groupedRowCount) * sizeof(size_t));
+    if (dataSourceRows == NULL)
+        return NO;
+    [permutation getDataSourceRows:dataSourceRows inRows:NSMakeRange(0, _groupedRowCount)];
+    _groupedDataSourceRows = dataSourceRows;
+    return YES;
+}
+
+// Shows every grouped row but those after the first of a collapsed group, without
+// reading or sorting anything. Returns nil if out of memory.
+- (MBTableGridRowPermutation *)_rowPermutationFromGroups {
+    if (![self _copyGroupedDataSourceRows])
+        return nil;
+    size_t *dataSourceRows = malloc(MAX(1, _groupedRowCount) * sizeof(size_t));
+    if (dataSourceRows == NULL)
+        return nil;
+    if (_collapsedGroups.count == 0) {
+        memcpy(dataSourceRows, _groupedDataSourceRows, _groupedRowCount * sizeof(size_t));
+        for (NSUInteger i = 0; i < _groupRunCount; i++) {
+            _groupRuns[i].firstRow = _groupRuns[i].firstGroupedRow;
+            _groupRuns[i].rowCount = _groupRuns[i].groupedRowCount;
+        }
+        return [[MBTableGridRowPermutation alloc] initWithDataSourceRows:dataSourceRows count:_groupedRowCount];
+    }
+    NSUInteger count = 0;
+    for (NSUInteger i = 0; i < _groupRunCount; i++) {
+        MBGroupRun *run = &_groupRuns[i];
+        run->firstRow = count;
+        run->rowCount = [_collapsedGroups containsIndex:run->group] ? MIN(1, run->groupedRowCount) : run->groupedRowCount;
+        memcpy(dataSourceRows + count, _groupedDataSourceRows + run->firstGroupedRow, run->rowCount * sizeof(size_t));
+        count += run->rowCount;
+    }
+    return [[MBTableGridRowPermutation alloc] initWithDataSourceRows:dataSourceRows count:count];
+}
+
+// Selected rows that are still shown stay selected
+- (void)_showGroupsAgain {
+    NSIndexSet *selectedDataSourceRowIndexes = [self _dataSourceRowIndexesForRowIndexes:self.selectedRowIndexes];
+    MBTableGridRowPermutation *permutation = [self _rowPermutationFromGroups];
+    if (permutation) {
+        [self _setRowPermutation:permutation];
+    } else {
+        // The groups may have been left half shown
+        [self _orderRowsFromSortKeys];
+    }
+    self.selectedRowIndexes = [self _rowIndexesForDataSourceRowIndexes:selectedDataSourceRowIndexes];
+}
+
+// Every group's summary of a column, by group number, built on first use from one read
+// of the column in the data source's order. NULL if memory runs out.
+- (const MBTableGridAggregate *)_groupAggregatesForColumn:(NSUInteger)columnIndex {
+    if (_groupAggregates == NULL) {
+        _groupAggregates = calloc(MAX(1, _numberOfColumns), sizeof(MBTableGridAggregate *));
+        if (_groupAggregates == NULL)
+            return NULL;
+        _groupAggregateColumnCount = _numberOfColumns;
+    }
+    if (columnIndex >= _groupAggregateColumnCount)
+        return NULL;
+    if (_groupAggregates[columnIndex])
+        return _groupAggregates[columnIndex];
+
+    size_t groupCount = MBTableGridGroupTableCount(_groupTable);
+    NSUInteger numberOfRows = _numberOfDataSourceRows;
+    NSUInteger capacity = MAX(1, MIN(numberOfRows, MBTableGridExportBatchSize));
+    MBTableGridAggregate *aggregates = malloc(MAX(1, groupCount) * sizeof(MBTableGridAggregate));
+    MBTableGridValue *values = malloc(capacity * sizeof(MBTableGridValue));
+    // Rows the filter hides belong to no group
+    uint32_t *groups = _filterMatches ? malloc(capacity * sizeof(uint32_t)) : NULL;
+    BOOL succeeded = (aggregates != NULL && values != NULL && (_filterMatches == NULL || groups != NULL));
+    for (size_t group = 0; group < groupCount && succeeded; group++) {
+        aggregates[group] = MBTableGridAggregateMakeEmpty();
+    }
+    for (NSUInteger firstRow = 0; firstRow < numberOfRows && succeeded; firstRow += MBTableGridExportBatchSize) {
+        NSRange batchRows = NSMakeRange(firstRow, MIN(MBTableGridExportBatchSize, numberOfRows - firstRow));
+        const uint32_t *batchGroups = _dataSourceRowGroups + firstRow;
+        if (groups) {
+            for (NSUInteger i = 0; i < batchRows.length; i++) {
+                groups[i] = _filterMatches[firstRow + i] ? batchGroups[i] : MBTableGridGroupNone;
+            }
+            batchGroups = groups;
+        }
+        succeeded = [self _getAggregateValues:values forColumn:columnIndex dataSourceRows:batchRows] &&
+                    MBTableGridGroupAggregate(batchGroups, values, batchRows.length, aggregates, groupCount, MBApplyConcurrently);
+    }
+    free(values);
+    free(groups);
+    if (!succeeded) {
+        free(aggregates);
+        return NULL;
+    }
+    _groupAggregates[columnIndex] = aggregates;
+    return aggregates;
+}
+
+- (void)_clearGroupAggregates {
+    for (NSUInteger i = 0; i < _groupAggregateColumnCount; i++) {
+        free(_groupAggregates[i]);
+    }
+    free(_groupAggregates);
+    _groupAggregates = NULL;
+    _groupAggregateColumnCount = 0;
+}
+
+@end
@@ -0,0 +1,259 @@
+//
+//  MBTableGrid+Private.h
+//  MBTableGrid
+//
+//  Created by agent on 10/17/26.
+//
+
+#import "MBTableGrid.h"
+#import "MBTableGridCopyDataProvider.h"
+#import "MBTableGridGeometry.h"
+#import "MBTableGridTrigramIndex.h"
+#import "MBTableGridSort.h"
+#import "MBTableGridRowPermutation.h"
+#import "MBTableGridFilter.h"
+#import "MBTableGridBitmap.h"
+#import "MBTableGridGroup.h"
+#import "MBTableGridFormulaSheet.h"
+#import <stdatomic.h>
+#import <os/lock.h>
+
+// What MBTableGrid.m and its category files share: the grid's instance variables, and
+// the functions and methods they call on one another
+
+#define MBTableGridObjectValueBatchSize 4096
+#define MBTableGridExportBatchSize 65536 // cells fetched from the data source at a time when exporting
+#define MBTableGridSortRepairLimit 4096 // changed rows moved one at a time before sorting again is quicker
+
+MBTableGridValue MBValueForObject(id object);
+void MBApplyConcurrently(size_t iterations, void *context, MBTableGridSortWorkFunction work);
+
+// A column the rows are sorted by, with the key of each data source row
+typedef struct MBSortColumn {
+    NSUInteger columnIndex;
+    BOOL ascending;
+    MBTableGridSortKeys *keys;
+} MBSortColumn;
+
+typedef struct MBSortRowContext {
+    const MBSortColumn *columns;
+    NSUInteger columnCount;
+    size_t dataSourceRow;
+} MBSortRowContext;
+
+int MBCompareSortRow(void *context, size_t dataSourceRow);
+
+// A group of rows as shown: its number in the group table, the rows it's shown in, and
+// where its data source rows are among every grouped row
+typedef struct MBGroupRun {
+    uint32_t group;
+    NSUInteger firstRow;
+    NSUInteger rowCount;
+    NSUInteger firstGroupedRow;
+    NSUInteger groupedRowCount;
+} MBGroupRun;
+
+// A condition the rows are filtered by, on the values of one column
+typedef struct MBFilterColumn {
+    NSUInteger columnIndex;
+    MBTableGridFilterCondition *condition;
+} MBFilterColumn;
+
+int MBCompareFilterColumns(const void *a, const void *b);
+
+@interface MBTableGrid () {
+    MBTableGridOffsetIndex *_columnOffsetIndex;
+    BOOL _columnOffsetIndexIsValid;
+    MBTableGridOffsetIndex *_rowOffsetIndex;
+    BOOL _rowOffsetIndexIsValid;
+    BOOL _usesVariableRowHeights;
+    NSPoint _lastScrollOrigin;
+    CFTimeInterval _lastScrollTime;
+    NSPoint _scrollVelocity;
+    NSRange _prefetchedColumns;
+    NSRange _prefetchedRows;
+    // The data source columns and rows of each block asked to be prefetched
+    NSMutableArray<NSArray<NSValue *> *> *_prefetchedBlocks;
+    NSMutableArray<NSArray<NSValue *> *> *_availableValueBlocks;
+    atomic_bool _findAborted;
+    MBTableGridTrigramIndex *_findIndex;
+    BOOL _findIndexIsValid;
+    BOOL _findIndexSkippedPendingCells;
+    BOOL _preservesFindIndex;
+    MBTableGridCopyDataProvider *_copyDataProvider;
+    NSString *_stringBufferKey;
+    NSArray<NSNumber *> *_secondarySortColumnIndexes;
+    NSIndexSet *_ascendingSecondarySortColumnIndexes;
+    MBSortColumn *_sortColumns;
+    NSUInteger _sortColumnCount;
+    NSArray<MBTableGridFilterPredicate *> *_filterPredicates;
+    MBFilterColumn *_filterColumns;
+    NSUInteger _filterColumnCount;
+    unsigned char *_filterMatches;
+    MBTableGridBitmap *_pendingFilterRows;
+    MBTableGridAggregateIndex **_aggregateIndexes;
+    NSUInteger _aggregateIndexCount;
+    NSIndexSet *_aggregateDataSourceRowIndexes;
+    BOOL _sendsSelectionAggregate;
+    NSTextFieldCell *_aggregateFooterCell;
+    MBTableGridGroupTable *_groupTable;
+    uint32_t *_dataSourceRowGroups;
+    size_t *_groupedDataSourceRows;
+    NSUInteger _groupedRowCount;
+    MBGroupRun *_groupRuns;
+    NSUInteger _groupRunCount;
+    NSMutableIndexSet *_collapsedGroups;
+    MBTableGridAggregate **_groupAggregates;
+    NSUInteger _groupAggregateColumnCount;
+    MBTableGridFormulaSheet *_formulaSheet;
+    // Guards the formula sheet, whose results background Find and exports read
+    os_unfair_lock _formulaLock;
+    NSString *_formulaStringBufferKey;
+    NSString *_columnStringBufferKey;
+    // The data source rows in the order rows were moved into, or nil for the data source's
+    MBTableGridRowPermutation *_rowOrder;
+    // Properties the category files read directly, whose instance variables would
+    // otherwise be synthesized out of their sight
+    NSUInteger _numberOfColumns;
+    NSUInteger _numberOfRows;
+    NSUInteger _numberOfDataSourceRows;
+    NSUInteger _sortColumnIndex;
+    BOOL _sortColumnAscending;
+    BOOL _sortsRows;
+    NSUInteger _groupColumnIndex;
+    NSIndexSet *_selectedRowIndexes;
+    MBTableGridAggregateFunction _groupFooterAggregateFunction;
+    NSUInteger _groupFooterColumnIndex;
+    BOOL _evaluatesFormulas;
+}
+@property (nonatomic, readwrite, assign) MBHorizontalEdge previousHorizontalSelectionDirection;
+@property (nonatomic, readwrite, assign) MBVerticalEdge previousVerticalSelectionDirection;
+- (void)_resolveCopiedCells;
+- (void)_resolveCopiedCellsInColumns:(NSIndexSet *)columnIndexes dataSourceRows:(NSIndexSet *)dataSourceRowIndexes;
+- (id)_objectValueForColumn:(NSUInteger)columnIndex dataSourceRow:(NSUInteger)rowIndex;
+- (void)_updateContentSize;
+- (void)_updateFindIndexForColumns:(NSIndexSet *)columnIndexes rows:(NSIndexSet *)rowIndexes;
+- (void)_noteDefaultRowHeightChanged;
+- (MBTableGridAggregateIndex *)_aggregateIndexForColumn:(NSUInteger)columnIndex;
+- (NSIndexSet *)_aggregateDataSourceRowIndexesForRowIndexes:(NSIndexSet *)rowIndexes;
+- (void)_addValuesInColumn:(NSUInteger)columnIndex dataSourceRows:(NSRange)dataSourceRowRange toAggregate:(MBTableGridAggregate *)aggregate;
+- (void)_updateAggregatesForColumns:(NSIndexSet *)columnIndexes rows:(NSIndexSet *)rowIndexes dataSourceRows:(NSIndexSet *)dataSourceRowIndexes;
+- (void)_updateAggregatesFromNumberOfDataSourceRows:(NSUInteger)previousNumberOfDataSourceRows;
+- (void)_clearAggregateIndexes;
+- (void)_invalidateAggregates;
+- (void)_noteAggregateRowsChanged;
+- (void)_noteSelectionAggregateChanged;
+- (BOOL)_getAggregateValues:(MBTableGridValue *)values forColumn:(NSUInteger)columnIndex dataSourceRows:(NSRange)dataSourceRowRange;
+- (BOOL)_makeRowOrder;
+- (BOOL)_moveRowsInRowOrder:(NSIndexSet *)rowIndexes toRow:(NSUInteger)rowIndex;
+- (NSIndexSet *)_dataSourceColumnIndexesForColumnIndexes:(NSIndexSet *)columnIndexes;
+- (NSIndexSet *)_columnIndexesForDataSourceColumnIndexes:(NSIndexSet *)dataSourceColumnIndexes;
+- (void)_enumerateDataSourceRangesInColumns:(NSRange)columnRange
+                                 usingBlock:(void (^)(NSRange dataSourceColumnRange, NSUInteger columnIndex, BOOL *stop))block;
+- (void)_enumerateDataSourceBlocksInColumns:(NSRange)columnRange rows:(NSRange)rowRange
+                                usingBlock:(void (^)(NSRange dataSourceColumns, NSRange dataSourceRows))block;
+- (void)_cancelPrefetchedCells;
+- (BOOL)_moveColumnsInColumnOrder:(NSIndexSet *)columnIndexes toColumn:(NSUInteger)columnIndex;
+- (void)_updateColumnOrderFromNumberOfColumns:(NSUInteger)previousNumberOfColumns;
+- (void)_noteColumnsMovedToColumns:(const NSUInteger *)newColumns;
+- (void)_updateSortableColumns;
+// The rows shown and their order when the grid has sorted, filtered or moved them, or
+// nil. Atomic, since background Find and exports read it.
+@property (atomic, strong) MBTableGridRowPermutation *rowPermutation;
+// The data source columns in the order columns were moved into, or nil for the data
+// source's. Atomic for the same reason.
+@property (atomic, strong) MBTableGridRowPermutation *columnOrder;
+@end
+
+@interface MBTableGrid (DataAccessors)
+- (NSString *)_headerStringForColumn:(NSUInteger)columnIndex;
+- (NSString *)_headerStringForRow:(NSUInteger)rowIndex;
+- (void)_setObjectValue:(id)value forColumn:(NSUInteger)columnIndex row:(NSUInteger)rowIndex;
+- (void)_setObjectValue:(id)value forColumns:(NSIndexSet *)columnIndexes rows:(NSIndexSet *)rowIndexes;
+- (CGFloat)_minimumWidthForColumn:(NSUInteger)columnIndex;
+- (CGFloat)_widthForColumn:(NSUInteger)columnIndex;
+- (void)_setWidth:(CGFloat) width forColumn:(NSUInteger)columnIndex;
+- (MBTableGridOffsetIndex *)_columnOffsetIndex;
+- (MBTableGridOffsetIndex *)_rowOffsetIndex;
+- (MBTableGridAxis)_columnAxis;
+- (MBTableGridAxis)_rowAxis;
+- (void)_getHeights:(float *)heights forRows:(NSRange)rowRange;
+- (BOOL)_providesObjectValuesInBulk;
+- (void)_getObjectValues:(id __strong *)values forColumns:(NSRange)columnRange rows:(NSRange)rowRange;
+- (void)_getObjectValues:(id __strong *)values forColumns:(NSRange)columnRange rows:(NSRange)rowRange ofDataSourceRows:(const size_t *)dataSourceRows;
+- (void)_getObjectValues:(id __strong *)values forColumns:(NSRange)columnRange dataSourceRows:(NSRange)dataSourceRowRange;
+- (void)_enumerateObjectValuesInColumns:(NSRange)columnRange rows:(NSRange)rowRange usingBlock:(void (^)(NSUInteger columnIndex, NSUInteger rowIndex, id value, BOOL *stop))block;
+- (BOOL)_providesTypedValues;
+- (NSMutableData *)_nextStringBufferForKey:(NSString *)key;
+- (void)_enumerateDataSourceRangesInRows:(NSRange)rowRange ofDataSourceRows:(const size_t *)dataSourceRows
+                              usingBlock:(void (^)(NSRange dataSourceRowRange, NSUInteger rowIndex, BOOL *stop))block;
+- (void)_getValues:(MBTableGridValue *)values forColumns:(NSRange)columnRange rows:(NSRange)rowRange;
+- (void)_getValues:(MBTableGridValue *)values forColumns:(NSRange)columnRange rows:(NSRange)rowRange ofDataSourceRows:(const size_t *)dataSourceRows;
+- (void)_getValues:(MBTableGridValue *)values forColumns:(NSRange)columnRange dataSourceRows:(NSRange)dataSourceRowRange;
+- (void)_enumerateValuesInColumns:(NSRange)columnRange rows:(NSRange)rowRange usingBlock:(void (^)(NSUInteger columnIndex, NSUInteger rowIndex, const MBTableGridValue *value, BOOL *stop))block;
+- (id)_objectForValue:(const MBTableGridValue *)value;
+- (NSData *)_tabularDataForColumns:(NSRange)columnRange rows:(NSRange)rowRange ofDataSourceRows:(const size_t *)dataSourceRows;
+- (char *)_stringsDescribingObjectValues:(MBTableGridValue *)values forColumns:(NSRange)columnRange rows:(NSRange)rowRange
+                        ofDataSourceRows:(const size_t *)dataSourceRows;
+- (BOOL)_canEditCellAtColumn:(NSUInteger)columnIndex row:(NSUInteger)rowIndex;
+- (BOOL)_canEditCellsInColumns:(NSIndexSet *)columnIndexes rows:(NSIndexSet *)rowIndexes;
+- (NSCell *)_footerCellForColumn:(NSUInteger)columnIndex;
+- (NSCell *)_footerCellForRow:(NSUInteger)rowIndex;
+- (NSCell *)_aggregateFooterCellForColumn:(NSUInteger)columnIndex;
+- (NSCell *)_aggregateFooterCellWithAggregate:(MBTableGridAggregate)aggregate function:(MBTableGridAggregateFunction)function;
+- (NSCell *)_footerCellForGroup:(NSUInteger)groupIndex;
+@end
+
+@interface MBTableGrid (SortingPrivate)
+- (NSIndexSet *)_dataSourceRowIndexesForRowIndexes:(NSIndexSet *)rowIndexes;
+- (NSIndexSet *)_rowIndexesForDataSourceRowIndexes:(NSIndexSet *)dataSourceRowIndexes;
+- (NSIndexSet *)_ascendingSortColumnIndexes;
+- (void)_setSortColumnIndexes:(NSArray<NSNumber *> *)columnIndexes ascendingColumns:(NSIndexSet *)ascendingColumnIndexes;
+- (BOOL)_readSortKeys:(MBTableGridSortKeys *)keys forColumn:(NSUInteger)columnIndex dataSourceRows:(NSRange)rowRange;
+- (void)_clearSortKeys;
+- (BOOL)_readAllSortKeys;
+- (MBTableGridRowPermutation *)_rowPermutationFromSortKeys;
+- (BOOL)_orderRowsFromSortKeys;
+- (void)_setRowPermutation:(MBTableGridRowPermutation *)permutation;
+- (void)_updateRowPermutationFromNumberOfDataSourceRows:(NSUInteger)previousNumberOfDataSourceRows;
+- (void)_updateRowOrderFromNumberOfDataSourceRows:(NSUInteger)previousNumberOfDataSourceRows;
+- (void)_orderRowsAgainReadingValues:(BOOL)readsValues;
+- (void)_repairSortForDataSourceRows:(NSIndexSet *)dataSourceRowIndexes columns:(NSIndexSet *)columnIndexes;
+@end
+
+@interface MBTableGrid (FilteringPrivate)
+- (void)_clearFilterConditions;
+- (void)_clearFilter;
+- (BOOL)_readFilterMatches;
+- (BOOL)_filterDataSourceRows:(NSRange)rowRange;
+- (void)_filterPendingDataSourceRows:(NSRange)rowRange columns:(NSIndexSet *)columnIndexes;
+- (void)_noteRowsRemovedFromRow:(NSUInteger)firstRow;
+@end
+
+@interface MBTableGrid (GroupingPrivate)
+- (void)_clearGroups;
+- (BOOL)_readAllGroups;
+- (BOOL)_readGroupsForDataSourceRows:(NSRange)rowRange;
+- (MBTableGridRowPermutation *)_rowPermutationGroupingDataSourceRows:(size_t *)dataSourceRows count:(NSUInteger)count;
+- (BOOL)_repairGroupsForDataSourceRows:(NSIndexSet *)dataSourceRowIndexes previousRows:(NSArray<NSNumber *> *)previousRows;
+- (BOOL)_copyGroupedDataSourceRows;
+- (MBTableGridRowPermutation *)_rowPermutationFromGroups;
+- (void)_showGroupsAgain;
+- (const MBTableGridAggregate *)_groupAggregatesForColumn:(NSUInteger)columnIndex;
+- (void)_clearGroupAggregates;
+@end
+
+@interface MBTableGrid (FormulasPrivate)
+- (BOOL)_readFormulaValues:(MBTableGridValue *)values forColumn:(NSUInteger)columnIndex dataSourceRows:(NSRange)rowRange
+                   strings:(NSMutableData *)strings;
+- (void)_noteFormulaValues:(const MBTableGridValue *)values forColumns:(NSRange)columnRange dataSourceRows:(NSRange)rowRange;
+- (void)_noteFormulaObject:(id)value forColumns:(NSIndexSet *)columnIndexes dataSourceRows:(NSIndexSet *)dataSourceRowIndexes;
+- (void)_recalculateFormulas;
+- (void)_getFormulaResults:(MBTableGridValue *)values forColumns:(NSRange)columnRange dataSourceRows:(NSRange)rowRange;
+- (void)_getFormulaObjects:(id __strong *)values forColumns:(NSRange)columnRange dataSourceRows:(NSRange)rowRange;
+@end
+
+@interface MBTableGrid (ExportingPrivate)
+- (BOOL)_exportColumns:(NSIndexSet *)columnIndexes rows:(NSIndexSet *)rowIndexes toFileDescriptor:(int)fileDescriptor
+                format:(MBTableGridExportFormat)format headers:(NSArray<NSString *> *)headers progress:(NSProgress *)progress;
+@end
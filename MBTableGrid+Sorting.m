@@ -0,0 +1,526 @@
+//
+//  MBTableGrid+Sorting.m
+//  MBTableGrid
+//
+//  Created by agent on 10/17/26.
+//
+
+#import "MBTableGrid+Private.h"
+#import "MBTableGridHeaderView.h"
+#import "MBTableGridFooterView.h"
+#import "MBTableGridContentView.h"
+#import "MBTableGridTextFinderClient.h"
+
+// Strings that aren't ASCII are folded by Foundation, which knows about case, diacritics
+// and width beyond ASCII
+static bool MBSetSortKey(MBTableGridSortKeys *keys, size_t rowIndex, const MBTableGridValue *value) {
+    if (value->type != MBTableGridValueTypeString || MBTableGridSortKeysCanFoldString(value->data.string.bytes, value->data.string.length))
+        return MBTableGridSortKeysSetValue(keys, rowIndex, value);
+    @autoreleasepool {
+        NSString *string = [[NSString alloc] initWithBytesNoCopy:(void *)value->data.string.bytes length:value->data.string.length
+                                                        encoding:NSUTF8StringEncoding freeWhenDone:NO];
+        NSString *folded = [string stringByFoldingWithOptions:NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch | NSWidthInsensitiveSearch
+                                                       locale:NSLocale.currentLocale];
+        const char *foldedBytes = folded.UTF8String;
+        if (foldedBytes == NULL)
+            return MBTableGridSortKeysSetValue(keys, rowIndex, value);
+        return MBTableGridSortKeysSetString(keys, rowIndex, foldedBytes, strlen(foldedBytes), value->data.string.bytes, value->data.string.length);
+    }
+}
+
+// Orders rows as sorting them from the data source's order does: by each column in
+// turn, and then by data source row
+int MBCompareSortRow(void *context, size_t dataSourceRow) {
+    const MBSortRowContext *sortRow = context;
+    for (NSUInteger i = 0; i < sortRow->columnCount; i++) {
+        int result = MBTableGridSortKeysCompare(sortRow->columns[i].keys, sortRow->columns[i].ascending, dataSourceRow, sortRow->dataSourceRow);
+        if (result)
+            return result;
+    }
+    return (dataSourceRow > sortRow->dataSourceRow) - (dataSourceRow < sortRow->dataSourceRow);
+}
+
+@implementation MBTableGrid (Sorting)
+
+- (void)_sortButtonClickedForColumn:(NSUInteger)column extending:(BOOL)extending {
+    NSMutableArray<NSNumber *> *columnIndexes = [self.sortColumnIndexes mutableCopy];
+    NSMutableIndexSet *ascendingColumnIndexes = [[self _ascendingSortColumnIndexes] mutableCopy];
+    NSUInteger priority = [columnIndexes indexOfObject:@(column)];
+    BOOL ascending = [ascendingColumnIndexes containsIndex:column];
+    if (!extending) {
+        // Sort by this column alone: descending, then ascending, then not at all
+        [columnIndexes removeAllObjects];
+        [ascendingColumnIndexes removeAllIndexes];
+        if (priority != 0) {
+            [columnIndexes addObject:@(column)];
+        } else if (!ascending) {
+            [columnIndexes addObject:@(column)];
+            [ascendingColumnIndexes addIndex:column];
+        }
+    } else if (priority == NSNotFound) {
+        // Shift-clicking goes through the same states, leaving the other columns alone
+        [columnIndexes addObject:@(column)];
+    } else if (!ascending) {
+        [ascendingColumnIndexes addIndex:column];
+    } else {
+        [columnIndexes removeObjectAtIndex:priority];
+        [ascendingColumnIndexes removeIndex:column];
+    }
+    [self _setSortColumnIndexes:columnIndexes ascendingColumns:ascendingColumnIndexes];
+    if ([self.delegate respondsToSelector:@selector(tableGrid:didSortByColumn:ascending:)]) {
+        [self.delegate tableGrid:self didSortByColumn:self.sortColumnIndex ascending:self.sortColumnAscending];
+    }
+    [self reloadData];
+    if (self.sortsRows) {
+        [self sortByColumns:columnIndexes ascendingColumns:ascendingColumnIndexes];
+    }
+}
+
+- (NSArray<NSNumber *> *)sortColumnIndexes {
+    if (_sortColumnIndex == NSNotFound)
+        return @[];
+    return [@[@(_sortColumnIndex)] arrayByAddingObjectsFromArray:_secondarySortColumnIndexes ?: @[]];
+}
+
+- (BOOL)isColumnSortedAscending:(NSUInteger)columnIndex {
+    if (_sortColumnIndex != NSNotFound && columnIndex == _sortColumnIndex)
+        return _sortColumnAscending;
+    return [_secondarySortColumnIndexes containsObject:@(columnIndex)] && [_ascendingSecondarySortColumnIndexes containsIndex:columnIndex];
+}
+
+- (NSIndexSet *)_ascendingSortColumnIndexes {
+    NSMutableIndexSet *ascendingColumnIndexes = [NSMutableIndexSet indexSet];
+    for (NSNumber *columnIndex in self.sortColumnIndexes) {
+        if ([self isColumnSortedAscending:columnIndex.unsignedIntegerValue])
+            [ascendingColumnIndexes addIndex:columnIndex.unsignedIntegerValue];
+    }
+    return ascendingColumnIndexes;
+}
+
+- (void)_setSortColumnIndexes:(NSArray<NSNumber *> *)columnIndexes ascendingColumns:(NSIndexSet *)ascendingColumnIndexes {
+    _sortColumnIndex = columnIndexes.count ? columnIndexes[0].unsignedIntegerValue : NSNotFound;
+    _sortColumnAscending = [ascendingColumnIndexes containsIndex:_sortColumnIndex];
+    _secondarySortColumnIndexes = (columnIndexes.count > 1) ? [columnIndexes subarrayWithRange:NSMakeRange(1, columnIndexes.count - 1)] : nil;
+    _ascendingSecondarySortColumnIndexes = [ascendingColumnIndexes copy];
+    columnHeaderView.needsDisplay = YES;
+}
+
+- (BOOL)sortsRows {
+    return _sortsRows;
+}
+
+- (void)setSortsRows:(BOOL)sortsRows {
+    if (_sortsRows == sortsRows)
+        return;
+    _sortsRows = sortsRows;
+    [self sortByColumns:self.sortColumnIndexes ascendingColumns:[self _ascendingSortColumnIndexes]];
+}
+
+- (BOOL)sortByColumn:(NSUInteger)columnIndex ascending:(BOOL)ascending {
+    if (columnIndex == NSNotFound)
+        return [self sortByColumns:@[] ascendingColumns:[NSIndexSet indexSet]];
+    return [self sortByColumns:@[@(columnIndex)]
+              ascendingColumns:ascending ? [NSIndexSet indexSetWithIndex:columnIndex] : [NSIndexSet indexSet]];
+}
+
+- (BOOL)sortByColumns:(NSArray<NSNumber *> *)columnIndexes ascendingColumns:(NSIndexSet *)ascendingColumnIndexes {
+    [self _setSortColumnIndexes:columnIndexes ascendingColumns:ascendingColumnIndexes];
+
+    BOOL hasSortColumn = NO;
+    for (NSNumber *columnIndex in columnIndexes) {
+        hasSortColumn = hasSortColumn || (columnIndex.unsignedIntegerValue < _numberOfColumns);
+    }
+    BOOL succeeded = YES;
+    if (self.sortsRows && hasSortColumn) {
+        succeeded = [self _readAllSortKeys];
+        if (!succeeded) {
+            NSLog(@"WARNING: MBTableGrid could not sort %lu rows", (unsigned long)_numberOfDataSourceRows);
+        }
+    } else {
+        [self _clearSortKeys];
+    }
+    return [self _orderRowsFromSortKeys] && succeeded;
+}
+
+- (NSUInteger)dataSourceRowForRow:(NSUInteger)rowIndex {
+    MBTableGridRowPermutation *permutation = self.rowPermutation;
+    return permutation ? [permutation dataSourceRowForRow:rowIndex] : rowIndex;
+}
+
+- (NSUInteger)rowForDataSourceRow:(NSUInteger)dataSourceRowIndex {
+    MBTableGridRowPermutation *permutation = self.rowPermutation;
+    return permutation ? [permutation rowForDataSourceRow:dataSourceRowIndex] : dataSourceRowIndex;
+}
+
+- (NSIndexSet *)_dataSourceRowIndexesForRowIndexes:(NSIndexSet *)rowIndexes {
+    MBTableGridRowPermutation *permutation = self.rowPermutation;
+    return permutation ? [permutation dataSourceRowIndexesForRowIndexes:rowIndexes] : rowIndexes;
+}
+
+- (NSIndexSet *)_rowIndexesForDataSourceRowIndexes:(NSIndexSet *)dataSourceRowIndexes {
+    MBTableGridRowPermutation *permutation = self.rowPermutation;
+    return permutation ? [permutation rowIndexesForDataSourceRowIndexes:dataSourceRowIndexes] : dataSourceRowIndexes;
+}
+
+// Reads a column's values for some data source rows into its keys, a batch at a time
+- (BOOL)_readSortKeys:(MBTableGridSortKeys *)keys forColumn:(NSUInteger)columnIndex dataSourceRows:(NSRange)rowRange {
+    NSRange columnRange = NSMakeRange(columnIndex, 1);
+    BOOL succeeded = YES;
+    if ([self _providesTypedValues]) {
+        MBTableGridValue *values = malloc(MAX(1, MIN(rowRange.length, MBTableGridExportBatchSize)) * sizeof(MBTableGridValue));
+        succeeded = (values != NULL);
+        for (NSUInteger firstRow = rowRange.location; firstRow < NSMaxRange(rowRange) && succeeded; firstRow += MBTableGridExportBatchSize) {
+            NSRange batchRows = NSMakeRange(firstRow, MIN(MBTableGridExportBatchSize, NSMaxRange(rowRange) - firstRow));
+            [self _getValues:values forColumns:columnRange dataSourceRows:batchRows];
+            for (NSUInteger i = 0; i < batchRows.length && succeeded; i++) {
+                succeeded = MBSetSortKey(keys, batchRows.location + i, &values[i]);
+            }
+        }
+        free(values);
+    } else {
+        __strong id *objects = (__strong id *)calloc(MAX(1, MIN(rowRange.length, MBTableGridObjectValueBatchSize)), sizeof(id));
+        succeeded = (objects != NULL);
+        for (NSUInteger firstRow = rowRange.location; firstRow < NSMaxRange(rowRange) && succeeded; firstRow += MBTableGridObjectValueBatchSize) {
+            NSRange batchRows = NSMakeRange(firstRow, MIN(MBTableGridObjectValueBatchSize, NSMaxRange(rowRange) - firstRow));
+            @autoreleasepool {
+                [self _getObjectValues:objects forColumns:columnRange dataSourceRows:batchRows];
+                for (NSUInteger i = 0; i < batchRows.length; i++) {
+                    MBTableGridValue value = MBValueForObject(objects[i]);
+                    succeeded = succeeded && MBSetSortKey(keys, batchRows.location + i, &value);
+                    objects[i] = nil;
+                }
+            }
+        }
+        free(objects);
+    }
+    return succeeded;
+}
+
+- (void)_clearSortKeys {
+    for (NSUInteger i = 0; i < _sortColumnCount; i++) {
+        MBTableGridSortKeysDestroy(_sortColumns[i].keys);
+    }
+    free(_sortColumns);
+    _sortColumns = NULL;
+    _sortColumnCount = 0;
+}
+
+// Reads every sort column in the data source's order, keeping a key for each cell so
+// that edits can move rows without reading everything again. Returns NO, keeping no
+// keys, if out of memory.
+- (BOOL)_readAllSortKeys {
+    [self _clearSortKeys];
+    NSArray<NSNumber *> *columnIndexes = self.sortColumnIndexes;
+    NSUInteger numberOfRows = _numberOfDataSourceRows;
+    _sortColumns = calloc(MAX(1, columnIndexes.count), sizeof(MBSortColumn));
+    if (_sortColumns == NULL)
+        return NO;
+    NSMutableIndexSet *readColumnIndexes = [NSMutableIndexSet indexSet];
+    for (NSNumber *number in columnIndexes) {
+        NSUInteger columnIndex = number.unsignedIntegerValue;
+        if (columnIndex >= _numberOfColumns || [readColumnIndexes containsIndex:columnIndex])
+            continue;
+        [readColumnIndexes addIndex:columnIndex];
+        MBTableGridSortKeys *keys = MBTableGridSortKeysCreate(numberOfRows);
+        if (keys == NULL || ![self _readSortKeys:keys forColumn:columnIndex dataSourceRows:NSMakeRange(0, numberOfRows)]) {
+            MBTableGridSortKeysDestroy(keys);
+            [self _clearSortKeys];
+            return NO;
+        }
+        _sortColumns[_sortColumnCount++] = (MBSortColumn){ columnIndex, [self isColumnSortedAscending:columnIndex], keys };
+    }
+    return YES;
+}
+
+// Sorts the grid's order of the rows by the least significant column first, on every
+// processor; each sort is stable, so it keeps the order of the columns before it among
+// rows that tie, and the grid's order among rows that tie in every column. Rows
+// the filter hides or that were taken out of the grid's order are then left out, and
+// the rest grouped. Returns nil if out of memory.
+- (MBTableGridRowPermutation *)_rowPermutationFromSortKeys {
+    NSUInteger numberOfRows = _numberOfDataSourceRows;
+    NSUInteger orderCount = _rowOrder ? MIN(_rowOrder.count, numberOfRows) : numberOfRows;
+    size_t *dataSourceRows = malloc(MAX(1, numberOfRows) * sizeof(size_t));
+    unsigned char *inOrder = (orderCount < numberOfRows) ? calloc(numberOfRows, 1) : NULL;
+    if (dataSourceRows == NULL || (orderCount < numberOfRows && inOrder == NULL)) {
+        free(dataSourceRows);
+        free(inOrder);
+        return nil;
+    }
+    if (_rowOrder) {
+        [_rowOrder getDataSourceRows:dataSourceRows inRows:NSMakeRange(0, orderCount)];
+    } else {
+        for (NSUInteger rowIndex = 0; rowIndex < numberOfRows; rowIndex++) {
+            dataSourceRows[rowIndex] = rowIndex;
+        }
+    }
+    // The keys sort every row, so those taken out of the order go after it until then
+    if (inOrder) {
+        for (NSUInteger i = 0; i < orderCount; i++) {
+            inOrder[dataSourceRows[i]] = 1;
+        }
+        NSUInteger i = orderCount;
+        for (NSUInteger rowIndex = 0; rowIndex < numberOfRows; rowIndex++) {
+            if (!inOrder[rowIndex])
+                dataSourceRows[i++] = rowIndex;
+        }
+    }
+    for (NSUInteger i = _sortColumnCount; i > 0; i--) {
+        if (!MBTableGridSortKeysSort(_sortColumns[i - 1].keys, _sortColumns[i - 1].ascending, dataSourceRows, MBApplyConcurrently)) {
+            free(dataSourceRows);
+            free(inOrder);
+            return nil;
+        }
+    }
+    NSUInteger count = numberOfRows;
+    if (_filterMatches || inOrder) {
+        count = 0;
+        for (NSUInteger i = 0; i < numberOfRows; i++) {
+            size_t dataSourceRow = dataSourceRows[i];
+            dataSourceRows[count] = dataSourceRow;
+            count += (_filterMatches == NULL || _filterMatches[dataSourceRow]) && (inOrder == NULL || inOrder[dataSourceRow]);
+        }
+    }
+    free(inOrder);
+    if (_groupTable)
+        return [self _rowPermutationGroupingDataSourceRows:dataSourceRows count:count];
+    return [[MBTableGridRowPermutation alloc] initWithDataSourceRows:dataSourceRows count:count];
+}
+
+// Shows the rows in the order of the sort keys, without those the filter hides and
+// in their groups, or in the grid's or the data source's order if there are none of
+// these. Returns NO if out of memory, in which case the sort, filter and groups are
+// dropped.
+- (BOOL)_orderRowsFromSortKeys {
+    MBTableGridRowPermutation *permutation = nil;
+    BOOL succeeded = YES;
+    if (_sortColumnCount || _filterMatches || _groupTable) {
+        permutation = [self _rowPermutationFromSortKeys];
+        if (permutation == nil) {
+            NSLog(@"WARNING: MBTableGrid could not order %lu rows", (unsigned long)_numberOfDataSourceRows);
+            [self _clearSortKeys];
+            [self _clearFilter];
+            [self _clearGroups];
+            succeeded = NO;
+        }
+    }
+    // Going back to the grid's order, or the data source's, just drops the permutation
+    if (permutation == nil)
+        permutation = _rowOrder;
+    if (permutation != self.rowPermutation) {
+        [self _setRowPermutation:permutation];
+    }
+    return succeeded;
+}
+
+// Everything worked out a row at a time is in the old order
+- (void)_setRowPermutation:(MBTableGridRowPermutation *)permutation {
+    self.rowPermutation = permutation;
+    NSUInteger numberOfRows = permutation ? permutation.count : _numberOfDataSourceRows;
+    if (numberOfRows != _numberOfRows) {
+        _numberOfRows = numberOfRows;
+        [self _updateContentSize];
+    }
+    _rowOffsetIndexIsValid = NO;
+    [self _cancelPrefetchedCells];
+    _findIndexIsValid = NO;
+    [(MBTableGridTextFinderClient *)_textFinderClient noteCellNumbersDidChange];
+    [_textFinder noteClientStringWillChange];
+    [self _noteAggregateRowsChanged];
+    self.needsDisplay = YES;
+}
+
+// Keeps the sort, filter and groups covering every row after the number of data source
+// rows changes. Rows added to the end are filtered, grouped and put where they belong;
+// removed rows may have been anywhere, so the rows are read, filtered, sorted and
+// grouped again.
+- (void)_updateRowPermutationFromNumberOfDataSourceRows:(NSUInteger)previousNumberOfDataSourceRows {
+    [self _updateRowOrderFromNumberOfDataSourceRows:previousNumberOfDataSourceRows];
+    MBTableGridRowPermutation *permutation = self.rowPermutation;
+    NSUInteger numberOfRows = _numberOfDataSourceRows;
+    if (permutation == nil || previousNumberOfDataSourceRows == numberOfRows)
+        return;
+    if (_sortColumnCount == 0 && _filterMatches == NULL && _groupTable == NULL) {
+        // The grid's order, which has just been updated, or nothing if that failed
+        [self _orderRowsFromSortKeys];
+        return;
+    }
+    BOOL succeeded = (numberOfRows > previousNumberOfDataSourceRows);
+    for (NSUInteger i = 0; i < _sortColumnCount && succeeded; i++) {
+        succeeded = MBTableGridSortKeysSetRowCount(_sortColumns[i].keys, numberOfRows);
+    }
+    if (succeeded && _filterMatches) {
+        unsigned char *filterMatches = realloc(_filterMatches, numberOfRows);
+        if (filterMatches)
+            _filterMatches = filterMatches;
+        succeeded = (filterMatches != NULL) &&
+                    [self _filterDataSourceRows:NSMakeRange(previousNumberOfDataSourceRows, numberOfRows - previousNumberOfDataSourceRows)];
+    }
+    if (succeeded && _groupTable) {
+        uint32_t *groups = realloc(_dataSourceRowGroups, numberOfRows * sizeof(uint32_t));
+        if (groups)
+            _dataSourceRowGroups = groups;
+        succeeded = (groups != NULL) &&
+                    [self _readGroupsForDataSourceRows:NSMakeRange(previousNumberOfDataSourceRows, numberOfRows - previousNumberOfDataSourceRows)];
+    }
+    if (succeeded) {
+        [self _repairSortForDataSourceRows:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(previousNumberOfDataSourceRows, numberOfRows - previousNumberOfDataSourceRows)]
+                                   columns:nil];
+    } else {
+        [self _orderRowsAgainReadingValues:YES];
+    }
+}
+
+// Rows added to the data source go at the end of the grid's order. Rows it removes are
+// taken to be its last, as when rows added by a fill are taken away again; a data source
+// that removes others takes them out of the order with removeRowsFromRowOrder: instead,
+// or sets the order again. Goes back to the data source's order if out of memory.
+- (void)_updateRowOrderFromNumberOfDataSourceRows:(NSUInteger)previousNumberOfDataSourceRows {
+    NSUInteger numberOfRows = _numberOfDataSourceRows;
+    if (_rowOrder == nil || previousNumberOfDataSourceRows == numberOfRows)
+        return;
+    BOOL succeeded = YES;
+    if (numberOfRows > previousNumberOfDataSourceRows) {
+        succeeded = [_rowOrder appendDataSourceRows:NSMakeRange(previousNumberOfDataSourceRows, numberOfRows - previousNumberOfDataSourceRows)];
+    } else {
+        for (NSUInteger dataSourceRowIndex = numberOfRows; dataSourceRowIndex < previousNumberOfDataSourceRows; dataSourceRowIndex++) {
+            [_rowOrder removeDataSourceRow:dataSourceRowIndex];
+        }
+    }
+    if (!succeeded) {
+        NSLog(@"WARNING: MBTableGrid could not keep the order of %lu rows", (unsigned long)numberOfRows);
+        _rowOrder = nil;
+    }
+}
+
+// Falls back to the data source's order if out of memory
+- (void)_orderRowsAgainReadingValues:(BOOL)readsValues {
+    if (readsValues && _sortColumnCount && ![self _readAllSortKeys]) {
+        NSLog(@"WARNING: MBTableGrid could not sort %lu rows", (unsigned long)_numberOfDataSourceRows);
+    }
+    if (readsValues && _filterMatches && ![self _readFilterMatches]) {
+        NSLog(@"WARNING: MBTableGrid could not filter %lu rows", (unsigned long)_numberOfDataSourceRows);
+        [self _clearFilter];
+    }
+    if (readsValues && _groupTable && ![self _readAllGroups]) {
+        NSLog(@"WARNING: MBTableGrid could not group %lu rows", (unsigned long)_numberOfDataSourceRows);
+        [self _clearGroups];
+    }
+    [self _orderRowsFromSortKeys];
+}
+
+// Moves data source rows whose values in some columns have changed to where they now
+// belong: each is taken out of the order, its keys are read again, and it goes back in
+// where a binary search of the order puts it. Changing more rows than that's worth
+// sorts all of them again from the keys. Rows that aren't in the order yet are just
+// put in, unless the filter hides them, and nil columns means every sort column.
+// Edited rows stay shown even if they no longer pass the filter. Grouped rows move
+// within and between groups the same way, unless that could change the order of the
+// groups, in which case they're ordered again from the keys.
+- (void)_repairSortForDataSourceRows:(NSIndexSet *)dataSourceRowIndexes columns:(NSIndexSet *)columnIndexes {
+    MBTableGridRowPermutation *permutation = self.rowPermutation;
+    if (permutation == nil || permutation == _rowOrder)
+        return;
+    NSUInteger numberOfRows = _numberOfDataSourceRows;
+    // Hidden rows are grouped too, since another filter may show them
+    BOOL changesGroups = (_groupTable && [columnIndexes containsIndex:_groupColumnIndex]);
+    if (changesGroups) {
+        __block BOOL succeeded = YES;
+        [dataSourceRowIndexes enumerateRangesInRange:NSMakeRange(0, numberOfRows) options:0 usingBlock:^(NSRange range, BOOL *stop) {
+            succeeded = [self _readGroupsForDataSourceRows:range];
+            *stop = !succeeded;
+        }];
+        if (!succeeded) {
+            [self _orderRowsAgainReadingValues:YES];
+            return;
+        }
+    }
+    const unsigned char *filterMatches = _filterMatches;
+    // Rows taken out of the grid's order stay out
+    MBTableGridRowPermutation *rowOrder = (_rowOrder.count < numberOfRows) ? _rowOrder : nil;
+    dataSourceRowIndexes = [dataSourceRowIndexes indexesPassingTest:^BOOL(NSUInteger idx, BOOL *stop) {
+        return (BOOL)(idx < numberOfRows && (filterMatches == NULL || filterMatches[idx]) &&
+                      (rowOrder == nil || [rowOrder rowForDataSourceRow:idx] != NSNotFound));
+    }];
+    BOOL changesKeys = (columnIndexes == nil) || changesGroups;
+    for (NSUInteger i = 0; i < _sortColumnCount; i++) {
+        changesKeys = changesKeys || [columnIndexes containsIndex:_sortColumns[i].columnIndex];
+    }
+    if (!changesKeys || dataSourceRowIndexes.count == 0)
+        return;
+
+    __block BOOL succeeded = YES;
+    for (NSUInteger i = 0; i < _sortColumnCount; i++) {
+        if (columnIndexes && ![columnIndexes containsIndex:_sortColumns[i].columnIndex])
+            continue;
+        MBTableGridSortKeys *keys = _sortColumns[i].keys;
+        NSUInteger columnIndex = _sortColumns[i].columnIndex;
+        [dataSourceRowIndexes enumerateRangesUsingBlock:^(NSRange range, BOOL *stop) {
+            succeeded = [self _readSortKeys:keys forColumn:columnIndex dataSourceRows:range];
+            *stop = !succeeded;
+        }];
+    }
+    if (!succeeded || dataSourceRowIndexes.count > MBTableGridSortRepairLimit) {
+        // Keys left half read can't be trusted
+        [self _orderRowsAgainReadingValues:!succeeded];
+        return;
+    }
+
+    NSMutableArray<NSNumber *> *previousRows = [NSMutableArray arrayWithCapacity:dataSourceRowIndexes.count];
+    [dataSourceRowIndexes enumerateIndexesUsingBlock:^(NSUInteger dataSourceRowIndex, BOOL *stop) {
+        [previousRows addObject:@([permutation rowForDataSourceRow:dataSourceRowIndex])];
+    }];
+    if (_groupTable) {
+        if (![self _repairGroupsForDataSourceRows:dataSourceRowIndexes previousRows:previousRows]) {
+            [self _orderRowsFromSortKeys];
+            return;
+        }
+    } else {
+        [dataSourceRowIndexes enumerateIndexesUsingBlock:^(NSUInteger dataSourceRowIndex, BOOL *stop) {
+            [permutation removeDataSourceRow:dataSourceRowIndex];
+        }];
+        __block MBSortRowContext context = { _sortColumns, _sortColumnCount, 0 };
+        [dataSourceRowIndexes enumerateIndexesUsingBlock:^(NSUInteger dataSourceRowIndex, BOOL *stop) {
+            context.dataSourceRow = dataSourceRowIndex;
+            succeeded = ([permutation insertDataSourceRow:dataSourceRowIndex compareFunction:MBCompareSortRow context:&context] != NSNotFound);
+            *stop = !succeeded;
+        }];
+        if (!succeeded) {
+            // The rows not put back can't be left out
+            [self _orderRowsAgainReadingValues:NO];
+            return;
+        }
+    }
+
+    // Every row from the first that moved to the last has a new row number, and a row
+    // that wasn't there before pushes every row after it down
+    __block NSUInteger firstRow = NSNotFound, lastRow = 0, i = 0;
+    NSUInteger count = permutation.count;
+    [dataSourceRowIndexes enumerateIndexesUsingBlock:^(NSUInteger dataSourceRowIndex, BOOL *stop) {
+        NSUInteger previousRow = previousRows[i++].unsignedIntegerValue, row = [permutation rowForDataSourceRow:dataSourceRowIndex];
+        if (previousRow == NSNotFound)
+            previousRow = count - 1;
+        if (row != previousRow) {
+            firstRow = MIN(firstRow, MIN(row, previousRow));
+            lastRow = MAX(lastRow, MAX(row, previousRow));
+        }
+    }];
+    if (firstRow == NSNotFound)
+        return;
+
+    if (_usesVariableRowHeights)
+        _rowOffsetIndexIsValid = NO;
+    _findIndexIsValid = NO;
+    [(MBTableGridTextFinderClient *)_textFinderClient noteCellNumbersDidChange];
+    [_textFinder noteClientStringWillChange];
+    [self _noteAggregateRowsChanged];
+    if (_numberOfColumns) {
+        NSRect dirtyRect = NSUnionRect([contentView frameOfCellAtColumn:0 row:firstRow],
+                                       [contentView frameOfCellAtColumn:_numberOfColumns - 1 row:lastRow]);
+        [contentView invalidateCachedTilesInRect:dirtyRect];
+        [rowHeaderView setNeedsDisplayInRect:NSMakeRect(0, NSMinY(dirtyRect), NSWidth(rowHeaderView.bounds), NSHeight(dirtyRect))];
+        [rowFooterView setNeedsDisplayInRect:NSMakeRect(0, NSMinY(dirtyRect), NSWidth(rowFooterView.bounds), NSHeight(dirtyRect))];
+    }
+}
+
+@end
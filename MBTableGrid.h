@@ -25,6 +25,9 @@
 
 #import <Cocoa/Cocoa.h>
 #import <QuartzCore/QuartzCore.h>
+#import "MBTableGridValue.h"
+#import "MBTableGridAggregate.h"
+#import "MBTableGridFilterPredicate.h"
 
 @class MBTableGridHeaderView, MBTableGridFooterView, MBTableGridContentView;
 @class MBTableGridCell, MBTableGridHeaderCell;
@@ -69,6 +72,18 @@ APPKIT_EXTERN NSString *MBTableGridDidMoveColumnsNotification;
  */
 APPKIT_EXTERN NSString *MBTableGridDidMoveRowsNotification;
 
+/**
+ * @brief		Returned by the data source in place of a value that is
+ *				still loading.
+ *
+ * @details		The grid draws a placeholder for the cell, and treats it
+ *				as empty when copying or searching. Once the value has
+ *				loaded, call \c noteValuesAvailableForColumns:rows: so that
+ *				the cell is redrawn. The grid compares against this object
+ *				by identity, so return it as is.
+ */
+APPKIT_EXTERN NSString * const MBTableGridPendingValue;
+
 APPKIT_EXTERN NSString *MBTableGridColumnDataType;
 APPKIT_EXTERN NSString *MBTableGridRowDataType;
 
@@ -82,6 +97,50 @@ typedef NS_ENUM(NSUInteger, MBVerticalEdge) {
     MBVerticalEdgeBottom
 };
 
+/**
+ * @brief		How the find bar's search text is matched against cells.
+ */
+typedef NS_ENUM(NSUInteger, MBTableGridFindMode) {
+    /** Cells containing the search text */
+    MBTableGridFindModeText,
+    /** Cells containing a match for the search text as a regular expression */
+    MBTableGridFindModeRegularExpression,
+    /** Cells containing a match for the search text as a wildcard pattern,
+        in which \c * matches any run of characters and \c ? any one */
+    MBTableGridFindModeWildcard
+};
+
+/**
+ * @brief		The formats cells can be exported in.
+ */
+typedef NS_ENUM(NSUInteger, MBTableGridExportFormat) {
+    /** Comma-separated text with CRLF line breaks, as in RFC 4180 */
+    MBTableGridExportFormatCommaSeparated,
+    /** Tab-separated text with line feeds */
+    MBTableGridExportFormatTabSeparated,
+    /** The compact binary format described in MBTableGridColumnarWriter.h,
+        which keeps each column's values together a group of rows at a time */
+    MBTableGridExportFormatColumnar
+};
+
+/**
+ * @brief		The summaries of a column a column footer can show.
+ */
+typedef NS_ENUM(NSUInteger, MBTableGridAggregateFunction) {
+    /** No summary; footers come only from the data source */
+    MBTableGridAggregateFunctionNone,
+    /** The total of the column's numbers */
+    MBTableGridAggregateFunctionSum,
+    /** The mean of the column's numbers */
+    MBTableGridAggregateFunctionAverage,
+    /** The least of the column's numbers */
+    MBTableGridAggregateFunctionMinimum,
+    /** The greatest of the column's numbers */
+    MBTableGridAggregateFunctionMaximum,
+    /** The number of the column's cells that aren't empty */
+    MBTableGridAggregateFunctionCount
+};
+
 /**
  * @brief		MBTableGrid (sometimes referred to as a table grid)
  *				is a means of displaying tabular data in a spreadsheet
@@ -144,6 +203,20 @@ typedef NS_ENUM(NSUInteger, MBVerticalEdge) {
 @property (nonatomic, assign) BOOL showsGrabHandles;
 @property (getter=isFindBarVisible) BOOL findBarVisible;
 
+/**
+ * @brief		How the find bar matches its search text against cells.
+ *
+ * @details		Regular expressions and wildcards are compiled once per
+ *				search and run over the UTF-8 text of each cell, so they
+ *				support the regular subset of the usual syntax: classes,
+ *				groups, alternation, quantifiers and anchors, but not
+ *				backreferences or lookaround. Ignoring case applies to
+ *				ASCII letters only. A search string that doesn't compile
+ *				matches nothing, and Replace replaces whole cells as it
+ *				does for text. The default is \c MBTableGridFindModeText.
+ */
+@property (nonatomic, assign) MBTableGridFindMode findMode;
+
 @property (getter=isColumnHeaderVisible, nonatomic, assign) BOOL columnHeaderVisible;
 @property (getter=isColumnFooterVisible, nonatomic, assign) BOOL columnFooterVisible;
 @property (getter=isRowHeaderVisible, nonatomic, assign) BOOL rowHeaderVisible;
@@ -160,7 +233,7 @@ typedef NS_ENUM(NSUInteger, MBVerticalEdge) {
 @property (nonatomic, readonly) NSView *trailingFooterCornerView;
 
 @property (nonatomic) NSEdgeInsets contentInsets;
-@property (nonatomic, assign) NSUInteger sortColumnIndex; // NSNotFound for none
+@property (nonatomic, assign) NSUInteger sortColumnIndex; // NSNotFound for none; setting it drops other sort columns
 @property (getter=isSortColumnAscending, nonatomic, assign) BOOL sortColumnAscending;
 
 - (void)setSelectedRowIndexes:(NSIndexSet *)anIndexSet notify:(BOOL)notify;
@@ -194,6 +267,52 @@ typedef NS_ENUM(NSUInteger, MBVerticalEdge) {
  */
 - (void)reloadData;
 
+/**
+ * @brief		Informs the receiver that the heights of the specified
+ *				rows have changed.
+ *
+ * @details		The receiver asks its data source for the new heights
+ *				of just these rows and updates its layout in place,
+ *				without reloading every row. This method has no effect
+ *				unless the data source implements \c tableGrid:heightForRow:
+ *				or \c tableGrid:getHeights:forRows:.
+ *
+ * @param		rowIndexes	The rows whose heights changed.
+ *
+ * @see			tableGrid:heightForRow:
+ */
+- (void)noteHeightOfRowsWithIndexesChanged:(NSIndexSet *)rowIndexes;
+
+/**
+ * @brief		Informs the receiver that rows have been added to or
+ *				removed from the end of its data source.
+ *
+ * @details		The receiver asks its data source for the number of rows
+ *				and updates its layout, redrawing only from the first row
+ *				added or removed. Columns, column widths and the values
+ *				of existing rows are assumed unchanged; call
+ *				\c reloadData if they may have changed too.
+ *
+ * @see			reloadData
+ */
+- (void)noteNumberOfRowsChanged;
+
+/**
+ * @brief		Informs the receiver that values it was given as pending
+ *				have finished loading.
+ *
+ * @details		This method may be called from any thread. The receiver
+ *				redraws just the affected cells on the main thread,
+ *				coalescing blocks reported in quick succession into one
+ *				update, and asks the data source for the values again.
+ *
+ * @param		columnRange	The columns of the block that finished loading.
+ * @param		rowRange	The rows of the block that finished loading.
+ *
+ * @see			MBTableGridPendingValue
+ */
+- (void)noteValuesAvailableForColumns:(NSRange)columnRange rows:(NSRange)rowRange;
+
 /**
  * @}
  */
@@ -219,15 +338,23 @@ typedef NS_ENUM(NSUInteger, MBVerticalEdge) {
 - (CGFloat)resizeColumnWithIndex:(NSUInteger)columnIndex withDistance:(float)distance location:(NSPoint)location;
 
 /**
- * @brief		Cache of column rects
+ * @brief		Widths of the columns the user has resized
  *
- * @return		A mutable dictionary containing the records for all the rows keyed by column index number
+ * @return		A mutable dictionary containing column widths keyed by column index number
  *
  */
-
-@property (nonatomic, readonly) NSMutableDictionary<NSNumber *, NSValue *> *columnRects;
 @property (nonatomic, readonly) NSMutableDictionary<NSNumber *, NSNumber *> *columnWidths;
 
+/**
+ * @brief		Discards the cached column geometry
+ *
+ * @details		Column offsets are computed once from the data source and
+ *				then updated in place as columns are resized. Call this
+ *				method if the data source's column widths change by some
+ *				other means; \c reloadData does so automatically.
+ */
+- (void)invalidateColumnWidths;
+
 
 - (void)resizeColumnWithIndex:(NSUInteger)columnIndex width:(float)w;
 
@@ -286,13 +413,25 @@ typedef NS_ENUM(NSUInteger, MBVerticalEdge) {
 /**
  * @brief		Returns the number of rows in the receiver.
  *
- * @return		The number of rows in the receiver.
+ * @return		The number of rows in the receiver, which is less than
+ *				the number of rows in the data source if some are hidden
+ *				by \c filterRowsWithPredicates:.
  *
  * @see			numberOfColumns
+ * @see			numberOfDataSourceRows
  */
 
 @property (nonatomic, assign) NSUInteger numberOfRows;
 
+/**
+ * @brief		Returns the number of rows in the data source, whether
+ *				shown or not.
+ *
+ * @see			numberOfRows
+ */
+
+@property (nonatomic, readonly) NSUInteger numberOfDataSourceRows;
+
 /**
  * @brief		Returns the number of columns in the receiver.
  *
@@ -338,8 +477,46 @@ cells. A cell can individually override this behavior. */
  */
 @property (nonatomic, strong) NSString *autosaveName;
 
+/**
+ * @brief		Whether the grid keeps an index of the text in its cells
+ *				to answer searches from the find bar.
+ *
+ * @details		The index is built the first time the find bar searches
+ *				for three or more characters, after which only the cells
+ *				that share every three-character sequence with the search
+ *				text are fetched and checked. Edits made through the grid
+ *				keep it up to date; \c reloadData and moving columns or
+ *				rows discard it, since the data source may then have
+ *				changed any cell. It suits large grids that are searched
+ *				more often than they change, at the cost of memory on the
+ *				order of the text itself. The default is \c NO.
+ */
+@property (nonatomic, assign) BOOL indexesCellsForFind;
+
 - (void)copy:(id)sender;
 
+/**
+ * @brief		Pastes tab- or comma-separated text into the grid.
+ *
+ * @details		The text is UTF-8, with fields quoted as in RFC 4180 where
+ *				needed, and its format is guessed from its first line. Each
+ *				pasted column is typed by what all of its fields hold, so
+ *				that a column of numbers arrives as numbers.
+ *
+ *				The text starts at the first of the given columns and rows.
+ *				If they name a single cell, all of it is pasted, and the
+ *				data source is asked to add columns and rows if it reaches
+ *				past the last ones; otherwise it is cut off at the last of
+ *				the given columns and rows. \c paste: calls this method
+ *				with the selection and the text on the general pasteboard
+ *				when the delegate doesn't implement
+ *				\c tableGrid:pasteCellsAtColumns:rows:.
+ *
+ * @return		\c NO if the text couldn't be read or the cells can't be
+ *				edited, otherwise \c YES.
+ */
+- (BOOL)pasteDelimitedData:(NSData *)data atColumns:(NSIndexSet *)columnIndexes rows:(NSIndexSet *)rowIndexes;
+
 
 /**
  * @}
@@ -512,6 +689,286 @@ cells. A cell can individually override this behavior. */
  */
 - (NSInteger)rowAtPoint:(NSPoint)aPoint;
 
+/**
+ * @}
+ */
+
+#pragma mark -
+#pragma mark Summarizing Cells
+
+/**
+ * @name		Summarizing Cells
+ */
+/**
+ * @{
+ */
+
+/**
+ * @brief		Returns the summary of a column's shown rows.
+ *
+ * @see			aggregateForColumns:rows:
+ */
+- (MBTableGridAggregate)aggregateForColumn:(NSUInteger)columnIndex;
+
+/**
+ * @brief		Returns the count, total, least and greatest of the
+ *				numbers, and the counts of other cells, in some of the
+ *				receiver's columns and rows.
+ *
+ * @details		The first time a column is summarized, it is read from
+ *				the data source in the data source's order, and a
+ *				summary of every block of rows is kept in a segment tree
+ *				(see \c MBTableGridAggregateIndex). After that, any run of
+ *				data source rows is summarized in logarithmic time,
+ *				reading only the partial blocks at its ends. Rows shown
+ *				in the data source's order, or every row of a column
+ *				however it is sorted, are summarized that way; a
+ *				selection of sorted rows is summarized a run of
+ *				adjacent data source rows at a time.
+ *
+ *				Cells set through the grid, pasted, or reported by
+ *				\c noteValuesAvailableForColumns:rows: are summarized
+ *				again a block at a time, as are rows added to or removed
+ *				from the end. Sorting, filtering, grouping and moving rows
+ *				or columns in the grid keep the summaries; moves made by
+ *				the data source and \c reloadData drop them, to be built
+ *				again when they are next needed. Cells changed by the
+ *				data source without the grid knowing aren't noticed
+ *				until \c reloadData.
+ *
+ *				Pending cells are counted in \c pendingCount and
+ *				otherwise left out.
+ *
+ * @param		columnIndexes	The columns to summarize; columns past the
+ *								last are ignored.
+ * @param		rowIndexes		The rows to summarize, as shown.
+ */
+- (MBTableGridAggregate)aggregateForColumns:(NSIndexSet *)columnIndexes rows:(NSIndexSet *)rowIndexes;
+
+/**
+ * @brief		The summary of the selected cells.
+ *
+ * @details		The delegate is sent \c tableGrid:didChangeSelectionAggregate:
+ *				when it changes.
+ *
+ * @see			aggregateForColumns:rows:
+ */
+@property (nonatomic, readonly) MBTableGridAggregate selectionAggregate;
+
+/**
+ * @brief		The summary of each column shown in its footer when the
+ *				data source doesn't supply a footer cell for it.
+ *
+ * @details		Setting a summary other than
+ *				\c MBTableGridAggregateFunctionNone shows the column
+ *				footers. Summaries cover the rows that are shown, and
+ *				are drawn again as cells change.
+ */
+@property (nonatomic, assign) MBTableGridAggregateFunction columnFooterAggregateFunction;
+
+/**
+ * @}
+ */
+
+#pragma mark -
+#pragma mark Row Order
+
+/**
+ * @name		Row Order
+ */
+/**
+ * @{
+ */
+
+/**
+ * @brief		Whether rows dragged to another place are moved in an order
+ *				the grid keeps of the data source rows, instead of by the
+ *				data source. The default is \c NO.
+ *
+ * @details		Moving rows in the data source costs it time in proportion
+ *				to every row after them, or every cell of those rows. The
+ *				grid's order is kept in blocks with a Fenwick tree over
+ *				them (see \c MBTableGridPermutation), so that moving \c k
+ *				of \c n rows costs <tt>O(k log n)</tt>. The order is made
+ *				on the first move, and the data source's order is left as
+ *				it is; \c dataSourceRowForRow: maps between the two, and
+ *				the data source is told of each move with
+ *				\c tableGrid:didMoveDataSourceRows:toRow: if it wants to
+ *				keep the order.
+ *
+ *				The data source's \c tableGrid:canMoveRows:toIndex: is
+ *				still asked, if it has one, with the rows as shown. Rows
+ *				the grid sorts, filters or groups can't be dragged, as
+ *				before, but they're sorted from the grid's order, so rows
+ *				that tie are in the order they were moved into.
+ *
+ *				Rows the data source adds go at the end of the order, or
+ *				anywhere in it with \c insertDataSourceRowsAtRow:, and rows
+ *				it removes are taken to be its last, as when rows added by
+ *				a fill are taken away again. Rows are taken out of the
+ *				order from anywhere with \c removeRowsFromRowOrder:, which
+ *				leaves them in the data source until it compacts itself;
+ *				a data source that removes other rows itself should set
+ *				the order again with \c setRowOrder:count:.
+ *
+ *				Columns are moved the same way with
+ *				\c movesColumnsByMapping. Turning this off goes back to
+ *				the data source's order.
+ */
+@property (nonatomic, assign) BOOL movesRowsByMapping;
+
+/**
+ * @brief		The number of data source rows in the grid's order: all of
+ *				them, less any taken out with \c removeRowsFromRowOrder:.
+ */
+@property (nonatomic, readonly) NSUInteger rowOrderCount;
+
+/**
+ * @brief		Copies the data source rows of part of the grid's order,
+ *				before any sorting, filtering or grouping, for example to
+ *				save it.
+ *
+ * @param		dataSourceRows	Room for \c range.length data source rows.
+ * @param		range			Positions in the order, of which there are
+ *								\c rowOrderCount.
+ */
+- (void)getRowOrder:(NSUInteger *)dataSourceRows range:(NSRange)range;
+
+/**
+ * @brief		Sets the grid's order of the data source rows, such as one
+ *				saved with \c getRowOrder:range:, and shows the rows in it.
+ *
+ * @param		dataSourceRows	Data source rows, each at most once, in the
+ *								order to show them, or \c NULL to go back to
+ *								the data source's order. Rows left out aren't
+ *								shown, as if taken out with
+ *								\c removeRowsFromRowOrder:.
+ * @param		count			The number of rows in the order.
+ *
+ * @return		\c NO if the rows aren't distinct data source rows or
+ *				memory runs out, in which case the order is unchanged.
+ */
+- (BOOL)setRowOrder:(const NSUInteger *)dataSourceRows count:(NSUInteger)count;
+
+/**
+ * @brief		Shows rows just added to the end of the data source at a
+ *				place in the grid's order, in <tt>O(k log n)</tt>.
+ *
+ * @details		Call it in place of \c noteNumberOfRowsChanged. The data
+ *				source is told of the move with
+ *				\c tableGrid:didMoveDataSourceRows:toRow:.
+ *
+ * @param		rowIndex		Where the first of the new rows goes in the
+ *								grid's order.
+ *
+ * @return		\c NO if no rows were added, \c movesRowsByMapping is off,
+ *				the rows are sorted, filtered or grouped, or memory runs
+ *				out, in which case any new rows are at the end of the
+ *				order.
+ */
+- (BOOL)insertDataSourceRowsAtRow:(NSUInteger)rowIndex;
+
+/**
+ * @brief		Takes rows out of the grid's order, in <tt>O(k log n)</tt>,
+ *				without the data source removing them.
+ *
+ * @details		Removing rows from the data source renumbers every row
+ *				after them, and so every data source row in the grid's
+ *				order. Rows taken out of the order instead stay in the
+ *				data source, shown nowhere, until it compacts itself:
+ *				it then removes them, sets the order again with the new
+ *				numbers with \c setRowOrder:count:, and calls
+ *				\c reloadData.
+ *
+ * @param		rowIndexes		Rows as shown, which may be sorted, filtered
+ *								or grouped.
+ *
+ * @return		\c NO if \c movesRowsByMapping is off, the rows aren't all
+ *				shown, or memory runs out.
+ */
+- (BOOL)removeRowsFromRowOrder:(NSIndexSet *)rowIndexes;
+
+/**
+ * @}
+ */
+
+#pragma mark -
+#pragma mark Column Order
+
+/**
+ * @name		Column Order
+ */
+/**
+ * @{
+ */
+
+/**
+ * @brief		Whether columns dragged to another place are moved in an
+ *				order the grid keeps of the data source columns, instead
+ *				of by the data source. The default is \c NO.
+ *
+ * @details		The order is kept as \c movesRowsByMapping keeps rows',
+ *				so that moving \c k of \c n columns costs
+ *				<tt>O(k log n)</tt> and the data source moves nothing. The
+ *				order is made on the first move; \c dataSourceColumnForColumn:
+ *				maps between the two, and the data source is told of each
+ *				move with \c tableGrid:didMoveDataSourceColumns:toColumn:
+ *				if it wants to keep the order.
+ *
+ *				The grid's methods and its delegate take columns as shown,
+ *				while the data source's methods take its own columns, as
+ *				do \c noteValuesAvailableForColumns:rows: and formulas'
+ *				cell references. The columns the rows are sorted,
+ *				filtered, grouped and summarized by, and the selection, go
+ *				with the columns they were on.
+ *
+ *				The data source's \c tableGrid:canMoveColumns:toIndex: is
+ *				still asked, if it has one. Columns it adds go at the end
+ *				of the order, and columns it removes are taken to be its
+ *				last; a data source that removes other columns should set
+ *				the order again with \c setColumnOrder:count:. Turning
+ *				this off goes back to the data source's order.
+ */
+@property (nonatomic, assign) BOOL movesColumnsByMapping;
+
+/**
+ * @brief		Returns the data source's column for a column as shown.
+ *
+ * @see			columnForDataSourceColumn:
+ */
+- (NSUInteger)dataSourceColumnForColumn:(NSUInteger)columnIndex;
+
+/**
+ * @brief		Returns the column a data source column is shown in.
+ *
+ * @see			dataSourceColumnForColumn:
+ */
+- (NSUInteger)columnForDataSourceColumn:(NSUInteger)dataSourceColumnIndex;
+
+/**
+ * @brief		Copies the data source columns of part of the grid's order,
+ *				for example to save it.
+ *
+ * @param		dataSourceColumns	Room for \c range.length data source
+ *									columns.
+ * @param		range				Columns as shown.
+ */
+- (void)getColumnOrder:(NSUInteger *)dataSourceColumns range:(NSRange)range;
+
+/**
+ * @brief		Sets the grid's order of the data source columns, such as
+ *				one saved with \c getColumnOrder:range:.
+ *
+ * @param		dataSourceColumns	Every data source column once, in the
+ *									order to show them, or \c NULL to go
+ *									back to the data source's order.
+ * @param		count				The number of columns in the order.
+ *
+ * @return		\c NO if the columns aren't every data source column once
+ *				or memory runs out, in which case the order is unchanged.
+ */
+- (BOOL)setColumnOrder:(const NSUInteger *)dataSourceColumns count:(NSUInteger)count;
+
 /**
  * @}
  */
@@ -598,6 +1055,468 @@ cells. A cell can individually override this behavior. */
 
 @end
 
+#pragma mark -
+#pragma mark Sorting
+
+@interface MBTableGrid (Sorting)
+
+/**
+ * @name		Sorting
+ */
+/**
+ * @{
+ */
+
+/**
+ * @brief		Whether the receiver sorts rows itself when a sort
+ *				indicator is clicked, rather than leaving it to the data
+ *				source.
+ *
+ * @details		The receiver reads the sort columns once, keeps a sort key
+ *				for each of their cells, and shows the rows in sorted
+ *				order without the data source moving anything: every
+ *				data source method that takes a row is sent the data
+ *				source's own row, as given by \c dataSourceRowForRow:.
+ *				Numbers and dates are sorted by value and strings
+ *				ignoring case, diacritics and width; rows with equal
+ *				values keep their order, and empty cells always come
+ *				last. Clicking the indicator a third time returns to the
+ *				data source's order straight away.
+ *
+ *				When the receiver sets cells in a sort column, by editing,
+ *				pasting or deleting, or when pending cells finish loading,
+ *				it reads just those cells again and moves their rows to
+ *				where they now belong, without sorting the other rows.
+ *				Rows added to the end of the data source are put where
+ *				they belong in the same way. The order is otherwise kept
+ *				when the receiver reloads, so values the data source
+ *				changes by itself take effect at the next sort; when rows
+ *				are removed the receiver sorts again. Delegate methods,
+ *				selections and \c NSIndexSet arguments not passed to the
+ *				data source are in the receiver's order. The default is
+ *				\c NO.
+ *
+ * @see			sortByColumns:ascendingColumns:
+ */
+@property (nonatomic, assign) BOOL sortsRows;
+
+/**
+ * @brief		The columns the rows are sorted by, as \c NSNumber
+ *				objects, with the most significant first.
+ *
+ * @details		The first is \c sortColumnIndex. Clicking a column's
+ *				sort indicator sorts by that column alone; Shift-clicking
+ *				it adds the column after the others, or reverses it, or
+ *				removes it, and the sort indicators of the columns are
+ *				numbered in order.
+ *
+ * @see			sortByColumns:ascendingColumns:
+ */
+@property (nonatomic, readonly) NSArray<NSNumber *> *sortColumnIndexes;
+
+/**
+ * @brief		Returns whether a column in \c sortColumnIndexes is
+ *				sorted from the smallest value.
+ */
+- (BOOL)isColumnSortedAscending:(NSUInteger)columnIndex;
+
+/**
+ * @brief		Sets the sort columns and, if \c sortsRows is \c YES,
+ *				sorts the rows by them.
+ *
+ * @details		Rows are sorted by the first column, then rows with equal
+ *				values by the second, and so on, and then by their order
+ *				in the data source. The data source's values are fetched
+ *				on this thread, and the keys sorted on every processor.
+ *
+ * @param		columnIndexes			The columns to sort by, most
+ *										significant first, or an empty
+ *										array to show the rows in the
+ *										data source's order.
+ * @param		ascendingColumnIndexes	The columns to sort from the
+ *										smallest value; the others are
+ *										sorted from the largest.
+ *
+ * @return		\c NO if the rows couldn't be sorted for lack of memory, in
+ *				which case they are shown in the data source's order.
+ */
+- (BOOL)sortByColumns:(NSArray<NSNumber *> *)columnIndexes ascendingColumns:(NSIndexSet *)ascendingColumnIndexes;
+
+/**
+ * @brief		Sets the sort column and, if \c sortsRows is \c YES,
+ *				sorts the rows by it.
+ *
+ * @details		The data source's values are fetched on this thread, and
+ *				the keys sorted on every processor.
+ *
+ * @param		columnIndex		The column to sort by, or \c NSNotFound to
+ *								show the rows in the data source's order.
+ * @param		ascending		Whether to sort from the smallest value.
+ *
+ * @return		\c NO if the rows couldn't be sorted for lack of memory, in
+ *				which case they are shown in the data source's order.
+ */
+- (BOOL)sortByColumn:(NSUInteger)columnIndex ascending:(BOOL)ascending;
+
+/**
+ * @brief		Returns the row of the data source shown at a row of the
+ *				receiver, which is the same row unless the receiver has
+ *				sorted or filtered its rows.
+ *
+ * @see			rowForDataSourceRow:
+ */
+- (NSUInteger)dataSourceRowForRow:(NSUInteger)rowIndex;
+
+/**
+ * @brief		Returns the row of the receiver that shows a row of the
+ *				data source, or \c NSNotFound if the row is hidden by
+ *				\c filterRowsWithPredicates:.
+ *
+ * @see			dataSourceRowForRow:
+ */
+- (NSUInteger)rowForDataSourceRow:(NSUInteger)dataSourceRowIndex;
+
+/**
+ * @}
+ */
+
+@end
+
+#pragma mark -
+#pragma mark Filtering
+
+@interface MBTableGrid (Filtering)
+
+/**
+ * @name		Filtering
+ */
+/**
+ * @{
+ */
+
+/**
+ * @brief		The predicates the shown rows match, or an empty array if
+ *				every row is shown.
+ *
+ * @see			filterRowsWithPredicates:
+ */
+@property (nonatomic, readonly) NSArray<MBTableGridFilterPredicate *> *filterPredicates;
+
+/**
+ * @brief		Shows only the data source rows that match every predicate,
+ *				in the data source's order or sorted as \c sortsRows
+ *				says.
+ *
+ * @details		Each predicate's column is read from the data source a
+ *				batch at a time, and the conditions on it tested against
+ *				the whole batch at once on every processor, so filtering
+ *				again costs one read of the filtered columns rather than
+ *				a copy of the data. Predicates on columns past the last
+ *				are ignored.
+ *
+ *				Like sorting, filtering only changes which data source row
+ *				each row shows: every data source method that takes a row
+ *				is sent the data source's own row, and selections, Find,
+ *				copying, exports and drags work on the rows that are
+ *				shown. Selected rows that are still shown stay selected.
+ *
+ *				Rows whose values are still pending are shown until their
+ *				values arrive, and hidden then if they don't match. Rows
+ *				added to the end of the data source are shown if they
+ *				match. Edited rows stay shown until the rows are filtered
+ *				again; when rows are removed from the data source, the
+ *				receiver filters again.
+ *
+ * @param		predicates	The predicates to match, or an empty array to
+ *							show every row.
+ *
+ * @return		\c NO if the rows couldn't be filtered for lack of memory,
+ *				in which case every row is shown.
+ */
+- (BOOL)filterRowsWithPredicates:(NSArray<MBTableGridFilterPredicate *> *)predicates;
+
+/**
+ * @}
+ */
+
+@end
+
+#pragma mark -
+#pragma mark Grouping
+
+@interface MBTableGrid (Grouping)
+
+/**
+ * @name		Grouping
+ */
+/**
+ * @{
+ */
+
+/**
+ * @brief		The column the shown rows are grouped by, or \c NSNotFound
+ *				if they aren't grouped.
+ *
+ * @see			groupRowsByColumn:
+ */
+@property (nonatomic, readonly) NSUInteger groupColumnIndex;
+
+/**
+ * @brief		Gathers the shown rows into groups with the same value in
+ *				a column.
+ *
+ * @details		The column is read from the data source a batch at a
+ *				time, and each batch's values are looked up in a hash
+ *				table of the column's distinct values on every processor
+ *				(see \c MBTableGridGroupTable). Groups are shown in the
+ *				order their first rows would be shown sorted and filtered
+ *				as they are, and each group's rows keep that order, so
+ *				grouping by a sort column shows the groups in sorted
+ *				order. Numbers are grouped by value, whether integers or
+ *				not, and strings by their characters.
+ *
+ *				The first row of each group heads it: the row header
+ *				draws a disclosure indicator there, and clicking it
+ *				collapses the group to that row. The row footer draws
+ *				one cell beside each group's rows, from
+ *				\c tableGrid:footerCellForGroup: or
+ *				\c groupFooterAggregateFunction.
+ *
+ *				As with sorting and filtering, only which data source row
+ *				each row shows changes. Editing a cell in the grouping
+ *				column, or one that is sorted by, moves the edited rows
+ *				out of their old groups and into their new ones by
+ *				binary search, reading only the edited rows. The rows
+ *				are grouped again from the values already read only if
+ *				that could change the order of the groups, or while a
+ *				group is collapsed. Rows added to the end of the data source join
+ *				their groups, and pending values are grouped as empty
+ *				until they arrive.
+ *
+ * @param		columnIndex		The column to group by, or \c NSNotFound to
+ *								stop grouping.
+ *
+ * @return		\c NO if the rows couldn't be grouped for lack of memory,
+ *				in which case they aren't.
+ */
+- (BOOL)groupRowsByColumn:(NSUInteger)columnIndex;
+
+/**
+ * @brief		The number of groups with shown rows, or 0 if the rows
+ *				aren't grouped.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfGroups;
+
+/**
+ * @brief		Returns the group a shown row is in, or \c NSNotFound if
+ *				the rows aren't grouped.
+ */
+- (NSUInteger)groupOfRow:(NSUInteger)rowIndex;
+
+/**
+ * @brief		Returns the rows a group is shown in; the first heads
+ *				it, and a collapsed group is shown in that row alone.
+ */
+- (NSRange)rowRangeOfGroup:(NSUInteger)groupIndex;
+
+/**
+ * @brief		Returns the number of data source rows in a group,
+ *				whether collapsed or not.
+ */
+- (NSUInteger)numberOfRowsInGroup:(NSUInteger)groupIndex;
+
+/**
+ * @brief		Returns the value a group's rows share in the grouping
+ *				column, as an \c NSNumber, \c NSDate or \c NSString, or
+ *				\c nil for empty cells.
+ */
+- (id)keyOfGroup:(NSUInteger)groupIndex;
+
+- (BOOL)isGroupCollapsed:(NSUInteger)groupIndex;
+
+/**
+ * @brief		Collapses a group to the row that heads it, or shows
+ *				all its rows again.
+ *
+ * @details		The rows are shown again from the groups already
+ *				formed, without reading or sorting anything, and selected
+ *				rows that are still shown stay selected. Groups stay
+ *				collapsed as rows are edited and grouped again, until the
+ *				grid is grouped by another column.
+ */
+- (void)setGroup:(NSUInteger)groupIndex collapsed:(BOOL)collapsed;
+
+/**
+ * @brief		Collapses every group, or shows the rows of every group.
+ */
+- (void)setAllGroupsCollapsed:(BOOL)collapsed;
+
+/**
+ * @brief		Returns the summary of a column's cells in every row of a
+ *				group, collapsed or not.
+ *
+ * @details		The first time a column is summarized by group, it is
+ *				read from the data source in the data source's order,
+ *				and each chunk of rows is summarized into every group on
+ *				its own processor, so summarizing a group is a lookup
+ *				after that. Editing the column summarizes it again when
+ *				it's next needed.
+ *
+ * @see			aggregateForColumns:rows:
+ */
+- (MBTableGridAggregate)aggregateForGroup:(NSUInteger)groupIndex column:(NSUInteger)columnIndex;
+
+/**
+ * @brief		The summary shown in the row footer beside each group
+ *				when the data source doesn't supply a cell for it.
+ *
+ * @details		Groups are summarized on \c groupFooterColumnIndex, or
+ *				with \c MBTableGridAggregateFunctionCount and no column,
+ *				counted by their rows. Setting a summary other than
+ *				\c MBTableGridAggregateFunctionNone shows the row footers.
+ */
+@property (nonatomic, assign) MBTableGridAggregateFunction groupFooterAggregateFunction;
+
+/**
+ * @brief		The column summarized in the footer beside each group,
+ *				or \c NSNotFound. The default is \c NSNotFound.
+ */
+@property (nonatomic, assign) NSUInteger groupFooterColumnIndex;
+
+/**
+ * @}
+ */
+
+@end
+
+#pragma mark -
+#pragma mark Formulas
+
+@interface MBTableGrid (Formulas)
+
+/**
+ * @name		Formulas
+ */
+/**
+ * @{
+ */
+
+/**
+ * @brief		Whether text starting with \c = that is entered in a cell
+ *				is evaluated as a formula, such as <tt>=SUM(A1:A10)</tt>.
+ *				The default is \c NO.
+ *
+ * @details		The data source is still given the text, to keep, and the
+ *				grid shows the formula's result in its place (see
+ *				\c MBTableGridFormula for what formulas can do). Cells are
+ *				referred to by data source column and row, so formulas
+ *				keep referring to the same cells however the rows are
+ *				sorted, filtered or grouped, or the rows or columns are
+ *				moved by mapping.
+ *
+ *				The grid keeps each formula's references in a dependency
+ *				graph (see \c MBTableGridFormulaSheet). Editing a cell
+ *				evaluates only the formulas that depend on it, in
+ *				topological order, with the formulas that don't depend on
+ *				each other evaluated in parallel, and redraws and
+ *				summarizes again only the cells whose results changed. A
+ *				formula that depends on itself shows \c #CYCLE!.
+ *
+ *				Formulas entered before the data source was last loaded
+ *				aren't known to the grid; set them again with
+ *				\c setFormula:forColumn:dataSourceRow:. Turning formulas
+ *				off forgets them all.
+ */
+@property (nonatomic, assign) BOOL evaluatesFormulas;
+
+/**
+ * @brief		Sets the formula of a cell, without changing the data
+ *				source, and evaluates it and every formula that depends on
+ *				the cell.
+ *
+ * @param		formula			The formula's text, which may start with
+ *								\c =, or \c nil to remove the cell's formula.
+ *
+ * @return		\c NO if formulas aren't evaluated, the text isn't a
+ *				formula, or memory runs out, in which case the cell has no
+ *				formula.
+ */
+- (BOOL)setFormula:(NSString *)formula forColumn:(NSUInteger)columnIndex dataSourceRow:(NSUInteger)rowIndex;
+
+/**
+ * @brief		Returns the text of a cell's formula, or \c nil if the cell
+ *				has none.
+ */
+- (NSString *)formulaForColumn:(NSUInteger)columnIndex dataSourceRow:(NSUInteger)rowIndex;
+
+/**
+ * @brief		Forgets every formula, so that cells show the data
+ *				source's values again.
+ */
+- (void)removeAllFormulas;
+
+/**
+ * @}
+ */
+
+@end
+
+#pragma mark -
+#pragma mark Exporting
+
+@interface MBTableGrid (Exporting)
+
+/**
+ * @name		Exporting
+ */
+/**
+ * @{
+ */
+
+/**
+ * @brief		Writes a block of cells to a file descriptor in the
+ *				background.
+ *
+ * @details		Cells are fetched from the data source in batches, the
+ *				same way Find fetches them, so memory use doesn't grow
+ *				with the number of cells. The data source is therefore
+ *				asked for values on a background thread, and should not
+ *				change the exported cells until the export finishes.
+ *				Pending values are written as empty cells.
+ *
+ *				Cancelling the returned progress stops the export after
+ *				the current batch. The file descriptor is neither closed
+ *				nor truncated, so whatever was written before the export
+ *				stopped remains.
+ *
+ * @param		columnIndexes		The columns to export, in order, or
+ *									\c nil for every column.
+ * @param		rowIndexes			The rows to export, in order, or \c nil
+ *									for every row.
+ * @param		fileDescriptor		Where to write, which must stay open
+ *									until the export finishes.
+ * @param		format				The format to write.
+ * @param		includeHeaders		Whether to start with the column
+ *									headers, as a record of delimited text
+ *									or as the columnar format's column names.
+ * @param		completionHandler	Called on the main thread when the
+ *									export stops, with \c YES if every cell
+ *									was written, or \c NO if it was
+ *									cancelled or a write failed.
+ *
+ * @return		The progress of the export, counted in rows, which can be
+ *				observed and cancelled from any thread.
+ */
+- (NSProgress *)exportColumns:(NSIndexSet *)columnIndexes rows:(NSIndexSet *)rowIndexes
+             toFileDescriptor:(int)fileDescriptor format:(MBTableGridExportFormat)format
+               includeHeaders:(BOOL)includeHeaders completionHandler:(void (^)(BOOL succeeded))completionHandler;
+
+/**
+ * @}
+ */
+
+@end
+
 #pragma mark -
 
 /**
@@ -671,7 +1590,8 @@ cells. A cell can individually override this behavior. */
  * @param		columnIndex		A column in \c aTableGrid.
  * @param		rowIndex		A row in \c aTableGrid.
  *
- * @return		The object for the specified cell of the view.
+ * @return		The object for the specified cell of the view, or
+ *				\c MBTableGridPendingValue if it is still loading.
  *
  * @see            tableGrid:setObjectValue:forColumn:row:
  * @see            tableGrid:setObjectValue:forColumns:rows:
@@ -727,6 +1647,139 @@ cells. A cell can individually override this behavior. */
  */
 - (void)tableGrid:(MBTableGrid *)aTableGrid setObjectValue:(id)anObject forColumns:(NSIndexSet *)columnIndexes rows:(NSIndexSet *)rowIndexes;
 
+@optional
+
+/**
+ * @brief        Fills a buffer with the data objects for a block of cells.
+ *
+ * @details      When implemented, this method is preferred over
+ *               \c tableGrid:objectValueForColumn:row: for drawing,
+ *               tool tips, Find and Copy, so that a block of visible
+ *               cells costs one lookup rather than one per cell. Before
+ *               drawing a cell returned by \c tableGrid:cellForColumn:row:,
+ *               the grid sets its \c objectValue from the buffer.
+ *
+ *               Values are laid out column by column: the value for
+ *               \c columnIndex and \c rowIndex belongs at
+ *               <tt>values[(columnIndex - columnRange.location) * rowRange.length
+ *               + (rowIndex - rowRange.location)]</tt>. Cells left \c nil
+ *               are drawn empty. The grid asks for at most a few thousand
+ *               cells at a time, and may do so from a background thread
+ *               during Find or an export.
+ *
+ * @param        aTableGrid        The table grid that sent the message.
+ * @param        values            A buffer of <tt>columnRange.length * rowRange.length</tt> values, initially \c nil.
+ * @param        columnRange       The columns whose values should be written to \c values.
+ * @param        rowRange          The rows whose values should be written to \c values.
+ *
+ * @see            tableGrid:objectValueForColumn:row:
+ */
+- (void)tableGrid:(MBTableGrid *)aTableGrid getObjectValues:(id __strong *)values forColumns:(NSRange)columnRange rows:(NSRange)rowRange;
+
+@optional
+
+/**
+ * @brief        Fills a buffer with typed values for a block of cells,
+ *               without creating any objects.
+ *
+ * @details      When implemented, this method is preferred over the
+ *               object value methods for drawing, Find and Copy. Copy
+ *               and Find format the values directly, and drawing wraps
+ *               them in the cheapest object a cell can display (numbers
+ *               as \c NSNumber, strings without copying their bytes).
+ *
+ *               The buffer is laid out like the one passed to
+ *               \c tableGrid:getObjectValues:forColumns:rows:, and is zeroed
+ *               (every value empty) before each call. Strings are
+ *               borrowed, so their bytes must remain valid until the next
+ *               time the grid calls this method.
+ *
+ * @param        aTableGrid        The table grid that sent the message.
+ * @param        values            A buffer of <tt>columnRange.length * rowRange.length</tt> values.
+ * @param        columnRange       The columns whose values should be written to \c values.
+ * @param        rowRange          The rows whose values should be written to \c values.
+ *
+ * @see            tableGrid:getObjectValues:forColumns:rows:
+ */
+- (void)tableGrid:(MBTableGrid *)aTableGrid getValues:(MBTableGridValue *)values forColumns:(NSRange)columnRange rows:(NSRange)rowRange;
+
+@optional
+
+/**
+ * @brief        Sets a block of cells from typed values, without creating
+ *               any objects.
+ *
+ * @details      When implemented, this method is preferred over the
+ *               object value setters for pasting, so that a large paste
+ *               costs one call per batch of cells rather than one per
+ *               cell. Numbers, Booleans and dates arrive already parsed,
+ *               typed by what the pasted text holds in each column.
+ *
+ *               The buffer is laid out like the one passed to
+ *               \c tableGrid:getValues:forColumns:rows:. Empty values
+ *               stand for empty cells. Strings are borrowed, so their
+ *               bytes must be copied if they are kept after this method
+ *               returns.
+ *
+ * @param        aTableGrid        The table grid that sent the message.
+ * @param        values            <tt>columnRange.length * rowRange.length</tt> values.
+ * @param        columnRange       The columns to set.
+ * @param        rowRange          The rows to set.
+ *
+ * @see            tableGrid:getValues:forColumns:rows:
+ * @see            tableGrid:setObjectValue:forColumn:row:
+ */
+- (void)tableGrid:(MBTableGrid *)aTableGrid setValues:(const MBTableGridValue *)values forColumns:(NSRange)columnRange rows:(NSRange)rowRange;
+
+@optional
+
+/**
+ * @brief        Tells the data source that a block of cells is likely to
+ *               be displayed soon.
+ *
+ * @details      While the grid scrolls, it estimates where the visible
+ *               area will be in the near future from the scrolling speed,
+ *               and sends this message for the cells just past the leading
+ *               edge. Use it to start loading slow values (e.g. from disk
+ *               or a database) so that they are ready when drawn. The
+ *               message is sent on the main thread and should return
+ *               quickly; do the actual loading asynchronously.
+ *
+ *               The ranges are the data source's columns and rows. When
+ *               columns have been moved, or rows sorted, filtered, grouped
+ *               or moved, the cells coming into view are sent as several
+ *               blocks, one for each run of them that is together in the
+ *               data source.
+ *
+ * @param        aTableGrid        The table grid that sent the message.
+ * @param        columnRange       The columns of the block.
+ * @param        rowRange          The rows of the block.
+ *
+ * @see            tableGrid:cancelPrefetchingColumns:rows:
+ */
+- (void)tableGrid:(MBTableGrid *)aTableGrid prefetchColumns:(NSRange)columnRange rows:(NSRange)rowRange;
+
+/**
+ * @brief        Tells the data source that a block of cells passed to
+ *               \c tableGrid:prefetchColumns:rows: is no longer expected
+ *               to be displayed soon.
+ *
+ * @details      Sent when the predicted block changes, e.g. because
+ *               scrolling changed direction, just before the new block is
+ *               requested; when scrolling stops; and when the grid reloads
+ *               or its rows or columns change order, with the same ranges
+ *               the block was requested with. The two blocks may overlap,
+ *               so treat this as a hint to lower the priority of pending
+ *               loads rather than discarding them.
+ *
+ * @param        aTableGrid        The table grid that sent the message.
+ * @param        columnRange       The columns of the previously requested block.
+ * @param        rowRange          The rows of the previously requested block.
+ *
+ * @see            tableGrid:prefetchColumns:rows:
+ */
+- (void)tableGrid:(MBTableGrid *)aTableGrid cancelPrefetchingColumns:(NSRange)columnRange rows:(NSRange)rowRange;
+
 
 @optional
 
@@ -752,6 +1805,61 @@ cells. A cell can individually override this behavior. */
  */
 - (float) tableGrid:(MBTableGrid *)aTableGrid widthForColumn:(NSUInteger)columnIndex;
 
+/**
+ * @brief        Fills a buffer with the widths (in points) of a range of columns.
+ *
+ * @details      When implemented, this method is preferred over
+ *               \c tableGrid:widthForColumn:, and is called once for all
+ *               columns whenever the grid rebuilds its column geometry
+ *               (e.g. on \c reloadData). Widths that are left at zero or
+ *               below the minimum column width are replaced by the
+ *               minimum width or by the width the user last resized
+ *               the column to.
+ *
+ * @param        aTableGrid        The table grid that sent the message.
+ * @param        widths            A buffer of \c columnRange.length widths, initially zero.
+ * @param        columnRange       The columns whose widths should be written to \c widths.
+ *
+ * @see          tableGrid:widthForColumn:
+ */
+- (void)tableGrid:(MBTableGrid *)aTableGrid getWidths:(float *)widths forColumns:(NSRange)columnRange;
+
+/**
+ * @brief        Returns the height (in points) of the given row.
+ *
+ * @details      Implement this method (or \c tableGrid:getHeights:forRows:)
+ *               to display rows of differing heights, e.g. for wrapped
+ *               or multi-line text. Rows for which it returns zero use
+ *               the content view's \c rowHeight. When neither method
+ *               is implemented, every row is \c rowHeight tall.
+ *
+ *               Heights are requested once for all rows by \c reloadData,
+ *               and again for individual rows by
+ *               \c noteHeightOfRowsWithIndexesChanged:.
+ *
+ * @param        aTableGrid        The table grid that sent the message.
+ * @param        rowIndex          A row in \c aTableGrid.
+ *
+ * @see          tableGrid:getHeights:forRows:
+ * @see          noteHeightOfRowsWithIndexesChanged:
+ */
+- (float)tableGrid:(MBTableGrid *)aTableGrid heightForRow:(NSUInteger)rowIndex;
+
+/**
+ * @brief        Fills a buffer with the heights (in points) of a range of rows.
+ *
+ * @details      When implemented, this method is preferred over
+ *               \c tableGrid:heightForRow:. Heights that are left at
+ *               zero use the content view's \c rowHeight.
+ *
+ * @param        aTableGrid        The table grid that sent the message.
+ * @param        heights           A buffer of \c rowRange.length heights, initially zero.
+ * @param        rowRange          The rows whose heights should be written to \c heights.
+ *
+ * @see          tableGrid:heightForRow:
+ */
+- (void)tableGrid:(MBTableGrid *)aTableGrid getHeights:(float *)heights forRows:(NSRange)rowRange;
+
 /**
  * @}
  */
@@ -827,6 +1935,23 @@ cells. A cell can individually override this behavior. */
  */
 - (NSCell *)tableGrid:(MBTableGrid *)aTableGrid footerCellForRow:(NSUInteger)rowIndex;
 
+/**
+ *  @brief      Returns the cell for the footer beside a group's rows,
+ *              when the rows are grouped.
+ *
+ * @details        Optional; if not implemented, or returns nil, the
+ *                group's \c groupFooterAggregateFunction is displayed.
+ *                The cell is drawn once, across every row of the group.
+ *
+ *  @param      aTableGrid  The table grid that sent the message.
+ *  @param      groupIndex A group in \c aTableGrid.
+ *
+ *  @return     The cell for the specified group footer.
+ *
+ *  @see        aggregateForGroup:column:
+ */
+- (NSCell *)tableGrid:(MBTableGrid *)aTableGrid footerCellForGroup:(NSUInteger)groupIndex;
+
 
 /**
  * @brief		Returns the data object for the footer of the specified column.
@@ -948,6 +2073,41 @@ cells. A cell can individually override this behavior. */
  */
 - (BOOL)tableGrid:(MBTableGrid *)aTableGrid moveRows:(NSIndexSet *)rowIndexes toIndex:(NSUInteger)index;
 
+/**
+ * @brief		Informs the data source that rows were moved in the grid's
+ *				order, when \c movesRowsByMapping is on, without changing
+ *				the data source.
+ *
+ * @param		aTableGrid			The table grid that sent the message.
+ * @param		dataSourceRowIndexes	The data source rows that were moved.
+ * @param		rowIndex			The position in the grid's order of the
+ *									first of them. The rest follow it in
+ *									the order they were shown in, which
+ *									\c getRowOrder:range: gives.
+ *
+ * @see			movesRowsByMapping
+ * @see			getRowOrder:range:
+ */
+- (void)tableGrid:(MBTableGrid *)aTableGrid didMoveDataSourceRows:(NSIndexSet *)dataSourceRowIndexes toRow:(NSUInteger)rowIndex;
+
+/**
+ * @brief		Informs the data source that columns were moved in the
+ *				grid's order, when \c movesColumnsByMapping is on, without
+ *				changing the data source.
+ *
+ * @param		aTableGrid			The table grid that sent the message.
+ * @param		dataSourceColumnIndexes	The data source columns that were
+ *									moved.
+ * @param		columnIndex			The column the first of them is shown
+ *									in. The rest follow it in the order
+ *									they were shown in, which
+ *									\c getColumnOrder:range: gives.
+ *
+ * @see			movesColumnsByMapping
+ * @see			getColumnOrder:range:
+ */
+- (void)tableGrid:(MBTableGrid *)aTableGrid didMoveDataSourceColumns:(NSIndexSet *)dataSourceColumnIndexes toColumn:(NSUInteger)columnIndex;
+
 #pragma mark Other Values
 
 /**
@@ -1007,6 +2167,23 @@ cells. A cell can individually override this behavior. */
  */
 - (BOOL)tableGrid:(MBTableGrid *)aTableGrid addRows:(NSUInteger)numberOfRows;
 
+/**
+ * @brief		Returns a Boolean value indicating whether the columns
+ *				were successfully added.
+ *
+ * @details		The data source should take care of modifiying the data model to
+ *				add the columns. The grid asks for columns, and rows, when
+ *				text pasted into a single cell reaches past the last ones.
+ *
+ * @param		aTableGrid		The table grid that sent the message.
+ * @param		numberOfColumns	The number of columns to add.
+ *
+ * @return		\c YES if the add was successful, otherwise \c NO.
+ *
+ * @see			tableGrid:addRows:
+ */
+- (BOOL)tableGrid:(MBTableGrid *)aTableGrid addColumns:(NSUInteger)numberOfColumns;
+
 /**
  * @brief		Returns a Boolean value indicating whether the specified rows
  *				were removed.
@@ -1029,9 +2206,9 @@ cells. A cell can individually override this behavior. */
 /**
  * @brief        Returns an index set indicating which columns in the table grid can be sorted.
  *
- * @details      The data source is responsible for sorting the data. The current sort specification
- *               can be accessed via the table grid's \c sortColumnIndex and \c isSortColumnAscending
- *               properties.
+ * @details      The data source is responsible for sorting the data, unless the table grid's
+ *               \c sortsRows is \c YES. The current sort specification can be accessed via the
+ *               table grid's \c sortColumnIndexes property and \c isColumnSortedAscending: method.
  *
  * @param        aTableGrid        The table grid that sent the message.
  *
@@ -1110,6 +2287,21 @@ cells. A cell can individually override this behavior. */
  */
 - (void)tableGridDidChangeSelection:(NSNotification *)aNotification;
 
+/**
+ * @brief		Tells the delegate the summary of the selected cells, after
+ *				the selection or the cells in it change.
+ *
+ * @details		Changes made while handling one event, such as the
+ *				columns and rows of a selection being dragged out, are
+ *				reported once, after the event.
+ *
+ * @param		aTableGrid		The table grid whose selection changed.
+ * @param		aggregate		The summary of the selected cells.
+ *
+ * @see			selectionAggregate
+ */
+- (void)tableGrid:(MBTableGrid *)aTableGrid didChangeSelectionAggregate:(MBTableGridAggregate)aggregate;
+
 /**
  * @brief		Tells the delegate that the specified column header was double-clicked
  *
@@ -1232,6 +2424,23 @@ cells. A cell can individually override this behavior. */
  */
 - (BOOL)tableGrid:(MBTableGrid *)aTableGrid shouldEditColumn:(NSUInteger)columnIndex row:(NSUInteger)rowIndex;
 
+/**
+ * @brief		Asks the delegate if a block of cells can be edited.
+ *
+ * @details		When implemented, the grid asks this in place of
+ *				\c tableGrid:shouldEditColumn:row: before changing many
+ *				cells at once, such as when replacing every match from the
+ *				find bar. The block is every combination of the given
+ *				columns and rows.
+ *
+ * @param		aTableGrid		The table grid which will edit the cells.
+ * @param		columnIndexes	The columns of the cells.
+ * @param		rowIndexes		The rows of the cells.
+ *
+ * @return		\c YES to permit \c aTableGrid to edit every cell in the block, \c NO to deny permission.
+ */
+- (BOOL)tableGrid:(MBTableGrid *)aTableGrid shouldEditColumns:(NSIndexSet *)columnIndexes rows:(NSIndexSet *)rowIndexes;
+
 /**
  *  @brief      Informs the delegate of the cells that should be copied to the clipboard.
  *
@@ -1244,6 +2453,9 @@ cells. A cell can individually override this behavior. */
 /**
  *  @brief      Informs the delegate of the cells that should be pasted from the clipboard.
  *
+ *  @details    If this method isn't implemented, the grid pastes tab- or
+ *              comma-separated text itself with \c pasteDelimitedData:atColumns:rows:.
+ *
  *  @param      aTableGrid       The table grid that contains the cell.
  *  @param      columnIndexes    Column indexes of the cells being copied.
  *  @param      rowIndexes       Row indexes of the cells being copied.
@@ -1274,6 +2486,9 @@ cells. A cell can individually override this behavior. */
 /**
  * @brief        Tells the delegate that the table grid's sort specification has changed.
  *
+ * @details      \c columnIndex is the most significant sort column; the others are in the
+ *               table grid's \c sortColumnIndexes.
+ *
  * @param        aTableGrid        The table grid that sent the message.
  * @param        columnIndex      The column that should be sorted by, or \c NSNotFound if no sorting should occur.
  * @param        isAscending      \c YES if the items should be sorted in ascending order; \c NO otherwise
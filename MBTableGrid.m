@@ -30,14 +30,30 @@
 #import "MBTableGridContentView.h"
 #import "MBTableGridContentScrollView.h"
 #import "MBTableGridTextFinderClient.h"
+#import "MBTableGridCopyDataProvider.h"
 #import "MBTableGridCell.h"
+#import "MBTableGridGeometry.h"
+#import "MBTableGridTrigramIndex.h"
+#import "MBTableGridDelimitedWriter.h"
+#import "MBTableGridDelimitedReader.h"
+#import "MBTableGridColumnarWriter.h"
+#import "MBTableGridSort.h"
+#import "MBTableGridRowPermutation.h"
+#import "MBTableGridFilter.h"
+#import "MBTableGridBitmap.h"
+#import "MBTableGridGroup.h"
+#import "MBTableGridFormulaSheet.h"
 #import "NSScrollView+InsetRectangles.h"
+#import "MBTableGrid+Private.h"
+#import <stdatomic.h>
+#import <os/lock.h>
 
 #pragma mark -
 #pragma mark Constant Definitions
 NSString *MBTableGridDidChangeSelectionNotification     = @"MBTableGridDidChangeSelectionNotification";
 NSString *MBTableGridDidMoveColumnsNotification         = @"MBTableGridDidMoveColumnsNotification";
 NSString *MBTableGridDidMoveRowsNotification            = @"MBTableGridDidMoveRowsNotification";
+NSString * const MBTableGridPendingValue                = @"MBTableGridPendingValue";
 CGFloat MBTableHeaderSortIndicatorWidth = 10.0;
 CGFloat MBTableHeaderSortIndicatorMargin = 4.0;
 CGFloat MBTableHeaderResizeLastColumnMargin = 4.0; // Need the header view to extend slightly past the rightmost column to catch clicks
@@ -47,6 +63,10 @@ CGFloat MBTableHeaderResizeLastColumnMargin = 4.0; // Need the header view to ex
 #define MBTableGridColumnFooterHeight 24.0
 #define MBTableGridRowHeaderWidth 56.0
 #define MBTableGridRowFooterWidth 24.0
+#define MBTableGridPasteBatchSize 65536
+#define MBTableGridPrefetchLookahead 0.5 // seconds of scrolling to prefetch
+#define MBTableGridPrefetchMaximumPages 4.0
+#define MBTableGridPrefetchVelocityTimeout 0.25
 
 #pragma mark -
 #pragma mark Drag Types
@@ -56,19 +76,6 @@ NSString *MBTableGridRowDataType = @"mbtablegrid.pasteboard.row";
 @interface MBTableGrid (Drawing)
 @end
 
-@interface MBTableGrid (DataAccessors)
-- (NSString *)_headerStringForColumn:(NSUInteger)columnIndex;
-- (NSString *)_headerStringForRow:(NSUInteger)rowIndex;
-- (void)_setObjectValue:(id)value forColumn:(NSUInteger)columnIndex row:(NSUInteger)rowIndex;
-- (void)_setObjectValue:(id)value forColumns:(NSIndexSet *)columnIndexes rows:(NSIndexSet *)rowIndexes;
-- (CGFloat)_minimumWidthForColumn:(NSUInteger)columnIndex;
-- (CGFloat)_widthForColumn:(NSUInteger)columnIndex;
-- (void)_setWidth:(CGFloat) width forColumn:(NSUInteger)columnIndex;
-- (BOOL)_canEditCellAtColumn:(NSUInteger)columnIndex row:(NSUInteger)rowIndex;
-- (NSCell *)_footerCellForColumn:(NSUInteger)columnIndex;
-- (NSCell *)_footerCellForRow:(NSUInteger)rowIndex;
-@end
-
 @interface MBTableGrid (DragAndDrop)
 - (void)_dragColumnsWithEvent:(NSEvent *)theEvent;
 - (void)_dragRowsWithEvent:(NSEvent *)theEvent;
@@ -115,10 +122,87 @@ NS_INLINE MBVerticalEdge MBOppositeVerticalEdge(MBVerticalEdge other) {
     return (other == MBVerticalEdgeTop) ? MBVerticalEdgeBottom : MBVerticalEdgeTop;
 }
 
-@interface MBTableGrid ()
-@property (nonatomic, readwrite, assign) MBHorizontalEdge previousHorizontalSelectionDirection;
-@property (nonatomic, readwrite, assign) MBVerticalEdge previousVerticalSelectionDirection;
-@end
+static bool MBAppendToData(void *context, const char *bytes, size_t length) {
+    [(__bridge NSMutableData *)context appendBytes:bytes length:length];
+    return true;
+}
+
+// Converts a data object to a typed value. Strings borrow the object's UTF-8
+// bytes, so the value mustn't outlive the object or the autorelease pool.
+MBTableGridValue MBValueForObject(id object) {
+    if (object == nil || object == MBTableGridPendingValue || object == [NSNull null])
+        return (MBTableGridValue){ .type = MBTableGridValueTypeEmpty };
+    if ([object isKindOfClass:[NSNumber class]]) {
+        NSNumber *number = object;
+        if (CFGetTypeID((__bridge CFTypeRef)number) == CFBooleanGetTypeID())
+            return MBTableGridValueMakeBoolean(number.boolValue);
+        if (CFNumberIsFloatType((__bridge CFNumberRef)number))
+            return MBTableGridValueMakeDouble(number.doubleValue);
+        return MBTableGridValueMakeInteger(number.longLongValue);
+    }
+    if ([object isKindOfClass:[NSDate class]])
+        return MBTableGridValueMakeDate([object timeIntervalSince1970]);
+    
+    NSString *string = [object isKindOfClass:[NSString class]] ? object : [object description];
+    const char *bytes = string.UTF8String ?: "";
+    return MBTableGridValueMakeString(bytes, strlen(bytes));
+}
+
+void MBApplyConcurrently(size_t iterations, void *context, MBTableGridSortWorkFunction work) {
+    dispatch_apply_f(iterations, DISPATCH_APPLY_AUTO, context, work);
+}
+
+// The place each of count columns goes when columnIndexes move to start at columnIndex,
+// the others keeping their order around them. Returns NULL if out of memory.
+static NSUInteger *MBNewIndexesForMove(NSIndexSet *indexes, NSUInteger index, NSUInteger count) {
+    NSUInteger *newIndexes = malloc(MAX(1, count) * sizeof(NSUInteger));
+    if (newIndexes == NULL)
+        return NULL;
+    NSUInteger movedCount = indexes.count, moved = 0, stayed = 0;
+    for (NSUInteger i = 0; i < count; i++) {
+        if ([indexes containsIndex:i]) {
+            newIndexes[i] = index + moved++;
+        } else {
+            newIndexes[i] = (stayed < index) ? stayed : stayed + movedCount;
+            stayed++;
+        }
+    }
+    return newIndexes;
+}
+
+// Moves each of count columns' pointers to the column's new place. Returns NO if out of
+// memory, leaving them where they were.
+static BOOL MBMoveColumnPointers(void **pointers, NSUInteger count, const NSUInteger *newColumns) {
+    if (pointers == NULL)
+        return YES;
+    void **moved = malloc(MAX(1, count) * sizeof(void *));
+    if (moved == NULL)
+        return NO;
+    for (NSUInteger i = 0; i < count; i++) {
+        moved[newColumns[i]] = pointers[i];
+    }
+    memcpy(pointers, moved, count * sizeof(void *));
+    free(moved);
+    return YES;
+}
+
+NS_INLINE NSRange MBRangeFromIndexRange(MBTableGridIndexRange range) {
+    if (range.location == MBTableGridGeometryNotFound)
+        return NSMakeRange(NSNotFound, 0);
+    return NSMakeRange(range.location, range.length);
+}
+
+// A column summarized by an MBTableGridAggregateIndex, which reads it in the data
+// source's order, so that the summary stays good however the rows are ordered
+typedef struct MBAggregateColumn {
+    __unsafe_unretained MBTableGrid *tableGrid;
+    NSUInteger columnIndex;
+} MBAggregateColumn;
+
+static bool MBReadAggregateValues(void *context, size_t firstRow, size_t count, MBTableGridValue *values) {
+    const MBAggregateColumn *column = context;
+    return [column->tableGrid _getAggregateValues:values forColumn:column->columnIndex dataSourceRows:NSMakeRange(firstRow, count)];
+}
 
 
 @implementation MBTableGrid
@@ -158,6 +242,8 @@ NS_INLINE MBVerticalEdge MBOppositeVerticalEdge(MBVerticalEdge other) {
         _columnFooterHeight = MBTableGridColumnFooterHeight;
         _rowFooterWidth = MBTableGridRowFooterWidth;
         _minimumColumnWidth = MBTableGridMinimumColumnWidth;
+        _groupColumnIndex = NSNotFound;
+        _groupFooterColumnIndex = NSNotFound;
         
         // Setup the content view
         NSRect contentFrame = NSMakeRect(0, 0,
@@ -283,7 +369,14 @@ NS_INLINE MBVerticalEdge MBOppositeVerticalEdge(MBVerticalEdge other) {
         self.previousVerticalSelectionDirection = MBVerticalEdgeTop;
         self.previousHorizontalSelectionDirection = MBHorizontalEdgeLeft;
 		
-		_columnRects = [[NSMutableDictionary alloc] init];
+		_columnOffsetIndex = MBTableGridOffsetIndexCreate();
+		_rowOffsetIndex = MBTableGridOffsetIndexCreate();
+		_availableValueBlocks = [NSMutableArray array];
+		_prefetchedBlocks = [NSMutableArray array];
+		_stringBufferKey = [NSString stringWithFormat:@"MBTableGridStringBuffers %@", [NSUUID UUID].UUIDString];
+		_formulaStringBufferKey = [NSString stringWithFormat:@"MBTableGridFormulaStringBuffers %@", [NSUUID UUID].UUIDString];
+		_columnStringBufferKey = [NSString stringWithFormat:@"MBTableGridColumnStringBuffers %@", [NSUUID UUID].UUIDString];
+		_formulaLock = OS_UNFAIR_LOCK_INIT;
         [self registerForDraggedTypes:@[MBTableGridColumnDataType, MBTableGridRowDataType]];
         
         _textFinder = [[NSTextFinder alloc] init];
@@ -293,6 +386,7 @@ NS_INLINE MBVerticalEdge MBOppositeVerticalEdge(MBVerticalEdge other) {
         
         _textFinderClient = [[MBTableGridTextFinderClient alloc] initWithTableGrid:self];
         _textFinder.client = _textFinderClient;
+        [self _updateFindAbortState];
 
         self.wantsLayer = YES;
 	}
@@ -304,25 +398,9 @@ NS_INLINE MBVerticalEdge MBOppositeVerticalEdge(MBVerticalEdge other) {
 	self.contentView.showsGrabHandle = s;
 }
 
-- (void)_sortButtonClickedForColumn:(NSUInteger)column {
-    if (self.sortColumnIndex == column) {
-        if (self.isSortColumnAscending) {
-            self.sortColumnIndex = NSNotFound;
-        } else {
-            self.sortColumnAscending = YES;
-        }
-    } else {
-        self.sortColumnIndex = column;
-        self.sortColumnAscending = NO;
-    }
-    if ([self.delegate respondsToSelector:@selector(tableGrid:didSortByColumn:ascending:)]) {
-        [self.delegate tableGrid:self didSortByColumn:self.sortColumnIndex ascending:self.sortColumnAscending];
-    }
-    [self reloadData];
-}
-
 - (void)setSortColumnIndex:(NSUInteger)sortColumnIndex {
     _sortColumnIndex = sortColumnIndex;
+    _secondarySortColumnIndexes = nil;
     columnHeaderView.needsDisplay = YES;
 }
 
@@ -331,6 +409,592 @@ NS_INLINE MBVerticalEdge MBOppositeVerticalEdge(MBVerticalEdge other) {
     columnHeaderView.needsDisplay = YES;
 }
 
+#pragma mark Aggregates
+
+- (MBTableGridAggregate)aggregateForColumn:(NSUInteger)columnIndex {
+    return [self aggregateForColumns:[NSIndexSet indexSetWithIndex:columnIndex]
+                                rows:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, _numberOfRows)]];
+}
+
+- (MBTableGridAggregate)aggregateForColumns:(NSIndexSet *)columnIndexes rows:(NSIndexSet *)rowIndexes {
+    __block MBTableGridAggregate aggregate = MBTableGridAggregateMakeEmpty();
+    NSIndexSet *dataSourceRowIndexes = [self _aggregateDataSourceRowIndexesForRowIndexes:rowIndexes];
+    [columnIndexes enumerateIndexesInRange:NSMakeRange(0, _numberOfColumns) options:0 usingBlock:^(NSUInteger columnIndex, BOOL *stopColumns) {
+        MBTableGridAggregateIndex *index = [self _aggregateIndexForColumn:columnIndex];
+        __block MBAggregateColumn column = { self, columnIndex };
+        [dataSourceRowIndexes enumerateRangesUsingBlock:^(NSRange range, BOOL *stopRows) {
+            if (index) {
+                MBTableGridAggregateIndexSummarize(index, range.location, range.length, MBReadAggregateValues, &column, &aggregate);
+            } else {
+                [self _addValuesInColumn:columnIndex dataSourceRows:range toAggregate:&aggregate];
+            }
+        }];
+    }];
+    return aggregate;
+}
+
+// The data source rows behind some rows shown. Those behind every row, which the column
+// footers ask about, are kept until rows are shown or hidden, since sorted rows would
+// otherwise be looked up one at a time on every redraw.
+- (NSIndexSet *)_aggregateDataSourceRowIndexesForRowIndexes:(NSIndexSet *)rowIndexes {
+    NSUInteger numberOfRows = _numberOfRows;
+    MBTableGridRowPermutation *permutation = self.rowPermutation;
+    if (![rowIndexes containsIndexesInRange:NSMakeRange(0, numberOfRows)]) {
+        NSIndexSet *shownRowIndexes = [rowIndexes indexesInRange:NSMakeRange(0, numberOfRows) options:0 passingTest:^BOOL(NSUInteger idx, BOOL *stop) {
+            return YES;
+        }];
+        return permutation ? [permutation dataSourceRowIndexesForRowIndexes:shownRowIndexes] : shownRowIndexes;
+    }
+    // A permutation of every data source row holds them all, whatever their order
+    if (permutation == nil || numberOfRows == _numberOfDataSourceRows)
+        return [NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, numberOfRows)];
+    if (_aggregateDataSourceRowIndexes == nil)
+        _aggregateDataSourceRowIndexes = [permutation dataSourceRowIndexesForRowIndexes:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, numberOfRows)]];
+    return _aggregateDataSourceRowIndexes;
+}
+
+- (MBTableGridAggregate)selectionAggregate {
+    return [self aggregateForColumns:self.selectedColumnIndexes rows:self.selectedRowIndexes];
+}
+
+- (void)setColumnFooterAggregateFunction:(MBTableGridAggregateFunction)function {
+    _columnFooterAggregateFunction = function;
+    if (function != MBTableGridAggregateFunctionNone)
+        self.columnFooterVisible = YES;
+    columnFooterView.needsDisplay = YES;
+}
+
+// A column's summary in the data source's order, built on first use. NULL if memory
+// runs out.
+- (MBTableGridAggregateIndex *)_aggregateIndexForColumn:(NSUInteger)columnIndex {
+    if (_aggregateIndexes == NULL) {
+        _aggregateIndexes = calloc(MAX(1, _numberOfColumns), sizeof(MBTableGridAggregateIndex *));
+        if (_aggregateIndexes == NULL)
+            return NULL;
+        _aggregateIndexCount = _numberOfColumns;
+    }
+    if (columnIndex >= _aggregateIndexCount)
+        return NULL;
+    if (_aggregateIndexes[columnIndex])
+        return _aggregateIndexes[columnIndex];
+    
+    MBTableGridAggregateIndex *index = MBTableGridAggregateIndexCreate(_numberOfDataSourceRows);
+    MBAggregateColumn column = { self, columnIndex };
+    if (index == NULL || !MBTableGridAggregateIndexUpdate(index, 0, _numberOfDataSourceRows, MBReadAggregateValues, &column)) {
+        MBTableGridAggregateIndexDestroy(index);
+        return NULL;
+    }
+    _aggregateIndexes[columnIndex] = index;
+    return index;
+}
+
+// Strings are only counted, so the values don't keep the objects' text, which goes away
+// with the autorelease pool
+- (BOOL)_getAggregateValues:(MBTableGridValue *)values forColumn:(NSUInteger)columnIndex dataSourceRows:(NSRange)dataSourceRowRange {
+    NSRange columnRange = NSMakeRange(columnIndex, 1);
+    if ([self _providesTypedValues]) {
+        [self _getValues:values forColumns:columnRange dataSourceRows:dataSourceRowRange];
+        return YES;
+    }
+    __strong id *objects = (__strong id *)calloc(MAX(1, MIN(dataSourceRowRange.length, MBTableGridObjectValueBatchSize)), sizeof(id));
+    if (objects == NULL)
+        return NO;
+    for (NSUInteger firstRow = dataSourceRowRange.location; firstRow < NSMaxRange(dataSourceRowRange); firstRow += MBTableGridObjectValueBatchSize) {
+        NSRange batchRows = NSMakeRange(firstRow, MIN(MBTableGridObjectValueBatchSize, NSMaxRange(dataSourceRowRange) - firstRow));
+        MBTableGridValue *batchValues = values + (firstRow - dataSourceRowRange.location);
+        @autoreleasepool {
+            [self _getObjectValues:objects forColumns:columnRange dataSourceRows:batchRows];
+            for (NSUInteger i = 0; i < batchRows.length; i++) {
+                batchValues[i] = (objects[i] == MBTableGridPendingValue) ? MBTableGridValueMakePending() : MBValueForObject(objects[i]);
+                if (batchValues[i].type == MBTableGridValueTypeString)
+                    batchValues[i] = MBTableGridValueMakeString("", 0);
+                objects[i] = nil;
+            }
+        }
+    }
+    free(objects);
+    return YES;
+}
+
+// Summarizes rows by reading them all, for when a column's summary can't be built
+- (void)_addValuesInColumn:(NSUInteger)columnIndex dataSourceRows:(NSRange)dataSourceRowRange toAggregate:(MBTableGridAggregate *)aggregate {
+    MBTableGridValue *values = malloc(MAX(1, MIN(dataSourceRowRange.length, MBTableGridExportBatchSize)) * sizeof(MBTableGridValue));
+    if (values == NULL)
+        return;
+    for (NSUInteger firstRow = dataSourceRowRange.location; firstRow < NSMaxRange(dataSourceRowRange); firstRow += MBTableGridExportBatchSize) {
+        NSRange batchRows = NSMakeRange(firstRow, MIN(MBTableGridExportBatchSize, NSMaxRange(dataSourceRowRange) - firstRow));
+        if (![self _getAggregateValues:values forColumn:columnIndex dataSourceRows:batchRows])
+            break;
+        MBTableGridAggregateAddValues(aggregate, values, batchRows.length);
+    }
+    free(values);
+}
+
+// Brings the summaries up to date after cells change, given both the rows shown and the
+// data source rows behind them. A summary that can't be is dropped, to be built again
+// when it's next needed, as are the columns' summaries by group, which are read in a
+// single pass.
+- (void)_updateAggregatesForColumns:(NSIndexSet *)columnIndexes rows:(NSIndexSet *)rowIndexes dataSourceRows:(NSIndexSet *)dataSourceRowIndexes {
+    [columnIndexes enumerateIndexesInRange:NSMakeRange(0, _groupAggregateColumnCount) options:0 usingBlock:^(NSUInteger columnIndex, BOOL *stop) {
+        free(_groupAggregates[columnIndex]);
+        _groupAggregates[columnIndex] = NULL;
+    }];
+    if (_groupTable)
+        rowFooterView.needsDisplay = YES;
+    [columnIndexes enumerateIndexesInRange:NSMakeRange(0, _aggregateIndexCount) options:0 usingBlock:^(NSUInteger columnIndex, BOOL *stopColumns) {
+        MBTableGridAggregateIndex *index = _aggregateIndexes[columnIndex];
+        if (index == NULL)
+            return;
+        __block MBAggregateColumn column = { self, columnIndex };
+        [dataSourceRowIndexes enumerateRangesUsingBlock:^(NSRange dataSourceRowRange, BOOL *stopRows) {
+            if (!MBTableGridAggregateIndexUpdate(index, dataSourceRowRange.location, dataSourceRowRange.length, MBReadAggregateValues, &column)) {
+                MBTableGridAggregateIndexDestroy(index);
+                _aggregateIndexes[columnIndex] = NULL;
+                *stopRows = YES;
+            }
+        }];
+    }];
+    columnFooterView.needsDisplay = YES;
+    if ([columnIndexes intersectsIndexSet:self.selectedColumnIndexes] && [rowIndexes intersectsIndexSet:self.selectedRowIndexes])
+        [self _noteSelectionAggregateChanged];
+}
+
+// Rows were added to or removed from the end of the data source, and the rest are where
+// they were
+- (void)_updateAggregatesFromNumberOfDataSourceRows:(NSUInteger)previousNumberOfDataSourceRows {
+    NSUInteger numberOfRows = _numberOfDataSourceRows;
+    // The block holding the last row before may have been partial, and the one holding
+    // the last row now may summarize rows that are gone
+    NSUInteger firstRow = MIN(previousNumberOfDataSourceRows, numberOfRows);
+    if (firstRow > 0)
+        firstRow--;
+    for (NSUInteger columnIndex = 0; columnIndex < _aggregateIndexCount; columnIndex++) {
+        MBTableGridAggregateIndex *index = _aggregateIndexes[columnIndex];
+        MBAggregateColumn column = { self, columnIndex };
+        if (index && !(MBTableGridAggregateIndexSetRowCount(index, numberOfRows) &&
+                       MBTableGridAggregateIndexUpdate(index, firstRow, numberOfRows - firstRow, MBReadAggregateValues, &column))) {
+            MBTableGridAggregateIndexDestroy(index);
+            _aggregateIndexes[columnIndex] = NULL;
+        }
+    }
+    [self _noteAggregateRowsChanged];
+}
+
+- (void)_clearAggregateIndexes {
+    for (NSUInteger i = 0; i < _aggregateIndexCount; i++) {
+        MBTableGridAggregateIndexDestroy(_aggregateIndexes[i]);
+    }
+    free(_aggregateIndexes);
+    _aggregateIndexes = NULL;
+    _aggregateIndexCount = 0;
+}
+
+// For when the data source's rows or columns change, after which the summaries are built
+// again as they're needed
+- (void)_invalidateAggregates {
+    [self _clearAggregateIndexes];
+    [self _noteAggregateRowsChanged];
+}
+
+// For when rows are shown, hidden or moved. The summaries are in the data source's order,
+// so they stay good, but the rows shown may now be others.
+- (void)_noteAggregateRowsChanged {
+    _aggregateDataSourceRowIndexes = nil;
+    columnFooterView.needsDisplay = YES;
+    [self _noteSelectionAggregateChanged];
+}
+
+// The delegate hears once the current event has been handled, so that dragging out a
+// selection, which sets the selected columns and then the rows, summarizes it once
+- (void)_noteSelectionAggregateChanged {
+    if (_sendsSelectionAggregate || ![self.delegate respondsToSelector:@selector(tableGrid:didChangeSelectionAggregate:)])
+        return;
+    _sendsSelectionAggregate = YES;
+    dispatch_async(dispatch_get_main_queue(), ^{
+        _sendsSelectionAggregate = NO;
+        if ([self.delegate respondsToSelector:@selector(tableGrid:didChangeSelectionAggregate:)])
+            [self.delegate tableGrid:self didChangeSelectionAggregate:self.selectionAggregate];
+    });
+}
+
+#pragma mark Row Order
+
+- (void)setMovesRowsByMapping:(BOOL)movesRowsByMapping {
+    _movesRowsByMapping = movesRowsByMapping;
+    if (!movesRowsByMapping && _rowOrder)
+        [self setRowOrder:NULL count:0];
+}
+
+- (void)getRowOrder:(NSUInteger *)dataSourceRows range:(NSRange)range {
+    if (_rowOrder) {
+        [_rowOrder getDataSourceRows:(size_t *)dataSourceRows inRows:range];
+        return;
+    }
+    for (NSUInteger i = 0; i < range.length; i++) {
+        dataSourceRows[i] = range.location + i;
+    }
+}
+
+- (NSUInteger)rowOrderCount {
+    return _rowOrder ? _rowOrder.count : _numberOfDataSourceRows;
+}
+
+// Selected rows stay selected wherever they go
+- (BOOL)setRowOrder:(const NSUInteger *)dataSourceRows count:(NSUInteger)count {
+    MBTableGridRowPermutation *rowOrder = nil;
+    if (dataSourceRows) {
+        NSUInteger numberOfDataSourceRows = _numberOfDataSourceRows;
+        if (count > numberOfDataSourceRows)
+            return NO;
+        unsigned char *seen = calloc(MAX(1, numberOfDataSourceRows), 1);
+        size_t *rows = malloc(MAX(1, count) * sizeof(size_t));
+        BOOL isValid = (seen != NULL && rows != NULL);
+        for (NSUInteger i = 0; i < count && isValid; i++) {
+            isValid = (dataSourceRows[i] < numberOfDataSourceRows && !seen[dataSourceRows[i]]);
+            if (isValid) {
+                seen[dataSourceRows[i]] = 1;
+                rows[i] = dataSourceRows[i];
+            }
+        }
+        free(seen);
+        if (!isValid) {
+            free(rows);
+            return NO;
+        }
+        rowOrder = [[MBTableGridRowPermutation alloc] initWithDataSourceRows:rows count:count];
+        if (rowOrder == nil)
+            return NO;
+    }
+    NSIndexSet *selectedDataSourceRowIndexes = [self _dataSourceRowIndexesForRowIndexes:self.selectedRowIndexes];
+    _rowOrder = rowOrder;
+    [self _orderRowsFromSortKeys];
+    self.selectedRowIndexes = [self _rowIndexesForDataSourceRowIndexes:selectedDataSourceRowIndexes];
+    return YES;
+}
+
+// The grid's order, made from the data source's the first time it's needed. Returns NO
+// if out of memory.
+- (BOOL)_makeRowOrder {
+    if (_rowOrder)
+        return YES;
+    NSUInteger count = _numberOfDataSourceRows;
+    size_t *dataSourceRows = malloc(MAX(1, count) * sizeof(size_t));
+    if (dataSourceRows == NULL)
+        return NO;
+    for (NSUInteger i = 0; i < count; i++) {
+        dataSourceRows[i] = i;
+    }
+    _rowOrder = [[MBTableGridRowPermutation alloc] initWithDataSourceRows:dataSourceRows count:count];
+    return _rowOrder != nil;
+}
+
+// Moves rows in the grid's order. Only the rows from the first that moved to the last
+// have new numbers, so only they're drawn again. A move that fails puts the rows back,
+// and only if that fails too does the grid go back to the data source's order.
+- (BOOL)_moveRowsInRowOrder:(NSIndexSet *)rowIndexes toRow:(NSUInteger)rowIndex {
+    if (rowIndexes.count == 0 || ![self _makeRowOrder])
+        return NO;
+    NSIndexSet *dataSourceRowIndexes = [_rowOrder dataSourceRowIndexesForRowIndexes:rowIndexes];
+    NSUInteger count = _rowOrder.count;
+    if (![_rowOrder moveRows:rowIndexes toRow:rowIndex]) {
+        NSLog(@"WARNING: MBTableGrid could not move %lu rows", (unsigned long)rowIndexes.count);
+        if (_rowOrder.count != count) {
+            _rowOrder = nil;
+            [self _orderRowsFromSortKeys];
+        }
+        return NO;
+    }
+
+    if (self.rowPermutation != _rowOrder) {
+        [self _setRowPermutation:_rowOrder];
+    } else {
+        NSUInteger firstRow = MIN(rowIndexes.firstIndex, rowIndex);
+        NSUInteger lastRow = MAX(rowIndexes.lastIndex, rowIndex + rowIndexes.count - 1);
+        if (_usesVariableRowHeights)
+            _rowOffsetIndexIsValid = NO;
+        [self _cancelPrefetchedCells];
+        [_textFinder noteClientStringWillChange];
+        [self _noteAggregateRowsChanged];
+        if (_numberOfColumns) {
+            NSRect dirtyRect = NSUnionRect([contentView frameOfCellAtColumn:0 row:firstRow],
+                                           [contentView frameOfCellAtColumn:_numberOfColumns - 1 row:lastRow]);
+            [contentView invalidateCachedTilesInRect:dirtyRect];
+            [rowHeaderView setNeedsDisplayInRect:NSMakeRect(0, NSMinY(dirtyRect), NSWidth(rowHeaderView.bounds), NSHeight(dirtyRect))];
+            [rowFooterView setNeedsDisplayInRect:NSMakeRect(0, NSMinY(dirtyRect), NSWidth(rowFooterView.bounds), NSHeight(dirtyRect))];
+        }
+    }
+    if ([self.dataSource respondsToSelector:@selector(tableGrid:didMoveDataSourceRows:toRow:)]) {
+        [self.dataSource tableGrid:self didMoveDataSourceRows:dataSourceRowIndexes toRow:rowIndex];
+    }
+    return YES;
+}
+
+// The data source's new rows are at the end of the grid's order, and moved from there
+- (BOOL)insertDataSourceRowsAtRow:(NSUInteger)rowIndex {
+    NSUInteger previousCount = self.rowOrderCount;
+    [self noteNumberOfRowsChanged];
+    NSUInteger count = self.rowOrderCount;
+    MBTableGridRowPermutation *permutation = self.rowPermutation;
+    if (count <= previousCount || !self.movesRowsByMapping || (permutation != nil && permutation != _rowOrder))
+        return NO;
+    return [self _moveRowsInRowOrder:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(previousCount, count - previousCount)] toRow:rowIndex];
+}
+
+// The rows leave the permutation shown as rows a filter hides do, and the grid's order,
+// which sorting, filtering and grouping start from
+- (BOOL)removeRowsFromRowOrder:(NSIndexSet *)rowIndexes {
+    if (!self.movesRowsByMapping || rowIndexes.count == 0 || rowIndexes.lastIndex >= _numberOfRows || ![self _makeRowOrder])
+        return NO;
+    MBTableGridRowPermutation *permutation = self.rowPermutation, *rowOrder = _rowOrder;
+    NSIndexSet *dataSourceRowIndexes = [self _dataSourceRowIndexesForRowIndexes:rowIndexes];
+    [dataSourceRowIndexes enumerateIndexesUsingBlock:^(NSUInteger dataSourceRowIndex, BOOL *stop) {
+        [rowOrder removeDataSourceRow:dataSourceRowIndex];
+        if (permutation && permutation != rowOrder)
+            [permutation removeDataSourceRow:dataSourceRowIndex];
+    }];
+    // The grid's order may not be shown yet, and taking rows out can leave a group empty
+    if (permutation == nil || _groupTable) {
+        [self _orderRowsFromSortKeys];
+    } else {
+        [self _noteRowsRemovedFromRow:rowIndexes.firstIndex];
+    }
+    return YES;
+}
+
+#pragma mark Column Order
+
+- (void)setMovesColumnsByMapping:(BOOL)movesColumnsByMapping {
+    _movesColumnsByMapping = movesColumnsByMapping;
+    if (!movesColumnsByMapping && self.columnOrder)
+        [self setColumnOrder:NULL count:0];
+}
+
+- (NSUInteger)dataSourceColumnForColumn:(NSUInteger)columnIndex {
+    MBTableGridRowPermutation *columnOrder = self.columnOrder;
+    return columnOrder ? [columnOrder dataSourceRowForRow:columnIndex] : columnIndex;
+}
+
+- (NSUInteger)columnForDataSourceColumn:(NSUInteger)dataSourceColumnIndex {
+    MBTableGridRowPermutation *columnOrder = self.columnOrder;
+    return columnOrder ? [columnOrder rowForDataSourceRow:dataSourceColumnIndex] : dataSourceColumnIndex;
+}
+
+- (NSIndexSet *)_dataSourceColumnIndexesForColumnIndexes:(NSIndexSet *)columnIndexes {
+    MBTableGridRowPermutation *columnOrder = self.columnOrder;
+    return columnOrder ? [columnOrder dataSourceRowIndexesForRowIndexes:columnIndexes] : columnIndexes;
+}
+
+- (NSIndexSet *)_columnIndexesForDataSourceColumnIndexes:(NSIndexSet *)dataSourceColumnIndexes {
+    MBTableGridRowPermutation *columnOrder = self.columnOrder;
+    return columnOrder ? [columnOrder rowIndexesForDataSourceRowIndexes:dataSourceColumnIndexes] : dataSourceColumnIndexes;
+}
+
+// Splits columns into runs whose data source columns are consecutive and ascending, as
+// _enumerateDataSourceRangesInRows: does for rows
+- (void)_enumerateDataSourceRangesInColumns:(NSRange)columnRange
+                                 usingBlock:(void (^)(NSRange dataSourceColumnRange, NSUInteger columnIndex, BOOL *stop))block {
+    MBTableGridRowPermutation *columnOrder = self.columnOrder;
+    if (columnOrder) {
+        [columnOrder enumerateDataSourceRangesInRows:columnRange usingBlock:block];
+    } else {
+        BOOL stop = NO;
+        block(columnRange, columnRange.location, &stop);
+    }
+}
+
+- (void)getColumnOrder:(NSUInteger *)dataSourceColumns range:(NSRange)range {
+    MBTableGridRowPermutation *columnOrder = self.columnOrder;
+    if (columnOrder) {
+        [columnOrder getDataSourceRows:(size_t *)dataSourceColumns inRows:range];
+        return;
+    }
+    for (NSUInteger i = 0; i < range.length; i++) {
+        dataSourceColumns[i] = range.location + i;
+    }
+}
+
+// Sorting, filtering, grouping, summaries, widths and the selection stay with their
+// data source columns wherever they go
+- (BOOL)setColumnOrder:(const NSUInteger *)dataSourceColumns count:(NSUInteger)count {
+    NSUInteger numberOfColumns = _numberOfColumns;
+    MBTableGridRowPermutation *columnOrder = nil;
+    if (dataSourceColumns) {
+        if (count != numberOfColumns)
+            return NO;
+        unsigned char *seen = calloc(MAX(1, numberOfColumns), 1);
+        size_t *columns = malloc(MAX(1, count) * sizeof(size_t));
+        BOOL isValid = (seen != NULL && columns != NULL);
+        for (NSUInteger i = 0; i < count && isValid; i++) {
+            isValid = (dataSourceColumns[i] < numberOfColumns && !seen[dataSourceColumns[i]]);
+            if (isValid) {
+                seen[dataSourceColumns[i]] = 1;
+                columns[i] = dataSourceColumns[i];
+            }
+        }
+        free(seen);
+        if (!isValid) {
+            free(columns);
+            return NO;
+        }
+        columnOrder = [[MBTableGridRowPermutation alloc] initWithDataSourceRows:columns count:count];
+        if (columnOrder == nil)
+            return NO;
+    }
+    NSUInteger *newColumns = malloc(MAX(1, numberOfColumns) * sizeof(NSUInteger));
+    if (newColumns == NULL)
+        return NO;
+    for (NSUInteger column = 0; column < numberOfColumns; column++) {
+        NSUInteger dataSourceColumn = [self dataSourceColumnForColumn:column];
+        newColumns[column] = columnOrder ? [columnOrder rowForDataSourceRow:dataSourceColumn] : dataSourceColumn;
+    }
+    // Copied cells are kept as the columns shown, so they're written out in the old order
+    [self _resolveCopiedCells];
+    NSIndexSet *selectedDataSourceColumnIndexes = [self _dataSourceColumnIndexesForColumnIndexes:self.selectedColumnIndexes];
+    self.columnOrder = columnOrder;
+    [self _noteColumnsMovedToColumns:newColumns];
+    free(newColumns);
+    self.selectedColumnIndexes = [self _columnIndexesForDataSourceColumnIndexes:selectedDataSourceColumnIndexes];
+    return YES;
+}
+
+// Moves columns in the grid's order, made from the data source's the first time. Cells
+// are read through the order, so the data source's cells and columns stay where they
+// are.
+- (BOOL)_moveColumnsInColumnOrder:(NSIndexSet *)columnIndexes toColumn:(NSUInteger)columnIndex {
+    NSUInteger numberOfColumns = _numberOfColumns;
+    if (columnIndexes.count == 0 || columnIndexes.lastIndex >= numberOfColumns)
+        return NO;
+    MBTableGridRowPermutation *columnOrder = self.columnOrder;
+    if (columnOrder == nil) {
+        size_t *dataSourceColumns = malloc(MAX(1, numberOfColumns) * sizeof(size_t));
+        if (dataSourceColumns == NULL)
+            return NO;
+        for (NSUInteger i = 0; i < numberOfColumns; i++) {
+            dataSourceColumns[i] = i;
+        }
+        columnOrder = [[MBTableGridRowPermutation alloc] initWithDataSourceRows:dataSourceColumns count:numberOfColumns];
+        if (columnOrder == nil)
+            return NO;
+    }
+    NSUInteger *newColumns = MBNewIndexesForMove(columnIndexes, columnIndex, numberOfColumns);
+    if (newColumns == NULL)
+        return NO;
+    NSIndexSet *dataSourceColumnIndexes = [columnOrder dataSourceRowIndexesForRowIndexes:columnIndexes];
+    // A move that fails puts the columns back, and only if that fails too does the grid
+    // go back to the data source's order
+    if (![columnOrder moveRows:columnIndexes toRow:columnIndex]) {
+        NSLog(@"WARNING: MBTableGrid could not move %lu columns", (unsigned long)columnIndexes.count);
+        free(newColumns);
+        if (columnOrder.count != numberOfColumns && self.columnOrder) {
+            self.columnOrder = nil;
+            _columnOffsetIndexIsValid = NO;
+            _findIndexIsValid = NO;
+            [(MBTableGridTextFinderClient *)_textFinderClient noteCellNumbersDidChange];
+            [self _invalidateAggregates];
+            [self _clearGroupAggregates];
+            self.needsDisplay = YES;
+        }
+        return NO;
+    }
+    self.columnOrder = columnOrder;
+    [self _noteColumnsMovedToColumns:newColumns];
+    free(newColumns);
+    if ([self.dataSource respondsToSelector:@selector(tableGrid:didMoveDataSourceColumns:toColumn:)]) {
+        [self.dataSource tableGrid:self didMoveDataSourceColumns:dataSourceColumnIndexes toColumn:columnIndex];
+    }
+    return YES;
+}
+
+// Columns the data source adds go at the end of the grid's order, and columns it removes
+// are taken to be its last
+- (void)_updateColumnOrderFromNumberOfColumns:(NSUInteger)previousNumberOfColumns {
+    MBTableGridRowPermutation *columnOrder = self.columnOrder;
+    NSUInteger numberOfColumns = _numberOfColumns;
+    if (columnOrder == nil || numberOfColumns == previousNumberOfColumns)
+        return;
+    BOOL succeeded = YES;
+    if (numberOfColumns > previousNumberOfColumns) {
+        succeeded = [columnOrder appendDataSourceRows:NSMakeRange(previousNumberOfColumns, numberOfColumns - previousNumberOfColumns)];
+    } else {
+        for (NSUInteger column = numberOfColumns; column < previousNumberOfColumns; column++) {
+            [columnOrder removeDataSourceRow:column];
+        }
+    }
+    if (!succeeded || columnOrder.count != numberOfColumns) {
+        NSLog(@"WARNING: MBTableGrid could not keep the order of %lu columns", (unsigned long)numberOfColumns);
+        self.columnOrder = nil;
+    }
+}
+
+// Gives the state the grid keeps by column to the columns' new places, the new column
+// of each column being in newColumns, after the grid or the data source moved them
+- (void)_noteColumnsMovedToColumns:(const NSUInteger *)newColumns {
+    NSUInteger numberOfColumns = _numberOfColumns;
+
+    NSMutableArray<NSNumber *> *sortColumnIndexes = [NSMutableArray array];
+    NSMutableIndexSet *ascendingColumnIndexes = [NSMutableIndexSet indexSet];
+    for (NSNumber *column in self.sortColumnIndexes) {
+        NSUInteger columnIndex = column.unsignedIntegerValue;
+        NSUInteger newColumnIndex = (columnIndex < numberOfColumns) ? newColumns[columnIndex] : columnIndex;
+        [sortColumnIndexes addObject:@(newColumnIndex)];
+        if ([self isColumnSortedAscending:columnIndex])
+            [ascendingColumnIndexes addIndex:newColumnIndex];
+    }
+    [self _setSortColumnIndexes:sortColumnIndexes ascendingColumns:ascendingColumnIndexes];
+    for (NSUInteger i = 0; i < _sortColumnCount; i++) {
+        if (_sortColumns[i].columnIndex < numberOfColumns)
+            _sortColumns[i].columnIndex = newColumns[_sortColumns[i].columnIndex];
+    }
+
+    if (_filterPredicates.count) {
+        NSMutableArray<MBTableGridFilterPredicate *> *predicates = [NSMutableArray arrayWithCapacity:_filterPredicates.count];
+        for (MBTableGridFilterPredicate *predicate in _filterPredicates) {
+            NSUInteger columnIndex = predicate.columnIndex;
+            [predicates addObject:(columnIndex < numberOfColumns) ? [predicate predicateWithColumn:newColumns[columnIndex]] : predicate];
+        }
+        _filterPredicates = predicates;
+    }
+    for (NSUInteger i = 0; i < _filterColumnCount; i++) {
+        if (_filterColumns[i].columnIndex < numberOfColumns)
+            _filterColumns[i].columnIndex = newColumns[_filterColumns[i].columnIndex];
+    }
+    qsort(_filterColumns, _filterColumnCount, sizeof(MBFilterColumn), MBCompareFilterColumns);
+
+    if (_groupColumnIndex < numberOfColumns)
+        _groupColumnIndex = newColumns[_groupColumnIndex];
+    if (_groupFooterColumnIndex < numberOfColumns)
+        _groupFooterColumnIndex = newColumns[_groupFooterColumnIndex];
+
+    // Each column's summaries are of the same cells as before
+    if (_aggregateIndexCount != numberOfColumns || !MBMoveColumnPointers((void **)_aggregateIndexes, numberOfColumns, newColumns))
+        [self _clearAggregateIndexes];
+    if (_groupAggregateColumnCount != numberOfColumns || !MBMoveColumnPointers((void **)_groupAggregates, numberOfColumns, newColumns))
+        [self _clearGroupAggregates];
+
+    NSMutableDictionary<NSNumber *, NSNumber *> *columnWidths = [NSMutableDictionary dictionaryWithCapacity:_columnWidths.count];
+    [_columnWidths enumerateKeysAndObjectsUsingBlock:^(NSNumber *key, NSNumber *obj, BOOL *stop) {
+        NSUInteger columnIndex = key.unsignedIntegerValue;
+        columnWidths[@((columnIndex < numberOfColumns) ? newColumns[columnIndex] : columnIndex)] = obj;
+    }];
+    _columnWidths = columnWidths;
+    _columnOffsetIndexIsValid = NO;
+
+    _findIndexIsValid = NO;
+    [(MBTableGridTextFinderClient *)_textFinderClient noteCellNumbersDidChange];
+    [self _cancelPrefetchedCells];
+    [self _updateSortableColumns];
+    columnFooterView.needsDisplay = YES;
+    rowFooterView.needsDisplay = YES;
+    [self _noteSelectionAggregateChanged];
+    self.needsDisplay = YES;
+}
+
+// The data source names the columns it can sort by as its own
+- (void)_updateSortableColumns {
+    if ([self.dataSource respondsToSelector:@selector(sortableColumnIndexesInTableGrid:)])
+        columnHeaderView.indicatorImageColumns = [self _columnIndexesForDataSourceColumnIndexes:[self.dataSource sortableColumnIndexesInTableGrid:self]];
+}
+
 - (void)awakeFromNib {
 //	[self reloadData];
 	[self unregisterDraggedTypes];
@@ -338,6 +1002,28 @@ NS_INLINE MBVerticalEdge MBOppositeVerticalEdge(MBVerticalEdge other) {
 
 - (void)dealloc {
 	[NSNotificationCenter.defaultCenter removeObserver:self];
+	[self _resolveCopiedCells];
+	MBTableGridOffsetIndexDestroy(_columnOffsetIndex);
+	MBTableGridOffsetIndexDestroy(_rowOffsetIndex);
+	MBTableGridTrigramIndexDestroy(_findIndex);
+	[self _clearSortKeys];
+	[self _clearFilterConditions];
+	[self _clearAggregateIndexes];
+	[self _clearGroups];
+	MBTableGridFormulaSheetDestroy(_formulaSheet);
+	[NSThread.currentThread.threadDictionary removeObjectForKey:_stringBufferKey];
+	[NSThread.currentThread.threadDictionary removeObjectForKey:_formulaStringBufferKey];
+	[NSThread.currentThread.threadDictionary removeObjectForKey:_columnStringBufferKey];
+}
+
+// The data source may go with the window, so copied cells are written out first
+- (void)viewWillMoveToWindow:(NSWindow *)newWindow {
+	[super viewWillMoveToWindow:newWindow];
+	if (newWindow == nil) {
+		[self _resolveCopiedCells];
+		[NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(_cancelPrefetchedCells) object:nil];
+		[self _cancelPrefetchedCells];
+	}
 }
 
 - (BOOL)isFlipped {
@@ -354,7 +1040,7 @@ NS_INLINE MBVerticalEdge MBOppositeVerticalEdge(MBVerticalEdge other) {
 
 - (__kindof MBTableGridCell *) _cellForColumn: (NSUInteger)columnIndex row:(NSUInteger)rowIndex {
 	if ([self.dataSource respondsToSelector:@selector(tableGrid:cellForColumn:row:)]) {
-		return [self.dataSource tableGrid:self cellForColumn:columnIndex row:rowIndex];
+		return [self.dataSource tableGrid:self cellForColumn:[self dataSourceColumnForColumn:columnIndex] row:[self dataSourceRowForRow:rowIndex]];
 	}
 	else if (self.dataSource) {
 		NSLog(@"WARNING: MBTableGrid data source does not implement tableGrid:cellForColumn:row:");
@@ -363,8 +1049,21 @@ NS_INLINE MBVerticalEdge MBOppositeVerticalEdge(MBVerticalEdge other) {
 }
 
 - (id) _objectValueForColumn: (NSUInteger)columnIndex row:(NSUInteger)rowIndex {
+	return [self _objectValueForColumn:columnIndex dataSourceRow:[self dataSourceRowForRow:rowIndex]];
+}
+
+- (id) _objectValueForColumn: (NSUInteger)columnIndex dataSourceRow:(NSUInteger)rowIndex {
+	NSUInteger dataSourceColumnIndex = [self dataSourceColumnForColumn:columnIndex];
+	if (_formulaSheet) {
+		__strong id result = nil;
+		[self _getFormulaObjects:&result forColumns:NSMakeRange(dataSourceColumnIndex, 1) dataSourceRows:NSMakeRange(rowIndex, 1)];
+		if (result)
+			return (result == MBTableGridPendingValue) ? nil : result;
+	}
 	if ([self.dataSource respondsToSelector:@selector(tableGrid:objectValueForColumn:row:)]) {
-		return [self.dataSource tableGrid:self objectValueForColumn:columnIndex row:rowIndex];
+		id value = [self.dataSource tableGrid:self objectValueForColumn:dataSourceColumnIndex row:rowIndex];
+		// Callers that can draw a placeholder look for pending values themselves
+		return (value == MBTableGridPendingValue) ? nil : value;
 	}
 	else if (self.dataSource) {
 		NSLog(@"WARNING: MBTableGrid data source does not implement tableGrid:objectValueForColumn:row:");
@@ -388,19 +1087,35 @@ NS_INLINE MBVerticalEdge MBOppositeVerticalEdge(MBVerticalEdge other) {
 	// Set new width of column
 	CGFloat currentWidth = w;
 	
-	[self.columnRects removeAllObjects];
 	if (currentWidth < [self _minimumWidthForColumn:columnIndex]) {
 		currentWidth = [self _minimumWidthForColumn:columnIndex];
 	}
 	[self _setWidth:currentWidth forColumn:columnIndex];
 	
-	self.needsDisplay = YES;
+	// Only the resized column's tiles are stale; the rest just move
+	[contentView invalidateCachedTilesInColumns:NSMakeRange(columnIndex, 1)];
+	columnHeaderView.needsDisplay = YES;
+	columnFooterView.needsDisplay = YES;
+}
+
+- (void)invalidateColumnWidths {
+	_columnOffsetIndexIsValid = NO;
+}
+
+- (void)setMinimumColumnWidth:(CGFloat)minimumColumnWidth {
+	_minimumColumnWidth = minimumColumnWidth;
+	[self invalidateColumnWidths];
 }
 
 - (void)setNeedsDisplay:(BOOL)needsDisplay {
     super.needsDisplay = needsDisplay;
     
-	self.contentView.needsDisplay = needsDisplay;
+	// Redrawing everything may mean the values changed, so re-render the tiles too
+	if (needsDisplay) {
+		[self.contentView invalidateAllCachedTiles];
+	} else {
+		self.contentView.needsDisplay = NO;
+	}
     columnHeaderView.needsDisplay = needsDisplay;
     rowHeaderView.needsDisplay = needsDisplay;
     columnFooterView.needsDisplay = needsDisplay;
@@ -427,13 +1142,9 @@ NS_INLINE MBVerticalEdge MBOppositeVerticalEdge(MBVerticalEdge other) {
 }
 
 - (CGFloat)resizeColumnWithIndex:(NSUInteger)columnIndex withDistance:(float)distance location:(NSPoint)location {
-	// Note that we only need this rect for its origin, which won't be changing, otherwise we'd need to flush the column rect cache first
+	// Note that we only need this rect for its origin, which won't be changing
 	NSRect columnRect = [self.contentView rectOfColumn:columnIndex];
 
-	// Flush rect cache for this column because we're changing its size
-	// Note that we're doing this after calling rectOfColumn: because that would cache the rect before we change its width...
-	[self.columnRects removeAllObjects];
-
 	// Set new width of column
 	CGFloat currentWidth = [self _widthForColumn:columnIndex];
     CGFloat offset = 0.0;
@@ -459,6 +1170,7 @@ NS_INLINE MBVerticalEdge MBOppositeVerticalEdge(MBVerticalEdge other) {
                                                          NSWidth(horizontalView.bounds) - columnRect.origin.x,
                                                          NSHeight(horizontalView.bounds))];
     }
+    [contentView invalidateCachedTilesInColumns:NSMakeRange(columnIndex, 1)];
     
     return offset;
 }
@@ -498,7 +1210,11 @@ NS_INLINE MBVerticalEdge MBOppositeVerticalEdge(MBVerticalEdge other) {
 
 - (BOOL)respondsToSelector:(SEL)aSelector {
     if (aSelector == @selector(paste:)) {
-        return ([self.delegate respondsToSelector:@selector(tableGrid:pasteCellsAtColumns:rows:)]);
+        return ([self.delegate respondsToSelector:@selector(tableGrid:pasteCellsAtColumns:rows:)] ||
+                (self.selectedRowIndexes.count > 0 && self.selectedColumnIndexes.count > 0 &&
+                 ([self.dataSource respondsToSelector:@selector(tableGrid:setValues:forColumns:rows:)] ||
+                  [self.dataSource respondsToSelector:@selector(tableGrid:setObjectValue:forColumn:row:)] ||
+                  [self.dataSource respondsToSelector:@selector(tableGrid:setObjectValue:forColumns:rows:)])));
     }
     if (aSelector == @selector(copy:)) {
         return (self.selectedRowIndexes.count > 0 && self.selectedColumnIndexes.count > 0);
@@ -518,35 +1234,174 @@ NS_INLINE MBVerticalEdge MBOppositeVerticalEdge(MBVerticalEdge other) {
     if ([self.delegate respondsToSelector:@selector(tableGrid:copyCellsAtColumns:rows:)]) {
 		[self.delegate tableGrid:self copyCellsAtColumns:selectedColumns rows:selectedRows];
     } else {
-        NSMutableString *string = [NSMutableString string];
-        for (NSInteger row=selectedRows.firstIndex; row<=selectedRows.lastIndex; row++) {
-            for (NSInteger columnIndex=selectedColumns.firstIndex; columnIndex<=selectedColumns.lastIndex; columnIndex++) {
-                NSString *value = [self.dataSource tableGrid:self objectValueForColumn:columnIndex row:row];
-                if (value)
-                    [string appendString:value];
-                if (columnIndex<selectedColumns.lastIndex)
-                    [string appendString:@"\t"];
-            }
-            if (row<selectedRows.lastIndex)
-                [string appendString:@"\n"];
+        // Promise the text rather than writing it, since it may never be pasted, and
+        // keep the copied rows as data source rows, since the grid's order may change
+        [self _resolveCopiedCells];
+        NSRange rowRange = NSMakeRange(selectedRows.firstIndex, selectedRows.lastIndex - selectedRows.firstIndex + 1);
+        MBTableGridRowPermutation *permutation = self.rowPermutation;
+        size_t *dataSourceRows = NULL;
+        if (permutation) {
+            dataSourceRows = malloc(rowRange.length * sizeof(size_t));
+            if (dataSourceRows == NULL)
+                return;
+            [permutation getDataSourceRows:dataSourceRows inRows:rowRange];
         }
-        
-        NSPasteboard *pboard = NSPasteboard.generalPasteboard;
-        
-        [pboard declareTypes:@[ NSPasteboardTypeTabularText, NSPasteboardTypeString ]
-                       owner:nil];
-        
-        [pboard setString:string forType:NSPasteboardTypeTabularText];
-        [pboard setString:string forType:NSPasteboardTypeString];
+        MBTableGridCopyDataProvider *provider = [[MBTableGridCopyDataProvider alloc] initWithTableGrid:self
+                                                                                               columns:NSMakeRange(selectedColumns.firstIndex, selectedColumns.lastIndex - selectedColumns.firstIndex + 1)
+                                                                                                  rows:rowRange
+                                                                                        dataSourceRows:dataSourceRows];
+        if ([provider writeToPasteboard:NSPasteboard.generalPasteboard])
+            _copyDataProvider = provider;
     }
 }
 
+// Copied cells are read when they're pasted, so read them before they change
+- (void)_resolveCopiedCells {
+    [_copyDataProvider resolveFromTableGrid:self];
+    _copyDataProvider = nil;
+}
+
+// Only an edit to a copied cell changes the copied text, except that any edit may change
+// the result of a formula among the copied cells
+- (void)_resolveCopiedCellsInColumns:(NSIndexSet *)columnIndexes dataSourceRows:(NSIndexSet *)dataSourceRowIndexes {
+    if (_copyDataProvider && (_formulaSheet || [_copyDataProvider containsCellsInColumns:columnIndexes dataSourceRows:dataSourceRowIndexes]))
+        [self _resolveCopiedCells];
+}
+
 - (void)paste:(id)sender {
     if ([self.delegate respondsToSelector:@selector(tableGrid:pasteCellsAtColumns:rows:)]) {
         [self.delegate tableGrid:self pasteCellsAtColumns:self.selectedColumnIndexes
                             rows:self.selectedRowIndexes];
         [self reloadData];
+    } else {
+        NSPasteboard *pasteboard = NSPasteboard.generalPasteboard;
+        NSData *data = [pasteboard dataForType:NSPasteboardTypeTabularText];
+        if (data.length == 0)
+            data = [pasteboard dataForType:NSPasteboardTypeString];
+        if (data.length)
+            [self pasteDelimitedData:data atColumns:self.selectedColumnIndexes rows:self.selectedRowIndexes];
+    }
+}
+
+- (BOOL)pasteDelimitedData:(NSData *)data atColumns:(NSIndexSet *)columnIndexes rows:(NSIndexSet *)rowIndexes {
+    if (columnIndexes.count == 0 || rowIndexes.count == 0)
+        return NO;
+    
+    MBTableGridDelimitedFormat format = MBTableGridDelimitedFormatGuess(data.bytes, data.length);
+    MBTableGridDelimitedTable *table = MBTableGridDelimitedTableCreate(data.bytes, data.length, format);
+    if (table == NULL)
+        return NO;
+    
+    NSUInteger firstColumn = columnIndexes.firstIndex;
+    NSUInteger firstRow = rowIndexes.firstIndex;
+    NSUInteger columnCount = MBTableGridDelimitedTableColumnCount(table);
+    NSUInteger rowCount = MBTableGridDelimitedTableRowCount(table);
+    
+    if (columnIndexes.count == 1 && rowIndexes.count == 1) {
+        // Pasting into one cell pastes everything, so make room for it
+        BOOL addedCells = NO;
+        if (firstColumn + columnCount > _numberOfColumns &&
+            [self.dataSource respondsToSelector:@selector(tableGrid:addColumns:)])
+            addedCells |= [self.dataSource tableGrid:self addColumns:firstColumn + columnCount - _numberOfColumns];
+        if (firstRow + rowCount > _numberOfRows &&
+            [self.dataSource respondsToSelector:@selector(tableGrid:addRows:)])
+            addedCells |= [self.dataSource tableGrid:self addRows:firstRow + rowCount - _numberOfRows];
+        if (addedCells)
+            [self reloadData];
+    } else {
+        columnCount = MIN(columnCount, columnIndexes.lastIndex - firstColumn + 1);
+        rowCount = MIN(rowCount, rowIndexes.lastIndex - firstRow + 1);
     }
+    if (firstColumn >= _numberOfColumns || firstRow >= _numberOfRows) {
+        MBTableGridDelimitedTableDestroy(table);
+        return NO;
+    }
+    NSRange columnRange = NSMakeRange(firstColumn, MIN(columnCount, _numberOfColumns - firstColumn));
+    NSRange rowRange = NSMakeRange(firstRow, MIN(rowCount, _numberOfRows - firstRow));
+    NSIndexSet *pastedColumns = [NSIndexSet indexSetWithIndexesInRange:columnRange];
+    NSIndexSet *pastedRows = [NSIndexSet indexSetWithIndexesInRange:rowRange];
+    if (columnRange.length == 0 || rowRange.length == 0 || ![self _canEditCellsInColumns:pastedColumns rows:pastedRows]) {
+        MBTableGridDelimitedTableDestroy(table);
+        return NO;
+    }
+    
+    [self _resolveCopiedCellsInColumns:pastedColumns dataSourceRows:[self _dataSourceRowIndexesForRowIndexes:pastedRows]];
+    
+    // Typed values go to the data source a batch of rows at a time; objects go a cell at a time
+    BOOL setsValues = [self.dataSource respondsToSelector:@selector(tableGrid:setValues:forColumns:rows:)];
+    BOOL setsSingleValues = [self.dataSource respondsToSelector:@selector(tableGrid:setObjectValue:forColumn:row:)];
+    NSUInteger rowsPerBatch = MAX(1, MBTableGridPasteBatchSize / columnRange.length);
+    NSUInteger batchCapacity = MIN(rowsPerBatch, rowRange.length) * columnRange.length;
+    MBTableGridRowPermutation *permutation = self.rowPermutation;
+    MBTableGridValue *values = malloc(batchCapacity * sizeof(MBTableGridValue));
+    // Sorted rows are set a run of data source rows at a time
+    MBTableGridValue *runValues = (setsValues && permutation) ? malloc(batchCapacity * sizeof(MBTableGridValue)) : NULL;
+    if (values == NULL || (setsValues && permutation && runValues == NULL)) {
+        free(values);
+        free(runValues);
+        MBTableGridDelimitedTableDestroy(table);
+        return NO;
+    }
+    for (NSUInteger rowOffset=0; rowOffset<rowRange.length; rowOffset+=rowsPerBatch) {
+        NSRange batchRows = NSMakeRange(rowRange.location + rowOffset, MIN(rowsPerBatch, rowRange.length - rowOffset));
+        MBTableGridDelimitedTableGetValues(table, values, 0, columnRange.length, rowOffset, batchRows.length);
+        if (setsValues) {
+            // A run of data source columns at a time, whose values are together
+            [self _enumerateDataSourceRangesInColumns:columnRange usingBlock:^(NSRange dataSourceColumns, NSUInteger columnIndex, BOOL *stopColumns) {
+                MBTableGridValue *columnValues = values + (columnIndex - columnRange.location) * batchRows.length;
+                if (permutation == nil) {
+                    [self.dataSource tableGrid:self setValues:columnValues forColumns:dataSourceColumns rows:batchRows];
+                    [self _noteFormulaValues:columnValues forColumns:dataSourceColumns dataSourceRows:batchRows];
+                    return;
+                }
+                [permutation enumerateDataSourceRangesInRows:batchRows usingBlock:^(NSRange dataSourceRows, NSUInteger rowIndex, BOOL *stop) {
+                    for (NSUInteger i=0; i<dataSourceColumns.length; i++) {
+                        memcpy(runValues + i * dataSourceRows.length, columnValues + i * batchRows.length + (rowIndex - batchRows.location),
+                               dataSourceRows.length * sizeof(MBTableGridValue));
+                    }
+                    [self.dataSource tableGrid:self setValues:runValues forColumns:dataSourceColumns rows:dataSourceRows];
+                    [self _noteFormulaValues:runValues forColumns:dataSourceColumns dataSourceRows:dataSourceRows];
+                }];
+            }];
+            continue;
+        }
+        @autoreleasepool {
+            for (NSUInteger i=0; i<columnRange.length; i++) {
+                for (NSUInteger j=0; j<batchRows.length; j++) {
+                    const MBTableGridValue *value = &values[i * batchRows.length + j];
+                    // Strings are copied, since the table's text goes away after the paste
+                    id object = (value->type == MBTableGridValueTypeString)
+                              ? [[NSString alloc] initWithBytes:value->data.string.bytes length:value->data.string.length
+                                                       encoding:NSUTF8StringEncoding]
+                              : [self _objectForValue:value];
+                    NSUInteger columnIndex = [self dataSourceColumnForColumn:columnRange.location + i];
+                    NSUInteger rowIndex = [self dataSourceRowForRow:batchRows.location + j];
+                    if (setsSingleValues) {
+                        [self.dataSource tableGrid:self setObjectValue:object forColumn:columnIndex row:rowIndex];
+                    } else {
+                        [self.dataSource tableGrid:self setObjectValue:object
+                                        forColumns:[NSIndexSet indexSetWithIndex:columnIndex]
+                                              rows:[NSIndexSet indexSetWithIndex:rowIndex]];
+                    }
+                    [self _noteFormulaValues:value forColumns:NSMakeRange(columnIndex, 1) dataSourceRows:NSMakeRange(rowIndex, 1)];
+                }
+            }
+        }
+    }
+    free(values);
+    free(runValues);
+    MBTableGridDelimitedTableDestroy(table);
+    
+    [self _updateFindIndexForColumns:pastedColumns rows:pastedRows];
+    [contentView invalidateCachedTilesInRect:NSUnionRect([contentView frameOfCellAtColumn:columnRange.location row:rowRange.location],
+                                                         [contentView frameOfCellAtColumn:NSMaxRange(columnRange) - 1 row:NSMaxRange(rowRange) - 1])];
+    NSIndexSet *pastedDataSourceRows = [self _dataSourceRowIndexesForRowIndexes:pastedRows];
+    [self _updateAggregatesForColumns:pastedColumns rows:pastedRows dataSourceRows:pastedDataSourceRows];
+    [self _repairSortForDataSourceRows:pastedDataSourceRows columns:pastedColumns];
+    [self _recalculateFormulas];
+    columnFooterView.needsDisplay = YES;
+    rowFooterView.needsDisplay = YES;
+    return YES;
 }
 
 - (void)insertTab:(id)sender {
@@ -1090,7 +1945,7 @@ NS_INLINE MBVerticalEdge MBOppositeVerticalEdge(MBVerticalEdge other) {
 - (void)deleteBackward:(id)sender {
 	// Clear the contents of every selected cell
     [self _setObjectValue:nil forColumns:self.selectedColumnIndexes rows:self.selectedRowIndexes];
-	[self reloadData];
+	[self _reloadDataPreservingFindIndex];
 }
 
 // From the Edit menu
@@ -1133,51 +1988,168 @@ NS_INLINE MBVerticalEdge MBOppositeVerticalEdge(MBVerticalEdge other) {
     return YES;
 }
 
+// Find threads read the flag without waiting on the main thread, which keeps it
+// current whenever the grid is hidden or shown, or the find bar comes or goes
 - (BOOL)_shouldAbortFindOperation {
     if (NSThread.isMainThread)
-        return self.isHiddenOrHasHiddenAncestor || !contentScrollView.isFindBarVisible;
-    
-    __block BOOL return_value = NO;
-    NSOperation *operation = [NSBlockOperation blockOperationWithBlock:^{
-        return_value = self.isHiddenOrHasHiddenAncestor || !self->contentScrollView.isFindBarVisible;
-    }];
-    [NSOperationQueue.mainQueue addOperations:@[ operation ] waitUntilFinished:YES];
-    return return_value;
+        [self _updateFindAbortState];
+    return atomic_load(&_findAborted);
 }
 
-- (BOOL)isFindBarVisible {
-    return contentScrollView.isFindBarVisible;
+- (void)_updateFindAbortState {
+    atomic_store(&_findAborted, self.isHiddenOrHasHiddenAncestor || !contentScrollView.isFindBarVisible);
 }
 
-- (void)setFindBarVisible:(BOOL)findBarVisible {
-    contentScrollView.findBarVisible = findBarVisible;
+- (void)_findBarVisibilityDidChange {
+    [self _updateFindAbortState];
 }
 
-#pragma mark -
-#pragma mark Notifications
+- (void)viewDidHide {
+    [super viewDidHide];
+    [self _updateFindAbortState];
+}
 
-- (NSArray<NSScrollView *> *)_scrollViews {
-    return @[ contentScrollView,
-              rowHeaderScrollView, rowFooterScrollView,
-              columnHeaderScrollView, columnFooterScrollView ];
+- (void)viewDidUnhide {
+    [super viewDidUnhide];
+    [self _updateFindAbortState];
 }
 
-- (void)synchronizeScrollView:(NSScrollView *)scrollView withChangedBoundsOrigin:(NSPoint)changedBoundsOrigin horizontal:(BOOL)horizontal {
-    // Get the current origin
-    NSPoint curOffset = scrollView.contentView.bounds.origin;
-    NSPoint newOffset = curOffset;
-    
-    if (horizontal) {
-        newOffset.x = changedBoundsOrigin.x;
-    } else {
-        newOffset.y = changedBoundsOrigin.y;
-    }
-    
-    // If the synced position is different from our current position, reposition the view
-    if (!NSEqualPoints(curOffset, newOffset)) {
-        [scrollView.contentView scrollToPoint:newOffset];
-        // We have to tell the NSScrollView to update its scrollers
-        [scrollView reflectScrolledClipView:scrollView.contentView];
+- (void)setFindMode:(MBTableGridFindMode)findMode {
+    _findMode = findMode;
+    [_textFinder noteClientStringWillChange];
+}
+
+- (void)setIndexesCellsForFind:(BOOL)flag {
+    _indexesCellsForFind = flag;
+    _findIndexIsValid = NO;
+    if (!flag) {
+        MBTableGridTrigramIndexDestroy(_findIndex);
+        _findIndex = NULL;
+    }
+}
+
+// The index of cell text, built on first use. NULL if indexing is off, or the
+// grid is too big to number its cells in 32 bits, or memory runs out.
+- (MBTableGridTrigramIndex *)_findIndex {
+    if (!_indexesCellsForFind)
+        return NULL;
+    
+    // Edits only ever add postings, so rebuild once half the cells have changed
+    if (_findIndexIsValid && MBTableGridTrigramIndexStaleCount(_findIndex) <= MBTableGridTrigramIndexCellCount(_findIndex) / 2)
+        return _findIndex;
+    
+    _findIndexIsValid = NO;
+    if (_numberOfColumns * _numberOfRows > UINT32_MAX)
+        return NULL;
+    if (_findIndex == NULL && (_findIndex = MBTableGridTrigramIndexCreate()) == NULL)
+        return NULL;
+    
+    MBTableGridTrigramIndexClear(_findIndex);
+    _findIndexSkippedPendingCells = NO;
+    if (![self _indexCellsInColumns:NSMakeRange(0, _numberOfColumns) rows:NSMakeRange(0, _numberOfRows) replacing:NO]) {
+        MBTableGridTrigramIndexClear(_findIndex);
+        return NULL;
+    }
+    _findIndexIsValid = YES;
+    return _findIndex;
+}
+
+// Adds the text of a block of cells to the index, as the data source now has it.
+// Returns NO if memory runs out.
+- (BOOL)_indexCellsInColumns:(NSRange)columnRange rows:(NSRange)rowRange replacing:(BOOL)replacing {
+    MBTableGridTrigramIndex *index = _findIndex;
+    NSUInteger rowCount = _numberOfRows;
+    __block BOOL succeeded = YES;
+    
+    if ([self _providesTypedValues]) {
+        [self _enumerateValuesInColumns:columnRange rows:rowRange usingBlock:^(NSUInteger columnIndex, NSUInteger rowIndex, const MBTableGridValue *value, BOOL *stop) {
+            if (value->type == MBTableGridValueTypePending)
+                _findIndexSkippedPendingCells = YES;
+            char scratch[MBTableGridValueFormatCapacity];
+            size_t length = 0;
+            const char *text = MBTableGridValueGetUTF8(value, scratch, &length);
+            uint32_t cell = (uint32_t)(columnIndex * rowCount + rowIndex);
+            if (!(replacing ? MBTableGridTrigramIndexReplaceText(index, cell, text, length)
+                            : MBTableGridTrigramIndexAddText(index, cell, text, length)))
+                succeeded = NO, *stop = YES;
+        }];
+    } else {
+        [self _enumerateObjectValuesInColumns:columnRange rows:rowRange usingBlock:^(NSUInteger columnIndex, NSUInteger rowIndex, id value, BOOL *stop) {
+            if (value == MBTableGridPendingValue)
+                _findIndexSkippedPendingCells = YES;
+            NSString *string = (value == nil || value == MBTableGridPendingValue) ? @""
+                             : [value isKindOfClass:[NSString class]] ? value : [value description];
+            const char *text = string.UTF8String ?: "";
+            uint32_t cell = (uint32_t)(columnIndex * rowCount + rowIndex);
+            if (!(replacing ? MBTableGridTrigramIndexReplaceText(index, cell, text, strlen(text))
+                            : MBTableGridTrigramIndexAddText(index, cell, text, strlen(text))))
+                succeeded = NO, *stop = YES;
+        }];
+    }
+    return succeeded;
+}
+
+// Brings the index, and the matches found so far, up to date after cells are set
+// through the grid
+- (void)_updateFindIndexForColumns:(NSIndexSet *)columnIndexes rows:(NSIndexSet *)rowIndexes {
+    [(MBTableGridTextFinderClient *)_textFinderClient noteCellsDidChangeInColumns:columnIndexes rows:rowIndexes];
+    if (!_findIndexIsValid)
+        return;
+    [columnIndexes enumerateRangesUsingBlock:^(NSRange columnRange, BOOL *stopColumns) {
+        [rowIndexes enumerateRangesUsingBlock:^(NSRange rowRange, BOOL *stopRows) {
+            if (![self _indexCellsInColumns:columnRange rows:rowRange replacing:YES]) {
+                _findIndexIsValid = NO;
+                *stopRows = *stopColumns = YES;
+            }
+        }];
+    }];
+}
+
+// For edits that leave the grid's shape alone, and so don't call for a reload
+- (void)_noteFindClientStringWillChange {
+    [_textFinder noteClientStringWillChange];
+}
+
+// For reloads after edits the index already knows about
+- (void)_reloadDataPreservingFindIndex {
+    _preservesFindIndex = YES;
+    [self reloadData];
+    _preservesFindIndex = NO;
+}
+
+- (BOOL)isFindBarVisible {
+    return contentScrollView.isFindBarVisible;
+}
+
+- (void)setFindBarVisible:(BOOL)findBarVisible {
+    contentScrollView.findBarVisible = findBarVisible;
+}
+
+#pragma mark -
+#pragma mark Notifications
+
+- (NSArray<NSScrollView *> *)_scrollViews {
+    return @[ contentScrollView,
+              rowHeaderScrollView, rowFooterScrollView,
+              columnHeaderScrollView, columnFooterScrollView ];
+}
+
+- (void)synchronizeScrollView:(NSScrollView *)scrollView withChangedBoundsOrigin:(NSPoint)changedBoundsOrigin horizontal:(BOOL)horizontal {
+    // Get the current origin
+    NSPoint curOffset = scrollView.contentView.bounds.origin;
+    NSPoint newOffset = curOffset;
+    
+    if (horizontal) {
+        newOffset.x = changedBoundsOrigin.x;
+    } else {
+        newOffset.y = changedBoundsOrigin.y;
+    }
+    
+    // If the synced position is different from our current position, reposition the view
+    if (!NSEqualPoints(curOffset, newOffset)) {
+        [scrollView.contentView scrollToPoint:newOffset];
+        // We have to tell the NSScrollView to update its scrollers
+        [scrollView reflectScrolledClipView:scrollView.contentView];
     }
 }
 
@@ -1197,6 +2169,105 @@ NS_INLINE MBVerticalEdge MBOppositeVerticalEdge(MBVerticalEdge other) {
         }
     }
     [self.window invalidateCursorRectsForView:self];
+    
+    if (scrollView == contentScrollView) {
+        [self _updatePrefetchedCells];
+    }
+}
+
+// Predicts where the content is scrolling from its recent velocity, and asks the data
+// source to prefetch the cells about to come into view (cancelling the previous request)
+- (void)_updatePrefetchedCells {
+    if (![self.dataSource respondsToSelector:@selector(tableGrid:prefetchColumns:rows:)])
+        return;
+    // Once scrolling stops, the cells ahead aren't coming after all
+    [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(_cancelPrefetchedCells) object:nil];
+    [self performSelector:@selector(_cancelPrefetchedCells) withObject:nil afterDelay:MBTableGridPrefetchVelocityTimeout];
+    
+    NSRect visibleRect = contentView.visibleRect;
+    CFTimeInterval now = CACurrentMediaTime();
+    CFTimeInterval elapsed = now - _lastScrollTime;
+    NSPoint delta = NSMakePoint(NSMinX(visibleRect) - _lastScrollOrigin.x, NSMinY(visibleRect) - _lastScrollOrigin.y);
+    
+    if (elapsed > MBTableGridPrefetchVelocityTimeout || elapsed <= 0.0) {
+        // The first movement after a pause says nothing about speed
+        _scrollVelocity = NSZeroPoint;
+    } else {
+        _scrollVelocity.x = 0.5 * _scrollVelocity.x + 0.5 * delta.x / elapsed;
+        _scrollVelocity.y = 0.5 * _scrollVelocity.y + 0.5 * delta.y / elapsed;
+    }
+    _lastScrollOrigin = visibleRect.origin;
+    _lastScrollTime = now;
+    
+    CGFloat dx = _scrollVelocity.x * MBTableGridPrefetchLookahead;
+    CGFloat dy = _scrollVelocity.y * MBTableGridPrefetchLookahead;
+    dx = MAX(-MBTableGridPrefetchMaximumPages * NSWidth(visibleRect), MIN(dx, MBTableGridPrefetchMaximumPages * NSWidth(visibleRect)));
+    dy = MAX(-MBTableGridPrefetchMaximumPages * NSHeight(visibleRect), MIN(dy, MBTableGridPrefetchMaximumPages * NSHeight(visibleRect)));
+    if (fabs(dx) < 1.0 && fabs(dy) < 1.0) {
+        [self _cancelPrefetchedCells];
+        return;
+    }
+    
+    // Cover the strip just past the leading edge in the main direction of travel,
+    // widened to follow any drift along the other axis
+    NSRect aheadRect = visibleRect;
+    if (fabs(dy) >= fabs(dx)) {
+        aheadRect.origin.y = (dy > 0.0) ? NSMaxY(visibleRect) : NSMinY(visibleRect) + dy;
+        aheadRect.size.height = fabs(dy);
+        aheadRect.origin.x += MIN(dx, 0.0);
+        aheadRect.size.width += fabs(dx);
+    } else {
+        aheadRect.origin.x = (dx > 0.0) ? NSMaxX(visibleRect) : NSMinX(visibleRect) + dx;
+        aheadRect.size.width = fabs(dx);
+        aheadRect.origin.y += MIN(dy, 0.0);
+        aheadRect.size.height += fabs(dy);
+    }
+    
+    MBTableGridAxis columns = [self _columnAxis];
+    MBTableGridAxis rows = [self _rowAxis];
+    NSRange columnRange = MBRangeFromIndexRange(MBTableGridAxisRangeIntersecting(&columns, NSMinX(aheadRect), NSMaxX(aheadRect)));
+    NSRange rowRange = MBRangeFromIndexRange(MBTableGridAxisRangeIntersecting(&rows, NSMinY(aheadRect), NSMaxY(aheadRect)));
+    if (columnRange.location == NSNotFound || rowRange.location == NSNotFound)
+        return;
+    if (NSEqualRanges(columnRange, _prefetchedColumns) && NSEqualRanges(rowRange, _prefetchedRows))
+        return;
+    
+    // Moved columns and sorted, filtered or moved rows are prefetched a run of data
+    // source columns and rows at a time
+    [self _cancelPrefetchedCells];
+    _prefetchedColumns = columnRange;
+    _prefetchedRows = rowRange;
+    [self _enumerateDataSourceBlocksInColumns:columnRange rows:rowRange usingBlock:^(NSRange dataSourceColumns, NSRange dataSourceRows) {
+        [self->_prefetchedBlocks addObject:@[ [NSValue valueWithRange:dataSourceColumns], [NSValue valueWithRange:dataSourceRows] ]];
+        [self.dataSource tableGrid:self prefetchColumns:dataSourceColumns rows:dataSourceRows];
+    }];
+}
+
+// Withdraws the cells last asked to be prefetched, in the data source columns and rows
+// they were asked for in, however the grid's columns and rows have moved since
+- (void)_cancelPrefetchedCells {
+    _prefetchedColumns = NSMakeRange(NSNotFound, 0);
+    _prefetchedRows = NSMakeRange(NSNotFound, 0);
+    if (_prefetchedBlocks.count == 0)
+        return;
+    NSArray<NSArray<NSValue *> *> *blocks = [_prefetchedBlocks copy];
+    [_prefetchedBlocks removeAllObjects];
+    if (![self.dataSource respondsToSelector:@selector(tableGrid:cancelPrefetchingColumns:rows:)])
+        return;
+    for (NSArray<NSValue *> *block in blocks) {
+        [self.dataSource tableGrid:self cancelPrefetchingColumns:block[0].rangeValue rows:block[1].rangeValue];
+    }
+}
+
+// Calls block for each block of cells that are together in the data source, whichever
+// way the columns and rows have been moved
+- (void)_enumerateDataSourceBlocksInColumns:(NSRange)columnRange rows:(NSRange)rowRange
+                                usingBlock:(void (^)(NSRange dataSourceColumns, NSRange dataSourceRows))block {
+    [self _enumerateDataSourceRangesInRows:rowRange ofDataSourceRows:NULL usingBlock:^(NSRange dataSourceRows, NSUInteger rowIndex, BOOL *stopRows) {
+        [self _enumerateDataSourceRangesInColumns:columnRange usingBlock:^(NSRange dataSourceColumns, NSUInteger columnIndex, BOOL *stopColumns) {
+            block(dataSourceColumns, dataSourceRows);
+        }];
+    }];
 }
 
 - (void)clipViewBoundsDidChange:(NSNotification *)aNotification {
@@ -1251,7 +2322,8 @@ NS_INLINE MBVerticalEdge MBOppositeVerticalEdge(MBVerticalEdge other) {
 			NSUInteger dropColumn = [self columnAtPoint:mouseLocation];
 			NSUInteger dropRow = [self rowAtPoint:mouseLocation];
 
-			NSDragOperation dragOperation = [self.dataSource tableGrid:self validateDrop:sender proposedColumn:dropColumn row:dropRow];
+			NSDragOperation dragOperation = [self.dataSource tableGrid:self validateDrop:sender proposedColumn:[self dataSourceColumnForColumn:dropColumn]
+																					 row:[self dataSourceRowForRow:dropRow]];
 
 			// If the drag is okay, highlight the appropriate cell
 			if (dragOperation != NSDragOperationNone) {
@@ -1289,9 +2361,13 @@ NS_INLINE MBVerticalEdge MBOppositeVerticalEdge(MBVerticalEdge other) {
             draggedColumns = (NSIndexSet *)[NSKeyedUnarchiver unarchiveObjectWithData:columnData];
         }
 
+		// Columns in the grid's own order are moved there whether or not the data source
+		// can move them
 		BOOL canDrop = NO;
 		if ([self.dataSource respondsToSelector:@selector(tableGrid:canMoveColumns:toIndex:)]) {
 			canDrop = [self.dataSource tableGrid:self canMoveColumns:draggedColumns toIndex:dropColumn];
+		} else {
+			canDrop = self.movesColumnsByMapping;
 		}
 
 		[contentView _setDraggingColumnOrRow:YES];
@@ -1322,8 +2398,14 @@ NS_INLINE MBVerticalEdge MBOppositeVerticalEdge(MBVerticalEdge other) {
         }
 
 		BOOL canDrop = NO;
-		if ([self.dataSource respondsToSelector:@selector(tableGrid:canMoveRows:toIndex:)]) {
+		// Rows sorted by the grid stay in sorted order, and rows in its own order are moved
+		// there whether or not the data source can move them
+		MBTableGridRowPermutation *permutation = self.rowPermutation;
+		BOOL movesRowsByMapping = self.movesRowsByMapping && (permutation == nil || permutation == _rowOrder);
+		if ((permutation == nil || movesRowsByMapping) && [self.dataSource respondsToSelector:@selector(tableGrid:canMoveRows:toIndex:)]) {
 			canDrop = [self.dataSource tableGrid:self canMoveRows:draggedRows toIndex:dropRow];
+		} else {
+			canDrop = movesRowsByMapping;
 		}
 
 		[contentView _setDraggingColumnOrRow:YES];
@@ -1343,7 +2425,8 @@ NS_INLINE MBVerticalEdge MBOppositeVerticalEdge(MBVerticalEdge other) {
 
 			[contentView _setDraggingColumnOrRow:NO];
 
-			NSDragOperation dragOperation = [self.dataSource tableGrid:self validateDrop:sender proposedColumn:dropColumn row:dropRow];
+			NSDragOperation dragOperation = [self.dataSource tableGrid:self validateDrop:sender proposedColumn:[self dataSourceColumnForColumn:dropColumn]
+																					 row:[self dataSourceRowForRow:dropRow]];
 
 			// If the drag is okay, highlight the appropriate cell
 			if (dragOperation != NSDragOperationNone) {
@@ -1388,7 +2471,8 @@ NS_INLINE MBVerticalEdge MBOppositeVerticalEdge(MBVerticalEdge other) {
 
 	if (columnData) {
 		// If we're dragging a column
-		if ([self.dataSource respondsToSelector:@selector(tableGrid:moveColumns:toIndex:)]) {
+		BOOL movesColumnsByMapping = self.movesColumnsByMapping;
+		if (movesColumnsByMapping || [self.dataSource respondsToSelector:@selector(tableGrid:moveColumns:toIndex:)]) {
 			// Get which columns are being dragged
             NSIndexSet *draggedColumns = [NSIndexSet indexSet];
             if (@available(macOS 10.13, *)) {
@@ -1405,19 +2489,39 @@ NS_INLINE MBVerticalEdge MBOppositeVerticalEdge(MBVerticalEdge other) {
 				return NO;
 			}
             
-			// Tell the data source to move the columns
-			BOOL didDrag = [self.dataSource tableGrid:self moveColumns:draggedColumns toIndex:dropColumn];
+			NSUInteger startIndex = dropColumn;
+			NSUInteger length = draggedColumns.count;
 
-			if (didDrag) {
-				NSUInteger startIndex = dropColumn;
-				NSUInteger length = draggedColumns.count;
+            if (dropColumn > draggedColumns.lastIndex) {
+                startIndex -= length;
+            } else if (dropColumn >= draggedColumns.firstIndex) {
+                startIndex = draggedColumns.firstIndex;
+            }
 
-                if (dropColumn > draggedColumns.lastIndex) {
-                    startIndex -= length;
-                } else if (dropColumn >= draggedColumns.firstIndex) {
-                    startIndex = draggedColumns.firstIndex;
-                }
+			// Move the columns in the grid's order, or tell the data source to move them, which
+			// renumbers those between them and the drop. Either way the columns are shown
+			// under new numbers.
+			NSUInteger firstMovedColumn = MIN(draggedColumns.firstIndex, dropColumn);
+			NSUInteger lastMovedColumn = MAX(draggedColumns.lastIndex + 1, dropColumn);
+			[self _resolveCopiedCellsInColumns:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(firstMovedColumn, lastMovedColumn - firstMovedColumn)]
+			                    dataSourceRows:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, _numberOfDataSourceRows)]];
+			BOOL didDrag = NO;
+			if (movesColumnsByMapping) {
+				didDrag = [self _moveColumnsInColumnOrder:draggedColumns toColumn:startIndex];
+			} else if ([self.dataSource tableGrid:self moveColumns:draggedColumns toIndex:dropColumn]) {
+				NSUInteger *movedColumns = MBNewIndexesForMove(draggedColumns, startIndex, _numberOfColumns);
+				if (movedColumns) {
+					[self _noteColumnsMovedToColumns:movedColumns];
+					free(movedColumns);
+				} else {
+					_findIndexIsValid = NO;
+					[(MBTableGridTextFinderClient *)_textFinderClient noteCellNumbersDidChange];
+					[self _invalidateAggregates];
+				}
+				didDrag = YES;
+			}
 
+			if (didDrag) {
 				NSIndexSet *newColumns = [NSIndexSet indexSetWithIndexesInRange:NSMakeRange(startIndex, length)];
 
 				// Post the notification
@@ -1432,7 +2536,9 @@ NS_INLINE MBVerticalEdge MBOppositeVerticalEdge(MBVerticalEdge other) {
 	}
 	else if (rowData) {
 		// If we're dragging a row
-		if ([self.dataSource respondsToSelector:@selector(tableGrid:moveRows:toIndex:)]) {
+		MBTableGridRowPermutation *permutation = self.rowPermutation;
+		BOOL movesRowsByMapping = self.movesRowsByMapping && (permutation == nil || permutation == _rowOrder);
+		if (movesRowsByMapping || (permutation == nil && [self.dataSource respondsToSelector:@selector(tableGrid:moveRows:toIndex:)])) {
 			// Get which rows are being dragged
             NSIndexSet *draggedRows = [NSIndexSet indexSet];
             if (@available(macOS 10.13, *)) {
@@ -1449,12 +2555,8 @@ NS_INLINE MBVerticalEdge MBOppositeVerticalEdge(MBVerticalEdge other) {
 				return NO;
 			}
             
-			// Tell the data source to move the rows
-			BOOL didDrag = [self.dataSource tableGrid:self moveRows:draggedRows toIndex:dropRow];
-
-			if (didDrag) {
-				NSUInteger startIndex = dropRow;
-				NSUInteger length = draggedRows.count;
+			NSUInteger startIndex = dropRow;
+			NSUInteger length = draggedRows.count;
 
         if (dropRow > draggedRows.lastIndex) {
             startIndex -= length;
@@ -1462,8 +2564,26 @@ NS_INLINE MBVerticalEdge MBOppositeVerticalEdge(MBVerticalEdge other) {
             startIndex = draggedRows.firstIndex;
         }
 
+			// Move the rows in the grid's order, or tell the data source to move them, which
+			// renumbers the data source rows between them and the drop
+			if (!movesRowsByMapping) {
+				NSUInteger firstMovedRow = MIN(draggedRows.firstIndex, dropRow);
+				NSUInteger lastMovedRow = MAX(draggedRows.lastIndex + 1, dropRow);
+				[self _resolveCopiedCellsInColumns:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, _numberOfColumns)]
+				                    dataSourceRows:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(firstMovedRow, lastMovedRow - firstMovedRow)]];
+			}
+			BOOL didDrag = movesRowsByMapping ? [self _moveRowsInRowOrder:draggedRows toRow:startIndex]
+			                                  : [self.dataSource tableGrid:self moveRows:draggedRows toIndex:dropRow];
+
+			if (didDrag) {
 				NSIndexSet *newRows = [NSIndexSet indexSetWithIndexesInRange:NSMakeRange(startIndex, length)];
 
+				_findIndexIsValid = NO;
+				[(MBTableGridTextFinderClient *)_textFinderClient noteCellNumbersDidChange];
+				// Rows moved in the data source take their values with them
+				if (!movesRowsByMapping)
+					[self _invalidateAggregates];
+
 				// Post the notification
 				[NSNotificationCenter.defaultCenter postNotificationName:MBTableGridDidMoveRowsNotification object:self userInfo:@{ @"OldRows": draggedRows, @"NewRows": newRows }];
 
@@ -1480,7 +2600,8 @@ NS_INLINE MBVerticalEdge MBOppositeVerticalEdge(MBVerticalEdge other) {
 			NSUInteger dropRow = [self rowAtPoint:mouseLocation];
 
 			// Pass the drag to the data source
-			BOOL didPerformDrag = [self.dataSource tableGrid:self acceptDrop:sender column:dropColumn row:dropRow];
+			BOOL didPerformDrag = [self.dataSource tableGrid:self acceptDrop:sender column:[self dataSourceColumnForColumn:dropColumn]
+			                                             row:[self dataSourceRowForRow:dropRow]];
 
 			return didPerformDrag;
 		}
@@ -1607,6 +2728,13 @@ NS_INLINE MBVerticalEdge MBOppositeVerticalEdge(MBVerticalEdge other) {
 
 - (void)reloadData {
 	CGRect visibleRect = contentScrollView.insetDocumentVisibleRect;
+	NSUInteger previousCellCount = _numberOfColumns * _numberOfRows;
+	NSUInteger previousNumberOfColumns = _numberOfColumns;
+	NSUInteger previousNumberOfDataSourceRows = _numberOfDataSourceRows;
+	
+	// Copied cells are written out before the grid takes in the data source's changes,
+	// which is the last it hears of the cells as they were
+	[self _resolveCopiedCells];
 	
 	// Set number of columns
 	if ([self.dataSource respondsToSelector:@selector(numberOfColumnsInTableGrid:)]) {
@@ -1615,6 +2743,8 @@ NS_INLINE MBVerticalEdge MBOppositeVerticalEdge(MBVerticalEdge other) {
 	else {
 		_numberOfColumns = 0;
 	}
+	[self _updateColumnOrderFromNumberOfColumns:previousNumberOfColumns];
+	[self invalidateColumnWidths];
 
     _selectedColumnIndexes = [_selectedColumnIndexes indexesPassingTest:^(NSUInteger idx, BOOL * stop) {
         return (BOOL)(idx < _numberOfColumns);
@@ -1622,27 +2752,44 @@ NS_INLINE MBVerticalEdge MBOppositeVerticalEdge(MBVerticalEdge other) {
 
 	// Set number of rows
 	if ([self.dataSource respondsToSelector:@selector(numberOfRowsInTableGrid:)]) {
-		_numberOfRows =  [self.dataSource numberOfRowsInTableGrid:self];
+		_numberOfDataSourceRows =  [self.dataSource numberOfRowsInTableGrid:self];
 	}
 	else {
-		_numberOfRows = 0;
+		_numberOfDataSourceRows = 0;
+	}
+	_rowOffsetIndexIsValid = NO;
+	[self _updateRowPermutationFromNumberOfDataSourceRows:previousNumberOfDataSourceRows];
+	_numberOfRows = self.rowPermutation ? self.rowPermutation.count : _numberOfDataSourceRows;
+	
+	// Anything prefetched before the reload is stale
+	[self _cancelPrefetchedCells];
+	
+	// And so are the find index and matches, and the columns' summaries, unless the grid
+	// made every change itself
+	if (!_preservesFindIndex || _numberOfColumns * _numberOfRows != previousCellCount) {
+		_findIndexIsValid = NO;
+		[(MBTableGridTextFinderClient *)_textFinderClient noteCellNumbersDidChange];
+		[self _invalidateAggregates];
+		[self _clearGroupAggregates];
+	}
+	
+	// Any cell may have changed, formulas' text included
+	if (_formulaSheet) {
+		os_unfair_lock_lock(&_formulaLock);
+		MBTableGridFormulaSheetNoteAllChanged(_formulaSheet);
+		os_unfair_lock_unlock(&_formulaLock);
+		[self _recalculateFormulas];
 	}
         
     _selectedRowIndexes = [_selectedRowIndexes indexesPassingTest:^(NSUInteger idx, BOOL * stop) {
         return (BOOL)(idx < _numberOfRows);
     }];
 
-    if ([self.dataSource respondsToSelector:@selector(sortableColumnIndexesInTableGrid:)])
-        columnHeaderView.indicatorImageColumns = [self.dataSource sortableColumnIndexesInTableGrid:self];
+    [self _updateSortableColumns];
     
 	// Update the content view's size
-    NSUInteger lastColumn = (_numberOfColumns>0) ? _numberOfColumns-1 : 0;
-    NSUInteger lastRow = (_numberOfRows>0) ? _numberOfRows-1 : 0;
-	NSRect bottomRightCellFrame = [contentView frameOfCellAtColumn:lastColumn row:lastRow];
-
-	NSSize contentRectSize = NSMakeSize(NSMaxX(bottomRightCellFrame), NSMaxY(bottomRightCellFrame));
-	[contentView setFrameSize:contentRectSize];
-    [self updateAuxiliaryViewSizesWithFrameSize:contentRectSize];
+	[self _updateContentSize];
+	NSSize contentRectSize = contentView.frame.size;
 
 	if(_numberOfRows > 0) {
 		if((visibleRect.size.height + visibleRect.origin.y) > contentRectSize.height) {
@@ -1659,6 +2806,174 @@ NS_INLINE MBVerticalEdge MBOppositeVerticalEdge(MBVerticalEdge other) {
 	self.needsDisplay = YES;
 }
 
+- (void)_updateContentSize {
+	NSUInteger lastColumn = (_numberOfColumns>0) ? _numberOfColumns-1 : 0;
+	NSUInteger lastRow = (_numberOfRows>0) ? _numberOfRows-1 : 0;
+	NSRect bottomRightCellFrame = [contentView frameOfCellAtColumn:lastColumn row:lastRow];
+	NSSize contentRectSize = NSMakeSize(NSMaxX(bottomRightCellFrame), NSMaxY(bottomRightCellFrame));
+	[contentView setFrameSize:contentRectSize];
+	[self updateAuxiliaryViewSizesWithFrameSize:contentRectSize];
+}
+
+// Rows without heights of their own follow the content view's rowHeight, so every
+// offset after the first such row may have moved
+- (void)_noteDefaultRowHeightChanged {
+	_rowOffsetIndexIsValid = NO;
+	[self _updateContentSize];
+	rowHeaderView.needsDisplay = YES;
+	rowFooterView.needsDisplay = YES;
+}
+
+- (void)noteHeightOfRowsWithIndexesChanged:(NSIndexSet *)rowIndexes {
+	MBTableGridOffsetIndex *rowOffsets = [self _rowOffsetIndex];
+	if (rowOffsets == NULL || rowIndexes.count == 0)
+		return;
+	
+	NSUInteger numberOfRows = _numberOfRows;
+	CGFloat defaultHeight = contentView.rowHeight;
+	[rowIndexes enumerateRangesInRange:NSMakeRange(0, numberOfRows) options:0 usingBlock:^(NSRange range, BOOL *stop) {
+		float *heights = calloc(range.length, sizeof(float));
+		if (heights == NULL) {
+			*stop = YES;
+			return;
+		}
+		[self _getHeights:heights forRows:range];
+		for (NSUInteger i = 0; i < range.length; i++) {
+			MBTableGridOffsetIndexSetSize(rowOffsets, range.location + i, heights[i] > 0.0 ? heights[i] : defaultHeight);
+		}
+		free(heights);
+	}];
+	
+	// Rows below the first changed one have moved
+	NSSize contentRectSize = NSMakeSize(NSWidth(contentView.frame), MBTableGridOffsetIndexTotalSize(rowOffsets));
+	[contentView setFrameSize:contentRectSize];
+	[self updateAuxiliaryViewSizesWithFrameSize:contentRectSize];
+	
+	[rowIndexes enumerateRangesInRange:NSMakeRange(0, numberOfRows) options:0 usingBlock:^(NSRange range, BOOL *stop) {
+		[self->contentView invalidateCachedTilesInRows:range];
+	}];
+	NSRect dirtyRect = [contentView rectOfRow:rowIndexes.firstIndex];
+	dirtyRect.size.height = contentRectSize.height - NSMinY(dirtyRect);
+	[rowHeaderView setNeedsDisplayInRect:NSMakeRect(0, NSMinY(dirtyRect), NSWidth(rowHeaderView.bounds), NSHeight(dirtyRect))];
+	[rowFooterView setNeedsDisplayInRect:NSMakeRect(0, NSMinY(dirtyRect), NSWidth(rowFooterView.bounds), NSHeight(dirtyRect))];
+}
+
+- (void)noteNumberOfRowsChanged {
+	NSUInteger previousNumberOfRows = _numberOfRows;
+	NSUInteger previousNumberOfDataSourceRows = _numberOfDataSourceRows;
+	NSUInteger numberOfDataSourceRows = 0;
+	if ([self.dataSource respondsToSelector:@selector(numberOfRowsInTableGrid:)]) {
+		numberOfDataSourceRows = [self.dataSource numberOfRowsInTableGrid:self];
+	}
+	if (numberOfDataSourceRows == previousNumberOfDataSourceRows)
+		return;
+	[self _resolveCopiedCells];
+	
+	// Rows may have been removed from anywhere, so every sorted or filtered row may move
+	if (self.rowPermutation && numberOfDataSourceRows < previousNumberOfDataSourceRows) {
+		[self reloadData];
+		return;
+	}
+	
+	_numberOfDataSourceRows = numberOfDataSourceRows;
+	_rowOffsetIndexIsValid = NO;
+	[self _updateRowPermutationFromNumberOfDataSourceRows:previousNumberOfDataSourceRows];
+	NSUInteger numberOfRows = self.rowPermutation ? self.rowPermutation.count : numberOfDataSourceRows;
+	_numberOfRows = numberOfRows;
+	[self _cancelPrefetchedCells];
+	
+	// Every cell number depends on the number of rows
+	_findIndexIsValid = NO;
+	[(MBTableGridTextFinderClient *)_textFinderClient noteCellNumbersDidChange];
+	[self _updateAggregatesFromNumberOfDataSourceRows:previousNumberOfDataSourceRows];
+	
+	_selectedRowIndexes = [_selectedRowIndexes indexesPassingTest:^(NSUInteger idx, BOOL * stop) {
+		return (BOOL)(idx < numberOfRows);
+	}];
+	
+	[self _updateContentSize];
+	NSSize contentRectSize = contentView.frame.size;
+	
+	// Only rows from the first one added or removed need drawing
+	NSUInteger firstRow = MIN(previousNumberOfRows, numberOfRows);
+	CGFloat top = (firstRow > 0) ? NSMaxY([contentView rectOfRow:firstRow - 1]) : 0;
+	if (contentRectSize.height > top) {
+		NSRect dirtyRect = NSMakeRect(0, top, contentRectSize.width, contentRectSize.height - top);
+		[contentView invalidateCachedTilesInRect:dirtyRect];
+		[contentView setNeedsDisplayInRect:dirtyRect];
+		[rowHeaderView setNeedsDisplayInRect:NSMakeRect(0, top, NSWidth(rowHeaderView.bounds), NSHeight(dirtyRect))];
+		[rowFooterView setNeedsDisplayInRect:NSMakeRect(0, top, NSWidth(rowFooterView.bounds), NSHeight(dirtyRect))];
+	}
+	// Footers may summarize whole columns
+	columnFooterView.needsDisplay = YES;
+	
+	[_textFinder noteClientStringWillChange];
+}
+
+- (void)noteValuesAvailableForColumns:(NSRange)columnRange rows:(NSRange)rowRange {
+	if (columnRange.length == 0 || rowRange.length == 0)
+		return;
+	
+	BOOL needsFlush = NO;
+	@synchronized (_availableValueBlocks) {
+		needsFlush = (_availableValueBlocks.count == 0);
+		[_availableValueBlocks addObject:@[ [NSValue valueWithRange:columnRange], [NSValue valueWithRange:rowRange] ]];
+	}
+	
+	// One pass on the main thread picks up every block reported before it runs
+	if (needsFlush) {
+		dispatch_async(dispatch_get_main_queue(), ^{
+			[self _redrawAvailableValues];
+		});
+	}
+}
+
+- (void)_redrawAvailableValues {
+	NSArray<NSArray<NSValue *> *> *blocks;
+	@synchronized (_availableValueBlocks) {
+		blocks = [_availableValueBlocks copy];
+		[_availableValueBlocks removeAllObjects];
+	}
+	
+	for (NSArray<NSValue *> *block in blocks) {
+		NSRange dataSourceColumnRange = NSIntersectionRange(block[0].rangeValue, NSMakeRange(0, _numberOfColumns));
+		NSRange rowRange = NSIntersectionRange(block[1].rangeValue, NSMakeRange(0, _numberOfDataSourceRows));
+		if (dataSourceColumnRange.length == 0 || rowRange.length == 0)
+			continue;
+		
+		// Cells that were pending passed the filter and sorted as empty, so their rows
+		// may be hidden or belong elsewhere, and the data source's rows and columns may
+		// be anywhere once sorted or moved
+		NSIndexSet *columnIndexes = [self _columnIndexesForDataSourceColumnIndexes:[NSIndexSet indexSetWithIndexesInRange:dataSourceColumnRange]];
+		[self _filterPendingDataSourceRows:rowRange columns:columnIndexes];
+		if (_formulaSheet) {
+			os_unfair_lock_lock(&_formulaLock);
+			for (NSUInteger columnIndex = dataSourceColumnRange.location; columnIndex < NSMaxRange(dataSourceColumnRange); columnIndex++) {
+				MBTableGridFormulaSheetNoteChange(_formulaSheet, columnIndex, rowRange.location, rowRange.length);
+			}
+			os_unfair_lock_unlock(&_formulaLock);
+		}
+		NSIndexSet *dataSourceRowIndexes = [NSIndexSet indexSetWithIndexesInRange:rowRange];
+		[self _repairSortForDataSourceRows:dataSourceRowIndexes columns:columnIndexes];
+		NSIndexSet *rowIndexes = [self _rowIndexesForDataSourceRowIndexes:dataSourceRowIndexes];
+		// Hidden rows are summarized too, since another filter may show them
+		[self _updateAggregatesForColumns:columnIndexes rows:rowIndexes dataSourceRows:dataSourceRowIndexes];
+		if (rowIndexes.count == 0)
+			continue;
+		
+		// The index may have skipped these cells while they were pending, and the
+		// text finder will have taken them for non-matches
+		if (_findIndexSkippedPendingCells)
+			_findIndexIsValid = NO;
+		[(MBTableGridTextFinderClient *)_textFinderClient noteCellsDidChangeInColumns:columnIndexes rows:rowIndexes];
+		
+		NSRect dirtyRect = NSUnionRect([contentView frameOfCellAtColumn:columnIndexes.firstIndex row:rowIndexes.firstIndex],
+									   [contentView frameOfCellAtColumn:columnIndexes.lastIndex row:rowIndexes.lastIndex]);
+		[contentView invalidateCachedTilesInRect:dirtyRect];
+	}
+	[self _recalculateFormulas];
+}
+
 #pragma mark Layout Support
 
 - (NSRect)rectOfColumn:(NSUInteger)columnIndex {
@@ -1689,59 +3004,30 @@ NS_INLINE MBVerticalEdge MBOppositeVerticalEdge(MBVerticalEdge other) {
 
 - (NSRange)_rangeOfColumnsIntersectingRect:(NSRect)rect {
     NSRect contentRect = [self convertRect:rect toView:self.contentView];
-    NSUInteger numberOfColumns = self.numberOfColumns;
-    NSUInteger column = 0;
-    
-    NSUInteger firstColumn = NSNotFound;
-    NSUInteger lastColumn = numberOfColumns - 1;
-    if (numberOfColumns == 0)
-        return NSMakeRange(NSNotFound, 0);
-    
-    while (column < numberOfColumns) {
-        NSRect columnRect = [self.contentView rectOfColumn:column];
-        if (NSMaxX(contentRect) >= NSMinX(columnRect) &&
-            NSMinX(contentRect) <= NSMaxX(columnRect)) {
-            if (firstColumn == NSNotFound) {
-                firstColumn = column;
-            }
-            lastColumn = column;
-        } else if (NSMinX(columnRect) > NSMaxX(contentRect)) {
-            break;
-        }
-        column++;
-    }
-    return NSMakeRange(firstColumn, lastColumn - firstColumn + 1);
+    MBTableGridAxis columns = [self _columnAxis];
+    return MBRangeFromIndexRange(MBTableGridAxisRangeIntersecting(&columns, NSMinX(contentRect), NSMaxX(contentRect)));
 }
 
 - (NSRange)_rangeOfRowsIntersectingRect:(NSRect)rect {
     NSRect contentRect = [self convertRect:rect toView:self.contentView];
-    CGFloat rowHeight = self.contentView.rowHeight;
-    NSUInteger numberOfRows = self.numberOfRows;
-    if (numberOfRows == 0)
-        return NSMakeRange(NSNotFound, 0);
-    
-    NSUInteger firstRow = MAX(0, floor(NSMinY(contentRect) / rowHeight));
-    NSUInteger lastRow = MIN(numberOfRows - 1, MAX(0, ceil(NSMaxY(contentRect)/rowHeight)));
-    return NSMakeRange(firstRow, lastRow - firstRow + 1);
+    MBTableGridAxis rows = [self _rowAxis];
+    return MBRangeFromIndexRange(MBTableGridAxisRangeIntersecting(&rows, NSMinY(contentRect), NSMaxY(contentRect)));
 }
 
 - (NSRect)rectOfSelectionRelativeToContentView {
-    NSRect dirtyRect = NSZeroRect;
     NSIndexSet *rowIndexes = self.selectedRowIndexes;
     NSIndexSet *columnIndexes = self.selectedColumnIndexes;
-    if (rowIndexes.count) {
-        dirtyRect = NSUnionRect([self.contentView rectOfRow:rowIndexes.firstIndex],
-                                [self.contentView rectOfRow:rowIndexes.lastIndex]);
-        if (columnIndexes.count) {
-            NSRect dirtyColumnRect = NSUnionRect([self.contentView rectOfColumn:columnIndexes.firstIndex],
-                                                 [self.contentView rectOfColumn:columnIndexes.lastIndex]);
-            dirtyRect = NSIntersectionRect(dirtyRect, dirtyColumnRect);
-        }
-    } else if (columnIndexes.count) {
-        dirtyRect = NSUnionRect([self.contentView rectOfColumn:columnIndexes.firstIndex],
-                                [self.contentView rectOfColumn:columnIndexes.lastIndex]);
-    }
-    return NSInsetRect(dirtyRect, -1.0, -1.0);
+    MBTableGridSelectionBounds selection = {
+        .firstColumn = columnIndexes.count ? columnIndexes.firstIndex : MBTableGridGeometryNotFound,
+        .lastColumn = columnIndexes.count ? columnIndexes.lastIndex : MBTableGridGeometryNotFound,
+        .firstRow = rowIndexes.count ? rowIndexes.firstIndex : MBTableGridGeometryNotFound,
+        .lastRow = rowIndexes.count ? rowIndexes.lastIndex : MBTableGridGeometryNotFound
+    };
+    MBTableGridAxis columns = [self _columnAxis];
+    MBTableGridAxis rows = [self _rowAxis];
+    NSSize contentSize = self.contentView.frame.size;
+    MBTableGridRect rect = MBTableGridGeometryRectOfSelection(&columns, &rows, selection, contentSize.width, contentSize.height);
+    return NSInsetRect(NSMakeRect(rect.x, rect.y, rect.width, rect.height), -1.0, -1.0);
 }
 
 - (NSRect)frameOfCellAtColumn:(NSUInteger)columnIndex row:(NSUInteger)rowIndex {
@@ -1765,13 +3051,9 @@ NS_INLINE MBVerticalEdge MBOppositeVerticalEdge(MBVerticalEdge other) {
 }
 
 - (NSInteger)columnAtPoint:(NSPoint)aPoint {
-	NSInteger column = 0;
-	while (column < _numberOfColumns) {
-		NSRect columnFrame = [self rectOfColumn:column];
-		if (NSPointInRect(aPoint, columnFrame)) {
-			return column;
-		}
-		column++;
+	NSInteger column = [contentView columnAtPoint:[self convertPoint:aPoint toView:contentView]];
+	if (column != NSNotFound && NSPointInRect(aPoint, [self rectOfColumn:column])) {
+		return column;
 	}
 	return NSNotFound;
 }
@@ -1894,6 +3176,8 @@ NS_INLINE MBVerticalEdge MBOppositeVerticalEdge(MBVerticalEdge other) {
     columnHeaderView.needsDisplay = YES;
     columnFooterView.needsDisplay = YES;
 
+    [self _noteSelectionAggregateChanged];
+
 	// Post the notification
 	if(notify) {
 		[NSNotificationCenter.defaultCenter postNotificationName:MBTableGridDidChangeSelectionNotification object:self];
@@ -1924,6 +3208,8 @@ NS_INLINE MBVerticalEdge MBOppositeVerticalEdge(MBVerticalEdge other) {
     // mark other views as dirty
     rowHeaderView.needsDisplay = YES;
 	
+    [self _noteSelectionAggregateChanged];
+	
 	// Post the notification
 	if(notify) {
 		[NSNotificationCenter.defaultCenter postNotificationName:MBTableGridDidChangeSelectionNotification object:self];
@@ -1954,7 +3240,8 @@ NS_INLINE MBVerticalEdge MBOppositeVerticalEdge(MBVerticalEdge other) {
 		[NSNotificationCenter.defaultCenter addObserver:_delegate selector:@selector(tableGridDidMoveRows:) name:MBTableGridDidMoveRowsNotification object:self];
 	}
     
-    self.columnFooterVisible = [_delegate respondsToSelector:@selector(tableGrid:footerCellForColumn:)];
+    self.columnFooterVisible = ([_delegate respondsToSelector:@selector(tableGrid:footerCellForColumn:)] ||
+                                _columnFooterAggregateFunction != MBTableGridAggregateFunctionNone);
 }
 
 @end
@@ -1970,7 +3257,8 @@ NS_INLINE MBVerticalEdge MBOppositeVerticalEdge(MBVerticalEdge other) {
 @implementation MBTableGrid (DataAccessors)
 
 - (NSString *)_headerStringForColumn:(NSUInteger)columnIndex {
-	// Ask the data source
+	// Ask the data source, whose column letters are the ones formulas refer to
+	columnIndex = [self dataSourceColumnForColumn:columnIndex];
 	if ([self.dataSource respondsToSelector:@selector(tableGrid:headerStringForColumn:)]) {
 		return [self.dataSource tableGrid:self headerStringForColumn:columnIndex];
 	}
@@ -1982,12 +3270,379 @@ NS_INLINE MBVerticalEdge MBOppositeVerticalEdge(MBVerticalEdge other) {
 - (NSString *)_headerStringForRow:(NSUInteger)rowIndex {
 	// Ask the data source
 	if ([self.dataSource respondsToSelector:@selector(tableGrid:headerStringForRow:)]) {
-		return [self.dataSource tableGrid:self headerStringForRow:rowIndex];
+		return [self.dataSource tableGrid:self headerStringForRow:[self dataSourceRowForRow:rowIndex]];
 	}
 
 	return [NSString stringWithFormat:@"%lu", (rowIndex + 1)];
 }
 
+- (BOOL)_providesObjectValuesInBulk {
+    return [self.dataSource respondsToSelector:@selector(tableGrid:getObjectValues:forColumns:rows:)];
+}
+
+- (void)_getObjectValues:(id __strong *)values forColumns:(NSRange)columnRange rows:(NSRange)rowRange {
+    [self _getObjectValues:values forColumns:columnRange rows:rowRange ofDataSourceRows:NULL];
+}
+
+// Fetches sorted rows a run of data source rows at a time, into values laid out for rowRange
+- (void)_getObjectValues:(id __strong *)values forColumns:(NSRange)columnRange rows:(NSRange)rowRange ofDataSourceRows:(const size_t *)dataSourceRowList {
+    __block __strong id *runValues = NULL;
+    [self _enumerateDataSourceRangesInRows:rowRange ofDataSourceRows:dataSourceRowList usingBlock:^(NSRange dataSourceRows, NSUInteger rowIndex, BOOL *stop) {
+        if (dataSourceRows.length == rowRange.length) {
+            [self _getObjectValues:values forColumns:columnRange dataSourceRows:dataSourceRows];
+            return;
+        }
+        if (runValues == NULL) {
+            runValues = (__strong id *)calloc(columnRange.length * rowRange.length, sizeof(id));
+            if (runValues == NULL) {
+                *stop = YES;
+                return;
+            }
+        }
+        [self _getObjectValues:runValues forColumns:columnRange dataSourceRows:dataSourceRows];
+        for (NSUInteger i = 0; i < columnRange.length; i++) {
+            for (NSUInteger j = 0; j < dataSourceRows.length; j++) {
+                values[i * rowRange.length + (rowIndex - rowRange.location) + j] = runValues[i * dataSourceRows.length + j];
+                runValues[i * dataSourceRows.length + j] = nil;
+            }
+        }
+    }];
+    free(runValues);
+}
+
+// Prefers the bulk form of the data source method, a run of data source columns at a
+// time, falling back to one call per cell
+- (void)_getObjectValues:(id __strong *)values forColumns:(NSRange)columnRange dataSourceRows:(NSRange)rowRange {
+    if ([self _providesObjectValuesInBulk]) {
+        [self _enumerateDataSourceRangesInColumns:columnRange usingBlock:^(NSRange dataSourceColumns, NSUInteger columnIndex, BOOL *stop) {
+            __strong id *columnValues = values + (columnIndex - columnRange.location) * rowRange.length;
+            [self.dataSource tableGrid:self getObjectValues:columnValues forColumns:dataSourceColumns rows:rowRange];
+            if (_formulaSheet)
+                [self _getFormulaObjects:columnValues forColumns:dataSourceColumns dataSourceRows:rowRange];
+        }];
+        return;
+    }
+    NSUInteger i = 0;
+    for (NSUInteger columnIndex = columnRange.location; columnIndex < NSMaxRange(columnRange); columnIndex++) {
+        for (NSUInteger rowIndex = rowRange.location; rowIndex < NSMaxRange(rowRange); rowIndex++) {
+            values[i++] = [self _objectValueForColumn:columnIndex dataSourceRow:rowIndex];
+        }
+    }
+}
+
+// Splits a block of cells into batches of at most MBTableGridObjectValueBatchSize cells, visited
+// column by column: whole columns at a time where they fit, and otherwise runs of rows
+- (void)_enumerateBatchesInColumns:(NSRange)columnRange rows:(NSRange)rowRange usingBlock:(void (^)(NSRange batchColumns, NSRange batchRows, BOOL *stop))block {
+    if (columnRange.location == NSNotFound || rowRange.location == NSNotFound || columnRange.length == 0 || rowRange.length == 0)
+        return;
+    
+    NSUInteger rowsPerBatch = MIN(rowRange.length, MBTableGridObjectValueBatchSize);
+    NSUInteger columnsPerBatch = MIN(columnRange.length, MAX(1, MBTableGridObjectValueBatchSize / rowsPerBatch));
+    
+    BOOL stop = NO;
+    for (NSUInteger column = columnRange.location; column < NSMaxRange(columnRange) && !stop; column += columnsPerBatch) {
+        for (NSUInteger row = rowRange.location; row < NSMaxRange(rowRange) && !stop; row += rowsPerBatch) {
+            block(NSMakeRange(column, MIN(columnsPerBatch, NSMaxRange(columnRange) - column)),
+                  NSMakeRange(row, MIN(rowsPerBatch, NSMaxRange(rowRange) - row)), &stop);
+        }
+    }
+}
+
+- (void)_enumerateObjectValuesInColumns:(NSRange)columnRange rows:(NSRange)rowRange usingBlock:(void (^)(NSUInteger columnIndex, NSUInteger rowIndex, id value, BOOL *stop))block {
+    if (columnRange.location == NSNotFound || rowRange.location == NSNotFound)
+        return;
+    __strong id *values = (__strong id *)calloc(MIN(columnRange.length * rowRange.length, MBTableGridObjectValueBatchSize), sizeof(id));
+    if (values == NULL)
+        return;
+    
+    [self _enumerateBatchesInColumns:columnRange rows:rowRange usingBlock:^(NSRange batchColumns, NSRange batchRows, BOOL *stop) {
+        NSUInteger count = batchColumns.length * batchRows.length;
+        @autoreleasepool {
+            [self _getObjectValues:values forColumns:batchColumns rows:batchRows];
+            for (NSUInteger i = 0; i < count && !*stop; i++) {
+                block(batchColumns.location + i / batchRows.length, batchRows.location + i % batchRows.length, values[i], stop);
+            }
+            for (NSUInteger i = 0; i < count; i++) {
+                values[i] = nil;
+            }
+        }
+    }];
+    free(values);
+}
+
+- (BOOL)_providesTypedValues {
+    return [self.dataSource respondsToSelector:@selector(tableGrid:getValues:forColumns:rows:)];
+}
+
+// Two buffers per thread, since copying fetches one batch while the one before it is
+// still being written out
+- (NSMutableData *)_nextStringBuffer {
+    return [self _nextStringBufferForKey:_stringBufferKey];
+}
+
+- (NSMutableData *)_nextStringBufferForKey:(NSString *)key {
+    NSMutableDictionary *threadDictionary = NSThread.currentThread.threadDictionary;
+    NSMutableArray<NSMutableData *> *buffers = threadDictionary[key];
+    if (buffers == nil) {
+        buffers = [NSMutableArray arrayWithObjects:[NSMutableData data], [NSMutableData data], nil];
+        threadDictionary[key] = buffers;
+    }
+    [buffers exchangeObjectAtIndex:0 withObjectAtIndex:1];
+    NSMutableData *buffer = buffers[0];
+    buffer.length = 0;
+    return buffer;
+}
+
+// Splits rows into runs whose data source rows are consecutive and ascending, so that
+// each run can be fetched with one call. The rows are the grid's, or if dataSourceRows
+// is given, indexes into it, such as the rows of copied cells.
+- (void)_enumerateDataSourceRangesInRows:(NSRange)rowRange ofDataSourceRows:(const size_t *)dataSourceRows
+                              usingBlock:(void (^)(NSRange dataSourceRowRange, NSUInteger rowIndex, BOOL *stop))block {
+    BOOL stop = NO;
+    if (dataSourceRows == NULL) {
+        MBTableGridRowPermutation *permutation = self.rowPermutation;
+        if (permutation) {
+            [permutation enumerateDataSourceRangesInRows:rowRange usingBlock:block];
+        } else {
+            block(rowRange, rowRange.location, &stop);
+        }
+        return;
+    }
+    NSUInteger i = rowRange.location;
+    while (i < NSMaxRange(rowRange) && !stop) {
+        NSUInteger length = 1;
+        while (i + length < NSMaxRange(rowRange) && dataSourceRows[i + length] == dataSourceRows[i] + length) {
+            length++;
+        }
+        block(NSMakeRange(dataSourceRows[i], length), i, &stop);
+        i += length;
+    }
+}
+
+- (void)_getValues:(MBTableGridValue *)values forColumns:(NSRange)columnRange rows:(NSRange)rowRange {
+    [self _getValues:values forColumns:columnRange rows:rowRange ofDataSourceRows:NULL];
+}
+
+// Fetches sorted rows a run of data source rows at a time. The data source's strings
+// only last until its next call, so when there's more than one run they're copied into
+// a buffer of the grid's, as offsets until the buffer stops growing.
+- (void)_getValues:(MBTableGridValue *)values forColumns:(NSRange)columnRange rows:(NSRange)rowRange ofDataSourceRows:(const size_t *)dataSourceRowList {
+    NSUInteger count = columnRange.length * rowRange.length;
+    __block MBTableGridValue *runValues = NULL;
+    __block NSMutableData *strings = nil;
+    [self _enumerateDataSourceRangesInRows:rowRange ofDataSourceRows:dataSourceRowList usingBlock:^(NSRange dataSourceRows, NSUInteger rowIndex, BOOL *stop) {
+        if (dataSourceRows.length == rowRange.length) {
+            [self _getValues:values forColumns:columnRange dataSourceRows:dataSourceRows];
+            return;
+        }
+        if (runValues == NULL) {
+            runValues = malloc(count * sizeof(MBTableGridValue));
+            strings = [self _nextStringBuffer];
+            if (runValues == NULL) {
+                memset(values, 0, count * sizeof(MBTableGridValue));
+                *stop = YES;
+                return;
+            }
+        }
+        [self _getValues:runValues forColumns:columnRange dataSourceRows:dataSourceRows];
+        for (NSUInteger i = 0; i < columnRange.length; i++) {
+            for (NSUInteger j = 0; j < dataSourceRows.length; j++) {
+                MBTableGridValue value = runValues[i * dataSourceRows.length + j];
+                if (value.type == MBTableGridValueTypeString) {
+                    size_t offset = strings.length;
+                    if (value.data.string.length)
+                        [strings appendBytes:value.data.string.bytes length:value.data.string.length];
+                    value.data.string.bytes = (const char *)(uintptr_t)offset;
+                }
+                values[i * rowRange.length + (rowIndex - rowRange.location) + j] = value;
+            }
+        }
+    }];
+    if (runValues == NULL)
+        return;
+    free(runValues);
+    
+    const char *bytes = strings.bytes;
+    for (NSUInteger i = 0; i < count; i++) {
+        if (values[i].type == MBTableGridValueTypeString)
+            values[i].data.string.bytes = bytes + (uintptr_t)values[i].data.string.bytes;
+    }
+}
+
+// Hands the data source a zeroed buffer, so that cells it skips read as empty. Columns
+// moved by the grid are fetched a run of data source columns at a time, with each run's
+// strings copied into a buffer of the grid's before the next, as _getValues:forColumns:
+// rows:ofDataSourceRows: copies runs of rows.
+- (void)_getValues:(MBTableGridValue *)values forColumns:(NSRange)columnRange dataSourceRows:(NSRange)rowRange {
+    NSUInteger count = columnRange.length * rowRange.length;
+    memset(values, 0, count * sizeof(MBTableGridValue));
+    __block NSMutableData *strings = nil;
+    [self _enumerateDataSourceRangesInColumns:columnRange usingBlock:^(NSRange dataSourceColumns, NSUInteger columnIndex, BOOL *stop) {
+        MBTableGridValue *columnValues = values + (columnIndex - columnRange.location) * rowRange.length;
+        [self.dataSource tableGrid:self getValues:columnValues forColumns:dataSourceColumns rows:rowRange];
+        if (_formulaSheet)
+            [self _getFormulaResults:columnValues forColumns:dataSourceColumns dataSourceRows:rowRange];
+        if (dataSourceColumns.length == columnRange.length)
+            return;
+        if (strings == nil)
+            strings = [self _nextStringBufferForKey:_columnStringBufferKey];
+        for (NSUInteger i = 0; i < dataSourceColumns.length * rowRange.length; i++) {
+            if (columnValues[i].type != MBTableGridValueTypeString)
+                continue;
+            size_t offset = strings.length;
+            if (columnValues[i].data.string.length)
+                [strings appendBytes:columnValues[i].data.string.bytes length:columnValues[i].data.string.length];
+            columnValues[i].data.string.bytes = (const char *)(uintptr_t)offset;
+        }
+    }];
+    if (strings == nil)
+        return;
+    
+    const char *bytes = strings.bytes;
+    for (NSUInteger i = 0; i < count; i++) {
+        if (values[i].type == MBTableGridValueTypeString)
+            values[i].data.string.bytes = bytes + (uintptr_t)values[i].data.string.bytes;
+    }
+}
+
+- (void)_enumerateValuesInColumns:(NSRange)columnRange rows:(NSRange)rowRange usingBlock:(void (^)(NSUInteger columnIndex, NSUInteger rowIndex, const MBTableGridValue *value, BOOL *stop))block {
+    if (columnRange.location == NSNotFound || rowRange.location == NSNotFound)
+        return;
+    MBTableGridValue *values = malloc(MIN(columnRange.length * rowRange.length, MBTableGridObjectValueBatchSize) * sizeof(MBTableGridValue));
+    if (values == NULL)
+        return;
+    
+    [self _enumerateBatchesInColumns:columnRange rows:rowRange usingBlock:^(NSRange batchColumns, NSRange batchRows, BOOL *stop) {
+        NSUInteger count = batchColumns.length * batchRows.length;
+        [self _getValues:values forColumns:batchColumns rows:batchRows];
+        for (NSUInteger i = 0; i < count && !*stop; i++) {
+            block(batchColumns.location + i / batchRows.length, batchRows.location + i % batchRows.length, &values[i], stop);
+        }
+    }];
+    free(values);
+}
+
+// Wraps a typed value in an object a cell can display. Strings borrow the data
+// source's bytes, so the result mustn't outlive the batch it came from.
+- (id)_objectForValue:(const MBTableGridValue *)value {
+    switch (value->type) {
+        case MBTableGridValueTypeInteger:
+            return @(value->data.integer);
+        case MBTableGridValueTypeDouble:
+            return @(value->data.number);
+        case MBTableGridValueTypeBoolean:
+            return value->data.boolean ? @YES : @NO;
+        case MBTableGridValueTypeDate:
+            return [NSDate dateWithTimeIntervalSince1970:value->data.number];
+        case MBTableGridValueTypeString:
+            if (value->data.string.bytes == NULL)
+                return nil;
+            return CFBridgingRelease(CFStringCreateWithBytesNoCopy(kCFAllocatorDefault, (const UInt8 *)value->data.string.bytes,
+                                                                   value->data.string.length, kCFStringEncodingUTF8,
+                                                                   false, kCFAllocatorNull));
+        case MBTableGridValueTypeEmpty:
+        default:
+            return nil;
+    }
+}
+
+// Tab-separated UTF-8 text for a block of cells. Batches of rows are fetched on this
+// thread, since data sources needn't be thread-safe, and written out on a serial queue
+// while the next batch is fetched, so no more than two batches are held at once. Each
+// batch's strings are copied before it's handed over, since the data source's only
+// last until its next call, and objects are described on this thread too. The rows are
+// indexes into dataSourceRows if it's given.
+- (NSData *)_tabularDataForColumns:(NSRange)columnRange rows:(NSRange)rowRange ofDataSourceRows:(const size_t *)dataSourceRows {
+    NSUInteger rowsPerBatch = MAX(1, MBTableGridObjectValueBatchSize / columnRange.length);
+    BOOL providesTypedValues = [self _providesTypedValues];
+    NSMutableData *data = [NSMutableData data];
+    MBTableGridDelimitedWriter *writer = MBTableGridDelimitedWriterCreate(MBTableGridDelimitedFormatTabSeparated, false,
+                                                                          MBAppendToData, (__bridge void *)data);
+    if (writer == NULL)
+        return nil;
+    
+    dispatch_queue_t queue = dispatch_queue_create("MBTableGrid.copy", DISPATCH_QUEUE_SERIAL);
+    dispatch_semaphore_t batchSlots = dispatch_semaphore_create(2);
+    
+    // The flag lives on this stack frame, which outlasts the queue's last block
+    atomic_bool failed = false;
+    atomic_bool *failure = &failed;
+    
+    for (NSUInteger firstRow=rowRange.location; firstRow<NSMaxRange(rowRange) && !atomic_load(failure); firstRow+=rowsPerBatch) {
+        NSRange batchRows = NSMakeRange(firstRow, MIN(rowsPerBatch, NSMaxRange(rowRange) - firstRow));
+        NSUInteger count = batchRows.length * columnRange.length;
+        dispatch_semaphore_wait(batchSlots, DISPATCH_TIME_FOREVER);
+        
+        // Formatted straight into the buffer, without creating a string per cell
+        MBTableGridValue *values = malloc(count * sizeof(MBTableGridValue));
+        char *strings = NULL;
+        if (values && providesTypedValues) {
+            [self _getValues:values forColumns:columnRange rows:batchRows ofDataSourceRows:dataSourceRows];
+            strings = MBTableGridValuesCopyStrings(values, count);
+        } else if (values) {
+            strings = [self _stringsDescribingObjectValues:values forColumns:columnRange rows:batchRows ofDataSourceRows:dataSourceRows];
+        }
+        if (strings == NULL) {
+            free(values);
+            atomic_store(failure, true);
+            dispatch_semaphore_signal(batchSlots);
+            break;
+        }
+        
+        dispatch_async(queue, ^{
+            if (!atomic_load(failure) && !MBTableGridDelimitedWriterWriteValues(writer, values, columnRange.length, batchRows.length))
+                atomic_store(failure, true);
+            free(values);
+            free(strings);
+            dispatch_semaphore_signal(batchSlots);
+        });
+    }
+    
+    dispatch_sync(queue, ^{
+        if (!MBTableGridDelimitedWriterFlush(writer))
+            atomic_store(failure, true);
+    });
+    MBTableGridDelimitedWriterDestroy(writer);
+    return atomic_load(failure) ? nil : data;
+}
+
+// Fetches a batch of object values and describes each as UTF-8 text in one buffer,
+// which is returned for the values to point into, or NULL if out of memory. Objects
+// are described on this thread, since they belong to the data source.
+- (char *)_stringsDescribingObjectValues:(MBTableGridValue *)values forColumns:(NSRange)columnRange rows:(NSRange)rowRange
+                        ofDataSourceRows:(const size_t *)dataSourceRows {
+    NSUInteger count = columnRange.length * rowRange.length;
+    __strong id *objects = (__strong id *)calloc(count, sizeof(id));
+    if (objects == NULL)
+        return NULL;
+    NSMutableData *strings = [NSMutableData data];
+    @autoreleasepool {
+        [self _getObjectValues:objects forColumns:columnRange rows:rowRange ofDataSourceRows:dataSourceRows];
+        for (NSUInteger i = 0; i < count; i++) {
+            id value = objects[i];
+            objects[i] = nil;
+            values[i] = MBTableGridValueMakeString(NULL, 0);
+            if (value == nil || value == MBTableGridPendingValue)
+                continue;
+            NSString *string = [value isKindOfClass:[NSString class]] ? value : [value description];
+            const char *text = string.UTF8String ?: "";
+            size_t length = strlen(text);
+            values[i].data.string.bytes = (const char *)(uintptr_t)strings.length;
+            values[i].data.string.length = length;
+            [strings appendBytes:text length:length];
+        }
+    }
+    free(objects);
+    char *bytes = malloc(MAX(1, strings.length));
+    if (bytes == NULL)
+        return NULL;
+    memcpy(bytes, strings.bytes, strings.length);
+    for (NSUInteger i = 0; i < count; i++) {
+        values[i].data.string.bytes = bytes + (uintptr_t)values[i].data.string.bytes;
+    }
+    return bytes;
+}
+
 - (NSControlStateValue)_headerStateForColumn:(NSUInteger)columnIndex {
     return [self.selectedColumnIndexes containsIndex:columnIndex];
 }
@@ -1999,27 +3654,51 @@ NS_INLINE MBVerticalEdge MBOppositeVerticalEdge(MBVerticalEdge other) {
 // This form prefers the singular form of the setObjectValue: data source method,
 // but will fall back to the plural form
 - (void)_setObjectValue:(id)value forColumn:(NSUInteger)columnIndex row:(NSUInteger)rowIndex {
+    NSUInteger dataSourceColumnIndex = [self dataSourceColumnForColumn:columnIndex];
+    NSUInteger dataSourceRowIndex = [self dataSourceRowForRow:rowIndex];
+    [self _resolveCopiedCellsInColumns:[NSIndexSet indexSetWithIndex:columnIndex] dataSourceRows:[NSIndexSet indexSetWithIndex:dataSourceRowIndex]];
     if ([self.dataSource respondsToSelector:@selector(tableGrid:setObjectValue:forColumn:row:)]) {
-        [self.dataSource tableGrid:self setObjectValue:value forColumn:columnIndex row:rowIndex];
+        [self.dataSource tableGrid:self setObjectValue:value forColumn:dataSourceColumnIndex row:dataSourceRowIndex];
     } else if ([self.dataSource respondsToSelector:@selector(tableGrid:setObjectValue:forColumns:rows:)]) {
         [self.dataSource tableGrid:self setObjectValue:value
-                        forColumns:[NSIndexSet indexSetWithIndex:columnIndex]
-                              rows:[NSIndexSet indexSetWithIndex:rowIndex]];
+                        forColumns:[NSIndexSet indexSetWithIndex:dataSourceColumnIndex]
+                              rows:[NSIndexSet indexSetWithIndex:dataSourceRowIndex]];
     }
+    [self _noteFormulaObject:value forColumns:[NSIndexSet indexSetWithIndex:dataSourceColumnIndex] dataSourceRows:[NSIndexSet indexSetWithIndex:dataSourceRowIndex]];
+    [self _updateFindIndexForColumns:[NSIndexSet indexSetWithIndex:columnIndex] rows:[NSIndexSet indexSetWithIndex:rowIndex]];
+    [contentView invalidateCachedTilesInRect:[contentView frameOfCellAtColumn:columnIndex row:rowIndex]];
+    [self _updateAggregatesForColumns:[NSIndexSet indexSetWithIndex:columnIndex] rows:[NSIndexSet indexSetWithIndex:rowIndex]
+                       dataSourceRows:[NSIndexSet indexSetWithIndex:dataSourceRowIndex]];
+    [self _repairSortForDataSourceRows:[NSIndexSet indexSetWithIndex:dataSourceRowIndex] columns:[NSIndexSet indexSetWithIndex:columnIndex]];
+    // A new formula's result, and those of the formulas that read the cell, are updated
+    // the same way as they come in
+    [self _recalculateFormulas];
 }
 
 // This form prefers the plural form of the setObjectValue: data source method,
 // but if not implemented will fall back to the singular form (potentially very slow)
 - (void)_setObjectValue:(id)value forColumns:(NSIndexSet *)columnIndexes rows:(NSIndexSet *)rowIndexes {
+    NSIndexSet *dataSourceColumnIndexes = [self _dataSourceColumnIndexesForColumnIndexes:columnIndexes];
+    NSIndexSet *dataSourceRowIndexes = [self _dataSourceRowIndexesForRowIndexes:rowIndexes];
+    [self _resolveCopiedCellsInColumns:columnIndexes dataSourceRows:dataSourceRowIndexes];
 	if ([self.dataSource respondsToSelector:@selector(tableGrid:setObjectValue:forColumns:rows:)]) {
-		[self.dataSource tableGrid:self setObjectValue:value forColumns:columnIndexes rows:rowIndexes];
+		[self.dataSource tableGrid:self setObjectValue:value forColumns:dataSourceColumnIndexes rows:dataSourceRowIndexes];
     } else if ([self.dataSource respondsToSelector:@selector(tableGrid:setObjectValue:forColumn:row:)]) {
-        [columnIndexes enumerateIndexesUsingBlock:^(NSUInteger columnIndex, BOOL *stopColumns) {
-            [rowIndexes enumerateIndexesUsingBlock:^(NSUInteger rowIndex, BOOL *stopRows) {
+        [dataSourceColumnIndexes enumerateIndexesUsingBlock:^(NSUInteger columnIndex, BOOL *stopColumns) {
+            [dataSourceRowIndexes enumerateIndexesUsingBlock:^(NSUInteger rowIndex, BOOL *stopRows) {
                 [self.dataSource tableGrid:self setObjectValue:value forColumn:columnIndex row:rowIndex];
             }];
         }];
 	}
+    [self _noteFormulaObject:value forColumns:dataSourceColumnIndexes dataSourceRows:dataSourceRowIndexes];
+    [self _updateFindIndexForColumns:columnIndexes rows:rowIndexes];
+    if (columnIndexes.count && rowIndexes.count) {
+        [contentView invalidateCachedTilesInRect:NSUnionRect([contentView frameOfCellAtColumn:columnIndexes.firstIndex row:rowIndexes.firstIndex],
+                                                             [contentView frameOfCellAtColumn:columnIndexes.lastIndex row:rowIndexes.lastIndex])];
+    }
+    [self _updateAggregatesForColumns:columnIndexes rows:rowIndexes dataSourceRows:dataSourceRowIndexes];
+    [self _repairSortForDataSourceRows:dataSourceRowIndexes columns:columnIndexes];
+    [self _recalculateFormulas];
 }
 
 - (CGFloat)_minimumWidthForColumn:(NSUInteger)columnIndex {
@@ -2036,30 +3715,132 @@ NS_INLINE MBVerticalEdge MBOppositeVerticalEdge(MBVerticalEdge other) {
     if (columnIndex >= _numberOfColumns)
         return 0.0;
     
-    CGFloat width = 0.0;
-    CGFloat min_width = [self _minimumWidthForColumn:columnIndex];
+    return MBTableGridOffsetIndexSizeAtIndex([self _columnOffsetIndex], columnIndex);
+}
+
+- (void)_setWidth:(CGFloat)width forColumn:(NSUInteger)columnIndex
+{
+    _columnWidths[@(columnIndex)] = @(width);
+    if (_columnOffsetIndexIsValid) {
+        MBTableGridOffsetIndexSetSize(_columnOffsetIndex, columnIndex, width);
+    }
+	
+	if ([self.dataSource respondsToSelector:@selector(tableGrid:setWidth:forColumn:)]) {
+		[self.dataSource tableGrid:self setWidth:width forColumn:[self dataSourceColumnForColumn:columnIndex]];
+    }
+}
+
+- (MBTableGridOffsetIndex *)_columnOffsetIndex {
+    if (_columnOffsetIndexIsValid)
+        return _columnOffsetIndex;
     
-    if ([self.dataSource respondsToSelector:@selector(tableGrid:widthForColumn:)]) {
-        width = [self.dataSource tableGrid:self widthForColumn:columnIndex];
-        if (width > min_width) {
-            _columnWidths[@(columnIndex)] = @(width);
+    NSUInteger numberOfColumns = _numberOfColumns;
+    float *widths = MBTableGridOffsetIndexBeginReset(_columnOffsetIndex, numberOfColumns);
+    if (widths == NULL) {
+        NSLog(@"WARNING: MBTableGrid could not allocate geometry for %lu columns", (unsigned long)numberOfColumns);
+        return _columnOffsetIndex;
+    }
+    
+    // Ask the data source for every width in one go if it can, otherwise column by column,
+    // putting moved columns' widths in the grid's order
+    memset(widths, 0, numberOfColumns * sizeof(float));
+    MBTableGridRowPermutation *columnOrder = self.columnOrder;
+    if ([self.dataSource respondsToSelector:@selector(tableGrid:getWidths:forColumns:)]) {
+        float *dataSourceWidths = columnOrder ? calloc(MAX(1, numberOfColumns), sizeof(float)) : widths;
+        if (dataSourceWidths) {
+            [self.dataSource tableGrid:self getWidths:dataSourceWidths forColumns:NSMakeRange(0, numberOfColumns)];
+        }
+        if (dataSourceWidths && dataSourceWidths != widths) {
+            for (NSUInteger column = 0; column < numberOfColumns; column++) {
+                widths[column] = dataSourceWidths[[columnOrder dataSourceRowForRow:column]];
+            }
+            free(dataSourceWidths);
+        }
+    } else if ([self.dataSource respondsToSelector:@selector(tableGrid:widthForColumn:)]) {
+        for (NSUInteger column = 0; column < numberOfColumns; column++) {
+            widths[column] = [self.dataSource tableGrid:self widthForColumn:[self dataSourceColumnForColumn:column]];
         }
     }
     
-    if (_columnWidths[@(columnIndex)]) {
-        return _columnWidths[@(columnIndex)].doubleValue;
+    // Data source widths win, then widths the user resized to, then the minimum
+    [_columnWidths enumerateKeysAndObjectsUsingBlock:^(NSNumber *key, NSNumber *obj, BOOL *stop) {
+        NSUInteger column = key.unsignedIntegerValue;
+        if (column < numberOfColumns && widths[column] <= [self _minimumWidthForColumn:column]) {
+            widths[column] = obj.floatValue;
+        }
+    }];
+    for (NSUInteger column = 0; column < numberOfColumns; column++) {
+        CGFloat minWidth = [self _minimumWidthForColumn:column];
+        if (widths[column] < minWidth) {
+            widths[column] = minWidth;
+        }
     }
+    
+    MBTableGridOffsetIndexEndReset(_columnOffsetIndex);
+    _columnOffsetIndexIsValid = YES;
+    return _columnOffsetIndex;
+}
 
-    return min_width;
+- (void)_getHeights:(float *)heights forRows:(NSRange)rowRange {
+    MBTableGridRowPermutation *permutation = self.rowPermutation;
+    if ([self.dataSource respondsToSelector:@selector(tableGrid:getHeights:forRows:)]) {
+        if (permutation == nil) {
+            [self.dataSource tableGrid:self getHeights:heights forRows:rowRange];
+            return;
+        }
+        [permutation enumerateDataSourceRangesInRows:rowRange usingBlock:^(NSRange dataSourceRows, NSUInteger rowIndex, BOOL *stop) {
+            [self.dataSource tableGrid:self getHeights:heights + (rowIndex - rowRange.location) forRows:dataSourceRows];
+        }];
+    } else {
+        for (NSUInteger i = 0; i < rowRange.length; i++) {
+            heights[i] = [self.dataSource tableGrid:self heightForRow:[self dataSourceRowForRow:rowRange.location + i]];
+        }
+    }
 }
 
-- (void)_setWidth:(CGFloat)width forColumn:(NSUInteger)columnIndex
-{
-    _columnWidths[@(columnIndex)] = @(width);
-	
-	if ([self.dataSource respondsToSelector:@selector(tableGrid:setWidth:forColumn:)]) {
-		[self.dataSource tableGrid:self setWidth:width forColumn:columnIndex];
+- (MBTableGridAxis)_columnAxis {
+    MBTableGridOffsetIndex *columnOffsets = [self _columnOffsetIndex];
+    MBTableGridAxis axis = { columnOffsets, MBTableGridOffsetIndexCount(columnOffsets), 0.0 };
+    return axis;
+}
+
+- (MBTableGridAxis)_rowAxis {
+    MBTableGridOffsetIndex *rowOffsets = [self _rowOffsetIndex];
+    MBTableGridAxis axis = { rowOffsets, rowOffsets ? MBTableGridOffsetIndexCount(rowOffsets) : _numberOfRows, contentView.rowHeight };
+    return axis;
+}
+
+// Returns NULL when every row is rowHeight tall, in which case callers
+// should stick to simple arithmetic
+- (MBTableGridOffsetIndex *)_rowOffsetIndex {
+    if (_rowOffsetIndexIsValid)
+        return _usesVariableRowHeights ? _rowOffsetIndex : NULL;
+    
+    _usesVariableRowHeights = ([self.dataSource respondsToSelector:@selector(tableGrid:getHeights:forRows:)] ||
+                               [self.dataSource respondsToSelector:@selector(tableGrid:heightForRow:)]);
+    _rowOffsetIndexIsValid = YES;
+    if (!_usesVariableRowHeights) {
+        MBTableGridOffsetIndexResetUniform(_rowOffsetIndex, 0, 0.0);
+        return NULL;
     }
+    
+    NSUInteger numberOfRows = _numberOfRows;
+    CGFloat defaultHeight = contentView.rowHeight;
+    float *heights = MBTableGridOffsetIndexBeginReset(_rowOffsetIndex, numberOfRows);
+    if (heights == NULL) {
+        NSLog(@"WARNING: MBTableGrid could not allocate geometry for %lu rows", (unsigned long)numberOfRows);
+        _usesVariableRowHeights = NO;
+        return NULL;
+    }
+    memset(heights, 0, numberOfRows * sizeof(float));
+    [self _getHeights:heights forRows:NSMakeRange(0, numberOfRows)];
+    for (NSUInteger row = 0; row < numberOfRows; row++) {
+        if (heights[row] <= 0.0) {
+            heights[row] = defaultHeight;
+        }
+    }
+    MBTableGridOffsetIndexEndReset(_rowOffsetIndex);
+    return _rowOffsetIndex;
 }
 
 - (BOOL)_canEditCellAtColumn:(NSUInteger)columnIndex row:(NSUInteger)rowIndex {
@@ -2077,22 +3858,112 @@ NS_INLINE MBVerticalEdge MBOppositeVerticalEdge(MBVerticalEdge other) {
 	return YES;
 }
 
+// Asks about a whole block at once if the delegate allows, and otherwise cell by cell
+- (BOOL)_canEditCellsInColumns:(NSIndexSet *)columnIndexes rows:(NSIndexSet *)rowIndexes {
+	if (![self.dataSource respondsToSelector:@selector(tableGrid:setObjectValue:forColumn:row:)] &&
+        ![self.dataSource respondsToSelector:@selector(tableGrid:setObjectValue:forColumns:rows:)]) {
+		return NO;
+	}
+
+	if ([self.delegate respondsToSelector:@selector(tableGrid:shouldEditColumns:rows:)]) {
+		return [self.delegate tableGrid:self shouldEditColumns:columnIndexes rows:rowIndexes];
+	}
+
+	if ([self.delegate respondsToSelector:@selector(tableGrid:shouldEditColumn:row:)]) {
+		__block BOOL canEdit = YES;
+		[columnIndexes enumerateIndexesUsingBlock:^(NSUInteger columnIndex, BOOL *stopColumns) {
+			[rowIndexes enumerateIndexesUsingBlock:^(NSUInteger rowIndex, BOOL *stopRows) {
+				if (![self.delegate tableGrid:self shouldEditColumn:columnIndex row:rowIndex]) {
+					canEdit = NO;
+					*stopRows = *stopColumns = YES;
+				}
+			}];
+		}];
+		return canEdit;
+	}
+
+	return YES;
+}
+
 #pragma mark Footers
 
 - (NSCell *)_footerCellForColumn:(NSUInteger)columnIndex {
+    NSCell *cell = nil;
     if ([self.dataSource respondsToSelector:@selector(tableGrid:footerCellForColumn:)]) {
-        return [self.dataSource tableGrid:self footerCellForColumn:columnIndex];
+        cell = [self.dataSource tableGrid:self footerCellForColumn:[self dataSourceColumnForColumn:columnIndex]];
     }
-    return nil;
+    if (cell == nil && _columnFooterAggregateFunction != MBTableGridAggregateFunctionNone) {
+        cell = [self _aggregateFooterCellForColumn:columnIndex];
+    }
+    return cell;
+}
+
+- (NSCell *)_aggregateFooterCellForColumn:(NSUInteger)columnIndex {
+    return [self _aggregateFooterCellWithAggregate:[self aggregateForColumn:columnIndex] function:_columnFooterAggregateFunction];
+}
+
+// One cell draws every column's and group's summary, one at a time
+- (NSCell *)_aggregateFooterCellWithAggregate:(MBTableGridAggregate)aggregate function:(MBTableGridAggregateFunction)function {
+    if (_aggregateFooterCell == nil) {
+        NSNumberFormatter *formatter = [[NSNumberFormatter alloc] init];
+        formatter.numberStyle = NSNumberFormatterDecimalStyle;
+        _aggregateFooterCell = [[NSTextFieldCell alloc] initTextCell:@""];
+        _aggregateFooterCell.formatter = formatter;
+        _aggregateFooterCell.alignment = NSTextAlignmentRight;
+        _aggregateFooterCell.font = [NSFont systemFontOfSize:NSFont.smallSystemFontSize];
+        _aggregateFooterCell.textColor = NSColor.secondaryLabelColor;
+    }
+    
+    NSNumber *value = nil;
+    switch (function) {
+        case MBTableGridAggregateFunctionNone:
+            break;
+        case MBTableGridAggregateFunctionSum:
+            value = aggregate.numberCount ? @(aggregate.sum) : nil;
+            break;
+        case MBTableGridAggregateFunctionAverage:
+            value = aggregate.numberCount ? @(MBTableGridAggregateAverage(&aggregate)) : nil;
+            break;
+        case MBTableGridAggregateFunctionMinimum:
+            value = aggregate.numberCount ? @(aggregate.minimum) : nil;
+            break;
+        case MBTableGridAggregateFunctionMaximum:
+            value = aggregate.numberCount ? @(aggregate.maximum) : nil;
+            break;
+        case MBTableGridAggregateFunctionCount:
+            value = @(aggregate.count);
+            break;
+    }
+    _aggregateFooterCell.objectValue = value;
+    return _aggregateFooterCell;
 }
 
 - (NSCell *)_footerCellForRow:(NSUInteger)rowIndex {
     if ([self.dataSource respondsToSelector:@selector(tableGrid:footerCellForRow:)]) {
-        return [self.dataSource tableGrid:self footerCellForRow:rowIndex];
+        return [self.dataSource tableGrid:self footerCellForRow:[self dataSourceRowForRow:rowIndex]];
     }
     return nil;
 }
 
+- (NSCell *)_footerCellForGroup:(NSUInteger)groupIndex {
+    NSCell *cell = nil;
+    if ([self.dataSource respondsToSelector:@selector(tableGrid:footerCellForGroup:)]) {
+        cell = [self.dataSource tableGrid:self footerCellForGroup:groupIndex];
+    }
+    if (cell == nil && _groupFooterAggregateFunction != MBTableGridAggregateFunctionNone) {
+        MBTableGridAggregate aggregate;
+        if (_groupFooterColumnIndex < _numberOfColumns) {
+            aggregate = [self aggregateForGroup:groupIndex column:_groupFooterColumnIndex];
+        } else {
+            // Without a column there is only the group's rows to count
+            aggregate = MBTableGridAggregateMakeEmpty();
+            aggregate.count = [self numberOfRowsInGroup:groupIndex];
+        }
+        cell = [self _aggregateFooterCellWithAggregate:aggregate function:_groupFooterAggregateFunction];
+    }
+    return cell;
+}
+
 @end
 
 @implementation MBTableGrid (DoubleClick)
@@ -0,0 +1,216 @@
+//
+//  MBTableGridAggregate.c
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#include "MBTableGridAggregate.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+// Blocks read from the data source at a time when updating
+#define MBAggregateReadBatchBlocks 512
+
+struct MBTableGridAggregateIndex {
+    size_t rowCount;
+    size_t blockCount;
+    // A power of two at least the number of blocks; node 1 is the root, the
+    // children of node i are 2i and 2i + 1, and block i is node leafCount + i
+    size_t leafCount;
+    MBTableGridAggregate *nodes;
+};
+
+MBTableGridAggregate MBTableGridAggregateMakeEmpty(void) {
+    return (MBTableGridAggregate){ .minimum = INFINITY, .maximum = -INFINITY };
+}
+
+void MBTableGridAggregateAddValues(MBTableGridAggregate *aggregate, const MBTableGridValue *values, size_t count) {
+    size_t valueCount = 0, numberCount = 0, pendingCount = 0;
+    double sum = 0.0, minimum = aggregate->minimum, maximum = aggregate->maximum;
+    for (size_t i = 0; i < count; i++) {
+        MBTableGridValueType type = values[i].type;
+        bool integer = (type == MBTableGridValueTypeInteger);
+        bool number = integer | (type == MBTableGridValueTypeDouble);
+        double value = integer ? (double)values[i].data.integer : values[i].data.number;
+        valueCount += (type != MBTableGridValueTypeEmpty) & (type != MBTableGridValueTypePending);
+        pendingCount += (type == MBTableGridValueTypePending);
+        numberCount += number;
+        sum += number ? value : 0.0;
+        minimum = (number && value < minimum) ? value : minimum;
+        maximum = (number && value > maximum) ? value : maximum;
+    }
+    aggregate->count += valueCount;
+    aggregate->numberCount += numberCount;
+    aggregate->pendingCount += pendingCount;
+    aggregate->sum += sum;
+    aggregate->minimum = minimum;
+    aggregate->maximum = maximum;
+}
+
+void MBTableGridAggregateMerge(MBTableGridAggregate *aggregate, const MBTableGridAggregate *other) {
+    aggregate->count += other->count;
+    aggregate->numberCount += other->numberCount;
+    aggregate->pendingCount += other->pendingCount;
+    aggregate->sum += other->sum;
+    aggregate->minimum = fmin(aggregate->minimum, other->minimum);
+    aggregate->maximum = fmax(aggregate->maximum, other->maximum);
+}
+
+double MBTableGridAggregateAverage(const MBTableGridAggregate *aggregate) {
+    return aggregate->numberCount ? aggregate->sum / (double)aggregate->numberCount : NAN;
+}
+
+static size_t MBBlockCount(size_t rowCount) {
+    return (rowCount + MBTableGridAggregateBlockSize - 1) / MBTableGridAggregateBlockSize;
+}
+
+static size_t MBLeafCount(size_t blockCount) {
+    size_t leafCount = 1;
+    while (leafCount < blockCount)
+        leafCount *= 2;
+    return leafCount;
+}
+
+static inline void MBSummarizeNode(MBTableGridAggregate *nodes, size_t node) {
+    nodes[node] = nodes[2 * node];
+    MBTableGridAggregateMerge(&nodes[node], &nodes[2 * node + 1]);
+}
+
+// Summarizes every node above the leaves again
+static void MBSummarizeAllNodes(MBTableGridAggregateIndex *index) {
+    for (size_t node = index->leafCount - 1; node > 0; node--)
+        MBSummarizeNode(index->nodes, node);
+}
+
+MBTableGridAggregateIndex *MBTableGridAggregateIndexCreate(size_t rowCount) {
+    MBTableGridAggregateIndex *index = calloc(1, sizeof(MBTableGridAggregateIndex));
+    if (index == NULL)
+        return NULL;
+    index->rowCount = rowCount;
+    index->blockCount = MBBlockCount(rowCount);
+    index->leafCount = MBLeafCount(index->blockCount);
+    index->nodes = malloc(2 * index->leafCount * sizeof(MBTableGridAggregate));
+    if (index->nodes == NULL) {
+        free(index);
+        return NULL;
+    }
+    for (size_t node = 0; node < 2 * index->leafCount; node++)
+        index->nodes[node] = MBTableGridAggregateMakeEmpty();
+    return index;
+}
+
+void MBTableGridAggregateIndexDestroy(MBTableGridAggregateIndex *index) {
+    if (index == NULL)
+        return;
+    free(index->nodes);
+    free(index);
+}
+
+size_t MBTableGridAggregateIndexRowCount(const MBTableGridAggregateIndex *index) {
+    return index->rowCount;
+}
+
+bool MBTableGridAggregateIndexSetRowCount(MBTableGridAggregateIndex *index, size_t rowCount) {
+    size_t blockCount = MBBlockCount(rowCount);
+    size_t leafCount = MBLeafCount(blockCount);
+    size_t keptBlockCount = (blockCount < index->blockCount) ? blockCount : index->blockCount;
+    if (leafCount != index->leafCount) {
+        MBTableGridAggregate *nodes = malloc(2 * leafCount * sizeof(MBTableGridAggregate));
+        if (nodes == NULL)
+            return false;
+        for (size_t node = 0; node < 2 * leafCount; node++)
+            nodes[node] = MBTableGridAggregateMakeEmpty();
+        for (size_t block = 0; block < keptBlockCount; block++)
+            nodes[leafCount + block] = index->nodes[index->leafCount + block];
+        free(index->nodes);
+        index->nodes = nodes;
+        index->leafCount = leafCount;
+    } else {
+        for (size_t block = keptBlockCount; block < index->blockCount; block++)
+            index->nodes[leafCount + block] = MBTableGridAggregateMakeEmpty();
+    }
+    index->rowCount = rowCount;
+    index->blockCount = blockCount;
+    MBSummarizeAllNodes(index);
+    return true;
+}
+
+bool MBTableGridAggregateIndexUpdate(MBTableGridAggregateIndex *index, size_t firstRow, size_t count,
+                                     MBTableGridAggregateReadFunction read, void *context) {
+    if (firstRow >= index->rowCount || count == 0)
+        return true;
+    size_t endRow = (count > index->rowCount - firstRow) ? index->rowCount : firstRow + count;
+    size_t firstBlock = firstRow / MBTableGridAggregateBlockSize;
+    size_t endBlock = MBBlockCount(endRow);
+    size_t batchBlocks = (endBlock - firstBlock < MBAggregateReadBatchBlocks) ? endBlock - firstBlock : MBAggregateReadBatchBlocks;
+    MBTableGridValue *values = malloc(batchBlocks * MBTableGridAggregateBlockSize * sizeof(MBTableGridValue));
+    if (values == NULL)
+        return false;
+
+    bool succeeded = true;
+    size_t leafCount = index->leafCount;
+    for (size_t batchBlock = firstBlock; batchBlock < endBlock && succeeded; batchBlock += batchBlocks) {
+        size_t batchFirstRow = batchBlock * MBTableGridAggregateBlockSize;
+        size_t batchEndRow = (batchBlock + batchBlocks) * MBTableGridAggregateBlockSize;
+        if (batchEndRow > index->rowCount)
+            batchEndRow = index->rowCount;
+        succeeded = read(context, batchFirstRow, batchEndRow - batchFirstRow, values);
+        for (size_t row = batchFirstRow; row < batchEndRow && succeeded; row += MBTableGridAggregateBlockSize) {
+            size_t length = (batchEndRow - row < MBTableGridAggregateBlockSize) ? batchEndRow - row : MBTableGridAggregateBlockSize;
+            MBTableGridAggregate *leaf = &index->nodes[leafCount + row / MBTableGridAggregateBlockSize];
+            *leaf = MBTableGridAggregateMakeEmpty();
+            MBTableGridAggregateAddValues(leaf, values + (row - batchFirstRow), length);
+        }
+    }
+    free(values);
+
+    // Each level above has half as many nodes to summarize again
+    for (size_t first = leafCount + firstBlock, last = leafCount + endBlock - 1; first > 1; ) {
+        first /= 2;
+        last /= 2;
+        for (size_t node = first; node <= last; node++)
+            MBSummarizeNode(index->nodes, node);
+    }
+    return succeeded;
+}
+
+static bool MBSummarizeRows(size_t firstRow, size_t endRow, MBTableGridAggregateReadFunction read, void *context,
+                            MBTableGridAggregate *aggregate) {
+    MBTableGridValue values[MBTableGridAggregateBlockSize];
+    if (endRow <= firstRow)
+        return true;
+    if (!read(context, firstRow, endRow - firstRow, values))
+        return false;
+    MBTableGridAggregateAddValues(aggregate, values, endRow - firstRow);
+    return true;
+}
+
+bool MBTableGridAggregateIndexSummarize(const MBTableGridAggregateIndex *index, size_t firstRow, size_t count,
+                                        MBTableGridAggregateReadFunction read, void *context, MBTableGridAggregate *aggregate) {
+    if (firstRow >= index->rowCount || count == 0)
+        return true;
+    size_t endRow = (count > index->rowCount - firstRow) ? index->rowCount : firstRow + count;
+    size_t firstBlock = MBBlockCount(firstRow);
+    size_t endBlock = endRow / MBTableGridAggregateBlockSize;
+    // The last block may be partial, but it holds nothing past the last row
+    if (endRow == index->rowCount)
+        endBlock = index->blockCount;
+
+    // Rows within a single block are read as they are
+    if (firstBlock > endBlock)
+        return MBSummarizeRows(firstRow, endRow, read, context, aggregate);
+
+    size_t headEndRow = firstBlock * MBTableGridAggregateBlockSize;
+    if (!MBSummarizeRows(firstRow, (headEndRow < endRow) ? headEndRow : endRow, read, context, aggregate) ||
+        !MBSummarizeRows(endBlock * MBTableGridAggregateBlockSize, endRow, read, context, aggregate))
+        return false;
+    for (size_t first = index->leafCount + firstBlock, end = index->leafCount + endBlock; first < end; first /= 2, end /= 2) {
+        if (first & 1)
+            MBTableGridAggregateMerge(aggregate, &index->nodes[first++]);
+        if (end & 1)
+            MBTableGridAggregateMerge(aggregate, &index->nodes[--end]);
+    }
+    return true;
+}
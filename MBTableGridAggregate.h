@@ -0,0 +1,150 @@
+//
+//  MBTableGridAggregate.h
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#ifndef MBTableGridAggregate_h
+#define MBTableGridAggregate_h
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "MBTableGridValue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief		A summary of some cells: how many there are of each kind,
+ *				and the total, least and greatest of their numbers.
+ *
+ * @details		Only integers and doubles count as numbers; Booleans,
+ *				dates and strings are counted but not added up.
+ */
+typedef struct MBTableGridAggregate {
+    /* Cells that are neither empty nor pending */
+    size_t count;
+    /* Cells holding integers or doubles */
+    size_t numberCount;
+    /* Cells whose values are still loading, and so aren't summarized */
+    size_t pendingCount;
+    double sum;
+    /* INFINITY and -INFINITY if there are no numbers */
+    double minimum;
+    double maximum;
+} MBTableGridAggregate;
+
+/**
+ * @brief		Returns the summary of no cells at all.
+ */
+MBTableGridAggregate MBTableGridAggregateMakeEmpty(void);
+
+/**
+ * @brief		Adds \c count values to a summary.
+ */
+void MBTableGridAggregateAddValues(MBTableGridAggregate *aggregate, const MBTableGridValue *values, size_t count);
+
+/**
+ * @brief		Adds the cells summarized by \c other to a summary.
+ */
+void MBTableGridAggregateMerge(MBTableGridAggregate *aggregate, const MBTableGridAggregate *other);
+
+/**
+ * @brief		Returns the mean of the numbers summarized, or \c NAN if
+ *				there are none.
+ */
+double MBTableGridAggregateAverage(const MBTableGridAggregate *aggregate);
+
+/**
+ * @brief		Reads the values of \c count rows from \c firstRow on into
+ *				\c values. Returns \c false to stop, for example when out
+ *				of memory.
+ */
+typedef bool (*MBTableGridAggregateReadFunction)(void *context, size_t firstRow, size_t count, MBTableGridValue *values);
+
+/**
+ * @brief		The number of rows each leaf of an
+ *				\c MBTableGridAggregateIndex summarizes.
+ */
+#define MBTableGridAggregateBlockSize 128
+
+/**
+ * @brief		\c MBTableGridAggregateIndex summarizes one column's cells
+ *				so that any run of its rows can be summarized in
+ *				logarithmic time.
+ *
+ * @details		The rows are divided into blocks of
+ *				\c MBTableGridAggregateBlockSize, each block is summarized,
+ *				and the blocks' summaries are combined pairwise into a
+ *				segment tree. A run of rows is summarized from the few
+ *				nodes that cover its whole blocks, plus the values of the
+ *				partial blocks at either end, read again through a
+ *				\c MBTableGridAggregateReadFunction; the cells themselves
+ *				aren't kept, so the index takes under two bytes a row.
+ *
+ *				Changing cells re-reads the blocks holding them and
+ *				summarizes their ancestors again, so an edit costs one
+ *				block's read and a logarithmic number of merges, and the
+ *				sum never drifts the way a running total does.
+ *
+ *				The index is not thread-safe.
+ */
+typedef struct MBTableGridAggregateIndex MBTableGridAggregateIndex;
+
+/**
+ * @brief		Creates an index of \c rowCount rows, all empty until
+ *				updated. Returns \c NULL if out of memory.
+ */
+MBTableGridAggregateIndex *MBTableGridAggregateIndexCreate(size_t rowCount);
+
+/**
+ * @brief		Frees an index created by \c MBTableGridAggregateIndexCreate.
+ */
+void MBTableGridAggregateIndexDestroy(MBTableGridAggregateIndex *index);
+
+/**
+ * @brief		Returns the number of rows the index covers.
+ */
+size_t MBTableGridAggregateIndexRowCount(const MBTableGridAggregateIndex *index);
+
+/**
+ * @brief		Changes the number of rows the index covers.
+ *
+ * @details		Rows added are empty until updated. The block holding
+ *				the last row keeps its summary, which may include rows
+ *				that have been removed, so update it after shrinking the
+ *				index. Returns \c false, leaving the index as it was, if
+ *				out of memory.
+ */
+bool MBTableGridAggregateIndexSetRowCount(MBTableGridAggregateIndex *index, size_t rowCount);
+
+/**
+ * @brief		Reads the blocks holding \c count rows from \c firstRow on
+ *				and summarizes them again.
+ *
+ * @details		Blocks are read a batch at a time. Returns \c false if
+ *				\c read fails or memory runs out, in which case some of
+ *				the blocks may not have been summarized again.
+ */
+bool MBTableGridAggregateIndexUpdate(MBTableGridAggregateIndex *index, size_t firstRow, size_t count,
+                                     MBTableGridAggregateReadFunction read, void *context);
+
+/**
+ * @brief		Adds the cells in \c count rows from \c firstRow on to a
+ *				summary, reading the rows in partial blocks at either end
+ *				through \c read.
+ *
+ * @details		Rows past the end of the index are left out. Returns
+ *				\c false if \c read fails.
+ */
+bool MBTableGridAggregateIndexSummarize(const MBTableGridAggregateIndex *index, size_t firstRow, size_t count,
+                                        MBTableGridAggregateReadFunction read, void *context, MBTableGridAggregate *aggregate);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MBTableGridAggregate_h */
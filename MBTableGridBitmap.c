@@ -0,0 +1,474 @@
+//
+//  MBTableGridBitmap.c
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#include "MBTableGridBitmap.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define MBChunkSize 65536
+#define MBChunkWords (MBChunkSize / 64)
+#define MBArrayMaximum 4096
+#define MBLastKey (UINT64_MAX >> 16)
+
+typedef enum MBChunkType {
+    MBChunkTypeArray,
+    MBChunkTypeBitmap,
+    MBChunkTypeRuns
+} MBChunkType;
+
+/* Runs are maximal, so neighbouring runs are never adjacent */
+typedef struct MBRun {
+    uint16_t first;
+    uint16_t last;
+} MBRun;
+
+typedef struct MBChunk {
+    uint64_t key;
+    /* Values for an array, words for a bitmap, or runs */
+    void *data;
+    /* Members, from 1 to 65536 */
+    uint32_t cardinality;
+    /* Values in an array, or runs */
+    uint32_t count;
+    MBChunkType type;
+} MBChunk;
+
+struct MBTableGridBitmap {
+    /* Chunks with at least one member, in order of key */
+    MBChunk *chunks;
+    size_t count;
+    size_t capacity;
+    uint64_t cardinality;
+};
+
+MBTableGridBitmap *MBTableGridBitmapCreate(void) {
+    return calloc(1, sizeof(MBTableGridBitmap));
+}
+
+void MBTableGridBitmapDestroy(MBTableGridBitmap *bitmap) {
+    if (bitmap == NULL)
+        return;
+    MBTableGridBitmapClear(bitmap);
+    free(bitmap->chunks);
+    free(bitmap);
+}
+
+void MBTableGridBitmapClear(MBTableGridBitmap *bitmap) {
+    for (size_t i = 0; i < bitmap->count; i++)
+        free(bitmap->chunks[i].data);
+    bitmap->count = 0;
+    bitmap->cardinality = 0;
+}
+
+static void MBWordsSetRange(uint64_t *words, uint32_t first, uint32_t end, bool value) {
+    while (first < end) {
+        uint32_t bit = first % 64;
+        uint32_t length = (end - first < 64 - bit) ? end - first : 64 - bit;
+        uint64_t mask = (length == 64) ? UINT64_MAX : ((UINT64_C(1) << length) - 1) << bit;
+        if (value)
+            words[first / 64] |= mask;
+        else
+            words[first / 64] &= ~mask;
+        first += length;
+    }
+}
+
+// The first bit at or after first that equals value, or MBChunkSize
+static uint32_t MBWordsNext(const uint64_t *words, uint32_t first, bool value) {
+    if (first >= MBChunkSize)
+        return MBChunkSize;
+    uint32_t index = first / 64;
+    uint64_t word = (value ? words[index] : ~words[index]) & (UINT64_MAX << (first % 64));
+    while (word == 0) {
+        if (++index == MBChunkWords)
+            return MBChunkSize;
+        word = value ? words[index] : ~words[index];
+    }
+    return index * 64 + (uint32_t)__builtin_ctzll(word);
+}
+
+// The last bit at or before last that equals value, or -1
+static int32_t MBWordsPrevious(const uint64_t *words, int32_t last, bool value) {
+    if (last < 0)
+        return -1;
+    int32_t index = last / 64;
+    uint64_t word = (value ? words[index] : ~words[index]) & (UINT64_MAX >> (63 - last % 64));
+    while (word == 0) {
+        if (--index < 0)
+            return -1;
+        word = value ? words[index] : ~words[index];
+    }
+    return index * 64 + 63 - (int32_t)__builtin_clzll(word);
+}
+
+// The position of the first array value at or after value
+static uint32_t MBArrayLowerBound(const uint16_t *values, uint32_t count, uint32_t value) {
+    uint32_t lower = 0, upper = count;
+    while (lower < upper) {
+        uint32_t middle = lower + (upper - lower) / 2;
+        if (values[middle] < value)
+            lower = middle + 1;
+        else
+            upper = middle;
+    }
+    return lower;
+}
+
+// The position of the last run starting at or before value, or -1
+static int32_t MBRunContaining(const MBRun *runs, uint32_t count, uint32_t value) {
+    uint32_t lower = 0, upper = count;
+    while (lower < upper) {
+        uint32_t middle = lower + (upper - lower) / 2;
+        if (runs[middle].first <= value)
+            lower = middle + 1;
+        else
+            upper = middle;
+    }
+    return (int32_t)lower - 1;
+}
+
+static bool MBChunkContains(const MBChunk *chunk, uint32_t value) {
+    if (chunk->type == MBChunkTypeBitmap) {
+        return (((const uint64_t *)chunk->data)[value / 64] >> (value % 64)) & 1;
+    } else if (chunk->type == MBChunkTypeArray) {
+        const uint16_t *values = chunk->data;
+        uint32_t i = MBArrayLowerBound(values, chunk->count, value);
+        return i < chunk->count && values[i] == value;
+    }
+    const MBRun *runs = chunk->data;
+    int32_t i = MBRunContaining(runs, chunk->count, value);
+    return i >= 0 && value <= runs[i].last;
+}
+
+// The first member at or after value, or MBChunkSize
+static uint32_t MBChunkNextMember(const MBChunk *chunk, uint32_t value) {
+    if (chunk->type == MBChunkTypeBitmap)
+        return MBWordsNext(chunk->data, value, true);
+    if (chunk->type == MBChunkTypeArray) {
+        const uint16_t *values = chunk->data;
+        uint32_t i = MBArrayLowerBound(values, chunk->count, value);
+        return i < chunk->count ? values[i] : MBChunkSize;
+    }
+    const MBRun *runs = chunk->data;
+    int32_t i = MBRunContaining(runs, chunk->count, value);
+    if (i >= 0 && value <= runs[i].last)
+        return value;
+    return (uint32_t)(i + 1) < chunk->count ? runs[i + 1].first : MBChunkSize;
+}
+
+// The last member at or before value, or -1
+static int32_t MBChunkPreviousMember(const MBChunk *chunk, uint32_t value) {
+    if (chunk->type == MBChunkTypeBitmap)
+        return MBWordsPrevious(chunk->data, (int32_t)value, true);
+    if (chunk->type == MBChunkTypeArray) {
+        const uint16_t *values = chunk->data;
+        uint32_t i = MBArrayLowerBound(values, chunk->count, value + 1);
+        return i > 0 ? values[i - 1] : -1;
+    }
+    const MBRun *runs = chunk->data;
+    int32_t i = MBRunContaining(runs, chunk->count, value);
+    if (i < 0)
+        return -1;
+    return value <= runs[i].last ? (int32_t)value : runs[i].last;
+}
+
+// The first non-member at or after value, or MBChunkSize
+static uint32_t MBChunkNextNonMember(const MBChunk *chunk, uint32_t value) {
+    if (chunk->type == MBChunkTypeBitmap)
+        return MBWordsNext(chunk->data, value, false);
+    if (chunk->type == MBChunkTypeArray) {
+        const uint16_t *values = chunk->data;
+        for (uint32_t i = MBArrayLowerBound(values, chunk->count, value); i < chunk->count && values[i] == value; i++)
+            value++;
+        return value;
+    }
+    const MBRun *runs = chunk->data;
+    int32_t i = MBRunContaining(runs, chunk->count, value);
+    return (i >= 0 && value <= runs[i].last) ? runs[i].last + 1u : value;
+}
+
+// The last non-member at or before value, or -1
+static int32_t MBChunkPreviousNonMember(const MBChunk *chunk, uint32_t value) {
+    if (chunk->type == MBChunkTypeBitmap)
+        return MBWordsPrevious(chunk->data, (int32_t)value, false);
+    if (chunk->type == MBChunkTypeArray) {
+        const uint16_t *values = chunk->data;
+        int32_t position = (int32_t)value;
+        for (int32_t i = (int32_t)MBArrayLowerBound(values, chunk->count, value + 1) - 1; i >= 0 && values[i] == position; i--)
+            position--;
+        return position;
+    }
+    const MBRun *runs = chunk->data;
+    int32_t i = MBRunContaining(runs, chunk->count, value);
+    return (i >= 0 && value <= runs[i].last) ? runs[i].first - 1 : (int32_t)value;
+}
+
+static void MBChunkGetWords(const MBChunk *chunk, uint64_t *words) {
+    if (chunk->type == MBChunkTypeBitmap) {
+        memcpy(words, chunk->data, MBChunkWords * sizeof(uint64_t));
+        return;
+    }
+    memset(words, 0, MBChunkWords * sizeof(uint64_t));
+    if (chunk->type == MBChunkTypeArray) {
+        const uint16_t *values = chunk->data;
+        for (uint32_t i = 0; i < chunk->count; i++)
+            words[values[i] / 64] |= UINT64_C(1) << (values[i] % 64);
+    } else {
+        const MBRun *runs = chunk->data;
+        for (uint32_t i = 0; i < chunk->count; i++)
+            MBWordsSetRange(words, runs[i].first, runs[i].last + 1u, true);
+    }
+}
+
+// Stores the bits in whichever form takes the least space. Returns false if out of
+// memory, leaving the chunk as it was; the chunk must not be left empty.
+static bool MBChunkSetWords(MBChunk *chunk, const uint64_t *words) {
+    uint32_t cardinality = 0, runCount = 0;
+    uint64_t carry = 0;
+    for (uint32_t i = 0; i < MBChunkWords; i++) {
+        cardinality += (uint32_t)__builtin_popcountll(words[i]);
+        runCount += (uint32_t)__builtin_popcountll(words[i] & ~((words[i] << 1) | carry));
+        carry = words[i] >> 63;
+    }
+
+    size_t arrayBytes = cardinality <= MBArrayMaximum ? cardinality * sizeof(uint16_t) : SIZE_MAX;
+    size_t runBytes = runCount * sizeof(MBRun);
+    size_t bitmapBytes = MBChunkWords * sizeof(uint64_t);
+    void *data = NULL;
+    MBChunkType type;
+    uint32_t count = 0;
+
+    if (arrayBytes <= runBytes && arrayBytes <= bitmapBytes) {
+        uint16_t *values = malloc(arrayBytes);
+        if (values == NULL)
+            return false;
+        for (uint32_t i = 0; i < MBChunkWords; i++) {
+            for (uint64_t word = words[i]; word; word &= word - 1)
+                values[count++] = (uint16_t)(i * 64 + (uint32_t)__builtin_ctzll(word));
+        }
+        type = MBChunkTypeArray;
+        data = values;
+    } else if (runBytes < bitmapBytes) {
+        MBRun *runs = malloc(runBytes);
+        if (runs == NULL)
+            return false;
+        for (uint32_t first = MBWordsNext(words, 0, true); first < MBChunkSize; ) {
+            uint32_t end = MBWordsNext(words, first, false);
+            runs[count++] = (MBRun){ (uint16_t)first, (uint16_t)(end - 1) };
+            first = MBWordsNext(words, end, true);
+        }
+        type = MBChunkTypeRuns;
+        data = runs;
+    } else {
+        if ((data = malloc(bitmapBytes)) == NULL)
+            return false;
+        memcpy(data, words, bitmapBytes);
+        type = MBChunkTypeBitmap;
+    }
+
+    free(chunk->data);
+    chunk->data = data;
+    chunk->type = type;
+    chunk->count = count;
+    chunk->cardinality = cardinality;
+    return true;
+}
+
+// The position of the first chunk with a key at or after key
+static size_t MBChunkLowerBound(const MBTableGridBitmap *bitmap, uint64_t key) {
+    size_t lower = 0, upper = bitmap->count;
+    while (lower < upper) {
+        size_t middle = lower + (upper - lower) / 2;
+        if (bitmap->chunks[middle].key < key)
+            lower = middle + 1;
+        else
+            upper = middle;
+    }
+    return lower;
+}
+
+static const MBChunk *MBFindChunk(const MBTableGridBitmap *bitmap, uint64_t key) {
+    size_t i = MBChunkLowerBound(bitmap, key);
+    return (i < bitmap->count && bitmap->chunks[i].key == key) ? &bitmap->chunks[i] : NULL;
+}
+
+static void MBRemoveChunk(MBTableGridBitmap *bitmap, size_t i) {
+    bitmap->cardinality -= bitmap->chunks[i].cardinality;
+    free(bitmap->chunks[i].data);
+    memmove(&bitmap->chunks[i], &bitmap->chunks[i + 1], (bitmap->count - i - 1) * sizeof(MBChunk));
+    bitmap->count--;
+}
+
+// Inserts an empty chunk, which the caller must fill, at position i
+static MBChunk *MBInsertChunk(MBTableGridBitmap *bitmap, size_t i, uint64_t key) {
+    if (bitmap->count == bitmap->capacity) {
+        size_t capacity = bitmap->capacity ? bitmap->capacity * 2 : 16;
+        MBChunk *chunks = realloc(bitmap->chunks, capacity * sizeof(MBChunk));
+        if (chunks == NULL)
+            return NULL;
+        bitmap->chunks = chunks;
+        bitmap->capacity = capacity;
+    }
+    memmove(&bitmap->chunks[i + 1], &bitmap->chunks[i], (bitmap->count - i) * sizeof(MBChunk));
+    bitmap->count++;
+    bitmap->chunks[i] = (MBChunk){ .key = key };
+    return &bitmap->chunks[i];
+}
+
+typedef enum MBOperation {
+    MBOperationAdd,
+    MBOperationRemove,
+    MBOperationAssign
+} MBOperation;
+
+// Applies an operation to the numbers from location, one chunk at a time
+static bool MBModify(MBTableGridBitmap *bitmap, uint64_t location, uint64_t length, MBOperation operation,
+                     const unsigned char *bytes) {
+    uint64_t words[MBChunkWords];
+    if (length > UINT64_MAX - location)
+        length = UINT64_MAX - location;
+
+    while (length) {
+        uint64_t key = location >> 16;
+        uint32_t first = (uint32_t)(location & 0xFFFF);
+        uint32_t end = (length < MBChunkSize - first) ? first + (uint32_t)length : MBChunkSize;
+        size_t i = MBChunkLowerBound(bitmap, key);
+        MBChunk *chunk = (i < bitmap->count && bitmap->chunks[i].key == key) ? &bitmap->chunks[i] : NULL;
+
+        if (operation == MBOperationRemove && chunk == NULL) {
+            // Nothing to remove
+        } else if (operation == MBOperationRemove && first == 0 && end == MBChunkSize) {
+            MBRemoveChunk(bitmap, i);
+        } else if (operation == MBOperationAdd && first == 0 && end == MBChunkSize) {
+            // A whole chunk is a single run
+            MBRun *run = malloc(sizeof(MBRun));
+            if (run == NULL || (chunk == NULL && (chunk = MBInsertChunk(bitmap, i, key)) == NULL)) {
+                free(run);
+                return false;
+            }
+            *run = (MBRun){ 0, MBChunkSize - 1 };
+            bitmap->cardinality += MBChunkSize - chunk->cardinality;
+            free(chunk->data);
+            *chunk = (MBChunk){ key, run, MBChunkSize, 1, MBChunkTypeRuns };
+        } else {
+            if (chunk)
+                MBChunkGetWords(chunk, words);
+            else
+                memset(words, 0, sizeof(words));
+
+            if (operation == MBOperationAssign) {
+                MBWordsSetRange(words, first, end, false);
+                for (uint32_t bit = first; bit < end; bit++, bytes++) {
+                    if (*bytes)
+                        words[bit / 64] |= UINT64_C(1) << (bit % 64);
+                }
+            } else {
+                MBWordsSetRange(words, first, end, operation == MBOperationAdd);
+            }
+
+            if (MBWordsNext(words, 0, true) == MBChunkSize) {
+                if (chunk)
+                    MBRemoveChunk(bitmap, i);
+            } else {
+                uint32_t cardinality = chunk ? chunk->cardinality : 0;
+                if (chunk == NULL && (chunk = MBInsertChunk(bitmap, i, key)) == NULL)
+                    return false;
+                if (!MBChunkSetWords(chunk, words)) {
+                    if (chunk->data == NULL)
+                        memmove(&bitmap->chunks[i], &bitmap->chunks[i + 1], (--bitmap->count - i) * sizeof(MBChunk));
+                    return false;
+                }
+                bitmap->cardinality += chunk->cardinality;
+                bitmap->cardinality -= cardinality;
+            }
+        }
+
+        location += end - first;
+        length -= end - first;
+    }
+    return true;
+}
+
+bool MBTableGridBitmapAddRange(MBTableGridBitmap *bitmap, uint64_t location, uint64_t length) {
+    return MBModify(bitmap, location, length, MBOperationAdd, NULL);
+}
+
+bool MBTableGridBitmapRemoveRange(MBTableGridBitmap *bitmap, uint64_t location, uint64_t length) {
+    return MBModify(bitmap, location, length, MBOperationRemove, NULL);
+}
+
+bool MBTableGridBitmapAssignBytes(MBTableGridBitmap *bitmap, uint64_t location, const unsigned char *bytes, size_t count) {
+    return MBModify(bitmap, location, count, MBOperationAssign, bytes);
+}
+
+bool MBTableGridBitmapContains(const MBTableGridBitmap *bitmap, uint64_t number) {
+    const MBChunk *chunk = MBFindChunk(bitmap, number >> 16);
+    return chunk && MBChunkContains(chunk, (uint32_t)(number & 0xFFFF));
+}
+
+uint64_t MBTableGridBitmapCardinality(const MBTableGridBitmap *bitmap) {
+    return bitmap->cardinality;
+}
+
+uint64_t MBTableGridBitmapNextMember(const MBTableGridBitmap *bitmap, uint64_t location) {
+    uint64_t key = location >> 16;
+    for (size_t i = MBChunkLowerBound(bitmap, key); i < bitmap->count; i++) {
+        const MBChunk *chunk = &bitmap->chunks[i];
+        uint32_t value = MBChunkNextMember(chunk, chunk->key == key ? (uint32_t)(location & 0xFFFF) : 0);
+        if (value < MBChunkSize)
+            return (chunk->key << 16) | value;
+    }
+    return MBTableGridBitmapNotFound;
+}
+
+uint64_t MBTableGridBitmapPreviousMember(const MBTableGridBitmap *bitmap, uint64_t location) {
+    if (location == 0)
+        return MBTableGridBitmapNotFound;
+    uint64_t last = location - 1, key = last >> 16;
+    for (size_t i = MBChunkLowerBound(bitmap, key + 1); i > 0; i--) {
+        const MBChunk *chunk = &bitmap->chunks[i - 1];
+        int32_t value = MBChunkPreviousMember(chunk, chunk->key == key ? (uint32_t)(last & 0xFFFF) : MBChunkSize - 1);
+        if (value >= 0)
+            return (chunk->key << 16) | (uint32_t)value;
+    }
+    return MBTableGridBitmapNotFound;
+}
+
+uint64_t MBTableGridBitmapNextNonMember(const MBTableGridBitmap *bitmap, uint64_t location) {
+    for (;;) {
+        uint64_t key = location >> 16;
+        const MBChunk *chunk = MBFindChunk(bitmap, key);
+        if (chunk == NULL)
+            return location;
+        uint32_t value = MBChunkNextNonMember(chunk, (uint32_t)(location & 0xFFFF));
+        if (value < MBChunkSize)
+            return (key << 16) | value;
+        // The run carries on into the next chunk, if there is one
+        if (key == MBLastKey)
+            return MBTableGridBitmapNotFound;
+        location = (key + 1) << 16;
+    }
+}
+
+uint64_t MBTableGridBitmapPreviousNonMember(const MBTableGridBitmap *bitmap, uint64_t location) {
+    if (location == 0)
+        return MBTableGridBitmapNotFound;
+    uint64_t last = location - 1;
+    for (;;) {
+        uint64_t key = last >> 16;
+        const MBChunk *chunk = MBFindChunk(bitmap, key);
+        if (chunk == NULL)
+            return last;
+        int32_t value = MBChunkPreviousNonMember(chunk, (uint32_t)(last & 0xFFFF));
+        if (value >= 0)
+            return (key << 16) | (uint32_t)value;
+        if (key == 0)
+            return MBTableGridBitmapNotFound;
+        last = (key << 16) - 1;
+    }
+}
@@ -0,0 +1,125 @@
+//
+//  MBTableGridBitmap.h
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#ifndef MBTableGridBitmap_h
+#define MBTableGridBitmap_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief		Returned by the bitmap's searches when there's no such bit.
+ */
+#define MBTableGridBitmapNotFound ((uint64_t)-1)
+
+/**
+ * @brief		\c MBTableGridBitmap is a compressed set of 64-bit numbers,
+ *				such as cells numbered in column-first order.
+ *
+ * @details		Numbers are split into chunks of 65,536 by their high bits,
+ *				and each chunk that has any members is stored in whichever
+ *				of three forms is smallest for it: a sorted array of up to
+ *				4,096 members, a plain bitmap, or a list of runs. Sparse
+ *				matches, dense matches and whole columns therefore all take
+ *				little space, and finding the next or previous member from
+ *				any point takes a binary search over the chunks and one
+ *				within a chunk, rather than a scan.
+ *
+ *				The bitmap is plain C so that it can be built and measured
+ *				away from AppKit. It is not thread-safe.
+ */
+typedef struct MBTableGridBitmap MBTableGridBitmap;
+
+/**
+ * @brief		Creates an empty bitmap. Returns \c NULL if out of memory.
+ */
+MBTableGridBitmap *MBTableGridBitmapCreate(void);
+
+/**
+ * @brief		Frees a bitmap created with \c MBTableGridBitmapCreate.
+ */
+void MBTableGridBitmapDestroy(MBTableGridBitmap *bitmap);
+
+/**
+ * @brief		Removes every member.
+ */
+void MBTableGridBitmapClear(MBTableGridBitmap *bitmap);
+
+/**
+ * @brief		Adds the \c length numbers from \c location.
+ *
+ * @return		\c false if out of memory, in which case the bitmap may
+ *				hold some but not all of them.
+ */
+bool MBTableGridBitmapAddRange(MBTableGridBitmap *bitmap, uint64_t location, uint64_t length);
+
+/**
+ * @brief		Removes the \c length numbers from \c location.
+ *
+ * @return		\c false if out of memory, in which case some of them may
+ *				remain.
+ */
+bool MBTableGridBitmapRemoveRange(MBTableGridBitmap *bitmap, uint64_t location, uint64_t length);
+
+/**
+ * @brief		Makes \c location + \c i a member if \c bytes[i] is nonzero,
+ *				and not a member otherwise, for each of the \c count bytes.
+ *
+ * @details		This is the quickest way to record a block of results,
+ *				such as the match flags for a batch of cells, since each
+ *				chunk is rewritten once rather than once per run.
+ *
+ * @return		\c false if out of memory, in which case some of the
+ *				numbers may be left as they were.
+ */
+bool MBTableGridBitmapAssignBytes(MBTableGridBitmap *bitmap, uint64_t location, const unsigned char *bytes, size_t count);
+
+/**
+ * @brief		Returns whether \c number is a member.
+ */
+bool MBTableGridBitmapContains(const MBTableGridBitmap *bitmap, uint64_t number);
+
+/**
+ * @brief		Returns the number of members.
+ */
+uint64_t MBTableGridBitmapCardinality(const MBTableGridBitmap *bitmap);
+
+/**
+ * @brief		Returns the first member at or after \c location, or
+ *				\c MBTableGridBitmapNotFound.
+ */
+uint64_t MBTableGridBitmapNextMember(const MBTableGridBitmap *bitmap, uint64_t location);
+
+/**
+ * @brief		Returns the last member before \c location, or
+ *				\c MBTableGridBitmapNotFound.
+ */
+uint64_t MBTableGridBitmapPreviousMember(const MBTableGridBitmap *bitmap, uint64_t location);
+
+/**
+ * @brief		Returns the first number at or after \c location that isn't
+ *				a member, which is the end of the run of members there.
+ */
+uint64_t MBTableGridBitmapNextNonMember(const MBTableGridBitmap *bitmap, uint64_t location);
+
+/**
+ * @brief		Returns the last number before \c location that isn't a
+ *				member, or \c MBTableGridBitmapNotFound if every number
+ *				before it is.
+ */
+uint64_t MBTableGridBitmapPreviousNonMember(const MBTableGridBitmap *bitmap, uint64_t location);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MBTableGridBitmap_h */
@@ -0,0 +1,644 @@
+//
+//  MBTableGridColumnStore.c
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#include "MBTableGridColumnStore.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MBWordBits 64
+#define MBInitialRowCapacity 64
+#define MBInitialArenaCapacity 256
+
+/* Arenas smaller than this are never worth compacting */
+#define MBMinimumCompactionLength 4096
+
+/* Longest string parsed as a number; anything longer isn't one */
+#define MBMaximumNumberLength 63
+
+typedef struct MBStringSlot {
+    size_t offset;
+    size_t length;
+} MBStringSlot;
+
+typedef struct MBColumn {
+    MBTableGridColumnType type;
+
+    /* One int64_t, double or MBStringSlot per row, and a bit per row set
+       for cells that hold a value */
+    unsigned char *cells;
+    uint64_t *present;
+
+    /* String columns only: the text of every string stored since the
+       arena was last compacted, of which garbageLength bytes are no
+       longer referenced by any cell */
+    char *arena;
+    size_t arenaLength;
+    size_t arenaCapacity;
+    size_t garbageLength;
+} MBColumn;
+
+struct MBTableGridColumnStore {
+    MBColumn *columns;
+    size_t columnCount;
+    size_t columnCapacity;
+
+    size_t rowCount;
+    /* Rows allocated in every column */
+    size_t rowCapacity;
+};
+
+static size_t MBCellSize(MBTableGridColumnType type) {
+    return type == MBTableGridColumnTypeString ? sizeof(MBStringSlot) : sizeof(int64_t);
+}
+
+static size_t MBWordCount(size_t bitCount) {
+    return (bitCount + MBWordBits - 1) / MBWordBits;
+}
+
+static inline bool MBGetBit(const uint64_t *bits, size_t index) {
+    return (bits[index / MBWordBits] >> (index % MBWordBits)) & 1;
+}
+
+static inline void MBPutBit(uint64_t *bits, size_t index, bool isSet) {
+    uint64_t mask = (uint64_t)1 << (index % MBWordBits);
+    if (isSet)
+        bits[index / MBWordBits] |= mask;
+    else
+        bits[index / MBWordBits] &= ~mask;
+}
+
+// Copies bits within or between bitmaps, allowing overlap in the manner of memmove
+static void MBMoveBits(uint64_t *destination, size_t to, const uint64_t *source, size_t from, size_t count) {
+    size_t wholeWords = (to % MBWordBits == 0 && from % MBWordBits == 0) ? count / MBWordBits : 0;
+    size_t wholeBits = wholeWords * MBWordBits;
+
+    if (destination == source && to > from) {
+        for (size_t i = count; i > wholeBits; i--)
+            MBPutBit(destination, to + i - 1, MBGetBit(source, from + i - 1));
+        if (wholeWords)
+            memmove(destination + to / MBWordBits, source + from / MBWordBits, wholeWords * sizeof(uint64_t));
+    } else {
+        if (wholeWords)
+            memmove(destination + to / MBWordBits, source + from / MBWordBits, wholeWords * sizeof(uint64_t));
+        for (size_t i = wholeBits; i < count; i++)
+            MBPutBit(destination, to + i, MBGetBit(source, from + i));
+    }
+}
+
+static void MBClearBits(uint64_t *bits, size_t from, size_t count) {
+    for (size_t i = from; i < from + count; i++)
+        MBPutBit(bits, i, false);
+}
+
+// Where a block of moved indexes starts once dropped before destination
+static size_t MBMovedLocation(const size_t *indexes, size_t count, size_t destination) {
+    if (destination > indexes[count - 1])
+        return destination - count;
+    if (destination >= indexes[0])
+        return indexes[0];
+    return destination;
+}
+
+static bool MBColumnReserve(MBColumn *column, size_t rowCapacity) {
+    unsigned char *cells = realloc(column->cells, rowCapacity * MBCellSize(column->type));
+    if (cells == NULL)
+        return false;
+    column->cells = cells;
+
+    uint64_t *present = realloc(column->present, MBWordCount(rowCapacity) * sizeof(uint64_t));
+    if (present == NULL)
+        return false;
+    column->present = present;
+    return true;
+}
+
+static void MBColumnFree(MBColumn *column) {
+    free(column->cells);
+    free(column->present);
+    free(column->arena);
+}
+
+// Moves a run of cells within a column, allowing overlap
+static void MBColumnShift(MBColumn *column, size_t to, size_t from, size_t count) {
+    size_t cellSize = MBCellSize(column->type);
+    if (count == 0 || to == from)
+        return;
+    memmove(column->cells + to * cellSize, column->cells + from * cellSize, count * cellSize);
+    MBMoveBits(column->present, to, column->present, from, count);
+}
+
+// Closes up the gaps left by the listed rows
+static void MBColumnCloseRows(MBColumn *column, size_t rowCount, const size_t *rows, size_t count) {
+    size_t write = rows[0];
+    for (size_t i = 0; i < count; i++) {
+        size_t start = rows[i] + 1;
+        size_t end = i + 1 < count ? rows[i + 1] : rowCount;
+        MBColumnShift(column, write, start, end - start);
+        write += end - start;
+    }
+}
+
+static void MBColumnClearCell(MBColumn *column, size_t row) {
+    if (!MBGetBit(column->present, row))
+        return;
+    if (column->type == MBTableGridColumnTypeString)
+        column->garbageLength += ((MBStringSlot *)column->cells)[row].length;
+    MBPutBit(column->present, row, false);
+}
+
+// Appends text to a string column's arena. The text may itself be in the
+// arena, so it's located by offset across any reallocation.
+static bool MBColumnAppendText(MBColumn *column, const char *bytes, size_t length, size_t *offset) {
+    if (column->arenaLength + length > column->arenaCapacity) {
+        bool isInArena = column->arena && bytes >= column->arena && bytes < column->arena + column->arenaLength;
+        size_t sourceOffset = isInArena ? (size_t)(bytes - column->arena) : 0;
+        size_t capacity = column->arenaCapacity ? column->arenaCapacity : MBInitialArenaCapacity;
+        while (capacity < column->arenaLength + length)
+            capacity *= 2;
+
+        char *arena = realloc(column->arena, capacity);
+        if (arena == NULL)
+            return false;
+        column->arena = arena;
+        column->arenaCapacity = capacity;
+        if (isInArena)
+            bytes = arena + sourceOffset;
+    }
+    if (length)
+        memcpy(column->arena + column->arenaLength, bytes, length);
+    *offset = column->arenaLength;
+    column->arenaLength += length;
+    return true;
+}
+
+// Grows a string column's arena to take another length bytes, moving it
+// to a new allocation but leaving the old one for the caller to free, so
+// that values borrowed from it stay valid in the meantime
+static bool MBColumnReserveText(MBColumn *column, size_t length, char **retiredArena) {
+    *retiredArena = NULL;
+    if (column->arenaLength + length <= column->arenaCapacity)
+        return true;
+    size_t capacity = column->arenaCapacity ? column->arenaCapacity : MBInitialArenaCapacity;
+    while (capacity < column->arenaLength + length)
+        capacity *= 2;
+
+    char *arena = malloc(capacity);
+    if (arena == NULL)
+        return false;
+    if (column->arenaLength)
+        memcpy(arena, column->arena, column->arenaLength);
+    *retiredArena = column->arena;
+    column->arena = arena;
+    column->arenaCapacity = capacity;
+    return true;
+}
+
+// Rewrites a string column's arena with only the text still in use, once
+// more than half of it is garbage
+static void MBColumnCompact(MBColumn *column, size_t rowCount) {
+    if (column->type != MBTableGridColumnTypeString || column->garbageLength < MBMinimumCompactionLength ||
+        column->garbageLength * 2 < column->arenaLength)
+        return;
+
+    size_t liveLength = column->arenaLength - column->garbageLength;
+    size_t capacity = liveLength > MBInitialArenaCapacity ? liveLength : MBInitialArenaCapacity;
+    char *arena = malloc(capacity);
+    if (arena == NULL)
+        return;
+
+    MBStringSlot *slots = (MBStringSlot *)column->cells;
+    size_t length = 0;
+    for (size_t row = 0; row < rowCount; row++) {
+        if (!MBGetBit(column->present, row))
+            continue;
+        memcpy(arena + length, column->arena + slots[row].offset, slots[row].length);
+        slots[row].offset = length;
+        length += slots[row].length;
+    }
+    free(column->arena);
+    column->arena = arena;
+    column->arenaLength = length;
+    column->arenaCapacity = capacity;
+    column->garbageLength = 0;
+}
+
+// Copies a string into a NUL-terminated buffer with surrounding spaces
+// trimmed, for the C library's number parsers
+static bool MBTrimmedNumberText(const MBTableGridValue *value, char *text) {
+    const char *bytes = value->data.string.bytes;
+    size_t length = bytes ? value->data.string.length : 0;
+    while (length && isspace((unsigned char)bytes[0])) {
+        bytes++;
+        length--;
+    }
+    while (length && isspace((unsigned char)bytes[length - 1]))
+        length--;
+    if (length == 0 || length > MBMaximumNumberLength)
+        return false;
+    memcpy(text, bytes, length);
+    text[length] = '\0';
+    return true;
+}
+
+static bool MBParseDouble(const MBTableGridValue *value, double *number) {
+    char text[MBMaximumNumberLength + 1];
+    char *end;
+    if (!MBTrimmedNumberText(value, text))
+        return false;
+    double parsed = strtod(text, &end);
+    if (*end != '\0')
+        return false;
+    *number = parsed;
+    return true;
+}
+
+static bool MBIntegerForDouble(double number, int64_t *integer) {
+    // The range of int64_t, both ends exactly representable as doubles
+    if (!(number >= -9223372036854775808.0 && number < 9223372036854775808.0) || number != trunc(number))
+        return false;
+    *integer = (int64_t)number;
+    return true;
+}
+
+static bool MBIntegerForValue(const MBTableGridValue *value, int64_t *integer) {
+    switch (value->type) {
+        case MBTableGridValueTypeInteger:
+            *integer = value->data.integer;
+            return true;
+        case MBTableGridValueTypeDouble:
+            return MBIntegerForDouble(value->data.number, integer);
+        case MBTableGridValueTypeBoolean:
+            *integer = value->data.boolean ? 1 : 0;
+            return true;
+        case MBTableGridValueTypeString: {
+            char text[MBMaximumNumberLength + 1];
+            char *end;
+            double number;
+            if (!MBTrimmedNumberText(value, text))
+                return false;
+            errno = 0;
+            long long parsed = strtoll(text, &end, 10);
+            if (*end == '\0' && errno == 0) {
+                *integer = parsed;
+                return true;
+            }
+            // Accept the likes of "1.0" and "1e6"
+            return MBParseDouble(value, &number) && MBIntegerForDouble(number, integer);
+        }
+        default:
+            return false;
+    }
+}
+
+static bool MBNumberForValue(const MBTableGridValue *value, MBTableGridColumnType type, double *number) {
+    switch (value->type) {
+        case MBTableGridValueTypeInteger:
+            *number = (double)value->data.integer;
+            return true;
+        case MBTableGridValueTypeDouble:
+            *number = value->data.number;
+            return true;
+        case MBTableGridValueTypeBoolean:
+            if (type == MBTableGridColumnTypeDate)
+                return false;
+            *number = value->data.boolean ? 1.0 : 0.0;
+            return true;
+        case MBTableGridValueTypeDate:
+            if (type != MBTableGridColumnTypeDate)
+                return false;
+            *number = value->data.number;
+            return true;
+        case MBTableGridValueTypeString:
+            if (type == MBTableGridColumnTypeDate)
+                return MBTableGridValueParseDate(value->data.string.bytes, value->data.string.bytes ? value->data.string.length : 0, number);
+            return MBParseDouble(value, number);
+        default:
+            return false;
+    }
+}
+
+// Sets a cell without compacting, so that values borrowed from the store
+// stay valid until the caller is done with them
+static bool MBSetCell(MBColumn *column, size_t row, const MBTableGridValue *value) {
+    if (value->type == MBTableGridValueTypeEmpty || value->type == MBTableGridValueTypePending) {
+        MBColumnClearCell(column, row);
+        return true;
+    }
+
+    switch (column->type) {
+        case MBTableGridColumnTypeInteger: {
+            int64_t integer;
+            if (!MBIntegerForValue(value, &integer))
+                return false;
+            ((int64_t *)column->cells)[row] = integer;
+            break;
+        }
+        case MBTableGridColumnTypeDouble:
+        case MBTableGridColumnTypeDate: {
+            double number;
+            if (!MBNumberForValue(value, column->type, &number))
+                return false;
+            ((double *)column->cells)[row] = number;
+            break;
+        }
+        case MBTableGridColumnTypeString: {
+            char scratch[MBTableGridValueFormatCapacity];
+            size_t length, offset;
+            const char *text = MBTableGridValueGetUTF8(value, scratch, &length);
+            if (!MBColumnAppendText(column, text, length, &offset))
+                return false;
+            MBColumnClearCell(column, row);
+            ((MBStringSlot *)column->cells)[row] = (MBStringSlot){ offset, length };
+            break;
+        }
+    }
+    MBPutBit(column->present, row, true);
+    return true;
+}
+
+MBTableGridColumnStore *MBTableGridColumnStoreCreate(void) {
+    return calloc(1, sizeof(MBTableGridColumnStore));
+}
+
+void MBTableGridColumnStoreDestroy(MBTableGridColumnStore *store) {
+    if (store == NULL)
+        return;
+    for (size_t i = 0; i < store->columnCount; i++)
+        MBColumnFree(&store->columns[i]);
+    free(store->columns);
+    free(store);
+}
+
+size_t MBTableGridColumnStoreColumnCount(const MBTableGridColumnStore *store) {
+    return store->columnCount;
+}
+
+size_t MBTableGridColumnStoreRowCount(const MBTableGridColumnStore *store) {
+    return store->rowCount;
+}
+
+MBTableGridColumnType MBTableGridColumnStoreColumnType(const MBTableGridColumnStore *store, size_t column) {
+    return store->columns[column].type;
+}
+
+size_t MBTableGridColumnStoreByteCount(const MBTableGridColumnStore *store) {
+    size_t byteCount = sizeof(MBTableGridColumnStore) + store->columnCapacity * sizeof(MBColumn);
+    for (size_t i = 0; i < store->columnCount; i++) {
+        const MBColumn *column = &store->columns[i];
+        byteCount += store->rowCapacity * MBCellSize(column->type);
+        byteCount += MBWordCount(store->rowCapacity) * sizeof(uint64_t);
+        byteCount += column->arenaCapacity;
+    }
+    return byteCount;
+}
+
+bool MBTableGridColumnStoreInsertColumns(MBTableGridColumnStore *store, size_t column, size_t count, MBTableGridColumnType type) {
+    if (column > store->columnCount)
+        return false;
+    if (count == 0)
+        return true;
+
+    if (store->columnCount + count > store->columnCapacity) {
+        size_t capacity = store->columnCapacity ? store->columnCapacity : 8;
+        while (capacity < store->columnCount + count)
+            capacity *= 2;
+        MBColumn *columns = realloc(store->columns, capacity * sizeof(MBColumn));
+        if (columns == NULL)
+            return false;
+        store->columns = columns;
+        store->columnCapacity = capacity;
+    }
+
+    MBColumn *inserted = calloc(count, sizeof(MBColumn));
+    if (inserted == NULL)
+        return false;
+    for (size_t i = 0; i < count; i++) {
+        inserted[i].type = type;
+        if (store->rowCapacity == 0)
+            continue;
+        inserted[i].cells = malloc(store->rowCapacity * MBCellSize(type));
+        inserted[i].present = calloc(MBWordCount(store->rowCapacity), sizeof(uint64_t));
+        if (inserted[i].cells == NULL || inserted[i].present == NULL) {
+            for (size_t j = 0; j <= i; j++)
+                MBColumnFree(&inserted[j]);
+            free(inserted);
+            return false;
+        }
+    }
+
+    memmove(&store->columns[column + count], &store->columns[column], (store->columnCount - column) * sizeof(MBColumn));
+    memcpy(&store->columns[column], inserted, count * sizeof(MBColumn));
+    store->columnCount += count;
+    free(inserted);
+    return true;
+}
+
+void MBTableGridColumnStoreRemoveColumns(MBTableGridColumnStore *store, const size_t *columns, size_t count) {
+    if (count == 0)
+        return;
+    size_t write = columns[0];
+    for (size_t i = 0; i < count; i++) {
+        size_t start = columns[i] + 1;
+        size_t end = i + 1 < count ? columns[i + 1] : store->columnCount;
+        MBColumnFree(&store->columns[columns[i]]);
+        memmove(&store->columns[write], &store->columns[start], (end - start) * sizeof(MBColumn));
+        write += end - start;
+    }
+    store->columnCount -= count;
+}
+
+size_t MBTableGridColumnStoreMoveColumns(MBTableGridColumnStore *store, const size_t *columns, size_t count, size_t destination) {
+    if (count == 0)
+        return destination;
+    size_t location = MBMovedLocation(columns, count, destination);
+    MBColumn *moved = malloc(count * sizeof(MBColumn));
+    if (moved == NULL)
+        return (size_t)-1;
+
+    for (size_t i = 0; i < count; i++)
+        moved[i] = store->columns[columns[i]];
+    size_t write = columns[0];
+    for (size_t i = 0; i < count; i++) {
+        size_t start = columns[i] + 1;
+        size_t end = i + 1 < count ? columns[i + 1] : store->columnCount;
+        memmove(&store->columns[write], &store->columns[start], (end - start) * sizeof(MBColumn));
+        write += end - start;
+    }
+    memmove(&store->columns[location + count], &store->columns[location],
+            (store->columnCount - count - location) * sizeof(MBColumn));
+    memcpy(&store->columns[location], moved, count * sizeof(MBColumn));
+    free(moved);
+    return location;
+}
+
+bool MBTableGridColumnStoreInsertRows(MBTableGridColumnStore *store, size_t row, size_t count) {
+    if (row > store->rowCount)
+        return false;
+    if (count == 0)
+        return true;
+
+    size_t rowCount = store->rowCount + count;
+    if (rowCount > store->rowCapacity) {
+        size_t capacity = store->rowCapacity ? store->rowCapacity : MBInitialRowCapacity;
+        while (capacity < rowCount)
+            capacity *= 2;
+        // A column that grows before another fails just keeps the extra room
+        for (size_t i = 0; i < store->columnCount; i++) {
+            if (!MBColumnReserve(&store->columns[i], capacity))
+                return false;
+        }
+        store->rowCapacity = capacity;
+    }
+
+    for (size_t i = 0; i < store->columnCount; i++) {
+        MBColumn *column = &store->columns[i];
+        MBColumnShift(column, row + count, row, store->rowCount - row);
+        MBClearBits(column->present, row, count);
+    }
+    store->rowCount = rowCount;
+    return true;
+}
+
+void MBTableGridColumnStoreRemoveRows(MBTableGridColumnStore *store, const size_t *rows, size_t count) {
+    if (count == 0)
+        return;
+    for (size_t i = 0; i < store->columnCount; i++) {
+        MBColumn *column = &store->columns[i];
+        if (column->type == MBTableGridColumnTypeString) {
+            for (size_t j = 0; j < count; j++)
+                MBColumnClearCell(column, rows[j]);
+        }
+        MBColumnCloseRows(column, store->rowCount, rows, count);
+    }
+    store->rowCount -= count;
+    for (size_t i = 0; i < store->columnCount; i++)
+        MBColumnCompact(&store->columns[i], store->rowCount);
+}
+
+size_t MBTableGridColumnStoreMoveRows(MBTableGridColumnStore *store, const size_t *rows, size_t count, size_t destination) {
+    if (count == 0)
+        return destination;
+    size_t location = MBMovedLocation(rows, count, destination);
+    unsigned char *cells = malloc(count * sizeof(MBStringSlot));
+    uint64_t *present = calloc(MBWordCount(count), sizeof(uint64_t));
+    if (cells == NULL || present == NULL) {
+        free(cells);
+        free(present);
+        return (size_t)-1;
+    }
+
+    for (size_t i = 0; i < store->columnCount; i++) {
+        MBColumn *column = &store->columns[i];
+        size_t cellSize = MBCellSize(column->type);
+
+        // Set the moved rows aside, close up the gaps, then open a gap at the new location
+        for (size_t j = 0; j < count; j++) {
+            memcpy(cells + j * cellSize, column->cells + rows[j] * cellSize, cellSize);
+            MBPutBit(present, j, MBGetBit(column->present, rows[j]));
+        }
+        MBColumnCloseRows(column, store->rowCount, rows, count);
+        MBColumnShift(column, location + count, location, store->rowCount - count - location);
+        memcpy(column->cells + location * cellSize, cells, count * cellSize);
+        MBMoveBits(column->present, location, present, 0, count);
+    }
+    free(cells);
+    free(present);
+    return location;
+}
+
+void MBTableGridColumnStoreGetValues(const MBTableGridColumnStore *store, MBTableGridValue *values,
+                                     size_t column, size_t columnCount, size_t row, size_t rowCount) {
+    for (size_t i = 0; i < columnCount; i++) {
+        const MBColumn *source = &store->columns[column + i];
+        MBTableGridValue *value = &values[i * rowCount];
+
+        for (size_t j = 0; j < rowCount; j++, value++) {
+            size_t cell = row + j;
+            if (!MBGetBit(source->present, cell)) {
+                memset(value, 0, sizeof(MBTableGridValue));
+                continue;
+            }
+            switch (source->type) {
+                case MBTableGridColumnTypeInteger:
+                    *value = MBTableGridValueMakeInteger(((const int64_t *)source->cells)[cell]);
+                    break;
+                case MBTableGridColumnTypeDouble:
+                    *value = MBTableGridValueMakeDouble(((const double *)source->cells)[cell]);
+                    break;
+                case MBTableGridColumnTypeDate:
+                    *value = MBTableGridValueMakeDate(((const double *)source->cells)[cell]);
+                    break;
+                case MBTableGridColumnTypeString: {
+                    MBStringSlot slot = ((const MBStringSlot *)source->cells)[cell];
+                    *value = MBTableGridValueMakeString(source->arena ? source->arena + slot.offset : "", slot.length);
+                    break;
+                }
+            }
+        }
+    }
+}
+
+bool MBTableGridColumnStoreSetValue(MBTableGridColumnStore *store, size_t column, size_t row, const MBTableGridValue *value) {
+    if (column >= store->columnCount || row >= store->rowCount)
+        return false;
+    bool didSet = MBSetCell(&store->columns[column], row, value);
+    MBColumnCompact(&store->columns[column], store->rowCount);
+    return didSet;
+}
+
+size_t MBTableGridColumnStoreSetValues(MBTableGridColumnStore *store, const MBTableGridValue *values,
+                                       size_t column, size_t columnCount, size_t row, size_t rowCount) {
+    size_t failureCount = 0;
+    if (column >= store->columnCount || row >= store->rowCount)
+        return columnCount * rowCount;
+    size_t settableColumns = column + columnCount > store->columnCount ? store->columnCount - column : columnCount;
+    size_t settableRows = row + rowCount > store->rowCount ? store->rowCount - row : rowCount;
+    failureCount = columnCount * rowCount - settableColumns * settableRows;
+
+    // The values may have been borrowed from this store, so make room for
+    // all of the text up front, and keep the arenas it came from until
+    // every cell has been copied
+    char **retiredArenas = calloc(settableColumns, sizeof(char *));
+    if (retiredArenas == NULL)
+        return columnCount * rowCount;
+    for (size_t i = 0; i < settableColumns; i++) {
+        MBColumn *target = &store->columns[column + i];
+        if (target->type != MBTableGridColumnTypeString)
+            continue;
+        size_t textLength = 0;
+        for (size_t j = 0; j < settableRows; j++) {
+            char scratch[MBTableGridValueFormatCapacity];
+            size_t length;
+            MBTableGridValueGetUTF8(&values[i * rowCount + j], scratch, &length);
+            textLength += length;
+        }
+        if (!MBColumnReserveText(target, textLength, &retiredArenas[i])) {
+            for (size_t k = 0; k < i; k++)
+                free(retiredArenas[k]);
+            free(retiredArenas);
+            return columnCount * rowCount;
+        }
+    }
+
+    for (size_t i = 0; i < settableColumns; i++) {
+        MBColumn *target = &store->columns[column + i];
+        for (size_t j = 0; j < settableRows; j++) {
+            if (!MBSetCell(target, row + j, &values[i * rowCount + j]))
+                failureCount++;
+        }
+    }
+    for (size_t i = 0; i < settableColumns; i++) {
+        free(retiredArenas[i]);
+        MBColumnCompact(&store->columns[column + i], store->rowCount);
+    }
+    free(retiredArenas);
+    return failureCount;
+}
@@ -0,0 +1,183 @@
+//
+//  MBTableGridColumnStore.h
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#ifndef MBTableGridColumnStore_h
+#define MBTableGridColumnStore_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "MBTableGridValue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief		The kind of data held by a column of an
+ *				\c MBTableGridColumnStore.
+ */
+typedef enum MBTableGridColumnType {
+    MBTableGridColumnTypeInteger = 0,
+    MBTableGridColumnTypeDouble,
+    MBTableGridColumnTypeDate,
+    MBTableGridColumnTypeString
+} MBTableGridColumnType;
+
+/**
+ * @brief		\c MBTableGridColumnStore is an in-memory table whose
+ *				columns each hold a single type of value.
+ *
+ * @details		Integers are stored as \c int64_t, and doubles and dates
+ *				(seconds since 1970 UTC) as \c double, each in one
+ *				contiguous array per column. Strings are UTF-8 bytes
+ *				appended to a per-column arena and addressed by offset;
+ *				the arena is compacted once more than half of it belongs
+ *				to overwritten or removed strings. A bitmap per column
+ *				records which cells are empty. Memory use is therefore
+ *				about 8 bytes per numeric cell, and 16 bytes plus the
+ *				text per string cell, with no per-cell allocations.
+ *
+ *				Rows are inserted, removed and moved in every column with
+ *				one \c memmove per contiguous run. Row and column lists
+ *				passed to the store must be sorted in ascending order
+ *				without duplicates.
+ *
+ *				The store is plain C so that it can be built and measured
+ *				away from AppKit. It is not thread-safe.
+ */
+typedef struct MBTableGridColumnStore MBTableGridColumnStore;
+
+/**
+ * @brief		Creates an empty store. Returns \c NULL if out of memory.
+ */
+MBTableGridColumnStore *MBTableGridColumnStoreCreate(void);
+
+/**
+ * @brief		Frees a store created with \c MBTableGridColumnStoreCreate.
+ */
+void MBTableGridColumnStoreDestroy(MBTableGridColumnStore *store);
+
+/**
+ * @brief		Returns the number of columns in the store.
+ */
+size_t MBTableGridColumnStoreColumnCount(const MBTableGridColumnStore *store);
+
+/**
+ * @brief		Returns the number of rows in the store.
+ */
+size_t MBTableGridColumnStoreRowCount(const MBTableGridColumnStore *store);
+
+/**
+ * @brief		Returns the type of a column.
+ */
+MBTableGridColumnType MBTableGridColumnStoreColumnType(const MBTableGridColumnStore *store, size_t column);
+
+/**
+ * @brief		Returns the number of bytes the store has allocated.
+ */
+size_t MBTableGridColumnStoreByteCount(const MBTableGridColumnStore *store);
+
+/**
+ * @brief		Inserts \c count columns of \c type before \c column,
+ *				with every cell empty.
+ *
+ * @return		\c false if out of memory, in which case the store is
+ *				unchanged.
+ */
+bool MBTableGridColumnStoreInsertColumns(MBTableGridColumnStore *store, size_t column, size_t count, MBTableGridColumnType type);
+
+/**
+ * @brief		Removes the listed columns.
+ */
+void MBTableGridColumnStoreRemoveColumns(MBTableGridColumnStore *store, const size_t *columns, size_t count);
+
+/**
+ * @brief		Moves the listed columns so that they are adjacent, in
+ *				the same order, starting at the position they are dropped
+ *				at before \c destination.
+ *
+ * @details		This follows the grid's drag and drop convention: if
+ *				\c destination is past the last listed column, the
+ *				columns end up just before it; if it falls among them,
+ *				they are gathered at the first listed column.
+ *
+ * @return		The new index of the first moved column, or \c (size_t)-1
+ *				if out of memory, in which case the store is unchanged.
+ */
+size_t MBTableGridColumnStoreMoveColumns(MBTableGridColumnStore *store, const size_t *columns, size_t count, size_t destination);
+
+/**
+ * @brief		Inserts \c count empty rows before \c row. Passing the row
+ *				count as \c row appends them.
+ *
+ * @return		\c false if out of memory, in which case the store is
+ *				unchanged.
+ */
+bool MBTableGridColumnStoreInsertRows(MBTableGridColumnStore *store, size_t row, size_t count);
+
+/**
+ * @brief		Removes the listed rows from every column.
+ */
+void MBTableGridColumnStoreRemoveRows(MBTableGridColumnStore *store, const size_t *rows, size_t count);
+
+/**
+ * @brief		Moves the listed rows, as \c MBTableGridColumnStoreMoveColumns
+ *				does for columns.
+ *
+ * @return		The new index of the first moved row, or \c (size_t)-1
+ *				if out of memory.
+ */
+size_t MBTableGridColumnStoreMoveRows(MBTableGridColumnStore *store, const size_t *rows, size_t count, size_t destination);
+
+/**
+ * @brief		Fills \c values with a block of cells, column by column:
+ *				the value for column <tt>column + i</tt> and row
+ *				<tt>row + j</tt> goes in <tt>values[i * rowCount + j]</tt>.
+ *
+ * @details		Empty cells are returned as zeroed values. Strings point
+ *				into the store, and remain valid until the store is next
+ *				changed.
+ */
+void MBTableGridColumnStoreGetValues(const MBTableGridColumnStore *store, MBTableGridValue *values,
+                                     size_t column, size_t columnCount, size_t row, size_t rowCount);
+
+/**
+ * @brief		Sets one cell, converting \c value to the column's type.
+ *
+ * @details		Empty and pending values clear the cell. Numbers are
+ *				accepted by numeric and date columns (integer columns only
+ *				take doubles with no fractional part), and any value is
+ *				accepted by string columns in its text form. Strings are
+ *				parsed by the other columns: decimal numbers, and dates in
+ *				ISO 8601 form (\c 2026-10-16, optionally followed by a
+ *				time such as \c T12:30:00Z). Strings are copied.
+ *
+ * @return		\c false if the value can't be converted or the store is
+ *				out of memory, in which case the cell is unchanged.
+ */
+bool MBTableGridColumnStoreSetValue(MBTableGridColumnStore *store, size_t column, size_t row, const MBTableGridValue *value);
+
+/**
+ * @brief		Sets a block of cells from \c values, laid out as for
+ *				\c MBTableGridColumnStoreGetValues.
+ *
+ * @details		The values may have been read from this same store,
+ *				strings included, even where the blocks overlap.
+ *
+ * @return		The number of cells that couldn't be set, which are left
+ *				unchanged.
+ */
+size_t MBTableGridColumnStoreSetValues(MBTableGridColumnStore *store, const MBTableGridValue *values,
+                                       size_t column, size_t columnCount, size_t row, size_t rowCount);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MBTableGridColumnStore_h */
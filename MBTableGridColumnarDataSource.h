@@ -0,0 +1,144 @@
+//
+//  MBTableGridColumnarDataSource.h
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#import <Cocoa/Cocoa.h>
+#import "MBTableGrid.h"
+#import "MBTableGridColumnStore.h"
+
+@class MBTableGridCell;
+
+/**
+ * @brief		\c MBTableGridColumnarDataSource is a ready-made data source
+ *				that keeps its values in an \c MBTableGridColumnStore.
+ *
+ * @details		Each column holds integers, doubles, dates or strings, so
+ *				a grid of millions of cells costs a few bytes per cell
+ *				rather than an object per cell. Values are handed to the
+ *				grid in bulk through \c tableGrid:getValues:forColumns:rows:,
+ *				and edits, pastes, row and column moves, and rows added or
+ *				removed by the grid are applied to the store directly.
+ *
+ *				Objects set on a cell are converted to the column's type:
+ *				\c NSNumber and \c NSDate values are stored as they are,
+ *				and strings are parsed. A value that can't be converted
+ *				leaves the cell unchanged.
+ */
+@interface MBTableGridColumnarDataSource : NSObject <MBTableGridDataSource>
+
+/**
+ * @brief		The underlying store, for loading or reading values in bulk.
+ *				Call \c reloadData on the grid after changing its shape.
+ */
+@property (nonatomic, readonly) MBTableGridColumnStore *store NS_RETURNS_INNER_POINTER;
+
+/**
+ * @brief		The cell used to display every value. Defaults to a text
+ *				cell.
+ */
+@property (nonatomic, strong) MBTableGridCell *cell;
+
+/**
+ * @brief		The number of columns and rows in the store.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfColumns;
+@property (nonatomic, readonly) NSUInteger numberOfRows;
+
+/**
+ * @brief		The number of bytes allocated for the store's values.
+ */
+@property (nonatomic, readonly) NSUInteger byteCount;
+
+/**
+ * @name		Columns
+ */
+
+/**
+ * @brief		Returns the type of values held by a column.
+ */
+- (MBTableGridColumnType)typeOfColumn:(NSUInteger)columnIndex;
+
+/**
+ * @brief		The header title of a column.
+ */
+- (NSString *)headerForColumn:(NSUInteger)columnIndex;
+- (void)setHeader:(NSString *)header forColumn:(NSUInteger)columnIndex;
+
+/**
+ * @brief		Inserts an empty column of \c type before \c columnIndex.
+ *
+ * @return		\c NO if out of memory.
+ */
+- (BOOL)insertColumnWithType:(MBTableGridColumnType)type header:(NSString *)header atIndex:(NSUInteger)columnIndex;
+
+/**
+ * @brief		Adds an empty column of \c type after the last column.
+ *
+ * @return		\c NO if out of memory.
+ */
+- (BOOL)addColumnWithType:(MBTableGridColumnType)type header:(NSString *)header;
+
+/**
+ * @brief		Removes the columns at \c columnIndexes.
+ */
+- (void)removeColumnsAtIndexes:(NSIndexSet *)columnIndexes;
+
+/**
+ * @name		Rows
+ */
+
+/**
+ * @brief		Inserts empty rows so that they occupy \c rowRange.
+ *
+ * @return		\c NO if out of memory.
+ */
+- (BOOL)insertRowsInRange:(NSRange)rowRange;
+
+/**
+ * @brief		Adds \c numberOfRows rows after the last row, filled from
+ *				\c values if it isn't \c NULL.
+ *
+ * @details		\c values holds \c numberOfRows values for each column in
+ *				turn, as for \c setValues:forColumns:rows:.
+ *
+ * @return		\c NO if out of memory.
+ */
+- (BOOL)appendRows:(NSUInteger)numberOfRows values:(const MBTableGridValue *)values;
+
+/**
+ * @brief		Removes the rows at \c rowIndexes.
+ */
+- (void)removeRowsAtIndexes:(NSIndexSet *)rowIndexes;
+
+/**
+ * @name		Values
+ */
+
+/**
+ * @brief		Returns the value of a cell as an \c NSNumber, \c NSDate or
+ *				\c NSString, or \c nil if the cell is empty.
+ */
+- (id)objectValueForColumn:(NSUInteger)columnIndex row:(NSUInteger)rowIndex;
+
+/**
+ * @brief		Sets the value of a cell, converting \c anObject to the
+ *				column's type. Setting \c nil empties the cell.
+ *
+ * @return		\c NO if the value can't be converted.
+ */
+- (BOOL)setObjectValue:(id)anObject forColumn:(NSUInteger)columnIndex row:(NSUInteger)rowIndex;
+
+/**
+ * @brief		Sets a block of cells from \c values, column by column: the
+ *				value for column <tt>columnRange.location + i</tt> and row
+ *				<tt>rowRange.location + j</tt> is
+ *				<tt>values[i * rowRange.length + j]</tt>.
+ *
+ * @return		The number of values that couldn't be converted.
+ */
+- (NSUInteger)setValues:(const MBTableGridValue *)values forColumns:(NSRange)columnRange rows:(NSRange)rowRange;
+
+@end
@@ -0,0 +1,266 @@
+//
+//  MBTableGridColumnarDataSource.m
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#import "MBTableGridColumnarDataSource.h"
+#import "MBTableGridCell.h"
+
+// Copies an index set into the sorted list the store expects. Returns NULL if empty.
+static size_t *MBCopyIndexes(NSIndexSet *indexes) {
+    if (indexes.count == 0)
+        return NULL;
+    size_t *list = malloc(indexes.count * sizeof(size_t));
+    if (list == NULL)
+        return NULL;
+    size_t count = 0;
+    for (NSUInteger index = indexes.firstIndex; index != NSNotFound; index = [indexes indexGreaterThanIndex:index])
+        list[count++] = index;
+    return list;
+}
+
+// Converts an object to a value the store can convert. String values borrow
+// the object's UTF-8 bytes, so they mustn't outlive it.
+static MBTableGridValue MBValueForObject(id anObject) {
+    if (anObject == nil || anObject == [NSNull null]) {
+        MBTableGridValue value = { MBTableGridValueTypeEmpty, { 0 } };
+        return value;
+    }
+    if ([anObject isKindOfClass:[NSNumber class]]) {
+        NSNumber *number = anObject;
+        if (CFGetTypeID((__bridge CFTypeRef)number) == CFBooleanGetTypeID())
+            return MBTableGridValueMakeBoolean(number.boolValue);
+        if (CFNumberIsFloatType((__bridge CFNumberRef)number))
+            return MBTableGridValueMakeDouble(number.doubleValue);
+        return MBTableGridValueMakeInteger(number.longLongValue);
+    }
+    if ([anObject isKindOfClass:[NSDate class]])
+        return MBTableGridValueMakeDate([anObject timeIntervalSince1970]);
+
+    NSString *string = [anObject isKindOfClass:[NSString class]] ? anObject : [anObject description];
+    const char *bytes = string.UTF8String;
+    return MBTableGridValueMakeString(bytes, bytes ? strlen(bytes) : 0);
+}
+
+@interface MBTableGridColumnarDataSource () {
+    MBTableGridColumnStore *_store;
+    NSMutableArray<NSString *> *_headers;
+}
+@end
+
+@implementation MBTableGridColumnarDataSource
+
+- (instancetype)init {
+    if (self = [super init]) {
+        _store = MBTableGridColumnStoreCreate();
+        if (_store == NULL)
+            return nil;
+        _headers = [NSMutableArray array];
+        _cell = [[MBTableGridCell alloc] initTextCell:@""];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    MBTableGridColumnStoreDestroy(_store);
+}
+
+- (MBTableGridColumnStore *)store {
+    return _store;
+}
+
+- (NSUInteger)numberOfColumns {
+    return MBTableGridColumnStoreColumnCount(_store);
+}
+
+- (NSUInteger)numberOfRows {
+    return MBTableGridColumnStoreRowCount(_store);
+}
+
+- (NSUInteger)byteCount {
+    return MBTableGridColumnStoreByteCount(_store);
+}
+
+#pragma mark - Columns
+
+- (MBTableGridColumnType)typeOfColumn:(NSUInteger)columnIndex {
+    return MBTableGridColumnStoreColumnType(_store, columnIndex);
+}
+
+- (NSString *)headerForColumn:(NSUInteger)columnIndex {
+    return _headers[columnIndex];
+}
+
+- (void)setHeader:(NSString *)header forColumn:(NSUInteger)columnIndex {
+    _headers[columnIndex] = [header copy] ?: @"";
+}
+
+- (BOOL)insertColumnWithType:(MBTableGridColumnType)type header:(NSString *)header atIndex:(NSUInteger)columnIndex {
+    if (!MBTableGridColumnStoreInsertColumns(_store, columnIndex, 1, type))
+        return NO;
+    [_headers insertObject:[header copy] ?: @"" atIndex:columnIndex];
+    return YES;
+}
+
+- (BOOL)addColumnWithType:(MBTableGridColumnType)type header:(NSString *)header {
+    return [self insertColumnWithType:type header:header atIndex:self.numberOfColumns];
+}
+
+- (void)removeColumnsAtIndexes:(NSIndexSet *)columnIndexes {
+    size_t *columns = MBCopyIndexes(columnIndexes);
+    if (columns == NULL)
+        return;
+    MBTableGridColumnStoreRemoveColumns(_store, columns, columnIndexes.count);
+    [_headers removeObjectsAtIndexes:columnIndexes];
+    free(columns);
+}
+
+#pragma mark - Rows
+
+- (BOOL)insertRowsInRange:(NSRange)rowRange {
+    return MBTableGridColumnStoreInsertRows(_store, rowRange.location, rowRange.length);
+}
+
+- (BOOL)appendRows:(NSUInteger)numberOfRows values:(const MBTableGridValue *)values {
+    NSUInteger firstRow = self.numberOfRows;
+    if (!MBTableGridColumnStoreInsertRows(_store, firstRow, numberOfRows))
+        return NO;
+    if (values && numberOfRows > 0)
+        MBTableGridColumnStoreSetValues(_store, values, 0, self.numberOfColumns, firstRow, numberOfRows);
+    return YES;
+}
+
+- (void)removeRowsAtIndexes:(NSIndexSet *)rowIndexes {
+    size_t *rows = MBCopyIndexes(rowIndexes);
+    if (rows == NULL)
+        return;
+    MBTableGridColumnStoreRemoveRows(_store, rows, rowIndexes.count);
+    free(rows);
+}
+
+#pragma mark - Values
+
+- (id)objectValueForColumn:(NSUInteger)columnIndex row:(NSUInteger)rowIndex {
+    MBTableGridValue value;
+    if (columnIndex >= self.numberOfColumns || rowIndex >= self.numberOfRows)
+        return nil;
+    MBTableGridColumnStoreGetValues(_store, &value, columnIndex, 1, rowIndex, 1);
+
+    switch (value.type) {
+        case MBTableGridValueTypeInteger:
+            return @(value.data.integer);
+        case MBTableGridValueTypeDouble:
+            return @(value.data.number);
+        case MBTableGridValueTypeDate:
+            return [NSDate dateWithTimeIntervalSince1970:value.data.number];
+        case MBTableGridValueTypeString:
+            return [[NSString alloc] initWithBytes:value.data.string.bytes length:value.data.string.length encoding:NSUTF8StringEncoding];
+        default:
+            return nil;
+    }
+}
+
+- (BOOL)setObjectValue:(id)anObject forColumn:(NSUInteger)columnIndex row:(NSUInteger)rowIndex {
+    MBTableGridValue value = MBValueForObject(anObject);
+    return MBTableGridColumnStoreSetValue(_store, columnIndex, rowIndex, &value);
+}
+
+- (NSUInteger)setValues:(const MBTableGridValue *)values forColumns:(NSRange)columnRange rows:(NSRange)rowRange {
+    return MBTableGridColumnStoreSetValues(_store, values, columnRange.location, columnRange.length,
+                                           rowRange.location, rowRange.length);
+}
+
+#pragma mark - MBTableGridDataSource
+
+- (NSUInteger)numberOfRowsInTableGrid:(MBTableGrid *)aTableGrid {
+    return self.numberOfRows;
+}
+
+- (NSUInteger)numberOfColumnsInTableGrid:(MBTableGrid *)aTableGrid {
+    return self.numberOfColumns;
+}
+
+- (id)tableGrid:(MBTableGrid *)aTableGrid objectValueForColumn:(NSUInteger)columnIndex row:(NSUInteger)rowIndex {
+    return [self objectValueForColumn:columnIndex row:rowIndex];
+}
+
+- (void)tableGrid:(MBTableGrid *)aTableGrid getValues:(MBTableGridValue *)values forColumns:(NSRange)columnRange rows:(NSRange)rowRange {
+    MBTableGridColumnStoreGetValues(_store, values, columnRange.location, columnRange.length,
+                                    rowRange.location, rowRange.length);
+}
+
+- (void)tableGrid:(MBTableGrid *)aTableGrid setValues:(const MBTableGridValue *)values forColumns:(NSRange)columnRange rows:(NSRange)rowRange {
+    [self setValues:values forColumns:columnRange rows:rowRange];
+}
+
+- (MBTableGridCell *)tableGrid:(MBTableGrid *)aTableGrid cellForColumn:(NSUInteger)columnIndex row:(NSUInteger)rowIndex {
+    self.cell.objectValue = [self objectValueForColumn:columnIndex row:rowIndex];
+    return self.cell;
+}
+
+- (void)tableGrid:(MBTableGrid *)aTableGrid setObjectValue:(id)anObject forColumn:(NSUInteger)columnIndex row:(NSUInteger)rowIndex {
+    [self setObjectValue:anObject forColumn:columnIndex row:rowIndex];
+}
+
+- (void)tableGrid:(MBTableGrid *)aTableGrid setObjectValue:(id)anObject forColumns:(NSIndexSet *)columnIndexes rows:(NSIndexSet *)rowIndexes {
+    MBTableGridValue value = MBValueForObject(anObject);
+    [columnIndexes enumerateIndexesUsingBlock:^(NSUInteger columnIndex, BOOL *stopColumns) {
+        [rowIndexes enumerateRangesUsingBlock:^(NSRange rowRange, BOOL *stopRows) {
+            for (NSUInteger rowIndex = rowRange.location; rowIndex < NSMaxRange(rowRange); rowIndex++)
+                MBTableGridColumnStoreSetValue(self->_store, columnIndex, rowIndex, &value);
+        }];
+    }];
+}
+
+- (NSString *)tableGrid:(MBTableGrid *)aTableGrid headerStringForColumn:(NSUInteger)columnIndex {
+    return [self headerForColumn:columnIndex];
+}
+
+- (BOOL)tableGrid:(MBTableGrid *)aTableGrid canMoveColumns:(NSIndexSet *)columnIndexes toIndex:(NSUInteger)index {
+    return YES;
+}
+
+- (BOOL)tableGrid:(MBTableGrid *)aTableGrid moveColumns:(NSIndexSet *)columnIndexes toIndex:(NSUInteger)index {
+    size_t *columns = MBCopyIndexes(columnIndexes);
+    if (columns == NULL)
+        return NO;
+    size_t location = MBTableGridColumnStoreMoveColumns(_store, columns, columnIndexes.count, index);
+    free(columns);
+    if (location == (size_t)-1)
+        return NO;
+
+    NSArray<NSString *> *headers = [_headers objectsAtIndexes:columnIndexes];
+    [_headers removeObjectsAtIndexes:columnIndexes];
+    [_headers insertObjects:headers atIndexes:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(location, headers.count)]];
+    return YES;
+}
+
+- (BOOL)tableGrid:(MBTableGrid *)aTableGrid canMoveRows:(NSIndexSet *)rowIndexes toIndex:(NSUInteger)index {
+    return YES;
+}
+
+- (BOOL)tableGrid:(MBTableGrid *)aTableGrid moveRows:(NSIndexSet *)rowIndexes toIndex:(NSUInteger)index {
+    size_t *rows = MBCopyIndexes(rowIndexes);
+    if (rows == NULL)
+        return NO;
+    size_t location = MBTableGridColumnStoreMoveRows(_store, rows, rowIndexes.count, index);
+    free(rows);
+    return location != (size_t)-1;
+}
+
+- (BOOL)tableGrid:(MBTableGrid *)aTableGrid addRows:(NSUInteger)numberOfRows {
+    if (![self appendRows:numberOfRows values:NULL])
+        return NO;
+    [aTableGrid reloadData];
+    return YES;
+}
+
+- (BOOL)tableGrid:(MBTableGrid *)aTableGrid removeRows:(NSIndexSet *)rowIndexes {
+    [self removeRowsAtIndexes:rowIndexes];
+    [aTableGrid reloadData];
+    return YES;
+}
+
+@end
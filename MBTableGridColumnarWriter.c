@@ -0,0 +1,260 @@
+//
+//  MBTableGridColumnarWriter.c
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#include "MBTableGridColumnarWriter.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define MBBufferMinimumCapacity 65536
+#define MBVarintCapacity 10
+
+static const char MBColumnarMagic[8] = { 'M', 'B', 'T', 'G', 'C', 'O', 'L', 0x01 };
+
+struct MBTableGridColumnarWriter {
+    MBTableGridDelimitedWriterOutput output;
+    void *context;
+    size_t columnCount;
+    uint64_t rowCount;
+    uint64_t bytesWritten;
+    bool failed;
+    bool finished;
+
+    /* What will be handed to the output, and the chunk being encoded */
+    unsigned char *buffer;
+    size_t length;
+    size_t capacity;
+    unsigned char *chunk;
+    size_t chunkLength;
+    size_t chunkCapacity;
+};
+
+static bool MBReserve(unsigned char **bytes, size_t length, size_t *capacity, size_t needed) {
+    if (*capacity - length >= needed)
+        return true;
+    size_t newCapacity = *capacity ? *capacity : MBBufferMinimumCapacity;
+    while (newCapacity - length < needed)
+        newCapacity *= 2;
+    unsigned char *newBytes = realloc(*bytes, newCapacity);
+    if (newBytes == NULL)
+        return false;
+    *bytes = newBytes;
+    *capacity = newCapacity;
+    return true;
+}
+
+// Returns the number of bytes written at bytes, which has room for MBVarintCapacity
+static size_t MBPutVarint(unsigned char *bytes, uint64_t number) {
+    size_t length = 0;
+    while (number >= 0x80) {
+        bytes[length++] = (unsigned char)(number | 0x80);
+        number >>= 7;
+    }
+    bytes[length++] = (unsigned char)number;
+    return length;
+}
+
+static inline uint64_t MBZigzag(int64_t number) {
+    return ((uint64_t)number << 1) ^ (uint64_t)(number >> 63);
+}
+
+static void MBPutDouble(unsigned char *bytes, double number) {
+    uint64_t bits;
+    memcpy(&bits, &number, sizeof(bits));
+    for (int i = 0; i < 8; i++)
+        bytes[i] = (unsigned char)(bits >> (8 * i));
+}
+
+static bool MBAppendChunk(MBTableGridColumnarWriter *writer, const void *bytes, size_t length) {
+    if (!MBReserve(&writer->chunk, writer->chunkLength, &writer->chunkCapacity, length))
+        return false;
+    memcpy(writer->chunk + writer->chunkLength, bytes, length);
+    writer->chunkLength += length;
+    return true;
+}
+
+static bool MBAppendBuffer(MBTableGridColumnarWriter *writer, const void *bytes, size_t length) {
+    if (!MBReserve(&writer->buffer, writer->length, &writer->capacity, length))
+        return false;
+    memcpy(writer->buffer + writer->length, bytes, length);
+    writer->length += length;
+    return true;
+}
+
+static bool MBAppendBufferVarint(MBTableGridColumnarWriter *writer, uint64_t number) {
+    unsigned char bytes[MBVarintCapacity];
+    return MBAppendBuffer(writer, bytes, MBPutVarint(bytes, number));
+}
+
+static inline bool MBIsEmpty(const MBTableGridValue *value) {
+    return value->type == MBTableGridValueTypeEmpty || value->type == MBTableGridValueTypePending;
+}
+
+// Appends a value of a mixed chunk, or of a chunk of its type if typed; previous
+// holds the last integer written, for deltas
+static bool MBEncodeValue(MBTableGridColumnarWriter *writer, const MBTableGridValue *value, bool typed, int64_t *previous) {
+    unsigned char bytes[1 + MBVarintCapacity + 8];
+    size_t length = 0;
+    if (!typed)
+        bytes[length++] = (unsigned char)value->type;
+
+    switch (value->type) {
+        case MBTableGridValueTypeInteger:
+            if (typed) {
+                length += MBPutVarint(bytes + length, MBZigzag((int64_t)((uint64_t)value->data.integer - (uint64_t)*previous)));
+                *previous = value->data.integer;
+            } else {
+                length += MBPutVarint(bytes + length, MBZigzag(value->data.integer));
+            }
+            break;
+        case MBTableGridValueTypeDouble:
+        case MBTableGridValueTypeDate:
+            MBPutDouble(bytes + length, value->data.number);
+            length += 8;
+            break;
+        case MBTableGridValueTypeBoolean:
+            bytes[length++] = value->data.boolean ? 1 : 0;
+            break;
+        case MBTableGridValueTypeString:
+            length += MBPutVarint(bytes + length, value->data.string.length);
+            return MBAppendChunk(writer, bytes, length) &&
+                   MBAppendChunk(writer, value->data.string.bytes, value->data.string.length);
+        default:
+            break;
+    }
+    return MBAppendChunk(writer, bytes, length);
+}
+
+// Encodes one column of a row group into the chunk buffer, then appends it with its header
+static bool MBWriteColumn(MBTableGridColumnarWriter *writer, const MBTableGridValue *values, size_t rowCount) {
+    int type = MBTableGridValueTypeEmpty;
+    bool hasEmpty = false;
+    for (size_t i = 0; i < rowCount; i++) {
+        if (MBIsEmpty(&values[i]))
+            hasEmpty = true;
+        else if (type == MBTableGridValueTypeEmpty)
+            type = values[i].type;
+        else if (type != (int)values[i].type)
+            type = MBTableGridColumnarMixedType;
+    }
+
+    writer->chunkLength = 0;
+    if (hasEmpty) {
+        size_t bitmapLength = (rowCount + 7) / 8;
+        if (!MBReserve(&writer->chunk, 0, &writer->chunkCapacity, bitmapLength))
+            return false;
+        memset(writer->chunk, 0, bitmapLength);
+        for (size_t i = 0; i < rowCount; i++) {
+            if (!MBIsEmpty(&values[i]))
+                writer->chunk[i / 8] |= (unsigned char)(1 << (i % 8));
+        }
+        writer->chunkLength = bitmapLength;
+    }
+
+    if (type == MBTableGridValueTypeBoolean) {
+        // Packed eight to a byte
+        unsigned char bits = 0;
+        size_t count = 0;
+        for (size_t i = 0; i < rowCount; i++) {
+            if (MBIsEmpty(&values[i]))
+                continue;
+            if (values[i].data.boolean)
+                bits |= (unsigned char)(1 << (count % 8));
+            if (++count % 8 == 0) {
+                if (!MBAppendChunk(writer, &bits, 1))
+                    return false;
+                bits = 0;
+            }
+        }
+        if (count % 8 && !MBAppendChunk(writer, &bits, 1))
+            return false;
+    } else if (type != MBTableGridValueTypeEmpty) {
+        int64_t previous = 0;
+        bool typed = (type != MBTableGridColumnarMixedType);
+        for (size_t i = 0; i < rowCount; i++) {
+            if (!MBIsEmpty(&values[i]) && !MBEncodeValue(writer, &values[i], typed, &previous))
+                return false;
+        }
+    }
+
+    unsigned char header[2 + MBVarintCapacity] = { (unsigned char)type, hasEmpty ? 1 : 0 };
+    size_t headerLength = 2 + MBPutVarint(header + 2, writer->chunkLength);
+    return MBAppendBuffer(writer, header, headerLength) && MBAppendBuffer(writer, writer->chunk, writer->chunkLength);
+}
+
+static bool MBFlush(MBTableGridColumnarWriter *writer) {
+    if (writer->length) {
+        if (!writer->output(writer->context, (const char *)writer->buffer, writer->length)) {
+            writer->failed = true;
+            return false;
+        }
+        writer->bytesWritten += writer->length;
+        writer->length = 0;
+    }
+    return true;
+}
+
+MBTableGridColumnarWriter *MBTableGridColumnarWriterCreate(size_t columnCount, const char *const *names, const size_t *nameLengths,
+                                                           MBTableGridDelimitedWriterOutput output, void *context) {
+    MBTableGridColumnarWriter *writer = calloc(1, sizeof(MBTableGridColumnarWriter));
+    if (writer == NULL)
+        return NULL;
+    writer->output = output;
+    writer->context = context;
+    writer->columnCount = columnCount;
+
+    bool succeeded = MBAppendBuffer(writer, MBColumnarMagic, sizeof(MBColumnarMagic)) && MBAppendBufferVarint(writer, columnCount);
+    for (size_t j = 0; j < columnCount && succeeded; j++) {
+        size_t length = names ? nameLengths[j] : 0;
+        succeeded = MBAppendBufferVarint(writer, length) && (length == 0 || MBAppendBuffer(writer, names[j], length));
+    }
+    if (!succeeded) {
+        MBTableGridColumnarWriterDestroy(writer);
+        return NULL;
+    }
+    return writer;
+}
+
+void MBTableGridColumnarWriterDestroy(MBTableGridColumnarWriter *writer) {
+    if (writer == NULL)
+        return;
+    free(writer->buffer);
+    free(writer->chunk);
+    free(writer);
+}
+
+bool MBTableGridColumnarWriterWriteValues(MBTableGridColumnarWriter *writer, const MBTableGridValue *values, size_t rowCount) {
+    if (writer->failed || writer->finished)
+        return false;
+    if (rowCount == 0)
+        return true;
+
+    bool succeeded = MBAppendBufferVarint(writer, rowCount);
+    for (size_t j = 0; j < writer->columnCount && succeeded; j++)
+        succeeded = MBWriteColumn(writer, values + j * rowCount, rowCount);
+    if (!succeeded) {
+        writer->failed = true;
+        return false;
+    }
+    writer->rowCount += rowCount;
+    return MBFlush(writer);
+}
+
+bool MBTableGridColumnarWriterFinish(MBTableGridColumnarWriter *writer) {
+    if (writer->failed || writer->finished)
+        return false;
+    writer->finished = true;
+    if (!MBAppendBufferVarint(writer, 0) || !MBAppendBufferVarint(writer, writer->rowCount)) {
+        writer->failed = true;
+        return false;
+    }
+    return MBFlush(writer);
+}
+
+uint64_t MBTableGridColumnarWriterBytesWritten(const MBTableGridColumnarWriter *writer) {
+    return writer->bytesWritten;
+}
@@ -0,0 +1,111 @@
+//
+//  MBTableGridColumnarWriter.h
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#ifndef MBTableGridColumnarWriter_h
+#define MBTableGridColumnarWriter_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "MBTableGridValue.h"
+#include "MBTableGridDelimitedWriter.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief		\c MBTableGridColumnarWriter writes cells in a compact
+ *				binary format that keeps each column's values together,
+ *				a group of rows at a time, so that it can be written as
+ *				the cells are fetched.
+ *
+ * @details		All integers are unsigned LEB128 varints unless noted. A
+ *				file is:
+ *
+ *				- the eight bytes \c "MBTGCOL" and \c 0x01;
+ *				- the column count, and each column's name as a byte count
+ *				  and UTF-8 bytes;
+ *				- row groups, each a row count other than zero followed by
+ *				  a chunk for each column;
+ *				- a zero, and the total row count.
+ *
+ *				A chunk is a type byte, a flags byte, the byte count of
+ *				the rest of the chunk, and then:
+ *
+ *				- if flag bit 0 is set, because some cells are empty, a
+ *				  bitmap with a bit for each row, low bit first, set for
+ *				  each cell that isn't;
+ *				- the value of each cell that isn't empty.
+ *
+ *				The type byte is the \c MBTableGridValueType of every value
+ *				in the chunk, \c MBTableGridValueTypeEmpty if there are
+ *				none, or \c 0xFF if they are mixed. Integers are written as
+ *				zigzag varints of the difference from the previous one;
+ *				doubles and dates as 8-byte little-endian IEEE 754;
+ *				Booleans as a bitmap; and strings as a byte count and UTF-8
+ *				bytes. In a mixed chunk each value is preceded by its type
+ *				byte, and integers are zigzag varints and Booleans bytes.
+ *				Pending values are written as empty.
+ *
+ *				The writer is plain C so that it can be built and measured
+ *				away from AppKit. It is not thread-safe, but needn't be used
+ *				on the thread that created it.
+ */
+typedef struct MBTableGridColumnarWriter MBTableGridColumnarWriter;
+
+#define MBTableGridColumnarMixedType 0xFF
+
+/**
+ * @brief		Creates a writer and buffers the file header. Returns
+ *				\c NULL if out of memory.
+ *
+ * @param		columnCount		The number of columns in every row group.
+ * @param		names			The UTF-8 name of each column, or \c NULL
+ *								for no names.
+ * @param		nameLengths		The byte count of each name.
+ * @param		output			Called with each buffer of bytes.
+ * @param		context			Passed to \c output.
+ */
+MBTableGridColumnarWriter *MBTableGridColumnarWriterCreate(size_t columnCount, const char *const *names, const size_t *nameLengths,
+                                                           MBTableGridDelimitedWriterOutput output, void *context);
+
+/**
+ * @brief		Frees a writer created with \c MBTableGridColumnarWriterCreate,
+ *				discarding anything not yet written.
+ */
+void MBTableGridColumnarWriterDestroy(MBTableGridColumnarWriter *writer);
+
+/**
+ * @brief		Writes a row group of \c rowCount rows, and hands it to the
+ *				output function with anything buffered before it.
+ *
+ * @details		The values are in column-first order, as the grid fetches
+ *				them: the value for column \c j of row \c i is at
+ *				\c values[j * rowCount + i].
+ *
+ * @return		\c false if out of memory or the output function has
+ *				failed, now or before.
+ */
+bool MBTableGridColumnarWriterWriteValues(MBTableGridColumnarWriter *writer, const MBTableGridValue *values, size_t rowCount);
+
+/**
+ * @brief		Writes the end of the file. Nothing more may be written.
+ */
+bool MBTableGridColumnarWriterFinish(MBTableGridColumnarWriter *writer);
+
+/**
+ * @brief		Returns the number of bytes handed to the output function.
+ */
+uint64_t MBTableGridColumnarWriterBytesWritten(const MBTableGridColumnarWriter *writer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MBTableGridColumnarWriter_h */
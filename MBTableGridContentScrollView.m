@@ -6,6 +6,11 @@
 //
 
 #import "MBTableGridContentScrollView.h"
+#import "MBTableGrid.h"
+
+@interface MBTableGrid (Private)
+- (void)_findBarVisibilityDidChange;
+@end
 
 @implementation MBTableGridContentScrollView
 
@@ -28,6 +33,11 @@
     if (findBarVisible) {
         [[self class] huntDownAndHideSearchFieldMenuItemsInView:self.findBarView];
     }
+    
+    // Let searches running off the main thread know whether to keep going
+    if ([self.superview isKindOfClass:[MBTableGrid class]]) {
+        [(MBTableGrid *)self.superview _findBarVisibilityDidChange];
+    }
 }
 
 @end
@@ -32,7 +32,7 @@ typedef NS_ENUM(NSUInteger, MBTableGridTrackingPart)
     MBTableGridTrackingPartFillBottom
 };
 
-@class MBTableGrid, MBTableGridCell;
+@class MBTableGrid, MBTableGridCell, MBTableGridTileCache;
 
 /**
  * @brief		\c MBTableGridContentView provides the actual display
@@ -65,14 +65,34 @@ typedef NS_ENUM(NSUInteger, MBTableGridTrackingPart)
     MBTableGridTrackingPart shouldDrawFillPart;
 	
 	MBTableGridCell *_defaultCell;
+	MBTableGridTileCache *_tileCache;
 }
 
 - (instancetype)initWithFrame:(NSRect)frameRect andTableGrid:(MBTableGrid*)tableGrid;
 
+/**
+ * @brief		The height of each row, or of rows for which the data
+ *				source reports no height of their own. Setting it resizes
+ *				the grid and redraws the rows.
+ * @see			tableGrid:heightForRow:
+ */
 @property (nonatomic, assign) CGFloat rowHeight;
 
 @property (nonatomic, assign) BOOL showsGrabHandle;
 
+/**
+ * @brief		Whether cell borders and interiors are drawn from a cache
+ *				of rendered tiles. Defaults to \c YES.
+ *
+ * @details		When enabled, cells are rendered in fixed blocks and the
+ *				bitmaps reused until the block is invalidated, so scrolling
+ *				and selection changes only composite existing tiles. The
+ *				selection, grab handle and drop indicators are always drawn
+ *				on top of the tiles.
+ * @see			invalidateCachedTilesInRect:
+ */
+@property (nonatomic, assign) BOOL cachesRenderedTiles;
+
 /**
  * @name		The Grid View
  */
@@ -106,6 +126,53 @@ typedef NS_ENUM(NSUInteger, MBTableGridTrackingPart)
  */
 - (__kindof MBTableGridCell *)editSelectedCell:(id)sender text:(NSString *)aString;
 
+/**
+ * @}
+ */
+
+/**
+ * @name		Rendered Tiles
+ */
+/**
+ * @{
+ */
+
+/**
+ * @brief		Discards the cached tiles of any cells intersecting
+ *				\c rect and marks them as needing display. Call this
+ *				when the values in those cells change.
+ * @param		rect		A rectangle in the receiver's coordinate system.
+ * @see			invalidateAllCachedTiles
+ */
+- (void)invalidateCachedTilesInRect:(NSRect)rect;
+
+/**
+ * @brief		Discards the cached tiles of the given columns and marks
+ *				them, and the columns to their right, as needing display.
+ *				Call this when the widths of those columns change; tiles
+ *				of other columns are kept.
+ * @param		columnRange		The columns whose widths changed.
+ * @see			invalidateCachedTilesInRows:
+ */
+- (void)invalidateCachedTilesInColumns:(NSRange)columnRange;
+
+/**
+ * @brief		Discards the cached tiles of the given rows and marks
+ *				them, and the rows below them, as needing display. Call
+ *				this when the heights of those rows change; tiles of
+ *				other rows are kept.
+ * @param		rowRange		The rows whose heights changed.
+ * @see			invalidateCachedTilesInColumns:
+ */
+- (void)invalidateCachedTilesInRows:(NSRange)rowRange;
+
+/**
+ * @brief		Discards every cached tile and marks the receiver as
+ *				needing display.
+ * @see			invalidateCachedTilesInRect:
+ */
+- (void)invalidateAllCachedTiles;
+
 /**
  * @}
  */
@@ -28,6 +28,8 @@
 #import "MBTableGrid.h"
 #import "MBTableGridCell.h"
 #import "MBTableGridEditable.h"
+#import "MBTableGridGeometry.h"
+#import "MBTableGridTileCache.h"
 #import "NSScrollView+InsetRectangles.h"
 
 #define kGRAB_HANDLE_HALF_SIDE_LENGTH 3.0f
@@ -48,11 +50,20 @@ NSString * const MBTableGridTrackingPartKey = @"part";
 - (void)_setObjectValue:(id)value forColumn:(NSUInteger)columnIndex row:(NSUInteger)rowIndex;
 - (void)_setObjectValue:(id)value forColumns:(NSIndexSet *)columnIndexes rows:(NSIndexSet *)rowIndexes;
 - (BOOL)_canEditCellAtColumn:(NSUInteger)columnIndex row:(NSUInteger)rowIndex;
+- (NSIndexSet *)_dataSourceRowIndexesForRowIndexes:(NSIndexSet *)rowIndexes;
 - (void)_setStickyColumn:(MBHorizontalEdge)stickyColumn row:(MBVerticalEdge)stickyRow;
 - (CGFloat)_widthForColumn:(NSUInteger)columnIndex;
+- (MBTableGridAxis)_columnAxis;
+- (MBTableGridAxis)_rowAxis;
 - (void)_didDoubleClickColumn:(NSUInteger)columnIndex row:(NSUInteger)rowIndex;
 - (NSRange)_rangeOfRowsIntersectingRect:(NSRect)rect;
 - (NSRange)_rangeOfColumnsIntersectingRect:(NSRect)rect;
+- (BOOL)_providesObjectValuesInBulk;
+- (BOOL)_providesTypedValues;
+- (void)_enumerateValuesInColumns:(NSRange)columnRange rows:(NSRange)rowRange usingBlock:(void (^)(NSUInteger columnIndex, NSUInteger rowIndex, const MBTableGridValue *value, BOOL *stop))block;
+- (id)_objectForValue:(const MBTableGridValue *)value;
+- (void)_enumerateObjectValuesInColumns:(NSRange)columnRange rows:(NSRange)rowRange usingBlock:(void (^)(NSUInteger columnIndex, NSUInteger rowIndex, id value, BOOL *stop))block;
+- (void)_noteDefaultRowHeightChanged;
 @end
 
 @interface MBTableGridContentView (Cursors)
@@ -107,6 +118,9 @@ NSString * const MBTableGridTrackingPartKey = @"part";
 
 		_rowHeight = 20.0;
 		
+		_tileCache = [[MBTableGridTileCache alloc] init];
+		_cachesRenderedTiles = YES;
+		
 		_defaultCell = [[MBTableGridCell alloc] initTextCell:@""];
         _defaultCell.bordered = YES;
         _defaultCell.scrollable = YES;
@@ -119,18 +133,62 @@ NSString * const MBTableGridTrackingPartKey = @"part";
 	[NSNotificationCenter.defaultCenter removeObserver:self];
 }
 
-- (void)enumerateCellsInRect:(NSRect)rect usingBlock:(void (^)(MBTableGridCell *cell, NSRect cellFrame))block {
-    NSRange columnRange = [_tableGrid _rangeOfColumnsIntersectingRect:[self convertRect:rect toView:_tableGrid]];
-    NSRange rowRange = [_tableGrid _rangeOfRowsIntersectingRect:[self convertRect:rect toView:_tableGrid]];
+- (void)setRowHeight:(CGFloat)rowHeight {
+	if (rowHeight == _rowHeight)
+		return;
+	_rowHeight = rowHeight;
+	
+	// Cached tiles were drawn at the old height, and rows after the first have moved
+	[self invalidateAllCachedTiles];
+	[_tableGrid _noteDefaultRowHeightChanged];
+}
+
+// Cells whose values are still loading are passed to the block as nil
+- (void)enumerateCellsInColumns:(NSRange)columnRange rows:(NSRange)rowRange onlyDirty:(BOOL)onlyDirty usingBlock:(void (^)(MBTableGridCell *cell, NSRect cellFrame))block {
+    if ([_tableGrid _providesTypedValues]) {
+        [_tableGrid _enumerateValuesInColumns:columnRange rows:rowRange usingBlock:^(NSUInteger column, NSUInteger row, const MBTableGridValue *value, BOOL *stop) {
+            NSRect cellFrame = [self frameOfCellAtColumn:column row:row];
+            if ((!onlyDirty || [self needsToDrawRect:cellFrame]) && (!(row == self->editedRow && column == self->editedColumn))) {
+                if (value->type == MBTableGridValueTypePending) {
+                    block(nil, cellFrame);
+                    return;
+                }
+                MBTableGridCell *cell = [self->_tableGrid _cellForColumn:column row:row];
+                cell.objectValue = [self->_tableGrid _objectForValue:value];
+                block(cell, cellFrame);
+                // Strings borrow the data source's bytes, so don't leave them in the cell
+                cell.objectValue = nil;
+            }
+        }];
+        return;
+    }
+    
+    if ([_tableGrid _providesObjectValuesInBulk]) {
+        // Fetch the values for the whole block at once, and only ask for the cells to draw them with
+        [_tableGrid _enumerateObjectValuesInColumns:columnRange rows:rowRange usingBlock:^(NSUInteger column, NSUInteger row, id value, BOOL *stop) {
+            NSRect cellFrame = [self frameOfCellAtColumn:column row:row];
+            if ((!onlyDirty || [self needsToDrawRect:cellFrame]) && (!(row == self->editedRow && column == self->editedColumn))) {
+                if (value == MBTableGridPendingValue) {
+                    block(nil, cellFrame);
+                    return;
+                }
+                MBTableGridCell *cell = [self->_tableGrid _cellForColumn:column row:row];
+                cell.objectValue = value;
+                block(cell, cellFrame);
+            }
+        }];
+        return;
+    }
     
     NSUInteger column = columnRange.location;
     while (column != NSNotFound && column < NSMaxRange(columnRange)) {
         NSUInteger row = rowRange.location;
         while (row != NSNotFound && row < NSMaxRange(rowRange)) {
             NSRect cellFrame = [self frameOfCellAtColumn:column row:row];
-            if ([self needsToDrawRect:cellFrame] && (!(row == editedRow && column == editedColumn))) {
+            if ((!onlyDirty || [self needsToDrawRect:cellFrame]) && (!(row == editedRow && column == editedColumn))) {
                 // Only fetch the cell if we need to
-                block([_tableGrid _cellForColumn:column row: row], cellFrame);
+                MBTableGridCell *cell = [_tableGrid _cellForColumn:column row: row];
+                block(cell.objectValue == MBTableGridPendingValue ? nil : cell, cellFrame);
             }
             row++;
         }
@@ -138,18 +196,188 @@ NSString * const MBTableGridTrackingPartKey = @"part";
     }
 }
 
+- (void)enumerateCellsInRect:(NSRect)rect usingBlock:(void (^)(MBTableGridCell *cell, NSRect cellFrame))block {
+    NSRange columnRange = [_tableGrid _rangeOfColumnsIntersectingRect:[self convertRect:rect toView:_tableGrid]];
+    NSRange rowRange = [_tableGrid _rangeOfRowsIntersectingRect:[self convertRect:rect toView:_tableGrid]];
+    
+    [self enumerateCellsInColumns:columnRange rows:rowRange onlyDirty:YES usingBlock:block];
+}
+
 - (void)drawCellBordersInRect:(NSRect)rect {
     [self enumerateCellsInRect:rect usingBlock:^(MBTableGridCell *cell, NSRect cellFrame) {
-        [cell drawBorderWithFrame:cellFrame inView:self];
+        [(cell ?: self->_defaultCell) drawBorderWithFrame:cellFrame inView:self];
     }];
 }
 
 - (void)drawCellInteriorsInRect:(NSRect)rect {
     [self enumerateCellsInRect:rect usingBlock:^(MBTableGridCell *cell, NSRect cellFrame) {
-        [cell drawInteriorWithFrame:cellFrame inView:self];
+        if (cell) {
+            [cell drawInteriorWithFrame:cellFrame inView:self];
+        } else {
+            [self drawPlaceholderWithFrame:cellFrame];
+        }
     }];
 }
 
+- (void)drawPlaceholderWithFrame:(NSRect)cellFrame {
+    // A short bar where the text will go
+    NSRect barRect = NSInsetRect(cellFrame, 6.0, 0.0);
+    barRect.size.width = MIN(NSWidth(barRect), MAX(NSWidth(barRect) * 0.6, 12.0));
+    barRect.size.height = MIN(NSHeight(cellFrame) - 4.0, 8.0);
+    barRect.origin.y = NSMidY(cellFrame) - NSHeight(barRect) / 2.0;
+    if (NSWidth(barRect) <= 0.0 || NSHeight(barRect) <= 0.0)
+        return;
+    
+    [[NSColor.tertiaryLabelColor colorWithAlphaComponent:0.3] set];
+    [[NSBezierPath bezierPathWithRoundedRect:barRect xRadius:NSHeight(barRect) / 2.0 yRadius:NSHeight(barRect) / 2.0] fill];
+}
+
+#pragma mark Rendered Tiles
+
+- (NSRange)_tileRangeForRange:(NSRange)range tileLength:(NSUInteger)tileLength {
+    if (range.location == NSNotFound || range.length == 0)
+        return NSMakeRange(NSNotFound, 0);
+    NSUInteger first = range.location / tileLength;
+    NSUInteger last = (NSMaxRange(range) - 1) / tileLength;
+    return NSMakeRange(first, last - first + 1);
+}
+
+- (NSRange)_rangeForTile:(NSUInteger)tile tileLength:(NSUInteger)tileLength count:(NSUInteger)count {
+    NSUInteger location = tile * tileLength;
+    return NSMakeRange(location, MIN(tileLength, count - location));
+}
+
+- (CGImageRef)_newImageForTileWithColumns:(NSRange)columnRange rows:(NSRange)rowRange frame:(NSRect)tileFrame scale:(CGFloat)scale CF_RETURNS_RETAINED {
+    size_t pixelsWide = (size_t)ceil(NSWidth(tileFrame) * scale);
+    size_t pixelsHigh = (size_t)ceil(NSHeight(tileFrame) * scale);
+    if (pixelsWide == 0 || pixelsHigh == 0)
+        return NULL;
+    
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateWithName(kCGColorSpaceSRGB);
+    CGContextRef bitmap = CGBitmapContextCreate(NULL, pixelsWide, pixelsHigh, 8, 0, colorSpace,
+                                                kCGImageAlphaPremultipliedFirst | kCGBitmapByteOrder32Host);
+    CGColorSpaceRelease(colorSpace);
+    if (bitmap == NULL)
+        return NULL;
+    
+    // Draw in the receiver's flipped coordinates, with the tile's origin at the top left
+    CGContextScaleCTM(bitmap, scale, scale);
+    CGContextTranslateCTM(bitmap, 0.0, NSHeight(tileFrame));
+    CGContextScaleCTM(bitmap, 1.0, -1.0);
+    CGContextTranslateCTM(bitmap, -NSMinX(tileFrame), -NSMinY(tileFrame));
+    
+    [NSGraphicsContext saveGraphicsState];
+    NSGraphicsContext.currentContext = [NSGraphicsContext graphicsContextWithCGContext:bitmap flipped:YES];
+    [self enumerateCellsInColumns:columnRange rows:rowRange onlyDirty:NO usingBlock:^(MBTableGridCell *cell, NSRect cellFrame) {
+        [(cell ?: self->_defaultCell) drawBorderWithFrame:cellFrame inView:self];
+        if (cell) {
+            [cell drawInteriorWithFrame:cellFrame inView:self];
+        } else {
+            [self drawPlaceholderWithFrame:cellFrame];
+        }
+    }];
+    [NSGraphicsContext restoreGraphicsState];
+    
+    CGImageRef image = CGBitmapContextCreateImage(bitmap);
+    CGContextRelease(bitmap);
+    return image;
+}
+
+- (void)drawCachedTilesInRect:(NSRect)rect {
+    NSUInteger numberOfColumns = _tableGrid.numberOfColumns;
+    NSUInteger numberOfRows = _tableGrid.numberOfRows;
+    NSRange columnRange = [_tableGrid _rangeOfColumnsIntersectingRect:[self convertRect:rect toView:_tableGrid]];
+    NSRange rowRange = [_tableGrid _rangeOfRowsIntersectingRect:[self convertRect:rect toView:_tableGrid]];
+    NSRange tileColumns = [self _tileRangeForRange:columnRange tileLength:MBTableGridTileColumns];
+    NSRange tileRows = [self _tileRangeForRange:rowRange tileLength:MBTableGridTileRows];
+    if (tileColumns.location == NSNotFound || tileRows.location == NSNotFound)
+        return;
+    
+    CGFloat scale = [self convertSizeToBacking:NSMakeSize(1.0, 1.0)].width;
+    
+    for (NSUInteger tileColumn = tileColumns.location; tileColumn < NSMaxRange(tileColumns); tileColumn++) {
+        NSRange columns = [self _rangeForTile:tileColumn tileLength:MBTableGridTileColumns count:numberOfColumns];
+        for (NSUInteger tileRow = tileRows.location; tileRow < NSMaxRange(tileRows); tileRow++) {
+            NSRange rows = [self _rangeForTile:tileRow tileLength:MBTableGridTileRows count:numberOfRows];
+            NSRect tileFrame = NSUnionRect([self frameOfCellAtColumn:columns.location row:rows.location],
+                                           [self frameOfCellAtColumn:NSMaxRange(columns) - 1 row:NSMaxRange(rows) - 1]);
+            if (![self needsToDrawRect:tileFrame])
+                continue;
+            
+            // Tiles remember their cells and size, so a tile that only moved is drawn again in its new place
+            CGImageRef image = [_tileCache imageForTileWithColumns:columns rows:rows size:tileFrame.size scale:scale];
+            if (image == NULL) {
+                CGImageRef rendered = [self _newImageForTileWithColumns:columns rows:rows frame:tileFrame scale:scale];
+                if (rendered == NULL)
+                    continue;
+                [_tileCache setImage:rendered forTileWithColumns:columns rows:rows size:tileFrame.size scale:scale];
+                CGImageRelease(rendered);
+                image = [_tileCache imageForTileWithColumns:columns rows:rows size:tileFrame.size scale:scale];
+                if (image == NULL)
+                    continue;
+            }
+            
+            NSImage *tileImage = [[NSImage alloc] initWithCGImage:image size:tileFrame.size];
+            [tileImage drawInRect:tileFrame fromRect:NSZeroRect operation:NSCompositingOperationSourceOver
+                         fraction:1.0 respectFlipped:YES hints:nil];
+        }
+    }
+}
+
+- (void)invalidateCachedTilesInRect:(NSRect)rect {
+    NSRange columnRange = [_tableGrid _rangeOfColumnsIntersectingRect:[self convertRect:rect toView:_tableGrid]];
+    NSRange rowRange = [_tableGrid _rangeOfRowsIntersectingRect:[self convertRect:rect toView:_tableGrid]];
+    [_tileCache removeTilesInColumns:[self _tileRangeForRange:columnRange tileLength:MBTableGridTileColumns]
+                                rows:[self _tileRangeForRange:rowRange tileLength:MBTableGridTileRows]];
+    [self setNeedsDisplayInRect:rect];
+}
+
+- (void)invalidateCachedTilesInColumns:(NSRange)columnRange {
+    NSUInteger numberOfRows = _tableGrid.numberOfRows;
+    NSRange tileColumns = [self _tileRangeForRange:columnRange tileLength:MBTableGridTileColumns];
+    NSRange tileRows = [self _tileRangeForRange:NSMakeRange(0, numberOfRows) tileLength:MBTableGridTileRows];
+    [_tileCache removeTilesInColumns:tileColumns rows:tileRows];
+    
+    // Columns to the right have moved, though their tiles are still good
+    NSRect dirtyRect = [self rectOfColumn:columnRange.location];
+    dirtyRect.size.width = NSWidth(self.bounds) - NSMinX(dirtyRect);
+    [self setNeedsDisplayInRect:dirtyRect];
+}
+
+- (void)invalidateCachedTilesInRows:(NSRange)rowRange {
+    NSUInteger numberOfColumns = _tableGrid.numberOfColumns;
+    NSRange tileColumns = [self _tileRangeForRange:NSMakeRange(0, numberOfColumns) tileLength:MBTableGridTileColumns];
+    NSRange tileRows = [self _tileRangeForRange:rowRange tileLength:MBTableGridTileRows];
+    [_tileCache removeTilesInColumns:tileColumns rows:tileRows];
+    
+    // Rows below have moved, though their tiles are still good
+    NSRect dirtyRect = [self rectOfRow:rowRange.location];
+    dirtyRect.size.height = NSHeight(self.bounds) - NSMinY(dirtyRect);
+    [self setNeedsDisplayInRect:dirtyRect];
+}
+
+- (void)invalidateAllCachedTiles {
+    [_tileCache removeAllTiles];
+    self.needsDisplay = YES;
+}
+
+- (void)setCachesRenderedTiles:(BOOL)cachesRenderedTiles {
+    _cachesRenderedTiles = cachesRenderedTiles;
+    [self invalidateAllCachedTiles];
+}
+
+- (void)viewDidChangeEffectiveAppearance {
+    [super viewDidChangeEffectiveAppearance];
+    [self invalidateAllCachedTiles];
+}
+
+- (void)viewDidChangeBackingProperties {
+    [super viewDidChangeBackingProperties];
+    [self invalidateAllCachedTiles];
+}
+
+#pragma mark Indicators
+
 - (void)drawColumnDropIndicator {
     // Draw the column drop indicator
     if (isDraggingColumnOrRow && dropColumn != NSNotFound && dropColumn <= _tableGrid.numberOfColumns && dropRow == NSNotFound) {
@@ -247,15 +475,25 @@ NSString * const MBTableGridTrackingPartKey = @"part";
         [selectionPath transformUsingAffineTransform:translate];
     }
     
-    [self drawCellBordersInRect:rect];
-    
-    // Fill the selection rectangle
-    if (selectionPath) {
-        [[selectionColor colorWithAlphaComponent:0.2] set];
-        [selectionPath fill];
+    if (_cachesRenderedTiles) {
+        [self drawCachedTilesInRect:rect];
+        
+        // The tiles hold no selection state, so fill it over them
+        if (selectionPath) {
+            [[selectionColor colorWithAlphaComponent:0.2] set];
+            [selectionPath fill];
+        }
+    } else {
+        [self drawCellBordersInRect:rect];
+        
+        // Fill the selection rectangle
+        if (selectionPath) {
+            [[selectionColor colorWithAlphaComponent:0.2] set];
+            [selectionPath fill];
+        }
+        
+        [self drawCellInteriorsInRect:rect];
     }
-    
-    [self drawCellInteriorsInRect:rect];
 
     // Draw the selection borders and grab handle art
     if (selectionPath) {
@@ -433,7 +671,7 @@ NSString * const MBTableGridTrackingPartKey = @"part";
             
             NSIndexSet *rowIndexes = [NSIndexSet indexSetWithIndexesInRange:NSMakeRange(firstRowToRemove, numberOfRows - firstRowToRemove)];
             
-            [self.tableGrid.dataSource tableGrid:self.tableGrid removeRows:rowIndexes];
+            [self.tableGrid.dataSource tableGrid:self.tableGrid removeRows:[self.tableGrid _dataSourceRowIndexesForRowIndexes:rowIndexes]];
             
             [self.window invalidateCursorRectsForView:self];
         }
@@ -579,20 +817,11 @@ NSString * const MBTableGridTrackingPartKey = @"part";
     NSRange columnRange = [_tableGrid _rangeOfColumnsIntersectingRect:[self convertRect:visibleRect toView:_tableGrid]];
     NSRange rowRange = [_tableGrid _rangeOfRowsIntersectingRect:[self convertRect:visibleRect toView:_tableGrid]];
     
-    NSUInteger column = columnRange.location;
-    while (column != NSNotFound && column < NSMaxRange(columnRange)) {
-        NSUInteger row = rowRange.location;
-        while (row != NSNotFound && row < NSMaxRange(rowRange)) {
-            NSRect cellFrame = [self frameOfCellAtColumn:column row:row];
-            // Only fetch the cell if we need to
-            NSCell* cell = [_tableGrid _cellForColumn:column row: row];
-            if (cell.cellSize.width > [cell titleRectForBounds:cellFrame].size.width) {
-                [self addToolTipRect:[cell titleRectForBounds:cellFrame] owner:self userData:nil];
-            }
-            row++;
+    [self enumerateCellsInColumns:columnRange rows:rowRange onlyDirty:NO usingBlock:^(MBTableGridCell *cell, NSRect cellFrame) {
+        if (cell && cell.cellSize.width > [cell titleRectForBounds:cellFrame].size.width) {
+            [self addToolTipRect:[cell titleRectForBounds:cellFrame] owner:self userData:nil];
         }
-        column++;
-    }
+    }];
 }
 
 - (NSString *)view:(NSView *)view stringForToolTip:(NSToolTipTag)tag point:(NSPoint)point userData:(void *)data {
@@ -633,6 +862,9 @@ NSString * const MBTableGridTrackingPartKey = @"part";
 		[self.tableGrid _setObjectValue:stringValue forColumn:editedColumn row:editedRow];
 	}
 
+	if (editedColumn != NSNotFound && editedRow != NSNotFound) {
+		[self invalidateCachedTilesInRect:[self frameOfCellAtColumn:editedColumn row:editedRow]];
+	}
 	editedColumn = NSNotFound;
 	editedRow = NSNotFound;
 	
@@ -751,6 +983,9 @@ NSString * const MBTableGridTrackingPartKey = @"part";
 	// Get the top-left selection
 	editedColumn = selectedColumn;
 	editedRow = selectedRow;
+	
+	// The field editor covers this cell, so drop it from its tile
+	[self invalidateCachedTilesInRect:[self frameOfCellAtColumn:editedColumn row:editedRow]];
  
 	// Select it and only it
 	if (self.tableGrid.selectedColumnIndexes.count > 1 && editedColumn != NSNotFound) {
@@ -765,7 +1000,9 @@ NSString * const MBTableGridTrackingPartKey = @"part";
 	selectedCell.editable = YES;
 	selectedCell.selectable = YES;
 	
-	NSString *currentValue = [self.tableGrid _objectValueForColumn:editedColumn row:editedRow];
+	// Formulas are edited as their text rather than their results
+	NSString *currentValue = [self.tableGrid formulaForColumn:editedColumn dataSourceRow:[self.tableGrid dataSourceRowForRow:editedRow]]
+		?: [self.tableGrid _objectValueForColumn:editedColumn row:editedRow];
 
 	NSText *editor = [self.window fieldEditor:YES forObject:self];
 	editor.delegate = self;
@@ -790,27 +1027,11 @@ NSString * const MBTableGridTrackingPartKey = @"part";
 - (NSRect)rectOfColumn:(NSUInteger)columnIndex
 {
 	NSRect rect = NSZeroRect;
-	BOOL foundRect = NO;
 	if (columnIndex < self.tableGrid.numberOfColumns) {
-		NSValue *cachedRectValue = self.tableGrid.columnRects[@(columnIndex)];
-		if (cachedRectValue) {
-			rect = cachedRectValue.rectValue;
-			foundRect = YES;
-		}
-	
-		if (!foundRect) {
-			CGFloat width = [self.tableGrid _widthForColumn:columnIndex];
-			
-			rect = NSMakeRect(0, 0, width, self.frame.size.height);
-            
-            if (columnIndex > 0) {
-                NSRect previousRect = [self rectOfColumn:columnIndex-1];
-                rect.origin.x = previousRect.origin.x + previousRect.size.width;
-            }
-
-			self.tableGrid.columnRects[@(columnIndex)] = @(rect);
-
-		}
+		MBTableGridAxis columns = [self.tableGrid _columnAxis];
+		MBTableGridSpan span = MBTableGridAxisSpanOfIndex(&columns, columnIndex);
+		rect.origin.x = span.origin;
+		rect.size.width = span.length;
 	}
 	
     return NSMakeRect(rect.origin.x, 0.0, rect.size.width, [self frame].size.height);
@@ -818,9 +1039,10 @@ NSString * const MBTableGridTrackingPartKey = @"part";
 
 - (NSRect)rectOfRow:(NSUInteger)rowIndex
 {
-	NSRect rect = NSMakeRect(0, 0, self.frame.size.width, self.rowHeight);
-	rect.origin.y += self.rowHeight * rowIndex;
-	return rect;
+	// Rows past the end (e.g. while filling) continue at the default height
+	MBTableGridAxis rows = [self.tableGrid _rowAxis];
+	MBTableGridSpan span = MBTableGridAxisSpanOfIndex(&rows, rowIndex);
+	return NSMakeRect(0, span.origin, self.frame.size.width, span.length);
 }
 
 - (NSRect)frameOfCellAtColumn:(NSUInteger)columnIndex row:(NSUInteger)rowIndex
@@ -832,24 +1054,16 @@ NSString * const MBTableGridTrackingPartKey = @"part";
 
 - (NSInteger)columnAtPoint:(NSPoint)aPoint
 {
-	NSInteger column = 0;
-	while(column < self.tableGrid.numberOfColumns) {
-		NSRect columnFrame = [self rectOfColumn:column];
-        if(aPoint.x >= NSMinX(columnFrame) && aPoint.x < NSMaxX(columnFrame)) {
-			return column;
-		}
-		column++;
-	}
-	return NSNotFound;
+	MBTableGridAxis columns = [self.tableGrid _columnAxis];
+	size_t column = MBTableGridAxisIndexAtOffset(&columns, aPoint.x);
+	return (column == MBTableGridGeometryNotFound) ? NSNotFound : (NSInteger)column;
 }
 
 - (NSInteger)rowAtPoint:(NSPoint)aPoint
 {
-	NSInteger row = aPoint.y / self.rowHeight;
-	if(row >= 0 && row < self.tableGrid.numberOfRows) {
-		return row;
-	}
-	return NSNotFound;
+	MBTableGridAxis rows = [self.tableGrid _rowAxis];
+	size_t row = MBTableGridAxisIndexAtOffset(&rows, aPoint.y);
+	return (row == MBTableGridGeometryNotFound) ? NSNotFound : (NSInteger)row;
 }
 
 @end
@@ -32,6 +32,7 @@
 	NSMutableArray *columns;
 	NSDictionary *formatters;
     NSArray *columnSampleWidths;
+    NSMutableData *valueText;
 }
 
 @property (nonatomic, assign) IBOutlet NSView *controls_view;
@@ -155,6 +155,35 @@ NSString * const PasteboardTypeColumnClass = @"pasteboardTypeColumnClass";
 	return [NSString stringWithFormat:@"%lu %lu", columnIndex, (unsigned long)rowIndex];
 }
 
+- (void)tableGrid:(MBTableGrid *)aTableGrid getObjectValues:(id __strong *)values forColumns:(NSRange)columnRange rows:(NSRange)rowRange
+{
+	NSUInteger i = 0;
+	for (NSUInteger columnIndex = columnRange.location; columnIndex < NSMaxRange(columnRange); columnIndex++) {
+		for (NSUInteger rowIndex = rowRange.location; rowIndex < NSMaxRange(rowRange); rowIndex++) {
+			values[i++] = [self tableGrid:aTableGrid objectValueForColumn:columnIndex row:rowIndex];
+		}
+	}
+}
+
+- (void)tableGrid:(MBTableGrid *)aTableGrid getValues:(MBTableGridValue *)values forColumns:(NSRange)columnRange rows:(NSRange)rowRange
+{
+	// The strings only need to last until the next call, so they all share one buffer
+	static const size_t maximumLength = 2 * 20 + 2;
+	if (valueText == nil)
+		valueText = [NSMutableData data];
+	valueText.length = columnRange.length * rowRange.length * maximumLength;
+	
+	char *text = valueText.mutableBytes;
+	NSUInteger i = 0;
+	for (NSUInteger columnIndex = columnRange.location; columnIndex < NSMaxRange(columnRange); columnIndex++) {
+		for (NSUInteger rowIndex = rowRange.location; rowIndex < NSMaxRange(rowRange); rowIndex++) {
+			int length = snprintf(text, maximumLength, "%lu %lu", (unsigned long)columnIndex, (unsigned long)rowIndex);
+			values[i++] = MBTableGridValueMakeString(text, length);
+			text += length;
+		}
+	}
+}
+
 - (BOOL)tableGrid:(MBTableGrid *)aTableGrid shouldEditColumn:(NSUInteger)columnIndex row:(NSUInteger)rowIndex {
 	return YES;
 }
@@ -190,6 +219,12 @@ NSString * const PasteboardTypeColumnClass = @"pasteboardTypeColumnClass";
     return (columnIndex < columnSampleWidths.count) ? [columnSampleWidths[columnIndex] floatValue] : 60;
 }
 
+- (void)tableGrid:(MBTableGrid *)aTableGrid getWidths:(float *)widths forColumns:(NSRange)columnRange {
+    for (NSUInteger i = 0; i < columnRange.length; i++) {
+        widths[i] = [self tableGrid:aTableGrid widthForColumn:columnRange.location + i];
+    }
+}
+
 #pragma mark Footer
 
 - (NSString *)footerDefaultsKeyForColumn:(NSUInteger)columnIndex;
@@ -290,82 +325,13 @@ NSString * const PasteboardTypeColumnClass = @"pasteboardTypeColumnClass";
 
 }
 
-- (void)tableGrid:(MBTableGrid *)aTableGrid pasteCellsAtColumns:(NSIndexSet *)columnIndexes rows:(NSIndexSet *)rowIndexes
+#pragma mark Adding and Removing Columns & Rows
+
+- (BOOL)tableGrid:(MBTableGrid *)aTableGrid addColumns:(NSUInteger)numberOfColumns;
 {
-    NSPasteboard *pasteboard = [NSPasteboard generalPasteboard];
-    BOOL isSingleSelection = columnIndexes.count == 1 && rowIndexes.count == 1;
-    NSString *tavString = [pasteboard stringForType:NSPasteboardTypeTabularText];
-    
-    if (!tavString.length) {
-        tavString = [pasteboard stringForType:NSPasteboardTypeString];
-    }
-    
-    if (!tavString.length) {
-        return;
-    }
-    
-    // Extract the rows and columns to a more convenient form
-    NSMutableArray *rowArray = [NSMutableArray array];
-    
-    for (NSString *rowString in [tavString componentsSeparatedByString:@"\n"]) {
-        
-        NSMutableArray *columnArray = [NSMutableArray array];
-        
-        for (NSString *columnString in [rowString componentsSeparatedByString:@"\t"]) {
-            
-            [columnArray addObject:columnString];
-        }
-        
-        [rowArray addObject:columnArray];
-    }
-    
-    NSUInteger firstSelectedColumn = [columnIndexes firstIndex];
-    NSUInteger firstSelectedRow = [rowIndexes firstIndex];
-    NSUInteger numberOfExistingColumns = [columns count];
-    NSUInteger numberOfExistingRows = [[columns firstObject] count];
-    NSUInteger numberOfPastingColumns = [[rowArray firstObject] count];
-    NSUInteger numberOfPastingRows = [rowArray count];
-    
-    // If pasting to a single cell, we want to paste all of the values, so add rows and columns if needed
-    if (isSingleSelection) {
-        NSInteger extraColumns = firstSelectedColumn + numberOfPastingColumns - numberOfExistingColumns;
-        NSInteger extraRows = firstSelectedRow + numberOfPastingRows - numberOfExistingRows;
-        
-        if (extraColumns > 0) {
-            // Add extra columns; a real controller could use the PasteboardTypeColumnClass values to add appropriate column types to the database
-            [self tableGrid:aTableGrid addColumns:extraColumns shouldReload:NO];
-        }
-        
-        if (extraRows > 0) {
-            [self tableGrid:aTableGrid addRows:extraRows shouldReload:NO];
-        }
-    } else {
-        numberOfPastingColumns = columnIndexes.count;
-        numberOfPastingRows = rowIndexes.count;
-    }
-    
-    // Insert the values
-    [rowArray enumerateObjectsUsingBlock:^(NSArray *columnArray, NSUInteger rowOffset, BOOL *stopRows) {
-        [columnArray enumerateObjectsUsingBlock:^(NSString *value, NSUInteger columnOffset, BOOL *stopColumns) {
-            
-            NSUInteger column = firstSelectedColumn + columnOffset;
-            NSUInteger row = firstSelectedRow + rowOffset;
-
-			[self tableGrid:aTableGrid setObjectValue:value forColumn:column row:row];
-            
-            if (columnOffset == numberOfPastingColumns - 1) {
-                *stopColumns = YES;
-            }
-        }];
-        
-        if (rowOffset == numberOfPastingRows - 1) {
-            *stopRows = YES;
-        }
-    }];
+    return [self tableGrid:aTableGrid addColumns:numberOfColumns shouldReload:YES];
 }
 
-#pragma mark Adding and Removing Columns & Rows
-
 - (BOOL)tableGrid:(MBTableGrid *)aTableGrid addColumns:(NSUInteger)numberOfColumns shouldReload:(BOOL)shouldReload;
 {
     // Default number of rows
@@ -413,8 +379,6 @@ NSString * const PasteboardTypeColumnClass = @"pasteboardTypeColumnClass";
         }
     }
     
-    [aTableGrid.columnRects removeAllObjects];
-    
     if (shouldReload) {
         [aTableGrid reloadData];
     }
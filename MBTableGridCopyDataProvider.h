@@ -0,0 +1,50 @@
+//
+//  MBTableGridCopyDataProvider.h
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#import <Cocoa/Cocoa.h>
+
+@class MBTableGrid;
+
+// Promises a block of cells to the pasteboard as tab-separated text, which is only
+// written out if something pastes it. The cells are kept as data source rows, so that
+// sorting, filtering or moving rows in the grid doesn't change them. The grid resolves
+// the promise before it changes one of the cells itself, before it reloads, takes in a
+// new row count or reorders its columns, and before it leaves its window or goes away,
+// so that what is pasted is what was selected when Copy was pressed.
+@interface MBTableGridCopyDataProvider : NSObject<NSPasteboardItemDataProvider> {
+    __weak MBTableGrid *_tableGrid;
+    NSRange _columnRange;
+    NSRange _rowRange;
+    
+    // The data source rows of the copied rows in the order they were shown, and sorted
+    // for looking them up, or NULL if they were shown in data source order as _rowRange
+    size_t *_dataSourceRows;
+    size_t *_sortedDataSourceRows;
+    
+    // The pasteboard holding the promise, and its change count when it was written
+    NSPasteboard *_pasteboard;
+    NSInteger _changeCount;
+    NSData *_data;
+}
+
+// Takes ownership of dataSourceRows, a malloc'd buffer of the data source rows of the
+// rows in rowRange, or NULL if they're their own data source rows. Returns nil, freeing
+// the buffer, if out of memory.
+- (instancetype)initWithTableGrid:(MBTableGrid *)tableGrid columns:(NSRange)columnRange rows:(NSRange)rowRange
+                   dataSourceRows:(size_t *)dataSourceRows;
+
+// Replaces the pasteboard's contents with the promise. Returns NO if it couldn't.
+- (BOOL)writeToPasteboard:(NSPasteboard *)pasteboard;
+
+// Whether the promise is still on the pasteboard and holds any of these cells
+- (BOOL)containsCellsInColumns:(NSIndexSet *)columnIndexes dataSourceRows:(NSIndexSet *)dataSourceRowIndexes;
+
+// Replaces the promise with the text itself, if it's still on the pasteboard. The grid
+// passes itself, since the promise's weak reference to it is gone while it deallocates.
+- (void)resolveFromTableGrid:(MBTableGrid *)tableGrid;
+
+@end
@@ -0,0 +1,135 @@
+//
+//  MBTableGridCopyDataProvider.m
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#import "MBTableGridCopyDataProvider.h"
+#import "MBTableGrid.h"
+
+@interface MBTableGrid (Private)
+- (NSData *)_tabularDataForColumns:(NSRange)columnRange rows:(NSRange)rowRange ofDataSourceRows:(const size_t *)dataSourceRows;
+@end
+
+static int MBCompareDataSourceRows(const void *a, const void *b) {
+    size_t left = *(const size_t *)a, right = *(const size_t *)b;
+    return (left > right) - (left < right);
+}
+
+@implementation MBTableGridCopyDataProvider
+
+- (instancetype)initWithTableGrid:(MBTableGrid *)tableGrid columns:(NSRange)columnRange rows:(NSRange)rowRange
+                   dataSourceRows:(size_t *)dataSourceRows {
+    if (self = [super init]) {
+        _tableGrid = tableGrid;
+        _columnRange = columnRange;
+        _rowRange = rowRange;
+        _dataSourceRows = dataSourceRows;
+        if (dataSourceRows) {
+            _sortedDataSourceRows = malloc(MAX(rowRange.length, 1) * sizeof(size_t));
+            if (_sortedDataSourceRows == NULL)
+                return nil;
+            memcpy(_sortedDataSourceRows, dataSourceRows, rowRange.length * sizeof(size_t));
+            qsort(_sortedDataSourceRows, rowRange.length, sizeof(size_t), MBCompareDataSourceRows);
+        }
+    }
+    return self;
+}
+
+- (void)dealloc {
+    free(_dataSourceRows);
+    free(_sortedDataSourceRows);
+}
+
+- (BOOL)writeToPasteboard:(NSPasteboard *)pasteboard {
+    NSPasteboardItem *item = [[NSPasteboardItem alloc] init];
+    if (![item setDataProvider:self forTypes:@[ NSPasteboardTypeTabularText, NSPasteboardTypeString ]])
+        return NO;
+    
+    [pasteboard clearContents];
+    if (![pasteboard writeObjects:@[ item ]])
+        return NO;
+    
+    _pasteboard = pasteboard;
+    _changeCount = pasteboard.changeCount;
+    return YES;
+}
+
+// Each range of edited rows is looked for among the copied rows by binary search
+- (BOOL)containsCellsInColumns:(NSIndexSet *)columnIndexes dataSourceRows:(NSIndexSet *)dataSourceRowIndexes {
+    if (_pasteboard == nil || _pasteboard.changeCount != _changeCount || ![columnIndexes intersectsIndexesInRange:_columnRange])
+        return NO;
+    if (_sortedDataSourceRows == NULL)
+        return [dataSourceRowIndexes intersectsIndexesInRange:_rowRange];
+    
+    const size_t *sortedDataSourceRows = _sortedDataSourceRows;
+    NSUInteger count = _rowRange.length;
+    __block BOOL contains = NO;
+    [dataSourceRowIndexes enumerateRangesUsingBlock:^(NSRange range, BOOL *stop) {
+        NSUInteger low = 0, high = count;
+        while (low < high) {
+            NSUInteger middle = low + (high - low) / 2;
+            if (sortedDataSourceRows[middle] < range.location) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        if (low < count && sortedDataSourceRows[low] < NSMaxRange(range)) {
+            contains = YES;
+            *stop = YES;
+        }
+    }];
+    return contains;
+}
+
+// Written once, whichever type is asked for first, and shared by both
+- (NSData *)_tabularDataFromTableGrid:(MBTableGrid *)tableGrid {
+    if (_data)
+        return _data;
+    
+    NSRange columnRange = NSIntersectionRange(_columnRange, NSMakeRange(0, tableGrid.numberOfColumns));
+    NSUInteger numberOfDataSourceRows = tableGrid.numberOfDataSourceRows;
+    size_t *dataSourceRows = malloc(MAX(_rowRange.length, 1) * sizeof(size_t));
+    NSUInteger rowCount = 0;
+    for (NSUInteger i = 0; dataSourceRows && i < _rowRange.length; i++) {
+        size_t dataSourceRow = _dataSourceRows ? _dataSourceRows[i] : _rowRange.location + i;
+        if (dataSourceRow < numberOfDataSourceRows)
+            dataSourceRows[rowCount++] = dataSourceRow;
+    }
+    if (columnRange.length > 0 && rowCount > 0)
+        _data = [tableGrid _tabularDataForColumns:columnRange rows:NSMakeRange(0, rowCount) ofDataSourceRows:dataSourceRows];
+    free(dataSourceRows);
+    if (_data == nil)
+        _data = [NSData data];
+    return _data;
+}
+
+- (void)resolveFromTableGrid:(MBTableGrid *)tableGrid {
+    if (_pasteboard == nil || _pasteboard.changeCount != _changeCount)
+        return;
+    
+    NSPasteboard *pasteboard = _pasteboard;
+    NSData *data = [self _tabularDataFromTableGrid:tableGrid];
+    _pasteboard = nil;
+    _data = nil;
+    
+    [pasteboard declareTypes:@[ NSPasteboardTypeTabularText, NSPasteboardTypeString ] owner:nil];
+    [pasteboard setData:data forType:NSPasteboardTypeTabularText];
+    [pasteboard setData:data forType:NSPasteboardTypeString];
+}
+
+#pragma mark -
+#pragma mark NSPasteboardItemDataProvider
+
+- (void)pasteboard:(NSPasteboard *)pasteboard item:(NSPasteboardItem *)item provideDataForType:(NSPasteboardType)type {
+    [item setData:[self _tabularDataFromTableGrid:_tableGrid] forType:type];
+}
+
+- (void)pasteboardFinishedWithDataProvider:(NSPasteboard *)pasteboard {
+    _pasteboard = nil;
+    _data = nil;
+}
+
+@end
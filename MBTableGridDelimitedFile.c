@@ -0,0 +1,500 @@
+//
+//  MBTableGridDelimitedFile.c
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#include "MBTableGridDelimitedFile.h"
+#include "MBTableGridDelimitedReader.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "MBTableGridDelimitedScan.h"
+
+#define MBRecordPageSize 65536 // record offsets per page
+#define MBFormatSampleLength 65536 // bytes searched for the first record's delimiters
+#define MBBufferMinimumCapacity 4096
+
+struct MBTableGridDelimitedFile {
+    const char *bytes;
+    size_t length;
+    bool isMapped;
+    MBTableGridDelimitedFormat format;
+    char delimiter;
+
+    /* The offset of each record, then one past the last record's, in pages
+       that are allocated as needed but never moved. The page table is as
+       large as any file of this length could need. */
+    size_t **pages;
+    size_t pageCount;
+    size_t offsetCount;
+
+    /* How far indexing has reached, and the state of the record there */
+    size_t indexedLength;
+    bool quoted;
+    size_t openDelimiters;
+    size_t widestDelimiters;
+
+    MBTableGridValueType *columnTypes;
+    size_t columnTypeCount;
+};
+
+typedef struct MBBufferBlock {
+    struct MBBufferBlock *next;
+    size_t capacity;
+    size_t used;
+    char bytes[];
+} MBBufferBlock;
+
+struct MBTableGridDelimitedFileBuffer {
+    /* The newest, and largest, block first */
+    MBBufferBlock *blocks;
+};
+
+static inline size_t MBRecordOffset(const MBTableGridDelimitedFile *file, size_t index) {
+    return file->pages[index / MBRecordPageSize][index % MBRecordPageSize];
+}
+
+// Allocates pages for the offsets up to count, so that adding them can't fail
+static bool MBReserveOffsets(MBTableGridDelimitedFile *file, size_t count) {
+    if (count > file->pageCount * MBRecordPageSize)
+        return false;
+    for (size_t page = file->offsetCount / MBRecordPageSize; page * MBRecordPageSize < count; page++) {
+        if (file->pages[page] == NULL && (file->pages[page] = malloc(MBRecordPageSize * sizeof(size_t))) == NULL)
+            return false;
+    }
+    return true;
+}
+
+static inline void MBAddOffset(MBTableGridDelimitedFile *file, size_t offset) {
+    file->pages[file->offsetCount / MBRecordPageSize][file->offsetCount % MBRecordPageSize] = offset;
+    file->offsetCount++;
+}
+
+// The bytes of a record, without its record separator
+static void MBRecordBounds(const MBTableGridDelimitedFile *file, size_t recordIndex, size_t *start, size_t *end) {
+    *start = MBRecordOffset(file, recordIndex);
+    *end = MBRecordOffset(file, recordIndex + 1);
+    if (*end > *start && file->bytes[*end - 1] == '\n')
+        (*end)--;
+    if (*end > *start && file->bytes[*end - 1] == '\r')
+        (*end)--;
+}
+
+static char *MBBufferAllocate(MBTableGridDelimitedFileBuffer *buffer, size_t length) {
+    MBBufferBlock *block = buffer->blocks;
+    if (block == NULL || block->capacity - block->used < length) {
+        size_t capacity = block ? block->capacity * 2 : MBBufferMinimumCapacity;
+        if (capacity < length)
+            capacity = length;
+        if ((block = malloc(sizeof(MBBufferBlock) + capacity)) == NULL)
+            return NULL;
+        block->next = buffer->blocks;
+        block->capacity = capacity;
+        block->used = 0;
+        buffer->blocks = block;
+    }
+    char *bytes = block->bytes + block->used;
+    block->used += length;
+    return bytes;
+}
+
+// Keeps only the largest block, so that a buffer settles at the size its reads need
+static void MBBufferReset(MBTableGridDelimitedFileBuffer *buffer) {
+    MBBufferBlock *block = buffer->blocks;
+    if (block == NULL)
+        return;
+    while (block->next) {
+        MBBufferBlock *next = block->next->next;
+        free(block->next);
+        block->next = next;
+    }
+    block->used = 0;
+}
+
+// Returns the field starting at *position in a record ending at end, and moves
+// *position past the delimiter after it, setting *more if there was one. Quoted
+// fields are unquoted into buffer when they have to be, or left quoted if buffer
+// is NULL. Returns NULL if out of memory.
+static const char *MBNextField(const MBTableGridDelimitedFile *file, MBTableGridDelimitedFileBuffer *buffer,
+                               size_t *position, size_t end, bool *more, size_t *length) {
+    const char *text = file->bytes;
+    size_t start = *position;
+
+    if (start == end || text[start] != '"') {
+        const char *delimiter = memchr(text + start, file->delimiter, end - start);
+        size_t fieldEnd = delimiter ? (size_t)(delimiter - text) : end;
+        *more = (delimiter != NULL);
+        *position = fieldEnd + 1;
+        *length = fieldEnd - start;
+        return text + start;
+    }
+
+    // Quoted up to a quote that isn't doubled, then literal up to the delimiter
+    size_t contentStart = start + 1, contentEnd = contentStart;
+    bool hasDoubledQuotes = false;
+    for (;;) {
+        const char *quote = memchr(text + contentEnd, '"', end - contentEnd);
+        if (quote == NULL) {
+            contentEnd = end;
+            break;
+        }
+        contentEnd = (size_t)(quote - text);
+        if (contentEnd + 1 < end && text[contentEnd + 1] == '"') {
+            hasDoubledQuotes = true;
+            contentEnd += 2;
+            continue;
+        }
+        break;
+    }
+    size_t literalStart = (contentEnd < end) ? contentEnd + 1 : end;
+    const char *delimiter = memchr(text + literalStart, file->delimiter, end - literalStart);
+    size_t fieldEnd = delimiter ? (size_t)(delimiter - text) : end;
+    *more = (delimiter != NULL);
+    *position = fieldEnd + 1;
+
+    if (buffer == NULL) {
+        *length = fieldEnd - start;
+        return text + start;
+    }
+    if (!hasDoubledQuotes && literalStart == fieldEnd) {
+        *length = contentEnd - contentStart;
+        return text + contentStart;
+    }
+
+    char *bytes = MBBufferAllocate(buffer, (contentEnd - contentStart) + (fieldEnd - literalStart));
+    if (bytes == NULL)
+        return NULL;
+    size_t written = 0;
+    for (size_t i = contentStart; i < contentEnd; i++) {
+        bytes[written++] = text[i];
+        if (text[i] == '"')
+            i++;
+    }
+    memcpy(bytes + written, text + literalStart, fieldEnd - literalStart);
+    *length = written + (fieldEnd - literalStart);
+    return bytes;
+}
+
+MBTableGridDelimitedFile *MBTableGridDelimitedFileOpen(const char *path) {
+    MBTableGridDelimitedFile *file = calloc(1, sizeof(MBTableGridDelimitedFile));
+    if (file == NULL)
+        return NULL;
+
+    int descriptor = open(path, O_RDONLY);
+    struct stat status;
+    if (descriptor < 0 || fstat(descriptor, &status) != 0 || status.st_size < 0) {
+        if (descriptor >= 0)
+            close(descriptor);
+        free(file);
+        return NULL;
+    }
+    file->length = (size_t)status.st_size;
+    if (file->length == 0) {
+        file->bytes = "";
+    } else {
+        void *bytes = mmap(NULL, file->length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (bytes == MAP_FAILED) {
+            close(descriptor);
+            free(file);
+            return NULL;
+        }
+        file->bytes = bytes;
+        file->isMapped = true;
+    }
+    close(descriptor);
+
+    file->format = MBTableGridDelimitedFormatGuess(file->bytes, file->length < MBFormatSampleLength ? file->length : MBFormatSampleLength);
+    file->delimiter = (file->format == MBTableGridDelimitedFormatCommaSeparated) ? ',' : '\t';
+
+    // Every byte could end a record, plus the offset of the first
+    file->pageCount = (file->length + 2) / MBRecordPageSize + 1;
+    if ((file->pages = calloc(file->pageCount, sizeof(size_t *))) == NULL || !MBReserveOffsets(file, 1)) {
+        MBTableGridDelimitedFileClose(file);
+        return NULL;
+    }
+    MBAddOffset(file, 0);
+    return file;
+}
+
+void MBTableGridDelimitedFileClose(MBTableGridDelimitedFile *file) {
+    if (file == NULL)
+        return;
+    if (file->isMapped)
+        munmap((void *)file->bytes, file->length);
+    if (file->pages) {
+        for (size_t page = 0; page < file->pageCount; page++)
+            free(file->pages[page]);
+    }
+    free(file->pages);
+    free(file->columnTypes);
+    free(file);
+}
+
+MBTableGridDelimitedFormat MBTableGridDelimitedFileFormat(const MBTableGridDelimitedFile *file) {
+    return file->format;
+}
+
+size_t MBTableGridDelimitedFileLength(const MBTableGridDelimitedFile *file) {
+    return file->length;
+}
+
+size_t MBTableGridDelimitedFileIndexedLength(const MBTableGridDelimitedFile *file) {
+    return file->indexedLength;
+}
+
+bool MBTableGridDelimitedFileIsIndexed(const MBTableGridDelimitedFile *file) {
+    return file->indexedLength == file->length;
+}
+
+void MBTableGridDelimitedFileCountQuotes(const MBTableGridDelimitedFile *file, MBTableGridDelimitedFileChunk *chunk) {
+    size_t count = 0;
+    const char *quote = file->bytes + chunk->start, *end = file->bytes + chunk->end;
+    while ((quote = memchr(quote, '"', (size_t)(end - quote))) != NULL) {
+        count++;
+        quote++;
+    }
+    chunk->quoteCount = count;
+}
+
+void MBTableGridDelimitedFileResolveQuotes(const MBTableGridDelimitedFile *file, MBTableGridDelimitedFileChunk *chunks, size_t chunkCount) {
+    bool quoted = file->quoted;
+    for (size_t i = 0; i < chunkCount; i++) {
+        chunks[i].startsQuoted = quoted;
+        quoted ^= (chunks[i].quoteCount & 1);
+    }
+}
+
+static bool MBAddRecordStart(MBTableGridDelimitedFileChunk *chunk, size_t offset) {
+    if (chunk->recordStartCount == chunk->recordStartCapacity) {
+        size_t capacity = chunk->recordStartCapacity ? chunk->recordStartCapacity * 2 : 1024;
+        size_t *recordStarts = realloc(chunk->recordStarts, capacity * sizeof(size_t));
+        if (recordStarts == NULL)
+            return false;
+        chunk->recordStarts = recordStarts;
+        chunk->recordStartCapacity = capacity;
+    }
+    chunk->recordStarts[chunk->recordStartCount++] = offset;
+    return true;
+}
+
+bool MBTableGridDelimitedFileScanChunk(const MBTableGridDelimitedFile *file, MBTableGridDelimitedFileChunk *chunk) {
+    const unsigned char *text = (const unsigned char *)file->bytes;
+    uint64_t delimiters = MBDelimitedOnes * (unsigned char)file->delimiter;
+    uint64_t quotes = MBDelimitedOnes * '"', lineFeeds = MBDelimitedOnes * '\n', returns = MBDelimitedOnes * '\r';
+    uint64_t quoted = chunk->startsQuoted ? UINT64_MAX : 0;
+    size_t delimiterCount = 0;
+
+    for (size_t block = chunk->start; block < chunk->end; block += MBDelimitedBlockSize) {
+        unsigned char padded[MBDelimitedBlockSize];
+        const unsigned char *bytes = text + block;
+        if (chunk->end - block < MBDelimitedBlockSize) {
+            memset(padded, 0, sizeof(padded));
+            memcpy(padded, bytes, chunk->end - block);
+            bytes = padded;
+        }
+
+        uint64_t quoteMask = MBDelimitedMatchingBlockBytes(bytes, quotes);
+        uint64_t delimiterMask = MBDelimitedMatchingBlockBytes(bytes, delimiters);
+        uint64_t breakMask = MBDelimitedMatchingBlockBytes(bytes, lineFeeds) | MBDelimitedMatchingBlockBytes(bytes, returns);
+
+        // Bytes after an odd number of quotes are inside a quoted field
+        uint64_t inside = MBDelimitedPrefixParity(quoteMask) ^ quoted;
+        quoted = (inside >> 63) ? UINT64_MAX : 0;
+        delimiterMask &= ~inside;
+        breakMask &= ~inside;
+
+        while (breakMask) {
+            unsigned bit = (unsigned)__builtin_ctzll(breakMask);
+            uint64_t before = (UINT64_C(1) << bit) - 1;
+            breakMask &= breakMask - 1;
+            delimiterCount += (size_t)__builtin_popcountll(delimiterMask & before);
+            delimiterMask &= ~before;
+
+            // The CR of a CRLF leaves the record to its LF
+            size_t position = block + bit;
+            if (text[position] == '\r' && position + 1 < file->length && text[position + 1] == '\n')
+                continue;
+
+            if (chunk->recordStartCount == 0)
+                chunk->leadingDelimiters = delimiterCount;
+            else if (delimiterCount > chunk->widestDelimiters)
+                chunk->widestDelimiters = delimiterCount;
+            delimiterCount = 0;
+            if (!MBAddRecordStart(chunk, position + 1)) {
+                chunk->failed = true;
+                return false;
+            }
+        }
+        delimiterCount += (size_t)__builtin_popcountll(delimiterMask);
+    }
+
+    if (chunk->recordStartCount == 0)
+        chunk->leadingDelimiters = delimiterCount;
+    else
+        chunk->trailingDelimiters = delimiterCount;
+    return true;
+}
+
+bool MBTableGridDelimitedFileAppendChunks(MBTableGridDelimitedFile *file, MBTableGridDelimitedFileChunk *chunks, size_t chunkCount) {
+    size_t position = file->indexedLength, recordStartCount = 0;
+    bool valid = true;
+    for (size_t i = 0; i < chunkCount; i++) {
+        valid = valid && !chunks[i].failed && chunks[i].start == position && chunks[i].end <= file->length;
+        position = chunks[i].end;
+        recordStartCount += chunks[i].recordStartCount;
+    }
+    // With room for the end of an unterminated last record
+    if (!valid || !MBReserveOffsets(file, file->offsetCount + recordStartCount + 1)) {
+        for (size_t i = 0; i < chunkCount; i++)
+            MBTableGridDelimitedFileChunkClear(&chunks[i]);
+        return false;
+    }
+
+    for (size_t i = 0; i < chunkCount; i++) {
+        MBTableGridDelimitedFileChunk *chunk = &chunks[i];
+        if (chunk->recordStartCount == 0) {
+            file->openDelimiters += chunk->leadingDelimiters;
+        } else {
+            if (file->openDelimiters + chunk->leadingDelimiters > file->widestDelimiters)
+                file->widestDelimiters = file->openDelimiters + chunk->leadingDelimiters;
+            if (chunk->widestDelimiters > file->widestDelimiters)
+                file->widestDelimiters = chunk->widestDelimiters;
+            file->openDelimiters = chunk->trailingDelimiters;
+        }
+        for (size_t j = 0; j < chunk->recordStartCount; j++)
+            MBAddOffset(file, chunk->recordStarts[j]);
+        file->quoted = chunk->startsQuoted ^ (chunk->quoteCount & 1);
+        file->indexedLength = chunk->end;
+        MBTableGridDelimitedFileChunkClear(chunk);
+    }
+
+    // The last record needn't end with a record separator
+    if (file->indexedLength == file->length && MBRecordOffset(file, file->offsetCount - 1) < file->length) {
+        MBAddOffset(file, file->length);
+        if (file->openDelimiters > file->widestDelimiters)
+            file->widestDelimiters = file->openDelimiters;
+    }
+    return true;
+}
+
+void MBTableGridDelimitedFileChunkClear(MBTableGridDelimitedFileChunk *chunk) {
+    free(chunk->recordStarts);
+    chunk->recordStarts = NULL;
+    chunk->recordStartCount = 0;
+    chunk->recordStartCapacity = 0;
+}
+
+size_t MBTableGridDelimitedFileRecordCount(const MBTableGridDelimitedFile *file) {
+    return file->offsetCount - 1;
+}
+
+size_t MBTableGridDelimitedFileColumnCount(const MBTableGridDelimitedFile *file) {
+    return (file->offsetCount > 1) ? file->widestDelimiters + 1 : 0;
+}
+
+bool MBTableGridDelimitedFileGuessColumnTypes(MBTableGridDelimitedFile *file, size_t firstRecord, size_t recordCount) {
+    size_t columnCount = MBTableGridDelimitedFileColumnCount(file);
+    MBTableGridDelimitedFileBuffer *buffer = MBTableGridDelimitedFileBufferCreate();
+    MBTableGridValueType *columnTypes = calloc(columnCount ? columnCount : 1, sizeof(MBTableGridValueType));
+    if (buffer == NULL || columnTypes == NULL) {
+        MBTableGridDelimitedFileBufferDestroy(buffer);
+        free(columnTypes);
+        return false;
+    }
+
+    bool succeeded = true;
+    for (size_t record = firstRecord; record < firstRecord + recordCount && succeeded; record++) {
+        size_t position, end, length;
+        bool more = true;
+        MBRecordBounds(file, record, &position, &end);
+        MBBufferReset(buffer);
+        for (size_t column = 0; column < columnCount && more; column++) {
+            const char *bytes = MBNextField(file, buffer, &position, end, &more, &length);
+            if (bytes == NULL) {
+                succeeded = false;
+                break;
+            }
+            columnTypes[column] = MBTableGridDelimitedColumnTypeAddField(columnTypes[column], bytes, length);
+        }
+    }
+    MBTableGridDelimitedFileBufferDestroy(buffer);
+    if (!succeeded) {
+        free(columnTypes);
+        return false;
+    }
+
+    for (size_t column = 0; column < columnCount; column++) {
+        if (columnTypes[column] == MBTableGridValueTypeEmpty)
+            columnTypes[column] = MBTableGridValueTypeString;
+    }
+    free(file->columnTypes);
+    file->columnTypes = columnTypes;
+    file->columnTypeCount = columnCount;
+    return true;
+}
+
+MBTableGridValueType MBTableGridDelimitedFileColumnType(const MBTableGridDelimitedFile *file, size_t columnIndex) {
+    return (columnIndex < file->columnTypeCount) ? file->columnTypes[columnIndex] : MBTableGridValueTypeString;
+}
+
+MBTableGridDelimitedFileBuffer *MBTableGridDelimitedFileBufferCreate(void) {
+    return calloc(1, sizeof(MBTableGridDelimitedFileBuffer));
+}
+
+void MBTableGridDelimitedFileBufferDestroy(MBTableGridDelimitedFileBuffer *buffer) {
+    if (buffer == NULL)
+        return;
+    MBBufferReset(buffer);
+    free(buffer->blocks);
+    free(buffer);
+}
+
+const char *MBTableGridDelimitedFileGetField(const MBTableGridDelimitedFile *file, MBTableGridDelimitedFileBuffer *buffer,
+                                             size_t columnIndex, size_t recordIndex, size_t *length) {
+    size_t position, end;
+    bool more = true;
+    MBRecordBounds(file, recordIndex, &position, &end);
+    MBBufferReset(buffer);
+
+    // Skip the fields before it without unquoting them
+    for (size_t column = 0; column < columnIndex && more; column++)
+        MBNextField(file, NULL, &position, end, &more, length);
+    if (!more) {
+        *length = 0;
+        return "";
+    }
+    return MBNextField(file, buffer, &position, end, &more, length);
+}
+
+void MBTableGridDelimitedFileGetValues(const MBTableGridDelimitedFile *file, MBTableGridDelimitedFileBuffer *buffer,
+                                       MBTableGridValue *values, size_t firstColumn, size_t columnCount,
+                                       size_t firstRecord, size_t recordCount) {
+    MBBufferReset(buffer);
+
+    // Each record is walked once, filling in a value for each column in turn
+    for (size_t j = 0; j < recordCount; j++) {
+        size_t position, end, length;
+        bool more = true;
+        MBRecordBounds(file, firstRecord + j, &position, &end);
+        for (size_t column = 0; column < firstColumn && more; column++)
+            MBNextField(file, NULL, &position, end, &more, &length);
+
+        for (size_t i = 0; i < columnCount; i++) {
+            const char *bytes = more ? MBNextField(file, buffer, &position, end, &more, &length) : NULL;
+            if (bytes == NULL) {
+                values[i * recordCount + j] = (MBTableGridValue){ .type = MBTableGridValueTypeEmpty };
+                more = false;
+                continue;
+            }
+            values[i * recordCount + j] = MBTableGridDelimitedFieldValue(bytes, length,
+                                                                         MBTableGridDelimitedFileColumnType(file, firstColumn + i));
+        }
+    }
+}
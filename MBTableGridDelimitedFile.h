@@ -0,0 +1,234 @@
+//
+//  MBTableGridDelimitedFile.h
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#ifndef MBTableGridDelimitedFile_h
+#define MBTableGridDelimitedFile_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "MBTableGridValue.h"
+#include "MBTableGridDelimitedWriter.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief		\c MBTableGridDelimitedFile reads a tab- or comma-separated
+ *				file in place, through a memory map, so that a file of
+ *				several gigabytes can be shown without copying it.
+ *
+ * @details		Only the offset of each record is kept, in pages that are
+ *				never moved, and fields are found again within a record
+ *				when they are read. Fields are handed out as slices of the
+ *				mapped file, except for quoted fields with doubled quotes,
+ *				which are unquoted into a caller's buffer when read.
+ *
+ *				The file is indexed a span of bytes at a time, and each
+ *				span may be split into chunks that are scanned on separate
+ *				threads in two passes: the first counts each chunk's
+ *				quotes, so that whether a chunk starts inside a quoted
+ *				field follows from the counts before it, and the second
+ *				finds the record starts and delimiters outside quotes with
+ *				the block masks of \c MBTableGridDelimitedTable. The
+ *				chunks are then appended in order on one thread.
+ *
+ *				Quotes are expected to be balanced, as RFC 4180 requires:
+ *				a stray quote in the middle of a field starts a quoted run
+ *				that ends at the next quote.
+ *
+ *				Records already indexed may be read from any number of
+ *				threads while later ones are appended, as long as the
+ *				readers learn the record count from the appending thread
+ *				through a barrier such as a dispatch queue.
+ */
+typedef struct MBTableGridDelimitedFile MBTableGridDelimitedFile;
+
+/**
+ * @brief		A chunk of the file to be scanned, and what scanning found.
+ *				Set \c start and \c end, zero the rest, and clear it with
+ *				\c MBTableGridDelimitedFileChunkClear if it isn't appended.
+ */
+typedef struct MBTableGridDelimitedFileChunk {
+    size_t start;
+    size_t end;
+    /* The double quotes in the chunk, and whether start is inside a quoted
+       field, which follows from the quotes before it */
+    size_t quoteCount;
+    bool startsQuoted;
+
+    /* The offsets just past each record separator in the chunk */
+    size_t *recordStarts;
+    size_t recordStartCount;
+    size_t recordStartCapacity;
+
+    /* Delimiters before the first record start, after the last one, and
+       the most in any record that starts and ends in the chunk */
+    size_t leadingDelimiters;
+    size_t trailingDelimiters;
+    size_t widestDelimiters;
+    bool failed;
+} MBTableGridDelimitedFileChunk;
+
+/**
+ * @brief		Memory for unquoted fields, reused from one read to the next.
+ *				Each thread reading a file needs its own.
+ */
+typedef struct MBTableGridDelimitedFileBuffer MBTableGridDelimitedFileBuffer;
+
+/**
+ * @brief		Maps a file and guesses its format from its first record,
+ *				as \c MBTableGridDelimitedFormatGuess does.
+ *
+ * @return		The file, with nothing yet indexed, or \c NULL if it
+ *				can't be opened or mapped or is out of memory.
+ */
+MBTableGridDelimitedFile *MBTableGridDelimitedFileOpen(const char *path);
+
+/**
+ * @brief		Unmaps a file opened with \c MBTableGridDelimitedFileOpen.
+ */
+void MBTableGridDelimitedFileClose(MBTableGridDelimitedFile *file);
+
+/**
+ * @brief		Returns the format guessed for the file.
+ */
+MBTableGridDelimitedFormat MBTableGridDelimitedFileFormat(const MBTableGridDelimitedFile *file);
+
+/**
+ * @brief		Returns the size of the file in bytes.
+ */
+size_t MBTableGridDelimitedFileLength(const MBTableGridDelimitedFile *file);
+
+/**
+ * @name		Indexing
+ */
+
+/**
+ * @brief		Returns the number of bytes indexed so far. Chunks to be
+ *				appended next start here.
+ */
+size_t MBTableGridDelimitedFileIndexedLength(const MBTableGridDelimitedFile *file);
+
+/**
+ * @brief		Returns whether the whole file has been indexed.
+ */
+bool MBTableGridDelimitedFileIsIndexed(const MBTableGridDelimitedFile *file);
+
+/**
+ * @brief		Counts the double quotes in a chunk, the first pass over
+ *				it. May be called on any thread, one chunk per call.
+ */
+void MBTableGridDelimitedFileCountQuotes(const MBTableGridDelimitedFile *file, MBTableGridDelimitedFileChunk *chunk);
+
+/**
+ * @brief		Sets whether each chunk starts inside a quoted field, from
+ *				the quotes counted in the chunks before it. The chunks must
+ *				follow one another from the indexed length.
+ */
+void MBTableGridDelimitedFileResolveQuotes(const MBTableGridDelimitedFile *file, MBTableGridDelimitedFileChunk *chunks, size_t chunkCount);
+
+/**
+ * @brief		Finds the record starts and delimiters in a chunk whose
+ *				\c startsQuoted is known, the second pass over a chunk.
+ *				May be called on any thread, one chunk per call.
+ *
+ * @return		\c false if out of memory.
+ */
+bool MBTableGridDelimitedFileScanChunk(const MBTableGridDelimitedFile *file, MBTableGridDelimitedFileChunk *chunk);
+
+/**
+ * @brief		Appends the records of scanned chunks, which must follow one
+ *				another from the indexed length, and clears the chunks
+ *				whether or not they were appended. The last record is
+ *				counted once the whole file is indexed.
+ *
+ * @return		\c false if a chunk failed or out of memory, in which case
+ *				nothing is appended.
+ */
+bool MBTableGridDelimitedFileAppendChunks(MBTableGridDelimitedFile *file, MBTableGridDelimitedFileChunk *chunks, size_t chunkCount);
+
+/**
+ * @brief		Frees what scanning a chunk allocated.
+ */
+void MBTableGridDelimitedFileChunkClear(MBTableGridDelimitedFileChunk *chunk);
+
+/**
+ * @brief		Returns the number of records indexed so far.
+ */
+size_t MBTableGridDelimitedFileRecordCount(const MBTableGridDelimitedFile *file);
+
+/**
+ * @brief		Returns the number of fields in the longest record indexed
+ *				so far.
+ */
+size_t MBTableGridDelimitedFileColumnCount(const MBTableGridDelimitedFile *file);
+
+/**
+ * @brief		Guesses the type of each column from a sample of records,
+ *				as \c MBTableGridDelimitedTable does for all of its records.
+ *				Call it once, before the records are read by other threads.
+ *
+ * @return		\c false if out of memory.
+ */
+bool MBTableGridDelimitedFileGuessColumnTypes(MBTableGridDelimitedFile *file, size_t firstRecord, size_t recordCount);
+
+/**
+ * @brief		Returns the type guessed for a column. Columns outside the
+ *				sample are strings.
+ */
+MBTableGridValueType MBTableGridDelimitedFileColumnType(const MBTableGridDelimitedFile *file, size_t columnIndex);
+
+/**
+ * @name		Reading
+ */
+
+/**
+ * @brief		Creates a buffer for unquoted fields. Returns \c NULL if out
+ *				of memory.
+ */
+MBTableGridDelimitedFileBuffer *MBTableGridDelimitedFileBufferCreate(void);
+
+/**
+ * @brief		Frees a buffer created with \c MBTableGridDelimitedFileBufferCreate.
+ */
+void MBTableGridDelimitedFileBufferDestroy(MBTableGridDelimitedFileBuffer *buffer);
+
+/**
+ * @brief		Returns the unquoted text of a field with its length in
+ *				\c length. Fields missing from the end of a short record
+ *				are empty.
+ *
+ * @details		The text is valid until the file is closed or, for a field
+ *				with doubled quotes, until \c buffer is next used.
+ *
+ * @return		The text, or \c NULL if out of memory.
+ */
+const char *MBTableGridDelimitedFileGetField(const MBTableGridDelimitedFile *file, MBTableGridDelimitedFileBuffer *buffer,
+                                             size_t columnIndex, size_t recordIndex, size_t *length);
+
+/**
+ * @brief		Fills in the values of a block of fields, typed as their
+ *				columns are, in column-first order as
+ *				\c MBTableGridDelimitedTableGetValues does.
+ *
+ * @details		Strings are borrowed from the file or from \c buffer, and
+ *				are valid until the file is closed or \c buffer is next
+ *				used. Fields that can't be unquoted for want of memory are
+ *				left empty. The block must lie within the indexed records.
+ */
+void MBTableGridDelimitedFileGetValues(const MBTableGridDelimitedFile *file, MBTableGridDelimitedFileBuffer *buffer,
+                                       MBTableGridValue *values, size_t firstColumn, size_t columnCount,
+                                       size_t firstRecord, size_t recordCount);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MBTableGridDelimitedFile_h */
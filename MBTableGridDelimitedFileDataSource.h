@@ -0,0 +1,98 @@
+//
+//  MBTableGridDelimitedFileDataSource.h
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#import <Cocoa/Cocoa.h>
+#import "MBTableGrid.h"
+#import "MBTableGridValue.h"
+
+@class MBTableGridCell;
+
+/**
+ * @brief		\c MBTableGridDelimitedFileDataSource is a ready-made,
+ *				read-only data source that shows a tab- or comma-separated
+ *				file without loading it into memory.
+ *
+ * @details		The file is memory mapped, and only the offset of each
+ *				record is kept. Values are handed to the grid in bulk
+ *				through \c tableGrid:getValues:forColumns:rows:, with
+ *				strings borrowed from the mapped file except for quoted
+ *				fields with doubled quotes, which are unquoted as they
+ *				are read.
+ *
+ *				The records are indexed in the background, on every
+ *				processor, a span of the file at a time. After each span
+ *				the data source tells its \c tableGrid about the rows
+ *				found so far with \c noteNumberOfRowsChanged, so the first
+ *				screen can be shown straight away. Column types are
+ *				guessed from the first span.
+ *
+ *				The file must not change while it is shown.
+ */
+@interface MBTableGridDelimitedFileDataSource : NSObject <MBTableGridDataSource>
+
+/**
+ * @brief		Opens a file and starts indexing it.
+ *
+ * @param		path				The file to show.
+ * @param		firstRowIsHeader	Whether the first record holds the
+ *									column headers rather than values.
+ *
+ * @return		The data source, or \c nil if the file can't be opened.
+ */
+- (instancetype)initWithContentsOfFile:(NSString *)path firstRowIsHeader:(BOOL)firstRowIsHeader;
+
+/**
+ * @brief		The grid told about rows as they are indexed. Set it to
+ *				the grid whose data source this is.
+ */
+@property (nonatomic, weak) MBTableGrid *tableGrid;
+
+/**
+ * @brief		The cell used to display every value. Defaults to a text
+ *				cell.
+ */
+@property (nonatomic, strong) MBTableGridCell *cell;
+
+/**
+ * @brief		Whether records are still being indexed.
+ */
+@property (nonatomic, readonly, getter=isIndexing) BOOL indexing;
+
+/**
+ * @brief		Stops indexing, leaving the rows indexed so far.
+ *
+ * @details		Indexing keeps the data source alive until it finishes,
+ *				so cancel it before letting go of a data source whose file
+ *				is still being indexed.
+ */
+- (void)cancelIndexing;
+
+/**
+ * @brief		The number of columns and rows indexed so far, as last
+ *				given to the grid.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfColumns;
+@property (nonatomic, readonly) NSUInteger numberOfRows;
+
+/**
+ * @brief		Returns the type guessed for a column's values.
+ */
+- (MBTableGridValueType)typeOfColumn:(NSUInteger)columnIndex;
+
+/**
+ * @brief		The header title of a column, or \c nil if the file has no
+ *				header row.
+ */
+- (NSString *)headerForColumn:(NSUInteger)columnIndex;
+
+/**
+ * @brief		Returns the value of a cell as an \c NSNumber, \c NSDate or
+ *				\c NSString, or \c nil if the cell is empty.
+ */
+- (id)objectValueForColumn:(NSUInteger)columnIndex row:(NSUInteger)rowIndex;
+
+@end
@@ -0,0 +1,274 @@
+//
+//  MBTableGridDelimitedFileDataSource.m
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#import "MBTableGridDelimitedFileDataSource.h"
+#import "MBTableGridCell.h"
+#import "MBTableGridDelimitedFile.h"
+#import <stdatomic.h>
+
+#define MBDelimitedFileFirstSpanLength (4 << 20) // bytes indexed before the first rows are shown
+#define MBDelimitedFileSpanLength (64 << 20) // bytes indexed between later updates
+#define MBDelimitedFileChunkLength (1 << 20) // fewest bytes scanned by each worker task
+#define MBDelimitedFileTypeSampleSize 10000 // records whose fields decide the column types
+
+// Owns the buffers one thread reads fields into, so that they are freed with the thread
+@interface MBTableGridDelimitedFileBuffers : NSObject
+// Unquoted strings handed to the grid, which must last until its next request
+@property (nonatomic, readonly) MBTableGridDelimitedFileBuffer *valueBuffer;
+// Unquoted strings copied into objects straight away
+@property (nonatomic, readonly) MBTableGridDelimitedFileBuffer *objectBuffer;
+@end
+
+@implementation MBTableGridDelimitedFileBuffers
+
+- (instancetype)init {
+    if (self = [super init]) {
+        _valueBuffer = MBTableGridDelimitedFileBufferCreate();
+        _objectBuffer = MBTableGridDelimitedFileBufferCreate();
+        if (_valueBuffer == NULL || _objectBuffer == NULL)
+            return nil;
+    }
+    return self;
+}
+
+- (void)dealloc {
+    MBTableGridDelimitedFileBufferDestroy(_valueBuffer);
+    MBTableGridDelimitedFileBufferDestroy(_objectBuffer);
+}
+
+@end
+
+@interface MBTableGridDelimitedFileDataSource () {
+    MBTableGridDelimitedFile *_file;
+    BOOL _firstRowIsHeader;
+    NSArray<NSString *> *_headers;
+    NSString *_bufferKey;
+    atomic_bool _indexingCancelled;
+}
+@end
+
+@implementation MBTableGridDelimitedFileDataSource
+
+- (instancetype)initWithContentsOfFile:(NSString *)path firstRowIsHeader:(BOOL)firstRowIsHeader {
+    if (self = [super init]) {
+        _file = MBTableGridDelimitedFileOpen(path.fileSystemRepresentation);
+        if (_file == NULL)
+            return nil;
+        _firstRowIsHeader = firstRowIsHeader;
+        _bufferKey = [NSString stringWithFormat:@"MBTableGridDelimitedFileBuffers %@", [NSUUID UUID].UUIDString];
+        _cell = [[MBTableGridCell alloc] initTextCell:@""];
+        _indexing = YES;
+        atomic_init(&_indexingCancelled, false);
+
+        // The block keeps the data source, and so the file, alive until indexing stops
+        dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+            [self _indexFile];
+        });
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [NSThread.currentThread.threadDictionary removeObjectForKey:_bufferKey];
+    MBTableGridDelimitedFileClose(_file);
+}
+
+- (BOOL)respondsToSelector:(SEL)aSelector {
+    // Without a header row the grid's own column titles will do
+    if (aSelector == @selector(tableGrid:headerStringForColumn:)) {
+        return _firstRowIsHeader;
+    }
+    return [super respondsToSelector:aSelector];
+}
+
+#pragma mark - Indexing
+
+- (void)cancelIndexing {
+    atomic_store(&_indexingCancelled, true);
+}
+
+- (void)_indexFile {
+    MBTableGridDelimitedFile *file = _file;
+    size_t length = MBTableGridDelimitedFileLength(file);
+    size_t maximumChunkCount = 2 * MAX(1, NSProcessInfo.processInfo.activeProcessorCount);
+    size_t headerCount = _firstRowIsHeader ? 1 : 0;
+    size_t spanLength = MBDelimitedFileFirstSpanLength;
+    dispatch_queue_t queue = dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0);
+    BOOL hasColumnTypes = NO;
+
+    while (!MBTableGridDelimitedFileIsIndexed(file) && !atomic_load(&_indexingCancelled)) {
+        size_t start = MBTableGridDelimitedFileIndexedLength(file);
+        size_t end = MIN(length, start + spanLength);
+        size_t chunkCount = MAX(1, MIN(maximumChunkCount, (end - start) / MBDelimitedFileChunkLength));
+        MBTableGridDelimitedFileChunk *chunks = calloc(chunkCount, sizeof(MBTableGridDelimitedFileChunk));
+        if (chunks == NULL)
+            break;
+        for (size_t i = 0; i < chunkCount; i++) {
+            chunks[i].start = start + (end - start) * i / chunkCount;
+            chunks[i].end = start + (end - start) * (i + 1) / chunkCount;
+        }
+
+        // Count the quotes first, so that each chunk knows whether it starts inside a quoted field
+        dispatch_apply(chunkCount, queue, ^(size_t i) {
+            MBTableGridDelimitedFileCountQuotes(file, &chunks[i]);
+        });
+        MBTableGridDelimitedFileResolveQuotes(file, chunks, chunkCount);
+        dispatch_apply(chunkCount, queue, ^(size_t i) {
+            MBTableGridDelimitedFileScanChunk(file, &chunks[i]);
+        });
+        BOOL appended = MBTableGridDelimitedFileAppendChunks(file, chunks, chunkCount);
+        free(chunks);
+        if (!appended) {
+            NSLog(@"WARNING: MBTableGrid could not index more than %lu bytes of a file", (unsigned long)start);
+            break;
+        }
+        spanLength = MBDelimitedFileSpanLength;
+
+        // Rows are shown once there are values to guess the column types from
+        size_t recordCount = MBTableGridDelimitedFileRecordCount(file);
+        NSArray<NSString *> *headers = nil;
+        if (!hasColumnTypes) {
+            if (recordCount <= headerCount && !MBTableGridDelimitedFileIsIndexed(file))
+                continue;
+            size_t firstRecord = MIN(headerCount, recordCount);
+            MBTableGridDelimitedFileGuessColumnTypes(file, firstRecord, MIN(recordCount - firstRecord, MBDelimitedFileTypeSampleSize));
+            headers = [self _readHeaders];
+            hasColumnTypes = YES;
+        }
+        [self _noteRecordCount:recordCount headers:headers];
+    }
+    [self _noteRecordCount:hasColumnTypes ? MBTableGridDelimitedFileRecordCount(file) : 0 headers:nil];
+
+    dispatch_async(dispatch_get_main_queue(), ^{
+        self->_indexing = NO;
+    });
+}
+
+- (NSArray<NSString *> *)_readHeaders {
+    if (!_firstRowIsHeader || MBTableGridDelimitedFileRecordCount(_file) == 0)
+        return nil;
+    MBTableGridDelimitedFileBuffer *buffer = MBTableGridDelimitedFileBufferCreate();
+    if (buffer == NULL)
+        return nil;
+
+    size_t columnCount = MBTableGridDelimitedFileColumnCount(_file);
+    NSMutableArray<NSString *> *headers = [NSMutableArray arrayWithCapacity:columnCount];
+    for (size_t column = 0; column < columnCount; column++) {
+        size_t length = 0;
+        const char *bytes = MBTableGridDelimitedFileGetField(_file, buffer, column, 0, &length);
+        NSString *header = bytes ? [[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding] : nil;
+        [headers addObject:header ?: @""];
+    }
+    MBTableGridDelimitedFileBufferDestroy(buffer);
+    return headers;
+}
+
+// Hands the records indexed so far to the grid, on the main thread
+- (void)_noteRecordCount:(size_t)recordCount headers:(NSArray<NSString *> *)headers {
+    size_t columnCount = MBTableGridDelimitedFileColumnCount(_file);
+    size_t headerCount = _firstRowIsHeader ? 1 : 0;
+    NSUInteger numberOfRows = (recordCount > headerCount) ? recordCount - headerCount : 0;
+
+    dispatch_async(dispatch_get_main_queue(), ^{
+        BOOL columnsChanged = (columnCount != self->_numberOfColumns || headers != nil);
+        if (headers)
+            self->_headers = headers;
+        self->_numberOfColumns = columnCount;
+        self->_numberOfRows = numberOfRows;
+        if (columnsChanged)
+            [self.tableGrid reloadData];
+        else
+            [self.tableGrid noteNumberOfRowsChanged];
+    });
+}
+
+#pragma mark - Columns
+
+- (MBTableGridValueType)typeOfColumn:(NSUInteger)columnIndex {
+    return MBTableGridDelimitedFileColumnType(_file, columnIndex);
+}
+
+- (NSString *)headerForColumn:(NSUInteger)columnIndex {
+    if (!_firstRowIsHeader)
+        return nil;
+    return (columnIndex < _headers.count) ? _headers[columnIndex] : @"";
+}
+
+#pragma mark - Values
+
+// Each thread the grid reads from gets its own buffers, so that strings handed
+// to one thread aren't overwritten by another
+- (MBTableGridDelimitedFileBuffers *)_buffers {
+    NSMutableDictionary *threadDictionary = NSThread.currentThread.threadDictionary;
+    MBTableGridDelimitedFileBuffers *buffers = threadDictionary[_bufferKey];
+    if (buffers == nil) {
+        buffers = [[MBTableGridDelimitedFileBuffers alloc] init];
+        if (buffers)
+            threadDictionary[_bufferKey] = buffers;
+    }
+    return buffers;
+}
+
+- (size_t)_recordForRow:(NSUInteger)rowIndex {
+    return rowIndex + (_firstRowIsHeader ? 1 : 0);
+}
+
+- (id)objectValueForColumn:(NSUInteger)columnIndex row:(NSUInteger)rowIndex {
+    MBTableGridDelimitedFileBuffers *buffers = [self _buffers];
+    MBTableGridValue value;
+    if (buffers == nil || columnIndex >= self.numberOfColumns || rowIndex >= self.numberOfRows)
+        return nil;
+    MBTableGridDelimitedFileGetValues(_file, buffers.objectBuffer, &value, columnIndex, 1, [self _recordForRow:rowIndex], 1);
+
+    switch (value.type) {
+        case MBTableGridValueTypeInteger:
+            return @(value.data.integer);
+        case MBTableGridValueTypeDouble:
+            return @(value.data.number);
+        case MBTableGridValueTypeBoolean:
+            return @(value.data.boolean);
+        case MBTableGridValueTypeDate:
+            return [NSDate dateWithTimeIntervalSince1970:value.data.number];
+        case MBTableGridValueTypeString:
+            return [[NSString alloc] initWithBytes:value.data.string.bytes length:value.data.string.length encoding:NSUTF8StringEncoding];
+        default:
+            return nil;
+    }
+}
+
+#pragma mark - MBTableGridDataSource
+
+- (NSUInteger)numberOfRowsInTableGrid:(MBTableGrid *)aTableGrid {
+    return self.numberOfRows;
+}
+
+- (NSUInteger)numberOfColumnsInTableGrid:(MBTableGrid *)aTableGrid {
+    return self.numberOfColumns;
+}
+
+- (id)tableGrid:(MBTableGrid *)aTableGrid objectValueForColumn:(NSUInteger)columnIndex row:(NSUInteger)rowIndex {
+    return [self objectValueForColumn:columnIndex row:rowIndex];
+}
+
+- (void)tableGrid:(MBTableGrid *)aTableGrid getValues:(MBTableGridValue *)values forColumns:(NSRange)columnRange rows:(NSRange)rowRange {
+    MBTableGridDelimitedFileBuffers *buffers = [self _buffers];
+    if (buffers == nil)
+        return;
+    MBTableGridDelimitedFileGetValues(_file, buffers.valueBuffer, values, columnRange.location, columnRange.length,
+                                      [self _recordForRow:rowRange.location], rowRange.length);
+}
+
+- (MBTableGridCell *)tableGrid:(MBTableGrid *)aTableGrid cellForColumn:(NSUInteger)columnIndex row:(NSUInteger)rowIndex {
+    self.cell.objectValue = [self objectValueForColumn:columnIndex row:rowIndex];
+    return self.cell;
+}
+
+- (NSString *)tableGrid:(MBTableGrid *)aTableGrid headerStringForColumn:(NSUInteger)columnIndex {
+    return [self headerForColumn:columnIndex];
+}
+
+@end
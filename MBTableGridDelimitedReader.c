@@ -0,0 +1,446 @@
+//
+//  MBTableGridDelimitedReader.c
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#include "MBTableGridDelimitedReader.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "MBTableGridDelimitedScan.h"
+
+typedef struct MBField {
+    uint32_t offset;
+    uint32_t length;
+} MBField;
+
+struct MBTableGridDelimitedTable {
+    /* A copy of the text, with quoted fields unquoted in place */
+    char *text;
+    MBField *fields;
+    size_t fieldCount;
+    size_t fieldCapacity;
+    /* The index of each record's first field, and one past the last record's */
+    size_t *rows;
+    size_t rowCount;
+    size_t rowCapacity;
+    size_t columnCount;
+    MBTableGridValueType *columnTypes;
+};
+
+static bool MBAddField(MBTableGridDelimitedTable *table, size_t offset, size_t length) {
+    if (table->fieldCount == table->fieldCapacity) {
+        size_t capacity = table->fieldCapacity ? table->fieldCapacity * 2 : 1024;
+        MBField *fields = realloc(table->fields, capacity * sizeof(MBField));
+        if (fields == NULL)
+            return false;
+        table->fields = fields;
+        table->fieldCapacity = capacity;
+    }
+    table->fields[table->fieldCount++] = (MBField){ (uint32_t)offset, (uint32_t)length };
+    return true;
+}
+
+// Starts a record at the next field
+static bool MBAddRow(MBTableGridDelimitedTable *table) {
+    if (table->rowCount + 1 >= table->rowCapacity) {
+        size_t capacity = table->rowCapacity ? table->rowCapacity * 2 : 256;
+        size_t *rows = realloc(table->rows, capacity * sizeof(size_t));
+        if (rows == NULL)
+            return false;
+        table->rows = rows;
+        table->rowCapacity = capacity;
+    }
+    table->rows[table->rowCount++] = table->fieldCount;
+    return true;
+}
+
+// Unquotes a field that starts and ends with a quote into its own first bytes.
+// Returns false if a quote inside it isn't doubled.
+static bool MBUnquote(char *text, size_t start, size_t end, size_t *length) {
+    size_t written = 0;
+    for (size_t i = start + 1; i < end - 1; i++) {
+        if (text[i] == '"') {
+            if (i + 1 >= end - 1 || text[i + 1] != '"')
+                return false;
+            i++;
+        }
+        text[start + written++] = text[i];
+    }
+    *length = written;
+    return true;
+}
+
+// Splits the text with bit masks. Returns false, with *needsScalar set, if a field
+// has quotes the masks can't account for, or just false if out of memory.
+static bool MBSplitBlocks(MBTableGridDelimitedTable *table, size_t length, char delimiter, bool *needsScalar) {
+    unsigned char *text = (unsigned char *)table->text;
+    uint64_t delimiters = MBDelimitedOnes * (unsigned char)delimiter;
+    uint64_t quotes = MBDelimitedOnes * '"', lineFeeds = MBDelimitedOnes * '\n', returns = MBDelimitedOnes * '\r';
+    uint64_t quoted = 0;
+    size_t fieldStart = 0, fieldQuotes = 0;
+    bool skipsLineFeed = false;
+
+    if (length && !MBAddRow(table))
+        return false;
+
+    for (size_t block = 0; block < length; block += MBDelimitedBlockSize) {
+        unsigned char padded[MBDelimitedBlockSize];
+        const unsigned char *bytes = text + block;
+        size_t blockLength = length - block < MBDelimitedBlockSize ? length - block : MBDelimitedBlockSize;
+        if (blockLength < MBDelimitedBlockSize) {
+            memset(padded, 0, sizeof(padded));
+            memcpy(padded, bytes, blockLength);
+            bytes = padded;
+        }
+
+        uint64_t quoteMask = 0, structuralMask = 0, returnMask = 0;
+        for (unsigned i = 0; i < MBDelimitedBlockSize / 8; i++) {
+            uint64_t word = MBDelimitedLoadWord(bytes + i * 8);
+            quoteMask |= MBDelimitedMatchingBytes(word, quotes) << (i * 8);
+            structuralMask |= (MBDelimitedMatchingBytes(word, delimiters) | MBDelimitedMatchingBytes(word, lineFeeds)) << (i * 8);
+            returnMask |= MBDelimitedMatchingBytes(word, returns) << (i * 8);
+        }
+
+        // Bytes after an odd number of quotes are inside a quoted field
+        uint64_t inside = MBDelimitedPrefixParity(quoteMask) ^ quoted;
+        quoted = (inside >> 63) ? UINT64_MAX : 0;
+        structuralMask = (structuralMask | returnMask) & ~inside;
+
+        unsigned consumed = 0;
+        while (structuralMask) {
+            unsigned bit = (unsigned)__builtin_ctzll(structuralMask);
+            structuralMask &= structuralMask - 1;
+            size_t position = block + bit;
+            fieldQuotes += (size_t)__builtin_popcountll(quoteMask & (((UINT64_C(1) << bit) - 1) & ~((UINT64_C(1) << consumed) - 1)));
+            consumed = bit + 1;
+
+            // The line feed of a CRLF was ended by its CR
+            if (skipsLineFeed) {
+                skipsLineFeed = false;
+                if (text[position] == '\n' && position == fieldStart) {
+                    fieldStart = position + 1;
+                    continue;
+                }
+            }
+
+            size_t fieldLength = position - fieldStart;
+            if (fieldQuotes) {
+                if (text[fieldStart] != '"' || fieldLength < 2 || text[position - 1] != '"' ||
+                    !MBUnquote(table->text, fieldStart, position, &fieldLength)) {
+                    *needsScalar = true;
+                    return false;
+                }
+            }
+            if (!MBAddField(table, fieldStart, fieldLength))
+                return false;
+            fieldStart = position + 1;
+            fieldQuotes = 0;
+
+            if (text[position] != (unsigned char)delimiter) {
+                skipsLineFeed = (text[position] == '\r');
+                if (position + 1 < length && !(skipsLineFeed && position + 2 == length && text[position + 1] == '\n') &&
+                    !MBAddRow(table))
+                    return false;
+            }
+        }
+        if (consumed < MBDelimitedBlockSize)
+            fieldQuotes += (size_t)__builtin_popcountll(quoteMask & ~((UINT64_C(1) << consumed) - 1));
+    }
+
+    // The last field, unless the text ended with a record separator
+    if (length && fieldStart < length) {
+        size_t fieldLength = length - fieldStart;
+        if (fieldQuotes) {
+            if (text[fieldStart] != '"' || fieldLength < 2 || text[length - 1] != '"' ||
+                !MBUnquote(table->text, fieldStart, length, &fieldLength)) {
+                *needsScalar = true;
+                return false;
+            }
+        }
+        if (!MBAddField(table, fieldStart, fieldLength))
+            return false;
+    } else if (length && fieldStart == length && text[length - 1] == (unsigned char)delimiter) {
+        // A trailing delimiter ends with an empty field
+        if (!MBAddField(table, fieldStart, 0))
+            return false;
+    }
+    return true;
+}
+
+// Splits the text a byte at a time, for text with stray quotes
+static bool MBSplitBytes(MBTableGridDelimitedTable *table, size_t length, char delimiter) {
+    char *text = table->text;
+    size_t i = 0;
+
+    while (i < length) {
+        if (!MBAddRow(table))
+            return false;
+        for (;;) {
+            size_t start = i, written = i;
+            if (i < length && text[i] == '"') {
+                // Quoted up to a quote that isn't doubled, then literal
+                for (i++; i < length; i++) {
+                    if (text[i] == '"') {
+                        if (i + 1 < length && text[i + 1] == '"')
+                            i++;
+                        else
+                            break;
+                    }
+                    text[written++] = text[i];
+                }
+                if (i < length)
+                    i++;
+            }
+            while (i < length && text[i] != delimiter && text[i] != '\n' && text[i] != '\r')
+                text[written++] = text[i++];
+            if (!MBAddField(table, start, written - start))
+                return false;
+
+            // A delimiter, even at the very end, is followed by another field
+            if (i < length && text[i] == delimiter) {
+                i++;
+                continue;
+            }
+            if (i < length && text[i] == '\r' && i + 1 < length && text[i + 1] == '\n')
+                i += 2;
+            else if (i < length)
+                i++;
+            break;
+        }
+    }
+    return true;
+}
+
+static bool MBParseInteger(const char *bytes, size_t length, int64_t *integer) {
+    size_t i = (length && (bytes[0] == '-' || bytes[0] == '+')) ? 1 : 0;
+    if (i == length || length - i > 18)
+        return false;
+    int64_t value = 0;
+    for (size_t j = i; j < length; j++) {
+        if (bytes[j] < '0' || bytes[j] > '9')
+            return false;
+        value = value * 10 + (bytes[j] - '0');
+    }
+    *integer = (bytes[0] == '-') ? -value : value;
+    return true;
+}
+
+static bool MBParseDouble(const char *bytes, size_t length, double *number) {
+    char buffer[64];
+    bool hasDigit = false;
+    if (length == 0 || length >= sizeof(buffer))
+        return false;
+    for (size_t i = 0; i < length; i++) {
+        char c = bytes[i];
+        if (c >= '0' && c <= '9')
+            hasDigit = true;
+        else if (c != '.' && c != '-' && c != '+' && c != 'e' && c != 'E')
+            return false;
+    }
+    if (!hasDigit)
+        return false;
+    memcpy(buffer, bytes, length);
+    buffer[length] = '\0';
+    char *end = NULL;
+    *number = strtod(buffer, &end);
+    return end == buffer + length && isfinite(*number);
+}
+
+static bool MBParseBoolean(const char *bytes, size_t length, bool *boolean) {
+    static const char *const names[2] = { "false", "true" };
+    for (int value = 0; value < 2; value++) {
+        if (length != strlen(names[value]))
+            continue;
+        size_t i = 0;
+        while (i < length && (bytes[i] | 0x20) == names[value][i])
+            i++;
+        if (i == length) {
+            *boolean = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+static MBTableGridValueType MBFieldType(const char *bytes, size_t length) {
+    int64_t integer;
+    double number;
+    bool boolean;
+    if (length == 0)
+        return MBTableGridValueTypeEmpty;
+    if (MBParseInteger(bytes, length, &integer))
+        return MBTableGridValueTypeInteger;
+    if (MBParseDouble(bytes, length, &number))
+        return MBTableGridValueTypeDouble;
+    if (MBParseBoolean(bytes, length, &boolean))
+        return MBTableGridValueTypeBoolean;
+    if (MBTableGridValueParseDate(bytes, length, &number))
+        return MBTableGridValueTypeDate;
+    return MBTableGridValueTypeString;
+}
+
+static MBTableGridValueType MBJoinTypes(MBTableGridValueType column, MBTableGridValueType field) {
+    if (field == MBTableGridValueTypeEmpty || field == column)
+        return column;
+    if (column == MBTableGridValueTypeEmpty)
+        return field;
+    if ((column == MBTableGridValueTypeInteger && field == MBTableGridValueTypeDouble) ||
+        (column == MBTableGridValueTypeDouble && field == MBTableGridValueTypeInteger))
+        return MBTableGridValueTypeDouble;
+    return MBTableGridValueTypeString;
+}
+
+static bool MBGuessColumnTypes(MBTableGridDelimitedTable *table) {
+    size_t columnCount = 0;
+    for (size_t row = 0; row < table->rowCount; row++) {
+        size_t count = table->rows[row + 1] - table->rows[row];
+        if (count > columnCount)
+            columnCount = count;
+    }
+    table->columnCount = columnCount;
+    if ((table->columnTypes = calloc(columnCount ? columnCount : 1, sizeof(MBTableGridValueType))) == NULL)
+        return false;
+
+    for (size_t row = 0; row < table->rowCount; row++) {
+        for (size_t i = table->rows[row], column = 0; i < table->rows[row + 1]; i++, column++) {
+            table->columnTypes[column] = MBTableGridDelimitedColumnTypeAddField(table->columnTypes[column],
+                                                                               table->text + table->fields[i].offset,
+                                                                               table->fields[i].length);
+        }
+    }
+    for (size_t column = 0; column < columnCount; column++) {
+        if (table->columnTypes[column] == MBTableGridValueTypeEmpty)
+            table->columnTypes[column] = MBTableGridValueTypeString;
+    }
+    return true;
+}
+
+MBTableGridValueType MBTableGridDelimitedColumnTypeAddField(MBTableGridValueType columnType, const char *bytes, size_t length) {
+    // Once a column holds strings, nothing else can change it
+    if (columnType == MBTableGridValueTypeString)
+        return columnType;
+    return MBJoinTypes(columnType, MBFieldType(bytes, length));
+}
+
+MBTableGridValue MBTableGridDelimitedFieldValue(const char *bytes, size_t length, MBTableGridValueType columnType) {
+    int64_t integer = 0;
+    double number = 0;
+    bool boolean = false;
+
+    if (length == 0)
+        return (MBTableGridValue){ .type = MBTableGridValueTypeEmpty };
+    if (columnType == MBTableGridValueTypeInteger && MBParseInteger(bytes, length, &integer))
+        return MBTableGridValueMakeInteger(integer);
+    if (columnType == MBTableGridValueTypeDouble && MBParseInteger(bytes, length, &integer))
+        return MBTableGridValueMakeDouble((double)integer);
+    if (columnType == MBTableGridValueTypeDouble && MBParseDouble(bytes, length, &number))
+        return MBTableGridValueMakeDouble(number);
+    if (columnType == MBTableGridValueTypeBoolean && MBParseBoolean(bytes, length, &boolean))
+        return MBTableGridValueMakeBoolean(boolean);
+    if (columnType == MBTableGridValueTypeDate && MBTableGridValueParseDate(bytes, length, &number))
+        return MBTableGridValueMakeDate(number);
+    return MBTableGridValueMakeString(bytes, length);
+}
+
+MBTableGridDelimitedFormat MBTableGridDelimitedFormatGuess(const char *text, size_t length) {
+    bool quoted = false, hasComma = false;
+    for (size_t i = 0; i < length; i++) {
+        if (text[i] == '"')
+            quoted = !quoted;
+        else if (quoted)
+            continue;
+        else if (text[i] == '\t')
+            return MBTableGridDelimitedFormatTabSeparated;
+        else if (text[i] == ',')
+            hasComma = true;
+        else if (text[i] == '\n' || text[i] == '\r')
+            break;
+    }
+    return hasComma ? MBTableGridDelimitedFormatCommaSeparated : MBTableGridDelimitedFormatTabSeparated;
+}
+
+MBTableGridDelimitedTable *MBTableGridDelimitedTableCreate(const char *text, size_t length, MBTableGridDelimitedFormat format) {
+    char delimiter = (format == MBTableGridDelimitedFormatCommaSeparated) ? ',' : '\t';
+    bool needsScalar = false;
+    if (length >= UINT32_MAX)
+        return NULL;
+
+    MBTableGridDelimitedTable *table = calloc(1, sizeof(MBTableGridDelimitedTable));
+    if (table == NULL)
+        return NULL;
+    if ((table->text = malloc(length ? length : 1)) == NULL) {
+        free(table);
+        return NULL;
+    }
+    memcpy(table->text, text, length);
+
+    bool split = MBSplitBlocks(table, length, delimiter, &needsScalar);
+    if (!split && needsScalar) {
+        // Start again from the original text, since unquoting rewrote the copy
+        memcpy(table->text, text, length);
+        table->fieldCount = 0;
+        table->rowCount = 0;
+        split = MBSplitBytes(table, length, delimiter);
+    }
+    // Close off the last record
+    if (split && table->rowCount && !MBAddRow(table))
+        split = false;
+    if (split && table->rowCount)
+        table->rowCount--;
+
+    if (!split || !MBGuessColumnTypes(table)) {
+        MBTableGridDelimitedTableDestroy(table);
+        return NULL;
+    }
+    return table;
+}
+
+void MBTableGridDelimitedTableDestroy(MBTableGridDelimitedTable *table) {
+    if (table == NULL)
+        return;
+    free(table->text);
+    free(table->fields);
+    free(table->rows);
+    free(table->columnTypes);
+    free(table);
+}
+
+size_t MBTableGridDelimitedTableRowCount(const MBTableGridDelimitedTable *table) {
+    return table->rowCount;
+}
+
+size_t MBTableGridDelimitedTableColumnCount(const MBTableGridDelimitedTable *table) {
+    return table->columnCount;
+}
+
+const char *MBTableGridDelimitedTableGetField(const MBTableGridDelimitedTable *table, size_t columnIndex,
+                                              size_t rowIndex, size_t *length) {
+    size_t i = table->rows[rowIndex] + columnIndex;
+    if (i >= table->rows[rowIndex + 1]) {
+        *length = 0;
+        return "";
+    }
+    *length = table->fields[i].length;
+    return table->text + table->fields[i].offset;
+}
+
+MBTableGridValueType MBTableGridDelimitedTableColumnType(const MBTableGridDelimitedTable *table, size_t columnIndex) {
+    return table->columnTypes[columnIndex];
+}
+
+void MBTableGridDelimitedTableGetValues(const MBTableGridDelimitedTable *table, MBTableGridValue *values,
+                                        size_t firstColumn, size_t columnCount, size_t firstRow, size_t rowCount) {
+    for (size_t i = 0; i < columnCount; i++) {
+        MBTableGridValueType type = table->columnTypes[firstColumn + i];
+        for (size_t j = 0; j < rowCount; j++) {
+            size_t length = 0;
+            const char *bytes = MBTableGridDelimitedTableGetField(table, firstColumn + i, firstRow + j, &length);
+            values[i * rowCount + j] = MBTableGridDelimitedFieldValue(bytes, length, type);
+        }
+    }
+}
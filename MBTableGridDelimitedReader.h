@@ -0,0 +1,128 @@
+//
+//  MBTableGridDelimitedReader.h
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#ifndef MBTableGridDelimitedReader_h
+#define MBTableGridDelimitedReader_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "MBTableGridValue.h"
+#include "MBTableGridDelimitedWriter.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief		\c MBTableGridDelimitedTable holds tab- or comma-separated
+ *				text split into records and fields.
+ *
+ * @details		Fields may be quoted as in RFC 4180, with doubled quotes
+ *				standing for quotes, so that they can hold delimiters and
+ *				line breaks. Records may end with LF, CRLF or CR, and a
+ *				separator at the very end doesn't start another record.
+ *				Quotes anywhere but at the start of a field are taken
+ *				literally, as spreadsheets do.
+ *
+ *				Text is split a 64-byte block at a time: the delimiters,
+ *				quotes and line breaks in each block are found as bit masks
+ *				eight bytes at a time, the masks of quoted bytes follow from
+ *				a running parity of the quotes, and only the delimiters and
+ *				line breaks outside quotes are visited. Text with stray
+ *				quotes, which the masks would misread, is split again a
+ *				byte at a time.
+ *
+ *				Each column's type is guessed from its fields: integers,
+ *				decimal numbers, Booleans, dates, or else strings.
+ *
+ *				The table is plain C so that it can be built and measured
+ *				away from AppKit. It is immutable once created, and may be
+ *				read from several threads at once.
+ */
+typedef struct MBTableGridDelimitedTable MBTableGridDelimitedTable;
+
+/**
+ * @brief		Guesses the format of some text from its first record: tab
+ *				separated if it has a tab outside quotes, else comma
+ *				separated if it has a comma, else tab separated.
+ */
+MBTableGridDelimitedFormat MBTableGridDelimitedFormatGuess(const char *text, size_t length);
+
+/**
+ * @brief		Widens a column's guessed type to fit one more unquoted
+ *				field. A column starts as \c MBTableGridValueTypeEmpty, and
+ *				is \c MBTableGridValueTypeString if it is still empty at the
+ *				end.
+ */
+MBTableGridValueType MBTableGridDelimitedColumnTypeAddField(MBTableGridValueType columnType, const char *bytes, size_t length);
+
+/**
+ * @brief		Returns an unquoted field as a value of its column's type,
+ *				or as a string borrowing \c bytes if it doesn't parse as
+ *				one. An empty field is an empty value.
+ */
+MBTableGridValue MBTableGridDelimitedFieldValue(const char *bytes, size_t length, MBTableGridValueType columnType);
+
+/**
+ * @brief		Splits \c length bytes of UTF-8 text, which is copied.
+ *
+ * @return		The table, or \c NULL if out of memory or the text is 4GB
+ *				or longer.
+ */
+MBTableGridDelimitedTable *MBTableGridDelimitedTableCreate(const char *text, size_t length, MBTableGridDelimitedFormat format);
+
+/**
+ * @brief		Frees a table created with \c MBTableGridDelimitedTableCreate.
+ */
+void MBTableGridDelimitedTableDestroy(MBTableGridDelimitedTable *table);
+
+/**
+ * @brief		Returns the number of records.
+ */
+size_t MBTableGridDelimitedTableRowCount(const MBTableGridDelimitedTable *table);
+
+/**
+ * @brief		Returns the number of fields in the longest record.
+ */
+size_t MBTableGridDelimitedTableColumnCount(const MBTableGridDelimitedTable *table);
+
+/**
+ * @brief		Returns the unquoted text of a field, which remains valid
+ *				for the life of the table, with its length in \c length.
+ *				Fields missing from the end of a short record are empty.
+ */
+const char *MBTableGridDelimitedTableGetField(const MBTableGridDelimitedTable *table, size_t columnIndex,
+                                              size_t rowIndex, size_t *length);
+
+/**
+ * @brief		Returns the type guessed for a column: the narrowest of
+ *				\c MBTableGridValueTypeInteger, \c MBTableGridValueTypeDouble,
+ *				\c MBTableGridValueTypeBoolean and \c MBTableGridValueTypeDate
+ *				that fits every non-empty field, or else
+ *				\c MBTableGridValueTypeString.
+ */
+MBTableGridValueType MBTableGridDelimitedTableColumnType(const MBTableGridDelimitedTable *table, size_t columnIndex);
+
+/**
+ * @brief		Fills in the values of a block of fields, typed as their
+ *				columns are, in column-first order: the value for column
+ *				<tt>firstColumn + i</tt> and row <tt>firstRow + j</tt> goes
+ *				in <tt>values[i * rowCount + j]</tt>.
+ *
+ * @details		Empty fields become empty values. Strings are borrowed from
+ *				the table. The block must lie within the table.
+ */
+void MBTableGridDelimitedTableGetValues(const MBTableGridDelimitedTable *table, MBTableGridValue *values,
+                                        size_t firstColumn, size_t columnCount, size_t firstRow, size_t rowCount);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MBTableGridDelimitedReader_h */
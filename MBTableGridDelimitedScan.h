@@ -0,0 +1,58 @@
+//
+//  MBTableGridDelimitedScan.h
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#ifndef MBTableGridDelimitedScan_h
+#define MBTableGridDelimitedScan_h
+
+#include <stdint.h>
+#include <string.h>
+
+/* Word-at-a-time helpers shared by the delimited text parsers. Each finds the
+   bytes of interest in a 64-byte block as one bit per byte, with the first
+   byte lowest, so that a block is scanned with a few word operations. */
+
+#define MBDelimitedBlockSize 64
+#define MBDelimitedOnes UINT64_C(0x0101010101010101)
+#define MBDelimitedLowBits UINT64_C(0x7F7F7F7F7F7F7F7F)
+
+static inline uint64_t MBDelimitedLoadWord(const unsigned char *bytes) {
+    uint64_t word;
+    memcpy(&word, bytes, sizeof(word));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    word = __builtin_bswap64(word);
+#endif
+    return word;
+}
+
+// One bit for each byte of the word equal to the byte in pattern, with the first byte lowest
+static inline uint64_t MBDelimitedMatchingBytes(uint64_t word, uint64_t pattern) {
+    uint64_t difference = word ^ pattern;
+    uint64_t zeros = ~(((difference & MBDelimitedLowBits) + MBDelimitedLowBits) | difference | MBDelimitedLowBits);
+    // Gather the high bit of each byte into the top byte
+    return ((zeros >> 7) * UINT64_C(0x0102040810204080)) >> 56;
+}
+
+// One bit for each byte of a block equal to the byte in pattern
+static inline uint64_t MBDelimitedMatchingBlockBytes(const unsigned char *block, uint64_t pattern) {
+    uint64_t mask = 0;
+    for (unsigned i = 0; i < MBDelimitedBlockSize / 8; i++)
+        mask |= MBDelimitedMatchingBytes(MBDelimitedLoadWord(block + i * 8), pattern) << (i * 8);
+    return mask;
+}
+
+// Each bit becomes the parity of itself and every bit below it
+static inline uint64_t MBDelimitedPrefixParity(uint64_t bits) {
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+#endif /* MBTableGridDelimitedScan_h */
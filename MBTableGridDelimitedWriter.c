@@ -0,0 +1,169 @@
+//
+//  MBTableGridDelimitedWriter.c
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#include "MBTableGridDelimitedWriter.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define MBBufferCapacity 65536
+
+struct MBTableGridDelimitedWriter {
+    MBTableGridDelimitedWriterOutput output;
+    void *context;
+    char *buffer;
+    size_t length;
+    uint64_t bytesWritten;
+    bool failed;
+
+    char fieldSeparator;
+    const char *recordSeparator;
+    size_t recordSeparatorLength;
+    bool terminatesRecords;
+
+    /* Fields written in the current record, and whether a previous record
+       still needs separating from it */
+    size_t fieldCount;
+    bool needsRecordSeparator;
+};
+
+MBTableGridDelimitedWriter *MBTableGridDelimitedWriterCreate(MBTableGridDelimitedFormat format, bool terminatesRecords,
+                                                             MBTableGridDelimitedWriterOutput output, void *context) {
+    MBTableGridDelimitedWriter *writer = calloc(1, sizeof(MBTableGridDelimitedWriter));
+    if (writer == NULL)
+        return NULL;
+    if ((writer->buffer = malloc(MBBufferCapacity)) == NULL) {
+        free(writer);
+        return NULL;
+    }
+    writer->output = output;
+    writer->context = context;
+    writer->terminatesRecords = terminatesRecords;
+    if (format == MBTableGridDelimitedFormatCommaSeparated) {
+        writer->fieldSeparator = ',';
+        writer->recordSeparator = "\r\n";
+    } else {
+        writer->fieldSeparator = '\t';
+        writer->recordSeparator = "\n";
+    }
+    writer->recordSeparatorLength = strlen(writer->recordSeparator);
+    return writer;
+}
+
+void MBTableGridDelimitedWriterDestroy(MBTableGridDelimitedWriter *writer) {
+    if (writer == NULL)
+        return;
+    free(writer->buffer);
+    free(writer);
+}
+
+bool MBTableGridDelimitedWriterFlush(MBTableGridDelimitedWriter *writer) {
+    if (writer->failed)
+        return false;
+    if (writer->length) {
+        if (!writer->output(writer->context, writer->buffer, writer->length)) {
+            writer->failed = true;
+            return false;
+        }
+        writer->bytesWritten += writer->length;
+        writer->length = 0;
+    }
+    return true;
+}
+
+static bool MBAppend(MBTableGridDelimitedWriter *writer, const char *bytes, size_t length) {
+    while (length) {
+        if (writer->length == MBBufferCapacity && !MBTableGridDelimitedWriterFlush(writer))
+            return false;
+        size_t count = MBBufferCapacity - writer->length;
+        if (count > length)
+            count = length;
+        memcpy(writer->buffer + writer->length, bytes, count);
+        writer->length += count;
+        bytes += count;
+        length -= count;
+    }
+    return !writer->failed;
+}
+
+static bool MBAppendByte(MBTableGridDelimitedWriter *writer, char byte) {
+    if (writer->length == MBBufferCapacity && !MBTableGridDelimitedWriterFlush(writer))
+        return false;
+    writer->buffer[writer->length++] = byte;
+    return !writer->failed;
+}
+
+bool MBTableGridDelimitedWriterWriteField(MBTableGridDelimitedWriter *writer, const char *text, size_t length) {
+    if (writer->fieldCount > 0) {
+        if (!MBAppendByte(writer, writer->fieldSeparator))
+            return false;
+    } else if (writer->needsRecordSeparator) {
+        if (!MBAppend(writer, writer->recordSeparator, writer->recordSeparatorLength))
+            return false;
+        writer->needsRecordSeparator = false;
+    }
+    writer->fieldCount++;
+
+    bool needsQuotes = false;
+    for (size_t i = 0; i < length && !needsQuotes; i++) {
+        char c = text[i];
+        needsQuotes = (c == writer->fieldSeparator || c == '"' || c == '\n' || c == '\r');
+    }
+    if (!needsQuotes)
+        return MBAppend(writer, text, length);
+
+    // Copy the text a stretch at a time, doubling each quote
+    if (!MBAppendByte(writer, '"'))
+        return false;
+    for (const char *end = text + length; text < end; ) {
+        const char *quote = memchr(text, '"', (size_t)(end - text));
+        size_t count = quote ? (size_t)(quote - text) + 1 : (size_t)(end - text);
+        if (!MBAppend(writer, text, count) || (quote && !MBAppendByte(writer, '"')))
+            return false;
+        text += count;
+    }
+    return MBAppendByte(writer, '"');
+}
+
+bool MBTableGridDelimitedWriterWriteValue(MBTableGridDelimitedWriter *writer, const MBTableGridValue *value) {
+    char scratch[MBTableGridValueFormatCapacity];
+    size_t length = 0;
+    const char *text = MBTableGridValueGetUTF8(value, scratch, &length);
+    return MBTableGridDelimitedWriterWriteField(writer, text, length);
+}
+
+bool MBTableGridDelimitedWriterEndRecord(MBTableGridDelimitedWriter *writer) {
+    // A record without fields is still a record, if only an empty line
+    if (writer->fieldCount == 0 && writer->needsRecordSeparator) {
+        if (!MBAppend(writer, writer->recordSeparator, writer->recordSeparatorLength))
+            return false;
+    }
+    writer->fieldCount = 0;
+    writer->needsRecordSeparator = true;
+    if (writer->terminatesRecords) {
+        writer->needsRecordSeparator = false;
+        return MBAppend(writer, writer->recordSeparator, writer->recordSeparatorLength);
+    }
+    return !writer->failed;
+}
+
+bool MBTableGridDelimitedWriterWriteValues(MBTableGridDelimitedWriter *writer, const MBTableGridValue *values,
+                                           size_t columnCount, size_t rowCount) {
+    for (size_t i = 0; i < rowCount; i++) {
+        for (size_t j = 0; j < columnCount; j++) {
+            if (!MBTableGridDelimitedWriterWriteValue(writer, &values[j * rowCount + i]))
+                return false;
+        }
+        if (!MBTableGridDelimitedWriterEndRecord(writer))
+            return false;
+    }
+    return true;
+}
+
+uint64_t MBTableGridDelimitedWriterBytesWritten(const MBTableGridDelimitedWriter *writer) {
+    return writer->bytesWritten;
+}
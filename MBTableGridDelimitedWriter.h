@@ -0,0 +1,114 @@
+//
+//  MBTableGridDelimitedWriter.h
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#ifndef MBTableGridDelimitedWriter_h
+#define MBTableGridDelimitedWriter_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "MBTableGridValue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum MBTableGridDelimitedFormat {
+    /* Tabs between fields and line feeds between records, as copied to the
+       pasteboard */
+    MBTableGridDelimitedFormatTabSeparated,
+    /* Commas between fields and CRLF between records, as in RFC 4180 */
+    MBTableGridDelimitedFormatCommaSeparated
+} MBTableGridDelimitedFormat;
+
+/**
+ * @brief		Receives the writer's output a buffer at a time. Returns
+ *				\c false to stop writing, for example when a write fails.
+ */
+typedef bool (*MBTableGridDelimitedWriterOutput)(void *context, const char *bytes, size_t length);
+
+/**
+ * @brief		\c MBTableGridDelimitedWriter writes cells as delimited
+ *				UTF-8 text, buffering it and handing it to an output
+ *				function in large pieces.
+ *
+ * @details		Fields containing the field delimiter, a double quote or a
+ *				line break are quoted, with their double quotes doubled, so
+ *				that any text survives a round trip through a parser that
+ *				follows RFC 4180. Other fields are written as they are.
+ *
+ *				The writer is plain C so that it can be built and measured
+ *				away from AppKit. It is not thread-safe, but needn't be used
+ *				on the thread that created it.
+ */
+typedef struct MBTableGridDelimitedWriter MBTableGridDelimitedWriter;
+
+/**
+ * @brief		Creates a writer. Returns \c NULL if out of memory.
+ *
+ * @param		format				The delimiters to write.
+ * @param		terminatesRecords	Whether to end the last record with a
+ *									record separator, as files usually do,
+ *									or only to separate records, as text
+ *									on the pasteboard usually does.
+ * @param		output				Called with each buffer of text.
+ * @param		context				Passed to \c output.
+ */
+MBTableGridDelimitedWriter *MBTableGridDelimitedWriterCreate(MBTableGridDelimitedFormat format, bool terminatesRecords,
+                                                             MBTableGridDelimitedWriterOutput output, void *context);
+
+/**
+ * @brief		Frees a writer created with \c MBTableGridDelimitedWriterCreate,
+ *				discarding any text not yet flushed.
+ */
+void MBTableGridDelimitedWriterDestroy(MBTableGridDelimitedWriter *writer);
+
+/**
+ * @brief		Writes the next field of the current record.
+ *
+ * @return		\c false if the output function has failed, now or before.
+ */
+bool MBTableGridDelimitedWriterWriteField(MBTableGridDelimitedWriter *writer, const char *text, size_t length);
+
+/**
+ * @brief		Writes a value as the next field, in the text form given by
+ *				\c MBTableGridValueGetUTF8.
+ */
+bool MBTableGridDelimitedWriterWriteValue(MBTableGridDelimitedWriter *writer, const MBTableGridValue *value);
+
+/**
+ * @brief		Ends the current record. The next field starts a new one.
+ */
+bool MBTableGridDelimitedWriterEndRecord(MBTableGridDelimitedWriter *writer);
+
+/**
+ * @brief		Writes a block of values as \c rowCount records of
+ *				\c columnCount fields each.
+ *
+ * @details		The values are in column-first order, as the grid fetches
+ *				them: the value for column \c j of row \c i is at
+ *				\c values[j * rowCount + i].
+ */
+bool MBTableGridDelimitedWriterWriteValues(MBTableGridDelimitedWriter *writer, const MBTableGridValue *values,
+                                           size_t columnCount, size_t rowCount);
+
+/**
+ * @brief		Hands any buffered text to the output function.
+ */
+bool MBTableGridDelimitedWriterFlush(MBTableGridDelimitedWriter *writer);
+
+/**
+ * @brief		Returns the number of bytes handed to the output function.
+ */
+uint64_t MBTableGridDelimitedWriterBytesWritten(const MBTableGridDelimitedWriter *writer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MBTableGridDelimitedWriter_h */
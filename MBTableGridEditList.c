@@ -0,0 +1,103 @@
+//
+//  MBTableGridEditList.c
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#include "MBTableGridEditList.h"
+
+#include <stdlib.h>
+
+struct MBTableGridEditList {
+    MBTableGridEditRun *runs;
+    size_t count;
+    size_t capacity;
+    uint64_t cellCount;
+    bool isSorted;
+};
+
+MBTableGridEditList *MBTableGridEditListCreate(void) {
+    MBTableGridEditList *list = calloc(1, sizeof(MBTableGridEditList));
+    if (list)
+        list->isSorted = true;
+    return list;
+}
+
+void MBTableGridEditListDestroy(MBTableGridEditList *list) {
+    if (list == NULL)
+        return;
+    free(list->runs);
+    free(list);
+}
+
+void MBTableGridEditListClear(MBTableGridEditList *list) {
+    list->count = 0;
+    list->cellCount = 0;
+    list->isSorted = true;
+}
+
+bool MBTableGridEditListAppend(MBTableGridEditList *list, uint64_t location, uint64_t length, uint32_t value) {
+    if (length == 0)
+        return true;
+    if (list->count) {
+        MBTableGridEditRun *last = &list->runs[list->count - 1];
+        if (last->value == value && last->location + last->length == location) {
+            last->length += length;
+            list->cellCount += length;
+            return true;
+        }
+        if (location < last->location + last->length)
+            list->isSorted = false;
+    }
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity ? list->capacity * 2 : 64;
+        MBTableGridEditRun *runs = realloc(list->runs, capacity * sizeof(MBTableGridEditRun));
+        if (runs == NULL)
+            return false;
+        list->runs = runs;
+        list->capacity = capacity;
+    }
+    list->runs[list->count++] = (MBTableGridEditRun){ location, length, value };
+    list->cellCount += length;
+    return true;
+}
+
+static int MBCompareRuns(const void *a, const void *b) {
+    const MBTableGridEditRun *left = a, *right = b;
+    return left->location < right->location ? -1 : left->location > right->location;
+}
+
+const MBTableGridEditRun *MBTableGridEditListGetRuns(MBTableGridEditList *list, size_t *count) {
+    if (!list->isSorted) {
+        size_t merged = 0;
+        qsort(list->runs, list->count, sizeof(MBTableGridEditRun), MBCompareRuns);
+        for (size_t i = 0; i < list->count; i++) {
+            MBTableGridEditRun run = list->runs[i];
+            if (merged) {
+                MBTableGridEditRun *last = &list->runs[merged - 1];
+                uint64_t lastEnd = last->location + last->length;
+                // Trim whatever an earlier run already covers
+                if (run.location < lastEnd) {
+                    if (run.location + run.length <= lastEnd)
+                        continue;
+                    run.length -= lastEnd - run.location;
+                    run.location = lastEnd;
+                }
+                if (run.location == lastEnd && run.value == last->value) {
+                    last->length += run.length;
+                    continue;
+                }
+            }
+            list->runs[merged++] = run;
+        }
+        list->count = merged;
+        list->isSorted = true;
+    }
+    *count = list->count;
+    return list->runs;
+}
+
+uint64_t MBTableGridEditListCellCount(const MBTableGridEditList *list) {
+    return list->cellCount;
+}
@@ -0,0 +1,86 @@
+//
+//  MBTableGridEditList.h
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#ifndef MBTableGridEditList_h
+#define MBTableGridEditList_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief		A run of consecutive cells, numbered in column-first order,
+ *				that all take the same new value. The value is an index into
+ *				whatever list of values the caller keeps.
+ */
+typedef struct MBTableGridEditRun {
+    uint64_t location;
+    uint64_t length;
+    uint32_t value;
+} MBTableGridEditRun;
+
+/**
+ * @brief		\c MBTableGridEditList collects edits to many cells as runs,
+ *				so that they can be checked and applied a block at a time.
+ *
+ * @details		Edits to the cell just after the previous edit, with the
+ *				same value, extend the previous run, so edits arriving in
+ *				order, as they do from a replace-all, take constant space
+ *				per run rather than per cell.
+ */
+typedef struct MBTableGridEditList MBTableGridEditList;
+
+/**
+ * @brief		Creates an empty list. Returns \c NULL if out of memory.
+ */
+MBTableGridEditList *MBTableGridEditListCreate(void);
+
+/**
+ * @brief		Frees a list created with \c MBTableGridEditListCreate.
+ */
+void MBTableGridEditListDestroy(MBTableGridEditList *list);
+
+/**
+ * @brief		Removes every run, keeping the allocated storage.
+ */
+void MBTableGridEditListClear(MBTableGridEditList *list);
+
+/**
+ * @brief		Records that \c length cells from \c location take \c value.
+ *
+ * @return		\c false if out of memory, in which case the edit is lost.
+ */
+bool MBTableGridEditListAppend(MBTableGridEditList *list, uint64_t location, uint64_t length, uint32_t value);
+
+/**
+ * @brief		Sorts the runs by location and merges neighbours with the
+ *				same value.
+ *
+ * @details		Runs aren't expected to overlap. If they do, cells covered
+ *				by more than one run keep the value of the run that starts
+ *				first. The list may be appended to again afterwards.
+ *
+ * @return		The runs, which remain valid until the list next changes,
+ *				with their number in \c count.
+ */
+const MBTableGridEditRun *MBTableGridEditListGetRuns(MBTableGridEditList *list, size_t *count);
+
+/**
+ * @brief		Returns the number of cells covered by runs appended since
+ *				the list was last cleared, counting overlaps more than once.
+ */
+uint64_t MBTableGridEditListCellCount(const MBTableGridEditList *list);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MBTableGridEditList_h */
@@ -0,0 +1,289 @@
+//
+//  MBTableGridFilter.c
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#include "MBTableGridFilter.h"
+#include "MBTableGridFind.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Values a negation tests at a time, with the result of its condition on the stack
+#define MBNegationChunkSize 1024
+
+typedef enum MBConditionKind {
+    MBConditionKindEquals = 0,
+    MBConditionKindRange,
+    MBConditionKindContains,
+    MBConditionKindIsEmpty,
+    MBConditionKindNegation
+} MBConditionKind;
+
+struct MBTableGridFilterCondition {
+    MBConditionKind kind;
+
+    // The value compared with, for equality; a string is kept in bytes,
+    // lowercased if ignoring case
+    MBTableGridValueType type;
+    int64_t integer;
+    double number;
+    bool boolean;
+    bool ignoresCase;
+
+    double minimum;
+    double maximum;
+
+    // NULL for an empty string, which every value but an empty one contains
+    MBTableGridFindPattern *pattern;
+
+    MBTableGridFilterCondition *condition;
+
+    size_t length;
+    char bytes[];
+};
+
+static inline unsigned char MBLowercase(unsigned char c) {
+    return (c >= 'A' && c <= 'Z') ? (unsigned char)(c | 0x20) : c;
+}
+
+static MBTableGridFilterCondition *MBCreateCondition(MBConditionKind kind, size_t length) {
+    MBTableGridFilterCondition *condition = calloc(1, sizeof(MBTableGridFilterCondition) + length);
+    if (condition == NULL)
+        return NULL;
+    condition->kind = kind;
+    condition->length = length;
+    return condition;
+}
+
+MBTableGridFilterCondition *MBTableGridFilterConditionCreateEquals(const MBTableGridValue *value, bool ignoresCase) {
+    size_t length = (value->type == MBTableGridValueTypeString) ? value->data.string.length : 0;
+    MBTableGridFilterCondition *condition = MBCreateCondition(MBConditionKindEquals, length);
+    if (condition == NULL)
+        return NULL;
+    condition->type = value->type;
+    condition->ignoresCase = ignoresCase;
+    switch (value->type) {
+        case MBTableGridValueTypeInteger:
+            condition->integer = value->data.integer;
+            condition->number = (double)value->data.integer;
+            break;
+        case MBTableGridValueTypeDouble:
+        case MBTableGridValueTypeDate:
+            condition->number = value->data.number;
+            break;
+        case MBTableGridValueTypeBoolean:
+            condition->boolean = value->data.boolean;
+            break;
+        case MBTableGridValueTypeString:
+            for (size_t i = 0; i < length; i++) {
+                unsigned char c = (unsigned char)value->data.string.bytes[i];
+                condition->bytes[i] = (char)(ignoresCase ? MBLowercase(c) : c);
+            }
+            break;
+        case MBTableGridValueTypeEmpty:
+            break;
+        default:
+            // Pending is taken to mean "not loaded yet", which nothing equals
+            condition->type = MBTableGridValueTypePending;
+            break;
+    }
+    return condition;
+}
+
+MBTableGridFilterCondition *MBTableGridFilterConditionCreateRange(double minimum, double maximum) {
+    MBTableGridFilterCondition *condition = MBCreateCondition(MBConditionKindRange, 0);
+    if (condition == NULL)
+        return NULL;
+    condition->minimum = minimum;
+    condition->maximum = maximum;
+    return condition;
+}
+
+MBTableGridFilterCondition *MBTableGridFilterConditionCreateContains(const char *bytes, size_t length, bool ignoresCase) {
+    MBTableGridFilterCondition *condition = MBCreateCondition(MBConditionKindContains, 0);
+    if (condition == NULL)
+        return NULL;
+    if (length) {
+        condition->pattern = MBTableGridFindPatternCreate(bytes, length, ignoresCase);
+        if (condition->pattern == NULL) {
+            free(condition);
+            return NULL;
+        }
+    }
+    return condition;
+}
+
+MBTableGridFilterCondition *MBTableGridFilterConditionCreateIsEmpty(void) {
+    return MBCreateCondition(MBConditionKindIsEmpty, 0);
+}
+
+MBTableGridFilterCondition *MBTableGridFilterConditionCreateNegation(MBTableGridFilterCondition *negatedCondition) {
+    if (negatedCondition == NULL)
+        return NULL;
+    MBTableGridFilterCondition *condition = MBCreateCondition(MBConditionKindNegation, 0);
+    if (condition == NULL) {
+        MBTableGridFilterConditionDestroy(negatedCondition);
+        return NULL;
+    }
+    condition->condition = negatedCondition;
+    return condition;
+}
+
+void MBTableGridFilterConditionDestroy(MBTableGridFilterCondition *condition) {
+    if (condition == NULL)
+        return;
+    MBTableGridFindPatternDestroy(condition->pattern);
+    MBTableGridFilterConditionDestroy(condition->condition);
+    free(condition);
+}
+
+static bool MBEqualsString(const MBTableGridFilterCondition *condition, const char *bytes, size_t length) {
+    if (length != condition->length)
+        return false;
+    if (!condition->ignoresCase)
+        return memcmp(bytes, condition->bytes, length) == 0;
+    for (size_t i = 0; i < length; i++) {
+        if (MBLowercase((unsigned char)bytes[i]) != (unsigned char)condition->bytes[i])
+            return false;
+    }
+    return true;
+}
+
+static void MBMarkEquals(const MBTableGridFilterCondition *condition, const MBTableGridValue *values, size_t count, unsigned char *matches) {
+    switch (condition->type) {
+        case MBTableGridValueTypeInteger:
+        case MBTableGridValueTypeDouble: {
+            // Integers compare exactly with an integer, and otherwise as doubles
+            bool integral = (condition->type == MBTableGridValueTypeInteger);
+            int64_t integer = condition->integer;
+            double number = condition->number;
+            for (size_t i = 0; i < count; i++) {
+                MBTableGridValueType type = values[i].type;
+                double value = (type == MBTableGridValueTypeInteger) ? (double)values[i].data.integer : values[i].data.number;
+                bool equal = (integral & (type == MBTableGridValueTypeInteger)) ? (values[i].data.integer == integer) : (value == number);
+                matches[i] &= (type == MBTableGridValueTypePending) |
+                              (((type == MBTableGridValueTypeInteger) | (type == MBTableGridValueTypeDouble)) & equal);
+            }
+            break;
+        }
+        case MBTableGridValueTypeDate: {
+            double number = condition->number;
+            for (size_t i = 0; i < count; i++) {
+                MBTableGridValueType type = values[i].type;
+                matches[i] &= (type == MBTableGridValueTypePending) |
+                              ((type == MBTableGridValueTypeDate) & (values[i].data.number == number));
+            }
+            break;
+        }
+        case MBTableGridValueTypeBoolean: {
+            bool boolean = condition->boolean;
+            for (size_t i = 0; i < count; i++) {
+                MBTableGridValueType type = values[i].type;
+                // Read as a byte, since other types leave bytes in it that aren't valid bools
+                bool value = *(const unsigned char *)&values[i].data.boolean != 0;
+                matches[i] &= (type == MBTableGridValueTypePending) | ((type == MBTableGridValueTypeBoolean) & (value == boolean));
+            }
+            break;
+        }
+        case MBTableGridValueTypeString:
+            for (size_t i = 0; i < count; i++) {
+                if (!matches[i] || values[i].type == MBTableGridValueTypePending)
+                    continue;
+                matches[i] = (values[i].type == MBTableGridValueTypeString &&
+                              MBEqualsString(condition, values[i].data.string.bytes, values[i].data.string.length));
+            }
+            break;
+        case MBTableGridValueTypeEmpty:
+            for (size_t i = 0; i < count; i++) {
+                MBTableGridValueType type = values[i].type;
+                matches[i] &= (type == MBTableGridValueTypePending) | (type == MBTableGridValueTypeEmpty);
+            }
+            break;
+        default:
+            // Only pending values, which satisfy every condition, are left
+            for (size_t i = 0; i < count; i++)
+                matches[i] &= (values[i].type == MBTableGridValueTypePending);
+            break;
+    }
+}
+
+static void MBMarkRange(const MBTableGridFilterCondition *condition, const MBTableGridValue *values, size_t count, unsigned char *matches) {
+    double minimum = condition->minimum, maximum = condition->maximum;
+    for (size_t i = 0; i < count; i++) {
+        MBTableGridValueType type = values[i].type;
+        double value = (type == MBTableGridValueTypeInteger) ? (double)values[i].data.integer : values[i].data.number;
+        bool numeric = (type == MBTableGridValueTypeInteger) | (type == MBTableGridValueTypeDouble) | (type == MBTableGridValueTypeDate);
+        matches[i] &= (type == MBTableGridValueTypePending) | (numeric & (value >= minimum) & (value <= maximum));
+    }
+}
+
+static void MBMarkContains(const MBTableGridFilterCondition *condition, const MBTableGridValue *values, size_t count, unsigned char *matches) {
+    for (size_t i = 0; i < count; i++) {
+        MBTableGridValueType type = values[i].type;
+        if (!matches[i] || type == MBTableGridValueTypePending)
+            continue;
+        if (type == MBTableGridValueTypeEmpty) {
+            matches[i] = 0;
+        } else if (condition->pattern) {
+            char scratch[MBTableGridValueFormatCapacity];
+            size_t length = 0;
+            const char *text = MBTableGridValueGetUTF8(&values[i], scratch, &length);
+            matches[i] = (MBTableGridFindPatternSearch(condition->pattern, text, length) != MBTableGridFindNotFound);
+        }
+    }
+}
+
+static void MBMarkIsEmpty(const MBTableGridValue *values, size_t count, unsigned char *matches) {
+    for (size_t i = 0; i < count; i++) {
+        MBTableGridValueType type = values[i].type;
+        matches[i] &= (type == MBTableGridValueTypePending) | (type == MBTableGridValueTypeEmpty);
+    }
+}
+
+static void MBMarkMatches(const MBTableGridFilterCondition *condition, const MBTableGridValue *values, size_t count, unsigned char *matches);
+
+// The negated condition is tested only on values still matching, and pending
+// values satisfy it, so they are left alone
+static void MBMarkNegation(const MBTableGridFilterCondition *condition, const MBTableGridValue *values, size_t count, unsigned char *matches) {
+    unsigned char negatedMatches[MBNegationChunkSize];
+    for (size_t first = 0; first < count; first += MBNegationChunkSize) {
+        size_t length = (count - first < MBNegationChunkSize) ? count - first : MBNegationChunkSize;
+        memcpy(negatedMatches, matches + first, length);
+        MBMarkMatches(condition->condition, values + first, length, negatedMatches);
+        for (size_t i = 0; i < length; i++) {
+            matches[first + i] &= (values[first + i].type == MBTableGridValueTypePending) | !negatedMatches[i];
+        }
+    }
+}
+
+static void MBMarkMatches(const MBTableGridFilterCondition *condition, const MBTableGridValue *values, size_t count, unsigned char *matches) {
+    switch (condition->kind) {
+        case MBConditionKindEquals:
+            MBMarkEquals(condition, values, count, matches);
+            break;
+        case MBConditionKindRange:
+            MBMarkRange(condition, values, count, matches);
+            break;
+        case MBConditionKindContains:
+            MBMarkContains(condition, values, count, matches);
+            break;
+        case MBConditionKindIsEmpty:
+            MBMarkIsEmpty(values, count, matches);
+            break;
+        case MBConditionKindNegation:
+            MBMarkNegation(condition, values, count, matches);
+            break;
+    }
+}
+
+size_t MBTableGridFilterConditionMarkMatches(const MBTableGridFilterCondition *condition, const MBTableGridValue *values,
+                                             size_t count, unsigned char *matches) {
+    MBMarkMatches(condition, values, count, matches);
+    size_t matchCount = 0;
+    for (size_t i = 0; i < count; i++)
+        matchCount += matches[i];
+    return matchCount;
+}
@@ -0,0 +1,112 @@
+//
+//  MBTableGridFilter.h
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#ifndef MBTableGridFilter_h
+#define MBTableGridFilter_h
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "MBTableGridValue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief		\c MBTableGridFilterCondition tests cell values, such as a
+ *				column's values for a batch of rows, against a condition.
+ *
+ * @details		Conditions are evaluated a batch at a time, in one pass
+ *				per condition over the values rather than one call per
+ *				cell. Equality and range tests on numbers and dates are
+ *				written without branches, so that the compiler can
+ *				vectorize them; text searches use the word-at-a-time
+ *				search of \c MBTableGridFindPattern and skip values that
+ *				another condition has already ruled out.
+ *
+ *				Pending values satisfy every condition, so that rows
+ *				whose values are still loading can be kept until they
+ *				arrive and tested again.
+ *
+ *				A condition is immutable once created, and may be used
+ *				from several threads at once.
+ */
+typedef struct MBTableGridFilterCondition MBTableGridFilterCondition;
+
+/**
+ * @brief		Creates a condition satisfied by values equal to \c value.
+ *
+ * @details		Integers and doubles are equal if they have the same
+ *				numeric value; dates if they are the same time; booleans
+ *				if they have the same value; and strings if they have the
+ *				same bytes, or, when \c ignoresCase is \c true, the same
+ *				bytes apart from the case of ASCII letters. Values of
+ *				other kinds are never equal, and an empty \c value is
+ *				equal only to empty values. A pending \c value is equal
+ *				to none, so only pending values, which satisfy every
+ *				condition, satisfy it. Returns \c NULL if out of memory.
+ */
+MBTableGridFilterCondition *MBTableGridFilterConditionCreateEquals(const MBTableGridValue *value, bool ignoresCase);
+
+/**
+ * @brief		Creates a condition satisfied by integers, doubles and
+ *				dates from \c minimum to \c maximum inclusive, with dates
+ *				measured in seconds since 1970 UTC. Pass \c -INFINITY or
+ *				\c INFINITY to leave an end open. Returns \c NULL if out
+ *				of memory.
+ */
+MBTableGridFilterCondition *MBTableGridFilterConditionCreateRange(double minimum, double maximum);
+
+/**
+ * @brief		Creates a condition satisfied by values whose text, as
+ *				given by \c MBTableGridValueGetUTF8, contains \c length
+ *				bytes of UTF-8, ignoring the case of ASCII letters if
+ *				\c ignoresCase is \c true. Empty values never satisfy it,
+ *				and every other value satisfies an empty string. Returns
+ *				\c NULL if out of memory.
+ */
+MBTableGridFilterCondition *MBTableGridFilterConditionCreateContains(const char *bytes, size_t length, bool ignoresCase);
+
+/**
+ * @brief		Creates a condition satisfied by empty values. Returns
+ *				\c NULL if out of memory.
+ */
+MBTableGridFilterCondition *MBTableGridFilterConditionCreateIsEmpty(void);
+
+/**
+ * @brief		Creates a condition satisfied by the values that don't
+ *				satisfy \c condition, and by pending values, taking
+ *				ownership of \c condition. Returns \c NULL, destroying
+ *				\c condition, if out of memory.
+ */
+MBTableGridFilterCondition *MBTableGridFilterConditionCreateNegation(MBTableGridFilterCondition *condition);
+
+/**
+ * @brief		Frees a condition created by one of the functions above.
+ */
+void MBTableGridFilterConditionDestroy(MBTableGridFilterCondition *condition);
+
+/**
+ * @brief		Sets \c matches[i] to 0 for each of the \c count values
+ *				that doesn't satisfy the condition, leaving the others
+ *				as they were.
+ *
+ * @details		\c matches should hold 0 or 1 for each value. Testing one
+ *				condition after another on the same bytes therefore
+ *				leaves 1 only for values satisfying them all.
+ *
+ * @return		The number of values whose byte is still 1.
+ */
+size_t MBTableGridFilterConditionMarkMatches(const MBTableGridFilterCondition *condition, const MBTableGridValue *values,
+                                             size_t count, unsigned char *matches);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MBTableGridFilter_h */
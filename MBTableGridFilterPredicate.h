@@ -0,0 +1,98 @@
+//
+//  MBTableGridFilterPredicate.h
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+ * @brief		The test an \c MBTableGridFilterPredicate applies to each
+ *				cell of its column.
+ */
+typedef NS_ENUM(NSUInteger, MBTableGridFilterOperator) {
+    MBTableGridFilterOperatorEquals = 0,
+    MBTableGridFilterOperatorRange,
+    MBTableGridFilterOperatorContains,
+    MBTableGridFilterOperatorIsEmpty
+};
+
+/**
+ * @brief		\c MBTableGridFilterPredicate is a condition on the values
+ *				of one column, used by \c filterRowsWithPredicates: to
+ *				choose the rows an \c MBTableGrid shows.
+ *
+ * @details		Values are compared as the grid reads them, whether from
+ *				\c tableGrid:getValues:forColumns:rows: or as objects:
+ *				\c NSNumber values by number, \c NSDate values by time,
+ *				and anything else by its text. Predicates are immutable.
+ */
+@interface MBTableGridFilterPredicate : NSObject <NSCopying>
+
+/**
+ * @brief		Returns a predicate matching cells equal to \c value, or
+ *				empty cells if \c value is \c nil.
+ *
+ * @details		Numbers are equal if they have the same value, whether
+ *				integers or not, and strings if they have the same
+ *				characters, or the same apart from the case of ASCII
+ *				letters if \c ignoresCase is \c YES. A number is never
+ *				equal to a string.
+ */
++ (instancetype)predicateWithColumn:(NSUInteger)columnIndex equalTo:(id)value ignoringCase:(BOOL)ignoresCase;
+
+/**
+ * @brief		Returns a predicate matching numbers or dates from
+ *				\c minimum to \c maximum inclusive.
+ *
+ * @param		minimum		An \c NSNumber or \c NSDate, or \c nil for no
+ *							lower bound.
+ * @param		maximum		An \c NSNumber or \c NSDate, or \c nil for no
+ *							upper bound.
+ */
++ (instancetype)predicateWithColumn:(NSUInteger)columnIndex minimum:(id)minimum maximum:(id)maximum;
+
+/**
+ * @brief		Returns a predicate matching cells whose text contains
+ *				\c string, ignoring the case of ASCII letters if
+ *				\c ignoresCase is \c YES. Empty cells never match.
+ */
++ (instancetype)predicateWithColumn:(NSUInteger)columnIndex containing:(NSString *)string ignoringCase:(BOOL)ignoresCase;
+
+/**
+ * @brief		Returns a predicate matching empty cells.
+ */
++ (instancetype)predicateForEmptyCellsInColumn:(NSUInteger)columnIndex;
+
+/**
+ * @brief		Returns a predicate matching the cells the receiver
+ *				doesn't match.
+ */
+- (instancetype)negatedPredicate;
+
+/**
+ * @brief		Returns the same predicate on another column, such as the
+ *				one the receiver's column moved to.
+ */
+- (instancetype)predicateWithColumn:(NSUInteger)columnIndex;
+
+@property (nonatomic, readonly) NSUInteger columnIndex;
+@property (nonatomic, readonly) MBTableGridFilterOperator filterOperator;
+
+/**
+ * @brief		The value compared with for \c MBTableGridFilterOperatorEquals,
+ *				or the string searched for with \c MBTableGridFilterOperatorContains.
+ */
+@property (nonatomic, readonly) id value;
+
+/**
+ * @brief		The bounds for \c MBTableGridFilterOperatorRange.
+ */
+@property (nonatomic, readonly) id minimum;
+@property (nonatomic, readonly) id maximum;
+
+@property (nonatomic, readonly) BOOL ignoresCase;
+@property (nonatomic, readonly, getter=isNegated) BOOL negated;
+
+@end
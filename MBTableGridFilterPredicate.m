@@ -0,0 +1,75 @@
+//
+//  MBTableGridFilterPredicate.m
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#import "MBTableGridFilterPredicate.h"
+
+@implementation MBTableGridFilterPredicate
+
+- (instancetype)_initWithColumn:(NSUInteger)columnIndex operator:(MBTableGridFilterOperator)filterOperator value:(id)value
+                        minimum:(id)minimum maximum:(id)maximum ignoringCase:(BOOL)ignoresCase negated:(BOOL)negated {
+    if (self = [super init]) {
+        _columnIndex = columnIndex;
+        _filterOperator = filterOperator;
+        _value = [value copy];
+        _minimum = [minimum copy];
+        _maximum = [maximum copy];
+        _ignoresCase = ignoresCase;
+        _negated = negated;
+    }
+    return self;
+}
+
++ (instancetype)predicateWithColumn:(NSUInteger)columnIndex equalTo:(id)value ignoringCase:(BOOL)ignoresCase {
+    return [[self alloc] _initWithColumn:columnIndex operator:MBTableGridFilterOperatorEquals value:value
+                                 minimum:nil maximum:nil ignoringCase:ignoresCase negated:NO];
+}
+
++ (instancetype)predicateWithColumn:(NSUInteger)columnIndex minimum:(id)minimum maximum:(id)maximum {
+    return [[self alloc] _initWithColumn:columnIndex operator:MBTableGridFilterOperatorRange value:nil
+                                 minimum:minimum maximum:maximum ignoringCase:NO negated:NO];
+}
+
++ (instancetype)predicateWithColumn:(NSUInteger)columnIndex containing:(NSString *)string ignoringCase:(BOOL)ignoresCase {
+    return [[self alloc] _initWithColumn:columnIndex operator:MBTableGridFilterOperatorContains value:string ?: @""
+                                 minimum:nil maximum:nil ignoringCase:ignoresCase negated:NO];
+}
+
++ (instancetype)predicateForEmptyCellsInColumn:(NSUInteger)columnIndex {
+    return [[self alloc] _initWithColumn:columnIndex operator:MBTableGridFilterOperatorIsEmpty value:nil
+                                 minimum:nil maximum:nil ignoringCase:NO negated:NO];
+}
+
+- (instancetype)negatedPredicate {
+    return [[[self class] alloc] _initWithColumn:_columnIndex operator:_filterOperator value:_value
+                                         minimum:_minimum maximum:_maximum ignoringCase:_ignoresCase negated:!_negated];
+}
+
+- (instancetype)predicateWithColumn:(NSUInteger)columnIndex {
+    return [[[self class] alloc] _initWithColumn:columnIndex operator:_filterOperator value:_value
+                                         minimum:_minimum maximum:_maximum ignoringCase:_ignoresCase negated:_negated];
+}
+
+- (id)copyWithZone:(NSZone *)zone {
+    return self;
+}
+
+- (BOOL)isEqual:(id)object {
+    if (![object isKindOfClass:[MBTableGridFilterPredicate class]])
+        return NO;
+    MBTableGridFilterPredicate *predicate = object;
+    return (_columnIndex == predicate->_columnIndex && _filterOperator == predicate->_filterOperator &&
+            _ignoresCase == predicate->_ignoresCase && _negated == predicate->_negated &&
+            (_value == predicate->_value || [_value isEqual:predicate->_value]) &&
+            (_minimum == predicate->_minimum || [_minimum isEqual:predicate->_minimum]) &&
+            (_maximum == predicate->_maximum || [_maximum isEqual:predicate->_maximum]));
+}
+
+- (NSUInteger)hash {
+    return _columnIndex ^ (_filterOperator << 8) ^ [_value hash];
+}
+
+@end
@@ -0,0 +1,148 @@
+//
+//  MBTableGridFind.c
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#include "MBTableGridFind.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MBOnes UINT64_C(0x0101010101010101)
+#define MBHighBits UINT64_C(0x8080808080808080)
+
+struct MBTableGridFindPattern {
+    size_t length;
+    bool ignoresCase;
+
+    /* Broadcast first and last bytes, and the mask OR-ed into text before
+       comparing with them (0x20 when ignoring case, which lowercases ASCII
+       letters; other bytes may then collide, but candidates are verified) */
+    uint64_t first;
+    uint64_t last;
+    uint64_t fold;
+
+    /* The pattern, lowercased if ignoring case */
+    unsigned char bytes[];
+};
+
+static inline unsigned char MBLowercase(unsigned char c) {
+    return (c >= 'A' && c <= 'Z') ? (unsigned char)(c | 0x20) : c;
+}
+
+// Loads eight bytes with the first in the lowest-order position
+static inline uint64_t MBLoadWord(const unsigned char *bytes) {
+    uint64_t word;
+    memcpy(&word, bytes, sizeof(word));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    word = __builtin_bswap64(word);
+#endif
+    return word;
+}
+
+// High bit set in each byte of the word that is zero. Bytes above a zero
+// byte may be flagged spuriously, which only adds candidates.
+static inline uint64_t MBZeroBytes(uint64_t word) {
+    return (word - MBOnes) & ~word & MBHighBits;
+}
+
+static inline unsigned MBFirstFlaggedByte(uint64_t flags) {
+    unsigned index;
+#if defined(__GNUC__) || defined(__clang__)
+    index = (unsigned)__builtin_ctzll(flags) / 8;
+#else
+    index = 0;
+    while (!(flags & 0x80)) {
+        flags >>= 8;
+        index++;
+    }
+#endif
+    return index;
+}
+
+static inline bool MBMatchesAt(const MBTableGridFindPattern *pattern, const unsigned char *text) {
+    if (!pattern->ignoresCase)
+        return memcmp(text, pattern->bytes, pattern->length) == 0;
+    for (size_t i = 0; i < pattern->length; i++) {
+        if (MBLowercase(text[i]) != pattern->bytes[i])
+            return false;
+    }
+    return true;
+}
+
+MBTableGridFindPattern *MBTableGridFindPatternCreate(const char *bytes, size_t length, bool ignoresCase) {
+    if (length == 0)
+        return NULL;
+    MBTableGridFindPattern *pattern = malloc(sizeof(MBTableGridFindPattern) + length);
+    if (pattern == NULL)
+        return NULL;
+
+    pattern->length = length;
+    pattern->ignoresCase = ignoresCase;
+    for (size_t i = 0; i < length; i++)
+        pattern->bytes[i] = ignoresCase ? MBLowercase((unsigned char)bytes[i]) : (unsigned char)bytes[i];
+    pattern->fold = ignoresCase ? MBOnes * 0x20 : 0;
+    pattern->first = (MBOnes * pattern->bytes[0]) | pattern->fold;
+    pattern->last = (MBOnes * pattern->bytes[length - 1]) | pattern->fold;
+    return pattern;
+}
+
+void MBTableGridFindPatternDestroy(MBTableGridFindPattern *pattern) {
+    free(pattern);
+}
+
+size_t MBTableGridFindPatternSearch(const MBTableGridFindPattern *pattern, const char *text, size_t length) {
+    const unsigned char *bytes = (const unsigned char *)text;
+    size_t patternLength = pattern->length;
+    size_t offset = 0;
+
+    if (length < patternLength)
+        return MBTableGridFindNotFound;
+    if (patternLength == 1 && !pattern->ignoresCase) {
+        const unsigned char *found = memchr(bytes, pattern->bytes[0], length);
+        return found ? (size_t)(found - bytes) : MBTableGridFindNotFound;
+    }
+
+    // Eight candidate positions at a time, while both words fit in the text
+    size_t lastWordOffset = length - patternLength + 1;
+    for (; offset + sizeof(uint64_t) <= lastWordOffset; offset += sizeof(uint64_t)) {
+        uint64_t firstWord = MBLoadWord(bytes + offset) | pattern->fold;
+        uint64_t lastWord = MBLoadWord(bytes + offset + patternLength - 1) | pattern->fold;
+        uint64_t candidates = MBZeroBytes(firstWord ^ pattern->first) & MBZeroBytes(lastWord ^ pattern->last);
+
+        while (candidates) {
+            unsigned index = MBFirstFlaggedByte(candidates);
+            if (MBMatchesAt(pattern, bytes + offset + index))
+                return offset + index;
+            candidates &= candidates - 1;
+        }
+    }
+    for (; offset < lastWordOffset; offset++) {
+        if (MBMatchesAt(pattern, bytes + offset))
+            return offset;
+    }
+    return MBTableGridFindNotFound;
+}
+
+size_t MBTableGridFindPatternMarkMatches(const MBTableGridFindPattern *pattern, const MBTableGridValue *values,
+                                         size_t count, unsigned char *matches) {
+    size_t matchCount = 0;
+    for (size_t i = 0; i < count; i++) {
+        char scratch[MBTableGridValueFormatCapacity];
+        size_t length = 0;
+        const char *text;
+
+        matches[i] = 0;
+        if (values[i].type == MBTableGridValueTypeEmpty || values[i].type == MBTableGridValueTypePending)
+            continue;
+        text = MBTableGridValueGetUTF8(&values[i], scratch, &length);
+        if (MBTableGridFindPatternSearch(pattern, text, length) != MBTableGridFindNotFound) {
+            matches[i] = 1;
+            matchCount++;
+        }
+    }
+    return matchCount;
+}
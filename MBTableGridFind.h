@@ -0,0 +1,78 @@
+//
+//  MBTableGridFind.h
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#ifndef MBTableGridFind_h
+#define MBTableGridFind_h
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "MBTableGridValue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief		Returned by \c MBTableGridFindPatternSearch when the text
+ *				doesn't contain the pattern.
+ */
+#define MBTableGridFindNotFound ((size_t)-1)
+
+/**
+ * @brief		\c MBTableGridFindPattern searches UTF-8 text for a fixed
+ *				string of bytes.
+ *
+ * @details		Candidate positions are found eight bytes at a time by
+ *				comparing the first and last bytes of the pattern against
+ *				a whole machine word of text at once, and only candidates
+ *				whose first and last bytes both match are compared in
+ *				full. When the pattern ignores case, ASCII letters are
+ *				compared without regard to case; other bytes must match
+ *				exactly, so callers wanting Unicode case folding need to
+ *				search some other way.
+ *
+ *				A pattern is immutable once created, and may be used from
+ *				several threads at once.
+ */
+typedef struct MBTableGridFindPattern MBTableGridFindPattern;
+
+/**
+ * @brief		Creates a pattern matching \c length bytes of UTF-8 text.
+ *				Returns \c NULL if \c length is zero or out of memory.
+ */
+MBTableGridFindPattern *MBTableGridFindPatternCreate(const char *bytes, size_t length, bool ignoresCase);
+
+/**
+ * @brief		Frees a pattern created with \c MBTableGridFindPatternCreate.
+ */
+void MBTableGridFindPatternDestroy(MBTableGridFindPattern *pattern);
+
+/**
+ * @brief		Returns the offset of the first occurrence of the pattern
+ *				in \c text, or \c MBTableGridFindNotFound.
+ */
+size_t MBTableGridFindPatternSearch(const MBTableGridFindPattern *pattern, const char *text, size_t length);
+
+/**
+ * @brief		Sets \c matches[i] to 1 for each of the \c count values
+ *				whose text contains the pattern, and to 0 otherwise.
+ *
+ * @details		Values are searched in the text form given by
+ *				\c MBTableGridValueGetUTF8. Empty and pending values never
+ *				match.
+ *
+ * @return		The number of matching values.
+ */
+size_t MBTableGridFindPatternMarkMatches(const MBTableGridFindPattern *pattern, const MBTableGridValue *values,
+                                         size_t count, unsigned char *matches);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MBTableGridFind_h */
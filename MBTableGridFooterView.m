@@ -30,6 +30,7 @@
 @interface MBTableGrid ()
 - (NSCell *)_footerCellForColumn:(NSUInteger)columnIndex;
 - (NSCell *)_footerCellForRow:(NSUInteger)rowIndex;
+- (NSCell *)_footerCellForGroup:(NSUInteger)groupIndex;
 - (void)_willDisplayFooterMenu:(NSMenu *)menu forColumn:(NSUInteger)columnIndex;
 - (void)_willDisplayFooterMenu:(NSMenu *)menu forRow:(NSUInteger)rowIndex;
 - (NSRange)_rangeOfColumnsIntersectingRect:(NSRect)rect;
@@ -53,6 +54,22 @@
                            [self.tableGrid _rangeOfRowsIntersectingRect:[self convertRect:rect toView:self.tableGrid]] :
                            [self.tableGrid _rangeOfColumnsIntersectingRect:[self convertRect:rect toView:self.tableGrid]]);
 
+    // Grouped rows have one footer a group, beside all of its rows
+    if (self.isVertical && self.tableGrid.numberOfGroups > 0) {
+        NSUInteger group = [self.tableGrid groupOfRow:columnRange.location];
+        while (group != NSNotFound && group < self.tableGrid.numberOfGroups) {
+            NSRange rowRange = [self.tableGrid rowRangeOfGroup:group];
+            if (rowRange.location >= NSMaxRange(columnRange))
+                break;
+            NSRect cellFrame = NSUnionRect([self footerRectOfRow:rowRange.location], [self footerRectOfRow:NSMaxRange(rowRange) - 1]);
+            if ([self needsToDrawRect:cellFrame]) {
+                [[self.tableGrid _footerCellForGroup:group] drawWithFrame:cellFrame inView:self];
+            }
+            group++;
+        }
+        return;
+    }
+
     // Find the columns to draw
     NSUInteger column = columnRange.location;
     while (column != NSNotFound && column < NSMaxRange(columnRange)) {
@@ -0,0 +1,1147 @@
+//
+//  MBTableGridFormula.c
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#include "MBTableGridFormula.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Parentheses and operators nested deeper than this aren't a formula anyone wrote by hand,
+// and would otherwise risk running out of stack while parsing
+#define MBMaximumNesting 256
+#define MBMaximumArguments 255
+// Enough for the number of any cell's column or row, or a number written out
+#define MBMaximumNumberLength 64
+// Operands evaluated on the C stack rather than the heap
+#define MBLocalStackDepth 16
+#define MBArenaBlockSize 4096
+
+typedef enum MBOpcode {
+    MBOpcodePushNumber = 0,
+    MBOpcodePushString,
+    MBOpcodePushBoolean,
+    MBOpcodePushError,
+    MBOpcodePushReference,
+    MBOpcodeNegate,
+    MBOpcodePercent,
+    MBOpcodeAdd,
+    MBOpcodeSubtract,
+    MBOpcodeMultiply,
+    MBOpcodeDivide,
+    MBOpcodePower,
+    MBOpcodeConcatenate,
+    MBOpcodeEqual,
+    MBOpcodeNotEqual,
+    MBOpcodeLess,
+    MBOpcodeGreater,
+    MBOpcodeLessEqual,
+    MBOpcodeGreaterEqual,
+    MBOpcodeCall
+} MBOpcode;
+
+typedef enum MBFunction {
+    MBFunctionSum = 0,
+    MBFunctionAverage,
+    MBFunctionMinimum,
+    MBFunctionMaximum,
+    MBFunctionCount,
+    MBFunctionCountA,
+    MBFunctionIf,
+    MBFunctionIfError,
+    MBFunctionAnd,
+    MBFunctionOr,
+    MBFunctionNot,
+    MBFunctionAbsolute,
+    MBFunctionRound,
+    MBFunctionInteger,
+    MBFunctionModulo,
+    MBFunctionPower,
+    MBFunctionSquareRoot,
+    MBFunctionLength,
+    MBFunctionConcatenate,
+    MBFunctionUnknown
+} MBFunction;
+
+static const struct {
+    const char *name;
+    MBFunction function;
+    unsigned minimumArguments;
+    unsigned maximumArguments;
+} MBFunctions[] = {
+    { "SUM", MBFunctionSum, 1, MBMaximumArguments },
+    { "AVERAGE", MBFunctionAverage, 1, MBMaximumArguments },
+    { "MIN", MBFunctionMinimum, 1, MBMaximumArguments },
+    { "MAX", MBFunctionMaximum, 1, MBMaximumArguments },
+    { "COUNT", MBFunctionCount, 1, MBMaximumArguments },
+    { "COUNTA", MBFunctionCountA, 1, MBMaximumArguments },
+    { "IF", MBFunctionIf, 2, 3 },
+    { "IFERROR", MBFunctionIfError, 2, 2 },
+    { "AND", MBFunctionAnd, 1, MBMaximumArguments },
+    { "OR", MBFunctionOr, 1, MBMaximumArguments },
+    { "NOT", MBFunctionNot, 1, 1 },
+    { "ABS", MBFunctionAbsolute, 1, 1 },
+    { "ROUND", MBFunctionRound, 1, 2 },
+    { "INT", MBFunctionInteger, 1, 1 },
+    { "MOD", MBFunctionModulo, 2, 2 },
+    { "POWER", MBFunctionPower, 2, 2 },
+    { "SQRT", MBFunctionSquareRoot, 1, 1 },
+    { "LEN", MBFunctionLength, 1, 1 },
+    { "CONCATENATE", MBFunctionConcatenate, 1, MBMaximumArguments },
+    { "CONCAT", MBFunctionConcatenate, 1, MBMaximumArguments }
+};
+
+// For strings, argument is the offset of the text in the formula's strings; for
+// references, the reference; for calls, the function, with the number of arguments
+// in count
+typedef struct MBInstruction {
+    MBOpcode opcode;
+    uint32_t argument;
+    uint32_t count;
+    double number;
+} MBInstruction;
+
+struct MBTableGridFormula {
+    char *text;
+    size_t textLength;
+
+    MBInstruction *instructions;
+    size_t instructionCount;
+    size_t instructionCapacity;
+
+    MBTableGridFormulaReference *references;
+    size_t referenceCount;
+    size_t referenceCapacity;
+
+    char *strings;
+    size_t stringsLength;
+    size_t stringsCapacity;
+
+    size_t stackDepth;
+};
+
+const char *MBTableGridFormulaErrorString(MBTableGridFormulaError error) {
+    switch (error) {
+        case MBTableGridFormulaErrorNone:
+            return "";
+        case MBTableGridFormulaErrorValue:
+            return "#VALUE!";
+        case MBTableGridFormulaErrorDivideByZero:
+            return "#DIV/0!";
+        case MBTableGridFormulaErrorNumber:
+            return "#NUM!";
+        case MBTableGridFormulaErrorName:
+            return "#NAME?";
+        case MBTableGridFormulaErrorCycle:
+            return "#CYCLE!";
+    }
+    return "";
+}
+
+
+typedef struct MBParser {
+    const char *bytes;
+    size_t length;
+    size_t position;
+    MBTableGridFormula *formula;
+    // Operands on the stack at this point of the instructions, and the most ever
+    size_t depth;
+    size_t nesting;
+    bool failed;
+} MBParser;
+
+static inline unsigned char MBUppercase(unsigned char c) {
+    return (c >= 'a' && c <= 'z') ? (unsigned char)(c & ~0x20) : c;
+}
+
+static inline bool MBIsLetter(unsigned char c) {
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+}
+
+static inline bool MBIsDigit(unsigned char c) {
+    return c >= '0' && c <= '9';
+}
+
+static bool MBGrow(void **items, size_t *capacity, size_t count, size_t size) {
+    if (count < *capacity)
+        return true;
+    size_t newCapacity = *capacity ? 2 * *capacity : 8;
+    void *newItems = realloc(*items, newCapacity * size);
+    if (newItems == NULL)
+        return false;
+    *items = newItems;
+    *capacity = newCapacity;
+    return true;
+}
+
+static void MBSkipSpace(MBParser *parser) {
+    while (parser->position < parser->length &&
+           (parser->bytes[parser->position] == ' ' || parser->bytes[parser->position] == '\t' ||
+            parser->bytes[parser->position] == '\n' || parser->bytes[parser->position] == '\r'))
+        parser->position++;
+}
+
+static inline int MBPeek(MBParser *parser) {
+    MBSkipSpace(parser);
+    return (parser->position < parser->length) ? (unsigned char)parser->bytes[parser->position] : -1;
+}
+
+// Takes the operator if it's next
+static bool MBAccept(MBParser *parser, const char *token) {
+    size_t length = strlen(token);
+    MBSkipSpace(parser);
+    if (parser->length - parser->position < length || memcmp(parser->bytes + parser->position, token, length) != 0)
+        return false;
+    parser->position += length;
+    return true;
+}
+
+// Emits an instruction that leaves the stack `change` operands deeper
+static void MBEmit(MBParser *parser, MBInstruction instruction, long change) {
+    MBTableGridFormula *formula = parser->formula;
+    if (parser->failed)
+        return;
+    if (!MBGrow((void **)&formula->instructions, &formula->instructionCapacity, formula->instructionCount, sizeof(MBInstruction))) {
+        parser->failed = true;
+        return;
+    }
+    formula->instructions[formula->instructionCount++] = instruction;
+    parser->depth = (size_t)((long)parser->depth + change);
+    if (parser->depth > formula->stackDepth)
+        formula->stackDepth = parser->depth;
+}
+
+static void MBEmitOperator(MBParser *parser, MBOpcode opcode, long change) {
+    MBEmit(parser, (MBInstruction){ .opcode = opcode }, change);
+}
+
+// Refers to a block of cells, listing each block only once
+static void MBEmitReference(MBParser *parser, MBTableGridFormulaReference reference) {
+    MBTableGridFormula *formula = parser->formula;
+    size_t index = 0;
+    while (index < formula->referenceCount && memcmp(&formula->references[index], &reference, sizeof(reference)) != 0)
+        index++;
+    if (index == formula->referenceCount) {
+        if (!MBGrow((void **)&formula->references, &formula->referenceCapacity, formula->referenceCount,
+                    sizeof(MBTableGridFormulaReference))) {
+            parser->failed = true;
+            return;
+        }
+        formula->references[formula->referenceCount++] = reference;
+    }
+    MBEmit(parser, (MBInstruction){ .opcode = MBOpcodePushReference, .argument = (uint32_t)index }, 1);
+}
+
+static bool MBParseNumber(MBParser *parser) {
+    char buffer[MBMaximumNumberLength + 1];
+    size_t start = parser->position, end = start;
+    while (end < parser->length && MBIsDigit(parser->bytes[end]))
+        end++;
+    if (end < parser->length && parser->bytes[end] == '.')
+        end++;
+    while (end < parser->length && MBIsDigit(parser->bytes[end]))
+        end++;
+    if (end < parser->length && (parser->bytes[end] == 'e' || parser->bytes[end] == 'E')) {
+        size_t exponent = end + 1;
+        if (exponent < parser->length && (parser->bytes[exponent] == '+' || parser->bytes[exponent] == '-'))
+            exponent++;
+        if (exponent < parser->length && MBIsDigit(parser->bytes[exponent])) {
+            end = exponent;
+            while (end < parser->length && MBIsDigit(parser->bytes[end]))
+                end++;
+        }
+    }
+    if (end - start > MBMaximumNumberLength || end == start + (parser->bytes[start] == '.'))
+        return false;
+    memcpy(buffer, parser->bytes + start, end - start);
+    buffer[end - start] = '\0';
+    double number = strtod(buffer, NULL);
+    if (!isfinite(number))
+        return false;
+    parser->position = end;
+    MBEmit(parser, (MBInstruction){ .opcode = MBOpcodePushNumber, .number = number }, 1);
+    return true;
+}
+
+// Doubled quotes stand for one
+static bool MBParseString(MBParser *parser) {
+    MBTableGridFormula *formula = parser->formula;
+    size_t offset = formula->stringsLength;
+    parser->position++;
+    for (;;) {
+        if (parser->position >= parser->length)
+            return false;
+        char c = parser->bytes[parser->position++];
+        if (c == '"') {
+            if (parser->position < parser->length && parser->bytes[parser->position] == '"') {
+                parser->position++;
+            } else {
+                break;
+            }
+        }
+        if (!MBGrow((void **)&formula->strings, &formula->stringsCapacity, formula->stringsLength, 1)) {
+            parser->failed = true;
+            return false;
+        }
+        formula->strings[formula->stringsLength++] = c;
+    }
+    if (offset > UINT32_MAX || formula->stringsLength - offset > UINT32_MAX)
+        return false;
+    MBEmit(parser, (MBInstruction){ .opcode = MBOpcodePushString, .argument = (uint32_t)offset,
+                                    .count = (uint32_t)(formula->stringsLength - offset) }, 1);
+    return true;
+}
+
+// Reads a cell such as B12 or $B$12 at the position, leaving the position after it
+static bool MBParseCell(MBParser *parser, size_t *column, size_t *row) {
+    size_t position = parser->position;
+    const char *bytes = parser->bytes;
+    size_t columnNumber = 0, rowNumber = 0, letters = 0, digits = 0;
+    if (position < parser->length && bytes[position] == '$')
+        position++;
+    while (position < parser->length && MBIsLetter(bytes[position]) && letters < 8) {
+        columnNumber = columnNumber * 26 + (MBUppercase(bytes[position++]) - 'A' + 1);
+        letters++;
+    }
+    if (position < parser->length && bytes[position] == '$')
+        position++;
+    while (position < parser->length && MBIsDigit(bytes[position]) && digits < 18) {
+        rowNumber = rowNumber * 10 + (size_t)(bytes[position++] - '0');
+        digits++;
+    }
+    // Anything run on after it makes it a name instead, such as LOG10(
+    if (letters == 0 || digits == 0 || rowNumber == 0 ||
+        (position < parser->length && (MBIsLetter(bytes[position]) || MBIsDigit(bytes[position]) ||
+                                       bytes[position] == '_' || bytes[position] == '.' || bytes[position] == '(')))
+        return false;
+    parser->position = position;
+    *column = columnNumber - 1;
+    *row = rowNumber - 1;
+    return true;
+}
+
+static void MBParseComparison(MBParser *parser);
+
+static void MBParseCall(MBParser *parser, const char *name, size_t nameLength) {
+    MBFunction function = MBFunctionUnknown;
+    unsigned minimumArguments = 0, maximumArguments = MBMaximumArguments;
+    for (size_t i = 0; i < sizeof(MBFunctions) / sizeof(MBFunctions[0]); i++) {
+        size_t length = strlen(MBFunctions[i].name), j = 0;
+        while (j < length && j < nameLength && MBUppercase(name[j]) == MBFunctions[i].name[j])
+            j++;
+        if (j == length && j == nameLength) {
+            function = MBFunctions[i].function;
+            minimumArguments = MBFunctions[i].minimumArguments;
+            maximumArguments = MBFunctions[i].maximumArguments;
+            break;
+        }
+    }
+    unsigned count = 0;
+    if (!MBAccept(parser, ")")) {
+        do {
+            MBParseComparison(parser);
+            count++;
+        } while (!parser->failed && count <= MBMaximumArguments && MBAccept(parser, ","));
+        if (!MBAccept(parser, ")"))
+            parser->failed = true;
+    }
+    if (count < minimumArguments || count > maximumArguments) {
+        parser->failed = true;
+        return;
+    }
+    MBEmit(parser, (MBInstruction){ .opcode = MBOpcodeCall, .argument = function, .count = count }, 1 - (long)count);
+}
+
+static void MBParsePrimary(MBParser *parser) {
+    int c = MBPeek(parser);
+    if (c < 0) {
+        parser->failed = true;
+    } else if (MBIsDigit((unsigned char)c) || c == '.') {
+        parser->failed = parser->failed || !MBParseNumber(parser);
+    } else if (c == '"') {
+        parser->failed = parser->failed || !MBParseString(parser);
+    } else if (c == '(') {
+        parser->position++;
+        MBParseComparison(parser);
+        if (!MBAccept(parser, ")"))
+            parser->failed = true;
+    } else if (MBIsLetter((unsigned char)c) || c == '$' || c == '_') {
+        size_t column, row;
+        if (MBParseCell(parser, &column, &row)) {
+            MBTableGridFormulaReference reference = { column, row, 1, 1 };
+            size_t start = parser->position;
+            MBSkipSpace(parser);
+            if (parser->position < parser->length && parser->bytes[parser->position] == ':') {
+                size_t lastColumn, lastRow;
+                parser->position++;
+                MBSkipSpace(parser);
+                if (!MBParseCell(parser, &lastColumn, &lastRow)) {
+                    parser->failed = true;
+                    return;
+                }
+                // Either pair of opposite corners names the same block
+                reference.firstColumn = (column < lastColumn) ? column : lastColumn;
+                reference.firstRow = (row < lastRow) ? row : lastRow;
+                reference.columnCount = ((column < lastColumn) ? lastColumn - column : column - lastColumn) + 1;
+                reference.rowCount = ((row < lastRow) ? lastRow - row : row - lastRow) + 1;
+            } else {
+                parser->position = start;
+            }
+            MBEmitReference(parser, reference);
+            return;
+        }
+        const char *name = parser->bytes + parser->position;
+        size_t nameLength = 0;
+        while (parser->position < parser->length &&
+               (MBIsLetter(parser->bytes[parser->position]) || MBIsDigit(parser->bytes[parser->position]) ||
+                parser->bytes[parser->position] == '_' || parser->bytes[parser->position] == '.')) {
+            parser->position++;
+            nameLength++;
+        }
+        if (nameLength == 0) {
+            parser->failed = true;
+        } else if (MBAccept(parser, "(")) {
+            MBParseCall(parser, name, nameLength);
+        } else if (nameLength == 4 && MBUppercase(name[0]) == 'T' && MBUppercase(name[1]) == 'R' &&
+                   MBUppercase(name[2]) == 'U' && MBUppercase(name[3]) == 'E') {
+            MBEmit(parser, (MBInstruction){ .opcode = MBOpcodePushBoolean, .argument = 1 }, 1);
+        } else if (nameLength == 5 && MBUppercase(name[0]) == 'F' && MBUppercase(name[1]) == 'A' &&
+                   MBUppercase(name[2]) == 'L' && MBUppercase(name[3]) == 'S' && MBUppercase(name[4]) == 'E') {
+            MBEmit(parser, (MBInstruction){ .opcode = MBOpcodePushBoolean, .argument = 0 }, 1);
+        } else {
+            MBEmit(parser, (MBInstruction){ .opcode = MBOpcodePushError, .argument = MBTableGridFormulaErrorName }, 1);
+        }
+    } else {
+        parser->failed = true;
+    }
+}
+
+static void MBParsePostfix(MBParser *parser) {
+    MBParsePrimary(parser);
+    while (!parser->failed && MBAccept(parser, "%"))
+        MBEmitOperator(parser, MBOpcodePercent, 0);
+}
+
+// Negation binds tighter than ^, so -2^2 is 4
+static void MBParseUnary(MBParser *parser) {
+    if (++parser->nesting > MBMaximumNesting) {
+        parser->failed = true;
+    } else if (MBAccept(parser, "-")) {
+        MBParseUnary(parser);
+        MBEmitOperator(parser, MBOpcodeNegate, 0);
+    } else if (MBAccept(parser, "+")) {
+        MBParseUnary(parser);
+    } else {
+        MBParsePostfix(parser);
+    }
+    parser->nesting--;
+}
+
+static void MBParsePower(MBParser *parser) {
+    MBParseUnary(parser);
+    while (!parser->failed && MBAccept(parser, "^")) {
+        MBParseUnary(parser);
+        MBEmitOperator(parser, MBOpcodePower, -1);
+    }
+}
+
+static void MBParseProduct(MBParser *parser) {
+    MBParsePower(parser);
+    while (!parser->failed) {
+        MBOpcode opcode;
+        if (MBAccept(parser, "*"))
+            opcode = MBOpcodeMultiply;
+        else if (MBAccept(parser, "/"))
+            opcode = MBOpcodeDivide;
+        else
+            break;
+        MBParsePower(parser);
+        MBEmitOperator(parser, opcode, -1);
+    }
+}
+
+static void MBParseSum(MBParser *parser) {
+    MBParseProduct(parser);
+    while (!parser->failed) {
+        MBOpcode opcode;
+        if (MBAccept(parser, "+"))
+            opcode = MBOpcodeAdd;
+        else if (MBAccept(parser, "-"))
+            opcode = MBOpcodeSubtract;
+        else
+            break;
+        MBParseProduct(parser);
+        MBEmitOperator(parser, opcode, -1);
+    }
+}
+
+static void MBParseConcatenation(MBParser *parser) {
+    MBParseSum(parser);
+    while (!parser->failed && MBAccept(parser, "&")) {
+        MBParseSum(parser);
+        MBEmitOperator(parser, MBOpcodeConcatenate, -1);
+    }
+}
+
+static void MBParseComparison(MBParser *parser) {
+    if (++parser->nesting > MBMaximumNesting) {
+        parser->failed = true;
+        return;
+    }
+    MBParseConcatenation(parser);
+    while (!parser->failed) {
+        MBOpcode opcode;
+        // Two-character operators first, so <= isn't read as <
+        if (MBAccept(parser, "<="))
+            opcode = MBOpcodeLessEqual;
+        else if (MBAccept(parser, ">="))
+            opcode = MBOpcodeGreaterEqual;
+        else if (MBAccept(parser, "<>"))
+            opcode = MBOpcodeNotEqual;
+        else if (MBAccept(parser, "<"))
+            opcode = MBOpcodeLess;
+        else if (MBAccept(parser, ">"))
+            opcode = MBOpcodeGreater;
+        else if (MBAccept(parser, "="))
+            opcode = MBOpcodeEqual;
+        else
+            break;
+        MBParseConcatenation(parser);
+        MBEmitOperator(parser, opcode, -1);
+    }
+    parser->nesting--;
+}
+
+MBTableGridFormula *MBTableGridFormulaCreate(const char *text, size_t length) {
+    MBTableGridFormula *formula = calloc(1, sizeof(MBTableGridFormula));
+    if (formula == NULL)
+        return NULL;
+    formula->text = malloc(length ? length : 1);
+    if (formula->text == NULL) {
+        free(formula);
+        return NULL;
+    }
+    if (length)
+        memcpy(formula->text, text, length);
+    formula->textLength = length;
+
+    MBParser parser = { .bytes = text, .length = length, .formula = formula };
+    MBSkipSpace(&parser);
+    if (parser.position < length && text[parser.position] == '=')
+        parser.position++;
+    MBParseComparison(&parser);
+    if (parser.failed || MBPeek(&parser) >= 0 || formula->instructionCount > UINT32_MAX) {
+        MBTableGridFormulaDestroy(formula);
+        return NULL;
+    }
+    return formula;
+}
+
+void MBTableGridFormulaDestroy(MBTableGridFormula *formula) {
+    if (formula == NULL)
+        return;
+    free(formula->text);
+    free(formula->instructions);
+    free(formula->references);
+    free(formula->strings);
+    free(formula);
+}
+
+const char *MBTableGridFormulaGetText(const MBTableGridFormula *formula, size_t *length) {
+    *length = formula->textLength;
+    return formula->text;
+}
+
+size_t MBTableGridFormulaReferenceCount(const MBTableGridFormula *formula) {
+    return formula->referenceCount;
+}
+
+const MBTableGridFormulaReference *MBTableGridFormulaGetReferences(const MBTableGridFormula *formula) {
+    return formula->references;
+}
+
+
+// A block of cells, or a single value; a reference to one cell is a block of one
+typedef struct MBOperand {
+    MBTableGridFormulaValue scalar;
+    const MBTableGridFormulaValue *block;
+    size_t blockCount;
+} MBOperand;
+
+// Text made while evaluating, in blocks that never move, all freed at the end
+typedef struct MBArenaBlock {
+    struct MBArenaBlock *next;
+    size_t used;
+    size_t capacity;
+    char bytes[];
+} MBArenaBlock;
+
+typedef struct MBEvaluation {
+    MBArenaBlock *blocks;
+    bool failed;
+} MBEvaluation;
+
+static char *MBAllocate(MBEvaluation *evaluation, size_t length) {
+    MBArenaBlock *block = evaluation->blocks;
+    if (block == NULL || block->capacity - block->used < length) {
+        size_t capacity = (length > MBArenaBlockSize) ? length : MBArenaBlockSize;
+        block = malloc(sizeof(MBArenaBlock) + capacity);
+        if (block == NULL) {
+            evaluation->failed = true;
+            return NULL;
+        }
+        block->next = evaluation->blocks;
+        block->used = 0;
+        block->capacity = capacity;
+        evaluation->blocks = block;
+    }
+    char *bytes = block->bytes + block->used;
+    block->used += length;
+    return bytes;
+}
+
+static inline MBTableGridFormulaValue MBMakeError(MBTableGridFormulaError error) {
+    return (MBTableGridFormulaValue){ .error = error };
+}
+
+static inline MBTableGridFormulaValue MBMakeValue(MBTableGridValue value) {
+    return (MBTableGridFormulaValue){ .value = value };
+}
+
+static inline MBTableGridFormulaValue MBMakeNumber(double number) {
+    return isfinite(number) ? MBMakeValue(MBTableGridValueMakeDouble(number)) : MBMakeError(MBTableGridFormulaErrorNumber);
+}
+
+static inline bool MBIsNumber(MBTableGridValueType type) {
+    return type == MBTableGridValueTypeInteger || type == MBTableGridValueTypeDouble || type == MBTableGridValueTypeDate;
+}
+
+static inline bool MBIsPending(const MBTableGridFormulaValue *value) {
+    return value->error == MBTableGridFormulaErrorNone && value->value.type == MBTableGridValueTypePending;
+}
+
+static inline double MBNumberOf(const MBTableGridValue *value) {
+    return (value->type == MBTableGridValueTypeInteger) ? (double)value->data.integer : value->data.number;
+}
+
+// A block of more than one cell can't stand for a single value
+static MBTableGridFormulaValue MBScalarOf(const MBOperand *operand) {
+    if (operand->block == NULL)
+        return operand->scalar;
+    if (operand->blockCount != 1)
+        return MBMakeError(MBTableGridFormulaErrorValue);
+    return operand->block[0];
+}
+
+// An error in either operand, the first first, or else a pending one, is the result
+static bool MBPropagate(const MBTableGridFormulaValue *a, const MBTableGridFormulaValue *b, MBTableGridFormulaValue *result) {
+    if (a->error != MBTableGridFormulaErrorNone) {
+        *result = *a;
+    } else if (b && b->error != MBTableGridFormulaErrorNone) {
+        *result = *b;
+    } else if (MBIsPending(a) || (b && MBIsPending(b))) {
+        *result = MBMakeValue(MBTableGridValueMakePending());
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static bool MBParseText(const char *bytes, size_t length, double *number) {
+    char buffer[MBMaximumNumberLength + 1];
+    while (length && (*bytes == ' ' || *bytes == '\t')) {
+        bytes++;
+        length--;
+    }
+    while (length && (bytes[length - 1] == ' ' || bytes[length - 1] == '\t'))
+        length--;
+    if (length == 0 || length > MBMaximumNumberLength)
+        return false;
+    for (size_t i = 0; i < length; i++) {
+        char c = bytes[i];
+        if (!MBIsDigit(c) && c != '.' && c != '-' && c != '+' && c != 'e' && c != 'E')
+            return false;
+    }
+    memcpy(buffer, bytes, length);
+    buffer[length] = '\0';
+    char *end = NULL;
+    *number = strtod(buffer, &end);
+    return end == buffer + length && isfinite(*number);
+}
+
+static MBTableGridFormulaError MBToNumber(const MBTableGridValue *value, double *number) {
+    switch (value->type) {
+        case MBTableGridValueTypeEmpty:
+        case MBTableGridValueTypePending:
+            *number = 0.0;
+            return MBTableGridFormulaErrorNone;
+        case MBTableGridValueTypeInteger:
+        case MBTableGridValueTypeDouble:
+        case MBTableGridValueTypeDate:
+            *number = MBNumberOf(value);
+            return MBTableGridFormulaErrorNone;
+        case MBTableGridValueTypeBoolean:
+            *number = value->data.boolean ? 1.0 : 0.0;
+            return MBTableGridFormulaErrorNone;
+        case MBTableGridValueTypeString:
+            return MBParseText(value->data.string.bytes, value->data.string.length, number) ?
+                MBTableGridFormulaErrorNone : MBTableGridFormulaErrorValue;
+    }
+    return MBTableGridFormulaErrorValue;
+}
+
+static bool MBTextEquals(const char *bytes, size_t length, const char *text) {
+    size_t i = 0;
+    while (i < length && text[i] && MBUppercase(bytes[i]) == (unsigned char)text[i])
+        i++;
+    return i == length && text[i] == '\0';
+}
+
+static MBTableGridFormulaError MBToBoolean(const MBTableGridValue *value, bool *boolean) {
+    if (value->type == MBTableGridValueTypeBoolean) {
+        *boolean = value->data.boolean;
+        return MBTableGridFormulaErrorNone;
+    }
+    if (value->type == MBTableGridValueTypeString) {
+        if (MBTextEquals(value->data.string.bytes, value->data.string.length, "TRUE"))
+            *boolean = true;
+        else if (MBTextEquals(value->data.string.bytes, value->data.string.length, "FALSE"))
+            *boolean = false;
+        else
+            return MBTableGridFormulaErrorValue;
+        return MBTableGridFormulaErrorNone;
+    }
+    double number;
+    MBTableGridFormulaError error = MBToNumber(value, &number);
+    *boolean = (number != 0.0);
+    return error;
+}
+
+// Text is borrowed, either from the value or from scratch
+static const char *MBToText(const MBTableGridValue *value, char *scratch, size_t *length) {
+    if (value->type == MBTableGridValueTypeString && value->data.string.length == 0) {
+        *length = 0;
+        return "";
+    }
+    return MBTableGridValueGetUTF8(value, scratch, length);
+}
+
+// Numbers come before text, and text before Booleans; empty cells are the least value
+// of whatever they're compared with, and text is compared without regard to ASCII case
+static int MBCompare(const MBTableGridValue *a, const MBTableGridValue *b) {
+    static const MBTableGridValue emptyNumber = { MBTableGridValueTypeDouble, { 0 } };
+    static const MBTableGridValue emptyText = { MBTableGridValueTypeString, { 0 } };
+    static const MBTableGridValue emptyBoolean = { MBTableGridValueTypeBoolean, { 0 } };
+    if (a->type == MBTableGridValueTypeEmpty || b->type == MBTableGridValueTypeEmpty) {
+        const MBTableGridValue *other = (a->type == MBTableGridValueTypeEmpty) ? b : a;
+        const MBTableGridValue *empty = (other->type == MBTableGridValueTypeString) ? &emptyText :
+                                        (other->type == MBTableGridValueTypeBoolean) ? &emptyBoolean : &emptyNumber;
+        if (a->type == MBTableGridValueTypeEmpty)
+            a = empty;
+        if (b->type == MBTableGridValueTypeEmpty)
+            b = empty;
+    }
+    int aRank = MBIsNumber(a->type) ? 0 : (a->type == MBTableGridValueTypeString) ? 1 : 2;
+    int bRank = MBIsNumber(b->type) ? 0 : (b->type == MBTableGridValueTypeString) ? 1 : 2;
+    if (aRank != bRank)
+        return aRank - bRank;
+    if (aRank == 0) {
+        double x = MBNumberOf(a), y = MBNumberOf(b);
+        return (x > y) - (x < y);
+    }
+    if (aRank == 2)
+        return (int)a->data.boolean - (int)b->data.boolean;
+    size_t aLength = a->data.string.length, bLength = b->data.string.length;
+    for (size_t i = 0; i < aLength && i < bLength; i++) {
+        unsigned char x = MBUppercase(a->data.string.bytes[i]), y = MBUppercase(b->data.string.bytes[i]);
+        if (x != y)
+            return (x > y) - (x < y);
+    }
+    return (aLength > bLength) - (aLength < bLength);
+}
+
+static MBTableGridFormulaValue MBConcatenate(MBEvaluation *evaluation, const MBTableGridFormulaValue *values, size_t count) {
+    char scratch[MBTableGridValueFormatCapacity];
+    size_t length = 0;
+    for (size_t i = 0; i < count; i++) {
+        size_t valueLength;
+        MBToText(&values[i].value, scratch, &valueLength);
+        length += valueLength;
+    }
+    char *bytes = MBAllocate(evaluation, length ? length : 1);
+    if (bytes == NULL)
+        return MBMakeError(MBTableGridFormulaErrorValue);
+    size_t offset = 0;
+    for (size_t i = 0; i < count; i++) {
+        size_t valueLength;
+        const char *text = MBToText(&values[i].value, scratch, &valueLength);
+        memcpy(bytes + offset, text, valueLength);
+        offset += valueLength;
+    }
+    return MBMakeValue(MBTableGridValueMakeString(bytes, length));
+}
+
+static MBTableGridFormulaValue MBEvaluateBinary(MBEvaluation *evaluation, MBOpcode opcode,
+                                                const MBOperand *left, const MBOperand *right) {
+    MBTableGridFormulaValue a = MBScalarOf(left), b = MBScalarOf(right), result;
+    if (MBPropagate(&a, &b, &result))
+        return result;
+    if (opcode == MBOpcodeConcatenate) {
+        MBTableGridFormulaValue values[2] = { a, b };
+        return MBConcatenate(evaluation, values, 2);
+    }
+    if (opcode >= MBOpcodeEqual) {
+        int comparison = MBCompare(&a.value, &b.value);
+        bool boolean = false;
+        switch (opcode) {
+            case MBOpcodeEqual: boolean = (comparison == 0); break;
+            case MBOpcodeNotEqual: boolean = (comparison != 0); break;
+            case MBOpcodeLess: boolean = (comparison < 0); break;
+            case MBOpcodeGreater: boolean = (comparison > 0); break;
+            case MBOpcodeLessEqual: boolean = (comparison <= 0); break;
+            case MBOpcodeGreaterEqual: boolean = (comparison >= 0); break;
+            default: break;
+        }
+        return MBMakeValue(MBTableGridValueMakeBoolean(boolean));
+    }
+
+    double x, y;
+    MBTableGridFormulaError error = MBToNumber(&a.value, &x);
+    if (error == MBTableGridFormulaErrorNone)
+        error = MBToNumber(&b.value, &y);
+    if (error != MBTableGridFormulaErrorNone)
+        return MBMakeError(error);
+    bool aIsDate = (a.value.type == MBTableGridValueTypeDate), bIsDate = (b.value.type == MBTableGridValueTypeDate);
+    switch (opcode) {
+        case MBOpcodeAdd:
+            result = MBMakeNumber(x + y);
+            // Moving a date by some seconds gives a date
+            if (result.error == MBTableGridFormulaErrorNone && aIsDate != bIsDate)
+                result.value.type = MBTableGridValueTypeDate;
+            return result;
+        case MBOpcodeSubtract:
+            result = MBMakeNumber(x - y);
+            if (result.error == MBTableGridFormulaErrorNone && aIsDate && !bIsDate)
+                result.value.type = MBTableGridValueTypeDate;
+            return result;
+        case MBOpcodeMultiply:
+            return MBMakeNumber(x * y);
+        case MBOpcodeDivide:
+            return (y == 0.0) ? MBMakeError(MBTableGridFormulaErrorDivideByZero) : MBMakeNumber(x / y);
+        case MBOpcodePower:
+            return MBMakeNumber(pow(x, y));
+        default:
+            return MBMakeError(MBTableGridFormulaErrorValue);
+    }
+}
+
+// Cells in blocks are summarized only if they hold numbers, while values given
+// directly are taken as numbers if they can be
+typedef struct MBSummary {
+    double sum;
+    double minimum;
+    double maximum;
+    size_t numberCount;
+    // Everything not empty, for COUNTA
+    size_t valueCount;
+} MBSummary;
+
+static MBTableGridFormulaValue MBSummarize(MBFunction function, const MBOperand *arguments, size_t count) {
+    MBSummary summary = { 0.0, INFINITY, -INFINITY, 0, 0 };
+    bool pending = false;
+    bool countsErrors = (function == MBFunctionCountA);
+    bool skipsErrors = countsErrors || (function == MBFunctionCount);
+    for (size_t i = 0; i < count; i++) {
+        const MBOperand *argument = &arguments[i];
+        bool inBlock = (argument->block != NULL);
+        size_t valueCount = inBlock ? argument->blockCount : 1;
+        for (size_t j = 0; j < valueCount; j++) {
+            const MBTableGridFormulaValue *value = inBlock ? &argument->block[j] : &argument->scalar;
+            if (value->error != MBTableGridFormulaErrorNone) {
+                if (!skipsErrors)
+                    return *value;
+                summary.valueCount += countsErrors;
+                continue;
+            }
+            if (value->value.type == MBTableGridValueTypePending) {
+                pending = true;
+                continue;
+            }
+            double number;
+            bool isNumber = MBIsNumber(value->value.type);
+            if (isNumber) {
+                number = MBNumberOf(&value->value);
+            } else if (!inBlock && value->value.type != MBTableGridValueTypeEmpty) {
+                MBTableGridFormulaError error = MBToNumber(&value->value, &number);
+                if (error != MBTableGridFormulaErrorNone && !skipsErrors)
+                    return MBMakeError(error);
+                isNumber = (error == MBTableGridFormulaErrorNone);
+            }
+            summary.valueCount += (value->value.type != MBTableGridValueTypeEmpty);
+            if (!isNumber)
+                continue;
+            summary.numberCount++;
+            summary.sum += number;
+            summary.minimum = (number < summary.minimum) ? number : summary.minimum;
+            summary.maximum = (number > summary.maximum) ? number : summary.maximum;
+        }
+    }
+    if (pending)
+        return MBMakeValue(MBTableGridValueMakePending());
+    switch (function) {
+        case MBFunctionSum:
+            return MBMakeNumber(summary.sum);
+        case MBFunctionAverage:
+            return summary.numberCount ? MBMakeNumber(summary.sum / (double)summary.numberCount) :
+                MBMakeError(MBTableGridFormulaErrorDivideByZero);
+        case MBFunctionMinimum:
+            return MBMakeNumber(summary.numberCount ? summary.minimum : 0.0);
+        case MBFunctionMaximum:
+            return MBMakeNumber(summary.numberCount ? summary.maximum : 0.0);
+        case MBFunctionCount:
+            return MBMakeValue(MBTableGridValueMakeInteger((int64_t)summary.numberCount));
+        default:
+            return MBMakeValue(MBTableGridValueMakeInteger((int64_t)summary.valueCount));
+    }
+}
+
+// Blocks count their Booleans and numbers, skipping text and empty cells
+static MBTableGridFormulaValue MBEvaluateLogical(MBFunction function, const MBOperand *arguments, size_t count) {
+    bool result = (function == MBFunctionAnd), found = false, pending = false;
+    for (size_t i = 0; i < count; i++) {
+        const MBOperand *argument = &arguments[i];
+        bool inBlock = (argument->block != NULL);
+        size_t valueCount = inBlock ? argument->blockCount : 1;
+        for (size_t j = 0; j < valueCount; j++) {
+            const MBTableGridFormulaValue *value = inBlock ? &argument->block[j] : &argument->scalar;
+            if (value->error != MBTableGridFormulaErrorNone)
+                return *value;
+            MBTableGridValueType type = value->value.type;
+            if (type == MBTableGridValueTypePending) {
+                pending = true;
+                continue;
+            }
+            if (type == MBTableGridValueTypeEmpty || (inBlock && type == MBTableGridValueTypeString))
+                continue;
+            bool boolean;
+            MBTableGridFormulaError error = MBToBoolean(&value->value, &boolean);
+            if (error != MBTableGridFormulaErrorNone)
+                return MBMakeError(error);
+            found = true;
+            result = (function == MBFunctionAnd) ? (result && boolean) : (result || boolean);
+        }
+    }
+    if (pending)
+        return MBMakeValue(MBTableGridValueMakePending());
+    if (!found)
+        return MBMakeError(MBTableGridFormulaErrorValue);
+    return MBMakeValue(MBTableGridValueMakeBoolean(result));
+}
+
+// Functions of numbers given directly
+static MBTableGridFormulaValue MBEvaluateArithmetic(MBFunction function, const MBOperand *arguments, size_t count) {
+    MBTableGridFormulaValue values[2];
+    double numbers[2] = { 0.0, 0.0 };
+    for (size_t i = 0; i < count; i++) {
+        MBTableGridFormulaValue result;
+        values[i] = MBScalarOf(&arguments[i]);
+        if (MBPropagate(&values[i], NULL, &result))
+            return result;
+    }
+    for (size_t i = 0; i < count; i++) {
+        MBTableGridFormulaError error = MBToNumber(&values[i].value, &numbers[i]);
+        if (error != MBTableGridFormulaErrorNone)
+            return MBMakeError(error);
+    }
+    double x = numbers[0], y = numbers[1];
+    switch (function) {
+        case MBFunctionAbsolute:
+            return MBMakeNumber(fabs(x));
+        case MBFunctionInteger:
+            return MBMakeNumber(floor(x));
+        case MBFunctionSquareRoot:
+            return (x < 0.0) ? MBMakeError(MBTableGridFormulaErrorNumber) : MBMakeNumber(sqrt(x));
+        case MBFunctionRound: {
+            // Halves round away from zero
+            double scale = pow(10.0, trunc(y));
+            return (scale == 0.0 || !isfinite(scale)) ? MBMakeError(MBTableGridFormulaErrorNumber) : MBMakeNumber(round(x * scale) / scale);
+        }
+        case MBFunctionModulo:
+            // The result takes the sign of the divisor
+            return (y == 0.0) ? MBMakeError(MBTableGridFormulaErrorDivideByZero) : MBMakeNumber(x - y * floor(x / y));
+        case MBFunctionPower:
+            return MBMakeNumber(pow(x, y));
+        default:
+            return MBMakeError(MBTableGridFormulaErrorValue);
+    }
+}
+
+static MBTableGridFormulaValue MBEvaluateCall(MBEvaluation *evaluation, MBFunction function,
+                                              const MBOperand *arguments, size_t count) {
+    MBTableGridFormulaValue value, result;
+    switch (function) {
+        case MBFunctionSum:
+        case MBFunctionAverage:
+        case MBFunctionMinimum:
+        case MBFunctionMaximum:
+        case MBFunctionCount:
+        case MBFunctionCountA:
+            return MBSummarize(function, arguments, count);
+        case MBFunctionAnd:
+        case MBFunctionOr:
+            return MBEvaluateLogical(function, arguments, count);
+        case MBFunctionIf: {
+            bool condition;
+            value = MBScalarOf(&arguments[0]);
+            if (MBPropagate(&value, NULL, &result))
+                return result;
+            MBTableGridFormulaError error = MBToBoolean(&value.value, &condition);
+            if (error != MBTableGridFormulaErrorNone)
+                return MBMakeError(error);
+            if (condition)
+                return MBScalarOf(&arguments[1]);
+            return (count > 2) ? MBScalarOf(&arguments[2]) : MBMakeValue(MBTableGridValueMakeBoolean(false));
+        }
+        case MBFunctionIfError:
+            value = MBScalarOf(&arguments[0]);
+            return (value.error != MBTableGridFormulaErrorNone) ? MBScalarOf(&arguments[1]) : value;
+        case MBFunctionNot: {
+            bool boolean;
+            value = MBScalarOf(&arguments[0]);
+            if (MBPropagate(&value, NULL, &result))
+                return result;
+            MBTableGridFormulaError error = MBToBoolean(&value.value, &boolean);
+            return (error != MBTableGridFormulaErrorNone) ? MBMakeError(error) : MBMakeValue(MBTableGridValueMakeBoolean(!boolean));
+        }
+        case MBFunctionAbsolute:
+        case MBFunctionRound:
+        case MBFunctionInteger:
+        case MBFunctionModulo:
+        case MBFunctionPower:
+        case MBFunctionSquareRoot:
+            return MBEvaluateArithmetic(function, arguments, count);
+        case MBFunctionLength: {
+            char scratch[MBTableGridValueFormatCapacity];
+            size_t length, characters = 0;
+            value = MBScalarOf(&arguments[0]);
+            if (MBPropagate(&value, NULL, &result))
+                return result;
+            const char *text = MBToText(&value.value, scratch, &length);
+            // Counts characters, not the UTF-8 bytes that continue them
+            for (size_t i = 0; i < length; i++)
+                characters += (((unsigned char)text[i] & 0xC0) != 0x80);
+            return MBMakeValue(MBTableGridValueMakeInteger((int64_t)characters));
+        }
+        case MBFunctionConcatenate: {
+            MBTableGridFormulaValue values[MBMaximumArguments + 1];
+            for (size_t i = 0; i < count; i++) {
+                values[i] = MBScalarOf(&arguments[i]);
+                if (MBPropagate(&values[i], NULL, &result))
+                    return result;
+            }
+            return MBConcatenate(evaluation, values, count);
+        }
+        case MBFunctionUnknown:
+            break;
+    }
+    return MBMakeError(MBTableGridFormulaErrorName);
+}
+
+bool MBTableGridFormulaEvaluate(const MBTableGridFormula *formula, const MBTableGridFormulaValue *const *inputs,
+                                MBTableGridFormulaValue *result, char **string) {
+    MBOperand localStack[MBLocalStackDepth];
+    MBOperand *stack = localStack;
+    if (formula->stackDepth > MBLocalStackDepth) {
+        stack = malloc(formula->stackDepth * sizeof(MBOperand));
+        if (stack == NULL)
+            return false;
+    }
+    MBEvaluation evaluation = { NULL, false };
+    size_t depth = 0;
+    for (size_t i = 0; i < formula->instructionCount; i++) {
+        const MBInstruction *instruction = &formula->instructions[i];
+        MBOperand operand = { { { MBTableGridValueTypeEmpty, { 0 } }, MBTableGridFormulaErrorNone }, NULL, 0 };
+        switch (instruction->opcode) {
+            case MBOpcodePushNumber:
+                operand.scalar = MBMakeNumber(instruction->number);
+                stack[depth++] = operand;
+                break;
+            case MBOpcodePushString:
+                operand.scalar = MBMakeValue(MBTableGridValueMakeString(formula->strings + instruction->argument, instruction->count));
+                stack[depth++] = operand;
+                break;
+            case MBOpcodePushBoolean:
+                operand.scalar = MBMakeValue(MBTableGridValueMakeBoolean(instruction->argument != 0));
+                stack[depth++] = operand;
+                break;
+            case MBOpcodePushError:
+                operand.scalar = MBMakeError((MBTableGridFormulaError)instruction->argument);
+                stack[depth++] = operand;
+                break;
+            case MBOpcodePushReference: {
+                const MBTableGridFormulaReference *reference = &formula->references[instruction->argument];
+                operand.block = inputs[instruction->argument];
+                operand.blockCount = reference->columnCount * reference->rowCount;
+                stack[depth++] = operand;
+                break;
+            }
+            case MBOpcodeNegate:
+            case MBOpcodePercent: {
+                MBTableGridFormulaValue value = MBScalarOf(&stack[depth - 1]);
+                double number = 0.0;
+                if (!MBPropagate(&value, NULL, &operand.scalar)) {
+                    MBTableGridFormulaError error = MBToNumber(&value.value, &number);
+                    operand.scalar = (error != MBTableGridFormulaErrorNone) ? MBMakeError(error) :
+                        MBMakeNumber((instruction->opcode == MBOpcodeNegate) ? -number : number / 100.0);
+                }
+                stack[depth - 1] = operand;
+                break;
+            }
+            case MBOpcodeCall: {
+                size_t count = instruction->count;
+                operand.scalar = MBEvaluateCall(&evaluation, (MBFunction)instruction->argument, stack + depth - count, count);
+                depth -= count;
+                stack[depth++] = operand;
+                break;
+            }
+            default:
+                operand.scalar = MBEvaluateBinary(&evaluation, instruction->opcode, &stack[depth - 2], &stack[depth - 1]);
+                stack[--depth - 1] = operand;
+                break;
+        }
+    }
+
+    MBTableGridFormulaValue value = MBScalarOf(&stack[0]);
+    // A formula that refers to an empty cell is 0, as in other spreadsheets
+    if (value.error == MBTableGridFormulaErrorNone && value.value.type == MBTableGridValueTypeEmpty)
+        value = MBMakeValue(MBTableGridValueMakeInteger(0));
+    char *bytes = NULL;
+    if (!evaluation.failed && value.error == MBTableGridFormulaErrorNone && value.value.type == MBTableGridValueTypeString) {
+        bytes = malloc(value.value.data.string.length ? value.value.data.string.length : 1);
+        if (bytes) {
+            memcpy(bytes, value.value.data.string.bytes, value.value.data.string.length);
+            value.value.data.string.bytes = bytes;
+        }
+    }
+    bool succeeded = !evaluation.failed && (bytes != NULL || value.error != MBTableGridFormulaErrorNone ||
+                                            value.value.type != MBTableGridValueTypeString);
+    while (evaluation.blocks) {
+        MBArenaBlock *next = evaluation.blocks->next;
+        free(evaluation.blocks);
+        evaluation.blocks = next;
+    }
+    if (stack != localStack)
+        free(stack);
+    if (!succeeded) {
+        free(bytes);
+        return false;
+    }
+    *result = value;
+    *string = bytes;
+    return true;
+}
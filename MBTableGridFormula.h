@@ -0,0 +1,147 @@
+//
+//  MBTableGridFormula.h
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#ifndef MBTableGridFormula_h
+#define MBTableGridFormula_h
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "MBTableGridValue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief		Why a formula has no value.
+ */
+typedef enum MBTableGridFormulaError {
+    MBTableGridFormulaErrorNone = 0,
+    /* An operand of the wrong kind, such as text that isn't a number */
+    MBTableGridFormulaErrorValue,
+    MBTableGridFormulaErrorDivideByZero,
+    /* A result that isn't a finite number, such as the square root of -1 */
+    MBTableGridFormulaErrorNumber,
+    /* A function that doesn't exist */
+    MBTableGridFormulaErrorName,
+    /* A formula that depends on itself */
+    MBTableGridFormulaErrorCycle
+} MBTableGridFormulaError;
+
+/**
+ * @brief		Returns how an error is shown in a cell, such as
+ *				\c #DIV/0!, or an empty string for no error.
+ */
+const char *MBTableGridFormulaErrorString(MBTableGridFormulaError error);
+
+/**
+ * @brief		A cell's value or the error that stands in for it, as a
+ *				formula reads and returns it.
+ *
+ * @details		\c value is ignored if \c error isn't
+ *				\c MBTableGridFormulaErrorNone.
+ */
+typedef struct MBTableGridFormulaValue {
+    MBTableGridValue value;
+    MBTableGridFormulaError error;
+} MBTableGridFormulaValue;
+
+/**
+ * @brief		A block of cells a formula refers to, such as \c B2 or
+ *				\c A1:C10, in data source rows counted from 0.
+ */
+typedef struct MBTableGridFormulaReference {
+    size_t firstColumn;
+    size_t firstRow;
+    size_t columnCount;
+    size_t rowCount;
+} MBTableGridFormulaReference;
+
+/**
+ * @brief		\c MBTableGridFormula is a spreadsheet formula, compiled
+ *				so that it can be evaluated many times.
+ *
+ * @details		Formulas are written as in a spreadsheet, such as
+ *				<tt>=IF(A1>0, SUM(B1:B10) / A1, "none")</tt>. Cells are
+ *				named by their column letters, \c A for the first column,
+ *				and row numbers counting from 1; \c $ signs are allowed
+ *				and ignored. Two cells joined by a colon name the block
+ *				between them.
+ *
+ *				Operators are, from loosest to tightest, comparison
+ *				(<tt>= <> < > <= >=</tt>), \c & to join text, \c + and
+ *				\c -, \c * and \c /, \c ^, negation and \c %. The
+ *				functions are \c SUM, \c AVERAGE, \c MIN, \c MAX,
+ *				\c COUNT, \c COUNTA, \c IF, \c IFERROR, \c AND, \c OR,
+ *				\c NOT, \c ABS, \c ROUND, \c INT, \c MOD, \c POWER,
+ *				\c SQRT, \c LEN and \c CONCATENATE; a name that's none of
+ *				these evaluates to \c MBTableGridFormulaErrorName.
+ *
+ *				Empty cells count as 0 or as empty text, Booleans as 1
+ *				or 0, and text as a number only if all of it is one. The
+ *				functions that summarize skip text, Booleans and empty
+ *				cells in blocks. Dates are numbers of seconds since 1970,
+ *				so adding to one gives another date. An error in an
+ *				operand is the result, and otherwise a pending operand
+ *				makes the result pending.
+ *
+ *				The compiled formula is a list of instructions for a
+ *				stack machine. It doesn't change once created, so it can
+ *				be evaluated on several threads at once.
+ */
+typedef struct MBTableGridFormula MBTableGridFormula;
+
+/**
+ * @brief		Compiles a formula from UTF-8 text, which may start with
+ *				\c =.
+ *
+ * @return		\c NULL if the text isn't a formula or out of memory.
+ */
+MBTableGridFormula *MBTableGridFormulaCreate(const char *text, size_t length);
+
+/**
+ * @brief		Frees a formula created by \c MBTableGridFormulaCreate.
+ */
+void MBTableGridFormulaDestroy(MBTableGridFormula *formula);
+
+/**
+ * @brief		Returns the text the formula was compiled from, which is
+ *				not NUL-terminated.
+ */
+const char *MBTableGridFormulaGetText(const MBTableGridFormula *formula, size_t *length);
+
+/**
+ * @brief		Returns the number of distinct blocks of cells the
+ *				formula refers to.
+ */
+size_t MBTableGridFormulaReferenceCount(const MBTableGridFormula *formula);
+
+/**
+ * @brief		Returns the blocks of cells the formula refers to, each
+ *				listed once.
+ */
+const MBTableGridFormulaReference *MBTableGridFormulaGetReferences(const MBTableGridFormula *formula);
+
+/**
+ * @brief		Evaluates a formula.
+ *
+ * @details		\c inputs holds the cells of each of the formula's
+ *				references, in the order they're listed, column by
+ *				column. A string result is copied into a buffer that
+ *				\c *string is set to and the caller frees; otherwise
+ *				\c *string is set to \c NULL. Returns \c false if out of
+ *				memory, leaving \c result unchanged.
+ */
+bool MBTableGridFormulaEvaluate(const MBTableGridFormula *formula, const MBTableGridFormulaValue *const *inputs,
+                                MBTableGridFormulaValue *result, char **string);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MBTableGridFormula_h */
@@ -0,0 +1,917 @@
+//
+//  MBTableGridFormulaSheet.c
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#include "MBTableGridFormulaSheet.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MBNone UINT32_MAX
+// Rows read from a column at a time
+#define MBReadBatchSize 4096
+
+// A cell that holds a formula or is read by one on its own; blocks of cells are kept
+// with their columns instead. Cells stay in the table once added, until it next grows.
+typedef struct MBCell {
+    size_t column;
+    size_t row;
+    uint32_t formula;
+    // The first of the formulas that read the cell, linked through the sheet's readers
+    uint32_t firstReader;
+    bool occupied;
+} MBCell;
+
+typedef struct MBReader {
+    uint32_t formula;
+    uint32_t next;
+} MBReader;
+
+typedef struct MBBlockReader {
+    uint32_t formula;
+    size_t firstRow;
+    size_t lastRow;
+} MBBlockReader;
+
+typedef struct MBColumn {
+    MBBlockReader *readers;
+    size_t readerCount;
+    size_t readerCapacity;
+    size_t formulaCount;
+} MBColumn;
+
+typedef struct MBFormulaSlot {
+    // NULL if the slot is free, in which case nextFree links it to the next one
+    MBTableGridFormula *formula;
+    size_t column;
+    size_t row;
+    MBTableGridFormulaValue result;
+    char *resultString;
+    uint32_t nextFree;
+
+    // Worked out afresh by each recalculation that visits the formula, which it
+    // marks with its epoch
+    uint32_t epoch;
+    uint32_t index;
+    uint32_t lowlink;
+    uint32_t component;
+    uint32_t level;
+    uint32_t edgeCount;
+    size_t firstEdge;
+    bool onStack;
+    bool cyclic;
+} MBFormulaSlot;
+
+typedef struct MBChange {
+    size_t column;
+    size_t firstRow;
+    size_t count;
+} MBChange;
+
+struct MBTableGridFormulaSheet {
+    MBCell *cells;
+    size_t cellCapacity;
+    size_t cellCount;
+
+    MBReader *readers;
+    size_t readerCount;
+    size_t readerCapacity;
+    uint32_t freeReader;
+
+    MBColumn *columns;
+    size_t columnCount;
+
+    MBFormulaSlot *formulas;
+    size_t formulaSlotCount;
+    size_t formulaSlotCapacity;
+    size_t formulaCount;
+    uint32_t freeFormula;
+
+    MBChange *changes;
+    size_t changeCount;
+    size_t changeCapacity;
+    uint32_t *changedFormulas;
+    size_t changedFormulaCount;
+    size_t changedFormulaCapacity;
+    bool allChanged;
+
+    uint32_t epoch;
+};
+
+static bool MBGrow(void **items, size_t *capacity, size_t count, size_t size) {
+    if (count < *capacity)
+        return true;
+    size_t newCapacity = *capacity ? 2 * *capacity : 8;
+    void *newItems = realloc(*items, newCapacity * size);
+    if (newItems == NULL)
+        return false;
+    *items = newItems;
+    *capacity = newCapacity;
+    return true;
+}
+
+static inline uint64_t MBMix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+static inline size_t MBCellHash(size_t column, size_t row) {
+    return (size_t)MBMix((uint64_t)column * 0x9e3779b97f4a7c15ULL ^ (uint64_t)row);
+}
+
+
+static MBCell *MBFindCell(const MBTableGridFormulaSheet *sheet, size_t column, size_t row) {
+    if (sheet->cellCapacity == 0)
+        return NULL;
+    size_t mask = sheet->cellCapacity - 1;
+    for (size_t slot = MBCellHash(column, row) & mask; sheet->cells[slot].occupied; slot = (slot + 1) & mask) {
+        if (sheet->cells[slot].column == column && sheet->cells[slot].row == row)
+            return &sheet->cells[slot];
+    }
+    return NULL;
+}
+
+// Cells that no longer hold or are read by any formula are left behind when the table
+// grows, keeping it at most half full by linear probing
+static bool MBRehashCells(MBTableGridFormulaSheet *sheet, size_t capacity) {
+    MBCell *cells = calloc(capacity, sizeof(MBCell));
+    if (cells == NULL)
+        return false;
+    size_t count = 0;
+    for (size_t i = 0; i < sheet->cellCapacity; i++) {
+        const MBCell *cell = &sheet->cells[i];
+        if (!cell->occupied || (cell->formula == MBNone && cell->firstReader == MBNone))
+            continue;
+        size_t slot = MBCellHash(cell->column, cell->row) & (capacity - 1);
+        while (cells[slot].occupied)
+            slot = (slot + 1) & (capacity - 1);
+        cells[slot] = *cell;
+        count++;
+    }
+    free(sheet->cells);
+    sheet->cells = cells;
+    sheet->cellCapacity = capacity;
+    sheet->cellCount = count;
+    return true;
+}
+
+// Pointers to cells last until the next cell is added
+static MBCell *MBAddCell(MBTableGridFormulaSheet *sheet, size_t column, size_t row) {
+    MBCell *cell = MBFindCell(sheet, column, row);
+    if (cell)
+        return cell;
+    if (2 * (sheet->cellCount + 1) > sheet->cellCapacity &&
+        !MBRehashCells(sheet, sheet->cellCapacity ? 2 * sheet->cellCapacity : 64))
+        return NULL;
+    size_t mask = sheet->cellCapacity - 1;
+    size_t slot = MBCellHash(column, row) & mask;
+    while (sheet->cells[slot].occupied)
+        slot = (slot + 1) & mask;
+    sheet->cells[slot] = (MBCell){ column, row, MBNone, MBNone, true };
+    sheet->cellCount++;
+    return &sheet->cells[slot];
+}
+
+static MBColumn *MBAddColumn(MBTableGridFormulaSheet *sheet, size_t column) {
+    if (column >= sheet->columnCount) {
+        size_t count = sheet->columnCount ? sheet->columnCount : 8;
+        while (count <= column)
+            count *= 2;
+        MBColumn *columns = realloc(sheet->columns, count * sizeof(MBColumn));
+        if (columns == NULL)
+            return NULL;
+        memset(columns + sheet->columnCount, 0, (count - sheet->columnCount) * sizeof(MBColumn));
+        sheet->columns = columns;
+        sheet->columnCount = count;
+    }
+    return &sheet->columns[column];
+}
+
+
+// Takes a formula's references out of the graph, including any only partly put in
+static void MBUnlinkFormula(MBTableGridFormulaSheet *sheet, uint32_t formula) {
+    const MBTableGridFormula *compiled = sheet->formulas[formula].formula;
+    const MBTableGridFormulaReference *references = MBTableGridFormulaGetReferences(compiled);
+    for (size_t i = 0; i < MBTableGridFormulaReferenceCount(compiled); i++) {
+        const MBTableGridFormulaReference *reference = &references[i];
+        if (reference->columnCount == 1 && reference->rowCount == 1) {
+            MBCell *cell = MBFindCell(sheet, reference->firstColumn, reference->firstRow);
+            uint32_t *link = cell ? &cell->firstReader : NULL;
+            while (link && *link != MBNone) {
+                uint32_t reader = *link;
+                if (sheet->readers[reader].formula == formula) {
+                    *link = sheet->readers[reader].next;
+                    sheet->readers[reader].next = sheet->freeReader;
+                    sheet->freeReader = reader;
+                    break;
+                }
+                link = &sheet->readers[reader].next;
+            }
+            continue;
+        }
+        for (size_t column = reference->firstColumn; column - reference->firstColumn < reference->columnCount &&
+             column < sheet->columnCount; column++) {
+            MBColumn *readers = &sheet->columns[column];
+            for (size_t j = 0; j < readers->readerCount; ) {
+                if (readers->readers[j].formula == formula)
+                    readers->readers[j] = readers->readers[--readers->readerCount];
+                else
+                    j++;
+            }
+        }
+    }
+}
+
+static bool MBLinkFormula(MBTableGridFormulaSheet *sheet, uint32_t formula) {
+    const MBTableGridFormula *compiled = sheet->formulas[formula].formula;
+    const MBTableGridFormulaReference *references = MBTableGridFormulaGetReferences(compiled);
+    for (size_t i = 0; i < MBTableGridFormulaReferenceCount(compiled); i++) {
+        const MBTableGridFormulaReference *reference = &references[i];
+        if (reference->columnCount == 1 && reference->rowCount == 1) {
+            uint32_t reader = sheet->freeReader;
+            if (reader == MBNone) {
+                if (sheet->readerCount >= MBNone ||
+                    !MBGrow((void **)&sheet->readers, &sheet->readerCapacity, sheet->readerCount, sizeof(MBReader)))
+                    return false;
+                reader = (uint32_t)sheet->readerCount++;
+            } else {
+                sheet->freeReader = sheet->readers[reader].next;
+            }
+            MBCell *cell = MBAddCell(sheet, reference->firstColumn, reference->firstRow);
+            if (cell == NULL) {
+                sheet->readers[reader].next = sheet->freeReader;
+                sheet->freeReader = reader;
+                return false;
+            }
+            sheet->readers[reader] = (MBReader){ formula, cell->firstReader };
+            cell->firstReader = reader;
+            continue;
+        }
+        size_t lastRow = reference->firstRow + reference->rowCount - 1;
+        for (size_t column = reference->firstColumn; column - reference->firstColumn < reference->columnCount; column++) {
+            MBColumn *readers = MBAddColumn(sheet, column);
+            if (readers == NULL ||
+                !MBGrow((void **)&readers->readers, &readers->readerCapacity, readers->readerCount, sizeof(MBBlockReader)))
+                return false;
+            readers->readers[readers->readerCount++] = (MBBlockReader){ formula, reference->firstRow, lastRow };
+        }
+    }
+    return true;
+}
+
+// Calls visit for each formula that reads any of count rows of a column
+static void MBVisitReaders(const MBTableGridFormulaSheet *sheet, size_t column, size_t firstRow, size_t count,
+                           void (*visit)(void *context, uint32_t formula), void *context) {
+    if (count == 0)
+        return;
+    size_t lastRow = (count - 1 > SIZE_MAX - firstRow) ? SIZE_MAX : firstRow + count - 1;
+    if (count <= sheet->cellCount) {
+        for (size_t row = firstRow; row - firstRow < count; row++) {
+            const MBCell *cell = MBFindCell(sheet, column, row);
+            for (uint32_t reader = cell ? cell->firstReader : MBNone; reader != MBNone; reader = sheet->readers[reader].next)
+                visit(context, sheet->readers[reader].formula);
+        }
+    } else {
+        // Fewer cells in the table than rows changed
+        for (size_t i = 0; i < sheet->cellCapacity; i++) {
+            const MBCell *cell = &sheet->cells[i];
+            if (!cell->occupied || cell->column != column || cell->row < firstRow || cell->row > lastRow)
+                continue;
+            for (uint32_t reader = cell->firstReader; reader != MBNone; reader = sheet->readers[reader].next)
+                visit(context, sheet->readers[reader].formula);
+        }
+    }
+    if (column < sheet->columnCount) {
+        const MBColumn *readers = &sheet->columns[column];
+        for (size_t i = 0; i < readers->readerCount; i++) {
+            if (readers->readers[i].firstRow <= lastRow && readers->readers[i].lastRow >= firstRow)
+                visit(context, readers->readers[i].formula);
+        }
+    }
+}
+
+
+MBTableGridFormulaSheet *MBTableGridFormulaSheetCreate(void) {
+    MBTableGridFormulaSheet *sheet = calloc(1, sizeof(MBTableGridFormulaSheet));
+    if (sheet == NULL)
+        return NULL;
+    sheet->freeReader = MBNone;
+    sheet->freeFormula = MBNone;
+    return sheet;
+}
+
+void MBTableGridFormulaSheetDestroy(MBTableGridFormulaSheet *sheet) {
+    if (sheet == NULL)
+        return;
+    for (size_t i = 0; i < sheet->formulaSlotCount; i++) {
+        MBTableGridFormulaDestroy(sheet->formulas[i].formula);
+        free(sheet->formulas[i].resultString);
+    }
+    for (size_t i = 0; i < sheet->columnCount; i++)
+        free(sheet->columns[i].readers);
+    free(sheet->formulas);
+    free(sheet->columns);
+    free(sheet->cells);
+    free(sheet->readers);
+    free(sheet->changes);
+    free(sheet->changedFormulas);
+    free(sheet);
+}
+
+size_t MBTableGridFormulaSheetCount(const MBTableGridFormulaSheet *sheet) {
+    return sheet->formulaCount;
+}
+
+bool MBTableGridFormulaSheetColumnHasFormulas(const MBTableGridFormulaSheet *sheet, size_t column) {
+    return column < sheet->columnCount && sheet->columns[column].formulaCount > 0;
+}
+
+static const MBFormulaSlot *MBFindFormula(const MBTableGridFormulaSheet *sheet, size_t column, size_t row) {
+    if (!MBTableGridFormulaSheetColumnHasFormulas(sheet, column))
+        return NULL;
+    const MBCell *cell = MBFindCell(sheet, column, row);
+    return (cell && cell->formula != MBNone) ? &sheet->formulas[cell->formula] : NULL;
+}
+
+static void MBNoteFormulaChange(MBTableGridFormulaSheet *sheet, uint32_t formula) {
+    if (!MBGrow((void **)&sheet->changedFormulas, &sheet->changedFormulaCapacity, sheet->changedFormulaCount, sizeof(uint32_t))) {
+        sheet->allChanged = true;
+        return;
+    }
+    sheet->changedFormulas[sheet->changedFormulaCount++] = formula;
+}
+
+bool MBTableGridFormulaSheetSetFormula(MBTableGridFormulaSheet *sheet, size_t column, size_t row,
+                                       const char *text, size_t length) {
+    MBTableGridFormulaSheetRemoveFormula(sheet, column, row);
+    MBTableGridFormula *compiled = MBTableGridFormulaCreate(text, length);
+    if (compiled == NULL)
+        return false;
+
+    uint32_t formula = sheet->freeFormula;
+    if (formula == MBNone) {
+        if (sheet->formulaSlotCount >= MBNone ||
+            !MBGrow((void **)&sheet->formulas, &sheet->formulaSlotCapacity, sheet->formulaSlotCount, sizeof(MBFormulaSlot))) {
+            MBTableGridFormulaDestroy(compiled);
+            return false;
+        }
+        formula = (uint32_t)sheet->formulaSlotCount++;
+    } else {
+        sheet->freeFormula = sheet->formulas[formula].nextFree;
+    }
+    MBFormulaSlot *slot = &sheet->formulas[formula];
+    memset(slot, 0, sizeof(MBFormulaSlot));
+    slot->formula = compiled;
+    slot->column = column;
+    slot->row = row;
+    slot->result.value = MBTableGridValueMakePending();
+    slot->nextFree = MBNone;
+
+    MBColumn *columnFormulas = MBAddColumn(sheet, column);
+    MBCell *cell = NULL;
+    bool linked = (columnFormulas != NULL) && MBLinkFormula(sheet, formula);
+    if (linked)
+        cell = MBAddCell(sheet, column, row);
+    if (cell == NULL) {
+        if (columnFormulas)
+            MBUnlinkFormula(sheet, formula);
+        MBTableGridFormulaDestroy(compiled);
+        slot->formula = NULL;
+        slot->nextFree = sheet->freeFormula;
+        sheet->freeFormula = formula;
+        return false;
+    }
+    cell->formula = formula;
+    sheet->columns[column].formulaCount++;
+    sheet->formulaCount++;
+    MBNoteFormulaChange(sheet, formula);
+    return true;
+}
+
+void MBTableGridFormulaSheetRemoveFormula(MBTableGridFormulaSheet *sheet, size_t column, size_t row) {
+    MBCell *cell = MBTableGridFormulaSheetColumnHasFormulas(sheet, column) ? MBFindCell(sheet, column, row) : NULL;
+    if (cell == NULL || cell->formula == MBNone)
+        return;
+    uint32_t formula = cell->formula;
+    MBFormulaSlot *slot = &sheet->formulas[formula];
+    cell->formula = MBNone;
+    MBUnlinkFormula(sheet, formula);
+    MBTableGridFormulaDestroy(slot->formula);
+    free(slot->resultString);
+    slot->formula = NULL;
+    slot->resultString = NULL;
+    slot->nextFree = sheet->freeFormula;
+    sheet->freeFormula = formula;
+    sheet->columns[column].formulaCount--;
+    sheet->formulaCount--;
+    MBTableGridFormulaSheetNoteChange(sheet, column, row, 1);
+}
+
+const char *MBTableGridFormulaSheetGetText(const MBTableGridFormulaSheet *sheet, size_t column, size_t row, size_t *length) {
+    const MBFormulaSlot *slot = MBFindFormula(sheet, column, row);
+    return slot ? MBTableGridFormulaGetText(slot->formula, length) : NULL;
+}
+
+bool MBTableGridFormulaSheetGetResult(const MBTableGridFormulaSheet *sheet, size_t column, size_t row,
+                                      MBTableGridFormulaValue *result) {
+    const MBFormulaSlot *slot = MBFindFormula(sheet, column, row);
+    if (slot == NULL)
+        return false;
+    *result = slot->result;
+    return true;
+}
+
+void MBTableGridFormulaSheetNoteChange(MBTableGridFormulaSheet *sheet, size_t column, size_t firstRow, size_t count) {
+    if (sheet->allChanged || count == 0)
+        return;
+    // Runs of rows edited one after another are kept as one
+    if (sheet->changeCount) {
+        MBChange *last = &sheet->changes[sheet->changeCount - 1];
+        if (last->column == column && last->firstRow + last->count == firstRow) {
+            last->count += count;
+            return;
+        }
+    }
+    if (!MBGrow((void **)&sheet->changes, &sheet->changeCapacity, sheet->changeCount, sizeof(MBChange))) {
+        sheet->allChanged = true;
+        return;
+    }
+    sheet->changes[sheet->changeCount++] = (MBChange){ column, firstRow, count };
+}
+
+void MBTableGridFormulaSheetNoteAllChanged(MBTableGridFormulaSheet *sheet) {
+    sheet->allChanged = true;
+}
+
+
+typedef struct MBRecalculation {
+    MBTableGridFormulaSheet *sheet;
+    uint32_t epoch;
+    bool failed;
+
+    // Formulas to start from, which may be listed more than once
+    uint32_t *roots;
+    size_t rootCount;
+    size_t rootCapacity;
+
+    // The formulas each visited formula's result is read by, found once
+    uint32_t *edges;
+    size_t edgeCount;
+    size_t edgeCapacity;
+
+    // Visited formulas, in the order Tarjan's algorithm finishes their components,
+    // which is the reverse of the order they can be evaluated in
+    uint32_t *finished;
+    size_t finishedCount;
+
+    uint32_t *tarjanStack;
+    size_t tarjanDepth;
+    uint32_t *callStack;
+    uint32_t *callEdges;
+    size_t callDepth;
+    size_t visitedCount;
+    size_t visitedCapacity;
+    uint32_t componentCount;
+} MBRecalculation;
+
+static void MBAddRoot(void *context, uint32_t formula) {
+    MBRecalculation *recalculation = context;
+    if (!MBGrow((void **)&recalculation->roots, &recalculation->rootCapacity, recalculation->rootCount, sizeof(uint32_t))) {
+        recalculation->failed = true;
+        return;
+    }
+    recalculation->roots[recalculation->rootCount++] = formula;
+}
+
+static void MBAddEdge(void *context, uint32_t formula) {
+    MBRecalculation *recalculation = context;
+    if (!MBGrow((void **)&recalculation->edges, &recalculation->edgeCapacity, recalculation->edgeCount, sizeof(uint32_t))) {
+        recalculation->failed = true;
+        return;
+    }
+    recalculation->edges[recalculation->edgeCount++] = formula;
+}
+
+// Gives a formula its place in the search, and finds the formulas that read it
+static bool MBVisit(MBRecalculation *recalculation, uint32_t formula) {
+    MBTableGridFormulaSheet *sheet = recalculation->sheet;
+    if (recalculation->visitedCount == recalculation->visitedCapacity) {
+        size_t capacity = recalculation->visitedCapacity ? 2 * recalculation->visitedCapacity : 64;
+        uint32_t *tarjanStack = realloc(recalculation->tarjanStack, capacity * sizeof(uint32_t));
+        if (tarjanStack)
+            recalculation->tarjanStack = tarjanStack;
+        uint32_t *callStack = realloc(recalculation->callStack, capacity * sizeof(uint32_t));
+        if (callStack)
+            recalculation->callStack = callStack;
+        uint32_t *callEdges = realloc(recalculation->callEdges, capacity * sizeof(uint32_t));
+        if (callEdges)
+            recalculation->callEdges = callEdges;
+        uint32_t *finished = realloc(recalculation->finished, capacity * sizeof(uint32_t));
+        if (finished)
+            recalculation->finished = finished;
+        if (tarjanStack == NULL || callStack == NULL || callEdges == NULL || finished == NULL)
+            return false;
+        recalculation->visitedCapacity = capacity;
+    }
+    MBFormulaSlot *slot = &sheet->formulas[formula];
+    slot->epoch = recalculation->epoch;
+    slot->index = slot->lowlink = (uint32_t)recalculation->visitedCount++;
+    slot->level = 0;
+    slot->cyclic = false;
+    slot->onStack = true;
+    slot->firstEdge = recalculation->edgeCount;
+    MBVisitReaders(sheet, slot->column, slot->row, 1, MBAddEdge, recalculation);
+    slot->edgeCount = (uint32_t)(recalculation->edgeCount - slot->firstEdge);
+    recalculation->tarjanStack[recalculation->tarjanDepth++] = formula;
+    recalculation->callStack[recalculation->callDepth] = formula;
+    recalculation->callEdges[recalculation->callDepth++] = 0;
+    return !recalculation->failed;
+}
+
+// Tarjan's algorithm, with the recursion kept on a stack of its own, since chains of
+// formulas can be far longer than the C stack is deep
+static bool MBFindComponents(MBRecalculation *recalculation, uint32_t root) {
+    MBFormulaSlot *formulas = recalculation->sheet->formulas;
+    if (formulas[root].epoch == recalculation->epoch)
+        return true;
+    if (!MBVisit(recalculation, root))
+        return false;
+    while (recalculation->callDepth) {
+        uint32_t formula = recalculation->callStack[recalculation->callDepth - 1];
+        MBFormulaSlot *slot = &formulas[formula];
+        uint32_t edge = recalculation->callEdges[recalculation->callDepth - 1];
+        if (edge < slot->edgeCount) {
+            recalculation->callEdges[recalculation->callDepth - 1]++;
+            uint32_t reader = recalculation->edges[slot->firstEdge + edge];
+            MBFormulaSlot *readerSlot = &formulas[reader];
+            if (reader == formula) {
+                slot->cyclic = true;
+            } else if (readerSlot->epoch != recalculation->epoch) {
+                if (!MBVisit(recalculation, reader))
+                    return false;
+            } else if (readerSlot->onStack && readerSlot->index < slot->lowlink) {
+                slot->lowlink = readerSlot->index;
+            }
+            continue;
+        }
+        recalculation->callDepth--;
+        if (slot->lowlink == slot->index) {
+            uint32_t member, component = recalculation->componentCount++;
+            size_t first = recalculation->finishedCount;
+            do {
+                member = recalculation->tarjanStack[--recalculation->tarjanDepth];
+                formulas[member].onStack = false;
+                formulas[member].component = component;
+                recalculation->finished[recalculation->finishedCount++] = member;
+            } while (member != formula);
+            // Formulas that read each other can't be worked out
+            if (recalculation->finishedCount - first > 1) {
+                for (size_t i = first; i < recalculation->finishedCount; i++)
+                    formulas[recalculation->finished[i]].cyclic = true;
+            }
+        }
+        if (recalculation->callDepth) {
+            MBFormulaSlot *caller = &formulas[recalculation->callStack[recalculation->callDepth - 1]];
+            if (slot->lowlink < caller->lowlink)
+                caller->lowlink = slot->lowlink;
+        }
+    }
+    return true;
+}
+
+// A level's formulas evaluated together, with the cells each reads
+typedef struct MBBatch {
+    MBTableGridFormulaSheet *sheet;
+    const uint32_t *formulas;
+    size_t count;
+    MBTableGridFormulaValue **inputs;
+    MBTableGridFormulaValue *results;
+    char **strings;
+    bool *evaluated;
+} MBBatch;
+
+static void MBEvaluateFormula(void *context, size_t iteration) {
+    MBBatch *batch = context;
+    const MBFormulaSlot *slot = &batch->sheet->formulas[batch->formulas[iteration]];
+    if (slot->cyclic) {
+        batch->results[iteration] = (MBTableGridFormulaValue){ .error = MBTableGridFormulaErrorCycle };
+        batch->strings[iteration] = NULL;
+        batch->evaluated[iteration] = true;
+        return;
+    }
+    size_t referenceCount = MBTableGridFormulaReferenceCount(slot->formula);
+    const MBTableGridFormulaValue *localInputs[8];
+    const MBTableGridFormulaValue **inputs = localInputs;
+    if (referenceCount > 8) {
+        inputs = malloc(referenceCount * sizeof(MBTableGridFormulaValue *));
+        if (inputs == NULL) {
+            batch->evaluated[iteration] = false;
+            return;
+        }
+    }
+    // Each reference's cells follow the one before's
+    const MBTableGridFormulaReference *references = MBTableGridFormulaGetReferences(slot->formula);
+    const MBTableGridFormulaValue *input = batch->inputs[iteration];
+    for (size_t i = 0; i < referenceCount; i++) {
+        inputs[i] = input;
+        input += references[i].columnCount * references[i].rowCount;
+    }
+    batch->evaluated[iteration] = MBTableGridFormulaEvaluate(slot->formula, inputs, &batch->results[iteration],
+                                                             &batch->strings[iteration]);
+    if (inputs != localInputs)
+        free(inputs);
+}
+
+static size_t MBCellCount(const MBFormulaSlot *slot) {
+    if (slot->cyclic)
+        return 0;
+    size_t count = 0;
+    const MBTableGridFormulaReference *references = MBTableGridFormulaGetReferences(slot->formula);
+    for (size_t i = 0; i < MBTableGridFormulaReferenceCount(slot->formula); i++) {
+        size_t cells = references[i].columnCount * references[i].rowCount;
+        count = (cells > SIZE_MAX - count) ? SIZE_MAX : count + cells;
+    }
+    return count;
+}
+
+typedef struct MBStrings {
+    char *bytes;
+    size_t length;
+    size_t capacity;
+} MBStrings;
+
+// Reads the cells of a formula's references, keeping strings as offsets into strings
+// until it stops growing. Cells that hold formulas are filled in afterwards. Formulas in
+// a cycle read nothing, as MBCellCount gives them no room.
+static bool MBReadInputs(const MBFormulaSlot *slot, MBTableGridFormulaValue *inputs,
+                         MBTableGridValue *values, MBStrings *strings, MBTableGridFormulaReadFunction read, void *context) {
+    if (slot->cyclic)
+        return true;
+    const MBTableGridFormulaReference *references = MBTableGridFormulaGetReferences(slot->formula);
+    for (size_t i = 0; i < MBTableGridFormulaReferenceCount(slot->formula); i++) {
+        const MBTableGridFormulaReference *reference = &references[i];
+        for (size_t column = 0; column < reference->columnCount; column++) {
+            for (size_t row = 0; row < reference->rowCount; row += MBReadBatchSize) {
+                size_t count = (reference->rowCount - row < MBReadBatchSize) ? reference->rowCount - row : MBReadBatchSize;
+                memset(values, 0, count * sizeof(MBTableGridValue));
+                if (!read(context, reference->firstColumn + column, reference->firstRow + row, count, values))
+                    return false;
+                for (size_t j = 0; j < count; j++) {
+                    MBTableGridValue value = values[j];
+                    if (value.type == MBTableGridValueTypeString) {
+                        size_t length = value.data.string.length;
+                        if (strings->capacity - strings->length < length) {
+                            size_t capacity = strings->capacity ? strings->capacity : 4096;
+                            while (capacity - strings->length < length)
+                                capacity *= 2;
+                            char *bytes = realloc(strings->bytes, capacity);
+                            if (bytes == NULL)
+                                return false;
+                            strings->bytes = bytes;
+                            strings->capacity = capacity;
+                        }
+                        if (length)
+                            memcpy(strings->bytes + strings->length, value.data.string.bytes, length);
+                        value.data.string.bytes = (const char *)(uintptr_t)strings->length;
+                        strings->length += length;
+                    }
+                    inputs[j] = (MBTableGridFormulaValue){ value, MBTableGridFormulaErrorNone };
+                }
+                inputs += count;
+            }
+        }
+    }
+    return true;
+}
+
+// Puts the results of formulas the formula reads in place of the cells' values, which
+// those formulas' levels have already worked out
+static void MBFillInFormulas(const MBTableGridFormulaSheet *sheet, const MBFormulaSlot *slot, MBTableGridFormulaValue *inputs) {
+    if (slot->cyclic)
+        return;
+    const MBTableGridFormulaReference *references = MBTableGridFormulaGetReferences(slot->formula);
+    for (size_t i = 0; i < MBTableGridFormulaReferenceCount(slot->formula); i++) {
+        const MBTableGridFormulaReference *reference = &references[i];
+        for (size_t column = 0; column < reference->columnCount; column++) {
+            MBTableGridFormulaValue *columnInputs = inputs + column * reference->rowCount;
+            size_t sheetColumn = reference->firstColumn + column;
+            if (!MBTableGridFormulaSheetColumnHasFormulas(sheet, sheetColumn))
+                continue;
+            if (reference->rowCount <= sheet->cellCount) {
+                for (size_t row = 0; row < reference->rowCount; row++) {
+                    const MBCell *cell = MBFindCell(sheet, sheetColumn, reference->firstRow + row);
+                    if (cell && cell->formula != MBNone)
+                        columnInputs[row] = sheet->formulas[cell->formula].result;
+                }
+            } else {
+                for (size_t j = 0; j < sheet->cellCapacity; j++) {
+                    const MBCell *cell = &sheet->cells[j];
+                    if (cell->occupied && cell->formula != MBNone && cell->column == sheetColumn &&
+                        cell->row >= reference->firstRow && cell->row - reference->firstRow < reference->rowCount)
+                        columnInputs[cell->row - reference->firstRow] = sheet->formulas[cell->formula].result;
+                }
+            }
+        }
+        inputs += reference->columnCount * reference->rowCount;
+    }
+}
+
+static bool MBResultsEqual(const MBTableGridFormulaValue *a, const MBTableGridFormulaValue *b) {
+    if (a->error != b->error)
+        return false;
+    if (a->error != MBTableGridFormulaErrorNone)
+        return true;
+    if (a->value.type != b->value.type)
+        return false;
+    switch (a->value.type) {
+        case MBTableGridValueTypeInteger:
+            return a->value.data.integer == b->value.data.integer;
+        case MBTableGridValueTypeDouble:
+        case MBTableGridValueTypeDate:
+            return a->value.data.number == b->value.data.number;
+        case MBTableGridValueTypeBoolean:
+            return a->value.data.boolean == b->value.data.boolean;
+        case MBTableGridValueTypeString:
+            return a->value.data.string.length == b->value.data.string.length &&
+                (a->value.data.string.length == 0 ||
+                 memcmp(a->value.data.string.bytes, b->value.data.string.bytes, a->value.data.string.length) == 0);
+        default:
+            return true;
+    }
+}
+
+// Reads the cells a run of a level's formulas read, evaluates the formulas on every
+// processor, and then keeps their results, reporting those that changed
+static bool MBEvaluateBatch(MBTableGridFormulaSheet *sheet, const uint32_t *formulas, size_t count,
+                            MBTableGridFormulaReadFunction read, MBTableGridFormulaChangeFunction change,
+                            void *context, MBTableGridSortApplyFunction apply) {
+    MBBatch batch = { sheet, formulas, count, NULL, NULL, NULL, NULL };
+    MBStrings strings = { NULL, 0, 0 };
+    size_t *cellCounts = malloc(count * sizeof(size_t));
+    MBTableGridValue *values = malloc(MBReadBatchSize * sizeof(MBTableGridValue));
+    batch.inputs = calloc(count, sizeof(MBTableGridFormulaValue *));
+    batch.results = malloc(count * sizeof(MBTableGridFormulaValue));
+    batch.strings = calloc(count, sizeof(char *));
+    batch.evaluated = calloc(count, sizeof(bool));
+    bool succeeded = (cellCounts && values && batch.inputs && batch.results && batch.strings && batch.evaluated);
+
+    for (size_t i = 0; i < count && succeeded; i++) {
+        const MBFormulaSlot *slot = &sheet->formulas[formulas[i]];
+        cellCounts[i] = MBCellCount(slot);
+        batch.inputs[i] = malloc((cellCounts[i] ? cellCounts[i] : 1) * sizeof(MBTableGridFormulaValue));
+        succeeded = (batch.inputs[i] != NULL) && (cellCounts[i] < SIZE_MAX / sizeof(MBTableGridFormulaValue)) &&
+                    MBReadInputs(slot, batch.inputs[i], values, &strings, read, context);
+    }
+    for (size_t i = 0; i < count && succeeded; i++) {
+        for (size_t j = 0; j < cellCounts[i]; j++) {
+            MBTableGridValue *value = &batch.inputs[i][j].value;
+            if (value->type == MBTableGridValueTypeString)
+                value->data.string.bytes = strings.bytes + (uintptr_t)value->data.string.bytes;
+        }
+        MBFillInFormulas(sheet, &sheet->formulas[formulas[i]], batch.inputs[i]);
+    }
+
+    if (succeeded) {
+        if (apply && count > 1) {
+            apply(count, &batch, MBEvaluateFormula);
+        } else {
+            for (size_t i = 0; i < count; i++)
+                MBEvaluateFormula(&batch, i);
+        }
+        for (size_t i = 0; i < count; i++)
+            succeeded = succeeded && batch.evaluated[i];
+    }
+    for (size_t i = 0; i < count && succeeded; i++) {
+        MBFormulaSlot *slot = &sheet->formulas[formulas[i]];
+        bool changed = !MBResultsEqual(&slot->result, &batch.results[i]);
+        free(slot->resultString);
+        slot->result = batch.results[i];
+        slot->resultString = batch.strings[i];
+        batch.strings[i] = NULL;
+        if (changed && change)
+            change(context, slot->column, slot->row);
+    }
+
+    for (size_t i = 0; batch.strings && i < count; i++)
+        free(batch.strings[i]);
+    for (size_t i = 0; batch.inputs && i < count; i++)
+        free(batch.inputs[i]);
+    free(batch.inputs);
+    free(batch.results);
+    free(batch.strings);
+    free(batch.evaluated);
+    free(cellCounts);
+    free(values);
+    free(strings.bytes);
+    return succeeded;
+}
+
+static void MBFreeRecalculation(MBRecalculation *recalculation) {
+    free(recalculation->roots);
+    free(recalculation->edges);
+    free(recalculation->finished);
+    free(recalculation->tarjanStack);
+    free(recalculation->callStack);
+    free(recalculation->callEdges);
+}
+
+bool MBTableGridFormulaSheetRecalculate(MBTableGridFormulaSheet *sheet, MBTableGridFormulaReadFunction read,
+                                        MBTableGridFormulaChangeFunction change, void *context,
+                                        MBTableGridSortApplyFunction apply) {
+    if (!sheet->allChanged && sheet->changeCount == 0 && sheet->changedFormulaCount == 0)
+        return true;
+    // Epochs start again from 1 once they run out, forgetting every earlier visit
+    if (++sheet->epoch == 0) {
+        for (size_t i = 0; i < sheet->formulaSlotCount; i++)
+            sheet->formulas[i].epoch = 0;
+        sheet->epoch = 1;
+    }
+    MBRecalculation recalculation = { .sheet = sheet, .epoch = sheet->epoch };
+
+    // Formulas changed themselves, and those that read changed cells, are where the
+    // search starts
+    if (sheet->allChanged) {
+        for (uint32_t i = 0; i < sheet->formulaSlotCount; i++) {
+            if (sheet->formulas[i].formula)
+                MBAddRoot(&recalculation, i);
+        }
+    } else {
+        for (size_t i = 0; i < sheet->changedFormulaCount; i++) {
+            uint32_t formula = sheet->changedFormulas[i];
+            if (formula < sheet->formulaSlotCount && sheet->formulas[formula].formula)
+                MBAddRoot(&recalculation, formula);
+        }
+        for (size_t i = 0; i < sheet->changeCount; i++)
+            MBVisitReaders(sheet, sheet->changes[i].column, sheet->changes[i].firstRow, sheet->changes[i].count,
+                           MBAddRoot, &recalculation);
+    }
+    bool succeeded = !recalculation.failed;
+    for (size_t i = 0; i < recalculation.rootCount && succeeded; i++)
+        succeeded = MBFindComponents(&recalculation, recalculation.roots[i]);
+
+    // In the reverse of the order components finished, every formula comes after those
+    // it reads, so each can go a level past any it's read by so far
+    uint32_t levelCount = 0;
+    for (size_t i = recalculation.finishedCount; i > 0 && succeeded; i--) {
+        const MBFormulaSlot *slot = &sheet->formulas[recalculation.finished[i - 1]];
+        for (uint32_t j = 0; j < slot->edgeCount; j++) {
+            MBFormulaSlot *reader = &sheet->formulas[recalculation.edges[slot->firstEdge + j]];
+            if (reader->component != slot->component && reader->level < slot->level + 1)
+                reader->level = slot->level + 1;
+        }
+        if (slot->level + 1 > levelCount)
+            levelCount = slot->level + 1;
+    }
+
+    // Formulas sorted by level, counting them first
+    size_t *levelStarts = succeeded ? calloc((size_t)levelCount + 1, sizeof(size_t)) : NULL;
+    uint32_t *levelFormulas = succeeded ? malloc((recalculation.finishedCount ? recalculation.finishedCount : 1) * sizeof(uint32_t)) : NULL;
+    succeeded = succeeded && levelStarts && levelFormulas;
+    if (succeeded) {
+        for (size_t i = 0; i < recalculation.finishedCount; i++)
+            levelStarts[sheet->formulas[recalculation.finished[i]].level + 1]++;
+        for (uint32_t level = 0; level < levelCount; level++)
+            levelStarts[level + 1] += levelStarts[level];
+        for (size_t i = recalculation.finishedCount; i > 0; i--) {
+            uint32_t formula = recalculation.finished[i - 1];
+            levelFormulas[levelStarts[sheet->formulas[formula].level]++] = formula;
+        }
+        // Each start was moved along to the next level's
+        memmove(levelStarts + 1, levelStarts, levelCount * sizeof(size_t));
+        levelStarts[0] = 0;
+    }
+
+    // Each level in runs of formulas that read at most a batch of cells between them
+    for (uint32_t level = 0; level < levelCount && succeeded; level++) {
+        size_t first = levelStarts[level], end = levelStarts[level + 1];
+        while (first < end && succeeded) {
+            size_t last = first, cells = MBCellCount(&sheet->formulas[levelFormulas[first]]);
+            while (last + 1 < end) {
+                size_t next = MBCellCount(&sheet->formulas[levelFormulas[last + 1]]);
+                if (next > MBTableGridFormulaSheetBatchCells - cells || cells + next > MBTableGridFormulaSheetBatchCells)
+                    break;
+                cells += next;
+                last++;
+            }
+            succeeded = MBEvaluateBatch(sheet, levelFormulas + first, last - first + 1, read, change, context, apply);
+            first = last + 1;
+        }
+    }
+    free(levelStarts);
+    free(levelFormulas);
+    MBFreeRecalculation(&recalculation);
+    if (succeeded) {
+        sheet->changeCount = 0;
+        sheet->changedFormulaCount = 0;
+        sheet->allChanged = false;
+    }
+    return succeeded;
+}
@@ -0,0 +1,161 @@
+//
+//  MBTableGridFormulaSheet.h
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#ifndef MBTableGridFormulaSheet_h
+#define MBTableGridFormulaSheet_h
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "MBTableGridValue.h"
+#include "MBTableGridSort.h"
+#include "MBTableGridFormula.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief		The most cells the formulas evaluated together may read,
+ *				which bounds the memory a recalculation takes.
+ */
+#define MBTableGridFormulaSheetBatchCells (1 << 20)
+
+/**
+ * @brief		Reads the values of \c count rows of a column from
+ *				\c firstRow on into \c values, which are zeroed, so that
+ *				cells left alone are empty. Strings need only last until
+ *				the next call. Returns \c false to stop, for example when
+ *				out of memory.
+ */
+typedef bool (*MBTableGridFormulaReadFunction)(void *context, size_t column, size_t firstRow, size_t count,
+                                               MBTableGridValue *values);
+
+/**
+ * @brief		Called for each formula whose result has changed.
+ */
+typedef void (*MBTableGridFormulaChangeFunction)(void *context, size_t column, size_t row);
+
+/**
+ * @brief		\c MBTableGridFormulaSheet keeps the formulas of a grid's
+ *				cells and their results, and works the results out again
+ *				when the cells they depend on change.
+ *
+ * @details		Cells are addressed by column and data source row. Each
+ *				formula's references are recorded as edges of a
+ *				dependency graph: a reference to one cell in a hash table
+ *				from the cell to the formulas that read it, and a block of
+ *				cells in a list for each column it covers.
+ *
+ *				Changes are noted as they happen, and recalculating
+ *				follows the edges from the changed cells to find only the
+ *				formulas that depend on them. Those are put in
+ *				topological order by Tarjan's algorithm, which also finds
+ *				the formulas that depend on themselves; each is given
+ *				\c MBTableGridFormulaErrorCycle. The rest are divided into
+ *				levels, each one after every formula it depends on, and
+ *				the formulas of a level are independent of each other, so
+ *				they're evaluated in parallel.
+ *
+ *				The cells a level's formulas read are read on the calling
+ *				thread first, through an \c MBTableGridFormulaReadFunction,
+ *				so the grid's data source is never called from another
+ *				thread.
+ *
+ *				The sheet is not thread-safe.
+ */
+typedef struct MBTableGridFormulaSheet MBTableGridFormulaSheet;
+
+/**
+ * @brief		Creates a sheet without formulas. Returns \c NULL if out
+ *				of memory.
+ */
+MBTableGridFormulaSheet *MBTableGridFormulaSheetCreate(void);
+
+/**
+ * @brief		Frees a sheet created by \c MBTableGridFormulaSheetCreate.
+ */
+void MBTableGridFormulaSheetDestroy(MBTableGridFormulaSheet *sheet);
+
+/**
+ * @brief		Returns the number of formulas in the sheet.
+ */
+size_t MBTableGridFormulaSheetCount(const MBTableGridFormulaSheet *sheet);
+
+/**
+ * @brief		Returns whether any cell of a column holds a formula,
+ *				which is quicker than looking for formulas cell by cell.
+ */
+bool MBTableGridFormulaSheetColumnHasFormulas(const MBTableGridFormulaSheet *sheet, size_t column);
+
+/**
+ * @brief		Compiles a formula into a cell, replacing any formula
+ *				there, and notes that it needs to be evaluated.
+ *
+ * @details		The result is pending until the sheet is recalculated.
+ *				Returns \c false, leaving the cell without a formula, if
+ *				the text isn't a formula or memory runs out.
+ */
+bool MBTableGridFormulaSheetSetFormula(MBTableGridFormulaSheet *sheet, size_t column, size_t row,
+                                       const char *text, size_t length);
+
+/**
+ * @brief		Removes the formula in a cell, if there is one, and notes
+ *				that the cell has changed.
+ */
+void MBTableGridFormulaSheetRemoveFormula(MBTableGridFormulaSheet *sheet, size_t column, size_t row);
+
+/**
+ * @brief		Returns the text of the formula in a cell, which is not
+ *				NUL-terminated, or \c NULL if there is none.
+ */
+const char *MBTableGridFormulaSheetGetText(const MBTableGridFormulaSheet *sheet, size_t column, size_t row, size_t *length);
+
+/**
+ * @brief		Looks up the result of the formula in a cell.
+ *
+ * @details		Strings point into the sheet, and are good until it's
+ *				next changed or recalculated. Returns \c false if the cell
+ *				holds no formula.
+ */
+bool MBTableGridFormulaSheetGetResult(const MBTableGridFormulaSheet *sheet, size_t column, size_t row,
+                                      MBTableGridFormulaValue *result);
+
+/**
+ * @brief		Notes that the values of \c count rows of a column, from
+ *				\c firstRow on, have changed, so that the formulas that
+ *				read them are evaluated again.
+ */
+void MBTableGridFormulaSheetNoteChange(MBTableGridFormulaSheet *sheet, size_t column, size_t firstRow, size_t count);
+
+/**
+ * @brief		Notes that any cell may have changed, so that every
+ *				formula is evaluated again.
+ */
+void MBTableGridFormulaSheetNoteAllChanged(MBTableGridFormulaSheet *sheet);
+
+/**
+ * @brief		Evaluates every formula that depends on a change noted
+ *				since the last recalculation, in dependency order.
+ *
+ * @details		Cells without formulas are read through \c read, and
+ *				\c change is called, on the calling thread, for each
+ *				formula whose result has changed. \c apply evaluates the
+ *				formulas of a level on several threads, or they're
+ *				evaluated on the calling thread if it's \c NULL. Returns
+ *				\c false if \c read fails or memory runs out, in which
+ *				case the changes are kept to be recalculated again.
+ */
+bool MBTableGridFormulaSheetRecalculate(MBTableGridFormulaSheet *sheet, MBTableGridFormulaReadFunction read,
+                                        MBTableGridFormulaChangeFunction change, void *context,
+                                        MBTableGridSortApplyFunction apply);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MBTableGridFormulaSheet_h */
@@ -0,0 +1,117 @@
+//
+//  MBTableGridGeometry.c
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#include "MBTableGridGeometry.h"
+
+#include <math.h>
+
+static const MBTableGridRect MBZeroRect = { 0.0, 0.0, 0.0, 0.0 };
+
+static MBTableGridRect MBIntersectRects(MBTableGridRect a, MBTableGridRect b) {
+    double minX = fmax(a.x, b.x);
+    double minY = fmax(a.y, b.y);
+    double maxX = fmin(a.x + a.width, b.x + b.width);
+    double maxY = fmin(a.y + a.height, b.y + b.height);
+    if (maxX <= minX || maxY <= minY)
+        return MBZeroRect;
+    MBTableGridRect rect = { minX, minY, maxX - minX, maxY - minY };
+    return rect;
+}
+
+double MBTableGridAxisLength(const MBTableGridAxis *axis) {
+    if (axis->offsets)
+        return MBTableGridOffsetIndexTotalSize(axis->offsets);
+    return axis->uniformSize * (double)axis->count;
+}
+
+MBTableGridSpan MBTableGridAxisSpanOfIndex(const MBTableGridAxis *axis, size_t i) {
+    MBTableGridSpan span = { 0.0, axis->uniformSize };
+    if (axis->offsets == NULL) {
+        span.origin = axis->uniformSize * (double)i;
+    } else if (i < axis->count) {
+        span.origin = MBTableGridOffsetIndexOffsetOfIndex(axis->offsets, i);
+        span.length = MBTableGridOffsetIndexSizeAtIndex(axis->offsets, i);
+    } else {
+        span.origin = MBTableGridOffsetIndexTotalSize(axis->offsets) + axis->uniformSize * (double)(i - axis->count);
+    }
+    return span;
+}
+
+size_t MBTableGridAxisIndexAtOffset(const MBTableGridAxis *axis, double offset) {
+    if (axis->count == 0 || offset < 0.0)
+        return MBTableGridGeometryNotFound;
+    if (axis->offsets) {
+        size_t i = MBTableGridOffsetIndexIndexAtOffset(axis->offsets, offset);
+        return i == MBTableGridOffsetIndexNotFound ? MBTableGridGeometryNotFound : i;
+    }
+    if (axis->uniformSize <= 0.0)
+        return MBTableGridGeometryNotFound;
+    double i = floor(offset / axis->uniformSize);
+    if (i >= (double)axis->count)
+        return MBTableGridGeometryNotFound;
+    return (size_t)i;
+}
+
+MBTableGridIndexRange MBTableGridAxisRangeIntersecting(const MBTableGridAxis *axis, double minimum, double maximum) {
+    MBTableGridIndexRange range = { MBTableGridGeometryNotFound, 0 };
+    double length = MBTableGridAxisLength(axis);
+    if (axis->count == 0 || maximum < 0.0 || minimum > length || maximum < minimum)
+        return range;
+
+    if (minimum < 0.0)
+        minimum = 0.0;
+
+    size_t first = MBTableGridAxisIndexAtOffset(axis, minimum);
+    if (first == MBTableGridGeometryNotFound) {
+        first = axis->count - 1;
+    } else if (first > 0 && MBTableGridAxisSpanOfIndex(axis, first).origin == minimum) {
+        first--;
+    }
+    size_t last = MBTableGridAxisIndexAtOffset(axis, maximum);
+    if (last == MBTableGridGeometryNotFound)
+        last = axis->count - 1;
+
+    range.location = first;
+    range.length = last - first + 1;
+    return range;
+}
+
+MBTableGridRect MBTableGridGeometryRectOfSelection(const MBTableGridAxis *columns,
+                                                   const MBTableGridAxis *rows,
+                                                   MBTableGridSelectionBounds selection,
+                                                   double contentWidth,
+                                                   double contentHeight) {
+    int hasRows = (selection.firstRow != MBTableGridGeometryNotFound);
+    int hasColumns = (selection.firstColumn != MBTableGridGeometryNotFound);
+    MBTableGridRect rowsRect = MBZeroRect;
+    MBTableGridRect columnsRect = MBZeroRect;
+
+    if (hasRows) {
+        MBTableGridSpan first = MBTableGridAxisSpanOfIndex(rows, selection.firstRow);
+        MBTableGridSpan last = MBTableGridAxisSpanOfIndex(rows, selection.lastRow);
+        rowsRect.x = 0.0;
+        rowsRect.width = contentWidth;
+        rowsRect.y = first.origin;
+        rowsRect.height = last.origin + last.length - first.origin;
+    }
+    if (hasColumns) {
+        MBTableGridSpan first = MBTableGridAxisSpanOfIndex(columns, selection.firstColumn);
+        MBTableGridSpan last = MBTableGridAxisSpanOfIndex(columns, selection.lastColumn);
+        columnsRect.x = first.origin;
+        columnsRect.width = last.origin + last.length - first.origin;
+        columnsRect.y = 0.0;
+        columnsRect.height = contentHeight;
+    }
+
+    if (hasRows && hasColumns)
+        return MBIntersectRects(rowsRect, columnsRect);
+    if (hasRows)
+        return rowsRect;
+    if (hasColumns)
+        return columnsRect;
+    return MBZeroRect;
+}
@@ -0,0 +1,119 @@
+//
+//  MBTableGridGeometry.h
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#ifndef MBTableGridGeometry_h
+#define MBTableGridGeometry_h
+
+#include "MBTableGridOffsetIndex.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief		Returned in place of an index when nothing matches.
+ */
+#define MBTableGridGeometryNotFound ((size_t)-1)
+
+/**
+ * @brief		One axis (columns or rows) of the grid's layout.
+ *
+ * @details		When \c offsets is \c NULL every entry is \c uniformSize
+ *				long and all queries are plain arithmetic. Otherwise the
+ *				entries are described by \c offsets, and \c uniformSize is
+ *				only used for positions past the last entry.
+ */
+typedef struct MBTableGridAxis {
+    const MBTableGridOffsetIndex *offsets;
+    size_t count;
+    double uniformSize;
+} MBTableGridAxis;
+
+/**
+ * @brief		A half-open interval along one axis.
+ */
+typedef struct MBTableGridSpan {
+    double origin;
+    double length;
+} MBTableGridSpan;
+
+/**
+ * @brief		A run of consecutive entries. \c location is
+ *				\c MBTableGridGeometryNotFound when the run is empty.
+ */
+typedef struct MBTableGridIndexRange {
+    size_t location;
+    size_t length;
+} MBTableGridIndexRange;
+
+/**
+ * @brief		A rectangle in the content view's (flipped) coordinates.
+ */
+typedef struct MBTableGridRect {
+    double x;
+    double y;
+    double width;
+    double height;
+} MBTableGridRect;
+
+/**
+ * @brief		The first and last selected column and row. Use
+ *				\c MBTableGridGeometryNotFound for an empty dimension.
+ */
+typedef struct MBTableGridSelectionBounds {
+    size_t firstColumn;
+    size_t lastColumn;
+    size_t firstRow;
+    size_t lastRow;
+} MBTableGridSelectionBounds;
+
+/**
+ * @brief		Returns the total length of an axis.
+ */
+double MBTableGridAxisLength(const MBTableGridAxis *axis);
+
+/**
+ * @brief		Returns the span covered by entry \c i. Entries past the
+ *				end continue at \c uniformSize intervals.
+ */
+MBTableGridSpan MBTableGridAxisSpanOfIndex(const MBTableGridAxis *axis, size_t i);
+
+/**
+ * @brief		Returns the entry containing \c offset, or
+ *				\c MBTableGridGeometryNotFound if it lies outside the axis.
+ */
+size_t MBTableGridAxisIndexAtOffset(const MBTableGridAxis *axis, double offset);
+
+/**
+ * @brief		Returns the entries that intersect <tt>[minimum, maximum]</tt>.
+ *
+ * @details		Entries that merely touch either end are included, so
+ *				that borders drawn on an edge are redrawn along with it.
+ *				The range is clamped to the entries of the axis.
+ */
+MBTableGridIndexRange MBTableGridAxisRangeIntersecting(const MBTableGridAxis *axis, double minimum, double maximum);
+
+/**
+ * @brief		Returns the rectangle enclosing a selection, before any
+ *				outset for drawing.
+ *
+ * @details		A selection of rows spans the full content width (and
+ *				a selection of columns the full content height) unless
+ *				both dimensions are selected, in which case the two are
+ *				intersected. An empty selection returns a zero rectangle.
+ */
+MBTableGridRect MBTableGridGeometryRectOfSelection(const MBTableGridAxis *columns,
+                                                   const MBTableGridAxis *rows,
+                                                   MBTableGridSelectionBounds selection,
+                                                   double contentWidth,
+                                                   double contentHeight);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MBTableGridGeometry_h */
@@ -0,0 +1,331 @@
+//
+//  MBTableGridGroup.c
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#include "MBTableGridGroup.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Slots a new table starts with; always a power of two
+#define MBGroupInitialSlotCount 64
+
+// The most summaries chunks may keep apart before being merged, beyond which
+// values are summarized on one thread
+#define MBGroupPartialAggregateLimit (1 << 18)
+
+typedef struct MBGroupKey {
+    uint64_t hash;
+    // Strings have no bytes of their own here; theirs are in the table's
+    // bytes from offset on
+    MBTableGridValue value;
+    size_t offset;
+} MBGroupKey;
+
+struct MBTableGridGroupTable {
+    MBGroupKey *keys;
+    size_t count;
+    size_t capacity;
+
+    // The group of the key hashed to each slot in the low 32 bits, or
+    // MBTableGridGroupNone, and the high bits of its hash in the rest, so
+    // that most keys that differ are told apart without reading them;
+    // collisions probe the following slots
+    uint64_t *slots;
+    size_t slotCount;
+
+    char *bytes;
+    size_t byteCount;
+    size_t byteCapacity;
+};
+
+static inline uint64_t MBMix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+static inline uint64_t MBHashDouble(double number, uint64_t kind) {
+    uint64_t bits;
+    memcpy(&bits, &number, sizeof(bits));
+    return MBMix(bits ^ kind);
+}
+
+// Pending values group with empty ones, 0 with -0, and every NaN together
+static inline MBTableGridValue MBNormalizeKey(const MBTableGridValue *key) {
+    MBTableGridValue value = *key;
+    if (value.type == MBTableGridValueTypePending) {
+        value.type = MBTableGridValueTypeEmpty;
+    } else if (value.type == MBTableGridValueTypeDouble || value.type == MBTableGridValueTypeDate) {
+        if (value.data.number == 0.0)
+            value.data.number = 0.0;
+        else if (isnan(value.data.number))
+            value.data.number = NAN;
+    }
+    return value;
+}
+
+// Integers hash as the doubles they're equal to, so that 1 and 1.0 meet
+static uint64_t MBHashKey(const MBTableGridValue *key) {
+    switch (key->type) {
+        case MBTableGridValueTypeInteger:
+            return MBHashDouble((double)key->data.integer, 1);
+        case MBTableGridValueTypeDouble:
+            return MBHashDouble(key->data.number, 1);
+        case MBTableGridValueTypeDate:
+            return MBHashDouble(key->data.number, 2);
+        case MBTableGridValueTypeBoolean:
+            return MBMix(3 + (uint64_t)key->data.boolean);
+        case MBTableGridValueTypeString: {
+            uint64_t hash = 14695981039346656037ULL;
+            const unsigned char *bytes = (const unsigned char *)key->data.string.bytes;
+            for (size_t i = 0; i < key->data.string.length; i++) {
+                hash = (hash ^ bytes[i]) * 1099511628211ULL;
+            }
+            return MBMix(hash ^ 5);
+        }
+        default:
+            return MBMix(0);
+    }
+}
+
+static inline bool MBIsNumber(MBTableGridValueType type) {
+    return (type == MBTableGridValueTypeInteger || type == MBTableGridValueTypeDouble);
+}
+
+static inline double MBNumber(const MBTableGridValue *value) {
+    return (value->type == MBTableGridValueTypeInteger) ? (double)value->data.integer : value->data.number;
+}
+
+static bool MBKeyEquals(const MBTableGridGroupTable *table, const MBGroupKey *stored, const MBTableGridValue *key) {
+    const MBTableGridValue *value = &stored->value;
+    if (MBIsNumber(value->type) && MBIsNumber(key->type)) {
+        if (value->type == MBTableGridValueTypeInteger && key->type == MBTableGridValueTypeInteger)
+            return value->data.integer == key->data.integer;
+        double a = MBNumber(value), b = MBNumber(key);
+        return a == b || (isnan(a) && isnan(b));
+    }
+    if (value->type != key->type)
+        return false;
+    switch (key->type) {
+        case MBTableGridValueTypeDate:
+            return value->data.number == key->data.number || (isnan(value->data.number) && isnan(key->data.number));
+        case MBTableGridValueTypeBoolean:
+            return value->data.boolean == key->data.boolean;
+        case MBTableGridValueTypeString:
+            return (value->data.string.length == key->data.string.length &&
+                    memcmp(table->bytes + stored->offset, key->data.string.bytes, key->data.string.length) == 0);
+        default:
+            return true;
+    }
+}
+
+static inline uint64_t MBSlotValue(uint64_t hash, uint32_t group) {
+    return (hash & 0xffffffff00000000ULL) | group;
+}
+
+static uint32_t MBLookUpKey(const MBTableGridGroupTable *table, const MBTableGridValue *key, uint64_t hash) {
+    size_t mask = table->slotCount - 1;
+    uint64_t tag = hash & 0xffffffff00000000ULL;
+    for (size_t slot = (size_t)hash & mask; ; slot = (slot + 1) & mask) {
+        uint64_t value = table->slots[slot];
+        uint32_t group = (uint32_t)value;
+        if (group == MBTableGridGroupNone)
+            return MBTableGridGroupNone;
+        if ((value & 0xffffffff00000000ULL) == tag && MBKeyEquals(table, &table->keys[group], key))
+            return group;
+    }
+}
+
+static bool MBResizeSlots(MBTableGridGroupTable *table, size_t slotCount) {
+    uint64_t *slots = malloc(slotCount * sizeof(uint64_t));
+    if (slots == NULL)
+        return false;
+    memset(slots, 0xff, slotCount * sizeof(uint64_t));
+    size_t mask = slotCount - 1;
+    for (size_t group = 0; group < table->count; group++) {
+        size_t slot = (size_t)table->keys[group].hash & mask;
+        while ((uint32_t)slots[slot] != MBTableGridGroupNone)
+            slot = (slot + 1) & mask;
+        slots[slot] = MBSlotValue(table->keys[group].hash, (uint32_t)group);
+    }
+    free(table->slots);
+    table->slots = slots;
+    table->slotCount = slotCount;
+    return true;
+}
+
+// Numbers a key that isn't in the table, keeping the table at most half full
+static uint32_t MBInsertKey(MBTableGridGroupTable *table, const MBTableGridValue *key, uint64_t hash) {
+    if (table->count >= MBTableGridGroupNone)
+        return MBTableGridGroupNone;
+    if (table->count == table->capacity) {
+        size_t capacity = table->capacity ? 2 * table->capacity : 64;
+        MBGroupKey *keys = realloc(table->keys, capacity * sizeof(MBGroupKey));
+        if (keys == NULL)
+            return MBTableGridGroupNone;
+        table->keys = keys;
+        table->capacity = capacity;
+    }
+    if (2 * (table->count + 1) > table->slotCount && !MBResizeSlots(table, 2 * table->slotCount))
+        return MBTableGridGroupNone;
+
+    MBGroupKey stored = { hash, *key, 0 };
+    if (key->type == MBTableGridValueTypeString) {
+        size_t length = key->data.string.length;
+        if (table->byteCount + length > table->byteCapacity) {
+            size_t byteCapacity = table->byteCapacity ? table->byteCapacity : 1024;
+            while (table->byteCount + length > byteCapacity)
+                byteCapacity *= 2;
+            char *bytes = realloc(table->bytes, byteCapacity);
+            if (bytes == NULL)
+                return MBTableGridGroupNone;
+            table->bytes = bytes;
+            table->byteCapacity = byteCapacity;
+        }
+        if (length)
+            memcpy(table->bytes + table->byteCount, key->data.string.bytes, length);
+        stored.offset = table->byteCount;
+        stored.value.data.string.bytes = NULL;
+        table->byteCount += length;
+    }
+
+    uint32_t group = (uint32_t)table->count++;
+    table->keys[group] = stored;
+    size_t mask = table->slotCount - 1;
+    size_t slot = (size_t)hash & mask;
+    while ((uint32_t)table->slots[slot] != MBTableGridGroupNone)
+        slot = (slot + 1) & mask;
+    table->slots[slot] = MBSlotValue(hash, group);
+    return group;
+}
+
+MBTableGridGroupTable *MBTableGridGroupTableCreate(void) {
+    MBTableGridGroupTable *table = calloc(1, sizeof(MBTableGridGroupTable));
+    if (table == NULL)
+        return NULL;
+    if (!MBResizeSlots(table, MBGroupInitialSlotCount)) {
+        free(table);
+        return NULL;
+    }
+    return table;
+}
+
+void MBTableGridGroupTableDestroy(MBTableGridGroupTable *table) {
+    if (table == NULL)
+        return;
+    free(table->keys);
+    free(table->slots);
+    free(table->bytes);
+    free(table);
+}
+
+size_t MBTableGridGroupTableCount(const MBTableGridGroupTable *table) {
+    return table->count;
+}
+
+MBTableGridValue MBTableGridGroupTableKey(const MBTableGridGroupTable *table, uint32_t group) {
+    if (group >= table->count)
+        return (MBTableGridValue){ .type = MBTableGridValueTypeEmpty };
+    const MBGroupKey *stored = &table->keys[group];
+    if (stored->value.type == MBTableGridValueTypeString)
+        return MBTableGridValueMakeString(table->bytes ? table->bytes + stored->offset : "", stored->value.data.string.length);
+    return stored->value;
+}
+
+typedef struct MBGroupLookup {
+    const MBTableGridGroupTable *table;
+    const MBTableGridValue *keys;
+    uint32_t *groups;
+    size_t count;
+} MBGroupLookup;
+
+static void MBLookUpChunk(void *context, size_t iteration) {
+    const MBGroupLookup *lookup = context;
+    size_t first = iteration * MBTableGridGroupChunkSize;
+    size_t end = (lookup->count - first < MBTableGridGroupChunkSize) ? lookup->count : first + MBTableGridGroupChunkSize;
+    for (size_t i = first; i < end; i++) {
+        MBTableGridValue key = MBNormalizeKey(&lookup->keys[i]);
+        lookup->groups[i] = MBLookUpKey(lookup->table, &key, MBHashKey(&key));
+    }
+}
+
+bool MBTableGridGroupTableAssign(MBTableGridGroupTable *table, const MBTableGridValue *keys, size_t count,
+                                 uint32_t *groups, MBTableGridSortApplyFunction apply) {
+    MBGroupLookup lookup = { table, keys, groups, count };
+    size_t chunkCount = (count + MBTableGridGroupChunkSize - 1) / MBTableGridGroupChunkSize;
+    if (apply && chunkCount > 1) {
+        apply(chunkCount, &lookup, MBLookUpChunk);
+    } else {
+        for (size_t chunk = 0; chunk < chunkCount; chunk++)
+            MBLookUpChunk(&lookup, chunk);
+    }
+
+    // Keys first seen in this batch may repeat within it
+    for (size_t i = 0; i < count; i++) {
+        if (groups[i] != MBTableGridGroupNone)
+            continue;
+        MBTableGridValue key = MBNormalizeKey(&keys[i]);
+        uint64_t hash = MBHashKey(&key);
+        uint32_t group = MBLookUpKey(table, &key, hash);
+        if (group == MBTableGridGroupNone && (group = MBInsertKey(table, &key, hash)) == MBTableGridGroupNone)
+            return false;
+        groups[i] = group;
+    }
+    return true;
+}
+
+typedef struct MBGroupAggregation {
+    const uint32_t *groups;
+    const MBTableGridValue *values;
+    size_t count;
+    MBTableGridAggregate *partials;
+    size_t groupCount;
+} MBGroupAggregation;
+
+static void MBAggregateRange(const uint32_t *groups, const MBTableGridValue *values, size_t first, size_t end,
+                             MBTableGridAggregate *aggregates, size_t groupCount) {
+    for (size_t i = first; i < end; i++) {
+        uint32_t group = groups[i];
+        if (group < groupCount)
+            MBTableGridAggregateAddValues(&aggregates[group], &values[i], 1);
+    }
+}
+
+static void MBAggregateChunk(void *context, size_t iteration) {
+    const MBGroupAggregation *aggregation = context;
+    size_t first = iteration * MBTableGridGroupChunkSize;
+    size_t end = (aggregation->count - first < MBTableGridGroupChunkSize) ? aggregation->count : first + MBTableGridGroupChunkSize;
+    MBTableGridAggregate *partial = aggregation->partials + iteration * aggregation->groupCount;
+    for (size_t group = 0; group < aggregation->groupCount; group++)
+        partial[group] = MBTableGridAggregateMakeEmpty();
+    MBAggregateRange(aggregation->groups, aggregation->values, first, end, partial, aggregation->groupCount);
+}
+
+bool MBTableGridGroupAggregate(const uint32_t *groups, const MBTableGridValue *values, size_t count,
+                               MBTableGridAggregate *aggregates, size_t groupCount, MBTableGridSortApplyFunction apply) {
+    size_t chunkCount = (count + MBTableGridGroupChunkSize - 1) / MBTableGridGroupChunkSize;
+    if (apply == NULL || chunkCount < 2 || groupCount > MBGroupPartialAggregateLimit / chunkCount) {
+        MBAggregateRange(groups, values, 0, count, aggregates, groupCount);
+        return true;
+    }
+
+    MBTableGridAggregate *partials = malloc(chunkCount * groupCount * sizeof(MBTableGridAggregate));
+    if (partials == NULL)
+        return false;
+    MBGroupAggregation aggregation = { groups, values, count, partials, groupCount };
+    apply(chunkCount, &aggregation, MBAggregateChunk);
+    for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+        for (size_t group = 0; group < groupCount; group++)
+            MBTableGridAggregateMerge(&aggregates[group], &partials[chunk * groupCount + group]);
+    }
+    free(partials);
+    return true;
+}
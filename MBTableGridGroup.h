@@ -0,0 +1,112 @@
+//
+//  MBTableGridGroup.h
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#ifndef MBTableGridGroup_h
+#define MBTableGridGroup_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "MBTableGridValue.h"
+#include "MBTableGridSort.h"
+#include "MBTableGridAggregate.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief		The group of a row that belongs to none, such as one a
+ *				filter hides.
+ */
+#define MBTableGridGroupNone UINT32_MAX
+
+/**
+ * @brief		The number of keys or values each iteration of a parallel
+ *				loop works through.
+ */
+#define MBTableGridGroupChunkSize 16384
+
+/**
+ * @brief		\c MBTableGridGroupTable numbers the distinct values of a
+ *				column, so that rows can be grouped by them.
+ *
+ * @details		Each key gets the next number the first time it's seen,
+ *				and keeps it, so numbers stay the same as more rows are
+ *				assigned. Integers and doubles are the same key if they
+ *				have the same value, and pending values are grouped with
+ *				empty ones. Strings are compared byte for byte, and copied
+ *				into the table.
+ *
+ *				Keys are looked up in an open-addressed hash table. Each
+ *				batch is looked up a chunk at a time on every processor,
+ *				without changing the table; only keys not in it yet are
+ *				then added, one at a time, so a column with few distinct
+ *				values is grouped almost entirely in parallel.
+ *
+ *				The table is not thread-safe.
+ */
+typedef struct MBTableGridGroupTable MBTableGridGroupTable;
+
+/**
+ * @brief		Creates an empty table. Returns \c NULL if out of memory.
+ */
+MBTableGridGroupTable *MBTableGridGroupTableCreate(void);
+
+/**
+ * @brief		Frees a table created by \c MBTableGridGroupTableCreate.
+ */
+void MBTableGridGroupTableDestroy(MBTableGridGroupTable *table);
+
+/**
+ * @brief		Returns the number of distinct keys seen, which numbers
+ *				the groups from 0 up to it.
+ */
+size_t MBTableGridGroupTableCount(const MBTableGridGroupTable *table);
+
+/**
+ * @brief		Returns the key of a group, as it was first seen.
+ *
+ * @details		Strings point into the table, and are good until more
+ *				keys are assigned or the table is destroyed. Pending keys
+ *				are returned as empty ones.
+ */
+MBTableGridValue MBTableGridGroupTableKey(const MBTableGridGroupTable *table, uint32_t group);
+
+/**
+ * @brief		Stores the group of each of \c count keys in \c groups,
+ *				numbering keys not seen before.
+ *
+ * @details		\c apply runs the lookups on several threads, or they
+ *				run on the calling thread if it's \c NULL. Returns
+ *				\c false if out of memory, or if there would be more than
+ *				\c MBTableGridGroupNone groups, in which case some groups
+ *				may not have been stored, though the table stays usable.
+ */
+bool MBTableGridGroupTableAssign(MBTableGridGroupTable *table, const MBTableGridValue *keys, size_t count,
+                                 uint32_t *groups, MBTableGridSortApplyFunction apply);
+
+/**
+ * @brief		Adds each of \c count values to the summary of its group,
+ *				one of \c groupCount in \c aggregates.
+ *
+ * @details		Values whose group is \c MBTableGridGroupNone are left
+ *				out. When there are few enough groups, each chunk of
+ *				values is summarized on its own through \c apply and the
+ *				chunks' summaries are then merged; otherwise the values
+ *				are added on the calling thread. Returns \c false, adding
+ *				nothing, if out of memory.
+ */
+bool MBTableGridGroupAggregate(const uint32_t *groups, const MBTableGridValue *values, size_t count,
+                               MBTableGridAggregate *aggregates, size_t groupCount, MBTableGridSortApplyFunction apply);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MBTableGridGroup_h */
@@ -60,6 +60,26 @@ typedef enum _MBTableGridHeaderOrientation {
 
 @property (nonatomic, assign) BOOL sortIndicatorAscending;
 
+/**
+ * @brief		The place of the column among several sort columns,
+ *				counting from 1, which is drawn beside the sort
+ *				indicator, or 0 to draw no number.
+ */
+@property (nonatomic, assign) NSInteger sortIndicatorPriority;
+
+/**
+ * @brief		The color of the triangle that shows or hides a group's
+ *				rows, drawn before the title of the group's first row,
+ *				or nil to draw none.
+ */
+@property (nonatomic, strong) NSColor *disclosureIndicatorColor;
+
+/**
+ * @brief		Whether the group's rows are shown, which points the
+ *				disclosure indicator down rather than to the right.
+ */
+@property (nonatomic, assign) BOOL disclosureIndicatorExpanded;
+
 @property (nonatomic, strong) NSTrackingArea *resizeTrackingArea;
 
 @property (nonatomic, strong) NSColor *borderColor;
@@ -68,4 +88,6 @@ typedef enum _MBTableGridHeaderOrientation {
 
 - (NSRect)sortIndicatorRectForBounds:(NSRect)rect;
 
+- (NSRect)disclosureIndicatorRectForBounds:(NSRect)rect;
+
 @end
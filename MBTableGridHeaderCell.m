@@ -77,6 +77,14 @@ extern CGFloat MBTableHeaderSortIndicatorMargin;
     return indicatorRect;
 }
 
+- (NSRect)disclosureIndicatorRectForBounds:(NSRect)rect {
+    NSRect indicatorRect = NSZeroRect;
+    indicatorRect.size = NSMakeSize(MBTableHeaderSortIndicatorWidth, MBTableHeaderSortIndicatorWidth);
+    indicatorRect.origin.x = NSMinX(rect) + MBTableHeaderSortIndicatorMargin;
+    indicatorRect.origin.y = NSMinY(rect) + roundf((NSHeight(rect) - MBTableHeaderSortIndicatorWidth) / 2.0);
+    return indicatorRect;
+}
+
 - (void)drawWithFrame:(NSRect)cellFrame inView:(MBTableGridHeaderView *)controlView
 {
 	NSRect cellFrameRect = cellFrame;
@@ -142,11 +150,29 @@ extern CGFloat MBTableHeaderSortIndicatorMargin;
 	return [[NSAttributedString alloc] initWithString:self.stringValue attributes:attributes];
 }
 
+- (NSAttributedString *)sortPriorityStringForPriority:(NSInteger)priority {
+    if (priority <= 0 || !self.sortIndicatorColor)
+        return nil;
+    NSDictionary<NSAttributedStringKey, id> *attributes = @{
+        NSFontAttributeName: [NSFont monospacedDigitSystemFontOfSize:NSFont.smallSystemFontSize - 2.0 weight:NSFontWeightRegular],
+        NSForegroundColorAttributeName: self.sortIndicatorColor
+    };
+    return [[NSAttributedString alloc] initWithString:[NSString stringWithFormat:@"%ld", (long)priority] attributes:attributes];
+}
+
 - (void)drawSortIndicatorWithFrame:(NSRect)cellFrame inView:(NSView *)controlView ascending:(BOOL)ascending priority:(NSInteger)priority {
     if (!self.sortIndicatorColor)
         return;
     
     NSRect indicatorRect = [self sortIndicatorRectForBounds:cellFrame];
+    
+    // Secondary sort columns have their place drawn just before the indicator
+    NSAttributedString *priorityString = [self sortPriorityStringForPriority:priority];
+    if (priorityString) {
+        NSSize size = priorityString.size;
+        [priorityString drawAtPoint:NSMakePoint(NSMinX(indicatorRect) - size.width - 1.0, NSMidY(indicatorRect) - size.height / 2)];
+    }
+    
     NSBezierPath *path = [NSBezierPath bezierPath];
     path.lineCapStyle = NSLineCapStyleRound;
     path.lineWidth = 1.5;
@@ -166,6 +192,33 @@ extern CGFloat MBTableHeaderSortIndicatorMargin;
     [path stroke];
 }
 
+- (void)drawDisclosureIndicatorWithFrame:(NSRect)cellFrame inView:(NSView *)controlView expanded:(BOOL)expanded {
+    if (!self.disclosureIndicatorColor)
+        return;
+    
+    NSRect indicatorRect = [self disclosureIndicatorRectForBounds:cellFrame];
+    NSBezierPath *path = [NSBezierPath bezierPath];
+    path.lineCapStyle = NSLineCapStyleRound;
+    path.lineWidth = 1.5;
+    [self.disclosureIndicatorColor setStroke];
+    if (expanded) {
+        [path moveToPoint:NSMakePoint(NSMinX(indicatorRect) + path.lineWidth / 2,
+                                      indicatorRect.origin.y + 0.25 * indicatorRect.size.height)];
+        [path lineToPoint:NSMakePoint(NSMidX(indicatorRect),
+                                      indicatorRect.origin.y + 0.75 * indicatorRect.size.height)];
+        [path lineToPoint:NSMakePoint(NSMaxX(indicatorRect) - path.lineWidth / 2,
+                                      indicatorRect.origin.y + 0.25 * indicatorRect.size.height)];
+    } else {
+        [path moveToPoint:NSMakePoint(indicatorRect.origin.x + 0.25 * indicatorRect.size.width,
+                                      NSMinY(indicatorRect) + path.lineWidth / 2)];
+        [path lineToPoint:NSMakePoint(indicatorRect.origin.x + 0.75 * indicatorRect.size.width,
+                                      NSMidY(indicatorRect))];
+        [path lineToPoint:NSMakePoint(indicatorRect.origin.x + 0.25 * indicatorRect.size.width,
+                                      NSMaxY(indicatorRect) - path.lineWidth / 2)];
+    }
+    [path stroke];
+}
+
 - (NSRect)titleRectForBounds:(NSRect)cellFrame {
     NSRect cellFrameRect = cellFrame;
 
@@ -179,8 +232,12 @@ extern CGFloat MBTableHeaderSortIndicatorMargin;
                                cellFrameRect.size.width - 2 * TEXT_PADDING,
                                stringSize.height);
         if (self.sortIndicatorColor)
-            textFrame.size.width -= MBTableHeaderSortIndicatorWidth;
+            textFrame.size.width -= MBTableHeaderSortIndicatorWidth + ceil([self sortPriorityStringForPriority:self.sortIndicatorPriority].size.width);
     } else {
+        // The title stays centered clear of the disclosure indicator
+        if (self.disclosureIndicatorColor)
+            cellFrame = NSInsetRect(cellFrame, MBTableHeaderSortIndicatorWidth + MBTableHeaderSortIndicatorMargin, 0.0);
+        cellFrameRect = cellFrame;
         NSRect boundingRect = [self.attributedStringValue boundingRectWithSize:cellFrame.size
                                                                        options:options];
         if (boundingRect.size.height < cellFrame.size.height) {
@@ -205,7 +262,8 @@ extern CGFloat MBTableHeaderSortIndicatorMargin;
     titleFrame.origin.y += cellFrame.origin.y;
     NSStringDrawingOptions options = (NSStringDrawingTruncatesLastVisibleLine | NSStringDrawingUsesLineFragmentOrigin);
 	[self.attributedStringValue drawWithRect:titleFrame options:options];
-    [self drawSortIndicatorWithFrame:cellFrame inView:controlView ascending:self.sortIndicatorAscending priority:0];
+    [self drawSortIndicatorWithFrame:cellFrame inView:controlView ascending:self.sortIndicatorAscending priority:self.sortIndicatorPriority];
+    [self drawDisclosureIndicatorWithFrame:cellFrame inView:controlView expanded:self.disclosureIndicatorExpanded];
 }
 
 @end
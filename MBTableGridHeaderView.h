@@ -156,6 +156,13 @@
 
 - (NSRect)sortIndicatorRectOfColumn:(NSUInteger)columnIndex;
 
+/**
+ * @brief		Returns the rectangle of the triangle that shows or
+ *				hides the rows of a group, or \c NSZeroRect if the row
+ *				at \c rowIndex doesn't start a group.
+ */
+- (NSRect)disclosureIndicatorRectOfRow:(NSUInteger)rowIndex;
+
 /**
  * @}
  */
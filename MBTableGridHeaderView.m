@@ -39,7 +39,7 @@ NSString* kAutosavedColumnHiddenKey = @"AutosavedColumnHidden";
 - (NSControlStateValue)_headerStateForRow:(NSUInteger)rowIndex;
 - (void)_dragColumnsWithEvent:(NSEvent *)theEvent;
 - (void)_dragRowsWithEvent:(NSEvent *)theEvent;
-- (void)_sortButtonClickedForColumn:(NSUInteger)column;
+- (void)_sortButtonClickedForColumn:(NSUInteger)column extending:(BOOL)extending;
 - (void)_willDisplayHeaderMenu:(NSMenu *)menu forColumn:(NSUInteger)columnIndex;
 - (void)_willDisplayHeaderMenu:(NSMenu *)menu forRow:(NSUInteger)rowIndex;
 - (void)_didDoubleClickColumn:(NSUInteger)columnIndex;
@@ -146,16 +146,22 @@ NSString* kAutosavedColumnHiddenKey = @"AutosavedColumnHidden";
         // Draw the column headers
         NSRange columnRange = [self.tableGrid _rangeOfColumnsIntersectingRect:
                                [self convertRect:rect toView:self.tableGrid]];
+        NSArray<NSNumber *> *sortColumnIndexes = self.tableGrid.sortColumnIndexes;
         NSUInteger column = columnRange.location;
         while (column != NSNotFound && column < NSMaxRange(columnRange)) {
 			NSRect headerRect = [self headerRectOfColumn:column];
 			
 			// Only draw the header if we need to
 			if ([self needsToDrawRect:headerRect]) {
+				headerCell.sortIndicatorPriority = 0;
 				if ([self.indicatorImageColumns containsIndex:column]) {
-                    if (_tableGrid.sortColumnIndex == column) {
-                        headerCell.sortIndicatorAscending = _tableGrid.isSortColumnAscending;
+                    NSUInteger priority = [sortColumnIndexes indexOfObject:@(column)];
+                    if (priority != NSNotFound) {
+                        headerCell.sortIndicatorAscending = [_tableGrid isColumnSortedAscending:column];
                         headerCell.sortIndicatorColor = NSColor.labelColor;
+                        // Numbered only when there's more than one sort column
+                        if (sortColumnIndexes.count > 1)
+                            headerCell.sortIndicatorPriority = priority + 1;
                     } else {
                         headerCell.sortIndicatorAscending = NO;
                         headerCell.sortIndicatorColor = NSColor.tertiaryLabelColor;
@@ -181,6 +187,14 @@ NSString* kAutosavedColumnHiddenKey = @"AutosavedColumnHidden";
 			
 			// Only draw the header if we need to
 			if ([self needsToDrawRect:headerRect]) {
+                // The first row of a group shows or hides the rest
+                NSUInteger group = [self.tableGrid groupOfRow:row];
+                if (group != NSNotFound && [self.tableGrid rowRangeOfGroup:group].location == row) {
+                    headerCell.disclosureIndicatorColor = NSColor.secondaryLabelColor;
+                    headerCell.disclosureIndicatorExpanded = ![self.tableGrid isGroupCollapsed:group];
+                } else {
+                    headerCell.disclosureIndicatorColor = nil;
+                }
                 headerCell.state = [self.tableGrid _headerStateForRow:row];
                 headerCell.stringValue = [self.tableGrid _headerStringForRow:row] ?: @"";
 				[headerCell drawWithFrame:headerRect inView:self];
@@ -230,8 +244,13 @@ NSString* kAutosavedColumnHiddenKey = @"AutosavedColumnHidden";
         isResizing = YES;
     } else if (self.orientation == MBTableHeaderHorizontalOrientation &&
                NSPointInRect(loc, [self sortIndicatorRectOfColumn:column])) {
-        // Clicked the sort indicator
-        [self.tableGrid _sortButtonClickedForColumn:column];
+        // Clicked the sort indicator; Shift-clicking sorts by more than one column
+        [self.tableGrid _sortButtonClickedForColumn:column extending:(theEvent.modifierFlags & NSEventModifierFlagShift) != 0];
+    } else if (self.orientation == MBTableHeaderVerticalOrientation && row != NSNotFound &&
+               NSPointInRect(loc, [self disclosureIndicatorRectOfRow:row])) {
+        // Clicked a group's disclosure indicator
+        NSUInteger group = [self.tableGrid groupOfRow:row];
+        [self.tableGrid setGroup:group collapsed:![self.tableGrid isGroupCollapsed:group]];
     } else if (theEvent.clickCount == 1) {
         // For single clicks,
         if ((theEvent.modifierFlags & NSEventModifierFlagShift) && self.tableGrid.allowsMultipleSelection) {
@@ -381,8 +400,6 @@ NSString* kAutosavedColumnHiddenKey = @"AutosavedColumnHidden";
         [self.window enableCursorRects];
         [self.window invalidateCursorRectsForView:self];
         
-		// update cache of column rects
-		[self.tableGrid.columnRects removeAllObjects];
 		[self updateTrackingAreas];
     } else {
         // If we only clicked on a header that was part of a bigger selection, select it
@@ -440,10 +457,8 @@ NSString* kAutosavedColumnHiddenKey = @"AutosavedColumnHidden";
 		columnAutoSaveProperties = [NSMutableDictionary dictionary];
 	}
 	
-	[self.tableGrid.columnRects enumerateKeysAndObjectsUsingBlock:^(id key, id obj, BOOL *stop) {
-		NSValue *rectValue = obj;
-		NSRect rect = rectValue.rectValue;
-		NSDictionary<NSString *, id> *columnDict = @{kAutosavedColumnWidthKey : @(rect.size.width),
+	[self.tableGrid.columnWidths enumerateKeysAndObjectsUsingBlock:^(NSNumber *key, NSNumber *obj, BOOL *stop) {
+		NSDictionary<NSString *, id> *columnDict = @{kAutosavedColumnWidthKey : obj,
                                                      kAutosavedColumnHiddenKey : @NO};
 		columnAutoSaveProperties[[NSString stringWithFormat:@"C-%@", key]] = columnDict;
 	}];
@@ -477,4 +492,13 @@ NSString* kAutosavedColumnHiddenKey = @"AutosavedColumnHidden";
     return NSInsetRect([headerCell sortIndicatorRectForBounds:[self headerRectOfColumn:columnIndex]], -2, -4);
 }
 
+- (NSRect)disclosureIndicatorRectOfRow:(NSUInteger)rowIndex
+{
+    NSUInteger group = [self.tableGrid groupOfRow:rowIndex];
+    if (group == NSNotFound || [self.tableGrid rowRangeOfGroup:group].location != rowIndex)
+        return NSZeroRect;
+    
+    return NSInsetRect([headerCell disclosureIndicatorRectForBounds:[self headerRectOfRow:rowIndex]], -2, -4);
+}
+
 @end
@@ -0,0 +1,228 @@
+//
+//  MBTableGridOffsetIndex.c
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#include "MBTableGridOffsetIndex.h"
+
+#include <stdlib.h>
+
+#define MBBlockShift 6
+#define MBBlockSize (1 << MBBlockShift)
+
+struct MBTableGridOffsetIndex {
+    size_t count;
+    double uniformSize;
+
+    /* Per-entry sizes; NULL while the index is uniform */
+    float *sizes;
+    size_t capacity;
+
+    /* 1-based Fenwick tree over the sums of each block of sizes */
+    double *tree;
+    size_t numberOfBlocks;
+    size_t highestBit;
+};
+
+static size_t MBHighestBit(size_t n) {
+    size_t bit = 1;
+    if (n == 0)
+        return 0;
+    while (bit <= n / 2)
+        bit <<= 1;
+    return bit;
+}
+
+static void MBClearStorage(MBTableGridOffsetIndex *index) {
+    free(index->sizes);
+    free(index->tree);
+    index->sizes = NULL;
+    index->tree = NULL;
+    index->capacity = 0;
+    index->numberOfBlocks = 0;
+    index->highestBit = 0;
+}
+
+static void MBBuildTree(MBTableGridOffsetIndex *index) {
+    size_t numberOfBlocks = index->numberOfBlocks;
+    double *tree = index->tree;
+
+    for (size_t block = 0; block < numberOfBlocks; block++) {
+        size_t start = block << MBBlockShift;
+        size_t end = start + MBBlockSize;
+        double sum = 0.0;
+        if (end > index->count)
+            end = index->count;
+        for (size_t i = start; i < end; i++)
+            sum += index->sizes[i];
+        tree[block + 1] = sum;
+    }
+    for (size_t node = 1; node <= numberOfBlocks; node++) {
+        size_t parent = node + (node & (~node + 1));
+        if (parent <= numberOfBlocks)
+            tree[parent] += tree[node];
+    }
+}
+
+static double MBPrefixOfBlocks(const MBTableGridOffsetIndex *index, size_t numberOfBlocks) {
+    double sum = 0.0;
+    for (size_t node = numberOfBlocks; node > 0; node &= node - 1)
+        sum += index->tree[node];
+    return sum;
+}
+
+static bool MBMaterialize(MBTableGridOffsetIndex *index) {
+    size_t count = index->count;
+    double uniformSize = index->uniformSize;
+    float *sizes = MBTableGridOffsetIndexBeginReset(index, count);
+    if (sizes == NULL) {
+        MBTableGridOffsetIndexResetUniform(index, count, uniformSize);
+        return false;
+    }
+    for (size_t i = 0; i < count; i++)
+        sizes[i] = (float)uniformSize;
+    MBTableGridOffsetIndexEndReset(index);
+    return true;
+}
+
+MBTableGridOffsetIndex *MBTableGridOffsetIndexCreate(void) {
+    return calloc(1, sizeof(MBTableGridOffsetIndex));
+}
+
+void MBTableGridOffsetIndexDestroy(MBTableGridOffsetIndex *index) {
+    if (index == NULL)
+        return;
+    MBClearStorage(index);
+    free(index);
+}
+
+void MBTableGridOffsetIndexResetUniform(MBTableGridOffsetIndex *index, size_t count, double size) {
+    MBClearStorage(index);
+    index->count = count;
+    index->uniformSize = size;
+}
+
+float *MBTableGridOffsetIndexBeginReset(MBTableGridOffsetIndex *index, size_t count) {
+    size_t numberOfBlocks = (count + MBBlockSize - 1) >> MBBlockShift;
+
+    if (count > index->capacity || index->tree == NULL) {
+        float *sizes = count ? realloc(index->sizes, count * sizeof(float)) : index->sizes;
+        if (count && sizes == NULL) {
+            MBTableGridOffsetIndexResetUniform(index, 0, 0.0);
+            return NULL;
+        }
+        index->sizes = sizes;
+        index->capacity = count;
+    }
+    double *tree = realloc(index->tree, (numberOfBlocks + 1) * sizeof(double));
+    if (tree == NULL) {
+        MBTableGridOffsetIndexResetUniform(index, 0, 0.0);
+        return NULL;
+    }
+    index->tree = tree;
+    index->count = count;
+    index->numberOfBlocks = numberOfBlocks;
+    index->highestBit = MBHighestBit(numberOfBlocks);
+    return index->sizes;
+}
+
+void MBTableGridOffsetIndexEndReset(MBTableGridOffsetIndex *index) {
+    if (index->tree)
+        MBBuildTree(index);
+}
+
+size_t MBTableGridOffsetIndexCount(const MBTableGridOffsetIndex *index) {
+    return index->count;
+}
+
+bool MBTableGridOffsetIndexIsUniform(const MBTableGridOffsetIndex *index) {
+    return index->tree == NULL;
+}
+
+double MBTableGridOffsetIndexSizeAtIndex(const MBTableGridOffsetIndex *index, size_t i) {
+    if (i >= index->count)
+        return 0.0;
+    if (index->tree == NULL)
+        return index->uniformSize;
+    return index->sizes[i];
+}
+
+double MBTableGridOffsetIndexOffsetOfIndex(const MBTableGridOffsetIndex *index, size_t i) {
+    if (i > index->count)
+        i = index->count;
+    if (index->tree == NULL)
+        return index->uniformSize * (double)i;
+
+    size_t block = i >> MBBlockShift;
+    double offset = MBPrefixOfBlocks(index, block);
+    for (size_t j = block << MBBlockShift; j < i; j++)
+        offset += index->sizes[j];
+    return offset;
+}
+
+double MBTableGridOffsetIndexTotalSize(const MBTableGridOffsetIndex *index) {
+    if (index->tree == NULL)
+        return index->uniformSize * (double)index->count;
+    return MBPrefixOfBlocks(index, index->numberOfBlocks);
+}
+
+size_t MBTableGridOffsetIndexIndexAtOffset(const MBTableGridOffsetIndex *index, double offset) {
+    if (offset < 0.0 || index->count == 0)
+        return MBTableGridOffsetIndexNotFound;
+
+    if (index->tree == NULL) {
+        if (index->uniformSize <= 0.0)
+            return MBTableGridOffsetIndexNotFound;
+        double i = offset / index->uniformSize;
+        if (i >= (double)index->count)
+            return MBTableGridOffsetIndexNotFound;
+        return (size_t)i;
+    }
+
+    // Descend the Fenwick tree to the block containing the offset...
+    size_t block = 0;
+    double remaining = offset;
+    for (size_t step = index->highestBit; step > 0; step >>= 1) {
+        size_t node = block + step;
+        if (node <= index->numberOfBlocks && index->tree[node] <= remaining) {
+            block = node;
+            remaining -= index->tree[node];
+        }
+    }
+    if (block >= index->numberOfBlocks)
+        return MBTableGridOffsetIndexNotFound;
+
+    // ...then scan the block itself
+    size_t i = block << MBBlockShift;
+    size_t end = i + MBBlockSize;
+    if (end > index->count)
+        end = index->count;
+    while (i < end && remaining >= index->sizes[i]) {
+        remaining -= index->sizes[i];
+        i++;
+    }
+    if (i == end) {
+        // Rounding pushed us past the block; the offset is on its last edge
+        return end == index->count ? MBTableGridOffsetIndexNotFound : end - 1;
+    }
+    return i;
+}
+
+bool MBTableGridOffsetIndexSetSize(MBTableGridOffsetIndex *index, size_t i, double size) {
+    if (i >= index->count)
+        return false;
+    if (index->tree == NULL) {
+        if (size == index->uniformSize)
+            return true;
+        if (!MBMaterialize(index))
+            return false;
+    }
+
+    double delta = (double)(float)size - (double)index->sizes[i];
+    index->sizes[i] = (float)size;
+    for (size_t node = (i >> MBBlockShift) + 1; node <= index->numberOfBlocks; node += node & (~node + 1))
+        index->tree[node] += delta;
+    return true;
+}
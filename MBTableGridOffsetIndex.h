@@ -0,0 +1,124 @@
+//
+//  MBTableGridOffsetIndex.h
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#ifndef MBTableGridOffsetIndex_h
+#define MBTableGridOffsetIndex_h
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief		Returned by \c MBTableGridOffsetIndexIndexAtOffset when the
+ *				offset lies outside the indexed span.
+ */
+#define MBTableGridOffsetIndexNotFound ((size_t)-1)
+
+/**
+ * @brief		\c MBTableGridOffsetIndex maps the sizes of a sequence of
+ *				columns (or rows) to their offsets along one axis.
+ *
+ * @details		Sizes are kept in a contiguous float array. The array is
+ *				split into blocks of 64 entries, and a Fenwick tree over the
+ *				block sums provides O(log n) offset lookups, hit tests and
+ *				size updates. An index whose entries all share one size
+ *				doesn't allocate the array at all and answers every query
+ *				with a multiplication; the array is only materialized the
+ *				first time an entry is given a size of its own.
+ *
+ *				The index is plain C so that it can be built and measured
+ *				away from AppKit. It is not thread-safe.
+ */
+typedef struct MBTableGridOffsetIndex MBTableGridOffsetIndex;
+
+/**
+ * @brief		Creates an empty index. Returns \c NULL if out of memory.
+ */
+MBTableGridOffsetIndex *MBTableGridOffsetIndexCreate(void);
+
+/**
+ * @brief		Frees an index created with \c MBTableGridOffsetIndexCreate.
+ */
+void MBTableGridOffsetIndexDestroy(MBTableGridOffsetIndex *index);
+
+/**
+ * @brief		Resets the index to \c count entries of the same \c size.
+ *				Runs in O(1) and releases any per-entry storage.
+ */
+void MBTableGridOffsetIndexResetUniform(MBTableGridOffsetIndex *index, size_t count, double size);
+
+/**
+ * @brief		Begins a bulk reset of the index to \c count entries.
+ *
+ * @details		Returns a buffer of \c count floats for the caller to fill
+ *				with entry sizes, or \c NULL if out of memory (in which case
+ *				the index is left empty). The index must not be queried
+ *				until \c MBTableGridOffsetIndexEndReset is called, which
+ *				builds the tree in O(n).
+ */
+float *MBTableGridOffsetIndexBeginReset(MBTableGridOffsetIndex *index, size_t count);
+
+/**
+ * @brief		Completes a bulk reset started with
+ *				\c MBTableGridOffsetIndexBeginReset.
+ */
+void MBTableGridOffsetIndexEndReset(MBTableGridOffsetIndex *index);
+
+/**
+ * @brief		Returns the number of entries in the index.
+ */
+size_t MBTableGridOffsetIndexCount(const MBTableGridOffsetIndex *index);
+
+/**
+ * @brief		Returns \c true if every entry has the same size and no
+ *				per-entry storage is allocated.
+ */
+bool MBTableGridOffsetIndexIsUniform(const MBTableGridOffsetIndex *index);
+
+/**
+ * @brief		Returns the size of the entry at \c i, or 0 if \c i is
+ *				out of range. O(1).
+ */
+double MBTableGridOffsetIndexSizeAtIndex(const MBTableGridOffsetIndex *index, size_t i);
+
+/**
+ * @brief		Returns the sum of the sizes of entries \c [0, i). An
+ *				\c i of \c count (or more) returns the total size. O(log n).
+ */
+double MBTableGridOffsetIndexOffsetOfIndex(const MBTableGridOffsetIndex *index, size_t i);
+
+/**
+ * @brief		Returns the sum of the sizes of all entries. O(log n).
+ */
+double MBTableGridOffsetIndexTotalSize(const MBTableGridOffsetIndex *index);
+
+/**
+ * @brief		Returns the entry \c i such that
+ *				<tt>offset(i) <= offset < offset(i+1)</tt>, or
+ *				\c MBTableGridOffsetIndexNotFound if \c offset is negative
+ *				or not less than the total size. O(log n).
+ */
+size_t MBTableGridOffsetIndexIndexAtOffset(const MBTableGridOffsetIndex *index, double offset);
+
+/**
+ * @brief		Sets the size of the entry at \c i. O(log n), except for
+ *				the first update of a uniform index, which allocates the
+ *				per-entry storage in O(n).
+ *
+ * @return		\c false if \c i is out of range or memory could not be
+ *				allocated, in which case the index is unchanged.
+ */
+bool MBTableGridOffsetIndexSetSize(MBTableGridOffsetIndex *index, size_t i, double size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MBTableGridOffsetIndex_h */
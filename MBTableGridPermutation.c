@@ -0,0 +1,297 @@
+//
+//  MBTableGridPermutation.c
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#include "MBTableGridPermutation.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define MBPermutationBlockCapacity 1024
+
+typedef struct MBPermutationBlock {
+    size_t count;
+    size_t items[MBPermutationBlockCapacity];
+} MBPermutationBlock;
+
+struct MBTableGridPermutation {
+    size_t count;
+
+    // Blocks by their ID, which never changes, and the IDs in order
+    MBPermutationBlock **blocks;
+    size_t *order;
+    size_t *orderIndexes; // where each block ID is in order
+    size_t blockCount;
+    size_t blockCapacity;
+
+    // Fenwick tree of the block counts, in order, indexed from 1
+    size_t *tree;
+
+    // The ID of the block holding each item, or MBTableGridPermutationNotFound
+    size_t *blockOfItem;
+    size_t itemCapacity;
+};
+
+static void MBTreeAdd(MBTableGridPermutation *permutation, size_t orderIndex, size_t delta) {
+    for (size_t i = orderIndex + 1; i <= permutation->blockCount; i += i & (~i + 1))
+        permutation->tree[i] += delta;
+}
+
+// The number of items in the blocks before orderIndex
+static size_t MBTreePrefix(const MBTableGridPermutation *permutation, size_t orderIndex) {
+    size_t sum = 0;
+    for (size_t i = orderIndex; i > 0; i -= i & (~i + 1))
+        sum += permutation->tree[i];
+    return sum;
+}
+
+static void MBTreeBuild(MBTableGridPermutation *permutation) {
+    permutation->tree[0] = 0;
+    for (size_t i = 1; i <= permutation->blockCount; i++)
+        permutation->tree[i] = permutation->blocks[permutation->order[i - 1]]->count;
+    for (size_t i = 1; i <= permutation->blockCount; i++) {
+        size_t parent = i + (i & (~i + 1));
+        if (parent <= permutation->blockCount)
+            permutation->tree[parent] += permutation->tree[i];
+    }
+}
+
+// Finds the block holding a position by descending the tree, and the position within it
+static size_t MBFindBlock(const MBTableGridPermutation *permutation, size_t position, size_t *offset) {
+    size_t step = 1;
+    while (step * 2 <= permutation->blockCount)
+        step *= 2;
+    size_t orderIndex = 0;
+    for (; step; step /= 2) {
+        if (orderIndex + step <= permutation->blockCount && permutation->tree[orderIndex + step] <= position) {
+            orderIndex += step;
+            position -= permutation->tree[orderIndex];
+        }
+    }
+    *offset = position;
+    return orderIndex;
+}
+
+static bool MBReserveBlocks(MBTableGridPermutation *permutation, size_t blockCount) {
+    if (blockCount <= permutation->blockCapacity)
+        return true;
+    size_t capacity = permutation->blockCapacity ? permutation->blockCapacity : 16;
+    while (capacity < blockCount)
+        capacity *= 2;
+    MBPermutationBlock **blocks = realloc(permutation->blocks, capacity * sizeof(MBPermutationBlock *));
+    if (blocks)
+        permutation->blocks = blocks;
+    size_t *order = realloc(permutation->order, capacity * sizeof(size_t));
+    if (order)
+        permutation->order = order;
+    size_t *orderIndexes = realloc(permutation->orderIndexes, capacity * sizeof(size_t));
+    if (orderIndexes)
+        permutation->orderIndexes = orderIndexes;
+    size_t *tree = realloc(permutation->tree, (capacity + 1) * sizeof(size_t));
+    if (tree)
+        permutation->tree = tree;
+    if (blocks == NULL || order == NULL || orderIndexes == NULL || tree == NULL)
+        return false;
+    permutation->blockCapacity = capacity;
+    return true;
+}
+
+static bool MBReserveItems(MBTableGridPermutation *permutation, size_t item) {
+    if (item < permutation->itemCapacity)
+        return true;
+    size_t capacity = permutation->itemCapacity ? permutation->itemCapacity : 1024;
+    while (capacity <= item)
+        capacity *= 2;
+    size_t *blockOfItem = realloc(permutation->blockOfItem, capacity * sizeof(size_t));
+    if (blockOfItem == NULL)
+        return false;
+    for (size_t i = permutation->itemCapacity; i < capacity; i++)
+        blockOfItem[i] = MBTableGridPermutationNotFound;
+    permutation->blockOfItem = blockOfItem;
+    permutation->itemCapacity = capacity;
+    return true;
+}
+
+MBTableGridPermutation *MBTableGridPermutationCreate(const size_t *items, size_t count) {
+    MBTableGridPermutation *permutation = calloc(1, sizeof(MBTableGridPermutation));
+    if (permutation == NULL)
+        return NULL;
+    size_t blockCount = (count + MBPermutationBlockCapacity - 1) / MBPermutationBlockCapacity;
+    size_t largestItem = 0;
+    for (size_t i = 0; i < count; i++)
+        largestItem = items[i] > largestItem ? items[i] : largestItem;
+    if (!MBReserveBlocks(permutation, blockCount ? blockCount : 1) || !MBReserveItems(permutation, largestItem)) {
+        MBTableGridPermutationDestroy(permutation);
+        return NULL;
+    }
+
+    // Blocks start full, and split the first time something is inserted into them
+    for (size_t id = 0; id < blockCount; id++) {
+        MBPermutationBlock *block = malloc(sizeof(MBPermutationBlock));
+        if (block == NULL) {
+            MBTableGridPermutationDestroy(permutation);
+            return NULL;
+        }
+        size_t first = id * MBPermutationBlockCapacity;
+        block->count = (count - first < MBPermutationBlockCapacity) ? count - first : MBPermutationBlockCapacity;
+        memcpy(block->items, items + first, block->count * sizeof(size_t));
+        for (size_t i = 0; i < block->count; i++)
+            permutation->blockOfItem[block->items[i]] = id;
+        permutation->blocks[id] = block;
+        permutation->order[id] = id;
+        permutation->orderIndexes[id] = id;
+        permutation->blockCount = id + 1;
+    }
+    permutation->count = count;
+    MBTreeBuild(permutation);
+    return permutation;
+}
+
+void MBTableGridPermutationDestroy(MBTableGridPermutation *permutation) {
+    if (permutation == NULL)
+        return;
+    for (size_t id = 0; id < permutation->blockCount; id++)
+        free(permutation->blocks[id]);
+    free(permutation->blocks);
+    free(permutation->order);
+    free(permutation->orderIndexes);
+    free(permutation->tree);
+    free(permutation->blockOfItem);
+    free(permutation);
+}
+
+size_t MBTableGridPermutationCount(const MBTableGridPermutation *permutation) {
+    return permutation->count;
+}
+
+size_t MBTableGridPermutationItemAtPosition(const MBTableGridPermutation *permutation, size_t position) {
+    size_t offset;
+    size_t orderIndex = MBFindBlock(permutation, position, &offset);
+    return permutation->blocks[permutation->order[orderIndex]]->items[offset];
+}
+
+size_t MBTableGridPermutationPositionOfItem(const MBTableGridPermutation *permutation, size_t item) {
+    if (item >= permutation->itemCapacity || permutation->blockOfItem[item] == MBTableGridPermutationNotFound)
+        return MBTableGridPermutationNotFound;
+    size_t id = permutation->blockOfItem[item];
+    const MBPermutationBlock *block = permutation->blocks[id];
+    for (size_t i = 0; i < block->count; i++) {
+        if (block->items[i] == item)
+            return MBTreePrefix(permutation, permutation->orderIndexes[id]) + i;
+    }
+    return MBTableGridPermutationNotFound;
+}
+
+void MBTableGridPermutationGetItems(const MBTableGridPermutation *permutation, size_t position, size_t count, size_t *items) {
+    if (count == 0)
+        return;
+    size_t offset;
+    size_t orderIndex = MBFindBlock(permutation, position, &offset);
+    while (count) {
+        const MBPermutationBlock *block = permutation->blocks[permutation->order[orderIndex++]];
+        size_t length = (block->count - offset < count) ? block->count - offset : count;
+        memcpy(items, block->items + offset, length * sizeof(size_t));
+        items += length;
+        count -= length;
+        offset = 0;
+    }
+}
+
+// Moves the upper half of a full block into a new block just after it
+static bool MBSplitBlock(MBTableGridPermutation *permutation, size_t orderIndex) {
+    if (!MBReserveBlocks(permutation, permutation->blockCount + 1))
+        return false;
+    MBPermutationBlock *upper = malloc(sizeof(MBPermutationBlock));
+    if (upper == NULL)
+        return false;
+
+    size_t id = permutation->blockCount;
+    MBPermutationBlock *lower = permutation->blocks[permutation->order[orderIndex]];
+    upper->count = lower->count / 2;
+    lower->count -= upper->count;
+    memcpy(upper->items, lower->items + lower->count, upper->count * sizeof(size_t));
+    for (size_t i = 0; i < upper->count; i++)
+        permutation->blockOfItem[upper->items[i]] = id;
+
+    permutation->blocks[id] = upper;
+    memmove(permutation->order + orderIndex + 2, permutation->order + orderIndex + 1,
+            (permutation->blockCount - orderIndex - 1) * sizeof(size_t));
+    permutation->order[orderIndex + 1] = id;
+    permutation->blockCount++;
+    for (size_t i = orderIndex + 1; i < permutation->blockCount; i++)
+        permutation->orderIndexes[permutation->order[i]] = i;
+    MBTreeBuild(permutation);
+    return true;
+}
+
+bool MBTableGridPermutationInsert(MBTableGridPermutation *permutation, size_t position, size_t item) {
+    if (!MBReserveItems(permutation, item))
+        return false;
+    if (permutation->blockCount == 0) {
+        MBPermutationBlock *block = malloc(sizeof(MBPermutationBlock));
+        if (block == NULL || !MBReserveBlocks(permutation, 1)) {
+            free(block);
+            return false;
+        }
+        block->count = 0;
+        permutation->blocks[0] = block;
+        permutation->order[0] = 0;
+        permutation->orderIndexes[0] = 0;
+        permutation->blockCount = 1;
+        MBTreeBuild(permutation);
+    }
+
+    size_t orderIndex, offset;
+    if (position == permutation->count) {
+        orderIndex = permutation->blockCount - 1;
+        offset = permutation->blocks[permutation->order[orderIndex]]->count;
+    } else {
+        orderIndex = MBFindBlock(permutation, position, &offset);
+    }
+    MBPermutationBlock *block = permutation->blocks[permutation->order[orderIndex]];
+    if (block->count == MBPermutationBlockCapacity) {
+        if (!MBSplitBlock(permutation, orderIndex))
+            return false;
+        if (offset > block->count) {
+            offset -= block->count;
+            orderIndex++;
+            block = permutation->blocks[permutation->order[orderIndex]];
+        }
+    }
+
+    memmove(block->items + offset + 1, block->items + offset, (block->count - offset) * sizeof(size_t));
+    block->items[offset] = item;
+    block->count++;
+    permutation->blockOfItem[item] = permutation->order[orderIndex];
+    MBTreeAdd(permutation, orderIndex, 1);
+    permutation->count++;
+    return true;
+}
+
+size_t MBTableGridPermutationRemove(MBTableGridPermutation *permutation, size_t position) {
+    size_t offset;
+    size_t orderIndex = MBFindBlock(permutation, position, &offset);
+    MBPermutationBlock *block = permutation->blocks[permutation->order[orderIndex]];
+    size_t item = block->items[offset];
+    memmove(block->items + offset, block->items + offset + 1, (block->count - offset - 1) * sizeof(size_t));
+    block->count--;
+    permutation->blockOfItem[item] = MBTableGridPermutationNotFound;
+    MBTreeAdd(permutation, orderIndex, (size_t)-1);
+    permutation->count--;
+    return item;
+}
+
+size_t MBTableGridPermutationSearch(const MBTableGridPermutation *permutation, MBTableGridPermutationCompareFunction compare, void *context) {
+    size_t low = 0, high = permutation->count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (compare(context, MBTableGridPermutationItemAtPosition(permutation, middle)) < 0)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
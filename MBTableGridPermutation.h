@@ -0,0 +1,110 @@
+//
+//  MBTableGridPermutation.h
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#ifndef MBTableGridPermutation_h
+#define MBTableGridPermutation_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief		Returned when an item isn't in the permutation.
+ */
+#define MBTableGridPermutationNotFound ((size_t)-1)
+
+/**
+ * @brief		\c MBTableGridPermutation is an ordered list of distinct
+ *				items, such as the data source rows in the order the grid
+ *				shows them, that can be changed an item at a time.
+ *
+ * @details		Items are kept in blocks of up to 1,024, with the number
+ *				in each block kept in a Fenwick tree, and each item's block
+ *				kept in a table indexed by item. Finding the item at a
+ *				position takes a descent of the tree; finding the position
+ *				of an item takes a scan of its block and a prefix sum of
+ *				the tree; and inserting or removing an item moves at most
+ *				one block's items, splitting full blocks in two. Moving an
+ *				item therefore costs \c O(log n) plus a block, rather than
+ *				the \c O(n) of shifting a flat array and its inverse.
+ *
+ *				The permutation is plain C so that it can be built and
+ *				measured away from AppKit. It is not thread-safe.
+ */
+typedef struct MBTableGridPermutation MBTableGridPermutation;
+
+/**
+ * @brief		Creates a permutation holding \c count distinct items in
+ *				the given order. Returns \c NULL if out of memory.
+ */
+MBTableGridPermutation *MBTableGridPermutationCreate(const size_t *items, size_t count);
+
+/**
+ * @brief		Frees a permutation created with \c MBTableGridPermutationCreate.
+ */
+void MBTableGridPermutationDestroy(MBTableGridPermutation *permutation);
+
+/**
+ * @brief		Returns the number of items.
+ */
+size_t MBTableGridPermutationCount(const MBTableGridPermutation *permutation);
+
+/**
+ * @brief		Returns the item at a position, which must be less than
+ *				the count.
+ */
+size_t MBTableGridPermutationItemAtPosition(const MBTableGridPermutation *permutation, size_t position);
+
+/**
+ * @brief		Returns the position of an item, or
+ *				\c MBTableGridPermutationNotFound if it isn't there.
+ */
+size_t MBTableGridPermutationPositionOfItem(const MBTableGridPermutation *permutation, size_t item);
+
+/**
+ * @brief		Copies the \c count items from \c position, which must all
+ *				exist, into \c items.
+ */
+void MBTableGridPermutationGetItems(const MBTableGridPermutation *permutation, size_t position, size_t count, size_t *items);
+
+/**
+ * @brief		Inserts an item that isn't already there before the item
+ *				at \c position, or at the end if \c position is the count.
+ *
+ * @return		\c false if out of memory, in which case the permutation
+ *				is unchanged.
+ */
+bool MBTableGridPermutationInsert(MBTableGridPermutation *permutation, size_t position, size_t item);
+
+/**
+ * @brief		Removes and returns the item at a position, which must be
+ *				less than the count.
+ */
+size_t MBTableGridPermutationRemove(MBTableGridPermutation *permutation, size_t position);
+
+/**
+ * @brief		Compares an item with the one being searched for, returning
+ *				a negative number if it belongs before it.
+ */
+typedef int (*MBTableGridPermutationCompareFunction)(void *context, size_t item);
+
+/**
+ * @brief		Returns the first position whose item doesn't belong before
+ *				the one being searched for, by binary search. The items must
+ *				already be in the order \c compare describes.
+ */
+size_t MBTableGridPermutationSearch(const MBTableGridPermutation *permutation, MBTableGridPermutationCompareFunction compare, void *context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MBTableGridPermutation_h */
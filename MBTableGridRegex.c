@@ -0,0 +1,1071 @@
+//
+//  MBTableGridRegex.c
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#include "MBTableGridRegex.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MBMaxCodePoint 0x10FFFF
+#define MBMaxRepeat 1000
+#define MBMaxStates 65536
+#define MBMaxDFAStates 1024
+#define MBNoNode (-1)
+#define MBNoState UINT32_MAX
+
+/* Returned by MBIntern when the state cache is full or memory runs out */
+#define MBDFAFull (-2)
+#define MBDFAFailed (-1)
+
+typedef struct MBRange {
+    uint32_t lo;
+    uint32_t hi;
+} MBRange;
+
+typedef struct MBRangeList {
+    MBRange *items;
+    size_t count;
+    size_t capacity;
+} MBRangeList;
+
+typedef enum MBNodeType {
+    MBNodeClass,
+    MBNodeConcat,
+    MBNodeAlternate,
+    MBNodeRepeat,
+    MBNodeBegin,
+    MBNodeEnd
+} MBNodeType;
+
+/* Parse tree. Concatenations and alternations link their operands through
+   child and sibling; a repetition's operand is its child. */
+typedef struct MBNode {
+    MBNodeType type;
+    int child;
+    int sibling;
+    int min;
+    int max; /* -1 if unbounded */
+    MBRangeList ranges;
+} MBNode;
+
+typedef struct MBParser {
+    const unsigned char *bytes;
+    size_t length;
+    size_t offset;
+    MBTableGridRegexSyntax syntax;
+    bool ignoresCase;
+    MBNode *nodes;
+    size_t nodeCount;
+    size_t nodeCapacity;
+} MBParser;
+
+typedef enum MBStateType {
+    MBStateByte,
+    MBStateSplit,
+    MBStateBegin,
+    MBStateEnd,
+    MBStateMatch
+} MBStateType;
+
+typedef struct MBState {
+    uint8_t type;
+    uint8_t lo;
+    uint8_t hi;
+    uint32_t out;
+    uint32_t out1;
+} MBState;
+
+struct MBTableGridRegex {
+    MBState *states;
+    uint32_t stateCount;
+    uint32_t stateCapacity;
+    uint32_t start;
+};
+
+typedef struct MBDFAState {
+    uint32_t setStart;
+    uint32_t setCount;
+    bool accepts;
+    bool acceptsAtEnd;
+    int32_t next[256];
+} MBDFAState;
+
+struct MBTableGridRegexMatcher {
+    const MBTableGridRegex *regex;
+
+    /* Scratch for building sets of automaton states */
+    uint32_t *marks;
+    uint32_t markGeneration;
+    uint32_t *stack;
+    uint32_t *current;
+    uint32_t currentCount;
+    uint32_t *following;
+
+    /* The cached deterministic states, their state sets, and a hash table
+       from set to state */
+    MBDFAState *dfa;
+    uint32_t dfaCount;
+    uint32_t dfaCapacity;
+    uint32_t *pool;
+    size_t poolCount;
+    size_t poolCapacity;
+    int32_t table[MBMaxDFAStates * 2];
+    int32_t start;
+};
+
+// Range lists
+
+static bool MBRangeListAdd(MBRangeList *list, uint32_t lo, uint32_t hi) {
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity ? list->capacity * 2 : 4;
+        MBRange *items = realloc(list->items, capacity * sizeof(MBRange));
+        if (items == NULL)
+            return false;
+        list->items = items;
+        list->capacity = capacity;
+    }
+    list->items[list->count++] = (MBRange){ lo, hi };
+    return true;
+}
+
+static int MBCompareRanges(const void *a, const void *b) {
+    const MBRange *left = a, *right = b;
+    return left->lo < right->lo ? -1 : left->lo > right->lo;
+}
+
+// Sorts the ranges and merges those that overlap or touch
+static void MBRangeListNormalize(MBRangeList *list) {
+    size_t count = 0;
+    qsort(list->items, list->count, sizeof(MBRange), MBCompareRanges);
+    for (size_t i = 0; i < list->count; i++) {
+        if (count && list->items[i].lo <= list->items[count - 1].hi + 1) {
+            if (list->items[i].hi > list->items[count - 1].hi)
+                list->items[count - 1].hi = list->items[i].hi;
+        } else {
+            list->items[count++] = list->items[i];
+        }
+    }
+    list->count = count;
+}
+
+// Replaces a normalized list with the code points it doesn't contain
+static bool MBRangeListNegate(MBRangeList *list) {
+    MBRangeList negated = { NULL, 0, 0 };
+    uint32_t next = 0;
+    for (size_t i = 0; i < list->count; i++) {
+        if (list->items[i].lo > next && !MBRangeListAdd(&negated, next, list->items[i].lo - 1))
+            goto fail;
+        next = list->items[i].hi + 1;
+    }
+    if (next <= MBMaxCodePoint && !MBRangeListAdd(&negated, next, MBMaxCodePoint))
+        goto fail;
+    free(list->items);
+    *list = negated;
+    return true;
+
+fail:
+    free(negated.items);
+    return false;
+}
+
+static bool MBRangeListAddCaseVariants(MBRangeList *list) {
+    size_t count = list->count;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t lo = list->items[i].lo, hi = list->items[i].hi;
+        if (lo <= 'z' && hi >= 'a' && !MBRangeListAdd(list, (lo > 'a' ? lo : 'a') - 32, (hi < 'z' ? hi : 'z') - 32))
+            return false;
+        if (lo <= 'Z' && hi >= 'A' && !MBRangeListAdd(list, (lo > 'A' ? lo : 'A') + 32, (hi < 'Z' ? hi : 'Z') + 32))
+            return false;
+    }
+    return true;
+}
+
+// Parser
+
+static int MBNewNode(MBParser *p, MBNodeType type) {
+    if (p->nodeCount == p->nodeCapacity) {
+        size_t capacity = p->nodeCapacity ? p->nodeCapacity * 2 : 16;
+        MBNode *nodes = realloc(p->nodes, capacity * sizeof(MBNode));
+        if (nodes == NULL)
+            return MBNoNode;
+        p->nodes = nodes;
+        p->nodeCapacity = capacity;
+    }
+    p->nodes[p->nodeCount] = (MBNode){ type, MBNoNode, MBNoNode, 0, 0, { NULL, 0, 0 } };
+    return (int)p->nodeCount++;
+}
+
+static bool MBAtEnd(const MBParser *p) {
+    return p->offset >= p->length;
+}
+
+static bool MBAccept(MBParser *p, unsigned char c) {
+    if (MBAtEnd(p) || p->bytes[p->offset] != c)
+        return false;
+    p->offset++;
+    return true;
+}
+
+static bool MBDecodeCodePoint(MBParser *p, uint32_t *codePoint) {
+    static const uint32_t minimums[] = { 0, 0x80, 0x800, 0x10000 };
+    const unsigned char *bytes = p->bytes + p->offset;
+    size_t available = p->length - p->offset, length;
+    uint32_t c = bytes[0];
+
+    if (c < 0x80) {
+        length = 1;
+    } else if (c >= 0xC2 && c <= 0xDF) {
+        length = 2;
+        c &= 0x1F;
+    } else if (c >= 0xE0 && c <= 0xEF) {
+        length = 3;
+        c &= 0x0F;
+    } else if (c >= 0xF0 && c <= 0xF4) {
+        length = 4;
+        c &= 0x07;
+    } else {
+        return false;
+    }
+    if (length > available)
+        return false;
+    for (size_t i = 1; i < length; i++) {
+        if ((bytes[i] & 0xC0) != 0x80)
+            return false;
+        c = (c << 6) | (bytes[i] & 0x3F);
+    }
+    if (c < minimums[length - 1] || c > MBMaxCodePoint)
+        return false;
+    p->offset += length;
+    *codePoint = c;
+    return true;
+}
+
+static int MBHexDigit(unsigned char c) {
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+static bool MBParseHex(MBParser *p, size_t digits, uint32_t *codePoint) {
+    uint32_t value = 0;
+    for (size_t i = 0; i < digits; i++) {
+        int digit = MBAtEnd(p) ? -1 : MBHexDigit(p->bytes[p->offset]);
+        if (digit < 0)
+            return false;
+        value = value * 16 + (uint32_t)digit;
+        p->offset++;
+    }
+    *codePoint = value;
+    return true;
+}
+
+typedef enum MBEscape {
+    MBEscapeInvalid,
+    MBEscapeLiteral,
+    MBEscapeClass,
+    MBEscapeBegin,
+    MBEscapeEnd
+} MBEscape;
+
+// Parses what follows a backslash, adding shorthand classes such as \d to ranges
+static MBEscape MBParseEscape(MBParser *p, MBRangeList *ranges, uint32_t *codePoint) {
+    MBRangeList shorthand = { NULL, 0, 0 };
+    bool succeeded = true;
+    unsigned char c;
+
+    if (MBAtEnd(p))
+        return MBEscapeInvalid;
+    if (p->syntax == MBTableGridRegexSyntaxWildcard || p->bytes[p->offset] >= 0x80)
+        return MBDecodeCodePoint(p, codePoint) ? MBEscapeLiteral : MBEscapeInvalid;
+
+    c = p->bytes[p->offset++];
+    switch (c) {
+        case 'n': *codePoint = '\n'; return MBEscapeLiteral;
+        case 't': *codePoint = '\t'; return MBEscapeLiteral;
+        case 'r': *codePoint = '\r'; return MBEscapeLiteral;
+        case 'f': *codePoint = '\f'; return MBEscapeLiteral;
+        case 'v': *codePoint = '\v'; return MBEscapeLiteral;
+        case 'e': *codePoint = 0x1B; return MBEscapeLiteral;
+        case 'A': return MBEscapeBegin;
+        case 'z': case 'Z': return MBEscapeEnd;
+        case 'x':
+            if (MBAccept(p, '{')) {
+                size_t start = p->offset;
+                while (!MBAtEnd(p) && MBHexDigit(p->bytes[p->offset]) >= 0)
+                    p->offset++;
+                size_t digits = p->offset - start;
+                p->offset = start;
+                if (digits == 0 || digits > 6 || !MBParseHex(p, digits, codePoint) || !MBAccept(p, '}'))
+                    return MBEscapeInvalid;
+                return *codePoint <= MBMaxCodePoint ? MBEscapeLiteral : MBEscapeInvalid;
+            }
+            return MBParseHex(p, 2, codePoint) ? MBEscapeLiteral : MBEscapeInvalid;
+        case 'u':
+            return MBParseHex(p, 4, codePoint) ? MBEscapeLiteral : MBEscapeInvalid;
+        case 'd': case 'D':
+            succeeded = MBRangeListAdd(&shorthand, '0', '9');
+            break;
+        case 'w': case 'W':
+            succeeded = (MBRangeListAdd(&shorthand, '0', '9') && MBRangeListAdd(&shorthand, 'A', 'Z') &&
+                         MBRangeListAdd(&shorthand, '_', '_') && MBRangeListAdd(&shorthand, 'a', 'z'));
+            break;
+        case 's': case 'S':
+            succeeded = MBRangeListAdd(&shorthand, '\t', '\r') && MBRangeListAdd(&shorthand, ' ', ' ');
+            break;
+        default:
+            // Any other letter or digit is an escape this engine doesn't support
+            if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9'))
+                return MBEscapeInvalid;
+            *codePoint = c;
+            return MBEscapeLiteral;
+    }
+
+    if (succeeded && c >= 'A' && c <= 'Z')
+        succeeded = MBRangeListNegate(&shorthand);
+    for (size_t i = 0; succeeded && i < shorthand.count; i++)
+        succeeded = MBRangeListAdd(ranges, shorthand.items[i].lo, shorthand.items[i].hi);
+    free(shorthand.items);
+    return succeeded ? MBEscapeClass : MBEscapeInvalid;
+}
+
+// A class node for the code points in ranges, which it takes over
+static int MBClassNode(MBParser *p, MBRangeList *ranges) {
+    int node;
+    if (p->ignoresCase && !MBRangeListAddCaseVariants(ranges))
+        goto fail;
+    MBRangeListNormalize(ranges);
+    if ((node = MBNewNode(p, MBNodeClass)) == MBNoNode)
+        goto fail;
+    p->nodes[node].ranges = *ranges;
+    return node;
+
+fail:
+    free(ranges->items);
+    return MBNoNode;
+}
+
+static int MBAnyNode(MBParser *p, bool matchesNewline) {
+    MBRangeList ranges = { NULL, 0, 0 };
+    if (matchesNewline ? !MBRangeListAdd(&ranges, 0, MBMaxCodePoint)
+                       : !MBRangeListAdd(&ranges, 0, '\n' - 1) || !MBRangeListAdd(&ranges, '\n' + 1, MBMaxCodePoint)) {
+        free(ranges.items);
+        return MBNoNode;
+    }
+    return MBClassNode(p, &ranges);
+}
+
+static int MBLiteralNode(MBParser *p, uint32_t codePoint) {
+    MBRangeList ranges = { NULL, 0, 0 };
+    if (!MBRangeListAdd(&ranges, codePoint, codePoint)) {
+        free(ranges.items);
+        return MBNoNode;
+    }
+    return MBClassNode(p, &ranges);
+}
+
+// Parses a bracketed class, after the opening bracket
+static int MBParseClass(MBParser *p) {
+    MBRangeList ranges = { NULL, 0, 0 };
+    bool negated = MBAccept(p, '^') || (p->syntax == MBTableGridRegexSyntaxWildcard && MBAccept(p, '!'));
+    bool isFirst = true;
+
+    for (;;) {
+        uint32_t lo, hi;
+        MBEscape escape = MBEscapeLiteral;
+
+        if (MBAtEnd(p))
+            goto fail;
+        if (!isFirst && MBAccept(p, ']'))
+            break;
+        isFirst = false;
+
+        if (MBAccept(p, '\\'))
+            escape = MBParseEscape(p, &ranges, &lo);
+        else if (!MBDecodeCodePoint(p, &lo))
+            goto fail;
+        if (escape == MBEscapeClass)
+            continue;
+        if (escape != MBEscapeLiteral)
+            goto fail;
+
+        hi = lo;
+        if (p->offset + 1 < p->length && p->bytes[p->offset] == '-' && p->bytes[p->offset + 1] != ']') {
+            p->offset++;
+            if (MBAccept(p, '\\'))
+                escape = MBParseEscape(p, &ranges, &hi);
+            else if (!MBDecodeCodePoint(p, &hi))
+                goto fail;
+            if (escape != MBEscapeLiteral || hi < lo)
+                goto fail;
+        }
+        if (!MBRangeListAdd(&ranges, lo, hi))
+            goto fail;
+    }
+
+    if (p->ignoresCase && !MBRangeListAddCaseVariants(&ranges))
+        goto fail;
+    MBRangeListNormalize(&ranges);
+    if (negated && !MBRangeListNegate(&ranges))
+        goto fail;
+
+    // Case variants are already in, so don't add them again
+    bool ignoresCase = p->ignoresCase;
+    p->ignoresCase = false;
+    int node = MBClassNode(p, &ranges);
+    p->ignoresCase = ignoresCase;
+    return node;
+
+fail:
+    free(ranges.items);
+    return MBNoNode;
+}
+
+static int MBParseAlternation(MBParser *p, int depth);
+
+static int MBParseAtom(MBParser *p, int depth) {
+    unsigned char c = p->bytes[p->offset];
+    uint32_t codePoint;
+
+    if (p->syntax == MBTableGridRegexSyntaxWildcard) {
+        if (c == '*') {
+            p->offset++;
+            int any = MBAnyNode(p, true), node;
+            if (any == MBNoNode || (node = MBNewNode(p, MBNodeRepeat)) == MBNoNode)
+                return MBNoNode;
+            p->nodes[node].child = any;
+            p->nodes[node].max = -1;
+            return node;
+        }
+        if (c == '?') {
+            p->offset++;
+            return MBAnyNode(p, true);
+        }
+    } else {
+        switch (c) {
+            case '(': {
+                p->offset++;
+                if (MBAccept(p, '?') && !MBAccept(p, ':'))
+                    return MBNoNode;
+                int node = MBParseAlternation(p, depth + 1);
+                if (node == MBNoNode || !MBAccept(p, ')'))
+                    return MBNoNode;
+                return node;
+            }
+            case '.':
+                p->offset++;
+                return MBAnyNode(p, false);
+            case '^':
+                p->offset++;
+                return MBNewNode(p, MBNodeBegin);
+            case '$':
+                p->offset++;
+                return MBNewNode(p, MBNodeEnd);
+            case '*': case '+': case '?':
+                return MBNoNode;
+        }
+    }
+
+    if (c == '[') {
+        p->offset++;
+        return MBParseClass(p);
+    }
+    if (c == '\\') {
+        MBRangeList ranges = { NULL, 0, 0 };
+        p->offset++;
+        if (MBAtEnd(p) && p->syntax == MBTableGridRegexSyntaxWildcard)
+            return MBLiteralNode(p, '\\');
+        switch (MBParseEscape(p, &ranges, &codePoint)) {
+            case MBEscapeLiteral:
+                return MBLiteralNode(p, codePoint);
+            case MBEscapeClass:
+                return MBClassNode(p, &ranges);
+            case MBEscapeBegin:
+                return MBNewNode(p, MBNodeBegin);
+            case MBEscapeEnd:
+                return MBNewNode(p, MBNodeEnd);
+            default:
+                free(ranges.items);
+                return MBNoNode;
+        }
+    }
+    if (!MBDecodeCodePoint(p, &codePoint))
+        return MBNoNode;
+    return MBLiteralNode(p, codePoint);
+}
+
+// Parses {m}, {m,} or {m,n}. A brace that doesn't start one is left as a literal.
+static bool MBParseBounds(MBParser *p, int *min, int *max, bool *isValid) {
+    size_t start = p->offset;
+    long bounds[2] = { 0, -1 };
+    int count = 0;
+
+    *isValid = true;
+    p->offset++;
+    for (;;) {
+        size_t digits = 0;
+        long value = 0;
+        while (!MBAtEnd(p) && p->bytes[p->offset] >= '0' && p->bytes[p->offset] <= '9') {
+            if (value <= MBMaxRepeat)
+                value = value * 10 + (p->bytes[p->offset] - '0');
+            p->offset++;
+            digits++;
+        }
+        if (digits == 0 && count == 0)
+            break;
+        bounds[count++] = digits ? value : -1;
+        if (count == 1 && MBAccept(p, ','))
+            continue;
+        if (MBAccept(p, '}')) {
+            *min = (int)bounds[0];
+            *max = (int)(count == 1 ? bounds[0] : bounds[1]);
+            *isValid = *min <= MBMaxRepeat && *max <= MBMaxRepeat && (*max < 0 || *min <= *max);
+            return true;
+        }
+        break;
+    }
+    p->offset = start;
+    return false;
+}
+
+static int MBParseRepeat(MBParser *p, int depth) {
+    int atom = MBParseAtom(p, depth);
+    if (atom == MBNoNode || p->syntax == MBTableGridRegexSyntaxWildcard)
+        return atom;
+
+    while (!MBAtEnd(p)) {
+        int min, max, node;
+        bool isValid;
+        switch (p->bytes[p->offset]) {
+            case '*': min = 0; max = -1; p->offset++; break;
+            case '+': min = 1; max = -1; p->offset++; break;
+            case '?': min = 0; max = 1; p->offset++; break;
+            case '{':
+                if (!MBParseBounds(p, &min, &max, &isValid))
+                    return atom;
+                if (!isValid)
+                    return MBNoNode;
+                break;
+            default:
+                return atom;
+        }
+
+        // Lazy and possessive forms match the same text
+        if (!MBAccept(p, '?'))
+            MBAccept(p, '+');
+
+        if ((node = MBNewNode(p, MBNodeRepeat)) == MBNoNode)
+            return MBNoNode;
+        p->nodes[node].child = atom;
+        p->nodes[node].min = min;
+        p->nodes[node].max = max;
+        atom = node;
+    }
+    return atom;
+}
+
+static int MBParseConcat(MBParser *p, int depth) {
+    int node = MBNewNode(p, MBNodeConcat), last = MBNoNode;
+    if (node == MBNoNode)
+        return MBNoNode;
+
+    while (!MBAtEnd(p)) {
+        unsigned char c = p->bytes[p->offset];
+        if (p->syntax == MBTableGridRegexSyntaxRegularExpression && (c == '|' || c == ')'))
+            break;
+        int item = MBParseRepeat(p, depth);
+        if (item == MBNoNode)
+            return MBNoNode;
+        if (last == MBNoNode)
+            p->nodes[node].child = item;
+        else
+            p->nodes[last].sibling = item;
+        last = item;
+    }
+    return node;
+}
+
+static int MBParseAlternation(MBParser *p, int depth) {
+    int first, node, last;
+    if (depth > 100)
+        return MBNoNode;
+    if ((first = MBParseConcat(p, depth)) == MBNoNode)
+        return MBNoNode;
+    if (MBAtEnd(p) || p->bytes[p->offset] != '|')
+        return first;
+
+    if ((node = MBNewNode(p, MBNodeAlternate)) == MBNoNode)
+        return MBNoNode;
+    p->nodes[node].child = last = first;
+    while (MBAccept(p, '|')) {
+        int next = MBParseConcat(p, depth);
+        if (next == MBNoNode)
+            return MBNoNode;
+        p->nodes[last].sibling = next;
+        last = next;
+    }
+    return node;
+}
+
+// Compiler
+
+static uint32_t MBAddState(MBTableGridRegex *regex, MBStateType type, uint8_t lo, uint8_t hi, uint32_t out, uint32_t out1) {
+    if (out == MBNoState || (type == MBStateSplit && out1 == MBNoState))
+        return MBNoState;
+    if (regex->stateCount == regex->stateCapacity) {
+        uint32_t capacity = regex->stateCapacity ? regex->stateCapacity * 2 : 64;
+        MBState *states;
+        if (regex->stateCount >= MBMaxStates || (states = realloc(regex->states, capacity * sizeof(MBState))) == NULL)
+            return MBNoState;
+        regex->states = states;
+        regex->stateCapacity = capacity;
+    }
+    regex->states[regex->stateCount] = (MBState){ (uint8_t)type, lo, hi, out, out1 };
+    return regex->stateCount++;
+}
+
+static size_t MBEncodeUTF8(uint32_t c, uint8_t *bytes) {
+    if (c < 0x80) {
+        bytes[0] = (uint8_t)c;
+        return 1;
+    }
+    if (c < 0x800) {
+        bytes[0] = (uint8_t)(0xC0 | (c >> 6));
+        bytes[1] = (uint8_t)(0x80 | (c & 0x3F));
+        return 2;
+    }
+    if (c < 0x10000) {
+        bytes[0] = (uint8_t)(0xE0 | (c >> 12));
+        bytes[1] = (uint8_t)(0x80 | ((c >> 6) & 0x3F));
+        bytes[2] = (uint8_t)(0x80 | (c & 0x3F));
+        return 3;
+    }
+    bytes[0] = (uint8_t)(0xF0 | (c >> 18));
+    bytes[1] = (uint8_t)(0x80 | ((c >> 12) & 0x3F));
+    bytes[2] = (uint8_t)(0x80 | ((c >> 6) & 0x3F));
+    bytes[3] = (uint8_t)(0x80 | (c & 0x3F));
+    return 4;
+}
+
+// Compiles the code points lo to hi into alternatives, each a run of byte
+// ranges, splitting the range until every encoding in a piece has the same
+// length and the same leading bytes except in one position. Each alternative
+// is split off from the one before, if any, and the last left in alternative.
+static bool MBCompileCodePoints(MBTableGridRegex *regex, uint32_t lo, uint32_t hi, uint32_t out, uint32_t *alternative) {
+    static const uint32_t limits[] = { 0x7F, 0x7FF, 0xFFFF };
+    uint8_t first[4] = { 0 }, last[4] = { 0 };
+
+    for (int i = 0; i < 3; i++) {
+        if (lo <= limits[i] && hi > limits[i])
+            return (MBCompileCodePoints(regex, lo, limits[i], out, alternative) &&
+                    MBCompileCodePoints(regex, limits[i] + 1, hi, out, alternative));
+    }
+    if (hi >= 0x80) {
+        for (int i = 1; i < 4; i++) {
+            uint32_t mask = (UINT32_C(1) << (6 * i)) - 1;
+            if ((lo & ~mask) == (hi & ~mask))
+                continue;
+            if ((lo & mask) != 0)
+                return (MBCompileCodePoints(regex, lo, lo | mask, out, alternative) &&
+                        MBCompileCodePoints(regex, (lo | mask) + 1, hi, out, alternative));
+            if ((hi & mask) != mask)
+                return (MBCompileCodePoints(regex, lo, (hi & ~mask) - 1, out, alternative) &&
+                        MBCompileCodePoints(regex, hi & ~mask, hi, out, alternative));
+        }
+    }
+
+    size_t length = MBEncodeUTF8(lo, first);
+    MBEncodeUTF8(hi, last);
+    uint32_t state = out;
+    for (size_t i = length; i-- > 0; )
+        state = MBAddState(regex, MBStateByte, first[i], last[i], state, 0);
+    if (*alternative != MBNoState)
+        state = MBAddState(regex, MBStateSplit, 0, 0, state, *alternative);
+    *alternative = state;
+    return state != MBNoState;
+}
+
+static uint32_t MBCompile(MBTableGridRegex *regex, const MBParser *p, int node, uint32_t out);
+
+// Compiles the operands linked from node, last first, so each leads into the next
+static uint32_t MBCompileSequence(MBTableGridRegex *regex, const MBParser *p, int node, uint32_t out) {
+    size_t count = 0;
+    int *items;
+    for (int item = node; item != MBNoNode; item = p->nodes[item].sibling)
+        count++;
+    if (count == 0)
+        return out;
+    if ((items = malloc(count * sizeof(int))) == NULL)
+        return MBNoState;
+    count = 0;
+    for (int item = node; item != MBNoNode; item = p->nodes[item].sibling)
+        items[count++] = item;
+    while (count-- > 0 && out != MBNoState)
+        out = MBCompile(regex, p, items[count], out);
+    free(items);
+    return out;
+}
+
+static uint32_t MBCompile(MBTableGridRegex *regex, const MBParser *p, int node, uint32_t out) {
+    const MBNode *n = &p->nodes[node];
+    uint32_t state = MBNoState;
+
+    if (out == MBNoState)
+        return MBNoState;
+    switch (n->type) {
+        case MBNodeClass:
+            for (size_t i = n->ranges.count; i-- > 0; ) {
+                if (!MBCompileCodePoints(regex, n->ranges.items[i].lo, n->ranges.items[i].hi, out, &state))
+                    return MBNoState;
+            }
+            // An empty class never matches
+            return state == MBNoState ? MBAddState(regex, MBStateByte, 1, 0, out, 0) : state;
+
+        case MBNodeConcat:
+            return MBCompileSequence(regex, p, n->child, out);
+
+        case MBNodeAlternate:
+            for (int item = n->child; item != MBNoNode; item = p->nodes[item].sibling) {
+                uint32_t alternative = MBCompile(regex, p, item, out);
+                state = (state == MBNoState) ? alternative : MBAddState(regex, MBStateSplit, 0, 0, alternative, state);
+                if (state == MBNoState)
+                    return MBNoState;
+            }
+            return state;
+
+        case MBNodeRepeat:
+            if (n->max < 0) {
+                // A loop back through a split, whose body is patched in once compiled
+                uint32_t split = MBAddState(regex, MBStateSplit, 0, 0, out, out), body;
+                if (split == MBNoState || (body = MBCompile(regex, p, n->child, split)) == MBNoState)
+                    return MBNoState;
+                regex->states[split].out = body;
+                state = split;
+            } else {
+                // Each optional copy may skip straight to what follows them all
+                state = out;
+                for (int i = n->min; i < n->max && state != MBNoState; i++)
+                    state = MBAddState(regex, MBStateSplit, 0, 0, MBCompile(regex, p, n->child, state), out);
+            }
+            for (int i = 0; i < n->min && state != MBNoState; i++)
+                state = MBCompile(regex, p, n->child, state);
+            return state;
+
+        case MBNodeBegin:
+            return MBAddState(regex, MBStateBegin, 0, 0, out, 0);
+
+        case MBNodeEnd:
+            return MBAddState(regex, MBStateEnd, 0, 0, out, 0);
+    }
+    return MBNoState;
+}
+
+MBTableGridRegex *MBTableGridRegexCreate(const char *pattern, size_t length, MBTableGridRegexSyntax syntax,
+                                         bool ignoresCase, size_t *errorOffset) {
+    MBParser parser = { (const unsigned char *)pattern, length, 0, syntax, ignoresCase, NULL, 0, 0 };
+    MBTableGridRegex *regex = NULL;
+    int root = MBParseAlternation(&parser, 0);
+
+    // A stray closing parenthesis stops the parse early
+    if (root != MBNoNode && MBAtEnd(&parser) && (regex = calloc(1, sizeof(MBTableGridRegex)))) {
+        uint32_t match = MBAddState(regex, MBStateMatch, 0, 0, 0, 0);
+        regex->start = MBCompile(regex, &parser, root, match);
+        if (regex->start == MBNoState) {
+            MBTableGridRegexDestroy(regex);
+            regex = NULL;
+        }
+    }
+    if (regex == NULL && errorOffset)
+        *errorOffset = parser.offset;
+
+    for (size_t i = 0; i < parser.nodeCount; i++)
+        free(parser.nodes[i].ranges.items);
+    free(parser.nodes);
+    return regex;
+}
+
+void MBTableGridRegexDestroy(MBTableGridRegex *regex) {
+    if (regex == NULL)
+        return;
+    free(regex->states);
+    free(regex);
+}
+
+// Matcher
+
+static void MBNewGeneration(MBTableGridRegexMatcher *matcher) {
+    if (++matcher->markGeneration == 0) {
+        memset(matcher->marks, 0, matcher->regex->stateCount * sizeof(uint32_t));
+        matcher->markGeneration = 1;
+    }
+}
+
+// Adds to set the states reachable from state without reading a byte, skipping
+// any already marked in this generation
+static void MBAddClosure(MBTableGridRegexMatcher *matcher, uint32_t *set, uint32_t *count, uint32_t state, bool atBegin) {
+    const MBState *states = matcher->regex->states;
+    uint32_t depth = 0;
+
+    matcher->stack[depth++] = state;
+    while (depth) {
+        uint32_t s = matcher->stack[--depth];
+        if (matcher->marks[s] == matcher->markGeneration)
+            continue;
+        matcher->marks[s] = matcher->markGeneration;
+        switch (states[s].type) {
+            case MBStateSplit:
+                matcher->stack[depth++] = states[s].out1;
+                matcher->stack[depth++] = states[s].out;
+                break;
+            case MBStateBegin:
+                if (atBegin)
+                    matcher->stack[depth++] = states[s].out;
+                break;
+            default:
+                set[(*count)++] = s;
+                break;
+        }
+    }
+}
+
+// The states that follow set after reading byte, plus a fresh start, since a
+// match may begin anywhere
+static uint32_t MBStep(MBTableGridRegexMatcher *matcher, const uint32_t *set, uint32_t count, unsigned char byte, uint32_t *following) {
+    const MBState *states = matcher->regex->states;
+    uint32_t followingCount = 0;
+
+    MBNewGeneration(matcher);
+    for (uint32_t i = 0; i < count; i++) {
+        const MBState *state = &states[set[i]];
+        if (state->type == MBStateByte && state->lo <= byte && byte <= state->hi)
+            MBAddClosure(matcher, following, &followingCount, state->out, false);
+    }
+    MBAddClosure(matcher, following, &followingCount, matcher->regex->start, false);
+    return followingCount;
+}
+
+static bool MBSetAccepts(const MBTableGridRegexMatcher *matcher, const uint32_t *set, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        if (matcher->regex->states[set[i]].type == MBStateMatch)
+            return true;
+    }
+    return false;
+}
+
+// Whether set reaches a match through end-of-text assertions
+static bool MBSetAcceptsAtEnd(MBTableGridRegexMatcher *matcher, const uint32_t *set, uint32_t count) {
+    const MBState *states = matcher->regex->states;
+    uint32_t depth = 0;
+
+    MBNewGeneration(matcher);
+    for (uint32_t i = 0; i < count; i++) {
+        if (states[set[i]].type == MBStateEnd)
+            matcher->stack[depth++] = states[set[i]].out;
+    }
+    while (depth) {
+        uint32_t s = matcher->stack[--depth];
+        if (matcher->marks[s] == matcher->markGeneration)
+            continue;
+        matcher->marks[s] = matcher->markGeneration;
+        switch (states[s].type) {
+            case MBStateMatch:
+                return true;
+            case MBStateSplit:
+                matcher->stack[depth++] = states[s].out1;
+                matcher->stack[depth++] = states[s].out;
+                break;
+            case MBStateEnd:
+                matcher->stack[depth++] = states[s].out;
+                break;
+            default:
+                break;
+        }
+    }
+    return false;
+}
+
+static int MBCompareStates(const void *a, const void *b) {
+    uint32_t left = *(const uint32_t *)a, right = *(const uint32_t *)b;
+    return left < right ? -1 : left > right;
+}
+
+static void MBFlush(MBTableGridRegexMatcher *matcher) {
+    matcher->dfaCount = 0;
+    matcher->poolCount = 0;
+    matcher->start = MBDFAFailed;
+    memset(matcher->table, 0xFF, sizeof(matcher->table));
+}
+
+// The cached state for a set of automaton states, adding it if it's new
+static int32_t MBIntern(MBTableGridRegexMatcher *matcher, uint32_t *set, uint32_t count) {
+    uint32_t hash = 2166136261u, mask = MBMaxDFAStates * 2 - 1, slot;
+    qsort(set, count, sizeof(uint32_t), MBCompareStates);
+    for (uint32_t i = 0; i < count; i++)
+        hash = (hash ^ set[i]) * 16777619u;
+
+    for (slot = hash & mask; matcher->table[slot] >= 0; slot = (slot + 1) & mask) {
+        const MBDFAState *state = &matcher->dfa[matcher->table[slot]];
+        if (state->setCount == count && memcmp(matcher->pool + state->setStart, set, count * sizeof(uint32_t)) == 0)
+            return matcher->table[slot];
+    }
+    if (matcher->dfaCount == MBMaxDFAStates)
+        return MBDFAFull;
+
+    if (matcher->dfaCount == matcher->dfaCapacity) {
+        uint32_t capacity = matcher->dfaCapacity ? matcher->dfaCapacity * 2 : 16;
+        MBDFAState *dfa = realloc(matcher->dfa, capacity * sizeof(MBDFAState));
+        if (dfa == NULL)
+            return MBDFAFailed;
+        matcher->dfa = dfa;
+        matcher->dfaCapacity = capacity;
+    }
+    if (matcher->poolCount + count > matcher->poolCapacity) {
+        size_t capacity = matcher->poolCapacity ? matcher->poolCapacity : 256;
+        while (capacity < matcher->poolCount + count)
+            capacity *= 2;
+        uint32_t *pool = realloc(matcher->pool, capacity * sizeof(uint32_t));
+        if (pool == NULL)
+            return MBDFAFailed;
+        matcher->pool = pool;
+        matcher->poolCapacity = capacity;
+    }
+
+    int32_t id = (int32_t)matcher->dfaCount++;
+    MBDFAState *state = &matcher->dfa[id];
+    state->setStart = (uint32_t)matcher->poolCount;
+    state->setCount = count;
+    state->accepts = MBSetAccepts(matcher, set, count);
+    state->acceptsAtEnd = MBSetAcceptsAtEnd(matcher, set, count);
+    memset(state->next, 0xFF, sizeof(state->next));
+    memcpy(matcher->pool + matcher->poolCount, set, count * sizeof(uint32_t));
+    matcher->poolCount += count;
+    matcher->table[slot] = id;
+    return id;
+}
+
+// Leaves the start set in current, so it can be simulated if caching fails
+static int32_t MBStartState(MBTableGridRegexMatcher *matcher) {
+    matcher->currentCount = 0;
+    MBNewGeneration(matcher);
+    MBAddClosure(matcher, matcher->current, &matcher->currentCount, matcher->regex->start, true);
+    memcpy(matcher->following, matcher->current, matcher->currentCount * sizeof(uint32_t));
+
+    int32_t state = MBIntern(matcher, matcher->following, matcher->currentCount);
+    if (state == MBDFAFull) {
+        MBFlush(matcher);
+        state = MBIntern(matcher, matcher->following, matcher->currentCount);
+    }
+    return matcher->start = (state < 0 ? MBDFAFailed : state);
+}
+
+// Leaves the set of state in current, so it can be simulated if caching fails
+static int32_t MBNextState(MBTableGridRegexMatcher *matcher, int32_t state, unsigned char byte) {
+    const MBDFAState *dfa = &matcher->dfa[state];
+    memcpy(matcher->current, matcher->pool + dfa->setStart, dfa->setCount * sizeof(uint32_t));
+    matcher->currentCount = dfa->setCount;
+
+    uint32_t count = MBStep(matcher, matcher->current, matcher->currentCount, byte, matcher->following);
+    int32_t next = MBIntern(matcher, matcher->following, count);
+    if (next == MBDFAFull) {
+        // The transition can't be recorded, since its source is flushed too
+        MBFlush(matcher);
+        next = MBIntern(matcher, matcher->following, count);
+    } else if (next >= 0) {
+        matcher->dfa[state].next[byte] = next;
+    }
+    return next < 0 ? MBDFAFailed : next;
+}
+
+// Matches the rest of the text from the set in current, without caching
+static bool MBSimulate(MBTableGridRegexMatcher *matcher, const unsigned char *bytes, size_t length) {
+    uint32_t *current = matcher->current, *following = matcher->following;
+    uint32_t count = matcher->currentCount;
+
+    for (size_t i = 0; i < length; i++) {
+        if (MBSetAccepts(matcher, current, count))
+            return true;
+        count = MBStep(matcher, current, count, bytes[i], following);
+        uint32_t *swap = current;
+        current = following;
+        following = swap;
+    }
+    return MBSetAccepts(matcher, current, count) || MBSetAcceptsAtEnd(matcher, current, count);
+}
+
+MBTableGridRegexMatcher *MBTableGridRegexMatcherCreate(const MBTableGridRegex *regex) {
+    MBTableGridRegexMatcher *matcher = calloc(1, sizeof(MBTableGridRegexMatcher));
+    if (matcher == NULL)
+        return NULL;
+    matcher->regex = regex;
+    matcher->marks = calloc(regex->stateCount, sizeof(uint32_t));
+    matcher->stack = malloc((3 * (size_t)regex->stateCount + 1) * sizeof(uint32_t));
+    matcher->current = malloc(regex->stateCount * sizeof(uint32_t));
+    matcher->following = malloc(regex->stateCount * sizeof(uint32_t));
+    if (!matcher->marks || !matcher->stack || !matcher->current || !matcher->following) {
+        MBTableGridRegexMatcherDestroy(matcher);
+        return NULL;
+    }
+    MBFlush(matcher);
+    return matcher;
+}
+
+void MBTableGridRegexMatcherDestroy(MBTableGridRegexMatcher *matcher) {
+    if (matcher == NULL)
+        return;
+    free(matcher->marks);
+    free(matcher->stack);
+    free(matcher->current);
+    free(matcher->following);
+    free(matcher->dfa);
+    free(matcher->pool);
+    free(matcher);
+}
+
+bool MBTableGridRegexMatcherMatches(MBTableGridRegexMatcher *matcher, const char *text, size_t length) {
+    const unsigned char *bytes = (const unsigned char *)text;
+    int32_t state = matcher->start >= 0 ? matcher->start : MBStartState(matcher);
+    if (state < 0)
+        return MBSimulate(matcher, bytes, length);
+
+    for (size_t i = 0; i < length; i++) {
+        const MBDFAState *dfa = &matcher->dfa[state];
+        if (dfa->accepts)
+            return true;
+        // Only patterns anchored at the start can run out of states
+        if (dfa->setCount == 0)
+            return false;
+        int32_t next = dfa->next[bytes[i]];
+        if (next < 0 && (next = MBNextState(matcher, state, bytes[i])) < 0)
+            return MBSimulate(matcher, bytes + i, length - i);
+        state = next;
+    }
+    return matcher->dfa[state].accepts || matcher->dfa[state].acceptsAtEnd;
+}
+
+size_t MBTableGridRegexMatcherMarkMatches(MBTableGridRegexMatcher *matcher, const MBTableGridValue *values,
+                                          size_t count, unsigned char *matches) {
+    size_t matchCount = 0;
+    for (size_t i = 0; i < count; i++) {
+        char scratch[MBTableGridValueFormatCapacity];
+        size_t length = 0;
+        const char *text;
+
+        matches[i] = 0;
+        if (values[i].type == MBTableGridValueTypeEmpty || values[i].type == MBTableGridValueTypePending)
+            continue;
+        text = MBTableGridValueGetUTF8(&values[i], scratch, &length);
+        if (MBTableGridRegexMatcherMatches(matcher, text, length)) {
+            matches[i] = 1;
+            matchCount++;
+        }
+    }
+    return matchCount;
+}
@@ -0,0 +1,110 @@
+//
+//  MBTableGridRegex.h
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#ifndef MBTableGridRegex_h
+#define MBTableGridRegex_h
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "MBTableGridValue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum MBTableGridRegexSyntax {
+    /* Regular expressions: literals, ., [classes], \d \w \s and their
+       negations, ^ $ \A \z, groups, |, and the * + ? {m,n} quantifiers.
+       Backreferences, lookaround and word boundaries aren't regular and
+       are rejected. */
+    MBTableGridRegexSyntaxRegularExpression,
+    /* Shell-style wildcards: * for any run of characters, ? for any one
+       character, [classes] negated with ! or ^, and \ to escape */
+    MBTableGridRegexSyntaxWildcard
+} MBTableGridRegexSyntax;
+
+/**
+ * @brief		\c MBTableGridRegex tests whether UTF-8 text contains a
+ *				match for a regular expression or wildcard pattern.
+ *
+ * @details		The pattern is compiled once into a Thompson automaton
+ *				over bytes, with multi-byte characters and classes spelled
+ *				out as sequences of byte ranges, so text is matched in place
+ *				without decoding it. Matching only answers whether the text
+ *				contains a match anywhere; \c ^ and \c $ anchor to the ends
+ *				of the text. When ignoring case, ASCII letters are compared
+ *				without regard to case; other characters must match exactly.
+ *
+ *				A compiled pattern is immutable, and may be shared between
+ *				threads, each with its own \c MBTableGridRegexMatcher.
+ */
+typedef struct MBTableGridRegex MBTableGridRegex;
+
+/**
+ * @brief		\c MBTableGridRegexMatcher matches text against a pattern
+ *				with a deterministic automaton built lazily, one state and
+ *				transition at a time, as the text demands them.
+ *
+ * @details		Once warmed up, matching takes one table lookup per byte
+ *				of text. The cache of states is bounded, and is flushed and
+ *				rebuilt when full. A matcher is not thread-safe; create one
+ *				per thread.
+ */
+typedef struct MBTableGridRegexMatcher MBTableGridRegexMatcher;
+
+/**
+ * @brief		Compiles \c length bytes of UTF-8 pattern text.
+ *
+ * @return		The compiled pattern, or \c NULL if the pattern is
+ *				malformed, too complex, or memory runs out. If
+ *				\c errorOffset isn't \c NULL it is set to the offset in the
+ *				pattern at which compiling failed.
+ */
+MBTableGridRegex *MBTableGridRegexCreate(const char *pattern, size_t length, MBTableGridRegexSyntax syntax,
+                                         bool ignoresCase, size_t *errorOffset);
+
+/**
+ * @brief		Frees a pattern created with \c MBTableGridRegexCreate,
+ *				which must outlive its matchers.
+ */
+void MBTableGridRegexDestroy(MBTableGridRegex *regex);
+
+/**
+ * @brief		Creates a matcher for a pattern. Returns \c NULL if out of
+ *				memory.
+ */
+MBTableGridRegexMatcher *MBTableGridRegexMatcherCreate(const MBTableGridRegex *regex);
+
+/**
+ * @brief		Frees a matcher created with \c MBTableGridRegexMatcherCreate.
+ */
+void MBTableGridRegexMatcherDestroy(MBTableGridRegexMatcher *matcher);
+
+/**
+ * @brief		Returns whether \c text contains a match for the pattern.
+ */
+bool MBTableGridRegexMatcherMatches(MBTableGridRegexMatcher *matcher, const char *text, size_t length);
+
+/**
+ * @brief		Sets \c matches[i] to 1 for each of the \c count values
+ *				whose text contains a match, and to 0 otherwise.
+ *
+ * @details		Values are matched in the text form given by
+ *				\c MBTableGridValueGetUTF8. Empty and pending values never
+ *				match.
+ *
+ * @return		The number of matching values.
+ */
+size_t MBTableGridRegexMatcherMarkMatches(MBTableGridRegexMatcher *matcher, const MBTableGridValue *values,
+                                          size_t count, unsigned char *matches);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MBTableGridRegex_h */
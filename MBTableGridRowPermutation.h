@@ -0,0 +1,65 @@
+//
+//  MBTableGridRowPermutation.h
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#import <Foundation/Foundation.h>
+#import <os/lock.h>
+
+#import "MBTableGridPermutation.h"
+
+// The data source rows the grid shows and their order, as the data source row of each
+// row and the row of each data source row. The grid moves rows within it as cells are
+// edited, on the main thread; every method takes a lock, so background Find and exports
+// can keep reading it, and each call sees the order as it was at one moment. Rows past
+// the end of the permutation are their own data source rows, and data source rows left
+// out of it, such as those a filter hides, have no row. The grid's order of moved
+// columns is kept in one too, with columns for rows.
+@interface MBTableGridRowPermutation : NSObject {
+    MBTableGridPermutation *_permutation;
+    os_unfair_lock _lock;
+}
+
+// Takes ownership of dataSourceRows, a malloc'd buffer of count distinct data source
+// rows. Returns nil, freeing the buffer, if out of memory.
+- (instancetype)initWithDataSourceRows:(size_t *)dataSourceRows count:(NSUInteger)count;
+
+@property (nonatomic, readonly) NSUInteger count;
+
+- (NSUInteger)dataSourceRowForRow:(NSUInteger)rowIndex;
+- (NSIndexSet *)dataSourceRowIndexesForRowIndexes:(NSIndexSet *)rowIndexes;
+
+// NSNotFound, or left out of the index set, for data source rows that aren't shown
+- (NSUInteger)rowForDataSourceRow:(NSUInteger)dataSourceRowIndex;
+- (NSIndexSet *)rowIndexesForDataSourceRowIndexes:(NSIndexSet *)dataSourceRowIndexes;
+
+// Copies the data source rows of rows that are all in the permutation
+- (void)getDataSourceRows:(size_t *)dataSourceRows inRows:(NSRange)rowRange;
+
+// Splits rows into runs whose data source rows are consecutive and ascending, so
+// that each run can be fetched from the data source with one call. rowIndex is the
+// first row of each run.
+- (void)enumerateDataSourceRangesInRows:(NSRange)rowRange usingBlock:(void (^)(NSRange dataSourceRows, NSUInteger rowIndex, BOOL *stop))block;
+
+// Takes a data source row out of the order, returning the row it was at, or NSNotFound
+- (NSUInteger)removeDataSourceRow:(NSUInteger)dataSourceRowIndex;
+
+// Adds data source rows that aren't in the order to the end of it. Returns NO if out of
+// memory, in which case some may have been added.
+- (BOOL)appendDataSourceRows:(NSRange)dataSourceRowRange;
+
+// Moves rows, which must all be in the order, so that they're together and in the order
+// they were in, from rowIndex on. Returns NO if there are none, any is out of the order,
+// or memory runs out, in which case the rows are put back where they were; only if
+// memory runs out again while putting them back may some be left out of the order.
+- (BOOL)moveRows:(NSIndexSet *)rowIndexes toRow:(NSUInteger)rowIndex;
+
+// Puts a data source row that isn't in the order back where compare, which must
+// describe the current order, says it goes. Returns the row it went to, or NSNotFound
+// if out of memory.
+- (NSUInteger)insertDataSourceRow:(NSUInteger)dataSourceRowIndex
+                  compareFunction:(MBTableGridPermutationCompareFunction)compare context:(void *)context;
+
+@end
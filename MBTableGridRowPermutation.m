@@ -0,0 +1,186 @@
+//
+//  MBTableGridRowPermutation.m
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#import "MBTableGridRowPermutation.h"
+
+@implementation MBTableGridRowPermutation
+
+- (instancetype)initWithDataSourceRows:(size_t *)dataSourceRows count:(NSUInteger)count {
+    if (self = [super init]) {
+        _permutation = MBTableGridPermutationCreate(dataSourceRows, count);
+        _lock = OS_UNFAIR_LOCK_INIT;
+    }
+    free(dataSourceRows);
+    if (_permutation == NULL)
+        return nil;
+    return self;
+}
+
+- (void)dealloc {
+    MBTableGridPermutationDestroy(_permutation);
+}
+
+- (NSUInteger)count {
+    os_unfair_lock_lock(&_lock);
+    NSUInteger count = MBTableGridPermutationCount(_permutation);
+    os_unfair_lock_unlock(&_lock);
+    return count;
+}
+
+- (NSUInteger)_dataSourceRowForRow:(NSUInteger)rowIndex {
+    if (rowIndex >= MBTableGridPermutationCount(_permutation))
+        return rowIndex;
+    return MBTableGridPermutationItemAtPosition(_permutation, rowIndex);
+}
+
+- (NSUInteger)_rowForDataSourceRow:(NSUInteger)dataSourceRowIndex {
+    size_t rowIndex = MBTableGridPermutationPositionOfItem(_permutation, dataSourceRowIndex);
+    return (rowIndex == MBTableGridPermutationNotFound) ? NSNotFound : rowIndex;
+}
+
+- (NSUInteger)dataSourceRowForRow:(NSUInteger)rowIndex {
+    os_unfair_lock_lock(&_lock);
+    NSUInteger dataSourceRowIndex = [self _dataSourceRowForRow:rowIndex];
+    os_unfair_lock_unlock(&_lock);
+    return dataSourceRowIndex;
+}
+
+- (NSUInteger)rowForDataSourceRow:(NSUInteger)dataSourceRowIndex {
+    os_unfair_lock_lock(&_lock);
+    NSUInteger rowIndex = [self _rowForDataSourceRow:dataSourceRowIndex];
+    os_unfair_lock_unlock(&_lock);
+    return rowIndex;
+}
+
+- (NSIndexSet *)dataSourceRowIndexesForRowIndexes:(NSIndexSet *)rowIndexes {
+    NSMutableIndexSet *dataSourceRowIndexes = [NSMutableIndexSet indexSet];
+    os_unfair_lock_lock(&_lock);
+    [rowIndexes enumerateIndexesUsingBlock:^(NSUInteger rowIndex, BOOL *stop) {
+        [dataSourceRowIndexes addIndex:[self _dataSourceRowForRow:rowIndex]];
+    }];
+    os_unfair_lock_unlock(&_lock);
+    return dataSourceRowIndexes;
+}
+
+- (NSIndexSet *)rowIndexesForDataSourceRowIndexes:(NSIndexSet *)dataSourceRowIndexes {
+    NSMutableIndexSet *rowIndexes = [NSMutableIndexSet indexSet];
+    os_unfair_lock_lock(&_lock);
+    [dataSourceRowIndexes enumerateIndexesUsingBlock:^(NSUInteger dataSourceRowIndex, BOOL *stop) {
+        NSUInteger rowIndex = [self _rowForDataSourceRow:dataSourceRowIndex];
+        if (rowIndex != NSNotFound)
+            [rowIndexes addIndex:rowIndex];
+    }];
+    os_unfair_lock_unlock(&_lock);
+    return rowIndexes;
+}
+
+- (void)getDataSourceRows:(size_t *)dataSourceRows inRows:(NSRange)rowRange {
+    os_unfair_lock_lock(&_lock);
+    MBTableGridPermutationGetItems(_permutation, rowRange.location, rowRange.length, dataSourceRows);
+    os_unfair_lock_unlock(&_lock);
+}
+
+// The rows are copied out first, so that the block runs without the lock, and so that
+// the runs all come from one order
+- (void)enumerateDataSourceRangesInRows:(NSRange)rowRange usingBlock:(void (^)(NSRange dataSourceRows, NSUInteger rowIndex, BOOL *stop))block {
+    size_t *dataSourceRows = malloc(MAX(rowRange.length, 1) * sizeof(size_t));
+    if (dataSourceRows == NULL) {
+        // Out of memory, so a row at a time
+        BOOL stop = NO;
+        for (NSUInteger rowIndex = rowRange.location; rowIndex < NSMaxRange(rowRange) && !stop; rowIndex++) {
+            block(NSMakeRange([self dataSourceRowForRow:rowIndex], 1), rowIndex, &stop);
+        }
+        return;
+    }
+    os_unfair_lock_lock(&_lock);
+    NSUInteger count = MBTableGridPermutationCount(_permutation);
+    NSUInteger permutedCount = (rowRange.location < count) ? MIN(rowRange.length, count - rowRange.location) : 0;
+    MBTableGridPermutationGetItems(_permutation, rowRange.location, permutedCount, dataSourceRows);
+    os_unfair_lock_unlock(&_lock);
+    for (NSUInteger i = permutedCount; i < rowRange.length; i++) {
+        dataSourceRows[i] = rowRange.location + i;
+    }
+
+    BOOL stop = NO;
+    NSUInteger i = 0;
+    while (i < rowRange.length && !stop) {
+        NSUInteger length = 1;
+        while (i + length < rowRange.length && dataSourceRows[i + length] == dataSourceRows[i] + length) {
+            length++;
+        }
+        block(NSMakeRange(dataSourceRows[i], length), rowRange.location + i, &stop);
+        i += length;
+    }
+    free(dataSourceRows);
+}
+
+- (NSUInteger)removeDataSourceRow:(NSUInteger)dataSourceRowIndex {
+    os_unfair_lock_lock(&_lock);
+    size_t rowIndex = MBTableGridPermutationPositionOfItem(_permutation, dataSourceRowIndex);
+    if (rowIndex != MBTableGridPermutationNotFound)
+        MBTableGridPermutationRemove(_permutation, rowIndex);
+    os_unfair_lock_unlock(&_lock);
+    return (rowIndex == MBTableGridPermutationNotFound) ? NSNotFound : rowIndex;
+}
+
+- (BOOL)appendDataSourceRows:(NSRange)dataSourceRowRange {
+    BOOL succeeded = YES;
+    os_unfair_lock_lock(&_lock);
+    for (NSUInteger dataSourceRowIndex = dataSourceRowRange.location; dataSourceRowIndex < NSMaxRange(dataSourceRowRange) && succeeded; dataSourceRowIndex++) {
+        succeeded = MBTableGridPermutationInsert(_permutation, MBTableGridPermutationCount(_permutation), dataSourceRowIndex);
+    }
+    os_unfair_lock_unlock(&_lock);
+    return succeeded;
+}
+
+// Each row costs a removal and an insertion, so moving k rows is O(k log n) plus a
+// block's worth of items each, however many rows there are. A failed insertion leaves
+// the permutation as it was, so the rows already put back are taken out again and each
+// goes back where it came from.
+- (BOOL)moveRows:(NSIndexSet *)rowIndexes toRow:(NSUInteger)rowIndex {
+    os_unfair_lock_lock(&_lock);
+    MBTableGridPermutation *permutation = _permutation;
+    NSUInteger count = MBTableGridPermutationCount(permutation);
+    NSUInteger movedCount = rowIndexes.count;
+    size_t *dataSourceRows = (movedCount > 0 && rowIndexes.lastIndex < count) ? malloc(movedCount * sizeof(size_t)) : NULL;
+    if (dataSourceRows == NULL) {
+        os_unfair_lock_unlock(&_lock);
+        return NO;
+    }
+    // From the last row up, so the rows before each are where they were
+    __block NSUInteger i = movedCount;
+    [rowIndexes enumerateIndexesWithOptions:NSEnumerationReverse usingBlock:^(NSUInteger movedRowIndex, BOOL *stop) {
+        dataSourceRows[--i] = MBTableGridPermutationRemove(permutation, movedRowIndex);
+    }];
+    NSUInteger position = MIN(rowIndex, count - movedCount);
+    BOOL succeeded = YES;
+    for (i = 0; i < movedCount && succeeded; i++) {
+        succeeded = MBTableGridPermutationInsert(permutation, position + i, dataSourceRows[i]);
+    }
+    if (!succeeded) {
+        for (i--; i > 0; i--) {
+            MBTableGridPermutationRemove(permutation, position + i - 1);
+        }
+        [rowIndexes enumerateIndexesUsingBlock:^(NSUInteger movedRowIndex, BOOL *stop) {
+            *stop = !MBTableGridPermutationInsert(permutation, movedRowIndex, dataSourceRows[i++]);
+        }];
+    }
+    os_unfair_lock_unlock(&_lock);
+    free(dataSourceRows);
+    return succeeded;
+}
+
+- (NSUInteger)insertDataSourceRow:(NSUInteger)dataSourceRowIndex
+                  compareFunction:(MBTableGridPermutationCompareFunction)compare context:(void *)context {
+    os_unfair_lock_lock(&_lock);
+    size_t rowIndex = MBTableGridPermutationSearch(_permutation, compare, context);
+    BOOL inserted = MBTableGridPermutationInsert(_permutation, rowIndex, dataSourceRowIndex);
+    os_unfair_lock_unlock(&_lock);
+    return inserted ? rowIndex : NSNotFound;
+}
+
+@end
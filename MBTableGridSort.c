@@ -0,0 +1,577 @@
+//
+//  MBTableGridSort.c
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#include "MBTableGridSort.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define MBSortMaximumFoldedLength 1024 // bytes of a string's text that decide its order
+#define MBSortStringMinimumCapacity 65536
+#define MBSortChunkLength 65536 // fewest rows handed to each parallel task
+#define MBSortMaximumChunkCount 64
+#define MBSortInsertionLength 32 // runs sorted by insertion before merging
+
+// Sort classes, in ascending order
+enum {
+    MBSortClassNumber,
+    MBSortClassString,
+    MBSortClassBoolean,
+    MBSortClassEmpty,
+    MBSortClassCount
+};
+
+struct MBTableGridSortKeys {
+    size_t rowCount;
+    unsigned char *types;
+    // Integer or double bits, a Boolean, or the first eight bytes of a string's key
+    uint64_t *numbers;
+    // Where each string's key lies in strings; allocated with the first string
+    size_t *offsets;
+    uint32_t *lengths;
+    char *strings;
+    size_t stringsLength;
+    size_t stringsCapacity;
+    size_t stringsUnused; // bytes of keys that have since been replaced
+};
+
+// A row being sorted, with the key it is sorted by, or the start of its string key
+typedef struct MBSortItem {
+    uint64_t key;
+    size_t row;
+} MBSortItem;
+
+MBTableGridSortKeys *MBTableGridSortKeysCreate(size_t rowCount) {
+    MBTableGridSortKeys *keys = calloc(1, sizeof(MBTableGridSortKeys));
+    if (keys == NULL)
+        return NULL;
+    keys->rowCount = rowCount;
+    keys->types = calloc(rowCount ? rowCount : 1, sizeof(unsigned char));
+    keys->numbers = calloc(rowCount ? rowCount : 1, sizeof(uint64_t));
+    if (keys->types == NULL || keys->numbers == NULL) {
+        MBTableGridSortKeysDestroy(keys);
+        return NULL;
+    }
+    return keys;
+}
+
+void MBTableGridSortKeysDestroy(MBTableGridSortKeys *keys) {
+    if (keys == NULL)
+        return;
+    free(keys->types);
+    free(keys->numbers);
+    free(keys->offsets);
+    free(keys->lengths);
+    free(keys->strings);
+    free(keys);
+}
+
+size_t MBTableGridSortKeysRowCount(const MBTableGridSortKeys *keys) {
+    return keys->rowCount;
+}
+
+bool MBTableGridSortKeysSetRowCount(MBTableGridSortKeys *keys, size_t rowCount) {
+    if (rowCount <= keys->rowCount) {
+        keys->rowCount = rowCount;
+        return true;
+    }
+    unsigned char *types = realloc(keys->types, rowCount * sizeof(unsigned char));
+    if (types)
+        keys->types = types;
+    uint64_t *numbers = realloc(keys->numbers, rowCount * sizeof(uint64_t));
+    if (numbers)
+        keys->numbers = numbers;
+    size_t *offsets = keys->offsets ? realloc(keys->offsets, rowCount * sizeof(size_t)) : NULL;
+    if (offsets)
+        keys->offsets = offsets;
+    uint32_t *lengths = keys->lengths ? realloc(keys->lengths, rowCount * sizeof(uint32_t)) : NULL;
+    if (lengths)
+        keys->lengths = lengths;
+    if (types == NULL || numbers == NULL || (keys->offsets && offsets == NULL) || (keys->lengths && lengths == NULL))
+        return false;
+    memset(keys->types + keys->rowCount, MBTableGridValueTypeEmpty, (rowCount - keys->rowCount) * sizeof(unsigned char));
+    memset(keys->numbers + keys->rowCount, 0, (rowCount - keys->rowCount) * sizeof(uint64_t));
+    keys->rowCount = rowCount;
+    return true;
+}
+
+bool MBTableGridSortKeysCanFoldString(const char *bytes, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        if ((unsigned char)bytes[i] >= 0x80)
+            return false;
+    }
+    return true;
+}
+
+// Moves the string keys still in use to the start of a new buffer, once most of the
+// old one is keys that have been replaced
+static void MBCompactStrings(MBTableGridSortKeys *keys) {
+    if (keys->stringsUnused < keys->stringsLength / 2 || keys->stringsLength < MBSortStringMinimumCapacity)
+        return;
+    size_t used = keys->stringsLength - keys->stringsUnused;
+    size_t capacity = 2 * used > MBSortStringMinimumCapacity ? 2 * used : MBSortStringMinimumCapacity;
+    char *strings = malloc(capacity);
+    if (strings == NULL)
+        return;
+    size_t length = 0;
+    for (size_t row = 0; row < keys->rowCount; row++) {
+        if (keys->types[row] != MBTableGridValueTypeString)
+            continue;
+        memcpy(strings + length, keys->strings + keys->offsets[row], keys->lengths[row]);
+        keys->offsets[row] = length;
+        length += keys->lengths[row];
+    }
+    free(keys->strings);
+    keys->strings = strings;
+    keys->stringsLength = length;
+    keys->stringsCapacity = capacity;
+    keys->stringsUnused = 0;
+}
+
+// Makes room for a string key of length bytes and returns where it goes
+static char *MBReserveString(MBTableGridSortKeys *keys, size_t rowIndex, size_t length) {
+    if (keys->offsets == NULL)
+        keys->offsets = calloc(keys->rowCount, sizeof(size_t));
+    if (keys->lengths == NULL)
+        keys->lengths = calloc(keys->rowCount, sizeof(uint32_t));
+    if (keys->offsets == NULL || keys->lengths == NULL)
+        return NULL;
+    if (keys->types[rowIndex] == MBTableGridValueTypeString) {
+        keys->types[rowIndex] = MBTableGridValueTypeEmpty;
+        keys->stringsUnused += keys->lengths[rowIndex];
+        MBCompactStrings(keys);
+    }
+    if (keys->stringsCapacity - keys->stringsLength < length) {
+        size_t capacity = keys->stringsCapacity ? keys->stringsCapacity : MBSortStringMinimumCapacity;
+        while (capacity - keys->stringsLength < length)
+            capacity *= 2;
+        char *strings = realloc(keys->strings, capacity);
+        if (strings == NULL)
+            return NULL;
+        keys->strings = strings;
+        keys->stringsCapacity = capacity;
+    }
+    keys->types[rowIndex] = MBTableGridValueTypeString;
+    keys->offsets[rowIndex] = keys->stringsLength;
+    keys->lengths[rowIndex] = (uint32_t)length;
+    keys->stringsLength += length;
+    return keys->strings + keys->offsets[rowIndex];
+}
+
+// Reads up to eight bytes as a big-endian number, so that numbers compare like the bytes
+static uint64_t MBStringPrefix(const char *bytes, size_t length) {
+    uint64_t prefix = 0;
+    for (size_t i = 0; i < 8; i++)
+        prefix = (prefix << 8) | (i < length ? (unsigned char)bytes[i] : 0);
+    return prefix;
+}
+
+bool MBTableGridSortKeysSetString(MBTableGridSortKeys *keys, size_t rowIndex, const char *folded, size_t foldedLength,
+                                  const char *bytes, size_t length) {
+    foldedLength = foldedLength < MBSortMaximumFoldedLength ? foldedLength : MBSortMaximumFoldedLength;
+    length = length < MBSortMaximumFoldedLength ? length : MBSortMaximumFoldedLength;
+    char *key = MBReserveString(keys, rowIndex, foldedLength + 1 + length);
+    if (key == NULL)
+        return false;
+    memcpy(key, folded, foldedLength);
+    key[foldedLength] = '\0';
+    memcpy(key + foldedLength + 1, bytes, length);
+    keys->numbers[rowIndex] = MBStringPrefix(key, foldedLength + 1 + length);
+    return true;
+}
+
+bool MBTableGridSortKeysSetValue(MBTableGridSortKeys *keys, size_t rowIndex, const MBTableGridValue *value) {
+    unsigned char type = (unsigned char)value->type;
+    uint64_t number = 0;
+    switch (value->type) {
+        case MBTableGridValueTypeInteger:
+            number = (uint64_t)value->data.integer;
+            break;
+        case MBTableGridValueTypeDouble:
+        case MBTableGridValueTypeDate:
+            memcpy(&number, &value->data.number, sizeof(number));
+            break;
+        case MBTableGridValueTypeBoolean:
+            number = value->data.boolean ? 1 : 0;
+            break;
+        case MBTableGridValueTypeString: {
+            size_t length = value->data.string.length;
+            length = length < MBSortMaximumFoldedLength ? length : MBSortMaximumFoldedLength;
+            char *key = MBReserveString(keys, rowIndex, 2 * length + 1);
+            if (key == NULL)
+                return false;
+            for (size_t i = 0; i < length; i++) {
+                char c = value->data.string.bytes[i];
+                key[i] = (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+            }
+            key[length] = '\0';
+            memcpy(key + length + 1, value->data.string.bytes, length);
+            keys->numbers[rowIndex] = MBStringPrefix(key, 2 * length + 1);
+            return true;
+        }
+        default:
+            type = MBTableGridValueTypeEmpty;
+            break;
+    }
+    // A string key this replaces stays in the buffer until it is compacted
+    if (keys->types[rowIndex] == MBTableGridValueTypeString)
+        keys->stringsUnused += keys->lengths[rowIndex];
+    keys->types[rowIndex] = type;
+    keys->numbers[rowIndex] = number;
+    return true;
+}
+
+static inline int MBSortClass(unsigned char type) {
+    switch (type) {
+        case MBTableGridValueTypeInteger:
+        case MBTableGridValueTypeDouble:
+        case MBTableGridValueTypeDate:
+            return MBSortClassNumber;
+        case MBTableGridValueTypeString:
+            return MBSortClassString;
+        case MBTableGridValueTypeBoolean:
+            return MBSortClassBoolean;
+        default:
+            return MBSortClassEmpty;
+    }
+}
+
+// Descending sorts reverse the classes but still put empty cells last
+static inline int MBSortClassOrder(int sortClass, bool ascending) {
+    static const int descendingOrder[MBSortClassCount] = { 2, 1, 0, 3 };
+    return ascending ? sortClass : descendingOrder[sortClass];
+}
+
+static inline uint64_t MBIntegerKey(uint64_t bits) {
+    return bits ^ (UINT64_C(1) << 63);
+}
+
+// Flips the sign bit of positive numbers and every bit of negative ones, so that
+// the bits compare in numeric order. NaNs go after everything.
+static inline uint64_t MBDoubleKey(double number) {
+    if (number != number)
+        return UINT64_MAX;
+    if (number == 0.0)
+        number = 0.0;
+    uint64_t bits;
+    memcpy(&bits, &number, sizeof(bits));
+    return (bits >> 63) ? ~bits : bits | (UINT64_C(1) << 63);
+}
+
+// NaNs stay after every other number when sorting descending, as empty cells do
+static inline bool MBIsNaN(const MBTableGridSortKeys *keys, size_t rowIndex) {
+    if (keys->types[rowIndex] == MBTableGridValueTypeInteger)
+        return false;
+    double number;
+    memcpy(&number, &keys->numbers[rowIndex], sizeof(number));
+    return number != number;
+}
+
+static inline uint64_t MBNumberKey(const MBTableGridSortKeys *keys, size_t rowIndex, bool integersAsDoubles) {
+    uint64_t bits = keys->numbers[rowIndex];
+    if (keys->types[rowIndex] != MBTableGridValueTypeInteger) {
+        double number;
+        memcpy(&number, &bits, sizeof(number));
+        return MBDoubleKey(number);
+    }
+    if (integersAsDoubles)
+        return MBDoubleKey((double)(int64_t)bits);
+    return MBIntegerKey(bits);
+}
+
+static void MBApply(MBTableGridSortApplyFunction apply, size_t iterations, void *context, MBTableGridSortWorkFunction work) {
+    if (apply && iterations > 1) {
+        apply(iterations, context, work);
+    } else {
+        for (size_t i = 0; i < iterations; i++)
+            work(context, i);
+    }
+}
+
+static size_t MBChunkCount(size_t count) {
+    size_t chunkCount = count / MBSortChunkLength;
+    if (chunkCount > MBSortMaximumChunkCount)
+        chunkCount = MBSortMaximumChunkCount;
+    return chunkCount ? chunkCount : 1;
+}
+
+typedef struct MBRadixContext {
+    MBSortItem *items;
+    MBSortItem *scratch;
+    size_t count;
+    size_t chunkLength;
+    size_t *histograms; // 256 counts, and then offsets, for each chunk
+    uint64_t *differences; // bits that differ from the first key, for each chunk
+    unsigned shift;
+} MBRadixContext;
+
+static void MBRadixDifferences(void *context, size_t chunk) {
+    MBRadixContext *radix = context;
+    size_t start = chunk * radix->chunkLength;
+    size_t end = start + radix->chunkLength < radix->count ? start + radix->chunkLength : radix->count;
+    uint64_t first = radix->items[0].key, differences = 0;
+    for (size_t i = start; i < end; i++)
+        differences |= radix->items[i].key ^ first;
+    radix->differences[chunk] = differences;
+}
+
+static void MBRadixCount(void *context, size_t chunk) {
+    MBRadixContext *radix = context;
+    size_t *histogram = radix->histograms + 256 * chunk;
+    size_t start = chunk * radix->chunkLength;
+    size_t end = start + radix->chunkLength < radix->count ? start + radix->chunkLength : radix->count;
+    memset(histogram, 0, 256 * sizeof(size_t));
+    for (size_t i = start; i < end; i++)
+        histogram[(radix->items[i].key >> radix->shift) & 0xFF]++;
+}
+
+static void MBRadixScatter(void *context, size_t chunk) {
+    MBRadixContext *radix = context;
+    size_t *offsets = radix->histograms + 256 * chunk;
+    size_t start = chunk * radix->chunkLength;
+    size_t end = start + radix->chunkLength < radix->count ? start + radix->chunkLength : radix->count;
+    for (size_t i = start; i < end; i++)
+        radix->scratch[offsets[(radix->items[i].key >> radix->shift) & 0xFF]++] = radix->items[i];
+}
+
+// Sorts items by key a byte at a time from the lowest, each chunk of items
+// counted and then scattered in parallel. Leaves the result in items.
+static bool MBRadixSort(MBSortItem *items, MBSortItem *scratch, size_t count, MBTableGridSortApplyFunction apply) {
+    if (count < 2)
+        return true;
+    size_t chunkCount = MBChunkCount(count);
+    MBRadixContext radix = {
+        .items = items,
+        .scratch = scratch,
+        .count = count,
+        .chunkLength = (count + chunkCount - 1) / chunkCount,
+        .histograms = malloc(256 * chunkCount * sizeof(size_t)),
+        .differences = malloc(chunkCount * sizeof(uint64_t)),
+    };
+    if (radix.histograms == NULL || radix.differences == NULL) {
+        free(radix.histograms);
+        free(radix.differences);
+        return false;
+    }
+
+    // Bytes every key shares needn't be sorted by
+    MBApply(apply, chunkCount, &radix, MBRadixDifferences);
+    uint64_t differences = 0;
+    for (size_t chunk = 0; chunk < chunkCount; chunk++)
+        differences |= radix.differences[chunk];
+
+    for (radix.shift = 0; radix.shift < 64; radix.shift += 8) {
+        if (((differences >> radix.shift) & 0xFF) == 0)
+            continue;
+        MBApply(apply, chunkCount, &radix, MBRadixCount);
+        size_t offset = 0;
+        for (size_t digit = 0; digit < 256; digit++) {
+            for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+                size_t digitCount = radix.histograms[256 * chunk + digit];
+                radix.histograms[256 * chunk + digit] = offset;
+                offset += digitCount;
+            }
+        }
+        MBApply(apply, chunkCount, &radix, MBRadixScatter);
+        MBSortItem *sorted = radix.scratch;
+        radix.scratch = radix.items;
+        radix.items = sorted;
+    }
+    if (radix.items != items)
+        memcpy(items, radix.items, count * sizeof(MBSortItem));
+
+    free(radix.histograms);
+    free(radix.differences);
+    return true;
+}
+
+typedef struct MBMergeContext {
+    const MBTableGridSortKeys *keys;
+    bool ascending;
+    MBSortItem *items;
+    MBSortItem *scratch;
+    size_t count;
+    size_t width; // the length of the runs being merged, or of the chunks being sorted
+} MBMergeContext;
+
+static inline int MBCompareStrings(const MBMergeContext *merge, const MBSortItem *a, const MBSortItem *b) {
+    int result = 0;
+    if (a->key != b->key) {
+        result = (a->key < b->key) ? -1 : 1;
+    } else {
+        // The prefixes are equal, so whichever key is shorter than eight bytes is a prefix of the other
+        const MBTableGridSortKeys *keys = merge->keys;
+        uint32_t aLength = keys->lengths[a->row], bLength = keys->lengths[b->row];
+        if (aLength > 8 && bLength > 8)
+            result = memcmp(keys->strings + keys->offsets[a->row] + 8, keys->strings + keys->offsets[b->row] + 8,
+                            (aLength < bLength ? aLength : bLength) - 8);
+        if (result == 0)
+            result = (aLength > bLength) - (aLength < bLength);
+    }
+    return merge->ascending ? result : -result;
+}
+
+// Takes from the left on ties, which keeps the merge stable
+static void MBMerge(const MBMergeContext *merge, const MBSortItem *left, size_t leftCount, const MBSortItem *right, size_t rightCount,
+                    MBSortItem *output) {
+    size_t i = 0, j = 0;
+    while (i < leftCount && j < rightCount) {
+        if (MBCompareStrings(merge, &right[j], &left[i]) < 0)
+            *output++ = right[j++];
+        else
+            *output++ = left[i++];
+    }
+    memcpy(output, left + i, (leftCount - i) * sizeof(MBSortItem));
+    memcpy(output + (leftCount - i), right + j, (rightCount - j) * sizeof(MBSortItem));
+}
+
+static void MBMergeSortChunk(void *context, size_t chunk) {
+    const MBMergeContext *merge = context;
+    size_t start = chunk * merge->width;
+    size_t count = (start + merge->width < merge->count ? start + merge->width : merge->count) - start;
+    MBSortItem *source = merge->items + start, *destination = merge->scratch + start;
+
+    for (size_t run = 0; run < count; run += MBSortInsertionLength) {
+        size_t runEnd = run + MBSortInsertionLength < count ? run + MBSortInsertionLength : count;
+        for (size_t i = run + 1; i < runEnd; i++) {
+            MBSortItem item = source[i];
+            size_t j = i;
+            while (j > run && MBCompareStrings(merge, &item, &source[j - 1]) < 0) {
+                source[j] = source[j - 1];
+                j--;
+            }
+            source[j] = item;
+        }
+    }
+    for (size_t width = MBSortInsertionLength; width < count; width *= 2) {
+        for (size_t left = 0; left < count; left += 2 * width) {
+            size_t middle = left + width < count ? left + width : count;
+            size_t right = middle + width < count ? middle + width : count;
+            MBMerge(merge, source + left, middle - left, source + middle, right - middle, destination + left);
+        }
+        MBSortItem *sorted = destination;
+        destination = source;
+        source = sorted;
+    }
+    if (source != merge->items + start)
+        memcpy(merge->items + start, source, count * sizeof(MBSortItem));
+}
+
+static void MBMergePair(void *context, size_t pair) {
+    const MBMergeContext *merge = context;
+    size_t left = 2 * pair * merge->width;
+    size_t middle = left + merge->width < merge->count ? left + merge->width : merge->count;
+    size_t right = middle + merge->width < merge->count ? middle + merge->width : merge->count;
+    MBMerge(merge, merge->items + left, middle - left, merge->items + middle, right - middle, merge->scratch + left);
+}
+
+// Sorts chunks of items in parallel, then merges pairs of runs in parallel until
+// one is left. Leaves the result in items.
+static void MBMergeSort(const MBTableGridSortKeys *keys, bool ascending, MBSortItem *items, MBSortItem *scratch, size_t count,
+                        MBTableGridSortApplyFunction apply) {
+    if (count < 2)
+        return;
+    size_t chunkCount = MBChunkCount(count);
+    MBMergeContext merge = {
+        .keys = keys,
+        .ascending = ascending,
+        .items = items,
+        .scratch = scratch,
+        .count = count,
+        .width = (count + chunkCount - 1) / chunkCount,
+    };
+    MBApply(apply, chunkCount, &merge, MBMergeSortChunk);
+
+    for (; merge.width < count; merge.width *= 2) {
+        MBApply(apply, (count + 2 * merge.width - 1) / (2 * merge.width), &merge, MBMergePair);
+        MBSortItem *sorted = merge.scratch;
+        merge.scratch = merge.items;
+        merge.items = sorted;
+    }
+    if (merge.items != items)
+        memcpy(items, merge.items, count * sizeof(MBSortItem));
+}
+
+bool MBTableGridSortKeysSort(const MBTableGridSortKeys *keys, bool ascending, size_t *rows, MBTableGridSortApplyFunction apply) {
+    size_t rowCount = keys->rowCount;
+    MBSortItem *items = malloc((rowCount ? rowCount : 1) * sizeof(MBSortItem));
+    MBSortItem *scratch = malloc((rowCount ? rowCount : 1) * sizeof(MBSortItem));
+    if (items == NULL || scratch == NULL) {
+        free(items);
+        free(scratch);
+        return false;
+    }
+
+    size_t classCounts[MBSortClassCount] = { 0 };
+    bool hasIntegers = false, hasDoubles = false;
+    for (size_t row = 0; row < rowCount; row++) {
+        unsigned char type = keys->types[row];
+        classCounts[MBSortClass(type)]++;
+        hasIntegers |= (type == MBTableGridValueTypeInteger);
+        hasDoubles |= (type == MBTableGridValueTypeDouble || type == MBTableGridValueTypeDate);
+    }
+    size_t classStarts[MBSortClassCount], position = 0;
+    for (int order = 0; order < MBSortClassCount; order++) {
+        for (int sortClass = 0; sortClass < MBSortClassCount; sortClass++) {
+            if (MBSortClassOrder(sortClass, ascending) == order) {
+                classStarts[sortClass] = position;
+                position += classCounts[sortClass];
+            }
+        }
+    }
+
+    // Numbers and Booleans are complemented to sort descending, which keeps equal keys in
+    // order; NaNs aren't, so that they stay last
+    bool integersAsDoubles = hasIntegers && hasDoubles;
+    size_t classPositions[MBSortClassCount];
+    memcpy(classPositions, classStarts, sizeof(classPositions));
+    for (size_t i = 0; i < rowCount; i++) {
+        size_t row = rows[i];
+        int sortClass = MBSortClass(keys->types[row]);
+        uint64_t key = keys->numbers[row];
+        if (sortClass == MBSortClassNumber)
+            key = MBNumberKey(keys, row, integersAsDoubles);
+        if (!ascending && (sortClass == MBSortClassBoolean || (sortClass == MBSortClassNumber && !MBIsNaN(keys, row))))
+            key = ~key;
+        items[classPositions[sortClass]++] = (MBSortItem){ key, row };
+    }
+
+    bool succeeded = MBRadixSort(items + classStarts[MBSortClassNumber], scratch, classCounts[MBSortClassNumber], apply) &&
+                     MBRadixSort(items + classStarts[MBSortClassBoolean], scratch, classCounts[MBSortClassBoolean], apply);
+    if (succeeded) {
+        MBMergeSort(keys, ascending, items + classStarts[MBSortClassString], scratch, classCounts[MBSortClassString], apply);
+        for (size_t i = 0; i < rowCount; i++)
+            rows[i] = items[i].row;
+    }
+    free(items);
+    free(scratch);
+    return succeeded;
+}
+
+int MBTableGridSortKeysCompare(const MBTableGridSortKeys *keys, bool ascending, size_t rowA, size_t rowB) {
+    unsigned char typeA = keys->types[rowA], typeB = keys->types[rowB];
+    int classA = MBSortClass(typeA), classB = MBSortClass(typeB);
+    if (classA != classB)
+        return MBSortClassOrder(classA, ascending) < MBSortClassOrder(classB, ascending) ? -1 : 1;
+
+    int result = 0;
+    if (classA == MBSortClassString) {
+        MBMergeContext merge = { .keys = keys, .ascending = ascending };
+        MBSortItem a = { keys->numbers[rowA], rowA }, b = { keys->numbers[rowB], rowB };
+        return MBCompareStrings(&merge, &a, &b);
+    } else if (classA == MBSortClassNumber) {
+        bool isNaNA = MBIsNaN(keys, rowA), isNaNB = MBIsNaN(keys, rowB);
+        if (isNaNA || isNaNB)
+            return (int)isNaNA - (int)isNaNB;
+        bool integers = (typeA == MBTableGridValueTypeInteger && typeB == MBTableGridValueTypeInteger);
+        uint64_t a = MBNumberKey(keys, rowA, !integers), b = MBNumberKey(keys, rowB, !integers);
+        result = (a > b) - (a < b);
+    } else if (classA == MBSortClassBoolean) {
+        result = (keys->numbers[rowA] > keys->numbers[rowB]) - (keys->numbers[rowA] < keys->numbers[rowB]);
+    }
+    return ascending ? result : -result;
+}
@@ -0,0 +1,155 @@
+//
+//  MBTableGridSort.h
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#ifndef MBTableGridSort_h
+#define MBTableGridSort_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "MBTableGridValue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief		\c MBTableGridSortKeys holds a sort key for each row of a
+ *				column, from which the order of the rows can be computed
+ *				without touching the data source again.
+ *
+ * @details		Numbers, dates and Booleans are kept as 64-bit keys that
+ *				compare as unsigned integers in the order of their values,
+ *				and are sorted with a least-significant-digit radix sort,
+ *				skipping the digits every key shares. Strings are kept as
+ *				collation keys: the case-folded text, a zero byte, and the
+ *				text itself, so that strings differing only in case sort
+ *				together but in a fixed order. They are compared as bytes,
+ *				with the first eight bytes of each carried along with its
+ *				row, and sorted with a merge sort.
+ *
+ *				Both sorts are stable, so rows with equal keys keep their
+ *				order. Numbers and dates sort before strings and strings
+ *				before Booleans; descending sorts reverse that, but empty
+ *				cells always come last, and NaNs always come after the
+ *				other numbers.
+ *
+ *				The keys are plain C so that they can be built and measured
+ *				away from AppKit. Setting keys is not thread-safe, but once
+ *				set, keys may be sorted from any number of threads.
+ */
+typedef struct MBTableGridSortKeys MBTableGridSortKeys;
+
+/**
+ * @brief		Does one iteration of a parallel loop.
+ */
+typedef void (*MBTableGridSortWorkFunction)(void *context, size_t iteration);
+
+/**
+ * @brief		Runs \c work for every iteration from \c 0 up to
+ *				\c iterations, in any order and possibly at once, and
+ *				returns when they have all finished. It has the shape of
+ *				\c dispatch_apply_f without the queue.
+ */
+typedef void (*MBTableGridSortApplyFunction)(size_t iterations, void *context, MBTableGridSortWorkFunction work);
+
+/**
+ * @brief		Creates keys for \c rowCount rows, all empty. Returns
+ *				\c NULL if out of memory.
+ */
+MBTableGridSortKeys *MBTableGridSortKeysCreate(size_t rowCount);
+
+/**
+ * @brief		Frees keys created with \c MBTableGridSortKeysCreate.
+ */
+void MBTableGridSortKeysDestroy(MBTableGridSortKeys *keys);
+
+/**
+ * @brief		Returns the number of rows the keys were created for.
+ */
+size_t MBTableGridSortKeysRowCount(const MBTableGridSortKeys *keys);
+
+/**
+ * @brief		Changes the number of rows, keeping the keys of the rows
+ *				that remain. Rows added are empty.
+ *
+ * @return		\c false if out of memory, in which case the keys are
+ *				unchanged.
+ */
+bool MBTableGridSortKeysSetRowCount(MBTableGridSortKeys *keys, size_t rowCount);
+
+/**
+ * @brief		Sets a row's key from its value. Pending values sort as
+ *				empty.
+ *
+ * @details		A string's text is folded to lower case a byte at a time,
+ *				which only folds ASCII letters; use
+ *				\c MBTableGridSortKeysSetString for other text.
+ *
+ * @return		\c false if out of memory.
+ */
+bool MBTableGridSortKeysSetValue(MBTableGridSortKeys *keys, size_t rowIndex, const MBTableGridValue *value);
+
+/**
+ * @brief		Sets a row's key to a string whose folded text has been
+ *				worked out by the caller, e.g. ignoring case and
+ *				diacritics in the user's locale.
+ *
+ * @param		folded			The UTF-8 text to sort the string by.
+ * @param		foldedLength	The byte count of \c folded.
+ * @param		bytes			The UTF-8 string itself, which orders
+ *								strings with the same folded text.
+ * @param		length			The byte count of \c bytes.
+ *
+ * @return		\c false if out of memory.
+ */
+bool MBTableGridSortKeysSetString(MBTableGridSortKeys *keys, size_t rowIndex, const char *folded, size_t foldedLength,
+                                  const char *bytes, size_t length);
+
+/**
+ * @brief		Returns whether \c MBTableGridSortKeysSetValue folds a
+ *				string fully by itself, which it does for ASCII text.
+ */
+bool MBTableGridSortKeysCanFoldString(const char *bytes, size_t length);
+
+/**
+ * @brief		Sorts the rows by their keys.
+ *
+ * @details		The sort is stable, so sorting by one column's keys after
+ *				another's orders rows by the last column first and then by
+ *				the ones before.
+ *
+ * @param		ascending	Whether to sort from the smallest value.
+ * @param		rows		Holds every row index once, in the order to
+ *							sort from, and receives them in sorted order.
+ * @param		apply		Runs the parallel parts of the sort, or
+ *							\c NULL to run everything on this thread.
+ *
+ * @return		\c false if out of memory, in which case \c rows is left
+ *				unchanged.
+ */
+bool MBTableGridSortKeysSort(const MBTableGridSortKeys *keys, bool ascending, size_t *rows, MBTableGridSortApplyFunction apply);
+
+/**
+ * @brief		Compares two rows' keys in the order
+ *				\c MBTableGridSortKeysSort sorts them in.
+ *
+ * @details		Integers compare as integers with each other and as
+ *				doubles with anything else, so that a row can be compared
+ *				without knowing what the rest of the column holds.
+ *
+ * @return		A negative number if \c rowA sorts first, a positive
+ *				number if \c rowB does, and zero if they are equal.
+ */
+int MBTableGridSortKeysCompare(const MBTableGridSortKeys *keys, bool ascending, size_t rowA, size_t rowB);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MBTableGridSort_h */
@@ -6,15 +6,28 @@
 //
 
 #import <Cocoa/Cocoa.h>
+#import "MBTableGridEditList.h"
 
 @class MBTableGrid;
+@class MBTableGridVirtualString;
 
 @interface MBTableGridTextFinderClient : NSObject<NSTextFinderClient> {
     __weak MBTableGrid *_tableGrid;
     
-    NSMutableDictionary<NSNumber *, NSDictionary<NSString *, id> *> *_pending_replacements;
+    // Kept for as long as the cells keep their numbers, along with what it has found
+    MBTableGridVirtualString *_string;
+    
+    // Replacements collected until NSTextFinder is done, as runs of cells whose values
+    // index into the replacement strings
+    MBTableGridEditList *_pendingEdits;
+    NSMutableArray<NSString *> *_replacementStrings;
 }
 
 - (instancetype)initWithTableGrid:(MBTableGrid *)tableGrid;
 
+// Called by the grid when cells change value, and when they're renumbered by a reload
+// or a move, so that matches found earlier aren't reported for the wrong cells
+- (void)noteCellsDidChangeInColumns:(NSIndexSet *)columnIndexes rows:(NSIndexSet *)rowIndexes;
+- (void)noteCellNumbersDidChange;
+
 @end
@@ -18,9 +18,58 @@ typedef struct __attribute__((objc_boxable)) _NSRange NSRange;
 - (void)_setObjectValue:(id)value forColumn:(NSUInteger)columnIndex row:(NSUInteger)rowIndex;
 - (void)_setObjectValue:(id)value forColumns:(NSIndexSet *)columnIndexes rows:(NSIndexSet *)rowIndexes;
 - (BOOL)_canEditCellAtColumn:(NSUInteger)columnIndex row:(NSUInteger)rowIndex;
+- (BOOL)_canEditCellsInColumns:(NSIndexSet *)columnIndexes rows:(NSIndexSet *)rowIndexes;
+- (void)_noteFindClientStringWillChange;
 - (void)scrollToArea:(NSRect)area animate:(BOOL)animate;
 @end
 
+// Splits runs of cells, sorted in column-first order, into rectangular blocks: the rows
+// of one column that take one value, joined with the columns after it while they have
+// the same rows and value, so that whole-column runs become a single block
+static void MBEnumerateEditBlocks(const MBTableGridEditRun *runs, size_t count, NSUInteger rowCount,
+                                  void (^block)(NSIndexSet *columnIndexes, NSIndexSet *rowIndexes, uint32_t value, BOOL *stop)) {
+    NSMutableIndexSet *blockColumns = [NSMutableIndexSet indexSet];
+    __block NSMutableIndexSet *blockRows = nil, *rows = nil;
+    __block uint32_t blockValue = 0, value = 0;
+    __block NSUInteger column = NSNotFound;
+    __block BOOL stop = NO;
+
+    // Called once the rows of a column for a value are complete
+    void (^finishColumn)(void) = ^{
+        if (blockColumns.count && blockValue == value && blockColumns.lastIndex + 1 == column && [blockRows isEqualToIndexSet:rows]) {
+            [blockColumns addIndex:column];
+            return;
+        }
+        if (blockColumns.count)
+            block(blockColumns, blockRows, blockValue, &stop);
+        [blockColumns removeAllIndexes];
+        [blockColumns addIndex:column];
+        blockRows = rows;
+        blockValue = value;
+    };
+
+    for (size_t i = 0; i < count && !stop; i++) {
+        uint64_t location = runs[i].location, end = location + runs[i].length;
+        while (location < end && !stop) {
+            NSUInteger runColumn = (NSUInteger)(location / rowCount), row = (NSUInteger)(location % rowCount);
+            NSUInteger length = (NSUInteger)MIN(end - location, rowCount - row);
+            if (runColumn != column || runs[i].value != value) {
+                if (rows)
+                    finishColumn();
+                column = runColumn;
+                value = runs[i].value;
+                rows = [NSMutableIndexSet indexSet];
+            }
+            [rows addIndexesInRange:NSMakeRange(row, length)];
+            location += length;
+        }
+    }
+    if (rows && !stop)
+        finishColumn();
+    if (blockColumns.count && !stop)
+        block(blockColumns, blockRows, blockValue, &stop);
+}
+
 @implementation MBTableGridTextFinderClient
 
 // Pros and cons of string vs stringAtIndex:effectiveRange:endsWithSearchBoundary
@@ -36,13 +85,28 @@ typedef struct __attribute__((objc_boxable)) _NSRange NSRange;
 - (instancetype)initWithTableGrid:(MBTableGrid *)tableGrid {
     if (self = [super init]) {
         _tableGrid = tableGrid;
-        _pending_replacements = [[NSMutableDictionary alloc] init];
+        _pendingEdits = MBTableGridEditListCreate();
+        _replacementStrings = [NSMutableArray array];
     }
     return self;
 }
 
+- (void)dealloc {
+    MBTableGridEditListDestroy(_pendingEdits);
+}
+
 - (NSString *)string {
-    return [[MBTableGridVirtualString alloc] initWithTableGrid:_tableGrid];
+    if (_string == nil)
+        _string = [[MBTableGridVirtualString alloc] initWithTableGrid:_tableGrid];
+    return _string;
+}
+
+- (void)noteCellsDidChangeInColumns:(NSIndexSet *)columnIndexes rows:(NSIndexSet *)rowIndexes {
+    [_string forgetCellsInColumns:columnIndexes rows:rowIndexes];
+}
+
+- (void)noteCellNumbersDidChange {
+    _string = nil;
 }
 
 - (NSRange)firstSelectedRange {
@@ -172,39 +236,37 @@ typedef struct __attribute__((objc_boxable)) _NSRange NSRange;
     [cell drawInteriorWithFrame:cellFrame inView:view];
 }
 
+// Checks permission a block of cells at a time, rather than asking about every match
 - (BOOL)shouldReplaceCharactersInRanges:(NSArray<NSValue *> *)ranges withStrings:(NSArray<NSString *> *)strings {
-    NSUInteger columnCount = _tableGrid.numberOfColumns;
     NSUInteger rowCount = _tableGrid.numberOfRows;
+    MBTableGridEditList *cells = MBTableGridEditListCreate();
+    __block BOOL canEdit = (cells != NULL);
+
     for (NSValue *rangeValue in ranges) {
         NSRange range = rangeValue.rangeValue;
-        NSUInteger cellIndex = range.location;
-        if (range.location == NSNotFound)
+        if (range.location == NSNotFound || !canEdit)
             continue;
-        while (cellIndex < range.location + range.length) {
-            NSUInteger rowIndex = _row(cellIndex, rowCount, columnCount);
-            NSUInteger filteredIndex = _col(cellIndex, rowCount, columnCount);
-            if (![_tableGrid _canEditCellAtColumn:filteredIndex row:rowIndex])
-                return NO;
-
-            cellIndex++;
-        }
+        canEdit = MBTableGridEditListAppend(cells, range.location, range.length, 0);
+    }
+    if (canEdit && rowCount) {
+        size_t count = 0;
+        const MBTableGridEditRun *runs = MBTableGridEditListGetRuns(cells, &count);
+        MBEnumerateEditBlocks(runs, count, rowCount, ^(NSIndexSet *columnIndexes, NSIndexSet *rowIndexes, uint32_t value, BOOL *stop) {
+            if (![_tableGrid _canEditCellsInColumns:columnIndexes rows:rowIndexes])
+                canEdit = NO, *stop = YES;
+        });
     }
-    return YES;
+    MBTableGridEditListDestroy(cells);
+    return canEdit;
 }
 
+// Replace All calls this once per match, in order, so runs of matches share an entry
 - (void)replaceCharactersInRange:(NSRange)range withString:(NSString *)string {
-    NSUInteger columnCount = _tableGrid.numberOfColumns;
-    NSUInteger rowCount = _tableGrid.numberOfRows;
-    
-    NSUInteger cellIndex = range.location;
-    NSUInteger rowIndex = _row(cellIndex, rowCount, columnCount);
-    NSUInteger columnIndex = _col(cellIndex, rowCount, columnCount);
+    NSString *lastString = _replacementStrings.lastObject;
+    if (lastString == nil || (string != lastString && ![string isEqualToString:lastString]))
+        [_replacementStrings addObject:[string copy]];
 
-    if (!_pending_replacements[@(columnIndex)]) {
-        _pending_replacements[@(columnIndex)] = @{ @"string": string, @"indexes": [NSMutableIndexSet indexSet] };
-    }
-    
-    [(NSMutableIndexSet *)_pending_replacements[@(columnIndex)][@"indexes"] addIndex:rowIndex];
+    MBTableGridEditListAppend(_pendingEdits, range.location, range.length, (uint32_t)(_replacementStrings.count - 1));
 }
 
 - (BOOL)isEditable {
@@ -212,16 +274,25 @@ typedef struct __attribute__((objc_boxable)) _NSRange NSRange;
             [_tableGrid.dataSource respondsToSelector:@selector(tableGrid:setObjectValue:forColumns:rows:)]);
 }
 
+// Writes each block with a single call to the data source, and redraws only those
+// cells, since the grid's shape hasn't changed
 - (void)didReplaceCharacters {
-    [_pending_replacements enumerateKeysAndObjectsUsingBlock:^(NSNumber *key, NSDictionary<NSString *, id> *replacement, BOOL *stop) {
-        [_tableGrid _setObjectValue:replacement[@"string"]
-                         forColumns:[NSIndexSet indexSetWithIndex:key.integerValue]
-                               rows:replacement[@"indexes"]];
-    }];
+    NSUInteger rowCount = _tableGrid.numberOfRows;
+    NSArray<NSString *> *strings = _replacementStrings;
+    size_t count = 0;
+    const MBTableGridEditRun *runs = MBTableGridEditListGetRuns(_pendingEdits, &count);
 
-    [_pending_replacements removeAllObjects];
+    if (rowCount && count) {
+        MBEnumerateEditBlocks(runs, count, rowCount, ^(NSIndexSet *columnIndexes, NSIndexSet *rowIndexes, uint32_t value, BOOL *stop) {
+            [_tableGrid _setObjectValue:strings[value] forColumns:columnIndexes rows:rowIndexes];
+        });
+        _tableGrid.columnFooterView.needsDisplay = YES;
+        _tableGrid.rowFooterView.needsDisplay = YES;
+        [_tableGrid _noteFindClientStringWillChange];
+    }
 
-    [_tableGrid reloadData];
+    MBTableGridEditListClear(_pendingEdits);
+    [_replacementStrings removeAllObjects];
 }
 
 
@@ -0,0 +1,70 @@
+//
+//  MBTableGridTileCache.h
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#import <Cocoa/Cocoa.h>
+
+/**
+ * @brief		Number of columns in each cached tile.
+ */
+#define MBTableGridTileColumns 8
+
+/**
+ * @brief		Number of rows in each cached tile.
+ */
+#define MBTableGridTileRows 32
+
+/**
+ * @brief		\c MBTableGridTileCache holds rendered bitmaps of fixed
+ *				blocks of cells (\c MBTableGridTileColumns by
+ *				\c MBTableGridTileRows), keyed by the range of cells
+ *				they hold.
+ *
+ * @details		Each bitmap remembers its cells, size and backing scale,
+ *				and is treated as missing if any of them no longer
+ *				matches. Its position isn't remembered, so a tile that
+ *				only moved because columns to its left or rows above it
+ *				were resized is drawn again in its new place; a resize
+ *				within a tile must discard it with
+ *				\c removeTilesInColumns:rows:. The least recently used
+ *				tiles are evicted once the cache exceeds \c byteLimit.
+ */
+@interface MBTableGridTileCache : NSObject
+
+/**
+ * @brief		The maximum number of bytes of bitmap data to keep.
+ *				Defaults to 64 MB.
+ */
+@property (nonatomic, assign) NSUInteger byteLimit;
+
+/**
+ * @brief		Returns the cached image for the tile holding the given
+ *				columns and rows, which start a tile, or \c NULL if the
+ *				tile hasn't been rendered for these cells at this size
+ *				and scale.
+ */
+- (CGImageRef)imageForTileWithColumns:(NSRange)columns rows:(NSRange)rows
+                                 size:(NSSize)size scale:(CGFloat)scale CF_RETURNS_NOT_RETAINED;
+
+/**
+ * @brief		Stores the rendered image for the tile holding the given
+ *				columns and rows, evicting old tiles if needed.
+ */
+- (void)setImage:(CGImageRef)image forTileWithColumns:(NSRange)columns rows:(NSRange)rows
+            size:(NSSize)size scale:(CGFloat)scale;
+
+/**
+ * @brief		Discards the tiles in the given ranges of tile columns
+ *				and tile rows.
+ */
+- (void)removeTilesInColumns:(NSRange)tileColumns rows:(NSRange)tileRows;
+
+/**
+ * @brief		Discards every tile.
+ */
+- (void)removeAllTiles;
+
+@end
@@ -0,0 +1,149 @@
+//
+//  MBTableGridTileCache.m
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#import "MBTableGridTileCache.h"
+
+#define MBTableGridTileCacheDefaultByteLimit (64 * 1024 * 1024)
+
+@interface MBTableGridTile : NSObject {
+@public
+    CGImageRef image;
+    NSRange columns;
+    NSRange rows;
+    NSSize size;
+    CGFloat scale;
+    NSUInteger lastUse;
+}
+@end
+
+@implementation MBTableGridTile
+
+- (void)dealloc {
+    CGImageRelease(image);
+}
+
+- (NSUInteger)byteCount {
+    return CGImageGetBytesPerRow(image) * CGImageGetHeight(image);
+}
+
+@end
+
+NS_INLINE NSNumber *MBTileKey(NSUInteger tileColumn, NSUInteger tileRow) {
+    return @(((uint64_t)tileColumn << 32) | (uint32_t)tileRow);
+}
+
+NS_INLINE NSNumber *MBTileKeyForCells(NSRange columns, NSRange rows) {
+    return MBTileKey(columns.location / MBTableGridTileColumns, rows.location / MBTableGridTileRows);
+}
+
+@interface MBTableGridTileCache () {
+    NSMutableDictionary<NSNumber *, MBTableGridTile *> *_tiles;
+    NSUInteger _byteCount;
+    NSUInteger _clock;
+}
+@end
+
+@implementation MBTableGridTileCache
+
+- (instancetype)init {
+    if (self = [super init]) {
+        _tiles = [NSMutableDictionary dictionary];
+        _byteLimit = MBTableGridTileCacheDefaultByteLimit;
+    }
+    return self;
+}
+
+- (CGImageRef)imageForTileWithColumns:(NSRange)columns rows:(NSRange)rows
+                                 size:(NSSize)size scale:(CGFloat)scale {
+    MBTableGridTile *tile = _tiles[MBTileKeyForCells(columns, rows)];
+    if (tile == nil || tile->scale != scale || !NSEqualSizes(tile->size, size) ||
+        !NSEqualRanges(tile->columns, columns) || !NSEqualRanges(tile->rows, rows))
+        return NULL;
+    tile->lastUse = ++_clock;
+    return tile->image;
+}
+
+- (void)setImage:(CGImageRef)image forTileWithColumns:(NSRange)columns rows:(NSRange)rows
+            size:(NSSize)size scale:(CGFloat)scale {
+    NSNumber *key = MBTileKeyForCells(columns, rows);
+    MBTableGridTile *previous = _tiles[key];
+    if (previous) {
+        _byteCount -= previous.byteCount;
+        [_tiles removeObjectForKey:key];
+    }
+    if (image == NULL)
+        return;
+
+    MBTableGridTile *tile = [[MBTableGridTile alloc] init];
+    tile->image = CGImageRetain(image);
+    tile->columns = columns;
+    tile->rows = rows;
+    tile->size = size;
+    tile->scale = scale;
+    tile->lastUse = ++_clock;
+    _tiles[key] = tile;
+    _byteCount += tile.byteCount;
+
+    [self _evictTilesExcept:key];
+}
+
+- (void)removeTilesInColumns:(NSRange)tileColumns rows:(NSRange)tileRows {
+    if (tileColumns.location == NSNotFound || tileRows.location == NSNotFound)
+        return;
+
+    // Walk whichever is smaller: the tiles we hold or the tiles in range
+    if (tileColumns.length * tileRows.length > _tiles.count) {
+        NSMutableArray<NSNumber *> *keys = [NSMutableArray array];
+        [_tiles enumerateKeysAndObjectsUsingBlock:^(NSNumber *key, MBTableGridTile *tile, BOOL *stop) {
+            uint64_t packed = key.unsignedLongLongValue;
+            if (NSLocationInRange((NSUInteger)(packed >> 32), tileColumns) &&
+                NSLocationInRange((NSUInteger)(packed & 0xFFFFFFFF), tileRows)) {
+                [keys addObject:key];
+            }
+        }];
+        for (NSNumber *key in keys) {
+            _byteCount -= _tiles[key].byteCount;
+            [_tiles removeObjectForKey:key];
+        }
+        return;
+    }
+
+    for (NSUInteger tileColumn = tileColumns.location; tileColumn < NSMaxRange(tileColumns); tileColumn++) {
+        for (NSUInteger tileRow = tileRows.location; tileRow < NSMaxRange(tileRows); tileRow++) {
+            NSNumber *key = MBTileKey(tileColumn, tileRow);
+            MBTableGridTile *tile = _tiles[key];
+            if (tile) {
+                _byteCount -= tile.byteCount;
+                [_tiles removeObjectForKey:key];
+            }
+        }
+    }
+}
+
+- (void)removeAllTiles {
+    [_tiles removeAllObjects];
+    _byteCount = 0;
+}
+
+- (void)_evictTilesExcept:(NSNumber *)keptKey {
+    while (_byteCount > _byteLimit && _tiles.count > 1) {
+        __block NSNumber *oldestKey = nil;
+        __block NSUInteger oldestUse = NSUIntegerMax;
+        [_tiles enumerateKeysAndObjectsUsingBlock:^(NSNumber *key, MBTableGridTile *tile, BOOL *stop) {
+            if (tile->lastUse < oldestUse && ![key isEqualToNumber:keptKey]) {
+                oldestUse = tile->lastUse;
+                oldestKey = key;
+            }
+        }];
+        if (oldestKey == nil)
+            break;
+        _byteCount -= _tiles[oldestKey].byteCount;
+        [_tiles removeObjectForKey:oldestKey];
+    }
+}
+
+@end
@@ -0,0 +1,261 @@
+//
+//  MBTableGridTrigramIndex.c
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#include "MBTableGridTrigramIndex.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define MBInitialTableCapacity 1024
+#define MBInitialPostingCapacity 4
+
+typedef struct MBPostingList {
+    uint32_t *cells;
+    uint32_t count;
+    uint32_t capacity;
+    /* Whether cells are in ascending order without duplicates */
+    bool isSorted;
+} MBPostingList;
+
+struct MBTableGridTrigramIndex {
+    /* Open-addressed table from trigram to postings list. Keys are stored
+       plus one, so that zero marks an empty slot. */
+    uint32_t *keys;
+    MBPostingList *lists;
+    size_t capacity;
+    size_t count;
+
+    size_t cellCount;
+    size_t staleCount;
+    uint64_t generation;
+};
+
+static inline unsigned char MBFold(unsigned char c) {
+    return (c >= 'A' && c <= 'Z') ? (unsigned char)(c | 0x20) : c;
+}
+
+static inline uint32_t MBTrigramAt(const unsigned char *bytes) {
+    return ((uint32_t)MBFold(bytes[0]) << 16) | ((uint32_t)MBFold(bytes[1]) << 8) | MBFold(bytes[2]);
+}
+
+static inline size_t MBSlotForKey(uint32_t key, size_t capacity) {
+    // Fibonacci hashing spreads the packed bytes across the table
+    return (size_t)((key * UINT32_C(2654435769)) >> 8) & (capacity - 1);
+}
+
+static MBPostingList *MBFindList(const MBTableGridTrigramIndex *index, uint32_t trigram) {
+    if (index->capacity == 0)
+        return NULL;
+    uint32_t key = trigram + 1;
+    for (size_t slot = MBSlotForKey(key, index->capacity); index->keys[slot]; slot = (slot + 1) & (index->capacity - 1)) {
+        if (index->keys[slot] == key)
+            return &index->lists[slot];
+    }
+    return NULL;
+}
+
+static bool MBGrowTable(MBTableGridTrigramIndex *index) {
+    size_t capacity = index->capacity ? index->capacity * 2 : MBInitialTableCapacity;
+    uint32_t *keys = calloc(capacity, sizeof(uint32_t));
+    MBPostingList *lists = calloc(capacity, sizeof(MBPostingList));
+    if (keys == NULL || lists == NULL) {
+        free(keys);
+        free(lists);
+        return false;
+    }
+    for (size_t i = 0; i < index->capacity; i++) {
+        if (index->keys[i] == 0)
+            continue;
+        size_t slot = MBSlotForKey(index->keys[i], capacity);
+        while (keys[slot])
+            slot = (slot + 1) & (capacity - 1);
+        keys[slot] = index->keys[i];
+        lists[slot] = index->lists[i];
+    }
+    free(index->keys);
+    free(index->lists);
+    index->keys = keys;
+    index->lists = lists;
+    index->capacity = capacity;
+    return true;
+}
+
+static MBPostingList *MBListForTrigram(MBTableGridTrigramIndex *index, uint32_t trigram) {
+    MBPostingList *list = MBFindList(index, trigram);
+    if (list)
+        return list;
+    if ((index->count + 1) * 2 > index->capacity && !MBGrowTable(index))
+        return NULL;
+
+    uint32_t key = trigram + 1;
+    size_t slot = MBSlotForKey(key, index->capacity);
+    while (index->keys[slot])
+        slot = (slot + 1) & (index->capacity - 1);
+    index->keys[slot] = key;
+    index->lists[slot] = (MBPostingList){ NULL, 0, 0, true };
+    index->count++;
+    return &index->lists[slot];
+}
+
+static bool MBAppendPosting(MBPostingList *list, uint32_t cell) {
+    // Trigrams repeated within one cell's text arrive back to back
+    if (list->count && list->cells[list->count - 1] == cell)
+        return true;
+    if (list->count == list->capacity) {
+        uint32_t capacity = list->capacity ? list->capacity * 2 : MBInitialPostingCapacity;
+        uint32_t *cells = realloc(list->cells, capacity * sizeof(uint32_t));
+        if (cells == NULL)
+            return false;
+        list->cells = cells;
+        list->capacity = capacity;
+    }
+    if (list->count && list->cells[list->count - 1] > cell)
+        list->isSorted = false;
+    list->cells[list->count++] = cell;
+    return true;
+}
+
+static int MBCompareCells(const void *a, const void *b) {
+    uint32_t left = *(const uint32_t *)a, right = *(const uint32_t *)b;
+    return left < right ? -1 : left > right;
+}
+
+static void MBSortList(MBPostingList *list) {
+    if (list->isSorted)
+        return;
+    qsort(list->cells, list->count, sizeof(uint32_t), MBCompareCells);
+    uint32_t unique = 0;
+    for (uint32_t i = 0; i < list->count; i++) {
+        if (unique == 0 || list->cells[unique - 1] != list->cells[i])
+            list->cells[unique++] = list->cells[i];
+    }
+    list->count = unique;
+    list->isSorted = true;
+}
+
+static bool MBIndexText(MBTableGridTrigramIndex *index, uint32_t cell, const char *text, size_t length) {
+    const unsigned char *bytes = (const unsigned char *)text;
+    index->generation++;
+    for (size_t i = 0; i + 3 <= length; i++) {
+        MBPostingList *list = MBListForTrigram(index, MBTrigramAt(bytes + i));
+        if (list == NULL || !MBAppendPosting(list, cell))
+            return false;
+    }
+    return true;
+}
+
+MBTableGridTrigramIndex *MBTableGridTrigramIndexCreate(void) {
+    return calloc(1, sizeof(MBTableGridTrigramIndex));
+}
+
+void MBTableGridTrigramIndexDestroy(MBTableGridTrigramIndex *index) {
+    if (index == NULL)
+        return;
+    for (size_t i = 0; i < index->capacity; i++)
+        free(index->lists[i].cells);
+    free(index->keys);
+    free(index->lists);
+    free(index);
+}
+
+void MBTableGridTrigramIndexClear(MBTableGridTrigramIndex *index) {
+    for (size_t i = 0; i < index->capacity; i++) {
+        index->lists[i].count = 0;
+        index->lists[i].isSorted = true;
+    }
+    index->cellCount = 0;
+    index->staleCount = 0;
+    index->generation++;
+}
+
+bool MBTableGridTrigramIndexAddText(MBTableGridTrigramIndex *index, uint32_t cell, const char *text, size_t length) {
+    index->cellCount++;
+    return MBIndexText(index, cell, text, length);
+}
+
+bool MBTableGridTrigramIndexAddValues(MBTableGridTrigramIndex *index, uint32_t firstCell, const MBTableGridValue *values, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        char scratch[MBTableGridValueFormatCapacity];
+        size_t length = 0;
+        const char *text = MBTableGridValueGetUTF8(&values[i], scratch, &length);
+        if (!MBTableGridTrigramIndexAddText(index, firstCell + (uint32_t)i, text, length))
+            return false;
+    }
+    return true;
+}
+
+bool MBTableGridTrigramIndexReplaceText(MBTableGridTrigramIndex *index, uint32_t cell, const char *text, size_t length) {
+    index->staleCount++;
+    return MBIndexText(index, cell, text, length);
+}
+
+size_t MBTableGridTrigramIndexCellCount(const MBTableGridTrigramIndex *index) {
+    return index->cellCount;
+}
+
+size_t MBTableGridTrigramIndexStaleCount(const MBTableGridTrigramIndex *index) {
+    return index->staleCount;
+}
+
+uint64_t MBTableGridTrigramIndexGeneration(const MBTableGridTrigramIndex *index) {
+    return index->generation;
+}
+
+size_t MBTableGridTrigramIndexByteCount(const MBTableGridTrigramIndex *index) {
+    size_t byteCount = sizeof(MBTableGridTrigramIndex) + index->capacity * (sizeof(uint32_t) + sizeof(MBPostingList));
+    for (size_t i = 0; i < index->capacity; i++)
+        byteCount += index->lists[i].capacity * sizeof(uint32_t);
+    return byteCount;
+}
+
+size_t MBTableGridTrigramIndexGetCandidates(MBTableGridTrigramIndex *index, const char *text, size_t length, uint32_t **cells) {
+    const unsigned char *bytes = (const unsigned char *)text;
+    MBPostingList *shortest = NULL;
+    *cells = NULL;
+    if (length < 3)
+        return MBTableGridTrigramIndexUnusable;
+
+    // Any missing trigram rules out every cell
+    for (size_t i = 0; i + 3 <= length; i++) {
+        MBPostingList *list = MBFindList(index, MBTrigramAt(bytes + i));
+        if (list == NULL || list->count == 0)
+            return 0;
+        MBSortList(list);
+        if (shortest == NULL || list->count < shortest->count)
+            shortest = list;
+    }
+
+    uint32_t *candidates = malloc(shortest->count * sizeof(uint32_t));
+    if (candidates == NULL)
+        return MBTableGridTrigramIndexUnusable;
+    memcpy(candidates, shortest->cells, shortest->count * sizeof(uint32_t));
+    size_t count = shortest->count;
+
+    // Narrow the shortest list by each of the others in turn
+    for (size_t i = 0; i + 3 <= length && count > 0; i++) {
+        MBPostingList *list = MBFindList(index, MBTrigramAt(bytes + i));
+        if (list == shortest)
+            continue;
+        size_t kept = 0, j = 0;
+        for (size_t k = 0; k < count; k++) {
+            while (j < list->count && list->cells[j] < candidates[k])
+                j++;
+            if (j == list->count)
+                break;
+            if (list->cells[j] == candidates[k])
+                candidates[kept++] = candidates[k];
+        }
+        count = kept;
+    }
+
+    if (count == 0) {
+        free(candidates);
+        return 0;
+    }
+    *cells = candidates;
+    return count;
+}
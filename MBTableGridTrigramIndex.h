@@ -0,0 +1,133 @@
+//
+//  MBTableGridTrigramIndex.h
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#ifndef MBTableGridTrigramIndex_h
+#define MBTableGridTrigramIndex_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "MBTableGridValue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief		Returned by \c MBTableGridTrigramIndexGetCandidates when the
+ *				index can't narrow down a search, because the search text
+ *				is shorter than three bytes.
+ */
+#define MBTableGridTrigramIndexUnusable ((size_t)-1)
+
+/**
+ * @brief		\c MBTableGridTrigramIndex maps every three-byte sequence
+ *				in the UTF-8 text of a set of cells to the cells that
+ *				contain it.
+ *
+ * @details		Cells are identified by number; the grid numbers them in
+ *				column-first order. ASCII letters are indexed without
+ *				regard to case. Any cell containing a search string of
+ *				three or more bytes contains each of its trigrams, so
+ *				intersecting their postings lists yields every cell that
+ *				can match, and only those need to be checked.
+ *
+ *				Postings are only ever added: when a cell's text changes,
+ *				its new trigrams are added and its old ones are left in
+ *				place. The candidates returned may therefore include cells
+ *				that no longer match, but never miss one that does, as
+ *				long as each change is recorded with
+ *				\c MBTableGridTrigramIndexReplaceText. Callers should
+ *				rebuild the index once \c MBTableGridTrigramIndexStaleCount
+ *				grows large.
+ *
+ *				The index is plain C so that it can be built and measured
+ *				away from AppKit. It is not thread-safe.
+ */
+typedef struct MBTableGridTrigramIndex MBTableGridTrigramIndex;
+
+/**
+ * @brief		Creates an empty index. Returns \c NULL if out of memory.
+ */
+MBTableGridTrigramIndex *MBTableGridTrigramIndexCreate(void);
+
+/**
+ * @brief		Frees an index created with \c MBTableGridTrigramIndexCreate.
+ */
+void MBTableGridTrigramIndexDestroy(MBTableGridTrigramIndex *index);
+
+/**
+ * @brief		Removes every posting, keeping the allocated storage.
+ */
+void MBTableGridTrigramIndexClear(MBTableGridTrigramIndex *index);
+
+/**
+ * @brief		Indexes the text of a cell not already in the index.
+ *
+ * @return		\c false if out of memory, in which case the index may
+ *				hold some of the cell's trigrams and should be cleared.
+ */
+bool MBTableGridTrigramIndexAddText(MBTableGridTrigramIndex *index, uint32_t cell, const char *text, size_t length);
+
+/**
+ * @brief		Indexes the text of \c count consecutive cells, starting
+ *				with \c firstCell, in the form given by
+ *				\c MBTableGridValueGetUTF8.
+ *
+ * @return		\c false if out of memory, as for
+ *				\c MBTableGridTrigramIndexAddText.
+ */
+bool MBTableGridTrigramIndexAddValues(MBTableGridTrigramIndex *index, uint32_t firstCell, const MBTableGridValue *values, size_t count);
+
+/**
+ * @brief		Indexes the new text of a cell that is already in the
+ *				index, and counts the cell as stale.
+ *
+ * @return		\c false if out of memory, as for
+ *				\c MBTableGridTrigramIndexAddText.
+ */
+bool MBTableGridTrigramIndexReplaceText(MBTableGridTrigramIndex *index, uint32_t cell, const char *text, size_t length);
+
+/**
+ * @brief		Returns the number of cells added since the index was
+ *				last cleared, and the number of those replaced since.
+ */
+size_t MBTableGridTrigramIndexCellCount(const MBTableGridTrigramIndex *index);
+size_t MBTableGridTrigramIndexStaleCount(const MBTableGridTrigramIndex *index);
+
+/**
+ * @brief		Returns a number that changes whenever cells are added,
+ *				replaced or cleared, so that callers can tell whether
+ *				candidates they hold are still complete.
+ */
+uint64_t MBTableGridTrigramIndexGeneration(const MBTableGridTrigramIndex *index);
+
+/**
+ * @brief		Returns the number of bytes the index has allocated.
+ */
+size_t MBTableGridTrigramIndexByteCount(const MBTableGridTrigramIndex *index);
+
+/**
+ * @brief		Finds the cells whose text may contain \c text.
+ *
+ * @details		On success \c cells is set to a buffer, allocated with
+ *				\c malloc and owned by the caller, of candidate cells in
+ *				ascending order, or to \c NULL if there are none.
+ *
+ * @return		The number of candidate cells, or
+ *				\c MBTableGridTrigramIndexUnusable if \c text is too short
+ *				for the index to help or memory runs out, in which case
+ *				every cell must be searched.
+ */
+size_t MBTableGridTrigramIndexGetCandidates(MBTableGridTrigramIndex *index, const char *text, size_t length, uint32_t **cells);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MBTableGridTrigramIndex_h */
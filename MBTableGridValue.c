@@ -0,0 +1,229 @@
+//
+//  MBTableGridValue.c
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#include "MBTableGridValue.h"
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static size_t MBFormatDouble(double number, char *scratch) {
+    if (isnan(number)) {
+        memcpy(scratch, "NaN", 4);
+        return 3;
+    }
+    if (isinf(number)) {
+        strcpy(scratch, number < 0 ? "-Inf" : "Inf");
+        return number < 0 ? 4 : 3;
+    }
+    // Most values read back exactly at 15 digits; fall back to 17, which always does
+    int length = snprintf(scratch, MBTableGridValueFormatCapacity, "%.15g", number);
+    if (strtod(scratch, NULL) != number)
+        length = snprintf(scratch, MBTableGridValueFormatCapacity, "%.17g", number);
+    return length > 0 ? (size_t)length : 0;
+}
+
+// Years 0000 through 9999, as seconds since 1970
+#define MBEarliestDate (-62167219200.0)
+#define MBLatestDate (253402300800.0)
+
+static size_t MBFormatDate(double secondsSince1970, char *scratch) {
+    if (!(secondsSince1970 >= MBEarliestDate && secondsSince1970 < MBLatestDate))
+        return MBFormatDouble(secondsSince1970, scratch);
+
+    double wholeSeconds = floor(secondsSince1970);
+    int milliseconds = (int)floor((secondsSince1970 - wholeSeconds) * 1000.0 + 0.5);
+    if (milliseconds == 1000) {
+        wholeSeconds += 1.0;
+        milliseconds = 0;
+    }
+    int64_t seconds = (int64_t)wholeSeconds;
+    int64_t days = seconds / 86400;
+    int64_t secondOfDay = seconds % 86400;
+    if (secondOfDay < 0) {
+        secondOfDay += 86400;
+        days--;
+    }
+
+    // Convert days to a proleptic Gregorian date, counting in 400-year eras from 0000-03-01
+    days += 719468;
+    int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    int64_t dayOfEra = days - era * 146097;
+    int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int64_t shiftedMonth = (5 * dayOfYear + 2) / 153;
+    int day = (int)(dayOfYear - (153 * shiftedMonth + 2) / 5 + 1);
+    int month = (int)(shiftedMonth < 10 ? shiftedMonth + 3 : shiftedMonth - 9);
+    int year = (int)(yearOfEra + era * 400 + (month <= 2));
+
+    int length;
+    if (milliseconds) {
+        length = snprintf(scratch, MBTableGridValueFormatCapacity, "%04d-%02d-%02dT%02d:%02d:%02d.%03dZ",
+                          year, month, day, (int)(secondOfDay / 3600), (int)(secondOfDay / 60 % 60),
+                          (int)(secondOfDay % 60), milliseconds);
+    } else {
+        length = snprintf(scratch, MBTableGridValueFormatCapacity, "%04d-%02d-%02dT%02d:%02d:%02dZ",
+                          year, month, day, (int)(secondOfDay / 3600), (int)(secondOfDay / 60 % 60),
+                          (int)(secondOfDay % 60));
+    }
+    return length > 0 ? (size_t)length : 0;
+}
+
+const char *MBTableGridValueGetUTF8(const MBTableGridValue *value, char *scratch, size_t *length) {
+    int written;
+    switch (value->type) {
+        case MBTableGridValueTypeString:
+            *length = value->data.string.bytes ? value->data.string.length : 0;
+            return value->data.string.bytes ? value->data.string.bytes : "";
+        case MBTableGridValueTypeInteger:
+            written = snprintf(scratch, MBTableGridValueFormatCapacity, "%" PRId64, value->data.integer);
+            *length = written > 0 ? (size_t)written : 0;
+            return scratch;
+        case MBTableGridValueTypeDouble:
+            *length = MBFormatDouble(value->data.number, scratch);
+            return scratch;
+        case MBTableGridValueTypeBoolean:
+            *length = value->data.boolean ? 4 : 5;
+            return value->data.boolean ? "TRUE" : "FALSE";
+        case MBTableGridValueTypeDate:
+            *length = MBFormatDate(value->data.number, scratch);
+            return scratch;
+        case MBTableGridValueTypeEmpty:
+        case MBTableGridValueTypePending:
+        default:
+            *length = 0;
+            return "";
+    }
+}
+
+size_t MBTableGridValueFormat(const MBTableGridValue *value, char *buffer, size_t capacity) {
+    char scratch[MBTableGridValueFormatCapacity];
+    size_t length = 0;
+    const char *text = MBTableGridValueGetUTF8(value, scratch, &length);
+    if (capacity > 0) {
+        size_t copied = length < capacity - 1 ? length : capacity - 1;
+        // Don't split a multibyte character when truncating
+        if (copied < length) {
+            while (copied > 0 && ((unsigned char)text[copied] & 0xC0) == 0x80)
+                copied--;
+        }
+        memcpy(buffer, text, copied);
+        buffer[copied] = '\0';
+    }
+    return length;
+}
+
+char *MBTableGridValuesCopyStrings(MBTableGridValue *values, size_t count) {
+    size_t length = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (values[i].type == MBTableGridValueTypeString)
+            length += values[i].data.string.length;
+    }
+    char *bytes = malloc(length ? length : 1);
+    if (bytes == NULL)
+        return NULL;
+    size_t offset = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (values[i].type != MBTableGridValueTypeString)
+            continue;
+        size_t stringLength = values[i].data.string.length;
+        if (stringLength)
+            memcpy(bytes + offset, values[i].data.string.bytes, stringLength);
+        values[i].data.string.bytes = bytes + offset;
+        offset += stringLength;
+    }
+    return bytes;
+}
+
+static bool MBReadDigits(const char **cursor, const char *end, int count, int *result) {
+    int number = 0;
+    if (end - *cursor < count)
+        return false;
+    for (int i = 0; i < count; i++) {
+        char c = (*cursor)[i];
+        if (c < '0' || c > '9')
+            return false;
+        number = number * 10 + (c - '0');
+    }
+    *cursor += count;
+    *result = number;
+    return true;
+}
+
+// Days since 1970-01-01 in the proleptic Gregorian calendar
+static int64_t MBDaysFromCivil(int64_t year, int month, int day) {
+    year -= month <= 2;
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    int64_t yearOfEra = year - era * 400;
+    int64_t dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+bool MBTableGridValueParseDate(const char *bytes, size_t length, double *secondsSince1970) {
+    static const int daysInMonth[] = { 31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    const char *cursor = bytes;
+    const char *end = bytes + length;
+    int year, month, day, hour = 0, minute = 0, second = 0, offset = 0;
+    double fraction = 0.0;
+
+    if (!MBReadDigits(&cursor, end, 4, &year) || cursor == end || *cursor++ != '-' ||
+        !MBReadDigits(&cursor, end, 2, &month) || cursor == end || *cursor++ != '-' ||
+        !MBReadDigits(&cursor, end, 2, &day))
+        return false;
+    if (month < 1 || month > 12 || day < 1 || day > daysInMonth[month - 1])
+        return false;
+    if (month == 2 && day == 29 && (year % 4 != 0 || (year % 100 == 0 && year % 400 != 0)))
+        return false;
+
+    if (cursor < end && (*cursor == 'T' || *cursor == ' ')) {
+        cursor++;
+        if (!MBReadDigits(&cursor, end, 2, &hour) || cursor == end || *cursor++ != ':' ||
+            !MBReadDigits(&cursor, end, 2, &minute))
+            return false;
+        if (cursor < end && *cursor == ':') {
+            cursor++;
+            if (!MBReadDigits(&cursor, end, 2, &second))
+                return false;
+            if (cursor < end && (*cursor == '.' || *cursor == ',')) {
+                double scale = 0.1;
+                cursor++;
+                if (cursor == end || *cursor < '0' || *cursor > '9')
+                    return false;
+                while (cursor < end && *cursor >= '0' && *cursor <= '9') {
+                    fraction += (*cursor++ - '0') * scale;
+                    scale /= 10.0;
+                }
+            }
+        }
+        if (hour > 23 || minute > 59 || second > 60)
+            return false;
+
+        if (cursor < end && *cursor == 'Z') {
+            cursor++;
+        } else if (cursor < end && (*cursor == '+' || *cursor == '-')) {
+            int sign = *cursor++ == '-' ? -1 : 1;
+            int offsetHours, offsetMinutes = 0;
+            if (!MBReadDigits(&cursor, end, 2, &offsetHours))
+                return false;
+            if (cursor < end && *cursor == ':')
+                cursor++;
+            if (cursor < end && !MBReadDigits(&cursor, end, 2, &offsetMinutes))
+                return false;
+            if (offsetHours > 23 || offsetMinutes > 59)
+                return false;
+            offset = sign * (offsetHours * 3600 + offsetMinutes * 60);
+        }
+    }
+    if (cursor != end)
+        return false;
+
+    *secondsSince1970 = (double)(MBDaysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second - offset) + fraction;
+    return true;
+}
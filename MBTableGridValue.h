@@ -0,0 +1,144 @@
+//
+//  MBTableGridValue.h
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+
+#ifndef MBTableGridValue_h
+#define MBTableGridValue_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief		The kind of data held by an \c MBTableGridValue.
+ */
+typedef enum MBTableGridValueType {
+    MBTableGridValueTypeEmpty = 0,
+    MBTableGridValueTypeInteger,
+    MBTableGridValueTypeDouble,
+    MBTableGridValueTypeBoolean,
+    MBTableGridValueTypeString,
+    MBTableGridValueTypePending,
+    MBTableGridValueTypeDate
+} MBTableGridValueType;
+
+/**
+ * @brief		A cell value that can be filled in without creating objects.
+ *
+ * @details		Strings are borrowed: \c data.string points at UTF-8 bytes
+ *				owned by whoever filled in the value, which need not be
+ *				NUL-terminated. Dates are held in \c data.number as seconds
+ *				since 1970 UTC. A zeroed value is empty. A pending value is
+ *				one that is still being loaded, and is drawn as a placeholder.
+ */
+typedef struct MBTableGridValue {
+    MBTableGridValueType type;
+    union {
+        int64_t integer;
+        double number;
+        bool boolean;
+        struct {
+            const char *bytes;
+            size_t length;
+        } string;
+    } data;
+} MBTableGridValue;
+
+/**
+ * @brief		Large enough for any formatted non-string value,
+ *				including the terminating NUL.
+ */
+#define MBTableGridValueFormatCapacity 32
+
+static inline MBTableGridValue MBTableGridValueMakeInteger(int64_t integer) {
+    MBTableGridValue value = { MBTableGridValueTypeInteger, { 0 } };
+    value.data.integer = integer;
+    return value;
+}
+
+static inline MBTableGridValue MBTableGridValueMakeDouble(double number) {
+    MBTableGridValue value = { MBTableGridValueTypeDouble, { 0 } };
+    value.data.number = number;
+    return value;
+}
+
+static inline MBTableGridValue MBTableGridValueMakeBoolean(bool boolean) {
+    MBTableGridValue value = { MBTableGridValueTypeBoolean, { 0 } };
+    value.data.boolean = boolean;
+    return value;
+}
+
+static inline MBTableGridValue MBTableGridValueMakeString(const char *bytes, size_t length) {
+    MBTableGridValue value = { MBTableGridValueTypeString, { 0 } };
+    value.data.string.bytes = bytes;
+    value.data.string.length = length;
+    return value;
+}
+
+static inline MBTableGridValue MBTableGridValueMakeDate(double secondsSince1970) {
+    MBTableGridValue value = { MBTableGridValueTypeDate, { 0 } };
+    value.data.number = secondsSince1970;
+    return value;
+}
+
+static inline MBTableGridValue MBTableGridValueMakePending(void) {
+    MBTableGridValue value = { MBTableGridValueTypePending, { 0 } };
+    return value;
+}
+
+/**
+ * @brief		Returns the value as UTF-8 text, without copying strings.
+ *
+ * @details		For strings this returns the borrowed bytes themselves.
+ *				Other values are formatted into \c scratch, which must hold
+ *				at least \c MBTableGridValueFormatCapacity bytes: integers
+ *				in decimal, doubles in the shortest form that reads back
+ *				exactly, booleans as \c TRUE or \c FALSE, and dates in
+ *				ISO 8601 form, such as \c 2026-10-16T12:30:00Z. Empty and
+ *				pending values return an empty string. The length in bytes
+ *				is stored in \c length, and the result is not necessarily
+ *				NUL-terminated.
+ */
+const char *MBTableGridValueGetUTF8(const MBTableGridValue *value, char *scratch, size_t *length);
+
+/**
+ * @brief		Writes the value as NUL-terminated UTF-8 text into
+ *				\c buffer, truncating it to fit \c capacity bytes.
+ *
+ * @return		The length of the full text, not counting the NUL, in the
+ *				manner of \c snprintf.
+ */
+size_t MBTableGridValueFormat(const MBTableGridValue *value, char *buffer, size_t capacity);
+
+/**
+ * @brief		Copies the strings of \c count values into one buffer, and
+ *				points the values at it, so that they outlast whatever they
+ *				were borrowed from.
+ *
+ * @return		The buffer, to be freed along with the values, or \c NULL
+ *				if out of memory, in which case the values are unchanged.
+ */
+char *MBTableGridValuesCopyStrings(MBTableGridValue *values, size_t count);
+
+/**
+ * @brief		Parses an ISO 8601 date, such as \c 2026-10-16, optionally
+ *				followed by a time such as \c T12:30:00Z or
+ *				<tt>12:30:00.5+02:00</tt>. Times without an offset are UTC.
+ *
+ * @return		\c false if \c bytes isn't a valid date, in which case
+ *				\c secondsSince1970 is unchanged.
+ */
+bool MBTableGridValueParseDate(const char *bytes, size_t length, double *secondsSince1970);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MBTableGridValue_h */
@@ -15,4 +15,7 @@
 
 - (instancetype)initWithTableGrid:(MBTableGrid *)tableGrid;
 
+// Marks cells whose values have changed as needing to be searched again
+- (void)forgetCellsInColumns:(NSIndexSet *)columnIndexes rows:(NSIndexSet *)rowIndexes;
+
 @end
@@ -7,18 +7,137 @@
 
 #import "MBTableGridVirtualString.h"
 #import "MBTableGrid.h"
+#import "MBTableGridValue.h"
+#import "MBTableGridFind.h"
+#import "MBTableGridTrigramIndex.h"
+#import "MBTableGridRegex.h"
+#import "MBTableGridBitmap.h"
+#import <stdatomic.h>
 
-#define _row(cellIndex, rows, cols) ((cellIndex) % (rows) + (cols-cols))
-#define _col(cellIndex, rows, cols) ((cellIndex) / (rows) + (cols-cols))
+#define MBTableGridFindBatchSize 65536 // cells fetched from the data source at a time
+#define MBTableGridFindChunkSize 1024 // cells matched by each worker task
+#define MBTableGridFindCandidateRatio 16 // cells per index candidate below which scanning is cheaper
 
 @interface MBTableGrid (Private)
 
 @property (nonatomic, readonly) BOOL _shouldAbortFindOperation;
+@property (nonatomic, readonly) MBTableGridTrigramIndex *_findIndex;
 
-- (id)_objectValueForColumn:(NSUInteger)columnIndex row:(NSUInteger)rowIndex;
+- (BOOL)_providesTypedValues;
+- (void)_getValues:(MBTableGridValue *)values forColumns:(NSRange)columnRange rows:(NSRange)rowRange;
+- (char *)_stringsDescribingObjectValues:(MBTableGridValue *)values forColumns:(NSRange)columnRange rows:(NSRange)rowRange
+                        ofDataSourceRows:(const size_t *)dataSourceRows;
+- (void)_getObjectValues:(id __strong *)values forColumns:(NSRange)columnRange rows:(NSRange)rowRange;
 
 @end
 
+// A block of cells being matched on worker threads, which owns copies of their values
+// so that the data source can be asked for the next block while this one is matched
+@interface MBTableGridFindBatch : NSObject {
+    atomic_bool _cancelled;
+}
+@property (nonatomic, readonly) NSRange columns;
+@property (nonatomic, readonly) NSRange rows;
+@property (nonatomic, readonly) uint64_t firstCell;
+@property (nonatomic, readonly) NSUInteger count;
+@property (nonatomic, readonly) MBTableGridValue *values;
+@property (nonatomic, readonly) unsigned char *matches;
+@property (nonatomic, readonly) atomic_bool *cancellation;
+@property (nonatomic, readonly) dispatch_group_t group;
+// The buffer holding the values' strings, freed with the batch
+@property (nonatomic) char *strings;
+@end
+
+@implementation MBTableGridFindBatch
+
+- (instancetype)initWithColumns:(NSRange)columnRange rows:(NSRange)rowRange rowCount:(NSUInteger)rowCount {
+    if (self = [super init]) {
+        _columns = columnRange;
+        _rows = rowRange;
+        // The block is contiguous in column-first order, so its cells are numbered from its first
+        _firstCell = columnRange.location * rowCount + rowRange.location;
+        _count = columnRange.length * rowRange.length;
+        _values = malloc(_count * sizeof(MBTableGridValue));
+        _matches = calloc(_count, 1);
+        _group = dispatch_group_create();
+        if (_values == NULL || _matches == NULL)
+            return nil;
+    }
+    return self;
+}
+
+- (void)dealloc {
+    free(_values);
+    free(_strings);
+    free(_matches);
+}
+
+- (atomic_bool *)cancellation {
+    return &_cancelled;
+}
+
+@end
+
+@interface MBTableGridVirtualString () {
+    // What was last searched for, the cells searched so far, and those that matched
+    NSString *_searchString;
+    NSStringCompareOptions _searchOptions;
+    MBTableGridFindMode _searchMode;
+    MBTableGridFindPattern *_pattern;
+    MBTableGridBitmap *_searchedCells;
+    MBTableGridBitmap *_matchingCells;
+
+    // Cells the grid's index says may match, and the index generation they came from
+    uint32_t *_candidates;
+    size_t _candidateCount;
+    uint64_t _candidateGeneration;
+    BOOL _hasCandidates;
+
+    // Patterns compiled for the regular expression and wildcard modes, with a matcher
+    // for each worker thread, since matchers cache automaton states as they go. There
+    // are two sets, taken in turn, since a batch may be matched while the last finishes.
+    MBTableGridRegex *_regex;
+    MBTableGridRegexMatcher **_matchers[2];
+    size_t _matcherCount;
+    NSUInteger _nextMatcherSet;
+
+    // The batch after the last one searched, still being matched, whose results are
+    // recorded on the main thread when it finishes unless a search takes it over first
+    MBTableGridFindBatch *_readAhead;
+}
+@end
+
+// The next block of cells to fetch, starting at startIndex (or ending at endIndex when
+// searching backwards): as many whole columns as fit in a batch, or else a run of rows
+// within one column, so that the block is always contiguous in column-first order
+static void MBFindBatch(NSUInteger startIndex, NSUInteger endIndex, NSUInteger rowCount, BOOL backwards,
+                        NSRange *columnRange, NSRange *rowRange) {
+    NSUInteger cellCount = endIndex - startIndex;
+    BOOL fitsWholeColumns = rowCount <= MBTableGridFindBatchSize && cellCount >= rowCount;
+
+    if (!backwards) {
+        NSUInteger row = startIndex % rowCount, column = startIndex / rowCount;
+        if (row == 0 && fitsWholeColumns) {
+            *columnRange = NSMakeRange(column, MIN(MBTableGridFindBatchSize / rowCount, cellCount / rowCount));
+            *rowRange = NSMakeRange(0, rowCount);
+        } else {
+            *columnRange = NSMakeRange(column, 1);
+            *rowRange = NSMakeRange(row, MIN(MIN(rowCount - row, cellCount), MBTableGridFindBatchSize));
+        }
+    } else {
+        NSUInteger row = (endIndex - 1) % rowCount, column = (endIndex - 1) / rowCount;
+        if (row == rowCount - 1 && fitsWholeColumns) {
+            NSUInteger columnCount = MIN(MBTableGridFindBatchSize / rowCount, cellCount / rowCount);
+            *columnRange = NSMakeRange(column + 1 - columnCount, columnCount);
+            *rowRange = NSMakeRange(0, rowCount);
+        } else {
+            NSUInteger length = MIN(MIN(row + 1, cellCount), MBTableGridFindBatchSize);
+            *columnRange = NSMakeRange(column, 1);
+            *rowRange = NSMakeRange(row + 1 - length, length);
+        }
+    }
+}
+
 @implementation MBTableGridVirtualString
 
 /* This is a virtual string that treats cells as individual "characters" that can be searched
@@ -26,50 +145,394 @@
  *
  * https://github.com/pixelspark/mbtablegrid/issues/31
  *
- * Searches in column-first order.
+ * Searches in column-first order. Cells are fetched from the data source a batch at a time
+ * on the main thread, then matched on a background queue while the next batch is fetched
+ * and started on, and every match in the batch is remembered so that NSTextFinder's follow-up searches for the next match (or for all of
+ * them) are answered in order without searching the same cells again. The cells searched
+ * and those that matched are kept as compressed bitmaps, so that moving to the next or
+ * previous match, or finding those in the visible cells to highlight, is a lookup
+ * however far apart they are. Cells the grid changes are forgotten and searched again.
+ * The batch read ahead of a search that stopped at a match is left to finish, and its
+ * matches and the cells it searched are posted back to the main thread, so that the
+ * search for the next match can start from them.
+ *
+ * When the grid indexes its cells, only the cells whose text has every trigram of the
+ * search string are fetched and checked, one at a time, as long as they're sparse enough
+ * for that to beat scanning.
+ *
+ * In the regular expression and wildcard find modes, the search string is compiled once
+ * into an automaton, and each worker thread runs it over the cells' UTF-8 text in place.
  */
 
 - (instancetype)initWithTableGrid:(MBTableGrid *)tableGrid {
     if (self = [super init]) {
         _tableGrid = tableGrid;
+        _searchedCells = MBTableGridBitmapCreate();
+        _matchingCells = MBTableGridBitmapCreate();
     }
     return self;
 }
 
+- (void)dealloc {
+    MBTableGridFindPatternDestroy(_pattern);
+    free(_candidates);
+    [self _destroyRegex];
+    MBTableGridBitmapDestroy(_searchedCells);
+    MBTableGridBitmapDestroy(_matchingCells);
+}
+
 - (NSUInteger)length {
     return _tableGrid.numberOfRows * _tableGrid.numberOfColumns;
 }
 
 - (NSRange)rangeOfString:(NSString *)searchString options:(NSStringCompareOptions)mask range:(NSRange)rangeOfReceiverToSearch {
-    NSUInteger cellIndex = rangeOfReceiverToSearch.location;
-    
-    NSInteger rowCount = _tableGrid.numberOfRows;
-    NSInteger columnCount = _tableGrid.numberOfColumns;
-    
-    while (cellIndex < rangeOfReceiverToSearch.location + rangeOfReceiverToSearch.length) {
-        NSRange result = NSMakeRange(NSNotFound, 0);
-        NSUInteger rowIndex = _row(cellIndex, rowCount, columnCount);
-        NSUInteger columnIndex = _col(cellIndex, rowCount, columnCount);
-        
-        @autoreleasepool {
-            NSString *value = [_tableGrid _objectValueForColumn:columnIndex row:rowIndex];
-            if (value) {
-                result = [value rangeOfString:searchString options:mask];
-            }
+    NSUInteger rowCount = _tableGrid.numberOfRows;
+    NSUInteger startIndex = rangeOfReceiverToSearch.location;
+    NSUInteger endIndex = MIN(NSMaxRange(rangeOfReceiverToSearch), self.length);
+    BOOL backwards = (mask & NSBackwardsSearch) != 0;
+
+    if (rowCount == 0 || searchString.length == 0 || startIndex >= endIndex || !_searchedCells || !_matchingCells)
+        return NSMakeRange(NSNotFound, 0);
+
+    [self _prepareToSearchForString:searchString options:mask & ~NSBackwardsSearch];
+
+    // A pattern that doesn't compile matches nothing
+    if (_searchMode != MBTableGridFindModeText && _matcherCount == 0)
+        return NSMakeRange(NSNotFound, 0);
+    if (_tableGrid._shouldAbortFindOperation)
+        return NSMakeRange(NSNotFound, 0);
+
+    // The index stores bytes, so it can only narrow down searches the pattern can answer
+    MBTableGridTrigramIndex *index = (_pattern && searchString.length >= 3) ? _tableGrid._findIndex : NULL;
+    if (index && [self _loadCandidatesFromIndex:index]) {
+        size_t first = [self _candidateIndexForCell:startIndex];
+        size_t last = [self _candidateIndexForCell:endIndex];
+        if ((last - first) * MBTableGridFindCandidateRatio <= endIndex - startIndex)
+            return [self _rangeOfCandidatesFrom:first to:last backwards:backwards rowCount:rowCount];
+    }
+
+    while (startIndex < endIndex) {
+        // Answer from the cells already searched, if they're next in line
+        if (!backwards && MBTableGridBitmapContains(_searchedCells, startIndex)) {
+            NSUInteger knownEnd = MIN(MBTableGridBitmapNextNonMember(_searchedCells, startIndex), endIndex);
+            uint64_t cellIndex = MBTableGridBitmapNextMember(_matchingCells, startIndex);
+            if (cellIndex < knownEnd)
+                return NSMakeRange(cellIndex, 1);
+            startIndex = knownEnd;
+            continue;
         }
-        
-        if (result.location != NSNotFound) {
-            return NSMakeRange(cellIndex, 1);
+        if (backwards && MBTableGridBitmapContains(_searchedCells, endIndex - 1)) {
+            uint64_t unknown = MBTableGridBitmapPreviousNonMember(_searchedCells, endIndex);
+            NSUInteger knownStart = (unknown == MBTableGridBitmapNotFound) ? startIndex : MAX(unknown + 1, startIndex);
+            uint64_t cellIndex = MBTableGridBitmapPreviousMember(_matchingCells, endIndex);
+            if (cellIndex != MBTableGridBitmapNotFound && cellIndex >= knownStart)
+                return NSMakeRange(cellIndex, 1);
+            endIndex = knownStart;
+            continue;
         }
-        
-        /* Checking whether to abort is expensive (requires access to main thread),
-         * so don't do it too often */
-        if ((cellIndex % 1000) == 0 && _tableGrid._shouldAbortFindOperation)
+
+        // Search no further than the next cells already searched
+        NSUInteger searchStart = startIndex, searchEnd = endIndex;
+        if (backwards) {
+            uint64_t known = MBTableGridBitmapPreviousMember(_searchedCells, endIndex);
+            if (known != MBTableGridBitmapNotFound && known >= startIndex)
+                searchStart = known + 1;
+        } else {
+            searchEnd = MIN(MBTableGridBitmapNextMember(_searchedCells, startIndex), endIndex);
+        }
+
+        NSRange columnRange, rowRange;
+        MBFindBatch(searchStart, searchEnd, rowCount, backwards, &columnRange, &rowRange);
+        MBTableGridFindBatch *batch = [self _takeReadAheadForColumns:columnRange rows:rowRange];
+        if (batch == nil && (batch = [self _startSearchingColumns:columnRange rows:rowRange rowCount:rowCount]) == nil)
+            break;
+
+        // Fetch the next batch and start on it while this one is matched
+        NSUInteger nextStart = backwards ? searchStart : batch.firstCell + batch.count;
+        NSUInteger nextEnd = backwards ? batch.firstCell : searchEnd;
+        if (nextStart < nextEnd) {
+            NSRange nextColumns, nextRows;
+            MBFindBatch(nextStart, nextEnd, rowCount, backwards, &nextColumns, &nextRows);
+            [self _readAheadColumns:nextColumns rows:nextRows rowCount:rowCount];
+        }
+
+        dispatch_group_wait(batch.group, DISPATCH_TIME_FOREVER);
+        if (![self _recordBatch:batch])
             break;
-        
-        cellIndex++;
     }
     return NSMakeRange(NSNotFound, 0);
 }
 
+- (void)forgetCellsInColumns:(NSIndexSet *)columnIndexes rows:(NSIndexSet *)rowIndexes {
+    NSUInteger rowCount = _tableGrid.numberOfRows;
+    [self _cancelReadAhead];
+    __block BOOL forgotten = (_searchedCells && _matchingCells);
+
+    [columnIndexes enumerateIndexesUsingBlock:^(NSUInteger columnIndex, BOOL *stopColumns) {
+        [rowIndexes enumerateRangesUsingBlock:^(NSRange rowRange, BOOL *stopRows) {
+            uint64_t firstCell = columnIndex * rowCount + rowRange.location;
+            if (!MBTableGridBitmapRemoveRange(_searchedCells, firstCell, rowRange.length) ||
+                !MBTableGridBitmapRemoveRange(_matchingCells, firstCell, rowRange.length))
+                forgotten = NO, *stopRows = *stopColumns = YES;
+        }];
+    }];
+
+    // Failing that, forget everything
+    if (!forgotten && _searchedCells && _matchingCells) {
+        MBTableGridBitmapClear(_searchedCells);
+        MBTableGridBitmapClear(_matchingCells);
+    }
+}
+
+- (void)_prepareToSearchForString:(NSString *)searchString options:(NSStringCompareOptions)options {
+    MBTableGridFindMode mode = (options & NSRegularExpressionSearch) ? MBTableGridFindModeRegularExpression : _tableGrid.findMode;
+    if ([searchString isEqualToString:_searchString] && options == _searchOptions && mode == _searchMode)
+        return;
+    [self _cancelReadAhead];
+
+    _searchString = [searchString copy];
+    _searchOptions = options;
+    _searchMode = mode;
+    MBTableGridBitmapClear(_searchedCells);
+    MBTableGridBitmapClear(_matchingCells);
+    free(_candidates);
+    _candidates = NULL;
+    _hasCandidates = NO;
+
+    // ASCII search strings can be matched byte for byte; anything else is left to NSString
+    MBTableGridFindPatternDestroy(_pattern);
+    _pattern = NULL;
+    [self _destroyRegex];
+    if (mode != MBTableGridFindModeText) {
+        [self _compileRegexForString:searchString mode:mode ignoresCase:(options & NSCaseInsensitiveSearch) != 0];
+    } else if ((options & ~(NSCaseInsensitiveSearch | NSLiteralSearch)) == 0 && [searchString canBeConvertedToEncoding:NSASCIIStringEncoding]) {
+        const char *bytes = searchString.UTF8String;
+        _pattern = MBTableGridFindPatternCreate(bytes, strlen(bytes), (options & NSCaseInsensitiveSearch) != 0);
+    }
+}
+
+- (void)_compileRegexForString:(NSString *)searchString mode:(MBTableGridFindMode)mode ignoresCase:(BOOL)ignoresCase {
+    const char *bytes = searchString.UTF8String;
+    MBTableGridRegexSyntax syntax = (mode == MBTableGridFindModeWildcard) ? MBTableGridRegexSyntaxWildcard : MBTableGridRegexSyntaxRegularExpression;
+    size_t workerCount = MAX(1, NSProcessInfo.processInfo.activeProcessorCount);
+
+    if ((_regex = MBTableGridRegexCreate(bytes, strlen(bytes), syntax, ignoresCase, NULL)) == NULL)
+        return;
+    if ((_matchers[0] = calloc(workerCount, sizeof(MBTableGridRegexMatcher *))) == NULL ||
+        (_matchers[1] = calloc(workerCount, sizeof(MBTableGridRegexMatcher *))) == NULL)
+        return;
+    while (_matcherCount < workerCount) {
+        MBTableGridRegexMatcher *first = MBTableGridRegexMatcherCreate(_regex);
+        MBTableGridRegexMatcher *second = first ? MBTableGridRegexMatcherCreate(_regex) : NULL;
+        if (second == NULL) {
+            MBTableGridRegexMatcherDestroy(first);
+            break;
+        }
+        _matchers[0][_matcherCount] = first;
+        _matchers[1][_matcherCount] = second;
+        _matcherCount++;
+    }
+}
+
+- (void)_destroyRegex {
+    for (NSUInteger set = 0; set < 2; set++) {
+        for (size_t i = 0; i < _matcherCount; i++)
+            MBTableGridRegexMatcherDestroy(_matchers[set][i]);
+        free(_matchers[set]);
+        _matchers[set] = NULL;
+    }
+    _matcherCount = 0;
+    MBTableGridRegexDestroy(_regex);
+    _regex = NULL;
+}
+
+// Looks up the cells that may match, unless the index hasn't changed since last time
+- (BOOL)_loadCandidatesFromIndex:(MBTableGridTrigramIndex *)index {
+    uint64_t generation = MBTableGridTrigramIndexGeneration(index);
+    if (_hasCandidates && generation == _candidateGeneration)
+        return YES;
+
+    free(_candidates);
+    _candidates = NULL;
+    const char *bytes = _searchString.UTF8String;
+    size_t count = MBTableGridTrigramIndexGetCandidates(index, bytes, strlen(bytes), &_candidates);
+    _hasCandidates = (count != MBTableGridTrigramIndexUnusable);
+    _candidateCount = _hasCandidates ? count : 0;
+    _candidateGeneration = generation;
+    return _hasCandidates;
+}
+
+// The position of the first candidate at or after the given cell
+- (size_t)_candidateIndexForCell:(NSUInteger)cellIndex {
+    size_t lower = 0, upper = _candidateCount;
+    while (lower < upper) {
+        size_t middle = lower + (upper - lower) / 2;
+        if (_candidates[middle] < cellIndex)
+            lower = middle + 1;
+        else
+            upper = middle;
+    }
+    return lower;
+}
+
+- (NSRange)_rangeOfCandidatesFrom:(size_t)first to:(size_t)last backwards:(BOOL)backwards rowCount:(NSUInteger)rowCount {
+    for (size_t n = 0; n < last - first; n++) {
+        size_t i = backwards ? last - 1 - n : first + n;
+        if (n % MBTableGridFindChunkSize == MBTableGridFindChunkSize - 1 && _tableGrid._shouldAbortFindOperation)
+            break;
+        if ([self _cellMatches:_candidates[i] rowCount:rowCount])
+            return NSMakeRange(_candidates[i], 1);
+    }
+    return NSMakeRange(NSNotFound, 0);
+}
+
+// Checks a single candidate, which the index may have kept after its text changed
+- (BOOL)_cellMatches:(NSUInteger)cellIndex rowCount:(NSUInteger)rowCount {
+    if (MBTableGridBitmapContains(_searchedCells, cellIndex))
+        return MBTableGridBitmapContains(_matchingCells, cellIndex);
+
+    NSRange columnRange = NSMakeRange(cellIndex / rowCount, 1);
+    NSRange rowRange = NSMakeRange(cellIndex % rowCount, 1);
+
+    if (_tableGrid._providesTypedValues) {
+        MBTableGridValue value;
+        unsigned char match = 0;
+        [_tableGrid _getValues:&value forColumns:columnRange rows:rowRange];
+        MBTableGridFindPatternMarkMatches(_pattern, &value, 1, &match);
+        return match;
+    }
+
+    __strong id value = nil;
+    [_tableGrid _getObjectValues:&value forColumns:columnRange rows:rowRange];
+    if (value == nil || value == MBTableGridPendingValue)
+        return NO;
+    NSString *string = [value isKindOfClass:[NSString class]] ? value : [value description];
+    const char *text = CFStringGetCStringPtr((__bridge CFStringRef)string, kCFStringEncodingUTF8);
+    if (text)
+        return MBTableGridFindPatternSearch(_pattern, text, strlen(text)) != MBTableGridFindNotFound;
+    return [string rangeOfString:_searchString options:_searchOptions].location != NSNotFound;
+}
+
+// Fetches a block of cells on this thread, since data sources needn't be thread-safe,
+// with its strings copied so that the batch owns them, and starts matching it in chunks
+// on a background queue, each worker taking the next chunk as it finishes the last.
+// Returns nil if out of memory.
+- (MBTableGridFindBatch *)_startSearchingColumns:(NSRange)columnRange rows:(NSRange)rowRange rowCount:(NSUInteger)rowCount {
+    MBTableGridFindBatch *batch = [[MBTableGridFindBatch alloc] initWithColumns:columnRange rows:rowRange rowCount:rowCount];
+    if (batch == nil)
+        return nil;
+
+    // Objects are described here too, since they come from the data source
+    MBTableGrid *tableGrid = _tableGrid;
+    MBTableGridValue *values = batch.values;
+    NSUInteger count = batch.count;
+    if (tableGrid._providesTypedValues) {
+        [tableGrid _getValues:values forColumns:columnRange rows:rowRange];
+        batch.strings = MBTableGridValuesCopyStrings(values, count);
+    } else {
+        batch.strings = [tableGrid _stringsDescribingObjectValues:values forColumns:columnRange rows:rowRange ofDataSourceRows:NULL];
+    }
+    if (batch.strings == NULL)
+        return nil;
+
+    size_t chunkCount = (count + MBTableGridFindChunkSize - 1) / MBTableGridFindChunkSize;
+    size_t workerCount = MIN(chunkCount, _regex ? _matcherCount : MAX(1, NSProcessInfo.processInfo.activeProcessorCount));
+    dispatch_queue_t queue = dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0);
+    unsigned char *matches = batch.matches;
+    atomic_bool *token = batch.cancellation;
+    MBTableGridFindPattern *pattern = _pattern;
+    MBTableGridRegexMatcher **matchers = _regex ? _matchers[_nextMatcherSet] : NULL;
+    NSString *searchString = _searchString;
+    NSStringCompareOptions options = _searchOptions;
+    _nextMatcherSet ^= 1;
+
+    dispatch_group_async(batch.group, queue, ^{
+        // The chunk counter lives on this block's stack frame, which outlasts dispatch_apply
+        atomic_size_t nextChunk = 0;
+        atomic_size_t *chunkCounter = &nextChunk;
+
+        dispatch_apply(workerCount, queue, ^(size_t worker) {
+            MBTableGridRegexMatcher *matcher = matchers ? matchers[worker] : NULL;
+            size_t chunk;
+            while (!atomic_load(token) && (chunk = atomic_fetch_add(chunkCounter, 1)) < chunkCount) {
+                size_t start = chunk * MBTableGridFindChunkSize;
+                size_t length = MIN(MBTableGridFindChunkSize, count - start);
+
+                if (matcher) {
+                    MBTableGridRegexMatcherMarkMatches(matcher, values + start, length, matches + start);
+                } else if (pattern) {
+                    MBTableGridFindPatternMarkMatches(pattern, values + start, length, matches + start);
+                } else {
+                    for (size_t i = start; i < start + length; i++) {
+                        if (values[i].type == MBTableGridValueTypeEmpty || values[i].type == MBTableGridValueTypePending)
+                            continue;
+
+                        // Search the formatted text in place rather than copying it into a new string
+                        char scratch[MBTableGridValueFormatCapacity];
+                        size_t textLength = 0;
+                        const char *text = MBTableGridValueGetUTF8(&values[i], scratch, &textLength);
+                        CFStringRef string = CFStringCreateWithBytesNoCopy(kCFAllocatorDefault, (const UInt8 *)text, textLength,
+                                                                           kCFStringEncodingUTF8, false, kCFAllocatorNull);
+                        if (string == NULL)
+                            continue;
+                        matches[i] = [(__bridge NSString *)string rangeOfString:searchString options:options].location != NSNotFound;
+                        CFRelease(string);
+                    }
+                }
+
+                if (tableGrid._shouldAbortFindOperation)
+                    atomic_store(token, true);
+            }
+        });
+    });
+    return batch;
+}
+
+// Starts on the batch after the one being searched, replacing any other, and has its
+// results posted back to this thread when it finishes, unless it's taken over first
+- (void)_readAheadColumns:(NSRange)columnRange rows:(NSRange)rowRange rowCount:(NSUInteger)rowCount {
+    [self _cancelReadAhead];
+    MBTableGridFindBatch *batch = [self _startSearchingColumns:columnRange rows:rowRange rowCount:rowCount];
+    if (batch == nil)
+        return;
+    _readAhead = batch;
+    dispatch_group_notify(batch.group, dispatch_get_main_queue(), ^{
+        if (self->_readAhead != batch)
+            return;
+        self->_readAhead = nil;
+        [self _recordBatch:batch];
+    });
+}
+
+// Hands over the batch read ahead if it's the one wanted, and otherwise abandons it
+- (MBTableGridFindBatch *)_takeReadAheadForColumns:(NSRange)columnRange rows:(NSRange)rowRange {
+    MBTableGridFindBatch *batch = _readAhead;
+    if (batch && NSEqualRanges(batch.columns, columnRange) && NSEqualRanges(batch.rows, rowRange)) {
+        _readAhead = nil;
+        return batch;
+    }
+    [self _cancelReadAhead];
+    return nil;
+}
+
+// Stops the batch read ahead, waiting for its workers, which share this string's
+// pattern and matchers, to finish their chunks
+- (void)_cancelReadAhead {
+    MBTableGridFindBatch *batch = _readAhead;
+    if (batch == nil)
+        return;
+    _readAhead = nil;
+    atomic_store(batch.cancellation, true);
+    dispatch_group_wait(batch.group, DISPATCH_TIME_FOREVER);
+}
+
+// Records the matches of a finished batch and marks its cells searched. Returns NO if
+// the search was abandoned, or its results couldn't be recorded.
+- (BOOL)_recordBatch:(MBTableGridFindBatch *)batch {
+    if (atomic_load(batch.cancellation))
+        return NO;
+    return MBTableGridBitmapAssignBytes(_matchingCells, batch.firstCell, batch.matches, batch.count) &&
+           MBTableGridBitmapAddRange(_searchedCells, batch.firstCell, batch.count);
+}
+
 @end
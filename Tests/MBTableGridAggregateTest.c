@@ -0,0 +1,175 @@
+//
+//  MBTableGridAggregateTest.c
+//  MBTableGrid
+//
+//  Created by agent on 10/17/26.
+//
+//  Checks the summaries of an MBTableGridAggregateIndex against summaries
+//  of the cells added up one by one, through edits, growing, and shrinking
+//  to a partial last block, and checks that only partial blocks are read.
+//
+
+#include "MBTableGridAggregate.h"
+#include "MBTableGridTest.h"
+
+#include <math.h>
+#include <string.h>
+
+#define MBMaximumRows 5000
+
+typedef struct MBColumn {
+    MBTableGridValue values[MBMaximumRows];
+    size_t rowCount;
+    size_t readRowCount;
+    bool fails;
+} MBColumn;
+
+static MBColumn MBCells;
+
+static bool MBReadCells(void *context, size_t firstRow, size_t count, MBTableGridValue *values) {
+    MBColumn *column = context;
+    MBTestCheck(firstRow + count <= column->rowCount);
+    if (column->fails)
+        return false;
+    memcpy(values, column->values + firstRow, count * sizeof(MBTableGridValue));
+    column->readRowCount += count;
+    return true;
+}
+
+// Halves and small integers, so that sums are exact in any order
+static MBTableGridValue MBRandomValue(void) {
+    switch (MBTestRandomIndex(8)) {
+        case 0:
+        case 1:
+            return MBTableGridValueMakeInteger((int64_t)MBTestRandomIndex(2001) - 1000);
+        case 2:
+        case 3:
+            return MBTableGridValueMakeDouble((double)((int64_t)MBTestRandomIndex(4001) - 2000) / 2.0);
+        case 4:
+            return MBTableGridValueMakeString("text", 4);
+        case 5:
+            return MBTableGridValueMakeDate(86400.0 * (double)MBTestRandomIndex(100));
+        case 6:
+            return MBTableGridValueMakePending();
+        default: {
+            MBTableGridValue value = { MBTableGridValueTypeEmpty, { 0 } };
+            return value;
+        }
+    }
+}
+
+static bool MBAggregatesAreEqual(const MBTableGridAggregate *a, const MBTableGridAggregate *b) {
+    return a->count == b->count && a->numberCount == b->numberCount && a->pendingCount == b->pendingCount &&
+           a->sum == b->sum && a->minimum == b->minimum && a->maximum == b->maximum;
+}
+
+static void MBCheckRange(const MBTableGridAggregateIndex *index, size_t firstRow, size_t count) {
+    MBTableGridAggregate expected = MBTableGridAggregateMakeEmpty();
+    if (firstRow < MBCells.rowCount)
+        MBTableGridAggregateAddValues(&expected, MBCells.values + firstRow,
+                                      count < MBCells.rowCount - firstRow ? count : MBCells.rowCount - firstRow);
+
+    MBTableGridAggregate aggregate = MBTableGridAggregateMakeEmpty();
+    MBTestCheck(MBTableGridAggregateIndexSummarize(index, firstRow, count, MBReadCells, &MBCells, &aggregate));
+    MBTestCheck(MBAggregatesAreEqual(&aggregate, &expected));
+}
+
+static void MBCheckIndex(const MBTableGridAggregateIndex *index) {
+    size_t rowCount = MBCells.rowCount;
+    MBTestCheck(MBTableGridAggregateIndexRowCount(index) == rowCount);
+    MBCheckRange(index, 0, rowCount);
+    MBCheckRange(index, 0, SIZE_MAX);
+    if (rowCount == 0)
+        return;
+
+    // Runs within a block, across block boundaries, and to the partial last block
+    MBCheckRange(index, rowCount - 1, 1);
+    MBCheckRange(index, rowCount - 1, 10);
+    MBCheckRange(index, rowCount / 2, rowCount);
+    for (size_t boundary = MBTableGridAggregateBlockSize; boundary < rowCount; boundary += MBTableGridAggregateBlockSize) {
+        MBCheckRange(index, boundary, rowCount - boundary);
+        MBCheckRange(index, boundary - 1, 2);
+        MBCheckRange(index, 0, boundary);
+    }
+    for (size_t check = 0; check < 200; check++) {
+        size_t firstRow = MBTestRandomIndex(rowCount);
+        MBCheckRange(index, firstRow, 1 + MBTestRandomIndex(rowCount - firstRow));
+    }
+}
+
+static void MBSetRowCount(MBTableGridAggregateIndex *index, size_t rowCount) {
+    for (size_t row = MBCells.rowCount; row < rowCount; row++)
+        MBCells.values[row] = MBRandomValue();
+    size_t oldRowCount = MBCells.rowCount;
+    MBCells.rowCount = rowCount;
+    MBTestCheck(MBTableGridAggregateIndexSetRowCount(index, rowCount));
+
+    // Added rows are empty until updated, and after shrinking the last block
+    // may still count rows that are gone
+    if (rowCount > oldRowCount)
+        MBTestCheck(MBTableGridAggregateIndexUpdate(index, oldRowCount, rowCount - oldRowCount, MBReadCells, &MBCells));
+    else if (rowCount > 0)
+        MBTestCheck(MBTableGridAggregateIndexUpdate(index, rowCount - 1, 1, MBReadCells, &MBCells));
+}
+
+int main(void) {
+    // A partial last block from the start
+    MBCells.rowCount = 1000;
+    for (size_t row = 0; row < MBCells.rowCount; row++)
+        MBCells.values[row] = MBRandomValue();
+    MBTableGridAggregateIndex *index = MBTableGridAggregateIndexCreate(MBCells.rowCount);
+    MBTestCheck(index != NULL);
+    MBTestCheck(MBTableGridAggregateIndexUpdate(index, 0, MBCells.rowCount, MBReadCells, &MBCells));
+    MBCheckIndex(index);
+
+    // Single edits, and runs of them
+    for (size_t edit = 0; edit < 100; edit++) {
+        size_t row = MBTestRandomIndex(MBCells.rowCount);
+        size_t count = (edit % 4 == 0) ? 1 + MBTestRandomIndex(300) : 1;
+        for (size_t i = row; i < row + count && i < MBCells.rowCount; i++)
+            MBCells.values[i] = MBRandomValue();
+        MBTestCheck(MBTableGridAggregateIndexUpdate(index, row, count, MBReadCells, &MBCells));
+        if (edit % 10 == 0)
+            MBCheckIndex(index);
+    }
+    MBCheckIndex(index);
+
+    // Growing within the same number of leaves and past it, then shrinking
+    // to partial last blocks, down to nothing and back
+    static const size_t MBRowCounts[] = { 1020, 1024, 1025, MBMaximumRows, 3000, 700, 129, 128, 100, 0, 300 };
+    for (size_t i = 0; i < sizeof(MBRowCounts) / sizeof(MBRowCounts[0]); i++) {
+        MBSetRowCount(index, MBRowCounts[i]);
+        MBCheckIndex(index);
+    }
+
+    // Rows added are empty until updated, even where rows were removed before
+    MBSetRowCount(index, 1000);
+    MBSetRowCount(index, 600);
+    MBTestCheck(MBTableGridAggregateIndexSetRowCount(index, 1000));
+    for (size_t row = 600; row < 1000; row++)
+        memset(&MBCells.values[row], 0, sizeof(MBTableGridValue));
+    MBCells.rowCount = 1000;
+    MBCheckIndex(index);
+
+    // Whole blocks come from the tree, so only the partial blocks at the
+    // ends are read
+    MBSetRowCount(index, MBMaximumRows);
+    MBCells.readRowCount = 0;
+    MBCheckRange(index, 100, MBMaximumRows - 200);
+    MBTestCheck(MBCells.readRowCount < 2 * MBTableGridAggregateBlockSize);
+
+    // A failing read is reported
+    MBCells.fails = true;
+    MBTableGridAggregate aggregate = MBTableGridAggregateMakeEmpty();
+    MBTestCheck(!MBTableGridAggregateIndexSummarize(index, 1, 10, MBReadCells, &MBCells, &aggregate));
+    MBTestCheck(!MBTableGridAggregateIndexUpdate(index, 0, 10, MBReadCells, &MBCells));
+    MBCells.fails = false;
+
+    MBTestCheck(isnan(MBTableGridAggregateAverage(&aggregate)));
+    MBTableGridValue values[] = { MBTableGridValueMakeInteger(1), MBTableGridValueMakeDouble(2.5), MBTableGridValueMakeBoolean(true) };
+    MBTableGridAggregateAddValues(&aggregate, values, 3);
+    MBTestCheck(aggregate.count == 3 && aggregate.numberCount == 2 && MBTableGridAggregateAverage(&aggregate) == 1.75);
+
+    MBTableGridAggregateIndexDestroy(index);
+    return MBTestExitStatus();
+}
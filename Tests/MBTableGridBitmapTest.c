@@ -0,0 +1,75 @@
+//
+//  MBTableGridBitmapTest.c
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+//  Checks membership, cardinality and neighbour searches against a plain
+//  array of flags, across ranges that cross container boundaries.
+//
+
+#include "MBTableGridBitmap.h"
+#include "MBTableGridTest.h"
+
+#include <string.h>
+
+#define MBNumberCount 300000
+
+static unsigned char MBMembers[MBNumberCount];
+
+static void MBCheckAgainstFlags(const MBTableGridBitmap *bitmap) {
+    uint64_t cardinality = 0;
+    for (size_t i = 0; i < MBNumberCount; i++)
+        cardinality += MBMembers[i];
+    MBTestCheck(MBTableGridBitmapCardinality(bitmap) == cardinality);
+    for (size_t i = 0; i < MBNumberCount; i += 997) {
+        MBTestCheck(MBTableGridBitmapContains(bitmap, i) == MBMembers[i]);
+        size_t next = i, nextNon = i;
+        while (next < MBNumberCount && !MBMembers[next])
+            next++;
+        while (nextNon < MBNumberCount && MBMembers[nextNon])
+            nextNon++;
+        MBTestCheck(MBTableGridBitmapNextMember(bitmap, i) == (next < MBNumberCount ? next : MBTableGridBitmapNotFound));
+        MBTestCheck(MBTableGridBitmapNextNonMember(bitmap, i) == nextNon);
+        size_t previous = i;
+        while (previous > 0 && !MBMembers[previous - 1])
+            previous--;
+        MBTestCheck(MBTableGridBitmapPreviousMember(bitmap, i) == (previous > 0 ? previous - 1 : MBTableGridBitmapNotFound));
+    }
+}
+
+int main(void) {
+    MBTableGridBitmap *bitmap = MBTableGridBitmapCreate();
+    MBTestCheck(bitmap != NULL);
+    MBCheckAgainstFlags(bitmap);
+
+    // Runs long enough to fill containers, and ranges that straddle them
+    MBTestCheck(MBTableGridBitmapAddRange(bitmap, 1000, 140000));
+    memset(MBMembers + 1000, 1, 140000);
+    MBTestCheck(MBTableGridBitmapRemoveRange(bitmap, 65530, 12));
+    memset(MBMembers + 65530, 0, 12);
+    MBCheckAgainstFlags(bitmap);
+
+    for (size_t change = 0; change < 500; change++) {
+        size_t location = MBTestRandomIndex(MBNumberCount - 2000), length = 1 + MBTestRandomIndex(2000);
+        bool adds = MBTestRandom() & 1;
+        MBTestCheck(adds ? MBTableGridBitmapAddRange(bitmap, location, length)
+                         : MBTableGridBitmapRemoveRange(bitmap, location, length));
+        memset(MBMembers + location, adds, length);
+    }
+    MBCheckAgainstFlags(bitmap);
+
+    unsigned char bytes[5000];
+    for (size_t i = 0; i < sizeof(bytes); i++)
+        bytes[i] = MBTestRandom() & 1;
+    MBTestCheck(MBTableGridBitmapAssignBytes(bitmap, 63000, bytes, sizeof(bytes)));
+    memcpy(MBMembers + 63000, bytes, sizeof(bytes));
+    MBCheckAgainstFlags(bitmap);
+
+    MBTableGridBitmapClear(bitmap);
+    memset(MBMembers, 0, sizeof(MBMembers));
+    MBCheckAgainstFlags(bitmap);
+
+    MBTableGridBitmapDestroy(bitmap);
+    return MBTestExitStatus();
+}
@@ -0,0 +1,400 @@
+//
+//  MBTableGridColumnStoreTest.c
+//  MBTableGrid
+//
+//  Created by agent on 10/17/26.
+//
+//  Checks the column store against a plain array of cells through random
+//  inserts, removals, moves and writes, then checks arena compaction, the
+//  conversions between value and column types, and writes of values
+//  borrowed from the store itself.
+//
+
+#include "MBTableGridColumnStore.h"
+#include "MBTableGridTest.h"
+
+#include <string.h>
+
+#define MBMaximumRows 200
+#define MBMaximumColumns 12
+#define MBMaximumTextLength 24
+
+typedef struct MBModelCell {
+    bool isPresent;
+    int64_t integer;
+    double number;
+    char text[MBMaximumTextLength];
+    size_t length;
+} MBModelCell;
+
+typedef struct MBModelColumn {
+    MBTableGridColumnType type;
+    MBModelCell cells[MBMaximumRows];
+} MBModelColumn;
+
+static MBModelColumn MBColumns[MBMaximumColumns];
+static size_t MBColumnCount = 0;
+static size_t MBRowCount = 0;
+
+static void MBCheckAgainstModel(const MBTableGridColumnStore *store) {
+    MBTestCheck(MBTableGridColumnStoreColumnCount(store) == MBColumnCount);
+    MBTestCheck(MBTableGridColumnStoreRowCount(store) == MBRowCount);
+    if (MBColumnCount == 0 || MBRowCount == 0)
+        return;
+
+    MBTableGridValue *values = malloc(MBColumnCount * MBRowCount * sizeof(MBTableGridValue));
+    MBTableGridColumnStoreGetValues(store, values, 0, MBColumnCount, 0, MBRowCount);
+    for (size_t i = 0; i < MBColumnCount; i++) {
+        MBTestCheck(MBTableGridColumnStoreColumnType(store, i) == MBColumns[i].type);
+        for (size_t j = 0; j < MBRowCount; j++) {
+            const MBModelCell *cell = &MBColumns[i].cells[j];
+            const MBTableGridValue *value = &values[i * MBRowCount + j];
+            if (!cell->isPresent) {
+                MBTestCheck(value->type == MBTableGridValueTypeEmpty);
+                continue;
+            }
+            switch (MBColumns[i].type) {
+                case MBTableGridColumnTypeInteger:
+                    MBTestCheck(value->type == MBTableGridValueTypeInteger && value->data.integer == cell->integer);
+                    break;
+                case MBTableGridColumnTypeDouble:
+                    MBTestCheck(value->type == MBTableGridValueTypeDouble && value->data.number == cell->number);
+                    break;
+                case MBTableGridColumnTypeDate:
+                    MBTestCheck(value->type == MBTableGridValueTypeDate && value->data.number == cell->number);
+                    break;
+                case MBTableGridColumnTypeString:
+                    MBTestCheck(value->type == MBTableGridValueTypeString && value->data.string.length == cell->length &&
+                                memcmp(value->data.string.bytes, cell->text, cell->length) == 0);
+                    break;
+            }
+        }
+    }
+    free(values);
+}
+
+// Makes a random value of the column's own kind, or an empty one, and the
+// model cell it should become
+static MBTableGridValue MBRandomValue(MBTableGridColumnType type, MBModelCell *cell) {
+    memset(cell, 0, sizeof(MBModelCell));
+    if (MBTestRandomIndex(6) == 0)
+        return (MBTableGridValue){ MBTableGridValueTypeEmpty, { 0 } };
+
+    cell->isPresent = true;
+    switch (type) {
+        case MBTableGridColumnTypeInteger:
+            cell->integer = (int64_t)(MBTestRandom() >> 2) - ((int64_t)1 << 61);
+            return MBTableGridValueMakeInteger(cell->integer);
+        case MBTableGridColumnTypeDouble:
+            cell->number = (double)MBTestRandomIndex(1000000) / 64.0 - 5000.0;
+            return MBTableGridValueMakeDouble(cell->number);
+        case MBTableGridColumnTypeDate:
+            cell->number = (double)MBTestRandomIndex(4000000000u);
+            return MBTableGridValueMakeDate(cell->number);
+        case MBTableGridColumnTypeString:
+            cell->length = 1 + MBTestRandomIndex(MBMaximumTextLength - 1);
+            for (size_t i = 0; i < cell->length; i++)
+                cell->text[i] = (char)('a' + MBTestRandomIndex(26));
+            return MBTableGridValueMakeString(cell->text, cell->length);
+    }
+    return (MBTableGridValue){ MBTableGridValueTypeEmpty, { 0 } };
+}
+
+// Picks between one and maximumCount distinct indexes below count, in order
+static size_t MBRandomIndexes(size_t *indexes, size_t count, size_t maximumCount) {
+    size_t picked = 0;
+    size_t wanted = 1 + MBTestRandomIndex(maximumCount < count ? maximumCount : count);
+    for (size_t i = 0; i < count && picked < wanted; i++) {
+        if (MBTestRandomIndex(count - i) < wanted - picked)
+            indexes[picked++] = i;
+    }
+    return picked;
+}
+
+// Where moved items end up, following the drag convention documented in
+// MBTableGridColumnStoreMoveColumns
+static size_t MBMovedLocation(const size_t *indexes, size_t count, size_t destination) {
+    if (destination > indexes[count - 1])
+        return destination - count;
+    if (destination >= indexes[0])
+        return indexes[0];
+    return destination;
+}
+
+// Applies a removal or move to a plain array of elements of the given size
+static void MBModelMove(void *elements, size_t elementSize, size_t elementCount, const size_t *indexes, size_t count,
+                        bool removes, size_t destination) {
+    unsigned char *bytes = elements;
+    unsigned char *moved = malloc(count * elementSize);
+    unsigned char *kept = malloc(elementCount * elementSize);
+    size_t keptCount = 0, next = 0;
+    for (size_t i = 0; i < elementCount; i++) {
+        if (next < count && indexes[next] == i)
+            memcpy(moved + next++ * elementSize, bytes + i * elementSize, elementSize);
+        else
+            memcpy(kept + keptCount++ * elementSize, bytes + i * elementSize, elementSize);
+    }
+    if (removes) {
+        memcpy(bytes, kept, keptCount * elementSize);
+    } else {
+        size_t location = MBMovedLocation(indexes, count, destination);
+        memcpy(bytes, kept, location * elementSize);
+        memcpy(bytes + location * elementSize, moved, count * elementSize);
+        memcpy(bytes + (location + count) * elementSize, kept + location * elementSize, (keptCount - location) * elementSize);
+    }
+    free(moved);
+    free(kept);
+}
+
+static void MBModelMoveRows(const size_t *rows, size_t count, bool removes, size_t destination) {
+    for (size_t i = 0; i < MBColumnCount; i++)
+        MBModelMove(MBColumns[i].cells, sizeof(MBModelCell), MBRowCount, rows, count, removes, destination);
+    if (removes) {
+        MBRowCount -= count;
+        for (size_t i = 0; i < MBColumnCount; i++)
+            memset(&MBColumns[i].cells[MBRowCount], 0, count * sizeof(MBModelCell));
+    }
+}
+
+static void MBCheckRandomChanges(void) {
+    MBTableGridColumnStore *store = MBTableGridColumnStoreCreate();
+    MBTestCheck(store != NULL);
+    MBCheckAgainstModel(store);
+
+    size_t indexes[MBMaximumRows];
+    for (size_t change = 0; change < 3000; change++) {
+        switch (MBTestRandomIndex(10)) {
+            case 0: {
+                size_t count = MBTestRandomIndex(MBMaximumRows - MBRowCount < 24 ? MBMaximumRows - MBRowCount + 1 : 24);
+                size_t row = MBTestRandomIndex(MBRowCount + 1);
+                MBTestCheck(MBTableGridColumnStoreInsertRows(store, row, count));
+                for (size_t i = 0; i < MBColumnCount; i++) {
+                    memmove(&MBColumns[i].cells[row + count], &MBColumns[i].cells[row], (MBRowCount - row) * sizeof(MBModelCell));
+                    memset(&MBColumns[i].cells[row], 0, count * sizeof(MBModelCell));
+                }
+                MBRowCount += count;
+                break;
+            }
+            case 1: {
+                if (MBRowCount == 0)
+                    break;
+                size_t count = MBRandomIndexes(indexes, MBRowCount, 16);
+                MBTableGridColumnStoreRemoveRows(store, indexes, count);
+                MBModelMoveRows(indexes, count, true, 0);
+                break;
+            }
+            case 2: {
+                if (MBRowCount == 0)
+                    break;
+                size_t count = MBRandomIndexes(indexes, MBRowCount, 16);
+                size_t destination = MBTestRandomIndex(MBRowCount + 1);
+                MBTestCheck(MBTableGridColumnStoreMoveRows(store, indexes, count, destination) == MBMovedLocation(indexes, count, destination));
+                MBModelMoveRows(indexes, count, false, destination);
+                break;
+            }
+            case 3: {
+                if (MBColumnCount == MBMaximumColumns)
+                    break;
+                size_t count = 1 + MBTestRandomIndex(MBMaximumColumns - MBColumnCount < 3 ? MBMaximumColumns - MBColumnCount : 3);
+                size_t column = MBTestRandomIndex(MBColumnCount + 1);
+                MBTableGridColumnType type = (MBTableGridColumnType)MBTestRandomIndex(4);
+                MBTestCheck(MBTableGridColumnStoreInsertColumns(store, column, count, type));
+                memmove(&MBColumns[column + count], &MBColumns[column], (MBColumnCount - column) * sizeof(MBModelColumn));
+                for (size_t i = column; i < column + count; i++) {
+                    memset(&MBColumns[i], 0, sizeof(MBModelColumn));
+                    MBColumns[i].type = type;
+                }
+                MBColumnCount += count;
+                break;
+            }
+            case 4: {
+                if (MBColumnCount < 2)
+                    break;
+                size_t count = MBRandomIndexes(indexes, MBColumnCount, MBColumnCount - 1);
+                MBTableGridColumnStoreRemoveColumns(store, indexes, count);
+                MBModelMove(MBColumns, sizeof(MBModelColumn), MBColumnCount, indexes, count, true, 0);
+                MBColumnCount -= count;
+                break;
+            }
+            case 5: {
+                if (MBColumnCount == 0)
+                    break;
+                size_t count = MBRandomIndexes(indexes, MBColumnCount, 4);
+                size_t destination = MBTestRandomIndex(MBColumnCount + 1);
+                MBTestCheck(MBTableGridColumnStoreMoveColumns(store, indexes, count, destination) == MBMovedLocation(indexes, count, destination));
+                MBModelMove(MBColumns, sizeof(MBModelColumn), MBColumnCount, indexes, count, false, destination);
+                break;
+            }
+            default: {
+                if (MBColumnCount == 0 || MBRowCount == 0)
+                    break;
+                for (size_t write = 0; write < 20; write++) {
+                    size_t column = MBTestRandomIndex(MBColumnCount), row = MBTestRandomIndex(MBRowCount);
+                    MBTableGridValue value = MBRandomValue(MBColumns[column].type, &MBColumns[column].cells[row]);
+                    MBTestCheck(MBTableGridColumnStoreSetValue(store, column, row, &value));
+                }
+                break;
+            }
+        }
+        if (change % 50 == 0)
+            MBCheckAgainstModel(store);
+    }
+    MBCheckAgainstModel(store);
+    MBTableGridColumnStoreDestroy(store);
+}
+
+static void MBCheckCompaction(void) {
+    MBTableGridColumnStore *store = MBTableGridColumnStoreCreate();
+    MBTestCheck(MBTableGridColumnStoreInsertColumns(store, 0, 1, MBTableGridColumnTypeString));
+    MBTestCheck(MBTableGridColumnStoreInsertRows(store, 0, 64));
+
+    // Overwriting the same cells over and over leaves only garbage behind,
+    // which compaction must reclaim without disturbing the live text
+    char text[MBMaximumTextLength + 1];
+    size_t peakByteCount = 0;
+    for (size_t write = 0; write < 20000; write++) {
+        size_t row = write % 64;
+        int length = snprintf(text, sizeof(text), "cell %zu written %zu", row, write);
+        MBTableGridValue value = MBTableGridValueMakeString(text, (size_t)length);
+        MBTestCheck(MBTableGridColumnStoreSetValue(store, 0, row, &value));
+        size_t byteCount = MBTableGridColumnStoreByteCount(store);
+        if (byteCount > peakByteCount)
+            peakByteCount = byteCount;
+    }
+    MBTestCheck(peakByteCount < 64 * 1024);
+
+    MBTableGridValue values[64];
+    MBTableGridColumnStoreGetValues(store, values, 0, 1, 0, 64);
+    for (size_t row = 0; row < 64; row++) {
+        int length = snprintf(text, sizeof(text), "cell %zu written %zu", row, 19999 - (19999 - row) % 64);
+        MBTestCheck(values[row].type == MBTableGridValueTypeString && values[row].data.string.length == (size_t)length &&
+                    memcmp(values[row].data.string.bytes, text, (size_t)length) == 0);
+    }
+    MBTableGridColumnStoreDestroy(store);
+}
+
+static void MBCheckCoercion(void) {
+    enum { MBInteger, MBDouble, MBDate, MBString };
+    MBTableGridColumnStore *store = MBTableGridColumnStoreCreate();
+    MBTestCheck(MBTableGridColumnStoreInsertColumns(store, 0, 1, MBTableGridColumnTypeString));
+    MBTestCheck(MBTableGridColumnStoreInsertColumns(store, 0, 1, MBTableGridColumnTypeDate));
+    MBTestCheck(MBTableGridColumnStoreInsertColumns(store, 0, 1, MBTableGridColumnTypeDouble));
+    MBTestCheck(MBTableGridColumnStoreInsertColumns(store, 0, 1, MBTableGridColumnTypeInteger));
+    MBTestCheck(MBTableGridColumnStoreInsertRows(store, 0, 1));
+    MBTableGridValue value, stored;
+
+    // Integer columns take whole numbers, in whatever form
+    value = MBTableGridValueMakeDouble(3.0);
+    MBTestCheck(MBTableGridColumnStoreSetValue(store, MBInteger, 0, &value));
+    MBTableGridColumnStoreGetValues(store, &stored, MBInteger, 1, 0, 1);
+    MBTestCheck(stored.type == MBTableGridValueTypeInteger && stored.data.integer == 3);
+    value = MBTableGridValueMakeString(" 42 ", 4);
+    MBTestCheck(MBTableGridColumnStoreSetValue(store, MBInteger, 0, &value));
+    MBTableGridColumnStoreGetValues(store, &stored, MBInteger, 1, 0, 1);
+    MBTestCheck(stored.type == MBTableGridValueTypeInteger && stored.data.integer == 42);
+    value = MBTableGridValueMakeString("1e6", 3);
+    MBTestCheck(MBTableGridColumnStoreSetValue(store, MBInteger, 0, &value));
+    MBTableGridColumnStoreGetValues(store, &stored, MBInteger, 1, 0, 1);
+    MBTestCheck(stored.type == MBTableGridValueTypeInteger && stored.data.integer == 1000000);
+    value = MBTableGridValueMakeBoolean(true);
+    MBTestCheck(MBTableGridColumnStoreSetValue(store, MBInteger, 0, &value));
+    MBTableGridColumnStoreGetValues(store, &stored, MBInteger, 1, 0, 1);
+    MBTestCheck(stored.type == MBTableGridValueTypeInteger && stored.data.integer == 1);
+
+    // Anything else is refused, leaving the cell as it was
+    value = MBTableGridValueMakeDouble(2.5);
+    MBTestCheck(!MBTableGridColumnStoreSetValue(store, MBInteger, 0, &value));
+    value = MBTableGridValueMakeDouble(1e19);
+    MBTestCheck(!MBTableGridColumnStoreSetValue(store, MBInteger, 0, &value));
+    value = MBTableGridValueMakeString("forty-two", 9);
+    MBTestCheck(!MBTableGridColumnStoreSetValue(store, MBInteger, 0, &value));
+    MBTableGridColumnStoreGetValues(store, &stored, MBInteger, 1, 0, 1);
+    MBTestCheck(stored.type == MBTableGridValueTypeInteger && stored.data.integer == 1);
+
+    // Double columns parse numbers but refuse dates
+    value = MBTableGridValueMakeString("2.5", 3);
+    MBTestCheck(MBTableGridColumnStoreSetValue(store, MBDouble, 0, &value));
+    MBTableGridColumnStoreGetValues(store, &stored, MBDouble, 1, 0, 1);
+    MBTestCheck(stored.type == MBTableGridValueTypeDouble && stored.data.number == 2.5);
+    value = MBTableGridValueMakeDate(86400.0);
+    MBTestCheck(!MBTableGridColumnStoreSetValue(store, MBDouble, 0, &value));
+
+    // Date columns parse ISO dates but refuse booleans
+    value = MBTableGridValueMakeString("2026-10-16", 10);
+    MBTestCheck(MBTableGridColumnStoreSetValue(store, MBDate, 0, &value));
+    MBTableGridColumnStoreGetValues(store, &stored, MBDate, 1, 0, 1);
+    MBTestCheck(stored.type == MBTableGridValueTypeDate && stored.data.number == 1792108800.0);
+    value = MBTableGridValueMakeString("2.5", 3);
+    MBTestCheck(!MBTableGridColumnStoreSetValue(store, MBDate, 0, &value));
+    value = MBTableGridValueMakeBoolean(false);
+    MBTestCheck(!MBTableGridColumnStoreSetValue(store, MBDate, 0, &value));
+
+    // String columns take anything, as text
+    value = MBTableGridValueMakeInteger(-17);
+    MBTestCheck(MBTableGridColumnStoreSetValue(store, MBString, 0, &value));
+    MBTableGridColumnStoreGetValues(store, &stored, MBString, 1, 0, 1);
+    MBTestCheck(stored.type == MBTableGridValueTypeString && stored.data.string.length == 3 &&
+                memcmp(stored.data.string.bytes, "-17", 3) == 0);
+    value = MBTableGridValueMakeBoolean(true);
+    MBTestCheck(MBTableGridColumnStoreSetValue(store, MBString, 0, &value));
+    MBTableGridColumnStoreGetValues(store, &stored, MBString, 1, 0, 1);
+    MBTestCheck(stored.type == MBTableGridValueTypeString && stored.data.string.length == 4 &&
+                memcmp(stored.data.string.bytes, "TRUE", 4) == 0);
+
+    // Empty and pending values clear the cell
+    value = MBTableGridValueMakePending();
+    MBTestCheck(MBTableGridColumnStoreSetValue(store, MBString, 0, &value));
+    MBTableGridColumnStoreGetValues(store, &stored, MBString, 1, 0, 1);
+    MBTestCheck(stored.type == MBTableGridValueTypeEmpty);
+    MBTableGridColumnStoreDestroy(store);
+}
+
+static void MBCheckBorrowedValues(void) {
+    MBTableGridColumnStore *store = MBTableGridColumnStoreCreate();
+    MBColumnCount = 0;
+    MBRowCount = 0;
+    MBTestCheck(MBTableGridColumnStoreInsertColumns(store, 0, 3, MBTableGridColumnTypeString));
+    MBTestCheck(MBTableGridColumnStoreInsertColumns(store, 1, 1, MBTableGridColumnTypeInteger));
+    MBTestCheck(MBTableGridColumnStoreInsertRows(store, 0, MBMaximumRows));
+    MBColumnCount = 4;
+    MBRowCount = MBMaximumRows;
+    memset(MBColumns, 0, sizeof(MBColumns));
+    for (size_t i = 0; i < MBColumnCount; i++)
+        MBColumns[i].type = i == 1 ? MBTableGridColumnTypeInteger : MBTableGridColumnTypeString;
+    for (size_t i = 0; i < MBColumnCount; i++) {
+        for (size_t j = 0; j < MBRowCount; j++) {
+            MBTableGridValue value = MBRandomValue(MBColumns[i].type, &MBColumns[i].cells[j]);
+            MBTestCheck(MBTableGridColumnStoreSetValue(store, i, j, &value));
+        }
+    }
+
+    // Copy blocks over overlapping blocks of the same columns, straight
+    // from the store's own cells, so that the writes grow and compact the
+    // arenas the values point into
+    MBTableGridValue values[MBMaximumColumns * MBMaximumRows];
+    MBModelCell cells[MBMaximumRows];
+    for (size_t copy = 0; copy < 300; copy++) {
+        size_t column = MBTestRandomIndex(MBColumnCount);
+        size_t columnCount = 1 + MBTestRandomIndex(MBColumnCount - column);
+        size_t rowCount = 1 + MBTestRandomIndex(MBRowCount);
+        size_t from = MBTestRandomIndex(MBRowCount - rowCount + 1), to = MBTestRandomIndex(MBRowCount - rowCount + 1);
+        MBTableGridColumnStoreGetValues(store, values, column, columnCount, from, rowCount);
+        MBTestCheck(MBTableGridColumnStoreSetValues(store, values, column, columnCount, to, rowCount) == 0);
+        for (size_t i = column; i < column + columnCount; i++) {
+            memcpy(cells, &MBColumns[i].cells[from], rowCount * sizeof(MBModelCell));
+            memcpy(&MBColumns[i].cells[to], cells, rowCount * sizeof(MBModelCell));
+        }
+        if (copy % 20 == 0)
+            MBCheckAgainstModel(store);
+    }
+    MBCheckAgainstModel(store);
+    MBTableGridColumnStoreDestroy(store);
+}
+
+int main(void) {
+    MBCheckRandomChanges();
+    MBCheckCompaction();
+    MBCheckCoercion();
+    MBCheckBorrowedValues();
+    return MBTestExitStatus();
+}
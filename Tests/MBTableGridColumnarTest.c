@@ -0,0 +1,333 @@
+//
+//  MBTableGridColumnarTest.c
+//  MBTableGrid
+//
+//  Created by agent on 10/17/26.
+//
+//  Writes row groups with MBTableGridColumnarWriter and decodes them with a
+//  plain reader written from the format described in its header, which must
+//  give back every value as it was written: typed, mixed, all-empty and
+//  Boolean chunks, with and without empty cells.
+//
+
+#include "MBTableGridColumnarWriter.h"
+#include "MBTableGridTest.h"
+
+#include <math.h>
+#include <string.h>
+
+#define MBColumnCount 8
+#define MBMaximumRows 700
+
+typedef struct MBOutput {
+    unsigned char *bytes;
+    size_t length;
+    size_t capacity;
+} MBOutput;
+
+static bool MBAppendOutput(void *context, const char *bytes, size_t length) {
+    MBOutput *output = context;
+    if (output->capacity - output->length < length) {
+        size_t capacity = output->capacity ? output->capacity : 4096;
+        while (capacity - output->length < length)
+            capacity *= 2;
+        unsigned char *grown = realloc(output->bytes, capacity);
+        if (grown == NULL)
+            return false;
+        output->bytes = grown;
+        output->capacity = capacity;
+    }
+    memcpy(output->bytes + output->length, bytes, length);
+    output->length += length;
+    return true;
+}
+
+static bool MBRefuseOutput(void *context, const char *bytes, size_t length) {
+    (void)context;
+    (void)bytes;
+    (void)length;
+    return false;
+}
+
+typedef struct MBReader {
+    const unsigned char *bytes;
+    size_t length;
+    size_t offset;
+} MBReader;
+
+static unsigned char MBReadByte(MBReader *reader) {
+    MBTestCheck(reader->offset < reader->length);
+    return reader->offset < reader->length ? reader->bytes[reader->offset++] : 0;
+}
+
+static uint64_t MBReadVarint(MBReader *reader) {
+    uint64_t number = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        unsigned char byte = MBReadByte(reader);
+        number |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return number;
+    }
+    MBTestCheck(!"varint longer than ten bytes");
+    return number;
+}
+
+static int64_t MBReadZigzag(MBReader *reader) {
+    uint64_t number = MBReadVarint(reader);
+    return (int64_t)(number >> 1) ^ -(int64_t)(number & 1);
+}
+
+static double MBReadDouble(MBReader *reader) {
+    uint64_t bits = 0;
+    for (unsigned i = 0; i < 8; i++)
+        bits |= (uint64_t)MBReadByte(reader) << (8 * i);
+    double number;
+    memcpy(&number, &bits, sizeof(number));
+    return number;
+}
+
+static const unsigned char *MBReadBytes(MBReader *reader, size_t length) {
+    MBTestCheck(reader->length - reader->offset >= length);
+    if (reader->length - reader->offset < length)
+        return NULL;
+    reader->offset += length;
+    return reader->bytes + reader->offset - length;
+}
+
+static MBTableGridValue MBReadValue(MBReader *reader, int type, int64_t *previous) {
+    MBTableGridValue value = { MBTableGridValueTypeEmpty, { 0 } };
+    bool typed = (type != MBTableGridColumnarMixedType);
+    value.type = typed ? (MBTableGridValueType)type : (MBTableGridValueType)MBReadByte(reader);
+    switch (value.type) {
+        case MBTableGridValueTypeInteger:
+            if (typed) {
+                *previous = (int64_t)((uint64_t)*previous + (uint64_t)MBReadZigzag(reader));
+                value.data.integer = *previous;
+            } else {
+                value.data.integer = MBReadZigzag(reader);
+            }
+            break;
+        case MBTableGridValueTypeDouble:
+        case MBTableGridValueTypeDate:
+            value.data.number = MBReadDouble(reader);
+            break;
+        case MBTableGridValueTypeBoolean:
+            MBTestCheck(!typed);
+            value.data.boolean = MBReadByte(reader);
+            break;
+        case MBTableGridValueTypeString:
+            value.data.string.length = MBReadVarint(reader);
+            value.data.string.bytes = (const char *)MBReadBytes(reader, value.data.string.length);
+            break;
+        default:
+            MBTestCheck(!"unexpected value type");
+            break;
+    }
+    return value;
+}
+
+// Decodes one chunk of rowCount cells into values, returning its type byte
+static int MBReadChunk(MBReader *reader, MBTableGridValue *values, size_t rowCount) {
+    int type = MBReadByte(reader);
+    unsigned char flags = MBReadByte(reader);
+    uint64_t chunkLength = MBReadVarint(reader);
+    size_t end = reader->offset + chunkLength;
+    MBTestCheck(flags <= 1);
+    MBTestCheck(end <= reader->length);
+
+    const unsigned char *present = (flags & 1) ? MBReadBytes(reader, (rowCount + 7) / 8) : NULL;
+    size_t presentCount = 0;
+    for (size_t i = 0; i < rowCount; i++)
+        presentCount += present == NULL || ((present[i / 8] >> (i % 8)) & 1);
+    if (type == MBTableGridValueTypeEmpty)
+        MBTestCheck(presentCount == 0);
+
+    const unsigned char *booleans = NULL;
+    if (type == MBTableGridValueTypeBoolean)
+        booleans = MBReadBytes(reader, (presentCount + 7) / 8);
+
+    int64_t previous = 0;
+    size_t count = 0;
+    for (size_t i = 0; i < rowCount; i++) {
+        MBTableGridValue value = { MBTableGridValueTypeEmpty, { 0 } };
+        if (present == NULL || ((present[i / 8] >> (i % 8)) & 1)) {
+            if (booleans) {
+                value.type = MBTableGridValueTypeBoolean;
+                value.data.boolean = (booleans[count / 8] >> (count % 8)) & 1;
+            } else {
+                value = MBReadValue(reader, type, &previous);
+            }
+            count++;
+        }
+        values[i] = value;
+    }
+    MBTestCheck(reader->offset == end);
+    reader->offset = end;
+    return type;
+}
+
+static bool MBValuesAreEqual(const MBTableGridValue *written, const MBTableGridValue *read) {
+    if (written->type == MBTableGridValueTypeEmpty || written->type == MBTableGridValueTypePending)
+        return read->type == MBTableGridValueTypeEmpty;
+    if (written->type != read->type)
+        return false;
+    switch (written->type) {
+        case MBTableGridValueTypeInteger:
+            return written->data.integer == read->data.integer;
+        case MBTableGridValueTypeDouble:
+        case MBTableGridValueTypeDate:
+            return memcmp(&written->data.number, &read->data.number, sizeof(double)) == 0;
+        case MBTableGridValueTypeBoolean:
+            return written->data.boolean == read->data.boolean;
+        case MBTableGridValueTypeString:
+            return written->data.string.length == read->data.string.length &&
+                   memcmp(written->data.string.bytes, read->data.string.bytes, written->data.string.length) == 0;
+        default:
+            return false;
+    }
+}
+
+static const char *const MBStrings[] = { "", "a", "ünïcødé", "a longer string, with punctuation", "\n\t" };
+
+static MBTableGridValue MBRandomValue(MBTableGridValueType type) {
+    switch (type) {
+        case MBTableGridValueTypeInteger: {
+            // Near zero, and at the ends of the range, for wrapping deltas
+            static const int64_t MBIntegers[] = { 0, 1, -1, INT64_MAX, INT64_MIN, 300, -300 };
+            if (MBTestRandom() & 1)
+                return MBTableGridValueMakeInteger(MBIntegers[MBTestRandomIndex(sizeof(MBIntegers) / sizeof(MBIntegers[0]))]);
+            return MBTableGridValueMakeInteger((int64_t)MBTestRandom());
+        }
+        case MBTableGridValueTypeDouble: {
+            static const double MBDoubles[] = { 0.0, -0.0, 1.5, -1e300, INFINITY, NAN };
+            return MBTableGridValueMakeDouble(MBDoubles[MBTestRandomIndex(sizeof(MBDoubles) / sizeof(MBDoubles[0]))]);
+        }
+        case MBTableGridValueTypeBoolean:
+            return MBTableGridValueMakeBoolean(MBTestRandom() & 1);
+        case MBTableGridValueTypeString: {
+            const char *string = MBStrings[MBTestRandomIndex(sizeof(MBStrings) / sizeof(MBStrings[0]))];
+            return MBTableGridValueMakeString(string, strlen(string));
+        }
+        case MBTableGridValueTypePending:
+            return MBTableGridValueMakePending();
+        case MBTableGridValueTypeDate:
+            return MBTableGridValueMakeDate((double)MBTestRandomIndex(4000000000u));
+        default: {
+            MBTableGridValue value = { MBTableGridValueTypeEmpty, { 0 } };
+            return value;
+        }
+    }
+}
+
+// The kinds of column in each row group, with the chunk type each should be
+// written as: typed with and without empty cells, Boolean, mixed, all-empty
+typedef struct MBColumnKind {
+    MBTableGridValueType type;
+    bool hasEmpty;
+    bool isMixed;
+    int chunkType;
+} MBColumnKind;
+
+static const MBColumnKind MBColumnKinds[MBColumnCount] = {
+    { MBTableGridValueTypeInteger, false, false, MBTableGridValueTypeInteger },
+    { MBTableGridValueTypeInteger, true, false, MBTableGridValueTypeInteger },
+    { MBTableGridValueTypeDouble, true, false, MBTableGridValueTypeDouble },
+    { MBTableGridValueTypeString, true, false, MBTableGridValueTypeString },
+    { MBTableGridValueTypeBoolean, false, false, MBTableGridValueTypeBoolean },
+    { MBTableGridValueTypeBoolean, true, false, MBTableGridValueTypeBoolean },
+    { MBTableGridValueTypeEmpty, true, true, MBTableGridColumnarMixedType },
+    { MBTableGridValueTypeEmpty, true, false, MBTableGridValueTypeEmpty },
+};
+
+static void MBFillColumn(MBTableGridValue *values, size_t rowCount, const MBColumnKind *kind) {
+    for (size_t i = 0; i < rowCount; i++) {
+        MBTableGridValueType type = kind->type;
+        if (kind->isMixed)
+            type = (MBTableGridValueType)MBTestRandomIndex(MBTableGridValueTypeDate + 1);
+        else if (kind->hasEmpty && (i == rowCount / 2 || MBTestRandomIndex(4) == 0))
+            type = (MBTestRandom() & 1) ? MBTableGridValueTypePending : MBTableGridValueTypeEmpty;
+        values[i] = MBRandomValue(type);
+    }
+    // Make sure mixed columns hold more than one type
+    if (kind->isMixed && rowCount >= 2) {
+        values[0] = MBRandomValue(MBTableGridValueTypeBoolean);
+        values[1] = MBRandomValue(MBTableGridValueTypeInteger);
+    }
+}
+
+static void MBTestRoundTrip(void) {
+    static const char *const MBNames[MBColumnCount] = { "id", "delta", "number", "name", "flag", "maybe", "mixed", "" };
+    size_t nameLengths[MBColumnCount];
+    for (size_t j = 0; j < MBColumnCount; j++)
+        nameLengths[j] = strlen(MBNames[j]);
+
+    MBOutput output = { NULL, 0, 0 };
+    MBTableGridColumnarWriter *writer = MBTableGridColumnarWriterCreate(MBColumnCount, MBNames, nameLengths, MBAppendOutput, &output);
+    MBTestCheck(writer != NULL);
+
+    // Row counts that do and don't fill the last byte of a bitmap
+    static const size_t MBRowCounts[] = { 1, 8, 9, 64, 333, MBMaximumRows };
+    size_t groupCount = sizeof(MBRowCounts) / sizeof(MBRowCounts[0]);
+    MBTableGridValue *groups[sizeof(MBRowCounts) / sizeof(MBRowCounts[0])];
+    size_t totalRowCount = 0;
+    for (size_t g = 0; g < groupCount; g++) {
+        size_t rowCount = MBRowCounts[g];
+        groups[g] = malloc(MBColumnCount * rowCount * sizeof(MBTableGridValue));
+        for (size_t j = 0; j < MBColumnCount; j++)
+            MBFillColumn(groups[g] + j * rowCount, rowCount, &MBColumnKinds[j]);
+        MBTestCheck(MBTableGridColumnarWriterWriteValues(writer, groups[g], rowCount));
+        MBTestCheck(MBTableGridColumnarWriterWriteValues(writer, groups[g], 0));
+        totalRowCount += rowCount;
+    }
+    MBTestCheck(MBTableGridColumnarWriterFinish(writer));
+    MBTestCheck(!MBTableGridColumnarWriterWriteValues(writer, groups[0], 1));
+    MBTestCheck(MBTableGridColumnarWriterBytesWritten(writer) == output.length);
+    MBTableGridColumnarWriterDestroy(writer);
+
+    MBReader reader = { output.bytes, output.length, 0 };
+    const unsigned char *magic = MBReadBytes(&reader, 8);
+    MBTestCheck(magic && memcmp(magic, "MBTGCOL\x01", 8) == 0);
+    MBTestCheck(MBReadVarint(&reader) == MBColumnCount);
+    for (size_t j = 0; j < MBColumnCount; j++) {
+        uint64_t length = MBReadVarint(&reader);
+        const unsigned char *name = MBReadBytes(&reader, length);
+        MBTestCheck(length == nameLengths[j] && (length == 0 || memcmp(name, MBNames[j], length) == 0));
+    }
+
+    MBTableGridValue read[MBMaximumRows];
+    for (size_t g = 0; g < groupCount; g++) {
+        size_t rowCount = MBRowCounts[g];
+        MBTestCheck(MBReadVarint(&reader) == rowCount);
+        for (size_t j = 0; j < MBColumnCount; j++) {
+            const MBTableGridValue *written = groups[g] + j * rowCount;
+            int type = MBReadChunk(&reader, read, rowCount);
+            // A group of one can't have both values and empty cells
+            if (rowCount > 1)
+                MBTestCheck(type == MBColumnKinds[j].chunkType);
+            for (size_t i = 0; i < rowCount; i++)
+                MBTestCheck(MBValuesAreEqual(&written[i], &read[i]));
+        }
+        free(groups[g]);
+    }
+    MBTestCheck(MBReadVarint(&reader) == 0);
+    MBTestCheck(MBReadVarint(&reader) == totalRowCount);
+    MBTestCheck(reader.offset == reader.length);
+    free(output.bytes);
+}
+
+static void MBTestFailedOutput(void) {
+    MBTableGridColumnarWriter *writer = MBTableGridColumnarWriterCreate(1, NULL, NULL, MBRefuseOutput, NULL);
+    MBTestCheck(writer != NULL);
+    MBTableGridValue value = MBTableGridValueMakeInteger(1);
+    MBTestCheck(!MBTableGridColumnarWriterWriteValues(writer, &value, 1));
+    MBTestCheck(!MBTableGridColumnarWriterWriteValues(writer, &value, 1));
+    MBTestCheck(!MBTableGridColumnarWriterFinish(writer));
+    MBTestCheck(MBTableGridColumnarWriterBytesWritten(writer) == 0);
+    MBTableGridColumnarWriterDestroy(writer);
+}
+
+int main(void) {
+    MBTestRoundTrip();
+    MBTestFailedOutput();
+    return MBTestExitStatus();
+}
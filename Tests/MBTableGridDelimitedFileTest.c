@@ -0,0 +1,109 @@
+//
+//  MBTableGridDelimitedFileTest.c
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+//  Indexes a file with quoted fields, line breaks inside quotes and doubled
+//  quotes, split into chunks of many sizes so that chunks start inside
+//  quoted fields and in the middle of CRLFs, and checks every field against
+//  MBTableGridDelimitedTable's reading of the same text.
+//
+
+#include "MBTableGridDelimitedFile.h"
+#include "MBTableGridDelimitedReader.h"
+#include "MBTableGridTest.h"
+
+#include <string.h>
+
+#define MBRecordCount 2000
+
+static size_t MBMakeText(char *text) {
+    static const char *const fields[] = { "12", "plain", "\"a,b\"", "\"two\r\nlines\"", "\"say \"\"hi\"\"\"", "", "3.5" };
+    size_t length = 0, fieldCount = sizeof(fields) / sizeof(fields[0]);
+    for (size_t record = 0; record < MBRecordCount; record++) {
+        size_t columns = 2 + record % 4;
+        for (size_t column = 0; column < columns; column++) {
+            const char *field = fields[(record * 3 + column) % fieldCount];
+            if (column)
+                text[length++] = ',';
+            memcpy(text + length, field, strlen(field));
+            length += strlen(field);
+        }
+        text[length++] = '\r';
+        text[length++] = '\n';
+    }
+    return length;
+}
+
+// Indexes spans of spanLength bytes, each split into chunkCount chunks, as the data
+// source does on several threads
+static MBTableGridDelimitedFile *MBIndexFile(const char *path, size_t spanLength, size_t chunkCount) {
+    MBTableGridDelimitedFile *file = MBTableGridDelimitedFileOpen(path);
+    MBTestCheck(file != NULL);
+    MBTestCheck(MBTableGridDelimitedFileFormat(file) == MBTableGridDelimitedFormatCommaSeparated);
+    size_t length = MBTableGridDelimitedFileLength(file);
+    MBTableGridDelimitedFileChunk chunks[16];
+    while (!MBTableGridDelimitedFileIsIndexed(file)) {
+        size_t start = MBTableGridDelimitedFileIndexedLength(file);
+        size_t end = (length - start < spanLength) ? length : start + spanLength;
+        memset(chunks, 0, sizeof(chunks));
+        for (size_t i = 0; i < chunkCount; i++) {
+            chunks[i].start = start + (end - start) * i / chunkCount;
+            chunks[i].end = start + (end - start) * (i + 1) / chunkCount;
+            MBTableGridDelimitedFileCountQuotes(file, &chunks[i]);
+        }
+        MBTableGridDelimitedFileResolveQuotes(file, chunks, chunkCount);
+        for (size_t i = 0; i < chunkCount; i++)
+            MBTestCheck(MBTableGridDelimitedFileScanChunk(file, &chunks[i]));
+        if (!MBTableGridDelimitedFileAppendChunks(file, chunks, chunkCount)) {
+            MBTestCheck(false);
+            break;
+        }
+    }
+    return file;
+}
+
+int main(void) {
+    char *text = malloc(MBRecordCount * 80);
+    size_t length = MBMakeText(text);
+    char path[] = "/tmp/MBTableGridDelimitedFileTest.XXXXXX";
+    int descriptor = mkstemp(path);
+    MBTestCheck(descriptor >= 0);
+    FILE *stream = fdopen(descriptor, "wb");
+    MBTestCheck(stream && fwrite(text, 1, length, stream) == length);
+    fclose(stream);
+
+    MBTableGridDelimitedTable *table = MBTableGridDelimitedTableCreate(text, length, MBTableGridDelimitedFormatCommaSeparated);
+    size_t rowCount = MBTableGridDelimitedTableRowCount(table), columnCount = MBTableGridDelimitedTableColumnCount(table);
+    MBTestCheck(rowCount == MBRecordCount && columnCount == 5);
+
+    const size_t spanLengths[] = { 7, 64, 1000, 65536, length };
+    const size_t chunkCounts[] = { 1, 3, 16 };
+    MBTableGridDelimitedFileBuffer *buffer = MBTableGridDelimitedFileBufferCreate();
+    for (size_t i = 0; i < sizeof(spanLengths) / sizeof(spanLengths[0]); i++) {
+        for (size_t j = 0; j < sizeof(chunkCounts) / sizeof(chunkCounts[0]); j++) {
+            if (spanLengths[i] < chunkCounts[j])
+                continue;
+            MBTableGridDelimitedFile *file = MBIndexFile(path, spanLengths[i], chunkCounts[j]);
+            MBTestCheck(MBTableGridDelimitedFileRecordCount(file) == rowCount);
+            MBTestCheck(MBTableGridDelimitedFileColumnCount(file) == columnCount);
+            for (size_t row = 0; row < rowCount; row++) {
+                for (size_t column = 0; column < columnCount; column++) {
+                    size_t expectedLength = 0, fieldLength = 0;
+                    const char *expected = MBTableGridDelimitedTableGetField(table, column, row, &expectedLength);
+                    const char *field = MBTableGridDelimitedFileGetField(file, buffer, column, row, &fieldLength);
+                    MBTestCheck(field && fieldLength == expectedLength &&
+                                (fieldLength == 0 || memcmp(field, expected, fieldLength) == 0));
+                }
+            }
+            MBTableGridDelimitedFileClose(file);
+        }
+    }
+
+    MBTableGridDelimitedFileBufferDestroy(buffer);
+    MBTableGridDelimitedTableDestroy(table);
+    remove(path);
+    free(text);
+    return MBTestExitStatus();
+}
@@ -0,0 +1,130 @@
+//
+//  MBTableGridDelimitedTest.c
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+//  Writes fields that need quoting with MBTableGridDelimitedWriter, in both
+//  formats, and reads them back with MBTableGridDelimitedTable, which must
+//  give back every field as it was written.
+//
+
+#include "MBTableGridDelimitedWriter.h"
+#include "MBTableGridDelimitedReader.h"
+#include "MBTableGridTest.h"
+
+#include <string.h>
+
+#define MBColumnCount 4
+#define MBRowCount 500
+
+typedef struct MBOutput {
+    char *bytes;
+    size_t length;
+    size_t capacity;
+} MBOutput;
+
+static bool MBAppendOutput(void *context, const char *bytes, size_t length) {
+    MBOutput *output = context;
+    if (output->capacity - output->length < length) {
+        size_t capacity = output->capacity ? output->capacity : 4096;
+        while (capacity - output->length < length)
+            capacity *= 2;
+        char *grown = realloc(output->bytes, capacity);
+        if (grown == NULL)
+            return false;
+        output->bytes = grown;
+        output->capacity = capacity;
+    }
+    memcpy(output->bytes + output->length, bytes, length);
+    output->length += length;
+    return true;
+}
+
+static const char *const MBFieldPieces[] = { "plain", "a,b", "tab\there", "say \"hi\"", "line\nbreak", "crlf\r\nend", "\"", "" };
+
+// The field at a cell, made of pieces that need quoting in one format or the other
+static size_t MBMakeField(char *field, size_t column, size_t row) {
+    size_t length = 0, pieceCount = sizeof(MBFieldPieces) / sizeof(MBFieldPieces[0]);
+    for (size_t i = 0; i < 1 + (row + column) % 3; i++) {
+        const char *piece = MBFieldPieces[(row * 5 + column * 3 + i) % pieceCount];
+        memcpy(field + length, piece, strlen(piece));
+        length += strlen(piece);
+    }
+    return length;
+}
+
+static void MBTestRoundTrip(MBTableGridDelimitedFormat format, bool terminatesRecords) {
+    MBOutput output = { NULL, 0, 0 };
+    MBTableGridDelimitedWriter *writer = MBTableGridDelimitedWriterCreate(format, terminatesRecords, MBAppendOutput, &output);
+    MBTestCheck(writer != NULL);
+    char field[64];
+    for (size_t row = 0; row < MBRowCount; row++) {
+        for (size_t column = 0; column < MBColumnCount; column++) {
+            // Keep the first field of each record non-empty, so no record is blank
+            size_t length = MBMakeField(field, column, row);
+            if (column == 0)
+                field[length++] = 'x';
+            MBTestCheck(MBTableGridDelimitedWriterWriteField(writer, field, length));
+        }
+        MBTestCheck(MBTableGridDelimitedWriterEndRecord(writer));
+    }
+    MBTestCheck(MBTableGridDelimitedWriterFlush(writer));
+    MBTestCheck(MBTableGridDelimitedWriterBytesWritten(writer) == output.length);
+    MBTableGridDelimitedWriterDestroy(writer);
+
+    MBTableGridDelimitedTable *table = MBTableGridDelimitedTableCreate(output.bytes, output.length, format);
+    MBTestCheck(table != NULL);
+    MBTestCheck(MBTableGridDelimitedTableRowCount(table) == MBRowCount);
+    MBTestCheck(MBTableGridDelimitedTableColumnCount(table) == MBColumnCount);
+    for (size_t row = 0; row < MBRowCount; row++) {
+        for (size_t column = 0; column < MBColumnCount; column++) {
+            size_t expectedLength = MBMakeField(field, column, row), length = 0;
+            if (column == 0)
+                field[expectedLength++] = 'x';
+            const char *bytes = MBTableGridDelimitedTableGetField(table, column, row, &length);
+            MBTestCheck(length == expectedLength && (length == 0 || memcmp(bytes, field, length) == 0));
+        }
+    }
+    MBTableGridDelimitedTableDestroy(table);
+    free(output.bytes);
+}
+
+// Typed values come back typed, through the columns' guessed types
+static void MBTestValues(void) {
+    MBTableGridValue values[3 * 2] = {
+        MBTableGridValueMakeInteger(42), MBTableGridValueMakeInteger(-7),
+        MBTableGridValueMakeDouble(2.5), MBTableGridValueMakeDouble(-0.125),
+        MBTableGridValueMakeString("x,y", 3), MBTableGridValueMakeString("", 0),
+    };
+    MBOutput output = { NULL, 0, 0 };
+    MBTableGridDelimitedWriter *writer = MBTableGridDelimitedWriterCreate(MBTableGridDelimitedFormatCommaSeparated, true,
+                                                                          MBAppendOutput, &output);
+    MBTestCheck(MBTableGridDelimitedWriterWriteValues(writer, values, 3, 2));
+    MBTestCheck(MBTableGridDelimitedWriterFlush(writer));
+    MBTableGridDelimitedWriterDestroy(writer);
+
+    MBTableGridDelimitedTable *table = MBTableGridDelimitedTableCreate(output.bytes, output.length,
+                                                                       MBTableGridDelimitedFormatGuess(output.bytes, output.length));
+    MBTestCheck(MBTableGridDelimitedTableRowCount(table) == 2 && MBTableGridDelimitedTableColumnCount(table) == 3);
+    MBTestCheck(MBTableGridDelimitedTableColumnType(table, 0) == MBTableGridValueTypeInteger);
+    MBTestCheck(MBTableGridDelimitedTableColumnType(table, 1) == MBTableGridValueTypeDouble);
+    MBTableGridValue read[3 * 2];
+    MBTableGridDelimitedTableGetValues(table, read, 0, 3, 0, 2);
+    MBTestCheck(read[0].data.integer == 42 && read[1].data.integer == -7);
+    MBTestCheck(read[2].data.number == 2.5 && read[3].data.number == -0.125);
+    MBTestCheck(read[4].type == MBTableGridValueTypeString && read[4].data.string.length == 3 &&
+                memcmp(read[4].data.string.bytes, "x,y", 3) == 0);
+    MBTestCheck(read[5].type == MBTableGridValueTypeEmpty);
+    MBTableGridDelimitedTableDestroy(table);
+    free(output.bytes);
+}
+
+int main(void) {
+    MBTestRoundTrip(MBTableGridDelimitedFormatTabSeparated, false);
+    MBTestRoundTrip(MBTableGridDelimitedFormatTabSeparated, true);
+    MBTestRoundTrip(MBTableGridDelimitedFormatCommaSeparated, false);
+    MBTestRoundTrip(MBTableGridDelimitedFormatCommaSeparated, true);
+    MBTestValues();
+    return MBTestExitStatus();
+}
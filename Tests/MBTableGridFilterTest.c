@@ -0,0 +1,233 @@
+//
+//  MBTableGridFilterTest.c
+//  MBTableGrid
+//
+//  Created by agent on 10/17/26.
+//
+//  Checks each kind of condition, alone, negated and one after another,
+//  against a plain cell-by-cell reference, over values of every type with
+//  pending and empty cells among them.
+//
+
+#include "MBTableGridFilter.h"
+#include "MBTableGridTest.h"
+
+#include <math.h>
+#include <string.h>
+
+#define MBValueCount 3000
+
+typedef enum MBKind {
+    MBKindEquals,
+    MBKindRange,
+    MBKindContains,
+    MBKindIsEmpty,
+    MBKindNegation
+} MBKind;
+
+typedef struct MBCondition {
+    MBKind kind;
+    MBTableGridValue value;
+    bool ignoresCase;
+    double minimum;
+    double maximum;
+    const char *text;
+    const struct MBCondition *negated;
+} MBCondition;
+
+static MBTableGridFilterCondition *MBCreate(const MBCondition *condition) {
+    switch (condition->kind) {
+        case MBKindEquals:
+            return MBTableGridFilterConditionCreateEquals(&condition->value, condition->ignoresCase);
+        case MBKindRange:
+            return MBTableGridFilterConditionCreateRange(condition->minimum, condition->maximum);
+        case MBKindContains:
+            return MBTableGridFilterConditionCreateContains(condition->text, strlen(condition->text), condition->ignoresCase);
+        case MBKindIsEmpty:
+            return MBTableGridFilterConditionCreateIsEmpty();
+        case MBKindNegation:
+            return MBTableGridFilterConditionCreateNegation(MBCreate(condition->negated));
+    }
+    return NULL;
+}
+
+static unsigned char MBFold(unsigned char c, bool ignoresCase) {
+    return (ignoresCase && c >= 'A' && c <= 'Z') ? (unsigned char)(c | 0x20) : c;
+}
+
+static bool MBHasBytesAt(const char *text, const char *bytes, size_t length, bool ignoresCase) {
+    for (size_t i = 0; i < length; i++) {
+        if (MBFold((unsigned char)text[i], ignoresCase) != MBFold((unsigned char)bytes[i], ignoresCase))
+            return false;
+    }
+    return true;
+}
+
+static bool MBReferenceEquals(const MBTableGridValue *wanted, bool ignoresCase, const MBTableGridValue *value) {
+    switch (wanted->type) {
+        case MBTableGridValueTypeInteger:
+            if (value->type == MBTableGridValueTypeInteger)
+                return value->data.integer == wanted->data.integer;
+            return value->type == MBTableGridValueTypeDouble && value->data.number == (double)wanted->data.integer;
+        case MBTableGridValueTypeDouble:
+            if (value->type == MBTableGridValueTypeInteger)
+                return (double)value->data.integer == wanted->data.number;
+            return value->type == MBTableGridValueTypeDouble && value->data.number == wanted->data.number;
+        case MBTableGridValueTypeDate:
+            return value->type == MBTableGridValueTypeDate && value->data.number == wanted->data.number;
+        case MBTableGridValueTypeBoolean:
+            return value->type == MBTableGridValueTypeBoolean && value->data.boolean == wanted->data.boolean;
+        case MBTableGridValueTypeString:
+            return value->type == MBTableGridValueTypeString && value->data.string.length == wanted->data.string.length &&
+                   MBHasBytesAt(value->data.string.bytes, wanted->data.string.bytes, wanted->data.string.length, ignoresCase);
+        case MBTableGridValueTypeEmpty:
+            return value->type == MBTableGridValueTypeEmpty;
+        default:
+            return false;
+    }
+}
+
+static bool MBReferenceContains(const char *wanted, bool ignoresCase, const MBTableGridValue *value) {
+    if (value->type == MBTableGridValueTypeEmpty)
+        return false;
+    char scratch[MBTableGridValueFormatCapacity];
+    size_t length, wantedLength = strlen(wanted);
+    const char *text = MBTableGridValueGetUTF8(value, scratch, &length);
+    for (size_t i = 0; i + wantedLength <= length; i++) {
+        if (MBHasBytesAt(text + i, wanted, wantedLength, ignoresCase))
+            return true;
+    }
+    return false;
+}
+
+static bool MBReferenceSatisfies(const MBCondition *condition, const MBTableGridValue *value) {
+    if (value->type == MBTableGridValueTypePending)
+        return true;
+    switch (condition->kind) {
+        case MBKindEquals:
+            return MBReferenceEquals(&condition->value, condition->ignoresCase, value);
+        case MBKindRange: {
+            double number;
+            if (value->type == MBTableGridValueTypeInteger)
+                number = (double)value->data.integer;
+            else if (value->type == MBTableGridValueTypeDouble || value->type == MBTableGridValueTypeDate)
+                number = value->data.number;
+            else
+                return false;
+            return number >= condition->minimum && number <= condition->maximum;
+        }
+        case MBKindContains:
+            return MBReferenceContains(condition->text, condition->ignoresCase, value);
+        case MBKindIsEmpty:
+            return value->type == MBTableGridValueTypeEmpty;
+        case MBKindNegation:
+            return !MBReferenceSatisfies(condition->negated, value);
+    }
+    return false;
+}
+
+static const char *const MBStrings[] = { "Apple", "apple", "APPLE pie", "banana", "", "3", "2.5" };
+
+static MBTableGridValue MBRandomValue(void) {
+    static const double MBDoubles[] = { -1.5, 0.0, 2.0, 2.5, 3.0, NAN, INFINITY };
+    switch (MBTestRandomIndex(8)) {
+        case 0:
+            return MBTableGridValueMakeInteger((int64_t)MBTestRandomIndex(7) - 3);
+        case 1:
+            return MBTableGridValueMakeDouble(MBDoubles[MBTestRandomIndex(sizeof(MBDoubles) / sizeof(MBDoubles[0]))]);
+        case 2:
+            return MBTableGridValueMakeDate(86400.0 * (double)MBTestRandomIndex(3));
+        case 3:
+            return MBTableGridValueMakeBoolean(MBTestRandom() & 1);
+        case 4:
+        case 5: {
+            const char *string = MBStrings[MBTestRandomIndex(sizeof(MBStrings) / sizeof(MBStrings[0]))];
+            return MBTableGridValueMakeString(string, strlen(string));
+        }
+        case 6:
+            return MBTableGridValueMakePending();
+        default: {
+            MBTableGridValue value = { MBTableGridValueTypeEmpty, { 0 } };
+            return value;
+        }
+    }
+}
+
+static MBTableGridValue MBValues[MBValueCount];
+static unsigned char MBMatches[MBValueCount];
+
+// Tests second on what first leaves, the way the grid tests one predicate after another
+static void MBCheckConditions(const MBCondition *first, const MBCondition *second) {
+    MBTableGridFilterCondition *firstCondition = MBCreate(first);
+    MBTableGridFilterCondition *secondCondition = second ? MBCreate(second) : NULL;
+    MBTestCheck(firstCondition != NULL && (second == NULL || secondCondition != NULL));
+
+    memset(MBMatches, 1, sizeof(MBMatches));
+    size_t matchCount = MBTableGridFilterConditionMarkMatches(firstCondition, MBValues, MBValueCount, MBMatches);
+    if (secondCondition)
+        matchCount = MBTableGridFilterConditionMarkMatches(secondCondition, MBValues, MBValueCount, MBMatches);
+
+    size_t expectedCount = 0;
+    for (size_t i = 0; i < MBValueCount; i++) {
+        bool expected = MBReferenceSatisfies(first, &MBValues[i]) && (second == NULL || MBReferenceSatisfies(second, &MBValues[i]));
+        MBTestCheck(MBMatches[i] == expected);
+        expectedCount += expected;
+    }
+    MBTestCheck(matchCount == expectedCount);
+    MBTableGridFilterConditionDestroy(firstCondition);
+    MBTableGridFilterConditionDestroy(secondCondition);
+}
+
+int main(void) {
+    for (size_t i = 0; i < MBValueCount; i++)
+        MBValues[i] = MBRandomValue();
+
+    const MBTableGridValue empty = { MBTableGridValueTypeEmpty, { 0 } };
+    const MBCondition conditions[] = {
+        { MBKindEquals, MBTableGridValueMakeInteger(3), false, 0, 0, NULL, NULL },
+        { MBKindEquals, MBTableGridValueMakeInteger(-1), false, 0, 0, NULL, NULL },
+        { MBKindEquals, MBTableGridValueMakeDouble(2.0), false, 0, 0, NULL, NULL },
+        { MBKindEquals, MBTableGridValueMakeDouble(NAN), false, 0, 0, NULL, NULL },
+        { MBKindEquals, MBTableGridValueMakeDate(86400.0), false, 0, 0, NULL, NULL },
+        { MBKindEquals, MBTableGridValueMakeBoolean(true), false, 0, 0, NULL, NULL },
+        { MBKindEquals, MBTableGridValueMakeString("apple", 5), false, 0, 0, NULL, NULL },
+        { MBKindEquals, MBTableGridValueMakeString("apple", 5), true, 0, 0, NULL, NULL },
+        { MBKindEquals, MBTableGridValueMakeString("", 0), false, 0, 0, NULL, NULL },
+        { MBKindEquals, empty, false, 0, 0, NULL, NULL },
+        { MBKindEquals, MBTableGridValueMakePending(), false, 0, 0, NULL, NULL },
+        { MBKindRange, empty, false, -1.0, 2.0, NULL, NULL },
+        { MBKindRange, empty, false, -INFINITY, 0.0, NULL, NULL },
+        { MBKindRange, empty, false, 86400.0, INFINITY, NULL, NULL },
+        { MBKindContains, empty, false, 0, 0, "pp", NULL },
+        { MBKindContains, empty, true, 0, 0, "PP", NULL },
+        { MBKindContains, empty, false, 0, 0, "PP", NULL },
+        { MBKindContains, empty, false, 0, 0, "", NULL },
+        { MBKindContains, empty, false, 0, 0, "2", NULL },
+        { MBKindContains, empty, true, 0, 0, "true", NULL },
+        { MBKindIsEmpty, empty, false, 0, 0, NULL, NULL },
+    };
+    size_t conditionCount = sizeof(conditions) / sizeof(conditions[0]);
+
+    for (size_t i = 0; i < conditionCount; i++) {
+        MBCondition negation = { MBKindNegation, empty, false, 0, 0, NULL, &conditions[i] };
+        MBCondition doubleNegation = { MBKindNegation, empty, false, 0, 0, NULL, &negation };
+        MBCheckConditions(&conditions[i], NULL);
+        MBCheckConditions(&negation, NULL);
+        MBCheckConditions(&doubleNegation, NULL);
+        for (size_t j = 0; j < conditionCount; j++) {
+            MBCondition otherNegation = { MBKindNegation, empty, false, 0, 0, NULL, &conditions[j] };
+            MBCheckConditions(&conditions[i], &conditions[j]);
+            MBCheckConditions(&negation, &otherNegation);
+        }
+    }
+
+    // A pending value is equal to nothing, so only pending values are left
+    MBTableGridValue pending = MBTableGridValueMakePending();
+    MBTableGridFilterCondition *equalsPending = MBTableGridFilterConditionCreateEquals(&pending, false);
+    memset(MBMatches, 1, sizeof(MBMatches));
+    MBTableGridFilterConditionMarkMatches(equalsPending, MBValues, MBValueCount, MBMatches);
+    for (size_t i = 0; i < MBValueCount; i++)
+        MBTestCheck(MBMatches[i] == (MBValues[i].type == MBTableGridValueTypePending));
+    MBTableGridFilterConditionDestroy(equalsPending);
+    return MBTestExitStatus();
+}
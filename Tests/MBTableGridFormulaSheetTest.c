@@ -0,0 +1,149 @@
+//
+//  MBTableGridFormulaSheetTest.c
+//  MBTableGrid
+//
+//  Created by agent on 10/17/26.
+//
+//  Edits the inputs of a sheet of chained formulas and checks that each
+//  incremental recalculation gives what a fresh sheet recalculated in full
+//  gives. Formulas in a cycle, which also read other cells, must get the
+//  cycle error and nothing else.
+//
+
+#include "MBTableGridFormulaSheet.h"
+#include "MBTableGridTest.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define MBRowCount 200
+#define MBInputColumnCount 3
+
+static int64_t MBInputs[MBInputColumnCount][MBRowCount];
+
+static bool MBReadCells(void *context, size_t column, size_t firstRow, size_t count, MBTableGridValue *values) {
+    (void)context;
+    for (size_t i = 0; i < count; i++) {
+        if (column < MBInputColumnCount && firstRow + i < MBRowCount)
+            values[i] = MBTableGridValueMakeInteger(MBInputs[column][firstRow + i]);
+    }
+    return true;
+}
+
+static void MBCountChange(void *context, size_t column, size_t row) {
+    (void)column;
+    (void)row;
+    (*(size_t *)context)++;
+}
+
+// Runs the iterations backwards, so that nothing can depend on their order
+static void MBApplyBackwards(size_t iterations, void *context, MBTableGridSortWorkFunction work) {
+    for (size_t i = iterations; i > 0; i--)
+        work(context, i - 1);
+}
+
+static void MBSetFormula(MBTableGridFormulaSheet *sheet, size_t column, size_t row, const char *text) {
+    MBTestCheck(MBTableGridFormulaSheetSetFormula(sheet, column, row, text, strlen(text)));
+}
+
+// D is A + B * C a row at a time, E the running total of D, F1 the total of E, and F2
+// and F3 depend on each other and on input cells
+static void MBSetFormulas(MBTableGridFormulaSheet *sheet, bool hasCycle) {
+    char text[64];
+    for (size_t row = 0; row < MBRowCount; row++) {
+        snprintf(text, sizeof(text), "=A%zu+B%zu*C%zu", row + 1, row + 1, row + 1);
+        MBSetFormula(sheet, 3, row, text);
+        snprintf(text, sizeof(text), "=SUM(D1:D%zu)", row + 1);
+        MBSetFormula(sheet, 4, row, text);
+    }
+    MBSetFormula(sheet, 5, 0, "=SUM(E1:E200)");
+    if (hasCycle) {
+        MBSetFormula(sheet, 5, 1, "=F3+A1+SUM(B1:C10)");
+        MBSetFormula(sheet, 5, 2, "=F2*2+B5");
+    }
+}
+
+static double MBNumber(const MBTableGridFormulaValue *result) {
+    if (result->value.type == MBTableGridValueTypeInteger)
+        return (double)result->value.data.integer;
+    return result->value.data.number;
+}
+
+static void MBCheckSameResults(const MBTableGridFormulaSheet *sheet, const MBTableGridFormulaSheet *fullSheet) {
+    for (size_t column = 3; column < 6; column++) {
+        for (size_t row = 0; row < MBRowCount; row++) {
+            MBTableGridFormulaValue result, fullResult;
+            bool hasFormula = MBTableGridFormulaSheetGetResult(sheet, column, row, &result);
+            MBTestCheck(hasFormula == MBTableGridFormulaSheetGetResult(fullSheet, column, row, &fullResult));
+            if (!hasFormula)
+                continue;
+            MBTestCheck(result.error == fullResult.error);
+            if (result.error == MBTableGridFormulaErrorNone)
+                MBTestCheck(MBNumber(&result) == MBNumber(&fullResult));
+        }
+    }
+}
+
+static void MBCheckAgainstFullRecalculation(const MBTableGridFormulaSheet *sheet, bool hasCycle) {
+    MBTableGridFormulaSheet *fullSheet = MBTableGridFormulaSheetCreate();
+    MBSetFormulas(fullSheet, hasCycle);
+    MBTestCheck(MBTableGridFormulaSheetRecalculate(fullSheet, MBReadCells, NULL, NULL, NULL));
+    MBCheckSameResults(sheet, fullSheet);
+    MBTableGridFormulaSheetDestroy(fullSheet);
+}
+
+static void MBTestCycle(void) {
+    MBTableGridFormulaSheet *sheet = MBTableGridFormulaSheetCreate();
+    MBSetFormula(sheet, 0, 0, "=B1+C1");
+    MBSetFormula(sheet, 1, 0, "=A1*2");
+    MBTestCheck(MBTableGridFormulaSheetRecalculate(sheet, MBReadCells, NULL, NULL, NULL));
+    MBTableGridFormulaValue result;
+    MBTestCheck(MBTableGridFormulaSheetGetResult(sheet, 0, 0, &result) && result.error == MBTableGridFormulaErrorCycle);
+    MBTestCheck(MBTableGridFormulaSheetGetResult(sheet, 1, 0, &result) && result.error == MBTableGridFormulaErrorCycle);
+
+    // Breaking the cycle evaluates both again
+    MBSetFormula(sheet, 1, 0, "=C1*2");
+    MBTestCheck(MBTableGridFormulaSheetRecalculate(sheet, MBReadCells, NULL, NULL, NULL));
+    MBTestCheck(MBTableGridFormulaSheetGetResult(sheet, 1, 0, &result) && result.error == MBTableGridFormulaErrorNone &&
+                MBNumber(&result) == 2.0 * (double)MBInputs[2][0]);
+    MBTestCheck(MBTableGridFormulaSheetGetResult(sheet, 0, 0, &result) && result.error == MBTableGridFormulaErrorNone &&
+                MBNumber(&result) == 3.0 * (double)MBInputs[2][0]);
+    MBTableGridFormulaSheetDestroy(sheet);
+}
+
+int main(void) {
+    for (size_t column = 0; column < MBInputColumnCount; column++) {
+        for (size_t row = 0; row < MBRowCount; row++)
+            MBInputs[column][row] = (int64_t)MBTestRandomIndex(100);
+    }
+    MBTestCycle();
+
+    for (size_t hasCycle = 0; hasCycle < 2; hasCycle++) {
+        MBTableGridFormulaSheet *sheet = MBTableGridFormulaSheetCreate();
+        MBSetFormulas(sheet, hasCycle);
+        MBTestCheck(MBTableGridFormulaSheetCount(sheet) == 2 * MBRowCount + 1 + 2 * hasCycle);
+        MBTestCheck(MBTableGridFormulaSheetRecalculate(sheet, MBReadCells, NULL, NULL, MBApplyBackwards));
+        MBCheckAgainstFullRecalculation(sheet, hasCycle);
+        if (hasCycle) {
+            MBTableGridFormulaValue result;
+            MBTestCheck(MBTableGridFormulaSheetGetResult(sheet, 5, 1, &result) && result.error == MBTableGridFormulaErrorCycle);
+            MBTestCheck(MBTableGridFormulaSheetGetResult(sheet, 5, 2, &result) && result.error == MBTableGridFormulaErrorCycle);
+        }
+
+        for (size_t edit = 0; edit < 50; edit++) {
+            size_t column = MBTestRandomIndex(MBInputColumnCount), row = MBTestRandomIndex(MBRowCount);
+            MBInputs[column][row] = (int64_t)MBTestRandomIndex(100);
+            MBTableGridFormulaSheetNoteChange(sheet, column, row, 1);
+            size_t changes = 0;
+            MBTestCheck(MBTableGridFormulaSheetRecalculate(sheet, MBReadCells, MBCountChange, &changes, MBApplyBackwards));
+            MBCheckAgainstFullRecalculation(sheet, hasCycle);
+        }
+
+        // Nothing noted, nothing evaluated
+        size_t changes = 0;
+        MBTestCheck(MBTableGridFormulaSheetRecalculate(sheet, MBReadCells, MBCountChange, &changes, NULL));
+        MBTestCheck(changes == 0);
+        MBTableGridFormulaSheetDestroy(sheet);
+    }
+    return MBTestExitStatus();
+}
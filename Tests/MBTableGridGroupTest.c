@@ -0,0 +1,235 @@
+//
+//  MBTableGridGroupTest.c
+//  MBTableGrid
+//
+//  Created by agent on 10/17/26.
+//
+//  Groups batches of keys of every type with an apply function that runs
+//  the chunks out of order, and checks that keys share a group exactly when
+//  they are equal, that groups are numbered as first seen and keep their
+//  numbers, and that per-group summaries match ones added up row by row,
+//  leaving out rows in no group.
+//
+
+#include "MBTableGridGroup.h"
+#include "MBTableGridTest.h"
+
+#include <math.h>
+#include <string.h>
+
+#define MBKeyCount 100000
+#define MBBatchCount 3
+#define MBTextLength 12
+
+// Runs the iterations in a shuffled order, as dispatch_apply_f may
+static void MBApplyShuffled(size_t iterations, void *context, MBTableGridSortWorkFunction work) {
+    size_t *order = malloc(iterations * sizeof(size_t));
+    for (size_t i = 0; i < iterations; i++)
+        order[i] = i;
+    for (size_t i = iterations; i > 1; i--) {
+        size_t j = MBTestRandomIndex(i), swap = order[i - 1];
+        order[i - 1] = order[j];
+        order[j] = swap;
+    }
+    for (size_t i = 0; i < iterations; i++)
+        work(context, order[i]);
+    free(order);
+}
+
+// What makes two keys equal: numbers by value, with 0 and -0 alike and
+// every NaN alike; dates apart from numbers; pending with empty
+typedef struct MBCanonicalKey {
+    int kind;
+    uint64_t bits;
+    const char *bytes;
+    size_t length;
+} MBCanonicalKey;
+
+static MBCanonicalKey MBCanonical(const MBTableGridValue *key) {
+    MBCanonicalKey canonical = { 0, 0, NULL, 0 };
+    double number;
+    switch (key->type) {
+        case MBTableGridValueTypeInteger:
+        case MBTableGridValueTypeDouble:
+        case MBTableGridValueTypeDate:
+            canonical.kind = (key->type == MBTableGridValueTypeDate) ? 2 : 1;
+            number = (key->type == MBTableGridValueTypeInteger) ? (double)key->data.integer : key->data.number;
+            number = isnan(number) ? NAN : number + 0.0;
+            memcpy(&canonical.bits, &number, sizeof(number));
+            break;
+        case MBTableGridValueTypeBoolean:
+            canonical.kind = 3;
+            canonical.bits = key->data.boolean;
+            break;
+        case MBTableGridValueTypeString:
+            canonical.kind = 4;
+            canonical.bytes = key->data.string.bytes;
+            canonical.length = key->data.string.length;
+            break;
+        default:
+            break;
+    }
+    return canonical;
+}
+
+static int MBCompareCanonical(const void *a, const void *b) {
+    const MBCanonicalKey *x = a, *y = b;
+    if (x->kind != y->kind)
+        return x->kind < y->kind ? -1 : 1;
+    if (x->bits != y->bits)
+        return x->bits < y->bits ? -1 : 1;
+    if (x->length != y->length)
+        return x->length < y->length ? -1 : 1;
+    return x->length ? memcmp(x->bytes, y->bytes, x->length) : 0;
+}
+
+static MBTableGridValue MBKeys[MBBatchCount][MBKeyCount];
+static uint32_t MBGroups[MBBatchCount][MBKeyCount];
+static char MBTexts[MBBatchCount][MBKeyCount][MBTextLength];
+
+// Few distinct keys of each kind, so that most of each batch is found by
+// the parallel lookups, with as many distinct strings as asked for
+static MBTableGridValue MBRandomKey(char *text, size_t stringCount) {
+    uint64_t nanBits = 0x7FF8000000000000ULL | MBTestRandomIndex(1000);
+    double nan;
+    memcpy(&nan, &nanBits, sizeof(nan));
+    switch (MBTestRandomIndex(9)) {
+        case 0:
+            return MBTableGridValueMakeInteger((int64_t)MBTestRandomIndex(50) - 25);
+        case 1:
+            return MBTableGridValueMakeDouble((double)MBTestRandomIndex(100) / 2.0 - 25.0);
+        case 2: {
+            static const double MBSpecial[] = { 0.0, -0.0, INFINITY, -INFINITY };
+            return MBTableGridValueMakeDouble((MBTestRandom() & 1) ? nan : MBSpecial[MBTestRandomIndex(4)]);
+        }
+        case 3:
+            return MBTableGridValueMakeDate((double)MBTestRandomIndex(20));
+        case 4:
+            return MBTableGridValueMakeBoolean(MBTestRandom() & 1);
+        case 5:
+        case 6: {
+            int length = snprintf(text, MBTextLength, "%zu", MBTestRandomIndex(stringCount));
+            return MBTableGridValueMakeString(text, (size_t)length);
+        }
+        case 7:
+            return MBTableGridValueMakePending();
+        default: {
+            MBTableGridValue key = { MBTableGridValueTypeEmpty, { 0 } };
+            return key;
+        }
+    }
+}
+
+static void MBCheckGrouping(size_t stringCount) {
+    MBTableGridGroupTable *table = MBTableGridGroupTableCreate();
+    MBTestCheck(table != NULL);
+    for (size_t batch = 0; batch < MBBatchCount; batch++) {
+        for (size_t i = 0; i < MBKeyCount; i++)
+            MBKeys[batch][i] = MBRandomKey(MBTexts[batch][i], stringCount);
+
+        // New groups are numbered in the order their keys first appear
+        size_t countBefore = MBTableGridGroupTableCount(table);
+        MBTestCheck(MBTableGridGroupTableAssign(table, MBKeys[batch], MBKeyCount, MBGroups[batch], batch ? MBApplyShuffled : NULL));
+        size_t nextGroup = countBefore;
+        for (size_t i = 0; i < MBKeyCount; i++) {
+            uint32_t group = MBGroups[batch][i];
+            MBTestCheck(group <= nextGroup);
+            if (group == nextGroup)
+                nextGroup++;
+            MBTableGridValue key = MBTableGridGroupTableKey(table, group);
+            MBCanonicalKey stored = MBCanonical(&key), canonical = MBCanonical(&MBKeys[batch][i]);
+            MBTestCheck(MBCompareCanonical(&stored, &canonical) == 0);
+        }
+        MBTestCheck(MBTableGridGroupTableCount(table) == nextGroup);
+    }
+
+    // Every group's key is distinct from every other's
+    size_t groupCount = MBTableGridGroupTableCount(table);
+    MBTableGridValue *keys = malloc(groupCount * sizeof(MBTableGridValue));
+    MBCanonicalKey *canonicals = malloc(groupCount * sizeof(MBCanonicalKey));
+    for (size_t group = 0; group < groupCount; group++) {
+        keys[group] = MBTableGridGroupTableKey(table, (uint32_t)group);
+        canonicals[group] = MBCanonical(&keys[group]);
+        MBTestCheck(keys[group].type != MBTableGridValueTypePending);
+    }
+    qsort(canonicals, groupCount, sizeof(MBCanonicalKey), MBCompareCanonical);
+    for (size_t group = 1; group < groupCount; group++)
+        MBTestCheck(MBCompareCanonical(&canonicals[group - 1], &canonicals[group]) != 0);
+    MBTestCheck(MBTableGridGroupTableKey(table, (uint32_t)groupCount).type == MBTableGridValueTypeEmpty);
+
+    // Assigning a batch again gives the same groups and adds none
+    uint32_t *groups = malloc(MBKeyCount * sizeof(uint32_t));
+    MBTestCheck(MBTableGridGroupTableAssign(table, MBKeys[0], MBKeyCount, groups, MBApplyShuffled));
+    MBTestCheck(memcmp(groups, MBGroups[0], MBKeyCount * sizeof(uint32_t)) == 0);
+    MBTestCheck(MBTableGridGroupTableCount(table) == groupCount);
+
+    free(groups);
+    free(canonicals);
+    free(keys);
+    MBTableGridGroupTableDestroy(table);
+}
+
+// Halves and small integers, so that sums are exact in any order
+static MBTableGridValue MBRandomValue(void) {
+    switch (MBTestRandomIndex(5)) {
+        case 0:
+            return MBTableGridValueMakeInteger((int64_t)MBTestRandomIndex(2001) - 1000);
+        case 1:
+            return MBTableGridValueMakeDouble((double)((int64_t)MBTestRandomIndex(4001) - 2000) / 2.0);
+        case 2:
+            return MBTableGridValueMakeString("text", 4);
+        case 3:
+            return MBTableGridValueMakePending();
+        default: {
+            MBTableGridValue value = { MBTableGridValueTypeEmpty, { 0 } };
+            return value;
+        }
+    }
+}
+
+static bool MBAggregatesAreEqual(const MBTableGridAggregate *a, const MBTableGridAggregate *b) {
+    return a->count == b->count && a->numberCount == b->numberCount && a->pendingCount == b->pendingCount &&
+           a->sum == b->sum && a->minimum == b->minimum && a->maximum == b->maximum;
+}
+
+// Few groups are summarized a chunk at a time and merged, many on one thread
+static void MBCheckAggregation(size_t groupCount) {
+    static MBTableGridValue values[MBKeyCount];
+    uint32_t *groups = malloc(MBKeyCount * sizeof(uint32_t));
+    MBTableGridAggregate *expected = malloc(groupCount * sizeof(MBTableGridAggregate));
+    MBTableGridAggregate *aggregates = malloc(groupCount * sizeof(MBTableGridAggregate));
+    MBTableGridAggregate *serialAggregates = malloc(groupCount * sizeof(MBTableGridAggregate));
+    for (size_t group = 0; group < groupCount; group++)
+        expected[group] = aggregates[group] = serialAggregates[group] = MBTableGridAggregateMakeEmpty();
+
+    // Rows in no group, such as those a filter hides, are left out
+    for (size_t i = 0; i < MBKeyCount; i++) {
+        values[i] = MBRandomValue();
+        groups[i] = MBTestRandomIndex(10) == 0 ? MBTableGridGroupNone : (uint32_t)MBTestRandomIndex(groupCount);
+        if (groups[i] != MBTableGridGroupNone)
+            MBTableGridAggregateAddValues(&expected[groups[i]], &values[i], 1);
+    }
+
+    MBTestCheck(MBTableGridGroupAggregate(groups, values, MBKeyCount, aggregates, groupCount, MBApplyShuffled));
+    MBTestCheck(MBTableGridGroupAggregate(groups, values, MBKeyCount, serialAggregates, groupCount, NULL));
+    for (size_t group = 0; group < groupCount; group++) {
+        MBTestCheck(MBAggregatesAreEqual(&aggregates[group], &expected[group]));
+        MBTestCheck(MBAggregatesAreEqual(&serialAggregates[group], &expected[group]));
+    }
+
+    free(serialAggregates);
+    free(aggregates);
+    free(expected);
+    free(groups);
+}
+
+int main(void) {
+    MBCheckGrouping(100);
+    // Enough distinct strings that the table grows many times over
+    MBCheckGrouping(1000000);
+
+    MBCheckAggregation(1);
+    MBCheckAggregation(37);
+    MBCheckAggregation(60000);
+    return MBTestExitStatus();
+}
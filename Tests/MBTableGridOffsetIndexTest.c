@@ -0,0 +1,80 @@
+//
+//  MBTableGridOffsetIndexTest.c
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+//  Checks offsets, hit tests and size updates against prefix sums worked out
+//  the slow way, for uniform and per-entry sizes.
+//
+
+#include "MBTableGridOffsetIndex.h"
+#include "MBTableGridTest.h"
+
+#include <math.h>
+
+#define MBEntryCount 1000
+
+static double MBOffsets[MBEntryCount + 1];
+
+static void MBSumSizes(const float *sizes) {
+    MBOffsets[0] = 0;
+    for (size_t i = 0; i < MBEntryCount; i++)
+        MBOffsets[i + 1] = MBOffsets[i] + sizes[i];
+}
+
+static void MBCheckAgainstSums(const MBTableGridOffsetIndex *index, const float *sizes) {
+    MBSumSizes(sizes);
+    MBTestCheck(MBTableGridOffsetIndexCount(index) == MBEntryCount);
+    MBTestCheck(fabs(MBTableGridOffsetIndexTotalSize(index) - MBOffsets[MBEntryCount]) < 1e-6);
+    for (size_t i = 0; i <= MBEntryCount; i++) {
+        MBTestCheck(fabs(MBTableGridOffsetIndexOffsetOfIndex(index, i) - MBOffsets[i]) < 1e-6);
+    }
+    for (size_t i = 0; i < MBEntryCount; i++) {
+        MBTestCheck(MBTableGridOffsetIndexSizeAtIndex(index, i) == sizes[i]);
+        if (sizes[i] > 0) {
+            MBTestCheck(MBTableGridOffsetIndexIndexAtOffset(index, MBOffsets[i]) == i);
+            MBTestCheck(MBTableGridOffsetIndexIndexAtOffset(index, MBOffsets[i] + sizes[i] * 0.5) == i);
+        }
+    }
+    MBTestCheck(MBTableGridOffsetIndexIndexAtOffset(index, -1.0) == MBTableGridOffsetIndexNotFound);
+    MBTestCheck(MBTableGridOffsetIndexIndexAtOffset(index, MBOffsets[MBEntryCount]) == MBTableGridOffsetIndexNotFound);
+}
+
+int main(void) {
+    static float sizes[MBEntryCount];
+    MBTableGridOffsetIndex *index = MBTableGridOffsetIndexCreate();
+    MBTestCheck(index != NULL);
+
+    MBTableGridOffsetIndexResetUniform(index, MBEntryCount, 20.0);
+    MBTestCheck(MBTableGridOffsetIndexIsUniform(index));
+    for (size_t i = 0; i < MBEntryCount; i++)
+        sizes[i] = 20.0f;
+    MBCheckAgainstSums(index, sizes);
+
+    // The first size of its own materializes the entries
+    MBTestCheck(MBTableGridOffsetIndexSetSize(index, 500, 35.0));
+    sizes[500] = 35.0f;
+    MBTestCheck(!MBTableGridOffsetIndexIsUniform(index));
+    MBCheckAgainstSums(index, sizes);
+    MBTestCheck(!MBTableGridOffsetIndexSetSize(index, MBEntryCount, 10.0));
+
+    float *buffer = MBTableGridOffsetIndexBeginReset(index, MBEntryCount);
+    MBTestCheck(buffer != NULL);
+    for (size_t i = 0; i < MBEntryCount; i++) {
+        sizes[i] = (float)(1 + MBTestRandomIndex(40));
+        buffer[i] = sizes[i];
+    }
+    MBTableGridOffsetIndexEndReset(index);
+    MBCheckAgainstSums(index, sizes);
+
+    for (size_t update = 0; update < 200; update++) {
+        size_t i = MBTestRandomIndex(MBEntryCount);
+        sizes[i] = (float)MBTestRandomIndex(60);
+        MBTestCheck(MBTableGridOffsetIndexSetSize(index, i, sizes[i]));
+    }
+    MBCheckAgainstSums(index, sizes);
+
+    MBTableGridOffsetIndexDestroy(index);
+    return MBTestExitStatus();
+}
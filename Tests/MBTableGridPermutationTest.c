@@ -0,0 +1,132 @@
+//
+//  MBTableGridPermutationTest.c
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+//  Checks the permutation's positions against a plain array through inserts,
+//  removes and moves, and repairs a sort the way the grid does after an
+//  edit: each edited row is taken out, its key is changed, and it goes back
+//  where a binary search puts it, which must match sorting from scratch.
+//
+
+#include "MBTableGridPermutation.h"
+#include "MBTableGridSort.h"
+#include "MBTableGridTest.h"
+
+#include <string.h>
+
+#define MBItemCount 5000
+
+static void MBCheckAgainstItems(const MBTableGridPermutation *permutation, const size_t *items, size_t count) {
+    MBTestCheck(MBTableGridPermutationCount(permutation) == count);
+    for (size_t i = 0; i < count; i++) {
+        MBTestCheck(MBTableGridPermutationItemAtPosition(permutation, i) == items[i]);
+        MBTestCheck(MBTableGridPermutationPositionOfItem(permutation, items[i]) == i);
+    }
+    size_t *copied = malloc((count ? count : 1) * sizeof(size_t));
+    MBTableGridPermutationGetItems(permutation, 0, count, copied);
+    MBTestCheck(count == 0 || memcmp(copied, items, count * sizeof(size_t)) == 0);
+    free(copied);
+}
+
+// Moves k rows together to a position, as a row drag does, in both
+static void MBMoveItems(MBTableGridPermutation *permutation, size_t *items, size_t count) {
+    size_t positions[32], moved[32], rest[MBItemCount];
+    size_t k = 1 + MBTestRandomIndex(32), position = MBTestRandomIndex(count - 3 * k);
+    for (size_t i = 0; i < k; i++)
+        positions[i] = position + i * 3;
+    for (size_t i = k; i > 0; i--)
+        moved[i - 1] = MBTableGridPermutationRemove(permutation, positions[i - 1]);
+    size_t restCount = 0, j = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (j < k && positions[j] == i)
+            MBTestCheck(moved[j++] == items[i]);
+        else
+            rest[restCount++] = items[i];
+    }
+    size_t target = MBTestRandomIndex(restCount + 1);
+    for (size_t i = 0; i < k; i++)
+        MBTestCheck(MBTableGridPermutationInsert(permutation, target + i, moved[i]));
+    memcpy(items, rest, target * sizeof(size_t));
+    memcpy(items + target, moved, k * sizeof(size_t));
+    memcpy(items + target + k, rest + target, (restCount - target) * sizeof(size_t));
+}
+
+typedef struct MBSortRow {
+    const MBTableGridSortKeys *keys;
+    size_t row;
+} MBSortRow;
+
+// Ties go by row, as the grid's repair breaks them
+static int MBCompareSortRow(void *context, size_t item) {
+    const MBSortRow *sortRow = context;
+    int result = MBTableGridSortKeysCompare(sortRow->keys, true, item, sortRow->row);
+    return result ? result : (item > sortRow->row) - (item < sortRow->row);
+}
+
+static void MBTestSortRepair(void) {
+    MBTableGridSortKeys *keys = MBTableGridSortKeysCreate(MBItemCount);
+    size_t *rows = malloc(MBItemCount * sizeof(size_t));
+    for (size_t i = 0; i < MBItemCount; i++) {
+        MBTableGridValue value = MBTableGridValueMakeInteger((int64_t)MBTestRandomIndex(100));
+        MBTestCheck(MBTableGridSortKeysSetValue(keys, i, &value));
+        rows[i] = i;
+    }
+    MBTestCheck(MBTableGridSortKeysSort(keys, true, rows, NULL));
+    MBTableGridPermutation *permutation = MBTableGridPermutationCreate(rows, MBItemCount);
+
+    for (size_t edit = 0; edit < 300; edit++) {
+        size_t row = MBTestRandomIndex(MBItemCount);
+        size_t position = MBTableGridPermutationPositionOfItem(permutation, row);
+        MBTestCheck(MBTableGridPermutationRemove(permutation, position) == row);
+        MBTableGridValue value = (edit % 7 == 0) ? MBTableGridValueMakeString("text", 4)
+                                                 : MBTableGridValueMakeInteger((int64_t)MBTestRandomIndex(100));
+        MBTestCheck(MBTableGridSortKeysSetValue(keys, row, &value));
+        MBSortRow sortRow = { keys, row };
+        MBTestCheck(MBTableGridPermutationInsert(permutation, MBTableGridPermutationSearch(permutation, MBCompareSortRow, &sortRow), row));
+    }
+
+    // A stable sort from the data source's order breaks ties by row too
+    for (size_t i = 0; i < MBItemCount; i++)
+        rows[i] = i;
+    MBTestCheck(MBTableGridSortKeysSort(keys, true, rows, NULL));
+    MBCheckAgainstItems(permutation, rows, MBItemCount);
+
+    MBTableGridPermutationDestroy(permutation);
+    MBTableGridSortKeysDestroy(keys);
+    free(rows);
+}
+
+int main(void) {
+    static size_t items[MBItemCount];
+    size_t count = MBItemCount;
+    for (size_t i = 0; i < count; i++)
+        items[i] = (i * 7919) % MBItemCount;
+    MBTableGridPermutation *permutation = MBTableGridPermutationCreate(items, count);
+    MBTestCheck(permutation != NULL);
+    MBCheckAgainstItems(permutation, items, count);
+    MBTestCheck(MBTableGridPermutationPositionOfItem(permutation, MBItemCount) == MBTableGridPermutationNotFound);
+
+    // Removing from the front and the end, and putting them back in the middle
+    size_t first = MBTableGridPermutationRemove(permutation, 0);
+    size_t last = MBTableGridPermutationRemove(permutation, count - 2);
+    MBTestCheck(first == items[0] && last == items[count - 1]);
+    memmove(items, items + 1, (count - 2) * sizeof(size_t));
+    count -= 2;
+    MBTestCheck(MBTableGridPermutationInsert(permutation, count / 2, first));
+    MBTestCheck(MBTableGridPermutationInsert(permutation, count / 2, last));
+    memmove(items + count / 2 + 2, items + count / 2, (count - count / 2) * sizeof(size_t));
+    items[count / 2] = last;
+    items[count / 2 + 1] = first;
+    count += 2;
+    MBCheckAgainstItems(permutation, items, count);
+
+    for (size_t move = 0; move < 500; move++)
+        MBMoveItems(permutation, items, count);
+    MBCheckAgainstItems(permutation, items, count);
+    MBTableGridPermutationDestroy(permutation);
+
+    MBTestSortRepair();
+    return MBTestExitStatus();
+}
@@ -0,0 +1,176 @@
+//
+//  MBTableGridSortTest.c
+//  MBTableGrid
+//
+//  Created by agent on 10/17/26.
+//
+//  Sorts a column of mixed values both ways, and checks the order against
+//  a plain comparison of the values, with ties kept in their original
+//  order, and MBTableGridSortKeysCompare against the same comparison.
+//  Empty cells come last both ways, and so do NaNs among the numbers.
+//
+
+#include "MBTableGridSort.h"
+#include "MBTableGridTest.h"
+
+#include <math.h>
+#include <string.h>
+
+#define MBRowCount 5000
+
+static MBTableGridValue MBValues[MBRowCount];
+
+static const char *const MBStrings[] = { "apple", "Apple", "APPLE", "apples", "banana", "", "Banana split", "zebra", "10", "9" };
+
+static MBTableGridValue MBRandomValue(void) {
+    static const double MBDoubles[] = { -0.0, 0.0, 2.5, -7.5, INFINITY, -INFINITY, NAN };
+    switch (MBTestRandomIndex(8)) {
+        case 0:
+            return MBTableGridValueMakeInteger((int64_t)MBTestRandomIndex(101) - 50);
+        case 1:
+            return MBTableGridValueMakeDouble(MBDoubles[MBTestRandomIndex(sizeof(MBDoubles) / sizeof(MBDoubles[0]))]);
+        case 2:
+            return MBTableGridValueMakeDouble((double)((int64_t)MBTestRandomIndex(201) - 100) / 4.0);
+        case 3:
+            return MBTableGridValueMakeDate(86400.0 * (double)MBTestRandomIndex(40));
+        case 4: {
+            const char *string = MBStrings[MBTestRandomIndex(sizeof(MBStrings) / sizeof(MBStrings[0]))];
+            return MBTableGridValueMakeString(string, strlen(string));
+        }
+        case 5:
+            return MBTableGridValueMakeBoolean(MBTestRandom() & 1);
+        case 6:
+            return MBTableGridValueMakePending();
+        default: {
+            MBTableGridValue value = { MBTableGridValueTypeEmpty, { 0 } };
+            return value;
+        }
+    }
+}
+
+// Numbers and dates, then strings, then Booleans, then empty cells
+static int MBClass(const MBTableGridValue *value) {
+    switch (value->type) {
+        case MBTableGridValueTypeInteger:
+        case MBTableGridValueTypeDouble:
+        case MBTableGridValueTypeDate:
+            return 0;
+        case MBTableGridValueTypeString:
+            return 1;
+        case MBTableGridValueTypeBoolean:
+            return 2;
+        default:
+            return 3;
+    }
+}
+
+static int MBCompareBytes(const char *a, size_t lengthA, const char *b, size_t lengthB, bool folds) {
+    for (size_t i = 0; i < lengthA && i < lengthB; i++) {
+        unsigned char x = (unsigned char)a[i], y = (unsigned char)b[i];
+        if (folds) {
+            x = (x >= 'A' && x <= 'Z') ? (unsigned char)(x | 0x20) : x;
+            y = (y >= 'A' && y <= 'Z') ? (unsigned char)(y | 0x20) : y;
+        }
+        if (x != y)
+            return x < y ? -1 : 1;
+    }
+    return (lengthA > lengthB) - (lengthA < lengthB);
+}
+
+// The order of two values within the same class, ascending
+static int MBCompareValues(const MBTableGridValue *a, const MBTableGridValue *b) {
+    switch (MBClass(a)) {
+        case 0: {
+            double x = (a->type == MBTableGridValueTypeInteger) ? (double)a->data.integer : a->data.number;
+            double y = (b->type == MBTableGridValueTypeInteger) ? (double)b->data.integer : b->data.number;
+            return (x > y) - (x < y);
+        }
+        case 1: {
+            int result = MBCompareBytes(a->data.string.bytes, a->data.string.length, b->data.string.bytes, b->data.string.length, true);
+            return result ? result : MBCompareBytes(a->data.string.bytes, a->data.string.length, b->data.string.bytes, b->data.string.length, false);
+        }
+        case 2:
+            return (int)a->data.boolean - (int)b->data.boolean;
+        default:
+            return 0;
+    }
+}
+
+static bool MBIsNaN(const MBTableGridValue *value) {
+    return (value->type == MBTableGridValueTypeDouble || value->type == MBTableGridValueTypeDate) && isnan(value->data.number);
+}
+
+static bool MBSortsAscending;
+
+static int MBReferenceCompare(size_t rowA, size_t rowB) {
+    const MBTableGridValue *a = &MBValues[rowA], *b = &MBValues[rowB];
+    int classA = MBClass(a), classB = MBClass(b);
+    if (classA != classB) {
+        if (classA == 3 || classB == 3)
+            return classA == 3 ? 1 : -1;
+        return MBSortsAscending ? (classA < classB ? -1 : 1) : (classA > classB ? -1 : 1);
+    }
+    if (MBIsNaN(a) || MBIsNaN(b))
+        return (int)MBIsNaN(a) - (int)MBIsNaN(b);
+    int result = MBCompareValues(a, b);
+    return MBSortsAscending ? result : -result;
+}
+
+// Ties keep their order, so the reference order is exact
+static int MBCompareRows(const void *a, const void *b) {
+    size_t rowA = *(const size_t *)a, rowB = *(const size_t *)b;
+    int result = MBReferenceCompare(rowA, rowB);
+    return result ? result : (rowA > rowB) - (rowA < rowB);
+}
+
+static void MBApplyInReverse(size_t iterations, void *context, MBTableGridSortWorkFunction work) {
+    for (size_t i = iterations; i > 0; i--)
+        work(context, i - 1);
+}
+
+int main(void) {
+    MBTableGridSortKeys *keys = MBTableGridSortKeysCreate(MBRowCount);
+    MBTestCheck(keys != NULL);
+    for (size_t row = 0; row < MBRowCount; row++) {
+        MBValues[row] = MBRandomValue();
+        MBTestCheck(MBTableGridSortKeysSetValue(keys, row, &MBValues[row]));
+    }
+
+    size_t *rows = malloc(MBRowCount * sizeof(size_t));
+    size_t *expected = malloc(MBRowCount * sizeof(size_t));
+    for (int direction = 0; direction < 2; direction++) {
+        MBSortsAscending = (direction == 0);
+        for (size_t row = 0; row < MBRowCount; row++)
+            expected[row] = row;
+        qsort(expected, MBRowCount, sizeof(size_t), MBCompareRows);
+
+        for (int parallel = 0; parallel < 2; parallel++) {
+            for (size_t row = 0; row < MBRowCount; row++)
+                rows[row] = row;
+            MBTestCheck(MBTableGridSortKeysSort(keys, MBSortsAscending, rows, parallel ? MBApplyInReverse : NULL));
+            MBTestCheck(memcmp(rows, expected, MBRowCount * sizeof(size_t)) == 0);
+        }
+
+        // NaNs come after the other numbers, whichever way the rows are sorted
+        size_t lastNumber = 0, firstNaN = MBRowCount;
+        for (size_t i = 0; i < MBRowCount; i++) {
+            if (MBIsNaN(&MBValues[rows[i]]) && firstNaN == MBRowCount)
+                firstNaN = i;
+            else if (MBClass(&MBValues[rows[i]]) == 0 && !MBIsNaN(&MBValues[rows[i]]))
+                lastNumber = i;
+        }
+        MBTestCheck(firstNaN < MBRowCount && lastNumber < firstNaN);
+
+        for (size_t check = 0; check < 20000; check++) {
+            size_t rowA = MBTestRandomIndex(MBRowCount), rowB = MBTestRandomIndex(MBRowCount);
+            int result = MBTableGridSortKeysCompare(keys, MBSortsAscending, rowA, rowB);
+            int reference = MBReferenceCompare(rowA, rowB);
+            MBTestCheck((result > 0) == (reference > 0) && (result < 0) == (reference < 0));
+        }
+    }
+
+    free(expected);
+    free(rows);
+    MBTableGridSortKeysDestroy(keys);
+    return MBTestExitStatus();
+}
@@ -0,0 +1,43 @@
+//
+//  MBTableGridTest.h
+//  MBTableGrid
+//
+//  Created by agent on 10/16/26.
+//
+//  A check macro shared by the tests of the plain C core. Each test is its
+//  own executable, run by ctest, that exits with a failure status if any
+//  check failed.
+//
+
+#ifndef MBTableGridTest_h
+#define MBTableGridTest_h
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static int MBTestFailures = 0;
+
+#define MBTestCheck(condition) do { \
+    if (!(condition)) { \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+        MBTestFailures++; \
+    } \
+} while (0)
+
+static uint64_t MBTestRandomState = 0x9E3779B97F4A7C15ULL;
+
+static inline uint64_t MBTestRandom(void) {
+    MBTestRandomState ^= MBTestRandomState << 13;
+    MBTestRandomState ^= MBTestRandomState >> 7;
+    MBTestRandomState ^= MBTestRandomState << 17;
+    return MBTestRandomState;
+}
+
+static inline size_t MBTestRandomIndex(size_t count) {
+    return (size_t)(MBTestRandom() % count);
+}
+
+#define MBTestExitStatus() (MBTestFailures ? EXIT_FAILURE : EXIT_SUCCESS)
+
+#endif /* MBTableGridTest_h */